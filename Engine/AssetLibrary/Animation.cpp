@@ -0,0 +1,291 @@
+#include "Animation.hpp"
+
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <xmmintrin.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+
+namespace inl {
+namespace asset {
+
+
+void LocalPose::Resize(size_t boneCount) {
+	for (auto& component : translation) {
+		component.resize(boneCount);
+	}
+	for (auto& component : rotation) {
+		component.resize(boneCount);
+	}
+	for (auto& component : scale) {
+		component.resize(boneCount);
+	}
+}
+
+
+size_t LocalPose::GetBoneCount() const {
+	return translation[0].size();
+}
+
+
+//------------------------------------------------------------------------------
+// Animation clip
+//------------------------------------------------------------------------------
+
+
+AnimationClip::AnimationClip(std::string name, float duration, std::vector<AnimationTrack> tracks)
+	: m_name(std::move(name)), m_duration(duration), m_tracks(std::move(tracks))
+{
+	auto validate = [this](const std::vector<float>& times, const auto& components) {
+		if (times.empty()) {
+			throw InvalidArgumentException("Animation tracks must have at least one key of each kind.", m_name);
+		}
+		if (!std::is_sorted(times.begin(), times.end())) {
+			throw InvalidArgumentException("Animation keys must be sorted by time.", m_name);
+		}
+		for (const auto& component : components) {
+			if (component.size() != times.size()) {
+				throw InvalidArgumentException("Animation tracks must have each component of each key.", m_name);
+			}
+		}
+	};
+	for (const auto& track : m_tracks) {
+		validate(track.translationTimes, track.translations);
+		validate(track.rotationTimes, track.rotations);
+		validate(track.scaleTimes, track.scales);
+	}
+}
+
+
+const std::string& AnimationClip::GetName() const {
+	return m_name;
+}
+
+
+float AnimationClip::GetDuration() const {
+	return m_duration;
+}
+
+
+size_t AnimationClip::GetTrackCount() const {
+	return m_tracks.size();
+}
+
+
+const AnimationTrack& AnimationClip::GetTrack(size_t index) const {
+	assert(index < m_tracks.size());
+	return m_tracks[index];
+}
+
+
+//------------------------------------------------------------------------------
+// Sampling
+//------------------------------------------------------------------------------
+
+
+AnimationSampler::AnimationSampler(const AnimationClip& clip)
+	: m_clip(&clip)
+{
+	const size_t numTracks = clip.GetTrackCount();
+	m_translationCursors.resize(numTracks, 0);
+	m_rotationCursors.resize(numTracks, 0);
+	m_scaleCursors.resize(numTracks, 0);
+	for (size_t i = 0; i < 4; ++i) {
+		m_first[i].resize(numTracks);
+		m_second[i].resize(numTracks);
+	}
+	m_factors.resize(numTracks);
+}
+
+
+void AnimationSampler::Sample(float time, LocalPose& pose) {
+	time = std::min(std::max(time, 0.0f), m_clip->GetDuration());
+	const size_t numTracks = m_clip->GetTrackCount();
+	pose.Resize(numTracks);
+
+	Gather(time, m_translationCursors, &AnimationTrack::translationTimes, &AnimationTrack::translations);
+	for (size_t i = 0; i < 3; ++i) {
+		Lerp(m_first[i].data(), m_second[i].data(), m_factors.data(), numTracks, pose.translation[i].data());
+	}
+
+	Gather(time, m_rotationCursors, &AnimationTrack::rotationTimes, &AnimationTrack::rotations);
+	Nlerp({ m_first[0].data(), m_first[1].data(), m_first[2].data(), m_first[3].data() },
+		{ m_second[0].data(), m_second[1].data(), m_second[2].data(), m_second[3].data() },
+		m_factors.data(),
+		numTracks,
+		{ pose.rotation[0].data(), pose.rotation[1].data(), pose.rotation[2].data(), pose.rotation[3].data() });
+
+	Gather(time, m_scaleCursors, &AnimationTrack::scaleTimes, &AnimationTrack::scales);
+	for (size_t i = 0; i < 3; ++i) {
+		Lerp(m_first[i].data(), m_second[i].data(), m_factors.data(), numTracks, pose.scale[i].data());
+	}
+}
+
+
+uint32_t AnimationSampler::FindKey(const std::vector<float>& times, float time, uint32_t cursor) {
+	const uint32_t count = (uint32_t)times.size();
+
+	// Played forward, the key is the same as last time or one of the next ones.
+	if (cursor < count && times[cursor] <= time) {
+		for (int step = 0; step < 2; ++step, ++cursor) {
+			if (cursor + 1 == count || times[cursor + 1] > time) {
+				return cursor;
+			}
+		}
+	}
+
+	auto it = std::upper_bound(times.begin(), times.end(), time);
+	return it == times.begin() ? 0 : uint32_t(it - times.begin() - 1);
+}
+
+
+template <size_t NumComponents>
+void AnimationSampler::Gather(
+	float time,
+	std::vector<uint32_t>& cursors,
+	std::vector<float> AnimationTrack::*times,
+	std::array<std::vector<float>, NumComponents> AnimationTrack::*values)
+{
+	for (size_t i = 0; i < m_clip->GetTrackCount(); ++i) {
+		const AnimationTrack& track = m_clip->GetTrack(i);
+		const std::vector<float>& keyTimes = track.*times;
+		const auto& keyValues = track.*values;
+
+		const uint32_t key = FindKey(keyTimes, time, cursors[i]);
+		const uint32_t next = std::min(key + 1, (uint32_t)keyTimes.size() - 1);
+		cursors[i] = key;
+
+		const float span = keyTimes[next] - keyTimes[key];
+		m_factors[i] = span > 0.0f ? std::min(std::max((time - keyTimes[key]) / span, 0.0f), 1.0f) : 0.0f;
+		for (size_t c = 0; c < NumComponents; ++c) {
+			m_first[c][i] = keyValues[c][key];
+			m_second[c][i] = keyValues[c][next];
+		}
+	}
+}
+
+
+void AnimationSampler::Lerp(const float* first, const float* second, const float* factors, size_t count, float* output) {
+	size_t index = 0;
+	for (; index + 4 <= count; index += 4) {
+		__m128 a = _mm_loadu_ps(first + index);
+		__m128 b = _mm_loadu_ps(second + index);
+		__m128 f = _mm_loadu_ps(factors + index);
+		_mm_storeu_ps(output + index, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), f)));
+	}
+
+	// Remainder, with the same operations in the same order.
+	for (; index < count; ++index) {
+		output[index] = first[index] + (second[index] - first[index]) * factors[index];
+	}
+}
+
+
+void AnimationSampler::Nlerp(const std::array<const float*, 4>& first, const std::array<const float*, 4>& second, const float* factors, size_t count, const std::array<float*, 4>& output) {
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+
+	size_t index = 0;
+	for (; index + 4 <= count; index += 4) {
+		__m128 a[4], b[4];
+		for (int c = 0; c < 4; ++c) {
+			a[c] = _mm_loadu_ps(first[c] + index);
+			b[c] = _mm_loadu_ps(second[c] + index);
+		}
+		__m128 f = _mm_loadu_ps(factors + index);
+
+		// q and -q are the same rotation, the one closer to the first key is taken so that the blend takes the short way.
+		__m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_add_ps(_mm_mul_ps(a[2], b[2]), _mm_mul_ps(a[3], b[3])));
+		__m128 sign = _mm_and_ps(dot, signMask);
+
+		__m128 result[4];
+		for (int c = 0; c < 4; ++c) {
+			result[c] = _mm_add_ps(a[c], _mm_mul_ps(_mm_sub_ps(_mm_xor_ps(b[c], sign), a[c]), f));
+		}
+		__m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(result[0], result[0]), _mm_mul_ps(result[1], result[1])), _mm_add_ps(_mm_mul_ps(result[2], result[2]), _mm_mul_ps(result[3], result[3])));
+		__m128 length = _mm_sqrt_ps(lengthSq);
+		for (int c = 0; c < 4; ++c) {
+			_mm_storeu_ps(output[c] + index, _mm_div_ps(result[c], length));
+		}
+	}
+
+	// Remainder, with the same operations in the same order.
+	for (; index < count; ++index) {
+		float a[4], b[4];
+		for (int c = 0; c < 4; ++c) {
+			a[c] = first[c][index];
+			b[c] = second[c][index];
+		}
+		const float f = factors[index];
+
+		const float dot = (a[0] * b[0] + a[1] * b[1]) + (a[2] * b[2] + a[3] * b[3]);
+		const float sign = std::signbit(dot) ? -1.0f : 1.0f;
+
+		float result[4];
+		for (int c = 0; c < 4; ++c) {
+			result[c] = a[c] + (sign * b[c] - a[c]) * f;
+		}
+		const float length = std::sqrt((result[0] * result[0] + result[1] * result[1]) + (result[2] * result[2] + result[3] * result[3]));
+		for (int c = 0; c < 4; ++c) {
+			output[c][index] = result[c] / length;
+		}
+	}
+}
+
+
+//------------------------------------------------------------------------------
+// Skin matrices
+//------------------------------------------------------------------------------
+
+
+static Mat44 GetLocalTransform(const LocalPose& pose, size_t bone) {
+	const float x = pose.rotation[0][bone];
+	const float y = pose.rotation[1][bone];
+	const float z = pose.rotation[2][bone];
+	const float w = pose.rotation[3][bone];
+
+	// The rows are the rotated axes, which are then scaled.
+	const float rotation[3][3] = {
+		{ 1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w) },
+		{ 2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w) },
+		{ 2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y) },
+	};
+
+	Mat44 local;
+	for (int i = 0; i < 3; ++i) {
+		for (int j = 0; j < 3; ++j) {
+			local(i, j) = rotation[i][j] * pose.scale[i][bone];
+		}
+		local(i, 3) = 0.0f;
+		local(3, i) = pose.translation[i][bone];
+	}
+	local(3, 3) = 1.0f;
+	return local;
+}
+
+
+void ComputeSkinMatrices(const Skeleton& skeleton, const LocalPose& pose, std::vector<Mat44>& skinMatrices) {
+	const size_t numBones = skeleton.GetBoneCount();
+	if (pose.GetBoneCount() != numBones) {
+		throw InvalidArgumentException("The pose must have a transform for each bone of the skeleton.");
+	}
+	skinMatrices.resize(numBones);
+
+	// Global transforms first, parents come before their children.
+	for (size_t i = 0; i < numBones; ++i) {
+		const Bone& bone = skeleton.GetBone(i);
+		Mat44 global = GetLocalTransform(pose, i) * bone.baseTransform;
+		if (bone.parent >= 0) {
+			global = global * skinMatrices[bone.parent];
+		}
+		skinMatrices[i] = global;
+	}
+	for (size_t i = 0; i < numBones; ++i) {
+		skinMatrices[i] = skeleton.GetBone(i).inverseBind * skinMatrices[i];
+	}
+}
+
+
+}
+}
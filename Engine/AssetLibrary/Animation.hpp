@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Skeleton.hpp"
+
+#include <InlineMath.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace inl {
+namespace asset {
+
+
+/// <summary>
+/// Local transforms of the bones of a skeleton, relative to their parents.
+/// Each component has its own array, so that bones are processed four at a time.
+/// </summary>
+/// <remarks> Rotations are unit quaternions in x, y, z, w order. </remarks>
+struct LocalPose {
+	void Resize(size_t boneCount);
+	size_t GetBoneCount() const;
+
+	std::array<std::vector<float>, 3> translation;
+	std::array<std::vector<float>, 4> rotation;
+	std::array<std::vector<float>, 3> scale;
+};
+
+
+/// <summary>
+/// The keyframes of a single bone. Each component has its own array, in the same order as the key times.
+/// </summary>
+/// <remarks> Rotations are unit quaternions in x, y, z, w order. </remarks>
+struct AnimationTrack {
+	std::vector<float> translationTimes;
+	std::array<std::vector<float>, 3> translations;
+	std::vector<float> rotationTimes;
+	std::array<std::vector<float>, 4> rotations;
+	std::vector<float> scaleTimes;
+	std::array<std::vector<float>, 3> scales;
+};
+
+
+/// <summary>
+/// A skeletal animation, with one track for each bone of the skeleton it was made for.
+/// </summary>
+class AnimationClip {
+public:
+	AnimationClip() = default;
+	/// <param name="duration"> In seconds, like the key times. </param>
+	/// <exception cref="InvalidArgumentException"> If a track has no keys, the keys are not sorted by time,
+	///		or the components have a different number of keys than the times. </exception>
+	AnimationClip(std::string name, float duration, std::vector<AnimationTrack> tracks);
+
+	const std::string& GetName() const;
+	float GetDuration() const;
+	size_t GetTrackCount() const;
+	const AnimationTrack& GetTrack(size_t index) const;
+
+private:
+	std::string m_name;
+	float m_duration = 0.0f;
+	std::vector<AnimationTrack> m_tracks;
+};
+
+
+/// <summary>
+/// Evaluates the tracks of an <see cref="AnimationClip"/> into a <see cref="LocalPose"/>.
+/// </summary>
+/// <remarks>
+/// Keys are found for each track first. The sampler remembers them, so a clip played forward
+/// finds them in a step or two. The keys are then blended four bones at a time with SSE,
+/// translations and scales linearly, rotations by normalized linear interpolation.
+/// The clip must outlive the sampler. A sampler must only be used by one thread at a time.
+/// </remarks>
+class AnimationSampler {
+public:
+	explicit AnimationSampler(const AnimationClip& clip);
+
+	/// <summary> Evaluates the clip at <paramref name="time"/> seconds, which is clamped to the duration.
+	///		Looping is up to the caller. </summary>
+	/// <param name="pose"> Resized to the number of tracks. </param>
+	void Sample(float time, LocalPose& pose);
+
+private:
+	// The index of the last key at or before the time, or 0 if the time is before the first key.
+	static uint32_t FindKey(const std::vector<float>& times, float time, uint32_t cursor);
+
+	// Finds the key pairs of a channel of every track, and gathers them into m_first, m_second and m_factors.
+	template <size_t NumComponents>
+	void Gather(
+		float time,
+		std::vector<uint32_t>& cursors,
+		std::vector<float> AnimationTrack::*times,
+		std::array<std::vector<float>, NumComponents> AnimationTrack::*values);
+
+	static void Lerp(const float* first, const float* second, const float* factors, size_t count, float* output);
+	static void Nlerp(const std::array<const float*, 4>& first, const std::array<const float*, 4>& second, const float* factors, size_t count, const std::array<float*, 4>& output);
+
+private:
+	const AnimationClip* m_clip;
+	std::vector<uint32_t> m_translationCursors;
+	std::vector<uint32_t> m_rotationCursors;
+	std::vector<uint32_t> m_scaleCursors;
+
+	// The two keys to blend and the blend factor of each track, for the channel being sampled.
+	std::array<std::vector<float>, 4> m_first;
+	std::array<std::vector<float>, 4> m_second;
+	std::vector<float> m_factors;
+};
+
+
+/// <summary> Computes the skin matrices of a pose, which the vertices are transformed by, see <see cref="Skeleton"/>. </summary>
+/// <param name="skinMatrices"> Resized to the number of bones. </param>
+/// <exception cref="InvalidArgumentException"> If the pose does not have a transform for each bone. </exception>
+void ComputeSkinMatrices(const Skeleton& skeleton, const LocalPose& pose, std::vector<Mat44>& skinMatrices);
+
+
+}
+}
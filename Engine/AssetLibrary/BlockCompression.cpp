@@ -0,0 +1,731 @@
+#include "BlockCompression.hpp"
+#include "ParallelFor.hpp"
+
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <emmintrin.h>
+
+
+namespace inl {
+namespace asset {
+
+
+//------------------------------------------------------------------------------
+// Endpoint fitting
+//------------------------------------------------------------------------------
+
+namespace {
+
+// The pixels of a block by channel, as floats so that SIMD registers can hold squared errors.
+struct BlockPixels {
+	alignas(16) float channels[4][16];
+};
+
+
+// Finds the nearest palette entry of each pixel, 4 pixels at a time. Ties go to the lower index.
+void FindNearest(const float (*channels)[16], int numChannels, const float (*palette)[4], int paletteSize, uint8_t* indices, float* errors) {
+	for (int group = 0; group < 16; group += 4) {
+		__m128 bestError = _mm_set1_ps(std::numeric_limits<float>::max());
+		__m128i bestIndex = _mm_setzero_si128();
+		for (int p = 0; p < paletteSize; ++p) {
+			__m128 error = _mm_setzero_ps();
+			for (int c = 0; c < numChannels; ++c) {
+				__m128 diff = _mm_sub_ps(_mm_load_ps(&channels[c][group]), _mm_set1_ps(palette[p][c]));
+				error = _mm_add_ps(error, _mm_mul_ps(diff, diff));
+			}
+			__m128i better = _mm_castps_si128(_mm_cmplt_ps(error, bestError));
+			bestError = _mm_min_ps(error, bestError);
+			bestIndex = _mm_or_si128(_mm_and_si128(better, _mm_set1_epi32(p)), _mm_andnot_si128(better, bestIndex));
+		}
+		alignas(16) int32_t groupIndices[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(groupIndices), bestIndex);
+		_mm_storeu_ps(errors + group, bestError);
+		for (int i = 0; i < 4; ++i) {
+			indices[group + i] = (uint8_t)groupIndices[i];
+		}
+	}
+}
+
+
+// Fits a line through the pixels which have a weight of 1 along their principal axis.
+// The endpoints bound the projections of the pixels, and are clamped to [0, 255].
+void FitLine(const float (*channels)[16], int numChannels, const float* mask, float* e0, float* e1) {
+	float count = 0.0f;
+	float mean[4] = { 0, 0, 0, 0 };
+	for (int i = 0; i < 16; ++i) {
+		count += mask[i];
+		for (int c = 0; c < numChannels; ++c) {
+			mean[c] += mask[i] * channels[c][i];
+		}
+	}
+	if (count == 0.0f) {
+		std::fill(e0, e0 + numChannels, 0.0f);
+		std::fill(e1, e1 + numChannels, 0.0f);
+		return;
+	}
+	for (int c = 0; c < numChannels; ++c) {
+		mean[c] /= count;
+	}
+
+	float covariance[4][4] = {};
+	for (int i = 0; i < 16; ++i) {
+		for (int c = 0; c < numChannels; ++c) {
+			for (int d = c; d < numChannels; ++d) {
+				covariance[c][d] += mask[i] * (channels[c][i] - mean[c]) * (channels[d][i] - mean[d]);
+			}
+		}
+	}
+	for (int c = 0; c < numChannels; ++c) {
+		for (int d = 0; d < c; ++d) {
+			covariance[c][d] = covariance[d][c];
+		}
+	}
+
+	// Power iteration, starting from the row of the channel with the largest variance.
+	int largest = 0;
+	for (int c = 1; c < numChannels; ++c) {
+		largest = covariance[c][c] > covariance[largest][largest] ? c : largest;
+	}
+	float axis[4] = { 0, 0, 0, 0 };
+	std::copy(covariance[largest], covariance[largest] + numChannels, axis);
+	for (int iteration = 0; iteration < 8; ++iteration) {
+		float next[4] = { 0, 0, 0, 0 };
+		float norm = 0.0f;
+		for (int c = 0; c < numChannels; ++c) {
+			for (int d = 0; d < numChannels; ++d) {
+				next[c] += covariance[c][d] * axis[d];
+			}
+			norm = std::max(norm, std::abs(next[c]));
+		}
+		if (norm == 0.0f) {
+			break;
+		}
+		for (int c = 0; c < numChannels; ++c) {
+			axis[c] = next[c] / norm;
+		}
+	}
+
+	float lengthSq = 0.0f;
+	for (int c = 0; c < numChannels; ++c) {
+		lengthSq += axis[c] * axis[c];
+	}
+	float minT = 0.0f, maxT = 0.0f;
+	if (lengthSq > 1e-12f) {
+		minT = std::numeric_limits<float>::max();
+		maxT = -std::numeric_limits<float>::max();
+		for (int i = 0; i < 16; ++i) {
+			if (mask[i] == 0.0f) {
+				continue;
+			}
+			float t = 0.0f;
+			for (int c = 0; c < numChannels; ++c) {
+				t += (channels[c][i] - mean[c]) * axis[c];
+			}
+			minT = std::min(minT, t / lengthSq);
+			maxT = std::max(maxT, t / lengthSq);
+		}
+	}
+	for (int c = 0; c < numChannels; ++c) {
+		e0[c] = std::min(255.0f, std::max(0.0f, mean[c] + minT * axis[c]));
+		e1[c] = std::min(255.0f, std::max(0.0f, mean[c] + maxT * axis[c]));
+	}
+}
+
+
+// Endpoints which minimize the squared error, given how far each pixel is from e0 towards e1.
+// Pixels with a negative weight are left out. Returns false if the weights don't determine the endpoints.
+bool SolveEndpoints(const float (*channels)[16], int numChannels, const float* weights, float* e0, float* e1) {
+	float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+	float ax[4] = { 0, 0, 0, 0 };
+	float bx[4] = { 0, 0, 0, 0 };
+	for (int i = 0; i < 16; ++i) {
+		float b = weights[i];
+		if (b < 0.0f) {
+			continue;
+		}
+		float a = 1.0f - b;
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+		for (int c = 0; c < numChannels; ++c) {
+			ax[c] += a * channels[c][i];
+			bx[c] += b * channels[c][i];
+		}
+	}
+	float determinant = aa * bb - ab * ab;
+	if (std::abs(determinant) < 1e-6f) {
+		return false;
+	}
+	for (int c = 0; c < numChannels; ++c) {
+		e0[c] = std::min(255.0f, std::max(0.0f, (ax[c] * bb - bx[c] * ab) / determinant));
+		e1[c] = std::min(255.0f, std::max(0.0f, (bx[c] * aa - ax[c] * ab) / determinant));
+	}
+	return true;
+}
+
+
+float SumErrors(const float* errors, const float* mask) {
+	float sum = 0.0f;
+	for (int i = 0; i < 16; ++i) {
+		sum += mask[i] * errors[i];
+	}
+	return sum;
+}
+
+
+const float OpaqueMask[16] = { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 };
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+// BC1 color blocks
+//------------------------------------------------------------------------------
+
+namespace {
+
+uint16_t QuantizeColor(const float* color) {
+	int r = std::min(31, int(color[0] * (31.0f / 255.0f) + 0.5f));
+	int g = std::min(63, int(color[1] * (63.0f / 255.0f) + 0.5f));
+	int b = std::min(31, int(color[2] * (31.0f / 255.0f) + 0.5f));
+	return uint16_t((r << 11) | (g << 5) | b);
+}
+
+
+// The 4 colors of a BC1 block. In 3 color mode, the last one is transparent black.
+void GetColorPalette(uint16_t c0, uint16_t c1, bool fourColor, uint8_t (*colors)[4]) {
+	int a[3] = { (c0 >> 11) & 31, (c0 >> 5) & 63, c0 & 31 };
+	int b[3] = { (c1 >> 11) & 31, (c1 >> 5) & 63, c1 & 31 };
+	for (int c = 0; c < 3; ++c) {
+		int bits = c == 1 ? 6 : 5;
+		a[c] = (a[c] << (8 - bits)) | (a[c] >> (2 * bits - 8));
+		b[c] = (b[c] << (8 - bits)) | (b[c] >> (2 * bits - 8));
+		colors[0][c] = (uint8_t)a[c];
+		colors[1][c] = (uint8_t)b[c];
+		if (fourColor) {
+			colors[2][c] = uint8_t((2 * a[c] + b[c]) / 3);
+			colors[3][c] = uint8_t((a[c] + 2 * b[c]) / 3);
+		}
+		else {
+			colors[2][c] = uint8_t((a[c] + b[c]) / 2);
+			colors[3][c] = 0;
+		}
+	}
+	colors[0][3] = colors[1][3] = colors[2][3] = 255;
+	colors[3][3] = fourColor ? 255 : 0;
+}
+
+
+// BC3 color blocks are always in 4 color mode, BC1 blocks are in 3 color mode if c0 <= c1.
+// Pixels with alpha below 128 are made transparent if punchThrough is set.
+void CompressColorBlock(const BlockPixels& block, bool punchThrough, uint8_t* out) {
+	float mask[16];
+	bool threeColor = false;
+	for (int i = 0; i < 16; ++i) {
+		bool transparent = punchThrough && block.channels[3][i] < 128.0f;
+		mask[i] = transparent ? 0.0f : 1.0f;
+		threeColor = threeColor || transparent;
+	}
+
+	const float fourColorWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+	const float threeColorWeights[4] = { 0.0f, 1.0f, 0.5f, -1.0f };
+	const float* weightOfIndex = threeColor ? threeColorWeights : fourColorWeights;
+
+	float e0[3], e1[3];
+	FitLine(block.channels, 3, mask, e0, e1);
+
+	uint16_t bestC0 = 0, bestC1 = 0;
+	uint8_t bestIndices[16] = {};
+	float bestError = std::numeric_limits<float>::max();
+	for (int iteration = 0; iteration < 3; ++iteration) {
+		uint16_t c0 = QuantizeColor(e0);
+		uint16_t c1 = QuantizeColor(e1);
+		if (threeColor ? c0 > c1 : c0 < c1) {
+			std::swap(c0, c1);
+		}
+
+		uint8_t colors[4][4];
+		float palette[4][4];
+		GetColorPalette(c0, c1, !threeColor, colors);
+		for (int p = 0; p < 4; ++p) {
+			std::copy(colors[p], colors[p] + 4, palette[p]);
+		}
+		uint8_t indices[16];
+		float errors[16];
+		FindNearest(block.channels, 3, palette, threeColor ? 3 : 4, indices, errors);
+		float error = SumErrors(errors, mask);
+		if (error < bestError) {
+			bestError = error;
+			bestC0 = c0;
+			bestC1 = c1;
+			std::copy(indices, indices + 16, bestIndices);
+		}
+		if (error == 0.0f) {
+			break;
+		}
+
+		float weights[16];
+		for (int i = 0; i < 16; ++i) {
+			weights[i] = mask[i] == 0.0f ? -1.0f : weightOfIndex[indices[i]];
+		}
+		if (!SolveEndpoints(block.channels, 3, weights, e0, e1)) {
+			break;
+		}
+	}
+
+	uint32_t indexBits = 0;
+	for (int i = 0; i < 16; ++i) {
+		uint32_t index = mask[i] == 0.0f ? 3 : bestIndices[i];
+		indexBits |= index << (2 * i);
+	}
+	out[0] = uint8_t(bestC0);
+	out[1] = uint8_t(bestC0 >> 8);
+	out[2] = uint8_t(bestC1);
+	out[3] = uint8_t(bestC1 >> 8);
+	for (int i = 0; i < 4; ++i) {
+		out[4 + i] = uint8_t(indexBits >> (8 * i));
+	}
+}
+
+
+void DecompressColorBlock(const uint8_t* block, bool forceFourColor, uint8_t* pixels) {
+	uint16_t c0 = uint16_t(block[0] | (block[1] << 8));
+	uint16_t c1 = uint16_t(block[2] | (block[3] << 8));
+	uint8_t colors[4][4];
+	GetColorPalette(c0, c1, forceFourColor || c0 > c1, colors);
+	for (int i = 0; i < 16; ++i) {
+		int index = (block[4 + i / 4] >> (2 * (i % 4))) & 3;
+		std::copy(colors[index], colors[index] + 4, pixels + 4 * i);
+	}
+}
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+// BC4 single channel blocks, also used for BC3 alpha and BC5
+//------------------------------------------------------------------------------
+
+namespace {
+
+// 8 values interpolated if v0 > v1, otherwise 6 values and 0 and 255.
+void GetValuePalette(int v0, int v1, int* values) {
+	values[0] = v0;
+	values[1] = v1;
+	if (v0 > v1) {
+		for (int i = 1; i <= 6; ++i) {
+			values[1 + i] = ((7 - i) * v0 + i * v1 + 3) / 7;
+		}
+	}
+	else {
+		for (int i = 1; i <= 4; ++i) {
+			values[1 + i] = ((5 - i) * v0 + i * v1 + 2) / 5;
+		}
+		values[6] = 0;
+		values[7] = 255;
+	}
+}
+
+
+float EvaluateValueBlock(const float (*channel)[16], int v0, int v1, uint8_t* indices) {
+	int values[8];
+	float palette[8][4];
+	float errors[16];
+	GetValuePalette(v0, v1, values);
+	for (int p = 0; p < 8; ++p) {
+		palette[p][0] = (float)values[p];
+	}
+	FindNearest(channel, 1, palette, 8, indices, errors);
+	return SumErrors(errors, OpaqueMask);
+}
+
+
+void CompressValueBlock(const float (*channel)[16], uint8_t* out) {
+	int minValue = 255, maxValue = 0;
+	int minInner = 255, maxInner = 0; // without 0 and 255, which the 6 value mode has exactly
+	for (int i = 0; i < 16; ++i) {
+		int value = (int)channel[0][i];
+		minValue = std::min(minValue, value);
+		maxValue = std::max(maxValue, value);
+		if (value != 0 && value != 255) {
+			minInner = std::min(minInner, value);
+			maxInner = std::max(maxInner, value);
+		}
+	}
+
+	int bestV0 = 0, bestV1 = 0;
+	uint8_t bestIndices[16] = {};
+	float bestError = std::numeric_limits<float>::max();
+	uint8_t indices[16];
+	auto tryEndpoints = [&](int v0, int v1) {
+		v0 = std::min(255, std::max(0, v0));
+		v1 = std::min(255, std::max(0, v1));
+		float error = EvaluateValueBlock(channel, v0, v1, indices);
+		if (error < bestError) {
+			bestError = error;
+			bestV0 = v0;
+			bestV1 = v1;
+			std::copy(indices, indices + 16, bestIndices);
+		}
+	};
+
+	// Search around the range of values in both modes, then refine the 8 value mode.
+	for (int d0 = -2; d0 <= 2 && bestError > 0.0f; ++d0) {
+		for (int d1 = -2; d1 <= 2 && bestError > 0.0f; ++d1) {
+			if (maxValue + d0 > minValue + d1) {
+				tryEndpoints(maxValue + d0, minValue + d1);
+			}
+		}
+	}
+	if (minInner <= maxInner) {
+		for (int d0 = -1; d0 <= 1 && bestError > 0.0f; ++d0) {
+			for (int d1 = -1; d1 <= 1 && bestError > 0.0f; ++d1) {
+				if (minInner + d0 <= maxInner + d1) {
+					tryEndpoints(minInner + d0, maxInner + d1);
+				}
+			}
+		}
+	}
+	else {
+		tryEndpoints(0, 0);
+	}
+	if (bestV0 > bestV1 && bestError > 0.0f) {
+		float weights[16];
+		for (int i = 0; i < 16; ++i) {
+			weights[i] = bestIndices[i] <= 1 ? float(bestIndices[i]) : float(bestIndices[i] - 1) / 7.0f;
+		}
+		float e0, e1;
+		if (SolveEndpoints(channel, 1, weights, &e0, &e1) && int(e0 + 0.5f) > int(e1 + 0.5f)) {
+			tryEndpoints(int(e0 + 0.5f), int(e1 + 0.5f));
+		}
+	}
+
+	uint64_t indexBits = 0;
+	for (int i = 0; i < 16; ++i) {
+		indexBits |= uint64_t(bestIndices[i]) << (3 * i);
+	}
+	out[0] = (uint8_t)bestV0;
+	out[1] = (uint8_t)bestV1;
+	for (int i = 0; i < 6; ++i) {
+		out[2 + i] = uint8_t(indexBits >> (8 * i));
+	}
+}
+
+
+void DecompressValueBlock(const uint8_t* block, uint8_t* pixels, int channel) {
+	int values[8];
+	GetValuePalette(block[0], block[1], values);
+	uint64_t indexBits = 0;
+	for (int i = 0; i < 6; ++i) {
+		indexBits |= uint64_t(block[2 + i]) << (8 * i);
+	}
+	for (int i = 0; i < 16; ++i) {
+		pixels[4 * i + channel] = (uint8_t)values[(indexBits >> (3 * i)) & 7];
+	}
+}
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+// BC7 mode 6 blocks
+//------------------------------------------------------------------------------
+
+namespace {
+
+const int Bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+
+// Endpoints are 7 bits per channel and a shared lowest bit per endpoint.
+void GetBc7Palette(const int* q0, int p0, const int* q1, int p1, int (*colors)[4]) {
+	for (int c = 0; c < 4; ++c) {
+		int e0 = (q0[c] << 1) | p0;
+		int e1 = (q1[c] << 1) | p1;
+		for (int i = 0; i < 16; ++i) {
+			colors[i][c] = ((64 - Bc7Weights[i]) * e0 + Bc7Weights[i] * e1 + 32) >> 6;
+		}
+	}
+}
+
+
+class BitWriter {
+public:
+	explicit BitWriter(uint8_t* data) : m_data(data) { std::fill(data, data + 16, uint8_t(0)); }
+	void Write(uint32_t value, int numBits) {
+		for (int i = 0; i < numBits; ++i, ++m_position) {
+			m_data[m_position / 8] |= uint8_t(((value >> i) & 1) << (m_position % 8));
+		}
+	}
+private:
+	uint8_t* m_data;
+	int m_position = 0;
+};
+
+
+class BitReader {
+public:
+	explicit BitReader(const uint8_t* data) : m_data(data) {}
+	uint32_t Read(int numBits) {
+		uint32_t value = 0;
+		for (int i = 0; i < numBits; ++i, ++m_position) {
+			value |= uint32_t((m_data[m_position / 8] >> (m_position % 8)) & 1) << i;
+		}
+		return value;
+	}
+private:
+	const uint8_t* m_data;
+	int m_position = 0;
+};
+
+
+void CompressBc7Block(const BlockPixels& block, uint8_t* out) {
+	float e0[4], e1[4];
+	FitLine(block.channels, 4, OpaqueMask, e0, e1);
+
+	int bestQ0[4] = {}, bestQ1[4] = {};
+	int bestP0 = 0, bestP1 = 0;
+	uint8_t bestIndices[16] = {};
+	float bestError = std::numeric_limits<float>::max();
+	for (int iteration = 0; iteration < 3 && bestError > 0.0f; ++iteration) {
+		uint8_t iterationIndices[16] = {};
+		float iterationError = std::numeric_limits<float>::max();
+		for (int pbits = 0; pbits < 4; ++pbits) {
+			int p0 = pbits & 1, p1 = pbits >> 1;
+			int q0[4], q1[4];
+			for (int c = 0; c < 4; ++c) {
+				q0[c] = std::min(127, std::max(0, int((e0[c] - p0) * 0.5f + 0.5f)));
+				q1[c] = std::min(127, std::max(0, int((e1[c] - p1) * 0.5f + 0.5f)));
+			}
+			int colors[16][4];
+			float palette[16][4];
+			GetBc7Palette(q0, p0, q1, p1, colors);
+			for (int i = 0; i < 16; ++i) {
+				std::copy(colors[i], colors[i] + 4, palette[i]);
+			}
+			uint8_t indices[16];
+			float errors[16];
+			FindNearest(block.channels, 4, palette, 16, indices, errors);
+			float error = SumErrors(errors, OpaqueMask);
+			if (error < iterationError) {
+				iterationError = error;
+				std::copy(indices, indices + 16, iterationIndices);
+			}
+			if (error < bestError) {
+				bestError = error;
+				std::copy(q0, q0 + 4, bestQ0);
+				std::copy(q1, q1 + 4, bestQ1);
+				bestP0 = p0;
+				bestP1 = p1;
+				std::copy(indices, indices + 16, bestIndices);
+			}
+		}
+
+		float weights[16];
+		for (int i = 0; i < 16; ++i) {
+			weights[i] = Bc7Weights[iterationIndices[i]] / 64.0f;
+		}
+		if (!SolveEndpoints(block.channels, 4, weights, e0, e1)) {
+			break;
+		}
+	}
+
+	// The highest bit of the first index is implied 0, swap the endpoints if it's not.
+	if (bestIndices[0] & 8) {
+		std::swap(bestQ0, bestQ1);
+		std::swap(bestP0, bestP1);
+		for (auto& index : bestIndices) {
+			index = uint8_t(15 - index);
+		}
+	}
+
+	BitWriter writer(out);
+	writer.Write(1 << 6, 7);
+	for (int c = 0; c < 4; ++c) {
+		writer.Write(bestQ0[c], 7);
+		writer.Write(bestQ1[c], 7);
+	}
+	writer.Write(bestP0, 1);
+	writer.Write(bestP1, 1);
+	writer.Write(bestIndices[0], 3);
+	for (int i = 1; i < 16; ++i) {
+		writer.Write(bestIndices[i], 4);
+	}
+}
+
+
+void DecompressBc7Block(const uint8_t* block, uint8_t* pixels) {
+	BitReader reader(block);
+	if (reader.Read(7) != 1 << 6) {
+		std::fill(pixels, pixels + 64, uint8_t(0)); // other modes are not decoded
+		return;
+	}
+	int q0[4], q1[4];
+	for (int c = 0; c < 4; ++c) {
+		q0[c] = (int)reader.Read(7);
+		q1[c] = (int)reader.Read(7);
+	}
+	int p0 = (int)reader.Read(1);
+	int p1 = (int)reader.Read(1);
+	int colors[16][4];
+	GetBc7Palette(q0, p0, q1, p1, colors);
+	for (int i = 0; i < 16; ++i) {
+		int index = (int)reader.Read(i == 0 ? 3 : 4);
+		for (int c = 0; c < 4; ++c) {
+			pixels[4 * i + c] = (uint8_t)colors[index][c];
+		}
+	}
+}
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+// BlockCompressor
+//------------------------------------------------------------------------------
+
+
+BlockCompressor::BlockCompressor(eBlockFormat format, unsigned numThreads)
+	: m_format(format), m_numThreads(numThreads)
+{}
+
+
+std::vector<uint8_t> BlockCompressor::Compress(const void* pixels, size_t bytesPerRow, size_t width, size_t height, int channelCount) const {
+	if (channelCount < 1 || channelCount > 4) {
+		throw InvalidArgumentException("Images must have 1 to 4 channels.", "channelCount");
+	}
+	if (bytesPerRow == 0) {
+		bytesPerRow = width * channelCount;
+	}
+
+	const size_t blockSize = GetBlockSize(m_format);
+	const size_t blocksX = (width + 3) / 4;
+	const size_t blocksY = (height + 3) / 4;
+	const uint8_t* source = static_cast<const uint8_t*>(pixels);
+	std::vector<uint8_t> blocks(GetCompressedSize(m_format, width, height));
+
+	ParallelFor(blocksY, GetNumThreads(m_numThreads), [&](size_t begin, size_t end) {
+		uint8_t blockPixels[16 * 4];
+		for (size_t by = begin; by < end; ++by) {
+			for (size_t bx = 0; bx < blocksX; ++bx) {
+				for (size_t i = 0; i < 16; ++i) {
+					size_t x = std::min(bx * 4 + i % 4, width - 1);
+					size_t y = std::min(by * 4 + i / 4, height - 1);
+					const uint8_t* pixel = source + y * bytesPerRow + x * channelCount;
+					for (int c = 0; c < 4; ++c) {
+						blockPixels[4 * i + c] = c < channelCount ? pixel[c] : c == 3 ? 255 : 0;
+					}
+				}
+				CompressBlock(m_format, blockPixels, blocks.data() + (by * blocksX + bx) * blockSize);
+			}
+		}
+	});
+
+	return blocks;
+}
+
+
+std::vector<uint8_t> BlockCompressor::Compress(const Image& image) const {
+	if (image.GetType() != eChannelType::INT8) {
+		throw InvalidArgumentException("Only images with 8 bit channels can be block compressed.");
+	}
+	return Compress(image.GetData(), image.GetBytesPerRow(), image.GetWidth(), image.GetHeight(), (int)image.GetChannelCount());
+}
+
+
+void BlockCompressor::Decompress(const void* blocks, size_t width, size_t height, void* pixels, size_t bytesPerRow) const {
+	if (bytesPerRow == 0) {
+		bytesPerRow = width * 4;
+	}
+
+	const size_t blockSize = GetBlockSize(m_format);
+	const size_t blocksX = (width + 3) / 4;
+	const uint8_t* source = static_cast<const uint8_t*>(blocks);
+	uint8_t* destination = static_cast<uint8_t*>(pixels);
+	uint8_t blockPixels[16 * 4];
+	for (size_t by = 0; by < (height + 3) / 4; ++by) {
+		for (size_t bx = 0; bx < blocksX; ++bx) {
+			DecompressBlock(m_format, source + (by * blocksX + bx) * blockSize, blockPixels);
+			for (size_t i = 0; i < 16; ++i) {
+				size_t x = bx * 4 + i % 4;
+				size_t y = by * 4 + i / 4;
+				if (x < width && y < height) {
+					std::copy(blockPixels + 4 * i, blockPixels + 4 * i + 4, destination + y * bytesPerRow + x * 4);
+				}
+			}
+		}
+	}
+}
+
+
+void BlockCompressor::CompressBlock(eBlockFormat format, const uint8_t* pixels, uint8_t* block) {
+	BlockPixels blockPixels;
+	for (int i = 0; i < 16; ++i) {
+		for (int c = 0; c < 4; ++c) {
+			blockPixels.channels[c][i] = pixels[4 * i + c];
+		}
+	}
+
+	switch (format) {
+		case eBlockFormat::BC1:
+			CompressColorBlock(blockPixels, true, block);
+			break;
+		case eBlockFormat::BC3:
+			CompressValueBlock(&blockPixels.channels[3], block);
+			CompressColorBlock(blockPixels, false, block + 8);
+			break;
+		case eBlockFormat::BC4:
+			CompressValueBlock(&blockPixels.channels[0], block);
+			break;
+		case eBlockFormat::BC5:
+			CompressValueBlock(&blockPixels.channels[0], block);
+			CompressValueBlock(&blockPixels.channels[1], block + 8);
+			break;
+		case eBlockFormat::BC7:
+			CompressBc7Block(blockPixels, block);
+			break;
+	}
+}
+
+
+void BlockCompressor::DecompressBlock(eBlockFormat format, const uint8_t* block, uint8_t* pixels) {
+	switch (format) {
+		case eBlockFormat::BC1:
+			DecompressColorBlock(block, false, pixels);
+			break;
+		case eBlockFormat::BC3:
+			DecompressColorBlock(block + 8, true, pixels);
+			DecompressValueBlock(block, pixels, 3);
+			break;
+		case eBlockFormat::BC4:
+		case eBlockFormat::BC5:
+			for (int i = 0; i < 16; ++i) {
+				pixels[4 * i + 1] = pixels[4 * i + 2] = 0;
+				pixels[4 * i + 3] = 255;
+			}
+			DecompressValueBlock(block, pixels, 0);
+			if (format == eBlockFormat::BC5) {
+				DecompressValueBlock(block + 8, pixels, 1);
+			}
+			break;
+		case eBlockFormat::BC7:
+			DecompressBc7Block(block, pixels);
+			break;
+	}
+}
+
+
+size_t BlockCompressor::GetBlockSize(eBlockFormat format) {
+	return format == eBlockFormat::BC1 || format == eBlockFormat::BC4 ? 8 : 16;
+}
+
+
+size_t BlockCompressor::GetCompressedSize(eBlockFormat format, size_t width, size_t height) {
+	return (width + 3) / 4 * ((height + 3) / 4) * GetBlockSize(format);
+}
+
+
+}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Image.hpp"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+
+namespace inl {
+namespace asset {
+
+
+enum class eBlockFormat {
+	BC1, // RGB with 1 bit alpha, 8 bytes per block
+	BC3, // RGBA, 16 bytes per block
+	BC4, // one channel, 8 bytes per block
+	BC5, // two channels, 16 bytes per block
+	BC7, // RGBA, 16 bytes per block
+};
+
+
+/// <summary>
+/// Compresses images to block compressed formats, 4x4 pixels at a time.
+/// Rows of blocks are split between threads, and endpoints are fitted with SIMD.
+/// </summary>
+/// <remarks>
+/// Channels are compressed in the order they are in memory: BC4 takes the first channel, BC5 the first two.
+/// The right and bottom blocks of images whose size is not a multiple of 4 repeat the last column and row.
+/// BC7 blocks are all encoded in mode 6, a single RGBA line with 4 bit indices.
+/// </remarks>
+class BlockCompressor {
+public:
+	/// <param name="numThreads"> Number of threads to use, 0 for the number of cores. </param>
+	explicit BlockCompressor(eBlockFormat format, unsigned numThreads = 0);
+
+	/// <summary> Compresses 8 bit pixels with 1 to 4 channels. Missing color channels are 0, missing alpha is opaque. </summary>
+	/// <param name="bytesPerRow"> Distance between the rows of pixels, 0 if they are tightly packed. </param>
+	/// <returns> The blocks row by row, see <see cref="GetCompressedSize"/>. </returns>
+	std::vector<uint8_t> Compress(const void* pixels, size_t bytesPerRow, size_t width, size_t height, int channelCount) const;
+
+	/// <summary> Compresses an image with 8 bit channels. </summary>
+	/// <remarks> FreeImage stores colors as BGR(A), and these are compressed as such,
+	///		the same way uncompressed images are uploaded. </remarks>
+	std::vector<uint8_t> Compress(const Image& image) const;
+
+	/// <summary> Decompresses blocks made by <see cref="Compress"/> to 4 channel pixels. </summary>
+	/// <remarks> Meant for checking the quality of the compression. Only BC7 mode 6 blocks are decoded. </remarks>
+	void Decompress(const void* blocks, size_t width, size_t height, void* pixels, size_t bytesPerRow = 0) const;
+
+	/// <summary> Compresses one block of 16 pixels of 4 channels, in row major order. </summary>
+	static void CompressBlock(eBlockFormat format, const uint8_t* pixels, uint8_t* block);
+
+	/// <summary> Decompresses one block to 16 pixels of 4 channels, in row major order. </summary>
+	static void DecompressBlock(eBlockFormat format, const uint8_t* block, uint8_t* pixels);
+
+	/// <summary> Bytes per 4x4 block. </summary>
+	static size_t GetBlockSize(eBlockFormat format);
+
+	/// <summary> Bytes the blocks of an image of the given size take. </summary>
+	static size_t GetCompressedSize(eBlockFormat format, size_t width, size_t height);
+
+	eBlockFormat GetFormat() const { return m_format; }
+private:
+	eBlockFormat m_format;
+	unsigned m_numThreads;
+};
+
+
+}
+}
@@ -0,0 +1,209 @@
+#include "CookManifest.hpp"
+
+#include <BaseLibrary/FileSystem/PackFile.hpp>
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+
+namespace inl {
+namespace asset {
+
+
+//------------------------------------------------------------------------------
+// File layout
+//------------------------------------------------------------------------------
+
+// One record per line, fields separated by tabs:
+//	inlcook	<format version>	<cooker version>
+//	asset	<source path>	<cooked path>	<input hash>	<dependencies...>
+//	file	<path>	<size>	<last write time>	<content hash>
+// Hashes are hexadecimal.
+
+static const char Magic[] = "inlcook";
+static constexpr uint32_t FormatVersion = 1;
+
+
+static std::vector<std::string> SplitFields(const std::string& line) {
+	std::vector<std::string> fields;
+	size_t begin = 0;
+	for (;;) {
+		size_t end = line.find('\t', begin);
+		fields.push_back(line.substr(begin, end - begin));
+		if (end == std::string::npos) {
+			return fields;
+		}
+		begin = end + 1;
+	}
+}
+
+
+static std::string ToHex(uint64_t value) {
+	std::ostringstream ss;
+	ss << std::hex << value;
+	return ss.str();
+}
+
+
+template <class T>
+static T ParseNumber(const std::string& text, int base, const std::string& path) {
+	size_t end = 0;
+	unsigned long long value = 0;
+	try {
+		value = std::stoull(text, &end, base);
+	}
+	catch (std::exception&) {
+		end = 0;
+	}
+	if (text.empty() || end != text.size()) {
+		throw InvalidArgumentException("Cook manifest is corrupt.", path);
+	}
+	return T(value);
+}
+
+
+//------------------------------------------------------------------------------
+// Manifest
+//------------------------------------------------------------------------------
+
+
+CookManifest::CookManifest(const std::string& path) {
+	Load(path);
+}
+
+
+void CookManifest::Load(const std::string& path) {
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		throw FileNotFoundException("Could not open cook manifest.", path);
+	}
+
+	m_assets.clear();
+	m_fileStamps.clear();
+
+	std::string line;
+	std::getline(file, line);
+	auto header = SplitFields(line);
+	if (header.size() != 3 || header[0] != Magic) {
+		throw InvalidArgumentException("File is not a cook manifest.", path);
+	}
+	if (ParseNumber<uint32_t>(header[1], 10, path) != FormatVersion) {
+		throw InvalidArgumentException("Cook manifest was made by a different version.", path);
+	}
+	m_cookerVersion = ParseNumber<uint32_t>(header[2], 10, path);
+
+	while (std::getline(file, line)) {
+		if (line.empty()) {
+			continue;
+		}
+		auto fields = SplitFields(line);
+		if (fields[0] == "asset" && fields.size() >= 4) {
+			Asset asset;
+			asset.sourcePath = fields[1];
+			asset.cookedPath = fields[2];
+			asset.inputHash = ParseNumber<uint64_t>(fields[3], 16, path);
+			asset.dependencies.assign(fields.begin() + 4, fields.end());
+			SetAsset(std::move(asset));
+		}
+		else if (fields[0] == "file" && fields.size() == 5) {
+			FileStamp stamp;
+			stamp.size = ParseNumber<uint64_t>(fields[2], 10, path);
+			stamp.lastWriteTime = ParseNumber<int64_t>(fields[3], 10, path);
+			stamp.contentHash = ParseNumber<uint64_t>(fields[4], 16, path);
+			SetFileStamp(fields[1], stamp);
+		}
+		else {
+			throw InvalidArgumentException("Cook manifest is corrupt.", path);
+		}
+	}
+}
+
+
+void CookManifest::Save(const std::string& path) const {
+	std::ofstream file(path, std::ios::trunc);
+	if (!file.is_open()) {
+		throw RuntimeException("Could not open file for writing.", path);
+	}
+
+	file << Magic << '\t' << FormatVersion << '\t' << m_cookerVersion << '\n';
+
+	for (const Asset* asset : GetAssets()) {
+		file << "asset\t" << asset->sourcePath << '\t' << asset->cookedPath << '\t' << ToHex(asset->inputHash);
+		for (const auto& dependency : asset->dependencies) {
+			file << '\t' << dependency;
+		}
+		file << '\n';
+	}
+
+	std::vector<const std::pair<std::string, FileStamp>*> stamps;
+	for (const auto& entry : m_fileStamps) {
+		stamps.push_back(&entry.second);
+	}
+	std::sort(stamps.begin(), stamps.end(), [](auto lhs, auto rhs) { return lhs->first < rhs->first; });
+	for (const auto* stamp : stamps) {
+		file << "file\t" << stamp->first << '\t' << stamp->second.size << '\t' << stamp->second.lastWriteTime << '\t' << ToHex(stamp->second.contentHash) << '\n';
+	}
+
+	if (!file.good()) {
+		throw RuntimeException("Could not write cook manifest.", path);
+	}
+}
+
+
+const CookManifest::Asset* CookManifest::FindAsset(const std::string& sourcePath) const {
+	auto it = m_assets.find(GetKey(sourcePath));
+	return it != m_assets.end() ? &it->second : nullptr;
+}
+
+
+void CookManifest::SetAsset(Asset asset) {
+	std::string key = GetKey(asset.sourcePath);
+	m_assets[key] = std::move(asset);
+}
+
+
+void CookManifest::RemoveAsset(const std::string& sourcePath) {
+	m_assets.erase(GetKey(sourcePath));
+}
+
+
+std::vector<const CookManifest::Asset*> CookManifest::GetAssets() const {
+	std::vector<const Asset*> assets;
+	for (const auto& entry : m_assets) {
+		assets.push_back(&entry.second);
+	}
+	std::sort(assets.begin(), assets.end(), [](const Asset* lhs, const Asset* rhs) { return lhs->sourcePath < rhs->sourcePath; });
+	return assets;
+}
+
+
+const CookManifest::FileStamp* CookManifest::FindFileStamp(const std::string& path) const {
+	auto it = m_fileStamps.find(GetKey(path));
+	return it != m_fileStamps.end() ? &it->second.second : nullptr;
+}
+
+
+void CookManifest::SetFileStamp(const std::string& path, const FileStamp& stamp) {
+	m_fileStamps[GetKey(path)] = { path, stamp };
+}
+
+
+void CookManifest::ClearFileStamps() {
+	m_fileStamps.clear();
+}
+
+
+std::string CookManifest::GetKey(const std::string& path) {
+	std::string key = PackFile::NormalizePath(path);
+	for (auto& c : key) {
+		c = (char)std::tolower((unsigned char)c);
+	}
+	return key;
+}
+
+
+}
+}
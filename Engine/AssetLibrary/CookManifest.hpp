@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace inl {
+namespace asset {
+
+
+/// <summary>
+/// Lists the assets made by the asset cooker, and what they were made from.
+/// The cooker uses it to find the assets that changed since the last run, the runtime
+/// to find the cooked asset of a source file without looking at the disk.
+/// </summary>
+/// <remarks>
+/// Paths are relative to the source and output directories, with forward slashes,
+/// and are looked up case insensitively. The file is text, sorted by path, so it diffs well.
+/// </remarks>
+class CookManifest {
+public:
+	static constexpr const char* FileName = "manifest.inlcook";
+
+	struct Asset {
+		std::string sourcePath;
+		std::string cookedPath;
+		/// <summary> Hash of the cooker version, the settings, and the contents of the source and the dependencies. </summary>
+		uint64_t inputHash = 0;
+		/// <summary> Other source files read while cooking, like the textures of a model or the includes of a shader. </summary>
+		std::vector<std::string> dependencies;
+	};
+
+	/// <summary> Identifies a version of a file without reading it, so that its content hash can be reused. </summary>
+	struct FileStamp {
+		uint64_t size = 0;
+		int64_t lastWriteTime = 0;
+		uint64_t contentHash = 0;
+	};
+public:
+	CookManifest() = default;
+	/// <summary> Loads the manifest, see <see cref="Load"/>. </summary>
+	explicit CookManifest(const std::string& path);
+
+	/// <exception cref="FileNotFoundException"> If the file cannot be opened. </exception>
+	/// <exception cref="InvalidArgumentException"> If the file is not a valid manifest. </exception>
+	void Load(const std::string& path);
+	/// <exception cref="RuntimeException"> If the file cannot be written. </exception>
+	void Save(const std::string& path) const;
+
+	/// <summary> Returns null if the source file has no cooked asset. </summary>
+	const Asset* FindAsset(const std::string& sourcePath) const;
+	void SetAsset(Asset asset);
+	void RemoveAsset(const std::string& sourcePath);
+	std::vector<const Asset*> GetAssets() const;
+
+	/// <summary> Returns null if the file was not seen by the last cook. </summary>
+	const FileStamp* FindFileStamp(const std::string& path) const;
+	void SetFileStamp(const std::string& path, const FileStamp& stamp);
+	void ClearFileStamps();
+
+	/// <summary> Manifests of a different cooker version are useless, all assets must be cooked again. </summary>
+	uint32_t GetCookerVersion() const { return m_cookerVersion; }
+	void SetCookerVersion(uint32_t version) { m_cookerVersion = version; }
+private:
+	static std::string GetKey(const std::string& path);
+private:
+	uint32_t m_cookerVersion = 0;
+	std::unordered_map<std::string, Asset> m_assets;
+	std::unordered_map<std::string, std::pair<std::string, FileStamp>> m_fileStamps;
+};
+
+
+}
+}
@@ -0,0 +1,335 @@
+#include "CookedMesh.hpp"
+
+#include <GraphicsEngine_LL/VertexCompressor.hpp>
+#include <BaseLibrary/ArrayView.hpp>
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <cstring>
+
+
+namespace inl {
+namespace asset {
+
+
+//------------------------------------------------------------------------------
+// File layout
+//------------------------------------------------------------------------------
+
+// The header is followed by the elements, submeshes, vertices and indices,
+// each starting at a multiple of SectionAlignment. Everything is little endian.
+struct CookedMeshHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t vertexStride;
+	uint32_t indexSize; // 2 or 4 bytes
+	uint32_t numElements;
+	uint32_t numSubmeshes;
+	uint32_t numVertices;
+	uint32_t numIndices;
+	uint64_t elementsOffset;
+	uint64_t submeshesOffset;
+	uint64_t verticesOffset;
+	uint64_t indicesOffset;
+	float boundsMin[3];
+	float boundsMax[3];
+};
+
+struct CookedMeshElement {
+	uint32_t semantic;
+	int32_t index;
+	int32_t offset;
+};
+
+static const char Magic[4] = { 'I', 'N', 'L', 'M' };
+static constexpr uint32_t Version = 2;
+static constexpr uint64_t SectionAlignment = 16;
+
+
+static uint64_t AlignSection(uint64_t offset) {
+	return (offset + SectionAlignment - 1) / SectionAlignment * SectionAlignment;
+}
+
+
+//------------------------------------------------------------------------------
+// Cooking
+//------------------------------------------------------------------------------
+
+
+void CookedMeshData::AddSubmesh(const gxeng::VertexBase* submeshVertices, const gxeng::IVertexReader* vertexReader, size_t numVertices, const unsigned* submeshIndices, size_t numIndices, unsigned materialIndex) {
+	const auto& readerElements = vertexReader->GetElements();
+	gxeng::VertexCompressor compressor{ vertexReader, std::vector<bool>(readerElements.size(), true) };
+	auto offsets = compressor.GetCompressedOffsets();
+
+	std::vector<gxeng::Mesh::Element> submeshElements;
+	for (size_t i = 0; i < readerElements.size(); ++i) {
+		submeshElements.push_back({ readerElements[i].semantic, readerElements[i].index, offsets[i] });
+	}
+	auto sameElement = [](const gxeng::Mesh::Element& lhs, const gxeng::Mesh::Element& rhs) {
+		return lhs.semantic == rhs.semantic && lhs.index == rhs.index && lhs.offset == rhs.offset;
+	};
+	if (submeshes.empty()) {
+		vertexStride = (uint32_t)compressor.GetCompressedStride();
+		elements = submeshElements;
+	}
+	else if (elements.size() != submeshElements.size() || !std::equal(elements.begin(), elements.end(), submeshElements.begin(), sameElement)) {
+		throw InvalidArgumentException("All submeshes of a cooked mesh must have the same vertex layout.");
+	}
+	if (vertices.size() / std::max<size_t>(1, vertexStride) + numVertices > std::numeric_limits<uint32_t>::max()) {
+		throw OutOfRangeException("Too many vertices for a cooked mesh.");
+	}
+
+	CookedSubmesh submesh;
+	submesh.firstVertex = uint32_t(vertexStride > 0 ? vertices.size() / vertexStride : 0);
+	submesh.numVertices = (uint32_t)numVertices;
+	submesh.firstIndex = (uint32_t)indices.size();
+	submesh.numIndices = (uint32_t)numIndices;
+	submesh.materialIndex = materialIndex;
+	std::fill(submesh.boundsMin, submesh.boundsMin + 3, numVertices > 0 ? std::numeric_limits<float>::max() : 0.0f);
+	std::fill(submesh.boundsMax, submesh.boundsMax + 3, numVertices > 0 ? -std::numeric_limits<float>::max() : 0.0f);
+
+	// Bounds are taken from the uncompressed positions.
+	auto hasPosition = std::any_of(readerElements.begin(), readerElements.end(), [](const gxeng::IVertexReader::Element& element) {
+		return element.semantic == gxeng::eVertexElementSemantic::POSITION && element.index == 0;
+	});
+	if (hasPosition) {
+		ArrayView<const gxeng::VertexBase> vertexArray{ submeshVertices, numVertices, (size_t)vertexReader->GetStride() };
+		for (size_t i = 0; i < numVertices; ++i) {
+			using PositionT = gxeng::VertexPartReader<gxeng::eVertexElementSemantic::POSITION>::DataType;
+			const PositionT& position = *static_cast<const PositionT*>(vertexReader->GetPointer(vertexArray[i], gxeng::eVertexElementSemantic::POSITION, 0));
+			const float coords[3] = { position.x, position.y, position.z };
+			for (int c = 0; c < 3; ++c) {
+				submesh.boundsMin[c] = std::min(submesh.boundsMin[c], coords[c]);
+				submesh.boundsMax[c] = std::max(submesh.boundsMax[c], coords[c]);
+			}
+		}
+	}
+
+	std::vector<uint8_t> compressedVertices = compressor.GetCompressedStream(submeshVertices, numVertices);
+	vertices.insert(vertices.end(), compressedVertices.begin(), compressedVertices.end());
+	indices.insert(indices.end(), submeshIndices, submeshIndices + numIndices);
+	submeshes.push_back(submesh);
+}
+
+
+void CookedMeshData::Write(const std::string& path) const {
+	const bool index32Bit = std::any_of(submeshes.begin(), submeshes.end(), [](const CookedSubmesh& submesh) {
+		return submesh.numVertices > 0xFFFFu;
+	});
+
+	CookedMeshHeader header = {};
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.vertexStride = vertexStride;
+	header.indexSize = index32Bit ? 4 : 2;
+	header.numElements = (uint32_t)elements.size();
+	header.numSubmeshes = (uint32_t)submeshes.size();
+	header.numVertices = uint32_t(vertexStride > 0 ? vertices.size() / vertexStride : 0);
+	header.numIndices = (uint32_t)indices.size();
+	header.elementsOffset = AlignSection(sizeof(CookedMeshHeader));
+	header.submeshesOffset = AlignSection(header.elementsOffset + elements.size() * sizeof(CookedMeshElement));
+	header.verticesOffset = AlignSection(header.submeshesOffset + submeshes.size() * sizeof(CookedSubmesh));
+	header.indicesOffset = AlignSection(header.verticesOffset + vertices.size());
+	for (int c = 0; c < 3; ++c) {
+		header.boundsMin[c] = submeshes.empty() ? 0.0f : std::numeric_limits<float>::max();
+		header.boundsMax[c] = submeshes.empty() ? 0.0f : -std::numeric_limits<float>::max();
+		for (const auto& submesh : submeshes) {
+			header.boundsMin[c] = std::min(header.boundsMin[c], submesh.boundsMin[c]);
+			header.boundsMax[c] = std::max(header.boundsMax[c], submesh.boundsMax[c]);
+		}
+	}
+
+	std::vector<CookedMeshElement> fileElements;
+	for (const auto& element : elements) {
+		fileElements.push_back({ (uint32_t)element.semantic, element.index, element.offset });
+	}
+	std::vector<uint8_t> fileIndices(indices.size() * header.indexSize);
+	for (size_t i = 0; i < indices.size(); ++i) {
+		if (index32Bit) {
+			std::memcpy(&fileIndices[i * 4], &indices[i], 4);
+		}
+		else {
+			uint16_t index = (uint16_t)indices[i];
+			std::memcpy(&fileIndices[i * 2], &index, 2);
+		}
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		throw RuntimeException("Could not open file for writing.", path);
+	}
+	auto writeSection = [&file](uint64_t offset, const void* data, size_t size) {
+		static const char padding[SectionAlignment] = {};
+		file.write(padding, std::streamsize(offset - (uint64_t)file.tellp()));
+		file.write(static_cast<const char*>(data), std::streamsize(size));
+	};
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	writeSection(header.elementsOffset, fileElements.data(), fileElements.size() * sizeof(CookedMeshElement));
+	writeSection(header.submeshesOffset, submeshes.data(), submeshes.size() * sizeof(CookedSubmesh));
+	writeSection(header.verticesOffset, vertices.data(), vertices.size());
+	writeSection(header.indicesOffset, fileIndices.data(), fileIndices.size());
+	if (!file.good()) {
+		throw RuntimeException("Could not write cooked mesh.", path);
+	}
+}
+
+
+//------------------------------------------------------------------------------
+// Loading
+//------------------------------------------------------------------------------
+
+
+CookedMesh::CookedMesh(const std::string& path)
+	: m_file(path)
+{
+	const uint8_t* data = static_cast<const uint8_t*>(m_file.GetData());
+	const uint64_t size = m_file.GetSize();
+
+	// Check that every section lies within the file, so that nothing is read from outside the mapping.
+	if (size < sizeof(CookedMeshHeader)) {
+		throw InvalidArgumentException("File is too small to be a cooked mesh.", path);
+	}
+	m_header = reinterpret_cast<const CookedMeshHeader*>(data);
+	if (std::memcmp(m_header->magic, Magic, sizeof(Magic)) != 0) {
+		throw InvalidArgumentException("File is not a cooked mesh.", path);
+	}
+	if (m_header->version != Version) {
+		throw InvalidArgumentException("Cooked mesh was made by a different version, cook it again.", path);
+	}
+	if ((m_header->indexSize != 2 && m_header->indexSize != 4) || m_header->vertexStride == 0) {
+		throw InvalidArgumentException("Cooked mesh header is corrupt.", path);
+	}
+	auto isSectionValid = [size](uint64_t offset, uint64_t count, uint64_t elementSize) {
+		return offset % SectionAlignment == 0 && offset <= size && count * elementSize <= size - offset;
+	};
+	if (!isSectionValid(m_header->elementsOffset, m_header->numElements, sizeof(CookedMeshElement))
+		|| !isSectionValid(m_header->submeshesOffset, m_header->numSubmeshes, sizeof(CookedSubmesh))
+		|| !isSectionValid(m_header->verticesOffset, m_header->numVertices, m_header->vertexStride)
+		|| !isSectionValid(m_header->indicesOffset, m_header->numIndices, m_header->indexSize))
+	{
+		throw InvalidArgumentException("Cooked mesh is truncated or corrupt.", path);
+	}
+	m_elements = reinterpret_cast<const CookedMeshElement*>(data + m_header->elementsOffset);
+	m_submeshes = reinterpret_cast<const CookedSubmesh*>(data + m_header->submeshesOffset);
+	m_vertices = data + m_header->verticesOffset;
+	m_indices = data + m_header->indicesOffset;
+
+	for (uint32_t i = 0; i < m_header->numElements; ++i) {
+		if (m_elements[i].semantic > (uint32_t)gxeng::eVertexElementSemantic::BONE_WEIGHTS
+			|| m_elements[i].offset < 0
+			|| (uint32_t)m_elements[i].offset >= m_header->vertexStride)
+		{
+			throw InvalidArgumentException("Cooked mesh has invalid vertex elements.", path);
+		}
+	}
+	for (uint32_t i = 0; i < m_header->numSubmeshes; ++i) {
+		const CookedSubmesh& submesh = m_submeshes[i];
+		if (uint64_t(submesh.firstVertex) + submesh.numVertices > m_header->numVertices
+			|| uint64_t(submesh.firstIndex) + submesh.numIndices > m_header->numIndices)
+		{
+			throw InvalidArgumentException("Cooked mesh has invalid submesh ranges.", path);
+		}
+	}
+}
+
+
+size_t CookedMesh::GetSubmeshCount() const {
+	return m_header->numSubmeshes;
+}
+
+
+const CookedSubmesh& CookedMesh::GetSubmesh(size_t submeshID) const {
+	if (submeshID >= m_header->numSubmeshes) {
+		throw OutOfRangeException("Submesh index is out of range.");
+	}
+	return m_submeshes[submeshID];
+}
+
+
+Vec3 CookedMesh::GetBoundsMin() const {
+	return Vec3(m_header->boundsMin[0], m_header->boundsMin[1], m_header->boundsMin[2]);
+}
+
+
+Vec3 CookedMesh::GetBoundsMax() const {
+	return Vec3(m_header->boundsMax[0], m_header->boundsMax[1], m_header->boundsMax[2]);
+}
+
+
+size_t CookedMesh::GetVertexCount() const {
+	return m_header->numVertices;
+}
+
+
+size_t CookedMesh::GetIndexCount() const {
+	return m_header->numIndices;
+}
+
+
+size_t CookedMesh::GetVertexStride() const {
+	return m_header->vertexStride;
+}
+
+
+std::vector<gxeng::Mesh::Element> CookedMesh::GetElements() const {
+	std::vector<gxeng::Mesh::Element> elements;
+	for (uint32_t i = 0; i < m_header->numElements; ++i) {
+		elements.push_back({ (gxeng::eVertexElementSemantic)m_elements[i].semantic, m_elements[i].index, m_elements[i].offset });
+	}
+	return elements;
+}
+
+
+const void* CookedMesh::GetVertices(size_t submeshID) const {
+	return m_vertices + size_t(GetSubmesh(submeshID).firstVertex) * m_header->vertexStride;
+}
+
+
+const void* CookedMesh::GetIndices(size_t submeshID) const {
+	return m_indices + size_t(GetSubmesh(submeshID).firstIndex) * m_header->indexSize;
+}
+
+
+const void* CookedMesh::GetVertices() const {
+	return m_vertices;
+}
+
+
+const void* CookedMesh::GetIndices() const {
+	return m_indices;
+}
+
+
+bool CookedMesh::IsIndex32Bit() const {
+	return m_header->indexSize == 4;
+}
+
+
+void CookedMesh::SetMesh(gxeng::Mesh& mesh, size_t submeshID) const {
+	const CookedSubmesh& submesh = GetSubmesh(submeshID);
+	mesh.SetCompressed(GetVertices(submeshID), GetVertexStride(), submesh.numVertices, GetElements(), GetIndices(submeshID), submesh.numIndices, IsIndex32Bit());
+}
+
+
+void CookedMesh::SetMesh(gxeng::Mesh& mesh) const {
+	// Indices are relative to the first vertex of their submesh, which becomes the base vertex of the draw.
+	std::vector<gxeng::Mesh::Submesh> submeshes;
+	for (uint32_t i = 0; i < m_header->numSubmeshes; ++i) {
+		const CookedSubmesh& cooked = m_submeshes[i];
+		gxeng::Mesh::Submesh submesh;
+		submesh.firstIndex = cooked.firstIndex;
+		submesh.numIndices = cooked.numIndices;
+		submesh.baseVertex = (int)cooked.firstVertex;
+		submesh.materialSlot = cooked.materialIndex;
+		submesh.boundsMin = Vec3(cooked.boundsMin[0], cooked.boundsMin[1], cooked.boundsMin[2]);
+		submesh.boundsMax = Vec3(cooked.boundsMax[0], cooked.boundsMax[1], cooked.boundsMax[2]);
+		submeshes.push_back(submesh);
+	}
+	mesh.SetCompressed(GetVertices(), GetVertexStride(), GetVertexCount(), GetElements(), GetIndices(), GetIndexCount(), IsIndex32Bit(), std::move(submeshes));
+}
+
+
+}
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Model.hpp"
+
+#include <BaseLibrary/Platform/MappedFile.hpp>
+#include <GraphicsEngine_LL/Mesh.hpp>
+#include <GraphicsEngine_LL/Vertex.hpp>
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+
+namespace inl {
+namespace asset {
+
+
+/// <summary> A submesh of a cooked mesh. Its indices are relative to its first vertex. </summary>
+struct CookedSubmesh {
+	uint32_t firstVertex;
+	uint32_t numVertices;
+	uint32_t firstIndex;
+	uint32_t numIndices;
+	uint32_t materialIndex;
+	float boundsMin[3];
+	float boundsMax[3];
+};
+
+
+/// <summary> Mesh data as it is stored in cooked mesh files, built offline. </summary>
+/// <remarks> Vertices are in the compressed layout of <see cref="gxeng::Mesh"/>, so they are uploaded as they are. </remarks>
+struct CookedMeshData {
+	/// <summary> Converts every submesh of the model. </summary>
+	template <class... AttribT>
+	static CookedMeshData FromModel(const Model& model, CoordSysLayout coordSysLayout = { AxisDir::POS_X, AxisDir::POS_Y, AxisDir::POS_Z });
+
+	/// <summary> Compresses the vertices and appends them as a new submesh. All submeshes must have the same vertex type. </summary>
+	/// <param name="materialIndex"> The material slot the submesh is drawn with. </param>
+	void AddSubmesh(const gxeng::VertexBase* submeshVertices, const gxeng::IVertexReader* vertexReader, size_t numVertices, const unsigned* submeshIndices, size_t numIndices, unsigned materialIndex = 0);
+
+	/// <summary> Writes the file <see cref="CookedMesh"/> loads. </summary>
+	void Write(const std::string& path) const;
+
+	uint32_t vertexStride = 0;
+	std::vector<gxeng::Mesh::Element> elements;
+	std::vector<uint8_t> vertices;
+	std::vector<uint32_t> indices;
+	std::vector<CookedSubmesh> submeshes;
+};
+
+
+struct CookedMeshHeader;
+struct CookedMeshElement;
+
+
+/// <summary>
+/// A cooked mesh file mapped into memory. Vertices and indices are handed to the
+/// graphics engine right from the mapping, nothing is parsed or converted.
+/// </summary>
+class CookedMesh {
+public:
+	static constexpr const char* Extension = ".inlmesh";
+
+	/// <exception cref="InvalidArgumentException"> If the file is not a valid cooked mesh. </exception>
+	explicit CookedMesh(const std::string& path);
+
+	size_t GetSubmeshCount() const;
+	const CookedSubmesh& GetSubmesh(size_t submeshID) const;
+
+	/// <summary> Bounds of all submeshes. </summary>
+	Vec3 GetBoundsMin() const;
+	Vec3 GetBoundsMax() const;
+
+	/// <summary> Number of vertices and indices in all submeshes. </summary>
+	size_t GetVertexCount() const;
+	size_t GetIndexCount() const;
+
+	size_t GetVertexStride() const;
+	std::vector<gxeng::Mesh::Element> GetElements() const;
+	const void* GetVertices(size_t submeshID) const;
+	const void* GetIndices(size_t submeshID) const;
+	/// <summary> The vertices and indices of all submeshes, one submesh after the other. </summary>
+	const void* GetVertices() const;
+	const void* GetIndices() const;
+	bool IsIndex32Bit() const;
+
+	/// <summary> Uploads the submesh to the mesh. </summary>
+	void SetMesh(gxeng::Mesh& mesh, size_t submeshID) const;
+	/// <summary> Uploads all submeshes to the mesh, into the same buffers, and sets its submesh table. </summary>
+	void SetMesh(gxeng::Mesh& mesh) const;
+private:
+	MappedFile m_file;
+	const CookedMeshHeader* m_header;
+	const CookedMeshElement* m_elements;
+	const CookedSubmesh* m_submeshes;
+	const uint8_t* m_vertices;
+	const uint8_t* m_indices;
+};
+
+
+
+template <class... AttribT>
+CookedMeshData CookedMeshData::FromModel(const Model& model, CoordSysLayout coordSysLayout) {
+	CookedMeshData data;
+	for (unsigned submeshID = 0; submeshID < model.SubmeshCount(); ++submeshID) {
+		auto vertices = model.GetVertices<AttribT...>(submeshID, coordSysLayout);
+		auto indices = model.GetIndices(submeshID);
+		data.AddSubmesh(vertices.data(), &gxeng::Vertex<AttribT...>::GetReader(), vertices.size(), indices.data(), indices.size(), model.GetMaterialIndex(submeshID));
+	}
+	return data;
+}
+
+
+}
+}
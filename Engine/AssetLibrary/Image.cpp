@@ -45,32 +45,9 @@ const void* Image::GetData() const {
 	return m_image.isValid() ? m_image.accessPixels() : nullptr;
 }
 
-template <eChannelType type, size_t count>
-Pixel<type, count>& Image::At(size_t x, size_t y) {
-	assert(x < GetWidth());
-	assert(y < GetHeight());
-
-	if (type != GetType() && count != GetCount()) {
-		throw InvalidCastException("The image does not contain this pixel type.");
-	}
-
-	return *(x + reinterpret_cast<Pixel<type, count>*>(m_image.getScanLine(y)));
-}
-template <eChannelType type, size_t count>
-const Pixel<type, count>& Image::At(size_t x, size_t y) {
-	assert(x < GetWidth());
-	assert(y < GetHeight());
-
-	if (type != GetType() && count != GetCount()) {
-		throw InvalidCastException("The image does not contain this pixel type.");
-	}
-
-	return *(x + reinterpret_cast<Pixel<type, count>*>(m_image.getScanLine(y)));
-}
-
 void Image::Create(size_t width, size_t height, eChannelType type, int channelCount) {
 	FREE_IMAGE_TYPE fiType;
-	int bpp;
+	int bpp = 0;
 
 	if (type == eChannelType::INT8 && channelCount <= 4) {
 		fiType = FIT_BITMAP;
@@ -114,6 +91,19 @@ void Image::Load(const std::string& file) {
 	}
 }
 
+void Image::Load(const void* data, size_t size) {
+	// FreeImage only reads from the memory, the cast is for its interface.
+	fipMemoryIO memory(static_cast<BYTE*>(const_cast<void*>(data)), (DWORD)size);
+	if (!m_image.loadFromMemory(memory)) {
+		throw RuntimeException("Failed to load image.");
+	}
+}
+
+void Image::Load(const VirtualFileSystem& fileSystem, const std::string& file) {
+	VirtualFile virtualFile = fileSystem.Open(file);
+	Load(virtualFile.GetData(), virtualFile.GetSize());
+}
+
 
 void Image::TranslateImageType(eChannelType& typeOut, size_t& countOut) const {
 	FREE_IMAGE_TYPE type = m_image.getImageType();
@@ -134,7 +124,7 @@ void Image::TranslateImageType(eChannelType& typeOut, size_t& countOut) const {
 		countOut = 1;
 	}
 	else if (type == FIT_FLOAT) {
-		typeOut = eChannelType::INT16;
+		typeOut = eChannelType::FLOAT;
 		countOut = 1;
 	}
 	else if (type == FIT_UINT32) {
@@ -6,6 +6,10 @@
 #include <type_traits>
 #include <cstdint>
 #include <string>
+#include <cassert>
+
+#include <BaseLibrary/Exception/Exception.hpp>
+#include <BaseLibrary/FileSystem/VirtualFileSystem.hpp>
 
 
 namespace inl {
@@ -39,7 +43,7 @@ public:
 		constexpr size_t argc = sizeof...(Args);
 		static_assert(argc <= count, "More parameters given than channel count.");
 		SetArg(0, args...);
-		for (size_t i = count; i >= argc; --i) {
+		for (size_t i = argc; i < count; ++i) {
 			channels[i] = channel_type(0);
 		}
 	}
@@ -57,7 +61,7 @@ private:
 		channels[n] = head;
 		SetArg(n + 1, rest...);
 	}
-	void SetArg() {}
+	void SetArg(int) {}
 };
 
 
@@ -80,10 +84,14 @@ public:
 	template <eChannelType type, size_t count>
 	Pixel<type, count>& At(size_t x, size_t y);
 	template <eChannelType type, size_t count>
-	const Pixel<type, count>& At(size_t x, size_t y);
+	const Pixel<type, count>& At(size_t x, size_t y) const;
 
 	void Create(size_t width, size_t height, eChannelType type, int channelCount);
 	void Load(const std::string& file);
+	/// <summary> Loads an image file which has already been read into memory. </summary>
+	void Load(const void* data, size_t size);
+	/// <summary> Loads an image file from the virtual file system. Files mapped from a pack are not copied. </summary>
+	void Load(const VirtualFileSystem& fileSystem, const std::string& file);
 private:
 	void TranslateImageType(eChannelType& typeOut, size_t& countOut) const;
 private:
@@ -91,5 +99,29 @@ private:
 };
 
 
+template <eChannelType type, size_t count>
+Pixel<type, count>& Image::At(size_t x, size_t y) {
+	assert(x < GetWidth());
+	assert(y < GetHeight());
+
+	if (type != GetType() || count != GetChannelCount()) {
+		throw InvalidCastException("The image does not contain this pixel type.");
+	}
+
+	return *(x + reinterpret_cast<Pixel<type, count>*>(m_image.getScanLine((unsigned)y)));
+}
+template <eChannelType type, size_t count>
+const Pixel<type, count>& Image::At(size_t x, size_t y) const {
+	assert(x < GetWidth());
+	assert(y < GetHeight());
+
+	if (type != GetType() || count != GetChannelCount()) {
+		throw InvalidCastException("The image does not contain this pixel type.");
+	}
+
+	return *(x + reinterpret_cast<const Pixel<type, count>*>(m_image.getScanLine((unsigned)y)));
+}
+
+
 }
 }
\ No newline at end of file
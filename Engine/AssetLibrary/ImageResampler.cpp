@@ -0,0 +1,584 @@
+#include "ImageResampler.hpp"
+#include "ParallelFor.hpp"
+
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <emmintrin.h>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+
+
+namespace inl {
+namespace asset {
+
+
+//------------------------------------------------------------------------------
+// Filters
+//------------------------------------------------------------------------------
+
+static constexpr double Pi = 3.14159265358979323846;
+
+
+static double Sinc(double x) {
+	if (std::abs(x) < 1e-9) {
+		return 1.0;
+	}
+	x *= Pi;
+	return std::sin(x) / x;
+}
+
+
+// Modified Bessel function of the first kind, for the Kaiser window.
+static double BesselI0(double x) {
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 32; ++k) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+
+static double GetFilterRadius(eResampleFilter filter) {
+	return filter == eResampleFilter::BOX ? 0.5 : 3.0;
+}
+
+
+// x is the distance from the center in destination pixels.
+static double EvaluateFilter(eResampleFilter filter, double x) {
+	switch (filter) {
+		case eResampleFilter::BOX:
+			return x >= -0.5 && x < 0.5 ? 1.0 : 0.0;
+		case eResampleFilter::KAISER:
+		{
+			constexpr double radius = 3.0;
+			constexpr double alpha = 4.0;
+			double t = x / radius;
+			return t * t < 1.0 ? Sinc(x) * BesselI0(alpha * std::sqrt(1.0 - t * t)) / BesselI0(alpha) : 0.0;
+		}
+		case eResampleFilter::LANCZOS:
+			return std::abs(x) < 3.0 ? Sinc(x) * Sinc(x / 3.0) : 0.0;
+	}
+	return 0.0;
+}
+
+
+// Weights of the source pixels for each destination pixel along one axis.
+// Samples outside the image are folded onto the edge, so every source index is valid.
+struct FilterTable {
+	std::vector<size_t> first; // first source pixel of each destination pixel
+	std::vector<size_t> offset; // offset into weights of each destination pixel
+	std::vector<size_t> count; // number of weights of each destination pixel
+	std::vector<float> weights;
+};
+
+
+static FilterTable ComputeFilterTable(eResampleFilter filter, size_t sourceSize, size_t destinationSize) {
+	const double scale = double(sourceSize) / double(destinationSize);
+	const double stretch = std::max(1.0, scale); // widen the filter when minifying
+	const double radius = GetFilterRadius(filter) * stretch;
+
+	FilterTable table;
+	table.first.resize(destinationSize);
+	table.offset.resize(destinationSize);
+	table.count.resize(destinationSize);
+
+	std::vector<double> weights;
+	for (size_t d = 0; d < destinationSize; ++d) {
+		const double center = (d + 0.5) * scale;
+		const ptrdiff_t low = (ptrdiff_t)std::floor(center - radius);
+		const ptrdiff_t high = (ptrdiff_t)std::ceil(center + radius);
+		const ptrdiff_t windowBegin = std::max(low, ptrdiff_t(0));
+		const ptrdiff_t windowEnd = std::min(high + 1, ptrdiff_t(sourceSize));
+
+		weights.assign(windowEnd - windowBegin, 0.0);
+		ptrdiff_t first = windowEnd, last = windowBegin - 1;
+		double sum = 0.0;
+		for (ptrdiff_t i = low; i <= high; ++i) {
+			double weight = EvaluateFilter(filter, (i + 0.5 - center) / stretch);
+			if (weight == 0.0) {
+				continue;
+			}
+			ptrdiff_t clamped = std::min(std::max(i, windowBegin), windowEnd - 1);
+			weights[clamped - windowBegin] += weight;
+			first = std::min(first, clamped);
+			last = std::max(last, clamped);
+			sum += weight;
+		}
+		if (last < first || sum == 0.0) { // not possible with the above filters, but fall back to nearest
+			first = last = std::min(std::max(ptrdiff_t(center), windowBegin), windowEnd - 1);
+			weights[first - windowBegin] = sum = 1.0;
+		}
+
+		table.first[d] = (size_t)first;
+		table.offset[d] = table.weights.size();
+		table.count[d] = size_t(last - first + 1);
+		for (ptrdiff_t i = first; i <= last; ++i) {
+			table.weights.push_back(float(weights[i - windowBegin] / sum));
+		}
+	}
+
+	return table;
+}
+
+
+//------------------------------------------------------------------------------
+// Filter passes
+//------------------------------------------------------------------------------
+
+static void FilterRowHorizontal(const float* source, float* destination, int channelCount, const FilterTable& table) {
+	const size_t width = table.first.size();
+	if (channelCount == 4) {
+		for (size_t d = 0; d < width; ++d) {
+			const float* weights = table.weights.data() + table.offset[d];
+			const float* pixel = source + table.first[d] * 4;
+			__m128 sum = _mm_setzero_ps();
+			for (size_t k = 0; k < table.count[d]; ++k, pixel += 4) {
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(pixel), _mm_set1_ps(weights[k])));
+			}
+			_mm_storeu_ps(destination + d * 4, sum);
+		}
+	}
+	else {
+		for (size_t d = 0; d < width; ++d) {
+			const float* weights = table.weights.data() + table.offset[d];
+			for (int c = 0; c < channelCount; ++c) {
+				const float* value = source + table.first[d] * channelCount + c;
+				float sum = 0.0f;
+				for (size_t k = 0; k < table.count[d]; ++k, value += channelCount) {
+					sum += *value * weights[k];
+				}
+				destination[d * channelCount + c] = sum;
+			}
+		}
+	}
+}
+
+
+// Adds the weighted source row to the destination row.
+static void AccumulateRow(const float* source, float* destination, size_t numValues, float weight) {
+	const __m128 weightVector = _mm_set1_ps(weight);
+	size_t i = 0;
+	for (; i + 4 <= numValues; i += 4) {
+		__m128 sum = _mm_add_ps(_mm_loadu_ps(destination + i), _mm_mul_ps(_mm_loadu_ps(source + i), weightVector));
+		_mm_storeu_ps(destination + i, sum);
+	}
+	for (; i < numValues; ++i) {
+		destination[i] += source[i] * weight;
+	}
+}
+
+
+//------------------------------------------------------------------------------
+// Encoding
+//------------------------------------------------------------------------------
+
+static float SrgbToLinear(float value) {
+	return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+
+static float LinearToSrgb(float value) {
+	return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+
+static float Clamp01(float value) {
+	return std::min(std::max(value, 0.0f), 1.0f);
+}
+
+
+// To encode, values are put into buckets by their exponent and the top 7 bits of the mantissa. A bucket is
+// so narrow that its values encode to its first value or one more, so one comparison with the midpoint
+// between the two gives the result. Values below the first bucket all encode to 0.
+struct SrgbTables {
+	static constexpr uint32_t FirstBucketBits = 0x39000000; // 2^-13
+	static constexpr uint32_t BucketShift = 16;
+	static constexpr int NumBuckets = (0x3F800000 - FirstBucketBits) >> BucketShift; // up to 1.0f
+
+	SrgbTables() {
+		for (int i = 0; i < 256; ++i) {
+			decode[i] = SrgbToLinear(i / 255.0f);
+		}
+		for (int i = 0; i < 255; ++i) {
+			midpoints[i] = SrgbToLinear((i + 0.5f) / 255.0f);
+		}
+		midpoints[255] = 2.0f; // clamped values never reach it
+		for (int bucket = 0; bucket < NumBuckets; ++bucket) {
+			uint32_t bits = FirstBucketBits + (uint32_t(bucket) << BucketShift);
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			bucketStarts[bucket] = uint8_t(std::upper_bound(midpoints, midpoints + 255, value) - midpoints);
+		}
+	}
+
+	uint8_t Encode(float value) const {
+		value = Clamp01(value);
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		if (bits < FirstBucketBits) {
+			return 0;
+		}
+		int bucket = std::min(int((bits - FirstBucketBits) >> BucketShift), NumBuckets - 1);
+		uint8_t encoded = bucketStarts[bucket];
+		return encoded + (value >= midpoints[encoded]);
+	}
+
+	float decode[256];
+	float midpoints[256]; // between the encoded value and the next
+	uint8_t bucketStarts[NumBuckets];
+};
+
+
+static const SrgbTables& GetSrgbTables() {
+	static const SrgbTables tables;
+	return tables;
+}
+
+
+// Channels below srgbChannels are sRGB encoded, the rest are linear.
+template <class T>
+static void DecodeRow(const T* source, float* destination, size_t width, int channelCount, int srgbChannels) {
+	const float max = std::is_same<T, float>::value ? 1.0f : float(std::numeric_limits<T>::max());
+	for (size_t x = 0; x < width; ++x, source += channelCount, destination += channelCount) {
+		for (int c = 0; c < channelCount; ++c) {
+			float value = float(source[c]) / max;
+			destination[c] = c < srgbChannels ? SrgbToLinear(value) : value;
+		}
+	}
+}
+
+
+static void DecodeRow(const uint8_t* source, float* destination, size_t width, int channelCount, int srgbChannels) {
+	const size_t numValues = width * channelCount;
+	if (srgbChannels == 0) {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128 max = _mm_set1_ps(255.0f);
+		size_t i = 0;
+		for (; i + 16 <= numValues; i += 16) {
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+			__m128i low = _mm_unpacklo_epi8(bytes, zero);
+			__m128i high = _mm_unpackhi_epi8(bytes, zero);
+			_mm_storeu_ps(destination + i, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), max));
+			_mm_storeu_ps(destination + i + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), max));
+			_mm_storeu_ps(destination + i + 8, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), max));
+			_mm_storeu_ps(destination + i + 12, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), max));
+		}
+		for (; i < numValues; ++i) {
+			destination[i] = source[i] / 255.0f;
+		}
+		return;
+	}
+
+	const float* table = GetSrgbTables().decode;
+	for (size_t x = 0; x < width; ++x, source += channelCount, destination += channelCount) {
+		for (int c = 0; c < channelCount; ++c) {
+			destination[c] = c < srgbChannels ? table[source[c]] : source[c] / 255.0f;
+		}
+	}
+}
+
+
+template <class T>
+static void EncodeRow(const float* source, T* destination, size_t width, int channelCount, int srgbChannels) {
+	const float max = float(std::numeric_limits<T>::max());
+	for (size_t x = 0; x < width; ++x, source += channelCount, destination += channelCount) {
+		for (int c = 0; c < channelCount; ++c) {
+			float value = Clamp01(source[c]);
+			destination[c] = T(std::nearbyint((c < srgbChannels ? LinearToSrgb(value) : value) * max));
+		}
+	}
+}
+
+
+static void EncodeRow(const float* source, float* destination, size_t width, int channelCount, int srgbChannels) {
+	if (srgbChannels == 0) {
+		std::memcpy(destination, source, width * channelCount * sizeof(float));
+		return;
+	}
+	for (size_t x = 0; x < width; ++x, source += channelCount, destination += channelCount) {
+		for (int c = 0; c < channelCount; ++c) {
+			destination[c] = c < srgbChannels ? LinearToSrgb(source[c]) : source[c];
+		}
+	}
+}
+
+
+// Rounds to nearest like the scalar path, as that is the default rounding mode.
+static __m128i EncodeU8x4(const float* source) {
+	__m128 clamped = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+	return _mm_cvtps_epi32(_mm_mul_ps(clamped, _mm_set1_ps(255.0f)));
+}
+
+
+static void EncodeRow(const float* source, uint8_t* destination, size_t width, int channelCount, int srgbChannels) {
+	const size_t numValues = width * channelCount;
+	if (srgbChannels == 0) {
+		size_t i = 0;
+		for (; i + 16 <= numValues; i += 16) {
+			__m128i low = _mm_packs_epi32(EncodeU8x4(source + i), EncodeU8x4(source + i + 4));
+			__m128i high = _mm_packs_epi32(EncodeU8x4(source + i + 8), EncodeU8x4(source + i + 12));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(low, high));
+		}
+		for (; i < numValues; ++i) {
+			destination[i] = uint8_t(std::nearbyint(Clamp01(source[i]) * 255.0f));
+		}
+		return;
+	}
+
+	const SrgbTables& tables = GetSrgbTables();
+	for (size_t x = 0; x < width; ++x, source += channelCount, destination += channelCount) {
+		for (int c = 0; c < channelCount; ++c) {
+			destination[c] = c < srgbChannels ? tables.Encode(source[c]) : uint8_t(std::nearbyint(Clamp01(source[c]) * 255.0f));
+		}
+	}
+}
+
+
+static void DecodeRow(const uint8_t* row, float* destination, size_t width, eChannelType type, int channelCount, int srgbChannels) {
+	switch (type) {
+		case eChannelType::INT8: DecodeRow(row, destination, width, channelCount, srgbChannels); break;
+		case eChannelType::INT16: DecodeRow(reinterpret_cast<const uint16_t*>(row), destination, width, channelCount, srgbChannels); break;
+		case eChannelType::FLOAT: DecodeRow(reinterpret_cast<const float*>(row), destination, width, channelCount, srgbChannels); break;
+		default: assert(false);
+	}
+}
+
+
+static void EncodeRow(const float* source, uint8_t* row, size_t width, eChannelType type, int channelCount, int srgbChannels) {
+	switch (type) {
+		case eChannelType::INT8: EncodeRow(source, row, width, channelCount, srgbChannels); break;
+		case eChannelType::INT16: EncodeRow(source, reinterpret_cast<uint16_t*>(row), width, channelCount, srgbChannels); break;
+		case eChannelType::FLOAT: EncodeRow(source, reinterpret_cast<float*>(row), width, channelCount, srgbChannels); break;
+		default: assert(false);
+	}
+}
+
+
+static size_t CountCoveredPixels(const float* row, size_t width, int channelCount, int alphaChannel, float reference) {
+	size_t numCovered = 0;
+	for (size_t x = 0; x < width; ++x) {
+		numCovered += row[x * channelCount + alphaChannel] > reference;
+	}
+	return numCovered;
+}
+
+
+//------------------------------------------------------------------------------
+// ImageResampler
+//------------------------------------------------------------------------------
+
+FloatImage::FloatImage(size_t width, size_t height, int channelCount)
+	: width(width), height(height), channelCount(channelCount), pixels(width * height * channelCount)
+{}
+
+
+ImageResampler::ImageResampler(const ResampleDesc& desc)
+	: m_desc(desc)
+{}
+
+
+Image ImageResampler::Resize(const Image& source, size_t width, size_t height) const {
+	FloatImage resized = Resize(source.GetWidth(), source.GetHeight(), (int)source.GetChannelCount(), GetRowReader(source), width, height);
+	return Encode(resized, source.GetType());
+}
+
+
+std::vector<Image> ImageResampler::GenerateMipChain(const Image& base) const {
+	std::vector<Image> levels;
+	for (const FloatImage& level : GenerateMipChain(base.GetWidth(), base.GetHeight(), (int)base.GetChannelCount(), GetRowReader(base))) {
+		levels.push_back(Encode(level, base.GetType()));
+	}
+	return levels;
+}
+
+
+FloatImage ImageResampler::Resize(const FloatImage& source, size_t width, size_t height) const {
+	return Resize(source.width, source.height, source.channelCount, GetRowReader(source), width, height);
+}
+
+
+std::vector<FloatImage> ImageResampler::GenerateMipChain(const FloatImage& base) const {
+	return GenerateMipChain(base.width, base.height, base.channelCount, GetRowReader(base));
+}
+
+
+FloatImage ImageResampler::Decode(const void* pixels, size_t bytesPerRow, size_t width, size_t height, eChannelType type, int channelCount) const {
+	if (type == eChannelType::INT32) {
+		throw InvalidArgumentException("32 bit integer images cannot be resampled.");
+	}
+
+	FloatImage image(width, height, channelCount);
+	const int srgbChannels = GetSrgbChannelCount(channelCount);
+	for (size_t y = 0; y < height; ++y) {
+		DecodeRow(static_cast<const uint8_t*>(pixels) + y * bytesPerRow, image.Row(y), width, type, channelCount, srgbChannels);
+	}
+	return image;
+}
+
+
+void ImageResampler::Encode(const FloatImage& image, void* pixels, size_t bytesPerRow, eChannelType type) const {
+	if (type == eChannelType::INT32) {
+		throw InvalidArgumentException("32 bit integer images cannot be resampled.");
+	}
+
+	const int srgbChannels = GetSrgbChannelCount(image.channelCount);
+	for (size_t y = 0; y < image.height; ++y) {
+		EncodeRow(image.Row(y), static_cast<uint8_t*>(pixels) + y * bytesPerRow, image.width, type, image.channelCount, srgbChannels);
+	}
+}
+
+
+float ImageResampler::GetAlphaCoverage(const FloatImage& image, int alphaChannel, float reference) {
+	size_t numCovered = 0;
+	for (size_t y = 0; y < image.height; ++y) {
+		numCovered += CountCoveredPixels(image.Row(y), image.width, image.channelCount, alphaChannel, reference);
+	}
+	return image.width * image.height > 0 ? float(numCovered) / float(image.width * image.height) : 0.0f;
+}
+
+
+FloatImage ImageResampler::Resize(size_t sourceWidth, size_t sourceHeight, int channelCount, const RowReader& readRow, size_t width, size_t height) const {
+	if (width == 0 || height == 0 || sourceWidth == 0 || sourceHeight == 0) {
+		throw InvalidArgumentException("Images must not be empty.");
+	}
+
+	const FilterTable horizontal = ComputeFilterTable(m_desc.filter, sourceWidth, width);
+	const FilterTable vertical = ComputeFilterTable(m_desc.filter, sourceHeight, height);
+
+	// Horizontal pass on all source rows, then vertical pass.
+	FloatImage intermediate(width, sourceHeight, channelCount);
+	ParallelFor(sourceHeight, GetNumThreads(intermediate.pixels.size()), [&](size_t begin, size_t end) {
+		std::vector<float> scratch(sourceWidth * channelCount);
+		for (size_t y = begin; y < end; ++y) {
+			FilterRowHorizontal(readRow(y, scratch.data()), intermediate.Row(y), channelCount, horizontal);
+		}
+	});
+
+	FloatImage result(width, height, channelCount);
+	ParallelFor(height, GetNumThreads(result.pixels.size()), [&](size_t begin, size_t end) {
+		const size_t rowSize = width * channelCount;
+		for (size_t y = begin; y < end; ++y) {
+			const float* weights = vertical.weights.data() + vertical.offset[y];
+			for (size_t k = 0; k < vertical.count[y]; ++k) {
+				AccumulateRow(intermediate.Row(vertical.first[y] + k), result.Row(y), rowSize, weights[k]);
+			}
+		}
+	});
+
+	return result;
+}
+
+
+std::vector<FloatImage> ImageResampler::GenerateMipChain(size_t baseWidth, size_t baseHeight, int channelCount, const RowReader& readRow) const {
+	// Each level is filtered from the one above, before adjusting alpha.
+	std::vector<FloatImage> levels;
+	size_t width = baseWidth, height = baseHeight;
+	while (width > 1 || height > 1) {
+		width = std::max<size_t>(1, width / 2);
+		height = std::max<size_t>(1, height / 2);
+		if (levels.empty()) {
+			levels.push_back(Resize(baseWidth, baseHeight, channelCount, readRow, width, height));
+		}
+		else {
+			levels.push_back(Resize(levels.back(), width, height));
+		}
+	}
+
+	if (m_desc.alphaCoverageReference != 0.0f && HasAlpha(channelCount)) {
+		std::vector<float> scratch(baseWidth * channelCount);
+		size_t numCovered = 0;
+		for (size_t y = 0; y < baseHeight; ++y) {
+			numCovered += CountCoveredPixels(readRow(y, scratch.data()), baseWidth, channelCount, m_desc.alphaChannel, m_desc.alphaCoverageReference);
+		}
+		const float coverage = float(numCovered) / float(baseWidth * baseHeight);
+		for (auto& level : levels) {
+			ScaleAlphaToCoverage(level, coverage);
+		}
+	}
+
+	return levels;
+}
+
+
+auto ImageResampler::GetRowReader(const FloatImage& image) const -> RowReader {
+	return [&image](size_t y, float*) {
+		return image.Row(y);
+	};
+}
+
+
+auto ImageResampler::GetRowReader(const Image& image) const -> RowReader {
+	const uint8_t* pixels = static_cast<const uint8_t*>(image.GetData());
+	const size_t bytesPerRow = image.GetBytesPerRow();
+	const size_t width = image.GetWidth();
+	const int channelCount = (int)image.GetChannelCount();
+	const eChannelType type = image.GetType();
+	const int srgbChannels = GetSrgbChannelCount(channelCount);
+	if (type == eChannelType::INT32) {
+		throw InvalidArgumentException("32 bit integer images cannot be resampled.");
+	}
+
+	return [=](size_t y, float* scratch) {
+		DecodeRow(pixels + y * bytesPerRow, scratch, width, type, channelCount, srgbChannels);
+		return const_cast<const float*>(scratch);
+	};
+}
+
+
+Image ImageResampler::Encode(const FloatImage& image, eChannelType type) const {
+	Image result;
+	result.Create(image.width, image.height, type, image.channelCount);
+	Encode(image, result.GetData(), result.GetBytesPerRow(), type);
+	return result;
+}
+
+
+// Finds the alpha threshold that gives the requested coverage, and scales alpha so that
+// the threshold moves to the reference value.
+void ImageResampler::ScaleAlphaToCoverage(FloatImage& image, float coverage) const {
+	const int alphaChannel = m_desc.alphaChannel;
+	float low = 0.0f, high = 1.0f;
+	for (int i = 0; i < 16; ++i) {
+		float threshold = (low + high) / 2;
+		if (GetAlphaCoverage(image, alphaChannel, threshold) > coverage) {
+			low = threshold;
+		}
+		else {
+			high = threshold;
+		}
+	}
+
+	const float scale = m_desc.alphaCoverageReference / std::max((low + high) / 2, 1e-6f);
+	const size_t numPixels = image.width * image.height;
+	for (size_t i = 0; i < numPixels; ++i) {
+		float& alpha = image.pixels[i * image.channelCount + alphaChannel];
+		alpha = Clamp01(alpha * scale);
+	}
+}
+
+
+unsigned ImageResampler::GetNumThreads(size_t numValues) const {
+	constexpr size_t MinValuesPerThread = 64 * 1024; // small levels are not worth starting threads for
+	return (unsigned)std::min<size_t>(asset::GetNumThreads(m_desc.numThreads), std::max<size_t>(1, numValues / MinValuesPerThread));
+}
+
+
+bool ImageResampler::HasAlpha(int channelCount) const {
+	return m_desc.alphaChannel >= 0 && m_desc.alphaChannel < channelCount;
+}
+
+
+int ImageResampler::GetSrgbChannelCount(int channelCount) const {
+	return !m_desc.srgb ? 0 : HasAlpha(channelCount) ? m_desc.alphaChannel : channelCount;
+}
+
+
+}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Image.hpp"
+
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+
+namespace inl {
+namespace asset {
+
+
+enum class eResampleFilter {
+	BOX, // average of the covered pixels, fast but aliases
+	KAISER, // Kaiser windowed sinc, sharp with little ringing
+	LANCZOS, // Lanczos windowed sinc, sharpest but rings more
+};
+
+
+struct ResampleDesc {
+	eResampleFilter filter = eResampleFilter::KAISER;
+
+	/// <summary> The color channels are sRGB encoded, they are filtered in linear space. </summary>
+	bool srgb = false;
+
+	/// <summary> Index of the alpha channel. Alpha is never sRGB encoded. Ignored if the image has fewer channels. </summary>
+	int alphaChannel = 3;
+
+	/// <summary> If not 0, alpha of the mip levels is scaled so that the same fraction of pixels have alpha above
+	/// this value as on the base level. Keeps alpha tested geometry from thinning out in the distance. </summary>
+	float alphaCoverageReference = 0.0f;
+
+	/// <summary> Number of threads to use, 0 for the number of cores. </summary>
+	unsigned numThreads = 0;
+};
+
+
+/// <summary> An image with float channels. Rows are tightly packed. </summary>
+struct FloatImage {
+	FloatImage() = default;
+	FloatImage(size_t width, size_t height, int channelCount);
+
+	float* Row(size_t y) { return pixels.data() + y * width * channelCount; }
+	const float* Row(size_t y) const { return pixels.data() + y * width * channelCount; }
+
+	size_t width = 0;
+	size_t height = 0;
+	int channelCount = 0;
+	std::vector<float> pixels;
+};
+
+
+/// <summary>
+/// Resizes images and generates mip chains with separable filters.
+/// Rows are split between threads, and 4 channel pixels are filtered with SIMD.
+/// </summary>
+/// <remarks>
+/// 32 bit integer images are not supported.
+/// </remarks>
+class ImageResampler {
+public:
+	explicit ImageResampler(const ResampleDesc& desc = {});
+
+	/// <summary> Returns the image resized to the given size, in the same format. </summary>
+	Image Resize(const Image& source, size_t width, size_t height) const;
+
+	/// <summary> Returns the mip levels below the base level, down to 1x1 pixels. </summary>
+	std::vector<Image> GenerateMipChain(const Image& base) const;
+
+	FloatImage Resize(const FloatImage& source, size_t width, size_t height) const;
+	std::vector<FloatImage> GenerateMipChain(const FloatImage& base) const;
+
+	/// <summary> Converts pixels to linear float channels. Normalized integers are mapped to [0, 1]. </summary>
+	FloatImage Decode(const void* pixels, size_t bytesPerRow, size_t width, size_t height, eChannelType type, int channelCount) const;
+
+	/// <summary> Inverse of <see cref="Decode"/>. Normalized integers are clamped and rounded to nearest. </summary>
+	void Encode(const FloatImage& image, void* pixels, size_t bytesPerRow, eChannelType type) const;
+
+	/// <summary> Returns the fraction of pixels which have alpha above the reference value. </summary>
+	static float GetAlphaCoverage(const FloatImage& image, int alphaChannel, float reference);
+
+	const ResampleDesc& GetDesc() const { return m_desc; }
+private:
+	/// <summary> Returns row y of the source as floats. Encoded rows are decoded into scratch. </summary>
+	using RowReader = std::function<const float*(size_t y, float* scratch)>;
+
+	FloatImage Resize(size_t sourceWidth, size_t sourceHeight, int channelCount, const RowReader& readRow, size_t width, size_t height) const;
+	std::vector<FloatImage> GenerateMipChain(size_t baseWidth, size_t baseHeight, int channelCount, const RowReader& readRow) const;
+	RowReader GetRowReader(const FloatImage& image) const;
+	RowReader GetRowReader(const Image& image) const;
+
+	Image Encode(const FloatImage& image, eChannelType type) const;
+	void ScaleAlphaToCoverage(FloatImage& image, float coverage) const;
+	unsigned GetNumThreads(size_t numValues) const;
+	bool HasAlpha(int channelCount) const;
+	int GetSrgbChannelCount(int channelCount) const;
+private:
+	ResampleDesc m_desc;
+};
+
+
+}
+}
\ No newline at end of file
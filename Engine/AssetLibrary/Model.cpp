@@ -1,4 +1,5 @@
 #include "Model.hpp"
+#include "VirtualIOSystem.hpp"
 
 #include <BaseLibrary/Exception/Exception.hpp>
 
@@ -6,6 +7,11 @@
 #include <assimp/scene.h>
 #include <assimp/mesh.h>
 
+#include <emmintrin.h>
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
 namespace inl {
 namespace asset {
 
@@ -48,6 +54,40 @@ static Mat44 GetAbsoluteTransform(const aiNode* node) {
 }
 
 
+// Assimp transforms column vectors, the engine row vectors.
+static Mat44 ToRowVectorTransform(const aiMatrix4x4& m) {
+	Mat44 result;
+	for (int i = 0; i < 4; ++i) {
+		for (int j = 0; j < 4; ++j) {
+			result(i, j) = m[j][i];
+		}
+	}
+	return result;
+}
+
+
+static Mat44 GetGlobalRowVectorTransform(const aiNode* node) {
+	Mat44 result = Mat44::Identity();
+	for (; node != nullptr; node = node->mParent) {
+		result = result * ToRowVectorTransform(node->mTransformation);
+	}
+	return result;
+}
+
+
+// Swaps the axes of a row vector as the coordinate system layout says.
+static Mat44 GetAxesTransform(CoordSysLayout csys) {
+	const Vec4 axes[3] = { GetAxis(csys.x), GetAxis(csys.y), GetAxis(csys.z) };
+	Mat44 result = Mat44::Identity();
+	for (int i = 0; i < 3; ++i) {
+		for (int j = 0; j < 3; ++j) {
+			result(i, j) = axes[i][j];
+		}
+	}
+	return result;
+}
+
+
 Vec4 GetAxis(AxisDir dir) {
 	switch (dir) {
 	case AxisDir::POS_X:
@@ -80,10 +120,35 @@ Model::Model(const std::string & filename) {
 	// "aiProcess_OptimizeGraph" will collapse nodes if possible.
 	// This flag is used to have ideally all submeshes in a single node.
 	m_scene = m_importer->ReadFile(filename, aiProcessPreset_TargetRealtime_Quality | aiProcess_OptimizeGraph);
+	Init(filename);
+}
 
+
+Model::Model(const void* data, size_t size, const std::string& formatHint) {
+	m_importer.reset(new Assimp::Importer);
+	m_scene = m_importer->ReadFileFromMemory(data, size, aiProcessPreset_TargetRealtime_Quality | aiProcess_OptimizeGraph, formatHint.c_str());
+	Init("<memory>." + formatHint);
+}
+
+
+Model::Model(const VirtualFileSystem& fileSystem, const std::string& path)
+	: Model(new VirtualIOSystem(fileSystem), path)
+{}
+
+
+Model::Model(Assimp::IOSystem* ioSystem, const std::string& path) {
+	m_importer.reset(new Assimp::Importer);
+	// The importer takes ownership of the IO system.
+	m_importer->SetIOHandler(ioSystem);
+	m_scene = m_importer->ReadFile(path, aiProcessPreset_TargetRealtime_Quality | aiProcess_OptimizeGraph);
+	Init(path);
+}
+
+
+void Model::Init(const std::string& name) {
 	if (m_scene == nullptr) {
 		const std::string msg(m_importer->GetErrorString());
-		throw RuntimeException("Could not load model \"" + filename + "\".",  msg);
+		throw RuntimeException("Could not load model \"" + name + "\".",  msg);
 	}
 
 	if (!m_scene->HasMeshes()) {
@@ -98,6 +163,53 @@ Model::Model(const std::string & filename) {
 
 	m_transform = GetAbsoluteTransform(node);
 	m_invTrTransform = m_transform.Inverse().Transpose();
+
+	FindBones();
+}
+
+
+void Model::FindBones() {
+	// The nodes that vertices are skinned to.
+	std::unordered_set<const aiNode*> skinnedNodes;
+	for (unsigned meshID = 0; meshID < m_scene->mNumMeshes; ++meshID) {
+		const aiMesh* mesh = m_scene->mMeshes[meshID];
+		for (unsigned boneID = 0; boneID < mesh->mNumBones; ++boneID) {
+			const aiNode* node = m_scene->mRootNode->FindNode(mesh->mBones[boneID]->mName);
+			if (node == nullptr) {
+				throw InvalidArgumentException("Model has a bone without a node.", mesh->mBones[boneID]->mName.C_Str());
+			}
+			skinnedNodes.insert(node);
+		}
+	}
+
+	// Nodes between two skinned nodes are bones too, so that the hierarchy is kept.
+	std::unordered_set<const aiNode*> boneNodes = skinnedNodes;
+	for (const aiNode* node : skinnedNodes) {
+		std::vector<const aiNode*> path;
+		for (const aiNode* ancestor = node->mParent; ancestor != nullptr; ancestor = ancestor->mParent) {
+			if (skinnedNodes.count(ancestor) > 0) {
+				boneNodes.insert(path.begin(), path.end());
+				break;
+			}
+			path.push_back(ancestor);
+		}
+	}
+
+	// Depth first, so that parents come before their children.
+	m_boneNodes.clear();
+	m_boneIndices.clear();
+	std::vector<const aiNode*> stack = { m_scene->mRootNode };
+	while (!stack.empty()) {
+		const aiNode* node = stack.back();
+		stack.pop_back();
+		if (boneNodes.count(node) > 0) {
+			m_boneIndices[node->mName.C_Str()] = (uint32_t)m_boneNodes.size();
+			m_boneNodes.push_back(node);
+		}
+		for (unsigned i = node->mNumChildren; i-- > 0;) {
+			stack.push_back(node->mChildren[i]);
+		}
+	}
 }
 
 
@@ -107,6 +219,179 @@ unsigned Model::SubmeshCount() const {
 }
 
 
+size_t Model::GetVertexCount(unsigned submeshID) const {
+	assert(submeshID < m_scene->mNumMeshes);
+	return m_scene->mMeshes[submeshID]->mNumVertices;
+}
+
+
+size_t Model::GetVertexCount() const {
+	size_t count = 0;
+	for (unsigned submeshID = 0; submeshID < m_scene->mNumMeshes; ++submeshID) {
+		count += m_scene->mMeshes[submeshID]->mNumVertices;
+	}
+	return count;
+}
+
+
+Model::VertexTransforms Model::GetVertexTransforms(CoordSysLayout csys) const {
+	auto xAxis = GetAxis(csys.x);
+	auto yAxis = GetAxis(csys.y);
+	auto zAxis = GetAxis(csys.z);
+	const Mat44 posTransform =
+		m_transform *
+		Mat44(xAxis.x, yAxis.x, zAxis.x, 0,
+			  xAxis.y, yAxis.y, zAxis.y, 0,
+			  xAxis.z, yAxis.z, zAxis.z, 0,
+			  0, 0, 0, 1);
+
+	// Positions are transformed as posTransform*(p|1), normals as (n|1)*normalTransform.
+	// The kernels only do the latter, so the position transform is transposed.
+	VertexTransforms transforms;
+	transforms.position = posTransform.Transposed();
+	transforms.normal = posTransform.Inverse().Transpose();
+	transforms.boneIndices = &m_boneIndices;
+	return transforms;
+}
+
+
+void Model::TransformVectors(const aiVector3D* input, size_t count, const Mat44& transform, bool divideByW, void* output, size_t outputStride) {
+	static_assert(sizeof(aiVector3D) == 3 * sizeof(float), "Vectors must be tightly packed.");
+
+	float m[4][4];
+	for (int i = 0; i < 4; ++i) {
+		for (int j = 0; j < 4; ++j) {
+			m[i][j] = transform(i, j);
+		}
+	}
+	uint8_t* outputBytes = static_cast<uint8_t*>(output);
+
+	// Four vectors at a time, deinterleaved into xxxx, yyyy and zzzz.
+	__m128 columns[4][4];
+	for (int i = 0; i < 4; ++i) {
+		for (int j = 0; j < 4; ++j) {
+			columns[i][j] = _mm_set1_ps(m[i][j]);
+		}
+	}
+	const float* inputFloats = reinterpret_cast<const float*>(input);
+	size_t index = 0;
+	for (; index + 4 <= count; index += 4) {
+		__m128 a = _mm_loadu_ps(inputFloats + 3 * index); // x0 y0 z0 x1
+		__m128 b = _mm_loadu_ps(inputFloats + 3 * index + 4); // y1 z1 x2 y2
+		__m128 c = _mm_loadu_ps(inputFloats + 3 * index + 8); // z2 x3 y3 z3
+		__m128 x = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 3, 0)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 0, 2, 1)), _MM_SHUFFLE(3, 1, 1, 0));
+		__m128 y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 0, 3, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+		__m128 z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+
+		__m128 result[4];
+		for (int j = 0; j < 4; ++j) {
+			result[j] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, columns[0][j]), _mm_mul_ps(y, columns[1][j])), _mm_mul_ps(z, columns[2][j])), columns[3][j]);
+		}
+		if (divideByW) {
+			for (int j = 0; j < 3; ++j) {
+				result[j] = _mm_div_ps(result[j], result[3]);
+			}
+		}
+
+		_MM_TRANSPOSE4_PS(result[0], result[1], result[2], result[3]);
+		for (int i = 0; i < 4; ++i) {
+			alignas(16) float vector[4];
+			_mm_store_ps(vector, result[i]);
+			std::memcpy(outputBytes + (index + i) * outputStride, vector, 3 * sizeof(float));
+		}
+	}
+
+	// Remainder, with the same operations in the same order.
+	for (; index < count; ++index) {
+		const float v[3] = { input[index].x, input[index].y, input[index].z };
+		float result[4];
+		for (int j = 0; j < 4; ++j) {
+			result[j] = v[0] * m[0][j] + v[1] * m[1][j] + v[2] * m[2][j] + m[3][j];
+		}
+		if (divideByW) {
+			for (int j = 0; j < 3; ++j) {
+				result[j] /= result[3];
+			}
+		}
+		std::memcpy(outputBytes + index * outputStride, result, 3 * sizeof(float));
+	}
+}
+
+
+void Model::CopyTexCoords(const aiVector3D* input, size_t count, void* output, size_t outputStride) {
+	uint8_t* outputBytes = static_cast<uint8_t*>(output);
+	for (size_t index = 0; index < count; ++index) {
+		const float texCoord[2] = { input[index].x, input[index].y };
+		std::memcpy(outputBytes + index * outputStride, texCoord, sizeof(texCoord));
+	}
+}
+
+
+void Model::CopyColors(const aiColor4D* input, size_t count, void* output, size_t outputStride) {
+	uint8_t* outputBytes = static_cast<uint8_t*>(output);
+	for (size_t index = 0; index < count; ++index) {
+		const float color[3] = { input[index].r, input[index].g, input[index].b };
+		std::memcpy(outputBytes + index * outputStride, color, sizeof(color));
+	}
+}
+
+
+void Model::CopyBoneInfluences(const aiMesh* mesh, const std::unordered_map<std::string, uint32_t>& boneIndices, size_t firstVertex, size_t count, void* indicesOutput, void* weightsOutput, size_t outputStride) {
+	constexpr int MaxInfluences = Skeleton::MaxInfluences;
+
+	// Assimp lists the weights by bone, they are gathered by vertex, keeping the largest ones.
+	std::vector<uint32_t> indices(count * MaxInfluences, 0);
+	std::vector<float> weights(count * MaxInfluences, 0.0f);
+	for (unsigned boneID = 0; boneID < mesh->mNumBones; ++boneID) {
+		const aiBone* bone = mesh->mBones[boneID];
+		const uint32_t boneIndex = boneIndices.at(bone->mName.C_Str());
+		for (unsigned weightID = 0; weightID < bone->mNumWeights; ++weightID) {
+			const aiVertexWeight& weight = bone->mWeights[weightID];
+			if (weight.mVertexId < firstVertex || weight.mVertexId >= firstVertex + count) {
+				continue;
+			}
+			const size_t first = (weight.mVertexId - firstVertex) * MaxInfluences;
+			size_t smallest = first;
+			for (size_t i = first + 1; i < first + MaxInfluences; ++i) {
+				if (weights[i] < weights[smallest]) {
+					smallest = i;
+				}
+			}
+			if (weight.mWeight > weights[smallest]) {
+				weights[smallest] = weight.mWeight;
+				indices[smallest] = boneIndex;
+			}
+		}
+	}
+
+	uint8_t* indicesBytes = static_cast<uint8_t*>(indicesOutput);
+	uint8_t* weightsBytes = static_cast<uint8_t*>(weightsOutput);
+	for (size_t index = 0; index < count; ++index) {
+		float* vertexWeights = &weights[index * MaxInfluences];
+		float sum = 0.0f;
+		for (int i = 0; i < MaxInfluences; ++i) {
+			sum += vertexWeights[i];
+		}
+		if (sum > 0.0f) {
+			for (int i = 0; i < MaxInfluences; ++i) {
+				vertexWeights[i] /= sum;
+			}
+		}
+		else {
+			// Vertices without weights follow the first bone.
+			vertexWeights[0] = 1.0f;
+		}
+
+		if (indicesBytes != nullptr) {
+			std::memcpy(indicesBytes + index * outputStride, &indices[index * MaxInfluences], MaxInfluences * sizeof(uint32_t));
+		}
+		if (weightsBytes != nullptr) {
+			std::memcpy(weightsBytes + index * outputStride, vertexWeights, MaxInfluences * sizeof(float));
+		}
+	}
+}
+
+
 std::vector<unsigned> Model::GetIndices(unsigned submeshID) const {
 	unsigned meshCount = m_scene->mNumMeshes;
 	assert(submeshID < meshCount);
@@ -128,6 +413,163 @@ std::vector<unsigned> Model::GetIndices(unsigned submeshID) const {
 }
 
 
+unsigned Model::GetMaterialIndex(unsigned submeshID) const {
+	assert(submeshID < m_scene->mNumMeshes);
+	return m_scene->mMeshes[submeshID]->mMaterialIndex;
+}
+
+
+std::vector<std::string> Model::GetTexturePaths() const {
+	std::vector<std::string> paths;
+	for (unsigned materialID = 0; materialID < m_scene->mNumMaterials; ++materialID) {
+		const aiMaterial* material = m_scene->mMaterials[materialID];
+		for (int type = aiTextureType_NONE + 1; type <= aiTextureType_UNKNOWN; ++type) {
+			for (unsigned i = 0; i < material->GetTextureCount(aiTextureType(type)); ++i) {
+				aiString path;
+				if (material->GetTexture(aiTextureType(type), i, &path) != AI_SUCCESS) {
+					continue;
+				}
+				// Embedded textures are referenced as *index.
+				if (path.length == 0 || path.data[0] == '*') {
+					continue;
+				}
+				if (std::find(paths.begin(), paths.end(), path.C_Str()) == paths.end()) {
+					paths.push_back(path.C_Str());
+				}
+			}
+		}
+	}
+	return paths;
+}
+
+
+bool Model::HasSkeleton() const {
+	return !m_boneNodes.empty();
+}
+
+
+Skeleton Model::GetSkeleton(CoordSysLayout csys) const {
+	if (m_boneNodes.empty()) {
+		throw InvalidCallException("Skeleton requested but the loaded model has no bones.");
+	}
+
+	// Skin matrices take the vertices as they are returned, and leave them in the same coordinate system.
+	const Mat44 inverseVertexTransform = GetVertexTransforms(csys).position.Inverse();
+	const Mat44 axesTransform = GetAxesTransform(csys);
+
+	std::unordered_map<std::string, const aiBone*> meshBones;
+	for (unsigned meshID = 0; meshID < m_scene->mNumMeshes; ++meshID) {
+		const aiMesh* mesh = m_scene->mMeshes[meshID];
+		for (unsigned boneID = 0; boneID < mesh->mNumBones; ++boneID) {
+			meshBones.insert({ mesh->mBones[boneID]->mName.C_Str(), mesh->mBones[boneID] });
+		}
+	}
+
+	std::vector<Bone> bones(m_boneNodes.size());
+	std::vector<Mat44> bindGlobals(m_boneNodes.size());
+	for (size_t i = 0; i < m_boneNodes.size(); ++i) {
+		const aiNode* node = m_boneNodes[i];
+		Bone& bone = bones[i];
+		bone.name = node->mName.C_Str();
+
+		auto parentIt = node->mParent != nullptr ? m_boneIndices.find(node->mParent->mName.C_Str()) : m_boneIndices.end();
+		if (parentIt != m_boneIndices.end() && m_boneNodes[parentIt->second] == node->mParent) {
+			bone.parent = (int)parentIt->second;
+			bindGlobals[i] = ToRowVectorTransform(node->mTransformation) * bindGlobals[bone.parent];
+		}
+		else {
+			bone.baseTransform = GetGlobalRowVectorTransform(node->mParent) * axesTransform;
+			bindGlobals[i] = ToRowVectorTransform(node->mTransformation) * bone.baseTransform;
+		}
+
+		// Bones that no vertex is skinned to have no offset matrix.
+		auto meshBoneIt = meshBones.find(bone.name);
+		if (meshBoneIt != meshBones.end()) {
+			bone.inverseBind = inverseVertexTransform * ToRowVectorTransform(meshBoneIt->second->mOffsetMatrix);
+		}
+		else {
+			bone.inverseBind = bindGlobals[i].Inverse();
+		}
+	}
+
+	return Skeleton(std::move(bones));
+}
+
+
+unsigned Model::AnimationCount() const {
+	assert(m_scene != nullptr);
+	return m_scene->mNumAnimations;
+}
+
+
+AnimationClip Model::GetAnimation(unsigned animationID, const Skeleton& skeleton) const {
+	assert(animationID < m_scene->mNumAnimations);
+	const aiAnimation* animation = m_scene->mAnimations[animationID];
+	// Assimp leaves it zero if the file does not tell.
+	const double ticksPerSecond = animation->mTicksPerSecond > 0.0 ? animation->mTicksPerSecond : 25.0;
+
+	std::vector<AnimationTrack> tracks(skeleton.GetBoneCount());
+	for (unsigned channelID = 0; channelID < animation->mNumChannels; ++channelID) {
+		const aiNodeAnim* channel = animation->mChannels[channelID];
+		const int boneIndex = skeleton.FindBone(channel->mNodeName.C_Str());
+		if (boneIndex < 0) {
+			continue;
+		}
+
+		AnimationTrack& track = tracks[boneIndex];
+		for (unsigned keyID = 0; keyID < channel->mNumPositionKeys; ++keyID) {
+			const aiVectorKey& key = channel->mPositionKeys[keyID];
+			track.translationTimes.push_back(float(key.mTime / ticksPerSecond));
+			track.translations[0].push_back(key.mValue.x);
+			track.translations[1].push_back(key.mValue.y);
+			track.translations[2].push_back(key.mValue.z);
+		}
+		for (unsigned keyID = 0; keyID < channel->mNumRotationKeys; ++keyID) {
+			const aiQuatKey& key = channel->mRotationKeys[keyID];
+			track.rotationTimes.push_back(float(key.mTime / ticksPerSecond));
+			track.rotations[0].push_back(key.mValue.x);
+			track.rotations[1].push_back(key.mValue.y);
+			track.rotations[2].push_back(key.mValue.z);
+			track.rotations[3].push_back(key.mValue.w);
+		}
+		for (unsigned keyID = 0; keyID < channel->mNumScalingKeys; ++keyID) {
+			const aiVectorKey& key = channel->mScalingKeys[keyID];
+			track.scaleTimes.push_back(float(key.mTime / ticksPerSecond));
+			track.scales[0].push_back(key.mValue.x);
+			track.scales[1].push_back(key.mValue.y);
+			track.scales[2].push_back(key.mValue.z);
+		}
+	}
+
+	// What the animation does not move stays in the bind pose.
+	for (size_t i = 0; i < tracks.size(); ++i) {
+		AnimationTrack& track = tracks[i];
+		aiVector3D scaling(1.0f, 1.0f, 1.0f);
+		aiQuaternion rotation;
+		aiVector3D translation(0.0f, 0.0f, 0.0f);
+		const aiNode* node = m_scene->mRootNode->FindNode(skeleton.GetBone(i).name.c_str());
+		if (node != nullptr) {
+			node->mTransformation.Decompose(scaling, rotation, translation);
+		}
+
+		if (track.translationTimes.empty()) {
+			track.translationTimes = { 0.0f };
+			track.translations = { { { translation.x }, { translation.y }, { translation.z } } };
+		}
+		if (track.rotationTimes.empty()) {
+			track.rotationTimes = { 0.0f };
+			track.rotations = { { { rotation.x }, { rotation.y }, { rotation.z }, { rotation.w } } };
+		}
+		if (track.scaleTimes.empty()) {
+			track.scaleTimes = { 0.0f };
+			track.scales = { { { scaling.x }, { scaling.y }, { scaling.z } } };
+		}
+	}
+
+	return AnimationClip(animation->mName.C_Str(), float(animation->mDuration / ticksPerSecond), std::move(tracks));
+}
+
+
 
 } // namespace asset
 } // namespace inl
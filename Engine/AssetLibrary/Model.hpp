@@ -1,5 +1,6 @@
 #pragma once
 
+#include <GraphicsEngine_LL/Mesh.hpp>
 #include <GraphicsEngine_LL/Vertex.hpp>
 
 #include <assimp/Importer.hpp>
@@ -8,8 +9,18 @@
 
 #include <InlineMath.hpp>
 
+#include "ParallelFor.hpp"
+#include "Skeleton.hpp"
+#include "Animation.hpp"
+
+#include <BaseLibrary/FileSystem/VirtualFileSystem.hpp>
+
+#include <algorithm>
+#include <limits>
 #include <vector>
 #include <memory>
+#include <string>
+#include <unordered_map>
 
 
 namespace inl {
@@ -27,13 +38,63 @@ class Model {
 public:
 	Model();
 	explicit Model(const std::string& filename);
+	/// <summary> Imports a model file which has already been read into memory. </summary>
+	/// <param name="formatHint"> The file extension, which tells assimp the format. </param>
+	Model(const void* data, size_t size, const std::string& formatHint);
+	/// <summary> Imports a model from the virtual file system, together with the files it references. </summary>
+	Model(const VirtualFileSystem& fileSystem, const std::string& path);
+	/// <summary> Imports a model through a custom IO system, which the model takes ownership of. </summary>
+	Model(Assimp::IOSystem* ioSystem, const std::string& path);
 
 	unsigned SubmeshCount() const;
 
+	/// <summary> Number of vertices in the submesh. </summary>
+	size_t GetVertexCount(unsigned submeshID) const;
+	/// <summary> Number of vertices in all submeshes. </summary>
+	size_t GetVertexCount() const;
+
 	template <typename... AttribT>
 	std::vector<gxeng::Vertex<AttribT...>> GetVertices(unsigned submeshID, CoordSysLayout cSysLayout = { AxisDir::POS_X, AxisDir::POS_Y, AxisDir::POS_Z }) const;
 
+	/// <summary> Writes the vertices of the submesh into <paramref name="output"/>, which must hold <see cref="GetVertexCount"/> vertices. </summary>
+	/// <param name="numThreads"> Large meshes are split across this many threads, 0 means one per core. </param>
+	template <typename... AttribT>
+	void GetVertices(unsigned submeshID, gxeng::Vertex<AttribT...>* output, CoordSysLayout cSysLayout = { AxisDir::POS_X, AxisDir::POS_Y, AxisDir::POS_Z }, unsigned numThreads = 0) const;
+
+	/// <summary> Returns the vertices of all submeshes, one submesh after the other. </summary>
+	template <typename... AttribT>
+	std::vector<gxeng::Vertex<AttribT...>> GetAllVertices(CoordSysLayout cSysLayout = { AxisDir::POS_X, AxisDir::POS_Y, AxisDir::POS_Z }) const;
+
+	/// <summary> Writes the vertices of all submeshes into <paramref name="output"/>, one submesh after the other. </summary>
+	/// <param name="numThreads"> Vertices are split across this many threads, 0 means one per core. </param>
+	template <typename... AttribT>
+	void GetAllVertices(gxeng::Vertex<AttribT...>* output, CoordSysLayout cSysLayout = { AxisDir::POS_X, AxisDir::POS_Y, AxisDir::POS_Z }, unsigned numThreads = 0) const;
+
 	std::vector<unsigned> GetIndices(unsigned submeshID) const;
+	/// <summary> Appends the indices of all submeshes to <paramref name="allIndices"/>, one submesh after the other, and returns
+	///		the table that draws each submesh from them. Indices stay relative to the first vertex of their submesh, its base vertex. </summary>
+	/// <param name="allVertices"> As returned by <see cref="GetAllVertices"/>, the bounds of the submeshes are those of their positions. </param>
+	template <typename... AttribT>
+	std::vector<gxeng::Mesh::Submesh> GetSubmeshTable(const gxeng::Vertex<AttribT...>* allVertices, std::vector<unsigned>& allIndices) const;
+	/// <summary> Index of the material the submesh uses, which is the material slot it is drawn with. </summary>
+	unsigned GetMaterialIndex(unsigned submeshID) const;
+
+	/// <summary> Paths of the texture files the materials reference, as written in the model. Embedded textures are not listed. </summary>
+	std::vector<std::string> GetTexturePaths() const;
+
+	/// <summary> Whether the meshes are skinned, so that vertices can be requested with bone indices and weights. </summary>
+	bool HasSkeleton() const;
+	/// <summary> Returns the bones that the meshes are skinned to, in the coordinate system that the vertices are returned in. </summary>
+	/// <remarks> The bone indices of the vertices refer to this skeleton. Nodes between two bones are bones too,
+	///		even if no vertex is skinned to them, so that their animation is not lost. </remarks>
+	/// <exception cref="InvalidCallException"> If the model has no bones. </exception>
+	Skeleton GetSkeleton(CoordSysLayout cSysLayout = { AxisDir::POS_X, AxisDir::POS_Y, AxisDir::POS_Z }) const;
+
+	unsigned AnimationCount() const;
+	/// <summary> Imports an animation of the model, with a track for each bone of the skeleton.
+	///		Bones that the animation does not move keep their bind pose. </summary>
+	/// <param name="skeleton"> Returned by <see cref="GetSkeleton"/>. </param>
+	AnimationClip GetAnimation(unsigned animationID, const Skeleton& skeleton) const;
 
 protected:
 	// It is cleary stated in the documentation that an imporer instance will keep ownership
@@ -46,71 +107,158 @@ protected:
 	Mat44 m_invTrTransform;
 
 private:
+	void Init(const std::string& name);
+	void FindBones();
+
+	// Transforms of a vertex as row vector (v|1)*matrix.
+	struct VertexTransforms {
+		Mat44 position;
+		Mat44 normal;
+		// Skeleton index of each bone by name, the bone indices of the meshes are remapped with it.
+		const std::unordered_map<std::string, uint32_t>* boneIndices;
+	};
+	VertexTransforms GetVertexTransforms(CoordSysLayout cSysLayout) const;
+
+	// Vertices of the submeshes in [firstSubmesh, lastSubmesh) are written after each other into output.
+	template <typename VertexT, typename... AttribT>
+	void ExtractVertices(unsigned firstSubmesh, unsigned lastSubmesh, VertexT* output, CoordSysLayout cSysLayout, unsigned numThreads) const;
+
+	// Batch kernels, they write count elements to output with the given stride in bytes.
+	static void TransformVectors(const aiVector3D* input, size_t count, const Mat44& transform, bool divideByW, void* output, size_t outputStride);
+	static void CopyTexCoords(const aiVector3D* input, size_t count, void* output, size_t outputStride);
+	static void CopyColors(const aiColor4D* input, size_t count, void* output, size_t outputStride);
+	// Writes the four largest bone weights of each vertex, normalized, and/or the skeleton indices of their bones. Either output may be null.
+	static void CopyBoneInfluences(const aiMesh* mesh, const std::unordered_map<std::string, uint32_t>& boneIndices, size_t firstVertex, size_t count, void* indicesOutput, void* weightsOutput, size_t outputStride);
+
+	// Meshes smaller than this are not worth spreading over threads.
+	static constexpr size_t MinVerticesPerThread = 32768;
 
 	template <typename VertexT, typename... AttribsT>
 	struct VertexAttributeSetter;
+
+	// The nodes of the bones in skeleton order, parents before children.
+	std::vector<const aiNode*> m_boneNodes;
+	std::unordered_map<std::string, uint32_t> m_boneIndices;
 };
 
 
 
 template <typename... AttribT>
 inline std::vector<gxeng::Vertex<AttribT...>> Model::GetVertices(unsigned submeshID, CoordSysLayout csys) const {
-	using VertexT = gxeng::Vertex<AttribT...>;
-	std::vector<VertexT> result;
+	assert(submeshID < m_scene->mNumMeshes);
+	std::vector<gxeng::Vertex<AttribT...>> result(GetVertexCount(submeshID));
+	ExtractVertices<gxeng::Vertex<AttribT...>, AttribT...>(submeshID, submeshID + 1, result.data(), csys, 0);
+	return result;
+}
+
 
+template <typename... AttribT>
+inline void Model::GetVertices(unsigned submeshID, gxeng::Vertex<AttribT...>* output, CoordSysLayout csys, unsigned numThreads) const {
 	assert(submeshID < m_scene->mNumMeshes);
-	const aiMesh* mesh = m_scene->mMeshes[submeshID];
-	result.reserve(mesh->mNumVertices);
+	ExtractVertices<gxeng::Vertex<AttribT...>, AttribT...>(submeshID, submeshID + 1, output, csys, numThreads);
+}
+
 
-	auto xAxis = GetAxis(csys.x);
-	auto yAxis = GetAxis(csys.y);
-	auto zAxis = GetAxis(csys.z);
-	const Mat44 posTransform =
-		m_transform *
-		//(Mat44(GetAxis(csys.x), GetAxis(csys.y), GetAxis(csys.z), Vec4(0, 0, 0, 1)).Transpose());
-		Mat44(xAxis.x, yAxis.x, zAxis.x, 0,
-			  xAxis.y, yAxis.y, zAxis.y, 0,
-			  xAxis.z, yAxis.z, zAxis.z, 0,
-			  0, 0, 0, 1);
+template <typename... AttribT>
+inline std::vector<gxeng::Vertex<AttribT...>> Model::GetAllVertices(CoordSysLayout csys) const {
+	std::vector<gxeng::Vertex<AttribT...>> result(GetVertexCount());
+	ExtractVertices<gxeng::Vertex<AttribT...>, AttribT...>(0, SubmeshCount(), result.data(), csys, 0);
+	return result;
+}
 
 
-	const Mat44 normalTransform = posTransform.Inverse().Transpose();
+template <typename... AttribT>
+inline void Model::GetAllVertices(gxeng::Vertex<AttribT...>* output, CoordSysLayout csys, unsigned numThreads) const {
+	ExtractVertices<gxeng::Vertex<AttribT...>, AttribT...>(0, SubmeshCount(), output, csys, numThreads);
+}
+
 
-	for (uint32_t i = 0; i < mesh->mNumVertices; i++) {
-		VertexT newVertex;
-		VertexAttributeSetter<VertexT, AttribT...>()(newVertex, mesh, i, posTransform, normalTransform);
-		result.push_back(newVertex);
+template <typename... AttribT>
+std::vector<gxeng::Mesh::Submesh> Model::GetSubmeshTable(const gxeng::Vertex<AttribT...>* allVertices, std::vector<unsigned>& allIndices) const {
+	std::vector<gxeng::Mesh::Submesh> submeshes;
+	size_t firstVertex = 0;
+	for (unsigned submeshID = 0; submeshID < SubmeshCount(); ++submeshID) {
+		std::vector<unsigned> submeshIndices = GetIndices(submeshID);
+		const size_t numVertices = GetVertexCount(submeshID);
+
+		gxeng::Mesh::Submesh submesh;
+		submesh.firstIndex = (unsigned)allIndices.size();
+		submesh.numIndices = (unsigned)submeshIndices.size();
+		submesh.baseVertex = (int)firstVertex;
+		submesh.materialSlot = GetMaterialIndex(submeshID);
+		for (int c = 0; c < 3; ++c) {
+			submesh.boundsMin[c] = numVertices > 0 ? std::numeric_limits<float>::max() : 0.0f;
+			submesh.boundsMax[c] = numVertices > 0 ? -std::numeric_limits<float>::max() : 0.0f;
+			for (size_t i = 0; i < numVertices; ++i) {
+				const float coord = allVertices[firstVertex + i].position[c];
+				submesh.boundsMin[c] = std::min(submesh.boundsMin[c], coord);
+				submesh.boundsMax[c] = std::max(submesh.boundsMax[c], coord);
+			}
+		}
+
+		allIndices.insert(allIndices.end(), submeshIndices.begin(), submeshIndices.end());
+		submeshes.push_back(submesh);
+		firstVertex += numVertices;
 	}
+	return submeshes;
+}
 
-	return result;
+
+template <typename VertexT, typename... AttribT>
+void Model::ExtractVertices(unsigned firstSubmesh, unsigned lastSubmesh, VertexT* output, CoordSysLayout csys, unsigned numThreads) const {
+	const VertexTransforms transforms = GetVertexTransforms(csys);
+
+	// Missing attributes are reported here, as exceptions can't leave the worker threads.
+	std::vector<size_t> firstVertices = { 0 };
+	for (unsigned submeshID = firstSubmesh; submeshID < lastSubmesh; ++submeshID) {
+		const aiMesh* mesh = m_scene->mMeshes[submeshID];
+		VertexAttributeSetter<VertexT, AttribT...>::Validate(mesh);
+		firstVertices.push_back(firstVertices.back() + mesh->mNumVertices);
+	}
+	const size_t totalVertices = firstVertices.back();
+
+	// Each thread takes a contiguous range of the output, which may cover parts of several submeshes.
+	numThreads = (unsigned)std::min<size_t>(GetNumThreads(numThreads), std::max<size_t>(1, totalVertices / MinVerticesPerThread));
+	ParallelFor(totalVertices, numThreads, [&](size_t begin, size_t end) {
+		for (unsigned submeshID = firstSubmesh; submeshID < lastSubmesh; ++submeshID) {
+			size_t submeshBegin = firstVertices[submeshID - firstSubmesh];
+			size_t submeshEnd = firstVertices[submeshID - firstSubmesh + 1];
+			size_t rangeBegin = std::max(begin, submeshBegin);
+			size_t rangeEnd = std::min(end, submeshEnd);
+			if (rangeBegin < rangeEnd) {
+				VertexAttributeSetter<VertexT, AttribT...>()(output + rangeBegin, m_scene->mMeshes[submeshID], rangeBegin - submeshBegin, rangeEnd - rangeBegin, transforms);
+			}
+		}
+	});
 }
 
 
+// Each setter fills one attribute of a range of vertices, then passes on to the next attribute.
 template <typename VertexT>
 struct Model::VertexAttributeSetter<VertexT> {
-	inline void operator()(VertexT&, const aiMesh*, uint32_t, const Mat44&, const Mat44&) {}
+	static void Validate(const aiMesh*) {}
+	inline void operator()(VertexT*, const aiMesh*, size_t, size_t, const VertexTransforms&) {}
 };
 
 
 template <typename VertexT, int semanticIndex, typename... TailAttribT>
 struct Model::VertexAttributeSetter<VertexT, gxeng::Position<semanticIndex>, TailAttribT...> {
 	static_assert(semanticIndex == 0, "There is only one position attribute inside a model.");
+	static void Validate(const aiMesh* mesh) {
+		assert(mesh->HasPositions());
+		VertexAttributeSetter<VertexT, TailAttribT...>::Validate(mesh);
+	}
 	inline void operator()(
-		VertexT& target,
+		VertexT* target,
 		const aiMesh* mesh,
-		uint32_t vertexIndex,
-		const Mat44& posTr,
-		const Mat44& normTr
+		size_t firstVertex,
+		size_t vertexCount,
+		const VertexTransforms& transforms
 		) {
-		using DataType = gxeng::VertexPartReader<gxeng::eVertexElementSemantic::POSITION>::DataType;
-		assert(mesh->HasPositions());
-		assert(vertexIndex < mesh->mNumVertices);
-		const aiVector3D& pos = mesh->mVertices[vertexIndex];
-		//target.position = (model->m_transform * mathfu::Vector<float, 4>(pos.x, pos.z, -pos.y, 1)).xyz();
-		target.position = (posTr * Vec4(pos.x, pos.y, pos.z, 1)).xyz;
-		//target.position = DataType(pos.x, pos.z, -pos.y);
+		assert(firstVertex + vertexCount <= mesh->mNumVertices);
+		TransformVectors(mesh->mVertices + firstVertex, vertexCount, transforms.position, false, &target->position, sizeof(VertexT));
 
-		VertexAttributeSetter<VertexT, TailAttribT...>()(target, mesh, vertexIndex, posTr, normTr);
+		VertexAttributeSetter<VertexT, TailAttribT...>()(target, mesh, firstVertex, vertexCount, transforms);
 	}
 };
 
@@ -118,23 +266,23 @@ struct Model::VertexAttributeSetter<VertexT, gxeng::Position<semanticIndex>, Tai
 template <typename VertexT, int semanticIndex, typename... TailAttribT>
 struct Model::VertexAttributeSetter<VertexT, gxeng::Normal<semanticIndex>, TailAttribT...> {
 	static_assert(semanticIndex == 0, "There is only one \"normal vector\" attribute inside a model.");
-	inline void operator()(
-		VertexT& target,
-		const aiMesh* mesh,
-		uint32_t vertexIndex,
-		const Mat44& posTr,
-		const Mat44& normTr
-		) {
-		using DataType = gxeng::VertexPartReader<gxeng::eVertexElementSemantic::NORMAL>::DataType;
+	static void Validate(const aiMesh* mesh) {
 		if (mesh->HasNormals() == false) {
 			throw InvalidCallException("Vertex array requested with normals but loaded mesh does not have such an attribute.");
 		}
-		assert(vertexIndex < mesh->mNumVertices);
-		const aiVector3D& normal = mesh->mNormals[vertexIndex];
-		target.normal = normTr * (Vec3)DataType(normal.x, normal.y, normal.z);
-		//target.normal = DataType(normal.x, normal.y, normal.z);
+		VertexAttributeSetter<VertexT, TailAttribT...>::Validate(mesh);
+	}
+	inline void operator()(
+		VertexT* target,
+		const aiMesh* mesh,
+		size_t firstVertex,
+		size_t vertexCount,
+		const VertexTransforms& transforms
+		) {
+		assert(firstVertex + vertexCount <= mesh->mNumVertices);
+		TransformVectors(mesh->mNormals + firstVertex, vertexCount, transforms.normal, true, &target->normal, sizeof(VertexT));
 
-		VertexAttributeSetter<VertexT, TailAttribT...>()(target, mesh, vertexIndex, posTr, normTr);
+		VertexAttributeSetter<VertexT, TailAttribT...>()(target, mesh, firstVertex, vertexCount, transforms);
 	}
 };
 
@@ -142,22 +290,23 @@ struct Model::VertexAttributeSetter<VertexT, gxeng::Normal<semanticIndex>, TailA
 template <typename VertexT, int semanticIndex, typename... TailAttribT>
 struct Model::VertexAttributeSetter<VertexT, gxeng::Tangent<semanticIndex>, TailAttribT...> {
 	static_assert(semanticIndex == 0, "There is only one \"tangent vector\" attribute inside a model.");
-	inline void operator()(
-		VertexT& target,
-		const aiMesh* mesh,
-		uint32_t vertexIndex,
-		const Mat44& posTr,
-		const Mat44& normTr
-		) {
-		using DataType = gxeng::VertexPart<gxeng::eVertexElementSemantic::NORMAL>::DataType;
+	static void Validate(const aiMesh* mesh) {
 		if (mesh->HasTangentsAndBitangents() == false) {
 			throw InvalidCallException("Vertex array requested with tangents but loaded mesh does not have such an attribute.");
 		}
-		assert(vertexIndex < mesh->mNumVertices);
-		const aiVector3D& tangent = mesh->mTangents[vertexIndex];
-		target.tangent = normTr * DataType(tangent.x, tangent.y, tangent.z);
+		VertexAttributeSetter<VertexT, TailAttribT...>::Validate(mesh);
+	}
+	inline void operator()(
+		VertexT* target,
+		const aiMesh* mesh,
+		size_t firstVertex,
+		size_t vertexCount,
+		const VertexTransforms& transforms
+		) {
+		assert(firstVertex + vertexCount <= mesh->mNumVertices);
+		TransformVectors(mesh->mTangents + firstVertex, vertexCount, transforms.normal, true, &target->tangent, sizeof(VertexT));
 
-		VertexAttributeSetter<VertexT, TailAttribT...>()(target, mesh, vertexIndex, posTr, normTr);
+		VertexAttributeSetter<VertexT, TailAttribT...>()(target, mesh, firstVertex, vertexCount, transforms);
 	}
 };
 
@@ -165,72 +314,123 @@ struct Model::VertexAttributeSetter<VertexT, gxeng::Tangent<semanticIndex>, Tail
 template <typename VertexT, int semanticIndex, typename... TailAttribT>
 struct Model::VertexAttributeSetter<VertexT, gxeng::Bitangent<semanticIndex>, TailAttribT...> {
 	static_assert(semanticIndex == 0, "There is only one \"bitangent vector\" attribute inside a model.");
-	inline void operator()(
-		VertexT& target,
-		const aiMesh* mesh,
-		uint32_t vertexIndex,
-		const Mat44& posTr,
-		const Mat44& normTr
-		) {
-		using DataType = gxeng::VertexPart<gxeng::eVertexElementSemantic::NORMAL>::DataType;
+	static void Validate(const aiMesh* mesh) {
 		if (mesh->HasTangentsAndBitangents() == false) {
 			throw InvalidCallException("Vertex array requested with bitangents but loaded mesh does not have such an attribute.");
 		}
-		assert(vertexIndex < mesh->mNumVertices);
-		const aiVector3D& bitangent = mesh->mBitangents[vertexIndex];
-		target.bitangent = normTr * DataType(bitangent.x, bitangent.y, bitangent.z);
+		VertexAttributeSetter<VertexT, TailAttribT...>::Validate(mesh);
+	}
+	inline void operator()(
+		VertexT* target,
+		const aiMesh* mesh,
+		size_t firstVertex,
+		size_t vertexCount,
+		const VertexTransforms& transforms
+		) {
+		assert(firstVertex + vertexCount <= mesh->mNumVertices);
+		TransformVectors(mesh->mBitangents + firstVertex, vertexCount, transforms.normal, true, &target->bitangent, sizeof(VertexT));
 
-		VertexAttributeSetter<VertexT, TailAttribT...>()(target, mesh, vertexIndex, posTr, normTr);
+		VertexAttributeSetter<VertexT, TailAttribT...>()(target, mesh, firstVertex, vertexCount, transforms);
 	}
 };
 
 
 template <typename VertexT, int semanticIndex, typename... TailAttribT>
 struct Model::VertexAttributeSetter<VertexT, gxeng::TexCoord<semanticIndex>, TailAttribT...> {
-	inline void operator()(
-		VertexT& target,
-		const aiMesh* mesh,
-		uint32_t vertexIndex,
-		const Mat44& posTr,
-		const Mat44& normTr
-		) {
-		using DataType = gxeng::VertexPartReader<gxeng::eVertexElementSemantic::TEX_COORD>::DataType;
+	static void Validate(const aiMesh* mesh) {
 		if (mesh->HasTextureCoords(semanticIndex) == false) {
 			throw InvalidCallException(
 				"Vertex array requested with texture coords of semantic index "
 				+ std::to_string(semanticIndex)
 				+ " but loaded mesh does not have such an attribute with that semantic index.");
 		}
-		assert(vertexIndex < mesh->mNumVertices);
-		const aiVector3D& texCoords = mesh->mTextureCoords[semanticIndex][vertexIndex];
-		target.texCoord = DataType(texCoords.x, texCoords.y);
+		VertexAttributeSetter<VertexT, TailAttribT...>::Validate(mesh);
+	}
+	inline void operator()(
+		VertexT* target,
+		const aiMesh* mesh,
+		size_t firstVertex,
+		size_t vertexCount,
+		const VertexTransforms& transforms
+		) {
+		assert(firstVertex + vertexCount <= mesh->mNumVertices);
+		CopyTexCoords(mesh->mTextureCoords[semanticIndex] + firstVertex, vertexCount, &target->texCoord, sizeof(VertexT));
 
-		VertexAttributeSetter<VertexT, TailAttribT...>()(target, mesh, vertexIndex, posTr, normTr);
+		VertexAttributeSetter<VertexT, TailAttribT...>()(target, mesh, firstVertex, vertexCount, transforms);
 	}
 };
 
 
 template <typename VertexT, int semanticIndex, typename... TailAttribT>
 struct Model::VertexAttributeSetter<VertexT, gxeng::Color<semanticIndex>, TailAttribT...> {
-	inline void operator()(
-		VertexT& target,
-		const aiMesh* mesh,
-		uint32_t vertexIndex,
-		const Mat44& posTr,
-		const Mat44& normTr
-		) {
-		using DataType = gxeng::VertexPartReader<gxeng::eVertexElementSemantic::COLOR>::DataType;
+	static void Validate(const aiMesh* mesh) {
 		if (mesh->HasVertexColors(semanticIndex) == false) {
 			throw InvalidCallException(
 				"Vertex array requested with vertex colors of semantic index "
 				+ std::to_string(semanticIndex)
 				+ " but loaded mesh does not have such an attribute with that semantic index.");
 		}
-		assert(vertexIndex < mesh->mNumVertices);
-		const aiColor4D& color = mesh->mColors[semanticIndex][vertexIndex];
-		target.color = DataType(color.r, color.g, color.b);
+		VertexAttributeSetter<VertexT, TailAttribT...>::Validate(mesh);
+	}
+	inline void operator()(
+		VertexT* target,
+		const aiMesh* mesh,
+		size_t firstVertex,
+		size_t vertexCount,
+		const VertexTransforms& transforms
+		) {
+		assert(firstVertex + vertexCount <= mesh->mNumVertices);
+		CopyColors(mesh->mColors[semanticIndex] + firstVertex, vertexCount, &target->color, sizeof(VertexT));
+
+		VertexAttributeSetter<VertexT, TailAttribT...>()(target, mesh, firstVertex, vertexCount, transforms);
+	}
+};
+
+
+template <typename VertexT, int semanticIndex, typename... TailAttribT>
+struct Model::VertexAttributeSetter<VertexT, gxeng::BoneIndices<semanticIndex>, TailAttribT...> {
+	static_assert(semanticIndex == 0, "There is only one \"bone indices\" attribute inside a model.");
+	static void Validate(const aiMesh* mesh) {
+		if (mesh->HasBones() == false) {
+			throw InvalidCallException("Vertex array requested with bone indices but loaded mesh does not have bones.");
+		}
+		VertexAttributeSetter<VertexT, TailAttribT...>::Validate(mesh);
+	}
+	inline void operator()(
+		VertexT* target,
+		const aiMesh* mesh,
+		size_t firstVertex,
+		size_t vertexCount,
+		const VertexTransforms& transforms
+		) {
+		assert(firstVertex + vertexCount <= mesh->mNumVertices);
+		CopyBoneInfluences(mesh, *transforms.boneIndices, firstVertex, vertexCount, &target->boneIndices, nullptr, sizeof(VertexT));
+
+		VertexAttributeSetter<VertexT, TailAttribT...>()(target, mesh, firstVertex, vertexCount, transforms);
+	}
+};
+
+
+template <typename VertexT, int semanticIndex, typename... TailAttribT>
+struct Model::VertexAttributeSetter<VertexT, gxeng::BoneWeights<semanticIndex>, TailAttribT...> {
+	static_assert(semanticIndex == 0, "There is only one \"bone weights\" attribute inside a model.");
+	static void Validate(const aiMesh* mesh) {
+		if (mesh->HasBones() == false) {
+			throw InvalidCallException("Vertex array requested with bone weights but loaded mesh does not have bones.");
+		}
+		VertexAttributeSetter<VertexT, TailAttribT...>::Validate(mesh);
+	}
+	inline void operator()(
+		VertexT* target,
+		const aiMesh* mesh,
+		size_t firstVertex,
+		size_t vertexCount,
+		const VertexTransforms& transforms
+		) {
+		assert(firstVertex + vertexCount <= mesh->mNumVertices);
+		CopyBoneInfluences(mesh, *transforms.boneIndices, firstVertex, vertexCount, nullptr, &target->boneWeights, sizeof(VertexT));
 
-		VertexAttributeSetter<VertexT, TailAttribT...>()(target, mesh, vertexIndex, posTr, normTr);
+		VertexAttributeSetter<VertexT, TailAttribT...>()(target, mesh, firstVertex, vertexCount, transforms);
 	}
 };
 
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+
+namespace inl {
+namespace asset {
+
+
+/// <summary> Returns the number of threads to use, 0 is replaced by the number of cores. </summary>
+inline unsigned GetNumThreads(unsigned numThreads) {
+	return numThreads > 0 ? numThreads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+
+/// <summary> Splits [0, count) into contiguous ranges, and calls func(begin, end) for each on its own thread. </summary>
+/// <remarks> The calling thread processes the first range. </remarks>
+template <class Func>
+void ParallelFor(size_t count, unsigned numThreads, Func func) {
+	numThreads = (unsigned)std::min<size_t>(std::max(1u, numThreads), count);
+	if (numThreads <= 1) {
+		func(size_t(0), count);
+		return;
+	}
+
+	std::vector<std::thread> threads;
+	threads.reserve(numThreads - 1);
+	const size_t chunk = (count + numThreads - 1) / numThreads;
+	for (unsigned i = 1; i < numThreads; ++i) {
+		size_t begin = std::min(count, i * chunk);
+		size_t end = std::min(count, begin + chunk);
+		threads.emplace_back([&func, begin, end] { func(begin, end); });
+	}
+	func(size_t(0), std::min(count, chunk));
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+
+}
+}
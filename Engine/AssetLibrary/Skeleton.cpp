@@ -0,0 +1,49 @@
+#include "Skeleton.hpp"
+
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <cassert>
+
+
+namespace inl {
+namespace asset {
+
+
+Skeleton::Skeleton(std::vector<Bone> bones)
+	: m_bones(std::move(bones))
+{
+	for (size_t i = 0; i < m_bones.size(); ++i) {
+		if (m_bones[i].parent < -1 || m_bones[i].parent >= (int)i) {
+			throw InvalidArgumentException("Bones must come after their parents.", m_bones[i].name);
+		}
+		if (!m_boneIndices.insert({ m_bones[i].name, (int)i }).second) {
+			throw InvalidArgumentException("Bone names must be unique.", m_bones[i].name);
+		}
+	}
+}
+
+
+size_t Skeleton::GetBoneCount() const {
+	return m_bones.size();
+}
+
+
+const Bone& Skeleton::GetBone(size_t index) const {
+	assert(index < m_bones.size());
+	return m_bones[index];
+}
+
+
+const std::vector<Bone>& Skeleton::GetBones() const {
+	return m_bones;
+}
+
+
+int Skeleton::FindBone(const std::string& name) const {
+	auto it = m_boneIndices.find(name);
+	return it != m_boneIndices.end() ? it->second : -1;
+}
+
+
+}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <InlineMath.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace inl {
+namespace asset {
+
+
+/// <summary> A joint of a <see cref="Skeleton"/>. </summary>
+struct Bone {
+	std::string name;
+	/// <summary> Index of the parent bone, -1 for root bones. </summary>
+	int parent = -1;
+	/// <summary> Transforms the vertices, as the model returns them, into the space of the bone in the bind pose. </summary>
+	Mat44 inverseBind = Mat44::Identity();
+	/// <summary> Between the local transform of the bone and the global transform of its parent.
+	///		Places root bones into the model, identity for the others. </summary>
+	Mat44 baseTransform = Mat44::Identity();
+};
+
+
+/// <summary>
+/// The bone hierarchy of a skinned model.
+/// </summary>
+/// <remarks>
+/// Vectors are row vectors like everywhere in the engine. The global transform of a bone is
+/// local * baseTransform * global of parent, and the skin matrix of a bone is inverseBind * global.
+/// Parents come before their children, so globals can be computed in a single pass.
+/// </remarks>
+class Skeleton {
+public:
+	/// <summary> The number of bones that can influence a vertex. </summary>
+	static constexpr int MaxInfluences = 4;
+public:
+	Skeleton() = default;
+	/// <exception cref="InvalidArgumentException"> If a bone comes before its parent, or two bones have the same name. </exception>
+	explicit Skeleton(std::vector<Bone> bones);
+
+	size_t GetBoneCount() const;
+	const Bone& GetBone(size_t index) const;
+	const std::vector<Bone>& GetBones() const;
+	/// <summary> Returns -1 if there is no bone with that name. </summary>
+	int FindBone(const std::string& name) const;
+
+private:
+	std::vector<Bone> m_bones;
+	std::unordered_map<std::string, int> m_boneIndices;
+};
+
+
+}
+}
@@ -0,0 +1,188 @@
+#include "Skinning.hpp"
+#include "ParallelFor.hpp"
+
+#include <xmmintrin.h>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+
+namespace inl {
+namespace asset {
+
+
+static void SkinRange(
+	const uint8_t* positions,
+	const uint8_t* normals,
+	const uint8_t* boneIndices,
+	const uint8_t* boneWeights,
+	size_t inputStride,
+	size_t begin,
+	size_t end,
+	const float* matrices,
+	size_t numSkinMatrices,
+	uint8_t* outputPositions,
+	uint8_t* outputNormals,
+	size_t outputStride)
+{
+	for (size_t index = begin; index < end; ++index) {
+		uint32_t indices[4];
+		float weights[4];
+		std::memcpy(indices, boneIndices + index * inputStride, sizeof(indices));
+		std::memcpy(weights, boneWeights + index * inputStride, sizeof(weights));
+
+		// Blend the rows of the four matrices.
+		__m128 rows[4];
+		for (int r = 0; r < 4; ++r) {
+			rows[r] = _mm_setzero_ps();
+		}
+		for (int i = 0; i < 4; ++i) {
+			assert(indices[i] < numSkinMatrices);
+			const float* matrix = matrices + 16 * indices[i];
+			const __m128 weight = _mm_set1_ps(weights[i]);
+			for (int r = 0; r < 4; ++r) {
+				rows[r] = _mm_add_ps(rows[r], _mm_mul_ps(_mm_loadu_ps(matrix + 4 * r), weight));
+			}
+		}
+
+		alignas(16) float result[4];
+		float vector[3];
+		std::memcpy(vector, positions + index * inputStride, sizeof(vector));
+		__m128 position = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(_mm_set1_ps(vector[0]), rows[0]),
+			_mm_mul_ps(_mm_set1_ps(vector[1]), rows[1])),
+			_mm_mul_ps(_mm_set1_ps(vector[2]), rows[2])),
+			rows[3]);
+		_mm_store_ps(result, position);
+		std::memcpy(outputPositions + index * outputStride, result, 3 * sizeof(float));
+
+		if (normals != nullptr) {
+			std::memcpy(vector, normals + index * inputStride, sizeof(vector));
+			__m128 normal = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(_mm_set1_ps(vector[0]), rows[0]),
+				_mm_mul_ps(_mm_set1_ps(vector[1]), rows[1])),
+				_mm_mul_ps(_mm_set1_ps(vector[2]), rows[2]));
+			__m128 squares = _mm_mul_ps(normal, normal);
+			__m128 lengthSq = _mm_add_ss(_mm_add_ss(squares, _mm_shuffle_ps(squares, squares, _MM_SHUFFLE(1, 1, 1, 1))), _mm_shuffle_ps(squares, squares, _MM_SHUFFLE(2, 2, 2, 2)));
+			__m128 length = _mm_sqrt_ss(lengthSq);
+			if (_mm_cvtss_f32(length) > 0.0f) {
+				normal = _mm_div_ps(normal, _mm_shuffle_ps(length, length, _MM_SHUFFLE(0, 0, 0, 0)));
+			}
+			_mm_store_ps(result, normal);
+			std::memcpy(outputNormals + index * outputStride, result, 3 * sizeof(float));
+		}
+	}
+}
+
+
+void SkinVertices(
+	const void* positions,
+	const void* normals,
+	const void* boneIndices,
+	const void* boneWeights,
+	size_t inputStride,
+	size_t vertexCount,
+	const Mat44* skinMatrices,
+	size_t numSkinMatrices,
+	void* outputPositions,
+	void* outputNormals,
+	size_t outputStride,
+	unsigned numThreads)
+{
+	assert((normals == nullptr) == (outputNormals == nullptr));
+
+	// Row by row, whatever the layout of the matrix type is.
+	std::vector<float> matrices(16 * numSkinMatrices);
+	for (size_t i = 0; i < numSkinMatrices; ++i) {
+		for (int r = 0; r < 4; ++r) {
+			for (int c = 0; c < 4; ++c) {
+				matrices[16 * i + 4 * r + c] = skinMatrices[i](r, c);
+			}
+		}
+	}
+
+	ParallelFor(vertexCount, GetNumThreads(numThreads), [&](size_t begin, size_t end) {
+		SkinRange(
+			static_cast<const uint8_t*>(positions),
+			static_cast<const uint8_t*>(normals),
+			static_cast<const uint8_t*>(boneIndices),
+			static_cast<const uint8_t*>(boneWeights),
+			inputStride,
+			begin,
+			end,
+			matrices.data(),
+			numSkinMatrices,
+			static_cast<uint8_t*>(outputPositions),
+			static_cast<uint8_t*>(outputNormals),
+			outputStride);
+	});
+}
+
+
+void SkinVerticesReference(
+	const void* positions,
+	const void* normals,
+	const void* boneIndices,
+	const void* boneWeights,
+	size_t inputStride,
+	size_t vertexCount,
+	const Mat44* skinMatrices,
+	size_t numSkinMatrices,
+	void* outputPositions,
+	void* outputNormals,
+	size_t outputStride)
+{
+	const uint8_t* inputBytes[4] = {
+		static_cast<const uint8_t*>(positions),
+		static_cast<const uint8_t*>(normals),
+		static_cast<const uint8_t*>(boneIndices),
+		static_cast<const uint8_t*>(boneWeights),
+	};
+	uint8_t* outputBytes[2] = { static_cast<uint8_t*>(outputPositions), static_cast<uint8_t*>(outputNormals) };
+
+	for (size_t index = 0; index < vertexCount; ++index) {
+		uint32_t indices[4];
+		float weights[4];
+		std::memcpy(indices, inputBytes[2] + index * inputStride, sizeof(indices));
+		std::memcpy(weights, inputBytes[3] + index * inputStride, sizeof(weights));
+
+		float blended[4][4] = {};
+		for (int i = 0; i < 4; ++i) {
+			assert(indices[i] < numSkinMatrices);
+			const Mat44& matrix = skinMatrices[indices[i]];
+			for (int r = 0; r < 4; ++r) {
+				for (int c = 0; c < 4; ++c) {
+					blended[r][c] = blended[r][c] + matrix(r, c) * weights[i];
+				}
+			}
+		}
+
+		float vector[3];
+		float result[3];
+		std::memcpy(vector, inputBytes[0] + index * inputStride, sizeof(vector));
+		for (int c = 0; c < 3; ++c) {
+			result[c] = ((vector[0] * blended[0][c] + vector[1] * blended[1][c]) + vector[2] * blended[2][c]) + blended[3][c];
+		}
+		std::memcpy(outputBytes[0] + index * outputStride, result, sizeof(result));
+
+		if (inputBytes[1] != nullptr) {
+			std::memcpy(vector, inputBytes[1] + index * inputStride, sizeof(vector));
+			for (int c = 0; c < 3; ++c) {
+				result[c] = (vector[0] * blended[0][c] + vector[1] * blended[1][c]) + vector[2] * blended[2][c];
+			}
+			const float length = std::sqrt((result[0] * result[0] + result[1] * result[1]) + result[2] * result[2]);
+			if (length > 0.0f) {
+				for (int c = 0; c < 3; ++c) {
+					result[c] /= length;
+				}
+			}
+			std::memcpy(outputBytes[1] + index * outputStride, result, sizeof(result));
+		}
+	}
+}
+
+
+}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <InlineMath.hpp>
+
+#include <cstddef>
+
+
+namespace inl {
+namespace asset {
+
+
+/// <summary>
+/// Skins vertices on the CPU, for passes that only draw static meshes, or for picking and physics.
+/// Positions and normals are transformed by the weighted sum of the skin matrices of up to four bones.
+/// </summary>
+/// <remarks>
+/// The skin matrices are those of <see cref="ComputeSkinMatrices"/>. The streams are read and written with their own strides
+/// in bytes, so vertices can be skinned from one vertex type into another. Normals are renormalized, but not transformed
+/// by the inverse transpose, so skin matrices should not scale non-uniformly. Pass null for the normals to skip them.
+/// </remarks>
+/// <param name="boneIndices"> Four 32 bit indices per vertex, each less than <paramref name="numSkinMatrices"/>. </param>
+/// <param name="boneWeights"> Four floats per vertex, which sum to one. </param>
+/// <param name="numThreads"> Vertices are split across this many threads, 0 means one per core. </param>
+void SkinVertices(
+	const void* positions,
+	const void* normals,
+	const void* boneIndices,
+	const void* boneWeights,
+	size_t inputStride,
+	size_t vertexCount,
+	const Mat44* skinMatrices,
+	size_t numSkinMatrices,
+	void* outputPositions,
+	void* outputNormals,
+	size_t outputStride,
+	unsigned numThreads = 1);
+
+/// <summary> Same as <see cref="SkinVertices"/> without SIMD, on a single thread. Used to test and benchmark the former. </summary>
+void SkinVerticesReference(
+	const void* positions,
+	const void* normals,
+	const void* boneIndices,
+	const void* boneWeights,
+	size_t inputStride,
+	size_t vertexCount,
+	const Mat44* skinMatrices,
+	size_t numSkinMatrices,
+	void* outputPositions,
+	void* outputNormals,
+	size_t outputStride);
+
+
+/// <summary> Skins the positions and normals of <paramref name="input"/> into those of <paramref name="output"/>.
+///		The other attributes of the output are left alone. </summary>
+template <class InputVertexT, class OutputVertexT>
+void SkinVertices(const InputVertexT* input, size_t vertexCount, const Mat44* skinMatrices, size_t numSkinMatrices, OutputVertexT* output, unsigned numThreads = 1) {
+	SkinVertices(
+		&input->position, &input->normal, &input->boneIndices, &input->boneWeights, sizeof(InputVertexT),
+		vertexCount,
+		skinMatrices, numSkinMatrices,
+		&output->position, &output->normal, sizeof(OutputVertexT),
+		numThreads);
+}
+
+
+}
+}
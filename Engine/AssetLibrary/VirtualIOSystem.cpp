@@ -0,0 +1,95 @@
+#include "VirtualIOSystem.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace inl {
+namespace asset {
+
+
+VirtualIOStream::VirtualIOStream(VirtualFile file)
+	: m_file(std::move(file)), m_position(0)
+{}
+
+
+size_t VirtualIOStream::Read(void* buffer, size_t size, size_t count) {
+	if (size == 0) {
+		return 0;
+	}
+	// Like fread, only whole elements are read.
+	const size_t numElements = std::min(count, (m_file.GetSize() - m_position) / size);
+	std::memcpy(buffer, static_cast<const uint8_t*>(m_file.GetData()) + m_position, numElements * size);
+	m_position += numElements * size;
+	return numElements;
+}
+
+
+size_t VirtualIOStream::Write(const void* buffer, size_t size, size_t count) {
+	return 0;
+}
+
+
+aiReturn VirtualIOStream::Seek(size_t offset, aiOrigin origin) {
+	size_t position;
+	switch (origin) {
+		case aiOrigin_SET: position = offset; break;
+		case aiOrigin_CUR: position = m_position + offset; break;
+		case aiOrigin_END: position = m_file.GetSize() + offset; break; // offset is negative, wraps around like CUR
+		default: return aiReturn_FAILURE;
+	}
+	if (position > m_file.GetSize()) {
+		return aiReturn_FAILURE;
+	}
+	m_position = position;
+	return aiReturn_SUCCESS;
+}
+
+
+size_t VirtualIOStream::Tell() const {
+	return m_position;
+}
+
+
+size_t VirtualIOStream::FileSize() const {
+	return m_file.GetSize();
+}
+
+
+void VirtualIOStream::Flush() {}
+
+
+VirtualIOSystem::VirtualIOSystem(const VirtualFileSystem& fileSystem)
+	: m_fileSystem(fileSystem)
+{}
+
+
+bool VirtualIOSystem::Exists(const char* file) const {
+	return m_fileSystem.Exists(file);
+}
+
+
+char VirtualIOSystem::getOsSeparator() const {
+	return '/';
+}
+
+
+Assimp::IOStream* VirtualIOSystem::Open(const char* file, const char* mode) {
+	if (std::strchr(mode, 'w') != nullptr || std::strchr(mode, 'a') != nullptr) {
+		return nullptr;
+	}
+	VirtualFile virtualFile;
+	if (!m_fileSystem.TryOpen(file, virtualFile)) {
+		return nullptr;
+	}
+	return new VirtualIOStream(std::move(virtualFile));
+}
+
+
+void VirtualIOSystem::Close(Assimp::IOStream* file) {
+	delete file;
+}
+
+
+}
+}
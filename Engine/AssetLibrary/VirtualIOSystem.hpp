@@ -0,0 +1,47 @@
+#pragma once
+
+#include <BaseLibrary/FileSystem/VirtualFileSystem.hpp>
+
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
+
+
+namespace inl {
+namespace asset {
+
+
+/// <summary> A file of the virtual file system, read by assimp. </summary>
+class VirtualIOStream : public Assimp::IOStream {
+public:
+	explicit VirtualIOStream(VirtualFile file);
+
+	size_t Read(void* buffer, size_t size, size_t count) override;
+	/// <summary> The virtual file system is read only, nothing is written. </summary>
+	size_t Write(const void* buffer, size_t size, size_t count) override;
+	aiReturn Seek(size_t offset, aiOrigin origin) override;
+	size_t Tell() const override;
+	size_t FileSize() const override;
+	void Flush() override;
+private:
+	VirtualFile m_file;
+	size_t m_position;
+};
+
+
+/// <summary> Lets assimp open the model and the files it references through the virtual file system. </summary>
+/// <remarks> The file system must outlive the importer the IO system is given to. </remarks>
+class VirtualIOSystem : public Assimp::IOSystem {
+public:
+	explicit VirtualIOSystem(const VirtualFileSystem& fileSystem);
+
+	bool Exists(const char* file) const override;
+	char getOsSeparator() const override;
+	Assimp::IOStream* Open(const char* file, const char* mode = "rb") override;
+	void Close(Assimp::IOStream* file) override;
+private:
+	const VirtualFileSystem& m_fileSystem;
+};
+
+
+}
+}
@@ -0,0 +1,74 @@
+#include "CpuFeatures.hpp"
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+
+namespace inl {
+
+
+static void Cpuid(int leaf, int subleaf, uint32_t (&registers)[4]) {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuidex(info, leaf, subleaf);
+	for (int i = 0; i < 4; ++i) {
+		registers[i] = (uint32_t)info[i];
+	}
+#else
+	__cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+
+static uint64_t ReadXcr0() {
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	uint32_t eax, edx;
+	__asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return ((uint64_t)edx << 32) | eax;
+#endif
+}
+
+
+eSimdLevel CpuFeatures::GetSimdLevel() {
+	static const eSimdLevel level = DetectSimdLevel();
+	return level;
+}
+
+
+eSimdLevel CpuFeatures::DetectSimdLevel() {
+	uint32_t registers[4];
+	Cpuid(0, 0, registers);
+	uint32_t maxLeaf = registers[0];
+	if (maxLeaf < 1) {
+		return eSimdLevel::SCALAR;
+	}
+
+	Cpuid(1, 0, registers);
+	bool sse41 = (registers[2] & (1u << 19)) != 0;
+	bool osxsave = (registers[2] & (1u << 27)) != 0;
+	bool avx = (registers[2] & (1u << 28)) != 0;
+	if (!sse41) {
+		return eSimdLevel::SCALAR;
+	}
+
+	// AVX registers are only usable if the OS saves them on context switches.
+	bool ymmEnabled = osxsave && avx && (ReadXcr0() & 0x6) == 0x6;
+	if (ymmEnabled && maxLeaf >= 7) {
+		Cpuid(7, 0, registers);
+		bool avx2 = (registers[1] & (1u << 5)) != 0;
+		if (avx2) {
+			return eSimdLevel::AVX2;
+		}
+	}
+	return eSimdLevel::SSE4_1;
+}
+
+
+} // namespace inl
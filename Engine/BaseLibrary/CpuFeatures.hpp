@@ -0,0 +1,39 @@
+#pragma once
+
+
+// Instruction sets can be used in a function without enabling them for the whole project.
+// MSVC does not need to be told, GCC and Clang need to know which functions use them.
+#ifdef _MSC_VER
+#define INL_TARGET_SSE41
+#define INL_TARGET_AVX2
+#else
+#define INL_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define INL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+
+namespace inl {
+
+
+/// <summary> Vector instruction sets, each level includes the ones below it. </summary>
+enum class eSimdLevel {
+	SCALAR = 0,
+	SSE4_1,
+	AVX2,
+};
+
+
+/// <summary> Tells what the CPU the program runs on is capable of, to pick the fastest implementation at runtime. </summary>
+class CpuFeatures {
+public:
+	/// <summary> The widest instruction set supported by both the CPU and the OS. Detected on first call. </summary>
+	static eSimdLevel GetSimdLevel();
+
+	static bool HasSse41() { return GetSimdLevel() >= eSimdLevel::SSE4_1; }
+	static bool HasAvx2() { return GetSimdLevel() >= eSimdLevel::AVX2; }
+private:
+	static eSimdLevel DetectSimdLevel();
+};
+
+
+} // namespace inl
@@ -0,0 +1,206 @@
+#include "Lz4.hpp"
+#include "../Exception/Exception.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+
+namespace inl {
+
+
+// Limits of the block format: the last match starts at least 12 bytes before
+// the end, and the last 5 bytes are always literals.
+static constexpr size_t MinMatch = 4;
+static constexpr size_t MatchStartLimit = 12;
+static constexpr size_t LastLiterals = 5;
+static constexpr size_t MaxOffset = 65535;
+static constexpr unsigned HashBits = 14;
+
+
+static uint32_t Read32(const uint8_t* p) {
+	uint32_t value;
+	std::memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+
+static uint32_t Hash(uint32_t sequence) {
+	return (sequence * 2654435761u) >> (32 - HashBits);
+}
+
+
+// Lengths over 15 continue in bytes of 255 after the token.
+static uint8_t* WriteLength(uint8_t* out, size_t length) {
+	for (; length >= 255; length -= 255) {
+		*out++ = 255;
+	}
+	*out++ = (uint8_t)length;
+	return out;
+}
+
+
+static uint8_t* WriteSequence(uint8_t* out, const uint8_t* outEnd, const uint8_t* literals, size_t numLiterals, size_t offset, size_t matchLength) {
+	const size_t maxSize = 1 + numLiterals / 255 + 1 + numLiterals + 2 + matchLength / 255 + 1;
+	if (size_t(outEnd - out) < maxSize) {
+		return nullptr;
+	}
+
+	uint8_t* token = out++;
+	*token = uint8_t((numLiterals < 15 ? numLiterals : 15) << 4);
+	if (numLiterals >= 15) {
+		out = WriteLength(out, numLiterals - 15);
+	}
+	if (numLiterals > 0) {
+		std::memcpy(out, literals, numLiterals);
+		out += numLiterals;
+	}
+
+	if (offset != 0) {
+		*out++ = uint8_t(offset);
+		*out++ = uint8_t(offset >> 8);
+		const size_t length = matchLength - MinMatch;
+		*token |= uint8_t(length < 15 ? length : 15);
+		if (length >= 15) {
+			out = WriteLength(out, length - 15);
+		}
+	}
+	return out;
+}
+
+
+size_t Lz4CompressBound(size_t size) {
+	return size + size / 255 + 16;
+}
+
+
+size_t Lz4Compress(const void* source, size_t sourceSize, void* destination, size_t capacity) {
+	const uint8_t* const in = static_cast<const uint8_t*>(source);
+	const uint8_t* const inEnd = in + sourceSize;
+	uint8_t* const out = static_cast<uint8_t*>(destination);
+	uint8_t* const outEnd = out + capacity;
+
+	const uint8_t* anchor = in;
+	uint8_t* op = out;
+
+	// Positions are kept in 32 bits.
+	if (sourceSize > UINT32_MAX) {
+		return 0;
+	}
+
+	if (sourceSize > MatchStartLimit) {
+		// Positions of the last occurrence of each hashed 4 byte sequence.
+		std::unique_ptr<uint32_t[]> table(new uint32_t[size_t(1) << HashBits]());
+		const uint8_t* const matchStartEnd = inEnd - MatchStartLimit;
+		const uint8_t* const matchEnd = inEnd - LastLiterals;
+
+		const uint8_t* ip = in;
+		while (ip < matchStartEnd) {
+			const uint32_t sequence = Read32(ip);
+			uint32_t& entry = table[Hash(sequence)];
+			const uint8_t* ref = in + entry;
+			entry = uint32_t(ip - in);
+
+			if (ref >= ip || size_t(ip - ref) > MaxOffset || Read32(ref) != sequence) {
+				// Step faster through data that does not compress.
+				ip += 1 + ((ip - anchor) >> 6);
+				continue;
+			}
+
+			const uint8_t* matchIp = ip + MinMatch;
+			const uint8_t* matchRef = ref + MinMatch;
+			while (matchIp < matchEnd && *matchIp == *matchRef) {
+				++matchIp;
+				++matchRef;
+			}
+
+			op = WriteSequence(op, outEnd, anchor, size_t(ip - anchor), size_t(ip - ref), size_t(matchIp - ip));
+			if (op == nullptr) {
+				return 0;
+			}
+			ip = anchor = matchIp;
+		}
+	}
+
+	op = WriteSequence(op, outEnd, anchor, size_t(inEnd - anchor), 0, 0);
+	return op != nullptr ? size_t(op - out) : 0;
+}
+
+
+void Lz4Decompress(const void* source, size_t sourceSize, void* destination, size_t size) {
+	const uint8_t* ip = static_cast<const uint8_t*>(source);
+	const uint8_t* const ipEnd = ip + sourceSize;
+	uint8_t* const out = static_cast<uint8_t*>(destination);
+	uint8_t* op = out;
+	uint8_t* const opEnd = out + size;
+
+	auto readLength = [&ip, ipEnd](size_t length) {
+		uint8_t byte;
+		do {
+			if (ip == ipEnd) {
+				throw InvalidArgumentException("LZ4 data is corrupt.");
+			}
+			byte = *ip++;
+			length += byte;
+		} while (byte == 255);
+		return length;
+	};
+
+	for (;;) {
+		if (ip == ipEnd) {
+			throw InvalidArgumentException("LZ4 data is corrupt.");
+		}
+		const uint8_t token = *ip++;
+
+		size_t numLiterals = token >> 4;
+		if (numLiterals == 15) {
+			numLiterals = readLength(numLiterals);
+		}
+		if (numLiterals > size_t(ipEnd - ip) || numLiterals > size_t(opEnd - op)) {
+			throw InvalidArgumentException("LZ4 data is corrupt.");
+		}
+		if (numLiterals > 0) {
+			std::memcpy(op, ip, numLiterals);
+			ip += numLiterals;
+			op += numLiterals;
+		}
+
+		// The last sequence has no match.
+		if (ip == ipEnd) {
+			break;
+		}
+
+		if (ipEnd - ip < 2) {
+			throw InvalidArgumentException("LZ4 data is corrupt.");
+		}
+		const size_t offset = size_t(ip[0]) | size_t(ip[1]) << 8;
+		ip += 2;
+		size_t matchLength = token & 15;
+		if (matchLength == 15) {
+			matchLength = readLength(matchLength);
+		}
+		matchLength += MinMatch;
+		if (offset == 0 || offset > size_t(op - out) || matchLength > size_t(opEnd - op)) {
+			throw InvalidArgumentException("LZ4 data is corrupt.");
+		}
+
+		// The match may overlap the output it produces, which repeats the last offset bytes.
+		const uint8_t* match = op - offset;
+		if (offset >= matchLength) {
+			std::memcpy(op, match, matchLength);
+			op += matchLength;
+		}
+		else {
+			for (size_t i = 0; i < matchLength; ++i) {
+				*op++ = *match++;
+			}
+		}
+	}
+
+	if (op != opEnd) {
+		throw InvalidArgumentException("LZ4 data does not match the expected size.");
+	}
+}
+
+
+} // namespace inl
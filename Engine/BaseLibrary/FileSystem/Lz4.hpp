@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+
+
+namespace inl {
+
+
+/// <summary> Size of the buffer that <see cref="Lz4Compress"/> needs for any input of <paramref name="size"/> bytes. </summary>
+size_t Lz4CompressBound(size_t size);
+
+/// <summary> Compresses data into the LZ4 block format. </summary>
+/// <returns> The compressed size, or 0 if the result does not fit into <paramref name="capacity"/> bytes. </returns>
+size_t Lz4Compress(const void* source, size_t sourceSize, void* destination, size_t capacity);
+
+/// <summary> Decompresses an LZ4 block that decodes to exactly <paramref name="size"/> bytes. </summary>
+/// <remarks> Never reads or writes outside the buffers, even if the input is corrupt. </remarks>
+/// <exception cref="InvalidArgumentException"> If the input is corrupt. </exception>
+void Lz4Decompress(const void* source, size_t sourceSize, void* destination, size_t size);
+
+
+} // namespace inl
@@ -0,0 +1,341 @@
+#include "PackFile.hpp"
+#include "Lz4.hpp"
+#include "../Exception/Exception.hpp"
+
+#include <cstring>
+#include <fstream>
+
+
+namespace inl {
+
+
+//------------------------------------------------------------------------------
+// File layout
+//------------------------------------------------------------------------------
+
+// The header is followed by the table of contents: the entries, the hash table
+// and the paths. The data of the entries comes after that, uncompressed entries
+// starting at a multiple of DataAlignment. Everything is little endian.
+struct PackFileHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t numEntries;
+	uint32_t hashTableSize; // Power of two, larger than numEntries.
+	uint64_t entriesOffset;
+	uint64_t hashTableOffset;
+	uint64_t pathsOffset;
+	uint64_t pathsSize;
+};
+
+struct PackFileEntry {
+	uint64_t pathHash;
+	uint64_t offset;
+	uint64_t storedSize;
+	uint64_t size;
+	uint32_t pathOffset;
+	uint32_t pathLength;
+	uint32_t compression;
+	uint32_t reserved;
+};
+
+static const char Magic[4] = { 'I', 'N', 'L', 'P' };
+static constexpr uint32_t Version = 1;
+static constexpr uint64_t DataAlignment = 16;
+
+
+static uint64_t Align(uint64_t offset, uint64_t alignment) {
+	return (offset + alignment - 1) / alignment * alignment;
+}
+
+
+static char ToLower(char c) {
+	return c >= 'A' && c <= 'Z' ? char(c - 'A' + 'a') : c;
+}
+
+
+// FNV-1a of the lowercase path.
+static uint64_t HashPath(const char* path, size_t length) {
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < length; ++i) {
+		hash ^= (uint8_t)ToLower(path[i]);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+
+static bool EqualPaths(const char* lhs, size_t lhsLength, const char* rhs, size_t rhsLength) {
+	if (lhsLength != rhsLength) {
+		return false;
+	}
+	for (size_t i = 0; i < lhsLength; ++i) {
+		if (ToLower(lhs[i]) != ToLower(rhs[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+std::string PackFile::NormalizePath(const std::string& path) {
+	std::vector<std::string> components;
+	size_t begin = 0;
+	while (begin <= path.size()) {
+		size_t end = path.find_first_of("/\\", begin);
+		if (end == std::string::npos) {
+			end = path.size();
+		}
+		std::string component = path.substr(begin, end - begin);
+		if (component == "..") {
+			if (!components.empty()) {
+				components.pop_back();
+			}
+		}
+		else if (!component.empty() && component != ".") {
+			components.push_back(std::move(component));
+		}
+		begin = end + 1;
+	}
+
+	std::string result;
+	for (const auto& component : components) {
+		if (!result.empty()) {
+			result += '/';
+		}
+		result += component;
+	}
+	return result;
+}
+
+
+//------------------------------------------------------------------------------
+// Writing
+//------------------------------------------------------------------------------
+
+
+void PackFileWriter::AddFile(const std::string& path, const void* data, size_t size, ePackCompression compression) {
+	File file;
+	file.path = PackFile::NormalizePath(path);
+	file.size = size;
+	file.compression = ePackCompression::NONE;
+
+	std::string key = file.path;
+	for (auto& c : key) {
+		c = ToLower(c);
+	}
+	if (!m_paths.insert(key).second) {
+		throw InvalidArgumentException("A file with the same path is already in the pack.", file.path);
+	}
+
+	if (compression == ePackCompression::LZ4) {
+		file.storedData.resize(size - size / 8);
+		size_t compressedSize = Lz4Compress(data, size, file.storedData.data(), file.storedData.size());
+		if (compressedSize > 0) {
+			file.storedData.resize(compressedSize);
+			file.compression = ePackCompression::LZ4;
+		}
+	}
+	if (file.compression == ePackCompression::NONE) {
+		file.storedData.assign(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+	}
+
+	m_files.push_back(std::move(file));
+}
+
+
+void PackFileWriter::Write(const std::string& packPath) const {
+	uint32_t hashTableSize = 1;
+	while (hashTableSize < 2 * m_files.size()) {
+		hashTableSize *= 2;
+	}
+
+	PackFileHeader header = {};
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.numEntries = (uint32_t)m_files.size();
+	header.hashTableSize = hashTableSize;
+	header.entriesOffset = Align(sizeof(PackFileHeader), DataAlignment);
+	header.hashTableOffset = Align(header.entriesOffset + m_files.size() * sizeof(PackFileEntry), DataAlignment);
+	header.pathsOffset = Align(header.hashTableOffset + hashTableSize * sizeof(uint32_t), DataAlignment);
+
+	std::string paths;
+	std::vector<PackFileEntry> entries;
+	std::vector<uint32_t> hashTable(hashTableSize, 0);
+	for (const auto& file : m_files) {
+		PackFileEntry entry = {};
+		entry.pathHash = HashPath(file.path.c_str(), file.path.size());
+		entry.storedSize = file.storedData.size();
+		entry.size = file.size;
+		entry.pathOffset = (uint32_t)paths.size();
+		entry.pathLength = (uint32_t)file.path.size();
+		entry.compression = (uint32_t)file.compression;
+		paths += file.path;
+
+		// Slots hold the entry index plus one, zero is empty.
+		size_t slot = entry.pathHash & (hashTableSize - 1);
+		while (hashTable[slot] != 0) {
+			slot = (slot + 1) & (hashTableSize - 1);
+		}
+		hashTable[slot] = uint32_t(entries.size() + 1);
+
+		entries.push_back(entry);
+	}
+	header.pathsSize = paths.size();
+
+	uint64_t offset = header.pathsOffset + paths.size();
+	for (auto& entry : entries) {
+		if (entry.compression == (uint32_t)ePackCompression::NONE) {
+			offset = Align(offset, DataAlignment);
+		}
+		entry.offset = offset;
+		offset += entry.storedSize;
+	}
+
+	std::ofstream file(packPath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		throw RuntimeException("Could not open file for writing.", packPath);
+	}
+	auto writeSection = [&file](uint64_t offset, const void* data, size_t size) {
+		static const char padding[DataAlignment] = {};
+		file.write(padding, std::streamsize(offset - (uint64_t)file.tellp()));
+		file.write(static_cast<const char*>(data), std::streamsize(size));
+	};
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	writeSection(header.entriesOffset, entries.data(), entries.size() * sizeof(PackFileEntry));
+	writeSection(header.hashTableOffset, hashTable.data(), hashTable.size() * sizeof(uint32_t));
+	writeSection(header.pathsOffset, paths.data(), paths.size());
+	for (size_t i = 0; i < entries.size(); ++i) {
+		writeSection(entries[i].offset, m_files[i].storedData.data(), m_files[i].storedData.size());
+	}
+	if (!file.good()) {
+		throw RuntimeException("Could not write pack file.", packPath);
+	}
+}
+
+
+//------------------------------------------------------------------------------
+// Reading
+//------------------------------------------------------------------------------
+
+
+PackFile::PackFile(const std::string& path)
+	: m_file(path)
+{
+	const uint8_t* data = static_cast<const uint8_t*>(m_file.GetData());
+	const uint64_t size = m_file.GetSize();
+
+	// Check that every section and entry lies within the file, so that nothing is read from outside the mapping.
+	if (size < sizeof(PackFileHeader)) {
+		throw InvalidArgumentException("File is too small to be a pack file.", path);
+	}
+	m_header = reinterpret_cast<const PackFileHeader*>(data);
+	if (std::memcmp(m_header->magic, Magic, sizeof(Magic)) != 0) {
+		throw InvalidArgumentException("File is not a pack file.", path);
+	}
+	if (m_header->version != Version) {
+		throw InvalidArgumentException("Pack file was made by a different version, pack it again.", path);
+	}
+	const uint32_t hashTableSize = m_header->hashTableSize;
+	if (hashTableSize <= m_header->numEntries || (hashTableSize & (hashTableSize - 1)) != 0) {
+		throw InvalidArgumentException("Pack file header is corrupt.", path);
+	}
+	auto isSectionValid = [size](uint64_t offset, uint64_t count, uint64_t elementSize) {
+		return offset % DataAlignment == 0 && offset <= size && count * elementSize <= size - offset;
+	};
+	if (!isSectionValid(m_header->entriesOffset, m_header->numEntries, sizeof(PackFileEntry))
+		|| !isSectionValid(m_header->hashTableOffset, hashTableSize, sizeof(uint32_t))
+		|| !isSectionValid(m_header->pathsOffset, m_header->pathsSize, 1))
+	{
+		throw InvalidArgumentException("Pack file is truncated or corrupt.", path);
+	}
+	m_entries = reinterpret_cast<const PackFileEntry*>(data + m_header->entriesOffset);
+	m_hashTable = reinterpret_cast<const uint32_t*>(data + m_header->hashTableOffset);
+	m_paths = reinterpret_cast<const char*>(data + m_header->pathsOffset);
+
+	for (uint32_t i = 0; i < m_header->numEntries; ++i) {
+		const PackFileEntry& entry = m_entries[i];
+		const bool isStored = entry.compression == (uint32_t)ePackCompression::NONE;
+		if (uint64_t(entry.pathOffset) + entry.pathLength > m_header->pathsSize
+			|| entry.offset > size || entry.storedSize > size - entry.offset
+			|| entry.compression > (uint32_t)ePackCompression::LZ4
+			|| (isStored && (entry.storedSize != entry.size || entry.offset % DataAlignment != 0)))
+		{
+			throw InvalidArgumentException("Pack file has invalid entries.", path);
+		}
+	}
+	// Find probes until an empty slot, a table without one would never end the search.
+	bool hasEmptySlot = false;
+	for (uint32_t i = 0; i < hashTableSize; ++i) {
+		if (m_hashTable[i] > m_header->numEntries) {
+			throw InvalidArgumentException("Pack file has an invalid hash table.", path);
+		}
+		hasEmptySlot = hasEmptySlot || m_hashTable[i] == 0;
+	}
+	if (!hasEmptySlot) {
+		throw InvalidArgumentException("Pack file has an invalid hash table.", path);
+	}
+}
+
+
+size_t PackFile::GetEntryCount() const {
+	return m_header->numEntries;
+}
+
+
+std::string PackFile::GetEntryPath(size_t index) const {
+	const PackFileEntry& entry = m_entries[index];
+	return std::string(m_paths + entry.pathOffset, entry.pathLength);
+}
+
+
+size_t PackFile::GetEntrySize(size_t index) const {
+	return (size_t)m_entries[index].size;
+}
+
+
+ePackCompression PackFile::GetEntryCompression(size_t index) const {
+	return (ePackCompression)m_entries[index].compression;
+}
+
+
+size_t PackFile::Find(const std::string& path) const {
+	const std::string normalizedPath = NormalizePath(path);
+	const uint64_t hash = HashPath(normalizedPath.c_str(), normalizedPath.size());
+	const uint32_t mask = m_header->hashTableSize - 1;
+
+	// The constructor made sure the table has an empty slot, so probing ends.
+	for (size_t slot = hash & mask; m_hashTable[slot] != 0; slot = (slot + 1) & mask) {
+		const size_t index = m_hashTable[slot] - 1;
+		const PackFileEntry& entry = m_entries[index];
+		if (entry.pathHash == hash && EqualPaths(m_paths + entry.pathOffset, entry.pathLength, normalizedPath.c_str(), normalizedPath.size())) {
+			return index;
+		}
+	}
+	return InvalidIndex;
+}
+
+
+const void* PackFile::GetMappedData(size_t index) const {
+	const PackFileEntry& entry = m_entries[index];
+	if (entry.compression != (uint32_t)ePackCompression::NONE) {
+		return nullptr;
+	}
+	return static_cast<const uint8_t*>(m_file.GetData()) + entry.offset;
+}
+
+
+void PackFile::Read(size_t index, void* output) const {
+	const PackFileEntry& entry = m_entries[index];
+	const uint8_t* storedData = static_cast<const uint8_t*>(m_file.GetData()) + entry.offset;
+	switch ((ePackCompression)entry.compression) {
+		case ePackCompression::NONE:
+			std::memcpy(output, storedData, (size_t)entry.size);
+			break;
+		case ePackCompression::LZ4:
+			Lz4Decompress(storedData, (size_t)entry.storedSize, output, (size_t)entry.size);
+			break;
+	}
+}
+
+
+} // namespace inl
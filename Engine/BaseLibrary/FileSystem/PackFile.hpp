@@ -0,0 +1,88 @@
+#pragma once
+
+#include "../Platform/MappedFile.hpp"
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+
+namespace inl {
+
+
+enum class ePackCompression : uint32_t {
+	NONE = 0,
+	LZ4 = 1,
+};
+
+
+struct PackFileHeader;
+struct PackFileEntry;
+
+
+/// <summary> Collects files and writes them into a pack file. </summary>
+class PackFileWriter {
+public:
+	/// <summary> Adds a file to the pack under the given path. </summary>
+	/// <remarks> Compressed files which don't get smaller by at least an eighth are stored uncompressed,
+	///		so that they are mapped without a copy. </remarks>
+	/// <exception cref="InvalidArgumentException"> If a file with the same path was already added. </exception>
+	void AddFile(const std::string& path, const void* data, size_t size, ePackCompression compression = ePackCompression::LZ4);
+
+	/// <exception cref="RuntimeException"> If the file cannot be written. </exception>
+	void Write(const std::string& packPath) const;
+private:
+	struct File {
+		std::string path;
+		std::vector<uint8_t> storedData;
+		uint64_t size;
+		ePackCompression compression;
+	};
+	std::vector<File> m_files;
+	std::unordered_set<std::string> m_paths;
+};
+
+
+/// <summary> An archive of many files, mapped into memory as a whole. </summary>
+/// <remarks> The table of contents has a hash index of the paths, so files are found without touching the disk.
+///		Uncompressed files are aligned to 16 bytes and are read directly from the mapping.
+///		Paths are compared case insensitively, with either slash as separator.
+///		All methods are thread-safe. </remarks>
+class PackFile {
+public:
+	static constexpr const char* Extension = ".inlpack";
+	static constexpr size_t InvalidIndex = ~size_t(0);
+public:
+	/// <exception cref="FileNotFoundException"> If the file cannot be opened. </exception>
+	/// <exception cref="InvalidArgumentException"> If the file is not a valid pack file. </exception>
+	explicit PackFile(const std::string& path);
+
+	size_t GetEntryCount() const;
+	std::string GetEntryPath(size_t index) const;
+	/// <summary> Size of the entry after decompression. </summary>
+	size_t GetEntrySize(size_t index) const;
+	ePackCompression GetEntryCompression(size_t index) const;
+
+	/// <summary> Returns the index of the entry, or InvalidIndex if there is none with that path. </summary>
+	size_t Find(const std::string& path) const;
+
+	/// <summary> Returns the entry in the mapped file if it is stored uncompressed, otherwise null. </summary>
+	const void* GetMappedData(size_t index) const;
+
+	/// <summary> Decompresses or copies the entry into <paramref name="output"/>, which must hold <see cref="GetEntrySize"/> bytes. </summary>
+	/// <exception cref="InvalidArgumentException"> If the compressed data is corrupt. </exception>
+	void Read(size_t index, void* output) const;
+
+	/// <summary> Converts backslashes to slashes, removes empty and "." components and resolves "..". </summary>
+	static std::string NormalizePath(const std::string& path);
+private:
+	MappedFile m_file;
+	const PackFileHeader* m_header;
+	const PackFileEntry* m_entries;
+	const uint32_t* m_hashTable;
+	const char* m_paths;
+};
+
+
+} // namespace inl
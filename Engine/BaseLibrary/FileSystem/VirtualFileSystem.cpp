@@ -0,0 +1,127 @@
+#include "VirtualFileSystem.hpp"
+#include "../Exception/Exception.hpp"
+
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+
+
+namespace inl {
+
+
+static std::string NormalizeMountPoint(const std::string& mountPoint) {
+	std::string result = PackFile::NormalizePath(mountPoint);
+	if (!result.empty()) {
+		result += '/';
+	}
+	return result;
+}
+
+
+void VirtualFileSystem::MountPack(std::shared_ptr<const PackFile> pack, const std::string& mountPoint) {
+	Mount mount;
+	mount.mountPoint = NormalizeMountPoint(mountPoint);
+	mount.pack = std::move(pack);
+	m_mounts.push_back(std::move(mount));
+}
+
+
+void VirtualFileSystem::MountDirectory(const std::string& directory, const std::string& mountPoint) {
+	Mount mount;
+	mount.mountPoint = NormalizeMountPoint(mountPoint);
+	mount.directory = directory;
+	m_mounts.push_back(std::move(mount));
+}
+
+
+bool VirtualFileSystem::Exists(const std::string& path) const {
+	const std::string normalizedPath = PackFile::NormalizePath(path);
+	std::string pathInMount;
+	for (auto it = m_mounts.rbegin(); it != m_mounts.rend(); ++it) {
+		if (!GetPathInMount(*it, normalizedPath, pathInMount)) {
+			continue;
+		}
+		if (it->pack) {
+			if (it->pack->Find(pathInMount) != PackFile::InvalidIndex) {
+				return true;
+			}
+		}
+		else if (std::experimental::filesystem::is_regular_file(std::experimental::filesystem::path(it->directory) / pathInMount)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+
+VirtualFile VirtualFileSystem::Open(const std::string& path) const {
+	VirtualFile file;
+	if (!TryOpen(path, file)) {
+		throw FileNotFoundException("File is not in the virtual file system.", path);
+	}
+	return file;
+}
+
+
+bool VirtualFileSystem::TryOpen(const std::string& path, VirtualFile& file) const {
+	const std::string normalizedPath = PackFile::NormalizePath(path);
+	std::string pathInMount;
+	for (auto it = m_mounts.rbegin(); it != m_mounts.rend(); ++it) {
+		if (!GetPathInMount(*it, normalizedPath, pathInMount)) {
+			continue;
+		}
+
+		if (it->pack) {
+			const size_t index = it->pack->Find(pathInMount);
+			if (index == PackFile::InvalidIndex) {
+				continue;
+			}
+			file = VirtualFile();
+			file.m_size = it->pack->GetEntrySize(index);
+			if (const void* mappedData = it->pack->GetMappedData(index)) {
+				file.m_pack = it->pack;
+				file.m_data = mappedData;
+			}
+			else {
+				file.m_buffer.resize(file.m_size);
+				it->pack->Read(index, file.m_buffer.data());
+				file.m_data = file.m_buffer.data();
+			}
+			return true;
+		}
+
+		const std::string filePath = (std::experimental::filesystem::path(it->directory) / pathInMount).generic_string();
+		std::ifstream stream(filePath, std::ios::binary | std::ios::ate);
+		if (!stream.is_open()) {
+			continue;
+		}
+		file = VirtualFile();
+		file.m_buffer.resize((size_t)stream.tellg());
+		stream.seekg(0);
+		stream.read(reinterpret_cast<char*>(file.m_buffer.data()), file.m_buffer.size());
+		if (!stream.good()) {
+			throw RuntimeException("Could not read file.", filePath);
+		}
+		file.m_data = file.m_buffer.data();
+		file.m_size = file.m_buffer.size();
+		return true;
+	}
+	return false;
+}
+
+
+bool VirtualFileSystem::GetPathInMount(const Mount& mount, const std::string& normalizedPath, std::string& pathInMount) {
+	if (normalizedPath.size() < mount.mountPoint.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < mount.mountPoint.size(); ++i) {
+		if (std::tolower((unsigned char)normalizedPath[i]) != std::tolower((unsigned char)mount.mountPoint[i])) {
+			return false;
+		}
+	}
+	pathInMount = normalizedPath.substr(mount.mountPoint.size());
+	return true;
+}
+
+
+} // namespace inl
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "PackFile.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace inl {
+
+
+/// <summary> The contents of a file opened through the <see cref="VirtualFileSystem"/>. </summary>
+/// <remarks> Uncompressed files in packs point into the mapped pack, which is kept open while the file lives.
+///		Other files are read or decompressed into a buffer owned by this object. </remarks>
+class VirtualFile {
+	friend class VirtualFileSystem;
+public:
+	VirtualFile() = default;
+	VirtualFile(const VirtualFile&) = delete;
+	VirtualFile(VirtualFile&&) = default;
+	VirtualFile& operator=(const VirtualFile&) = delete;
+	VirtualFile& operator=(VirtualFile&&) = default;
+
+	const void* GetData() const { return m_data; }
+	size_t GetSize() const { return m_size; }
+
+	/// <summary> True if the data is read directly from a mapped pack, without a copy. </summary>
+	bool IsMapped() const { return m_pack != nullptr; }
+private:
+	std::shared_ptr<const PackFile> m_pack;
+	std::vector<uint8_t> m_buffer;
+	const void* m_data = nullptr;
+	size_t m_size = 0;
+};
+
+
+/// <summary> Opens files from mounted pack files and directories by path. </summary>
+/// <remarks> Mounts made later take precedence, so a patch can be mounted over the base pack.
+///		Looking up a file in a pack does not touch the disk, only mounted directories are searched on the disk.
+///		Mounting is not thread-safe, the other methods are. </remarks>
+class VirtualFileSystem {
+public:
+	/// <summary> Makes the files of the pack available under <paramref name="mountPoint"/>. </summary>
+	void MountPack(std::shared_ptr<const PackFile> pack, const std::string& mountPoint = "");
+
+	/// <summary> Makes the files in the directory available under <paramref name="mountPoint"/>. </summary>
+	void MountDirectory(const std::string& directory, const std::string& mountPoint = "");
+
+	bool Exists(const std::string& path) const;
+
+	/// <exception cref="FileNotFoundException"> If no mount has the file. </exception>
+	/// <exception cref="RuntimeException"> If the file cannot be read. </exception>
+	VirtualFile Open(const std::string& path) const;
+
+	/// <summary> Same as <see cref="Open"/>, but returns false instead of throwing if no mount has the file. </summary>
+	bool TryOpen(const std::string& path, VirtualFile& file) const;
+private:
+	struct Mount {
+		std::string mountPoint; // Normalized, ends with a slash unless empty.
+		std::shared_ptr<const PackFile> pack;
+		std::string directory;
+	};
+
+	// Returns false if the path is not under the mount point.
+	static bool GetPathInMount(const Mount& mount, const std::string& normalizedPath, std::string& pathInMount);
+private:
+	std::vector<Mount> m_mounts;
+};
+
+
+} // namespace inl
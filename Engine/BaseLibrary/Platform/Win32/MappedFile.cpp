@@ -0,0 +1,92 @@
+#include "MappedFile.hpp"
+#include "../../Exception/Exception.hpp"
+
+#include <utility>
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+
+
+namespace inl {
+
+
+MappedFile::MappedFile(const std::string& path) {
+	Open(path);
+}
+
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept {
+	*this = std::move(rhs);
+}
+
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept {
+	if (this != &rhs) {
+		Close();
+		std::swap(m_file, rhs.m_file);
+		std::swap(m_mapping, rhs.m_mapping);
+		std::swap(m_data, rhs.m_data);
+		std::swap(m_size, rhs.m_size);
+	}
+	return *this;
+}
+
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+
+void MappedFile::Open(const std::string& path) {
+	Close();
+
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		throw FileNotFoundException("Could not open file for mapping.", path);
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		CloseHandle(file);
+		throw RuntimeException("Empty files cannot be mapped.", path);
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == NULL) {
+		CloseHandle(file);
+		throw RuntimeException("Could not create file mapping.", path);
+	}
+
+	const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (data == nullptr) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		throw RuntimeException("Could not map view of file.", path);
+	}
+
+	m_file = file;
+	m_mapping = mapping;
+	m_data = data;
+	m_size = (size_t)size.QuadPart;
+}
+
+
+void MappedFile::Close() noexcept {
+	if (m_data != nullptr) {
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping != nullptr) {
+		CloseHandle(m_mapping);
+	}
+	if (m_file != nullptr) {
+		CloseHandle(m_file);
+	}
+	m_file = nullptr;
+	m_mapping = nullptr;
+	m_data = nullptr;
+	m_size = 0;
+}
+
+
+} // namespace inl
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+
+namespace inl {
+
+
+/// <summary> Maps a whole file into memory for reading. Pages are loaded by the OS as they are touched. </summary>
+class MappedFile {
+public:
+	MappedFile() = default;
+	/// <summary> Maps the file, see <see cref="Open"/>. </summary>
+	explicit MappedFile(const std::string& path);
+	MappedFile(const MappedFile&) = delete;
+	MappedFile(MappedFile&& rhs) noexcept;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile& operator=(MappedFile&& rhs) noexcept;
+	~MappedFile();
+
+	/// <summary> Maps the file, closing the previous one. </summary>
+	/// <exception cref="FileNotFoundException"> If the file cannot be opened. </exception>
+	/// <exception cref="RuntimeException"> If the file is empty or cannot be mapped. </exception>
+	void Open(const std::string& path);
+	void Close() noexcept;
+
+	bool IsOpen() const { return m_data != nullptr; }
+	const void* GetData() const { return m_data; }
+	size_t GetSize() const { return m_size; }
+private:
+	void* m_file = nullptr; // HANDLEs, Windows.h is not included here
+	void* m_mapping = nullptr;
+	const void* m_data = nullptr;
+	size_t m_size = 0;
+};
+
+
+} // namespace inl
@@ -0,0 +1,339 @@
+#include "AssetCache.hpp"
+
+#include <GraphicsEngine_LL/Pixel.hpp>
+
+#include <chrono>
+#include <limits>
+
+namespace inl::core {
+
+enum eContentType
+{
+	CONTENT_MESH,
+	CONTENT_TEXTURE,
+	CONTENT_MATERIAL,
+};
+
+template <class T>
+static bool IsReady(const std::shared_future<T>& future)
+{
+	return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+SharedGpuResource::SharedGpuResource(void* resource, size_t sizeInBytes, std::function<void()> release, std::shared_ptr<size_t> memoryUsage)
+:resource(resource), sizeInBytes(sizeInBytes), release(std::move(release)), memoryUsage(std::move(memoryUsage))
+{
+	*this->memoryUsage += sizeInBytes;
+}
+
+SharedGpuResource::~SharedGpuResource()
+{
+	release();
+	*memoryUsage -= sizeInBytes;
+}
+
+AssetCache::AssetCache(gxeng::GraphicsEngine* graphicsEngine, AssetLoader* assetLoader, size_t memoryBudget)
+:graphicsEngine(graphicsEngine), assetLoader(assetLoader), memoryBudget(memoryBudget), memoryUsage(std::make_shared<size_t>(0)), requestCounter(0)
+{
+}
+
+AssetCache::~AssetCache()
+{
+	// Materials go first, they hold the textures.
+	materials.clear();
+	meshes.clear();
+	textures.clear();
+}
+
+std::shared_ptr<CachedMesh> AssetCache::GetMesh(const std::string& modelPath, asset::CoordSysLayout coordSysLayout, eLoadPriority priority)
+{
+	const uint64_t settings = uint64_t(coordSysLayout.x) | uint64_t(coordSysLayout.y) << 8 | uint64_t(coordSysLayout.z) << 16;
+	const std::string key = modelPath + "|" + std::to_string(settings);
+
+	auto it = meshes.find(key);
+	if (it != meshes.end())
+	{
+		++statistics.hits;
+		it->second.lastRequest = ++requestCounter;
+		return it->second.asset;
+	}
+
+	++statistics.misses;
+	MeshRecord record;
+	record.asset = std::make_shared<CachedMesh>();
+	record.loading = assetLoader->LoadMesh(modelPath, coordSysLayout, priority);
+	record.settings = settings;
+	record.lastRequest = ++requestCounter;
+	meshes.insert({ key, record });
+	return record.asset;
+}
+
+std::shared_ptr<CachedTexture> AssetCache::GetTexture(const std::string& imagePath, eLoadPriority priority)
+{
+	auto it = textures.find(imagePath);
+	if (it != textures.end())
+	{
+		++statistics.hits;
+		it->second.lastRequest = ++requestCounter;
+		return it->second.asset;
+	}
+
+	++statistics.misses;
+	TextureRecord record;
+	record.asset = std::make_shared<CachedTexture>();
+	record.loading = assetLoader->LoadTexture(imagePath, priority);
+	record.settings = 0;
+	record.lastRequest = ++requestCounter;
+	textures.insert({ imagePath, record });
+	return record.asset;
+}
+
+std::shared_ptr<CachedMaterial> AssetCache::GetMaterial(const std::shared_ptr<CachedTexture>& texture)
+{
+	auto it = materials.find(texture.get());
+	if (it != materials.end())
+	{
+		++statistics.hits;
+		it->second.lastRequest = ++requestCounter;
+		return it->second.asset;
+	}
+
+	// Materials are not loaded, only created, so they are not counted as misses.
+	MaterialRecord record;
+	record.asset = std::make_shared<CachedMaterial>();
+	record.texture = texture;
+	record.lastRequest = ++requestCounter;
+	materials.insert({ texture.get(), record });
+	return record.asset;
+}
+
+void AssetCache::Update()
+{
+	size_t numUploads = 0;
+
+	for (auto& entry : meshes)
+	{
+		MeshRecord& record = entry.second;
+		if (numUploads < MaxUploadsPerUpdate && record.loading.valid() && IsReady(record.loading))
+		{
+			FinishMesh(record);
+			++numUploads;
+		}
+	}
+
+	for (auto& entry : textures)
+	{
+		TextureRecord& record = entry.second;
+		if (numUploads < MaxUploadsPerUpdate && record.loading.valid() && IsReady(record.loading))
+		{
+			FinishTexture(record);
+			++numUploads;
+		}
+	}
+
+	for (auto& entry : materials)
+	{
+		MaterialRecord& record = entry.second;
+		if (!record.asset->IsReady() && !record.asset->error)
+		{
+			if (record.texture->error)
+				record.asset->error = record.texture->error;
+			else if (record.texture->IsReady())
+				FinishMaterial(record);
+		}
+	}
+
+	Evict();
+}
+
+void AssetCache::SetMemoryBudget(size_t memoryBudget)
+{
+	this->memoryBudget = memoryBudget;
+}
+
+size_t AssetCache::GetMemoryBudget() const
+{
+	return memoryBudget;
+}
+
+AssetCache::Statistics AssetCache::GetStatistics() const
+{
+	Statistics result = statistics;
+	result.memoryUsage = *memoryUsage;
+	return result;
+}
+
+void AssetCache::FinishMesh(MeshRecord& record)
+{
+	try
+	{
+		std::shared_ptr<const LoadedMesh> loaded = record.loading.get();
+		record.loading = {};
+
+		record.asset->gpuResource = FindOrCreate({ CONTENT_MESH, loaded->contentHash, record.settings }, [this, &loaded]
+		{
+			gxeng::Mesh* mesh = graphicsEngine->CreateMesh();
+			size_t sizeInBytes;
+			try
+			{
+				if (loaded->cookedMesh)
+				{
+					const asset::CookedMesh& cookedMesh = *loaded->cookedMesh;
+					cookedMesh.SetMesh(*mesh);
+					sizeInBytes = cookedMesh.GetVertexCount() * cookedMesh.GetVertexStride() + cookedMesh.GetIndexCount() * (cookedMesh.IsIndex32Bit() ? 4 : 2);
+				}
+				else
+				{
+					mesh->Set(loaded->vertices.data(), &MeshVertex::GetReader(), loaded->vertices.size(), loaded->indices.data(), loaded->indices.size(), loaded->submeshes);
+					sizeInBytes = loaded->vertices.size() * sizeof(MeshVertex) + loaded->indices.size() * sizeof(unsigned);
+				}
+			}
+			catch (...)
+			{
+				delete mesh;
+				throw;
+			}
+			return std::make_shared<SharedGpuResource>(mesh, sizeInBytes, [mesh] { delete mesh; }, memoryUsage);
+		});
+	}
+	catch (...)
+	{
+		record.loading = {};
+		record.asset->error = std::current_exception();
+	}
+}
+
+void AssetCache::FinishTexture(TextureRecord& record)
+{
+	try
+	{
+		std::shared_ptr<const LoadedTexture> loaded = record.loading.get();
+		record.loading = {};
+
+		record.asset->gpuResource = FindOrCreate({ CONTENT_TEXTURE, loaded->contentHash, record.settings }, [this, &loaded]
+		{
+			using PixelT = gxeng::Pixel<gxeng::ePixelChannelType::INT8_NORM, 3, gxeng::ePixelClass::LINEAR>;
+			const asset::Image& img = loaded->image;
+
+			gxeng::Image* texture = graphicsEngine->CreateImage();
+			try
+			{
+				texture->SetLayout(img.GetWidth(), img.GetHeight(), gxeng::ePixelChannelType::INT8_NORM, 3, gxeng::ePixelClass::LINEAR);
+				texture->Update(0, 0, img.GetWidth(), img.GetHeight(), 0, img.GetData(), PixelT::Reader(), img.GetBytesPerRow());
+			}
+			catch (...)
+			{
+				delete texture;
+				throw;
+			}
+
+			// Three channel textures take four bytes per pixel on the GPU.
+			size_t sizeInBytes = img.GetWidth() * img.GetHeight() * 4;
+			return std::make_shared<SharedGpuResource>(texture, sizeInBytes, [texture] { delete texture; }, memoryUsage);
+		});
+	}
+	catch (...)
+	{
+		record.loading = {};
+		record.asset->error = std::current_exception();
+	}
+}
+
+void AssetCache::FinishMaterial(MaterialRecord& record)
+{
+	// Textures with the same contents share the GPU resource, and thus the material.
+	std::shared_ptr<SharedGpuResource> textureResource = record.texture->gpuResource;
+
+	record.asset->gpuResource = FindOrCreate({ CONTENT_MATERIAL, (uint64_t)(uintptr_t)textureResource.get(), 0 }, [this, &textureResource]
+	{
+		gxeng::Material* material = graphicsEngine->CreateMaterial();
+
+		gxeng::MaterialShaderGraph* graph = graphicsEngine->CreateMaterialShaderGraph();
+
+		std::unique_ptr<inl::gxeng::MaterialShaderEquation> mapShader(graphicsEngine->CreateMaterialShaderEquation());
+		std::unique_ptr<inl::gxeng::MaterialShaderEquation> diffuseShader(graphicsEngine->CreateMaterialShaderEquation());
+
+		mapShader->SetSourceName("bitmap_color_2d.mtl");
+		diffuseShader->SetSourceName("simple_diffuse.mtl");
+
+		std::vector<std::unique_ptr<inl::gxeng::MaterialShader>> nodes;
+		nodes.push_back(std::move(mapShader));
+		nodes.push_back(std::move(diffuseShader));
+		graph->SetGraph(std::move(nodes), { { 0, 1, 0 } });
+		material->SetShader(graph);
+
+		(*material)[0] = static_cast<gxeng::Image*>(textureResource->Get());
+
+		// The material keeps its texture alive.
+		return std::make_shared<SharedGpuResource>(material, sizeof(gxeng::Material), [material, graph, textureResource] { delete material; delete graph; }, memoryUsage);
+	});
+}
+
+void AssetCache::Evict()
+{
+	while (*memoryUsage > memoryBudget)
+	{
+		// Find the least recently requested asset that nobody holds and that is not loading.
+		// Material records hold their textures, so textures are only evicted after their materials.
+		uint64_t oldestRequest = std::numeric_limits<uint64_t>::max();
+		std::function<void()> evictOldest;
+
+		for (auto it = meshes.begin(); it != meshes.end(); ++it)
+		{
+			if (it->second.asset.use_count() == 1 && !it->second.loading.valid() && it->second.lastRequest < oldestRequest)
+			{
+				oldestRequest = it->second.lastRequest;
+				evictOldest = [this, it] { meshes.erase(it); };
+			}
+		}
+		for (auto it = textures.begin(); it != textures.end(); ++it)
+		{
+			if (it->second.asset.use_count() == 1 && !it->second.loading.valid() && it->second.lastRequest < oldestRequest)
+			{
+				oldestRequest = it->second.lastRequest;
+				evictOldest = [this, it] { textures.erase(it); };
+			}
+		}
+		for (auto it = materials.begin(); it != materials.end(); ++it)
+		{
+			if (it->second.asset.use_count() == 1 && it->second.lastRequest < oldestRequest)
+			{
+				oldestRequest = it->second.lastRequest;
+				evictOldest = [this, it] { materials.erase(it); };
+			}
+		}
+
+		if (!evictOldest)
+			break;
+
+		evictOldest();
+		++statistics.evictions;
+	}
+
+	for (auto it = contents.begin(); it != contents.end();)
+	{
+		if (it->second.expired())
+			it = contents.erase(it);
+		else
+			++it;
+	}
+}
+
+std::shared_ptr<SharedGpuResource> AssetCache::FindOrCreate(const ContentKey& key, const std::function<std::shared_ptr<SharedGpuResource>()>& create)
+{
+	auto it = contents.find(key);
+	if (it != contents.end())
+	{
+		if (std::shared_ptr<SharedGpuResource> resource = it->second.lock())
+		{
+			++statistics.contentHits;
+			return resource;
+		}
+	}
+
+	std::shared_ptr<SharedGpuResource> resource = create();
+	contents[key] = resource;
+	return resource;
+}
+
+} // namespace inl::core
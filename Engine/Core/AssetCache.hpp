@@ -0,0 +1,145 @@
+#pragma once
+#include "AssetLoader.hpp"
+
+#include <GraphicsEngine_LL/GraphicsEngine.hpp>
+#include <GraphicsEngine_LL/Mesh.hpp>
+#include <GraphicsEngine_LL/Image.hpp>
+#include <GraphicsEngine_LL/Material.hpp>
+
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+namespace inl::core {
+
+// A GPU resource, shared by every cached asset whose file has the same contents and import settings.
+// It is deleted when the last asset using it is evicted.
+class SharedGpuResource
+{
+public:
+	SharedGpuResource(void* resource, size_t sizeInBytes, std::function<void()> release, std::shared_ptr<size_t> memoryUsage);
+	~SharedGpuResource();
+
+	SharedGpuResource(const SharedGpuResource&) = delete;
+	SharedGpuResource& operator=(const SharedGpuResource&) = delete;
+
+	void* Get() const { return resource; }
+	size_t GetSizeInBytes() const { return sizeInBytes; }
+
+private:
+	void* resource;
+	size_t sizeInBytes;
+	std::function<void()> release;
+	std::shared_ptr<size_t> memoryUsage; // Outlives the cache if handles do.
+};
+
+// An asset handed out by the cache. Holding the handle keeps the asset from being evicted.
+// The resource is null until the asset has been loaded and uploaded by AssetCache::Update.
+template <class ResourceT>
+class CachedAsset
+{
+	friend class AssetCache;
+public:
+	bool IsReady() const { return gpuResource != nullptr; }
+	ResourceT* Get() const { return gpuResource ? static_cast<ResourceT*>(gpuResource->Get()) : nullptr; }
+
+	// Set if the asset could not be loaded, it won't become ready then.
+	std::exception_ptr GetError() const { return error; }
+
+private:
+	std::shared_ptr<SharedGpuResource> gpuResource;
+	std::exception_ptr error;
+};
+
+using CachedMesh = CachedAsset<gxeng::Mesh>;
+using CachedTexture = CachedAsset<gxeng::Image>;
+using CachedMaterial = CachedAsset<gxeng::Material>;
+
+// Shares meshes, textures and materials between everything that uses the same asset.
+// Assets are looked up by path and import settings, so each is loaded once, and GPU resources
+// are looked up by content hash, so files with the same contents are uploaded once.
+// Assets nobody holds a handle to are kept until the memory budget runs out, then the least
+// recently requested ones are evicted. All methods must be called from the game thread.
+class AssetCache
+{
+public:
+	struct Statistics
+	{
+		size_t hits = 0; // Requests served from the cache.
+		size_t misses = 0; // Requests that started loading.
+		size_t contentHits = 0; // Loads that found the GPU resource of another file with the same contents.
+		size_t evictions = 0;
+		size_t memoryUsage = 0; // Estimated size of the GPU resources in bytes.
+
+		double GetHitRate() const { return hits + misses > 0 ? double(hits) / double(hits + misses) : 0.0; }
+	};
+
+public:
+	AssetCache(gxeng::GraphicsEngine* graphicsEngine, AssetLoader* assetLoader, size_t memoryBudget = 512 * 1024 * 1024);
+	~AssetCache();
+
+	std::shared_ptr<CachedMesh> GetMesh(const std::string& modelPath, asset::CoordSysLayout coordSysLayout, eLoadPriority priority = eLoadPriority::NORMAL);
+	std::shared_ptr<CachedTexture> GetTexture(const std::string& imagePath, eLoadPriority priority = eLoadPriority::NORMAL);
+
+	// The default material showing the texture with diffuse lighting.
+	std::shared_ptr<CachedMaterial> GetMaterial(const std::shared_ptr<CachedTexture>& texture);
+
+	// Uploads the assets that finished loading, and evicts unused assets if over the memory budget.
+	void Update();
+
+	void SetMemoryBudget(size_t memoryBudget);
+	size_t GetMemoryBudget() const;
+	Statistics GetStatistics() const;
+
+protected:
+	template <class ResourceT, class LoadedT>
+	struct Record
+	{
+		std::shared_ptr<CachedAsset<ResourceT>> asset;
+		std::shared_future<std::shared_ptr<const LoadedT>> loading; // Reset when finished.
+		uint64_t settings; // Hash of the import settings.
+		uint64_t lastRequest;
+	};
+	using MeshRecord = Record<gxeng::Mesh, LoadedMesh>;
+	using TextureRecord = Record<gxeng::Image, LoadedTexture>;
+	struct MaterialRecord
+	{
+		std::shared_ptr<CachedMaterial> asset;
+		std::shared_ptr<CachedTexture> texture;
+		uint64_t lastRequest;
+	};
+
+	// Type of the resource, content hash and hash of the import settings.
+	using ContentKey = std::tuple<int, uint64_t, uint64_t>;
+
+	void FinishMesh(MeshRecord& record);
+	void FinishTexture(TextureRecord& record);
+	void FinishMaterial(MaterialRecord& record);
+	void Evict();
+
+	// Returns the shared resource of the content if it is still alive, otherwise creates it.
+	std::shared_ptr<SharedGpuResource> FindOrCreate(const ContentKey& key, const std::function<std::shared_ptr<SharedGpuResource>()>& create);
+
+protected:
+	gxeng::GraphicsEngine* graphicsEngine;
+	AssetLoader* assetLoader;
+
+	std::unordered_map<std::string, MeshRecord> meshes;
+	std::unordered_map<std::string, TextureRecord> textures;
+	std::unordered_map<const CachedTexture*, MaterialRecord> materials;
+	std::map<ContentKey, std::weak_ptr<SharedGpuResource>> contents;
+
+	size_t memoryBudget;
+	std::shared_ptr<size_t> memoryUsage;
+	Statistics statistics;
+	uint64_t requestCounter;
+
+	// At most this many assets are uploaded in an update, to spread the uploads of a large spawn over frames
+	static constexpr size_t MaxUploadsPerUpdate = 8;
+};
+
+} // namespace inl::core
@@ -0,0 +1,268 @@
+#include "AssetLoader.hpp"
+
+#include <BaseLibrary/Exception/Exception.hpp>
+#include <BaseLibrary/FileSystem/PackFile.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+
+namespace inl::core {
+
+AssetLoader::AssetLoader(unsigned numIoThreads, unsigned numDecodeThreads)
+:nextSequence(0), pendingCount(0), stopping(false)
+{
+	if (numDecodeThreads == 0)
+		numDecodeThreads = std::max(1, (int)std::thread::hardware_concurrency() - 1 - (int)numIoThreads);
+
+	for (unsigned i = 0; i < std::max(1u, numIoThreads); ++i)
+		threads.emplace_back(&AssetLoader::IoThreadFunc, this);
+
+	for (unsigned i = 0; i < numDecodeThreads; ++i)
+		threads.emplace_back(&AssetLoader::DecodeThreadFunc, this);
+}
+
+AssetLoader::~AssetLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	ioCondition.notify_all();
+	decodeCondition.notify_all();
+
+	for (auto& thread : threads)
+		thread.join();
+
+	// Requests still in the queues are destroyed with their promises, their futures report broken_promise.
+}
+
+std::shared_future<std::shared_ptr<const LoadedMesh>> AssetLoader::LoadMesh(const std::string& modelPath, asset::CoordSysLayout coordSysLayout, eLoadPriority priority)
+{
+	namespace fs = std::experimental::filesystem;
+
+	auto promise = std::make_shared<std::promise<std::shared_ptr<const LoadedMesh>>>();
+	std::shared_future<std::shared_ptr<const LoadedMesh>> future = promise->get_future().share();
+
+	// Cooked meshes are mapped by the decoder instead of being read. They must have been
+	// cooked with the same coordinate system layout.
+	fs::path cookedPath;
+	if (cookManifest)
+	{
+		cookedPath = FindCookedFile(modelPath);
+	}
+	else
+	{
+		cookedPath = modelPath;
+		cookedPath.replace_extension(asset::CookedMesh::Extension);
+	}
+	bool isCooked = cookManifest ? !cookedPath.empty() : fs::exists(cookedPath);
+
+	std::unique_ptr<Request> request(new Request());
+	request->priority = priority;
+	request->path = isCooked ? cookedPath.generic_string() : modelPath;
+	request->readFile = !isCooked;
+	request->decode = [promise, coordSysLayout, isCooked](Request& current)
+	{
+		auto mesh = std::make_shared<LoadedMesh>();
+		if (isCooked)
+		{
+			mesh->cookedMesh.reset(new asset::CookedMesh(current.path));
+
+			// Hashing reads every mapped page, so the game thread won't wait for the disk while uploading.
+			const asset::CookedMesh& cookedMesh = *mesh->cookedMesh;
+			const size_t indexSize = cookedMesh.IsIndex32Bit() ? 4 : 2;
+			const size_t vertexBytes = cookedMesh.GetVertexCount() * cookedMesh.GetVertexStride();
+			const size_t indexBytes = cookedMesh.GetIndexCount() * indexSize;
+			mesh->contentHash = HashContent(cookedMesh.GetIndices(), indexBytes, HashContent(cookedMesh.GetVertices(), vertexBytes));
+		}
+		else
+		{
+			mesh->contentHash = HashContent(current.data.data(), current.data.size());
+
+			std::string extension = fs::path(current.path).extension().generic_string();
+			asset::Model model(current.data.data(), current.data.size(), extension.empty() ? extension : extension.substr(1));
+
+			// This already runs on one of many decode threads, so the model is not split further.
+			mesh->vertices.resize(model.GetVertexCount());
+			model.GetAllVertices(mesh->vertices.data(), coordSysLayout, 1);
+
+			// Every submesh is drawn from the same buffers, with its own index range and base vertex.
+			mesh->submeshes = model.GetSubmeshTable(mesh->vertices.data(), mesh->indices);
+		}
+		promise->set_value(std::move(mesh));
+	};
+	request->fail = [promise](std::exception_ptr exception)
+	{
+		promise->set_exception(exception);
+	};
+
+	Submit(std::move(request));
+	return future;
+}
+
+void AssetLoader::SetCookManifest(std::shared_ptr<const asset::CookManifest> manifest, const std::string& sourceDirectory, const std::string& cookedDirectory)
+{
+	cookManifest = std::move(manifest);
+	cookSourceDirectory = PackFile::NormalizePath(sourceDirectory);
+	std::transform(cookSourceDirectory.begin(), cookSourceDirectory.end(), cookSourceDirectory.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+	cookOutputDirectory = cookedDirectory;
+}
+
+std::string AssetLoader::FindCookedFile(const std::string& sourcePath) const
+{
+	namespace fs = std::experimental::filesystem;
+
+	std::string path = PackFile::NormalizePath(sourcePath);
+	std::string lowerPath = path;
+	std::transform(lowerPath.begin(), lowerPath.end(), lowerPath.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+
+	// The manifest has paths relative to the source directory.
+	if (!cookSourceDirectory.empty())
+	{
+		if (lowerPath.compare(0, cookSourceDirectory.size(), cookSourceDirectory) != 0 || lowerPath.size() <= cookSourceDirectory.size() || lowerPath[cookSourceDirectory.size()] != '/')
+			return {};
+		path = path.substr(cookSourceDirectory.size() + 1);
+	}
+
+	const asset::CookManifest::Asset* asset = cookManifest->FindAsset(path);
+	if (asset == nullptr)
+		return {};
+	return (fs::path(cookOutputDirectory) / asset->cookedPath).generic_string();
+}
+
+std::shared_future<std::shared_ptr<const LoadedTexture>> AssetLoader::LoadTexture(const std::string& imagePath, eLoadPriority priority)
+{
+	auto promise = std::make_shared<std::promise<std::shared_ptr<const LoadedTexture>>>();
+	std::shared_future<std::shared_ptr<const LoadedTexture>> future = promise->get_future().share();
+
+	std::unique_ptr<Request> request(new Request());
+	request->priority = priority;
+	request->path = imagePath;
+	request->readFile = true;
+	request->decode = [promise](Request& current)
+	{
+		auto texture = std::make_shared<LoadedTexture>();
+		texture->image.Load(current.data.data(), current.data.size());
+		texture->contentHash = HashContent(current.data.data(), current.data.size());
+		promise->set_value(std::move(texture));
+	};
+	request->fail = [promise](std::exception_ptr exception)
+	{
+		promise->set_exception(exception);
+	};
+
+	Submit(std::move(request));
+	return future;
+}
+
+size_t AssetLoader::GetPendingCount() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return pendingCount;
+}
+
+void AssetLoader::Submit(std::unique_ptr<Request> request)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		request->sequence = nextSequence++;
+		++pendingCount;
+	}
+	Push(ioQueue, ioCondition, std::move(request));
+}
+
+void AssetLoader::IoThreadFunc()
+{
+	while (std::unique_ptr<Request> request = Pop(ioQueue, ioCondition))
+	{
+		if (request->readFile)
+		{
+			std::ifstream file(request->path, std::ios::binary | std::ios::ate);
+			if (!file.is_open())
+			{
+				request->fail(std::make_exception_ptr(FileNotFoundException("Could not open asset file.", request->path)));
+				Finish();
+				continue;
+			}
+			request->data.resize((size_t)file.tellg());
+			file.seekg(0);
+			file.read(reinterpret_cast<char*>(request->data.data()), request->data.size());
+			if (!file.good())
+			{
+				request->fail(std::make_exception_ptr(RuntimeException("Could not read asset file.", request->path)));
+				Finish();
+				continue;
+			}
+		}
+		Push(decodeQueue, decodeCondition, std::move(request));
+	}
+}
+
+void AssetLoader::DecodeThreadFunc()
+{
+	while (std::unique_ptr<Request> request = Pop(decodeQueue, decodeCondition))
+	{
+		try
+		{
+			request->decode(*request);
+		}
+		catch (...)
+		{
+			request->fail(std::current_exception());
+		}
+		Finish();
+	}
+}
+
+std::unique_ptr<AssetLoader::Request> AssetLoader::Pop(RequestQueue& queue, std::condition_variable& condition)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	condition.wait(lock, [this, &queue] { return stopping || !queue.empty(); });
+	if (stopping)
+		return nullptr;
+
+	std::pop_heap(queue.begin(), queue.end(), &AssetLoader::IsLaterRequest);
+	std::unique_ptr<Request> request = std::move(queue.back());
+	queue.pop_back();
+	return request;
+}
+
+void AssetLoader::Push(RequestQueue& queue, std::condition_variable& condition, std::unique_ptr<Request> request)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queue.push_back(std::move(request));
+		std::push_heap(queue.begin(), queue.end(), &AssetLoader::IsLaterRequest);
+	}
+	condition.notify_one();
+}
+
+void AssetLoader::Finish()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	--pendingCount;
+}
+
+uint64_t AssetLoader::HashContent(const void* data, size_t size, uint64_t hash)
+{
+	// FNV-1a
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+bool AssetLoader::IsLaterRequest(const std::unique_ptr<Request>& lhs, const std::unique_ptr<Request>& rhs)
+{
+	// The heap keeps the greatest element on top: the highest priority, then the oldest request.
+	if (lhs->priority != rhs->priority)
+		return lhs->priority < rhs->priority;
+	return lhs->sequence > rhs->sequence;
+}
+
+} // namespace inl::core
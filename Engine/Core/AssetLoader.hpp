@@ -0,0 +1,119 @@
+#pragma once
+#include <AssetLibrary/Model.hpp>
+#include <AssetLibrary/Image.hpp>
+#include <AssetLibrary/CookedMesh.hpp>
+#include <AssetLibrary/CookManifest.hpp>
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace inl::core {
+
+enum class eLoadPriority
+{
+	LOW,
+	NORMAL,
+	HIGH,
+};
+
+// Vertex layout of the meshes loaded for actors.
+using MeshVertex = gxeng::Vertex<gxeng::Position<0>, gxeng::Normal<0>, gxeng::TexCoord<0>>;
+
+// A mesh decoded by the loader. Either the vertices, indices and submeshes are filled, or the cooked mesh is set.
+// Submeshes follow each other in the buffers, their indices are relative to their base vertex.
+struct LoadedMesh
+{
+	std::vector<MeshVertex> vertices;
+	std::vector<unsigned> indices;
+	std::vector<gxeng::Mesh::Submesh> submeshes;
+	std::unique_ptr<asset::CookedMesh> cookedMesh;
+	uint64_t contentHash; // Of the file, files with the same contents decode to the same mesh.
+};
+
+// An image decoded by the loader.
+struct LoadedTexture
+{
+	asset::Image image;
+	uint64_t contentHash; // Of the file.
+};
+
+// Reads and decodes assets on worker threads, so that loading does not stall the game thread.
+// Files are read by the I/O threads, then parsed by the decode threads. Both stages serve
+// higher priority requests first, and requests of the same priority in order.
+// GPU resources are not created here, the results are uploaded by the game thread.
+class AssetLoader
+{
+public:
+	// 0 decode threads means one for each core that is left after the game and I/O threads.
+	AssetLoader(unsigned numIoThreads = 1, unsigned numDecodeThreads = 0);
+	~AssetLoader();
+
+	// Loads all submeshes of the model into one mesh, or its cooked mesh if there is one.
+	// The future holds the exception if the file can't be read or decoded.
+	std::shared_future<std::shared_ptr<const LoadedMesh>> LoadMesh(const std::string& modelPath, asset::CoordSysLayout coordSysLayout, eLoadPriority priority = eLoadPriority::NORMAL);
+
+	// Without a manifest, the cooked mesh is looked for next to the model. With one, it is looked up
+	// in the manifest written by the asset cooker, and the disk is not searched.
+	// Paths in the manifest are relative to the source and cooked directories. Call before loading.
+	// The engine does not know where the cooked assets are, so this is opt-in: applications that run
+	// the asset cooker call it through Core::GetAssetLoader().
+	void SetCookManifest(std::shared_ptr<const asset::CookManifest> manifest, const std::string& sourceDirectory, const std::string& cookedDirectory);
+
+	// The future holds the exception if the file can't be read or decoded.
+	std::shared_future<std::shared_ptr<const LoadedTexture>> LoadTexture(const std::string& imagePath, eLoadPriority priority = eLoadPriority::NORMAL);
+
+	// Requests submitted but not finished yet.
+	size_t GetPendingCount() const;
+
+protected:
+	struct Request
+	{
+		eLoadPriority priority;
+		uint64_t sequence;
+		std::string path;
+		bool readFile; // Otherwise the decoder opens the file itself.
+		std::vector<uint8_t> data;
+		std::function<void(Request&)> decode;
+		std::function<void(std::exception_ptr)> fail;
+	};
+	using RequestQueue = std::vector<std::unique_ptr<Request>>; // Kept as a heap.
+
+	void Submit(std::unique_ptr<Request> request);
+	void IoThreadFunc();
+	void DecodeThreadFunc();
+
+	// Blocks until there is a request in the queue, returns null when stopping.
+	std::unique_ptr<Request> Pop(RequestQueue& queue, std::condition_variable& condition);
+	void Push(RequestQueue& queue, std::condition_variable& condition, std::unique_ptr<Request> request);
+	void Finish();
+
+	// Returns empty if the manifest has no cooked asset for the source file.
+	std::string FindCookedFile(const std::string& sourcePath) const;
+
+	static uint64_t HashContent(const void* data, size_t size, uint64_t hash = 14695981039346656037ull);
+	static bool IsLaterRequest(const std::unique_ptr<Request>& lhs, const std::unique_ptr<Request>& rhs);
+
+protected:
+	mutable std::mutex mutex;
+	std::condition_variable ioCondition;
+	std::condition_variable decodeCondition;
+	RequestQueue ioQueue;
+	RequestQueue decodeQueue;
+	uint64_t nextSequence;
+	size_t pendingCount;
+	bool stopping;
+
+	std::vector<std::thread> threads;
+
+	std::shared_ptr<const asset::CookManifest> cookManifest;
+	std::string cookSourceDirectory; // Normalized and lower case.
+	std::string cookOutputDirectory;
+};
+
+} // namespace inl::core
@@ -8,8 +8,9 @@
 namespace inl::core {
 
 Core::Core()
-:graphicsEngine(0), physicsEngine(0)/*, soundEngine(0), networkEngine(0)*/
+:graphicsEngine(0), physicsEngine(0), assetCache(0)/*, soundEngine(0), networkEngine(0)*/
 {
+	assetLoader = new AssetLoader();
 
 }
 
@@ -30,6 +31,9 @@ Core::~Core()
 	for (Scene* a : scenes)
 		delete a;
 
+	delete assetCache;
+	delete assetLoader;
+
 	//for (auto& a : importedModels)
 	//	delete a.second;
 	//
@@ -73,6 +77,9 @@ gxeng::GraphicsEngine* Core::InitGraphicsEngine(int width, int height, HWND hwnd
 
 	graphicsEngine = new gxeng::GraphicsEngine(desc);
 
+	delete assetCache;
+	assetCache = new AssetCache(graphicsEngine, assetLoader);
+
 	graphicsEngine->SetEnvVariable("world_render_size", inl::Any(Vec2(width, height)));
 
 	return graphicsEngine;
@@ -656,6 +663,9 @@ void Core::Update(float deltaTime)
 	//}
 	
 
+	if (assetCache)
+		assetCache->Update();
+
 	for (Scene* scene : scenes)
 		scene->Update(deltaTime);
 
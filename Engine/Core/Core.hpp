@@ -16,6 +16,8 @@
 #include "PerspCameraPart.hpp"
 #include "Common.hpp"
 #include "Scene.hpp"
+#include "AssetLoader.hpp"
+#include "AssetCache.hpp"
 
 #include <unordered_map>
 #include <vector>
@@ -73,6 +75,9 @@ public:
 	
 	gxeng::GraphicsEngine*	 GetGraphicsEngine() const { return graphicsEngine; }
 	physics::bullet::PhysicsEngineBullet*	 GetPhysicsEngine() const { return physicsEngine; }
+	AssetLoader*			 GetAssetLoader() const { return assetLoader; }
+	AssetCache*				 GetAssetCache() const { return assetCache; }
+	Logger*					 GetLogger() { return &logger; }
 	//inline INetworkEngine*	 GetNetworkEngine() const { return networkEngine; }
 	//inline ISoundEngine*	 GetSoundEngine() const { return soundEngine; }
 
@@ -89,6 +94,12 @@ protected:
 	// guiEngine
 	GuiEngine* guiEngine;
 
+	// Loads assets on worker threads
+	AssetLoader* assetLoader;
+
+	// Shares the loaded assets between actors, created with the graphics engine
+	AssetCache* assetCache;
+
 	std::vector<Scene*> scenes;
 
 	// Scripts operating on scenes
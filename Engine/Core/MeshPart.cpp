@@ -15,4 +15,10 @@ void MeshPart::UpdateEntityTransform()
 	entity->SetScale(GetScale());
 }
 
+void MeshPart::SetAssets(std::shared_ptr<CachedMesh> mesh, std::shared_ptr<CachedMaterial> material)
+{
+	meshAsset = std::move(mesh);
+	materialAsset = std::move(material);
+}
+
 } // namespace inl::core
\ No newline at end of file
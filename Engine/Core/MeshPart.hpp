@@ -1,5 +1,6 @@
 #pragma once
 #include "Part.hpp"
+#include "AssetCache.hpp"
 #include <GraphicsEngine_LL\MeshEntity.hpp>
 
 namespace inl::core {
@@ -14,8 +15,13 @@ public:
 
 	void UpdateEntityTransform() override;
 
+	// The assets stay in the cache as long as the part holds them.
+	void SetAssets(std::shared_ptr<CachedMesh> mesh, std::shared_ptr<CachedMaterial> material);
+
 protected:
 	gxeng::MeshEntity* entity;
+	std::shared_ptr<CachedMesh> meshAsset;
+	std::shared_ptr<CachedMaterial> materialAsset;
 };
 
 } // namespace inl::core
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <AssetLibrary/Model.hpp>
 #include <AssetLibrary/Image.hpp>
+#include <AssetLibrary/CookedMesh.hpp>
 #include <GraphicsEngine_LL/Pixel.hpp>
 #include <GraphicsEngine_LL/Mesh.hpp>
 #include <GraphicsEngine_LL/Material.hpp>
@@ -17,6 +18,7 @@ Scene::Scene(Core* core)
 {
 	graphicsScene = core->GetGraphicsEngine()->CreateScene("World");
 	physicsScene = core->GetPhysicsEngine()->CreateScene();
+	logStream = core->GetLogger()->CreateLogStream("Scene");
 
 	DirectionalLightActor* sun = AddActor_DirectionalLight();
 
@@ -26,6 +28,8 @@ Scene::Scene(Core* core)
 
 void Scene::Update(float deltaTime)
 {
+	FinishPendingMeshes();
+
 	for (Part* part : parts)
 		part->UpdateEntityTransform();
 	
@@ -87,65 +91,69 @@ void Scene::AddActor(Actor* a)
 	parts.push_back(a);
 }
 
-MeshActor* Scene::AddActor_Mesh(const path& modelPath)
+MeshActor* Scene::AddActor_Mesh(const path& modelPath, eLoadPriority priority)
 {
-	gxeng::GraphicsEngine* graphicsEngine = core->GetGraphicsEngine();
-	
-	auto str = modelPath.generic_string();
-	std::wstring path = modelPath;
-	Model* model = new Model(std::string(path.begin(), path.end()));
-	
+	AssetCache* assetCache = core->GetAssetCache();
+
 	inl::asset::CoordSysLayout coordSysLayout = { AxisDir::POS_X,   AxisDir::NEG_Z , AxisDir::NEG_Y };
-	
-	auto modelVertices = model->GetVertices<gxeng::Position<0>, gxeng::Normal<0>, gxeng::TexCoord<0>>(0, coordSysLayout);
-	std::vector<unsigned> modelIndices = model->GetIndices(0);
-	
-	gxeng::Mesh* mesh = graphicsEngine->CreateMesh();
-	mesh->Set(modelVertices.data(), &modelVertices[0].GetReader(), modelVertices.size(), modelIndices.data(), modelIndices.size());
-	
-	gxeng::MeshEntity* entity = new gxeng::MeshEntity();
-	entity->SetMesh(mesh);
-	
-	// Create material
-	gxeng::Material* material = graphicsEngine->CreateMaterial();
-	
-	gxeng::MaterialShaderGraph* graph = graphicsEngine->CreateMaterialShaderGraph();
-	
-	std::unique_ptr<inl::gxeng::MaterialShaderEquation> mapShader(graphicsEngine->CreateMaterialShaderEquation());
-	std::unique_ptr<inl::gxeng::MaterialShaderEquation> diffuseShader(graphicsEngine->CreateMaterialShaderEquation());
-	
-	mapShader->SetSourceName("bitmap_color_2d.mtl");
-	diffuseShader->SetSourceName("simple_diffuse.mtl");
-	
-	std::vector<std::unique_ptr<inl::gxeng::MaterialShader>> nodes;
-	nodes.push_back(std::move(mapShader));
-	nodes.push_back(std::move(diffuseShader));
-	graph->SetGraph(std::move(nodes), { { 0, 1, 0 } });
-	material->SetShader(graph);
-	
-	// Create texture
-	{
-		using PixelT = gxeng::Pixel<gxeng::ePixelChannelType::INT8_NORM, 3, gxeng::ePixelClass::LINEAR>;
-		static inl::asset::Image img("assets\\pine_tree.jpg");
-	
-		gxeng::Image* texture = graphicsEngine->CreateImage();
-			
-		texture->SetLayout(img.GetWidth(), img.GetHeight(), gxeng::ePixelChannelType::INT8_NORM, 3, gxeng::ePixelClass::LINEAR);
-		texture->Update(0, 0, img.GetWidth(), img.GetHeight(), 0, img.GetData(), PixelT::Reader());
 
-		(*material)[0] = texture;
-	}
-	
-	entity->SetMaterial(material);
-	
-	graphicsScene->GetMeshEntities().Add(entity);
-	
-	MeshActor* a = new MeshActor(this, entity);
+	// Actors of the same model share the assets, they are only loaded for the first one.
+	// The entity is added to the graphics scene when the assets are ready, see FinishPendingMeshes
+	PendingMesh pending;
+	pending.entity = new gxeng::MeshEntity();
+	pending.modelPath = modelPath.generic_string();
+	pending.mesh = assetCache->GetMesh(modelPath.generic_string(), coordSysLayout, priority);
+	pending.material = assetCache->GetMaterial(assetCache->GetTexture("assets\\pine_tree.jpg", priority));
+	pendingMeshes.push_back(pending);
+
+	MeshActor* a = new MeshActor(this, pending.entity);
+	a->SetAssets(pending.mesh, pending.material);
 	actors.push_back(a);
 	parts.push_back(a);
 	return a;
 }
 
+void Scene::FinishPendingMeshes()
+{
+	// The assets are uploaded by AssetCache::Update, before the scenes are updated
+	for (auto it = pendingMeshes.begin(); it != pendingMeshes.end();)
+	{
+		// Assets which failed to load are logged, the actor stays without a graphics entity
+		if (it->mesh->GetError() || it->material->GetError())
+		{
+			std::exception_ptr error = it->mesh->GetError() ? it->mesh->GetError() : it->material->GetError();
+			std::string reason = "unknown error";
+			try
+			{
+				std::rethrow_exception(error);
+			}
+			catch (std::exception& ex)
+			{
+				reason = ex.what();
+			}
+			catch (...)
+			{
+			}
+			logStream.Event("Failed to load mesh actor " + it->modelPath + ": " + reason);
+
+			it = pendingMeshes.erase(it);
+			continue;
+		}
+
+		if (!it->mesh->IsReady() || !it->material->IsReady())
+		{
+			++it;
+			continue;
+		}
+
+		it->entity->SetMesh(it->mesh->Get());
+		it->entity->SetMaterial(it->material->Get());
+		graphicsScene->GetMeshEntities().Add(it->entity);
+
+		it = pendingMeshes.erase(it);
+	}
+}
+
 RigidBodyActor* Scene::AddActor_RigidBody(const path& modelPath, float mass /*= 0*/)
 {
 	// Load model
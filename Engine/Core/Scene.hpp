@@ -3,6 +3,7 @@
 #include "Common.hpp"
 
 #include "Actors.hpp"
+#include "AssetCache.hpp"
 
 #include <GraphicsEngine_LL\GraphicsEngine.hpp>
 #include <GraphicsEngine_LL\Scene.hpp>
@@ -10,6 +11,7 @@
 
 // TMP !!
 #include <GraphicsEngine_LL\DirectionalLight.hpp>
+#include <BaseLibrary\Logging\LogStream.hpp>
 #include <filesystem>
 
 
@@ -37,7 +39,8 @@ public:
 
 	EmptyActor*				AddActor();
 	void					AddActor(Actor* a);
-	MeshActor*				AddActor_Mesh(const path& modelPath);
+	// The actor becomes visible once its mesh and texture are loaded, see Update.
+	MeshActor*				AddActor_Mesh(const path& modelPath, eLoadPriority priority = eLoadPriority::NORMAL);
 	RigidBodyActor*			AddActor_RigidBody(const path& modelPath, float mass = 0);
 	RigidBodyActor*			AddActor_RigidBodyCapsule(float height, float radius, float mass = 0);
 	PerspCameraActor*		AddActor_PerspCamera();
@@ -59,6 +62,10 @@ public:
 	//bool TracePhysicsRay(const Vec3& from, const Vec3& to, PhysicsTraceResult& traceInfo_out);
 	//bool TraceClosestPoint_Physics(PhysicsTraceResult& traceInfo_out);
 
+protected:
+	// Adds the mesh actors whose assets are ready to the graphics scene
+	void FinishPendingMeshes();
+
 protected:
 	// Core
 	Core* core;
@@ -74,6 +81,19 @@ protected:
 
 	std::vector<Part*> parts;
 
+	// Mesh actors whose assets are still loading
+	struct PendingMesh
+	{
+		gxeng::MeshEntity* entity;
+		std::string modelPath;
+		std::shared_ptr<CachedMesh> mesh;
+		std::shared_ptr<CachedMaterial> material;
+	};
+	std::vector<PendingMesh> pendingMeshes;
+
+	// Reports assets which failed to load
+	LogStream logStream;
+
 	// TMP REMOVE
 	inl::gxeng::DirectionalLight* sun;
 };
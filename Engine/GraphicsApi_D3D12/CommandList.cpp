@@ -137,6 +137,26 @@ void CopyCommandList::ResourceBarrier(unsigned numBarriers, gxapi::ResourceBarri
 }
 
 
+// queries
+static D3D12_QUERY_TYPE GetQueryType(gxapi::IQueryHeap* heap) {
+	switch (heap->GetDesc().type) {
+	case gxapi::eQueryHeapType::TIMESTAMP:
+		return D3D12_QUERY_TYPE_TIMESTAMP;
+	default:
+		assert(false);
+		return D3D12_QUERY_TYPE{};
+	}
+}
+
+void CopyCommandList::EndQuery(gxapi::IQueryHeap* heap, unsigned index) {
+	m_native->EndQuery(native_cast(heap), GetQueryType(heap), index);
+}
+
+void CopyCommandList::ResolveQueryData(gxapi::IQueryHeap* heap, unsigned firstIndex, unsigned numQueries, gxapi::IResource* destination, size_t destinationOffset) {
+	m_native->ResolveQueryData(native_cast(heap), GetQueryType(heap), firstIndex, numQueries, native_cast(destination), destinationOffset);
+}
+
+
 // helpers
 D3D12_TEXTURE_COPY_LOCATION CopyCommandList::CreateTextureCopyLocation(gxapi::IResource* resource, gxapi::TextureCopyDesc description) {
 
@@ -166,6 +186,12 @@ D3D12_TEXTURE_COPY_LOCATION CopyCommandList::CreateTextureCopyLocation(gxapi::IR
 				footprint.Height = description.height;
 				footprint.Width = (UINT)description.width; // narrowing conversion!
 				size_t rowSize = size_t(GetFormatSizeInBytes(description.format)*description.width);
+				if (IsBlockCompressed(description.format)) {
+					// footprints of block compressed formats cover whole 4x4 blocks
+					footprint.Width = (footprint.Width + 3) / 4 * 4;
+					footprint.Height = (footprint.Height + 3) / 4 * 4;
+					rowSize = size_t(GetFormatBlockSizeInBytes(description.format)) * (footprint.Width / 4);
+				}
 				size_t alignement = D3D12_TEXTURE_DATA_PITCH_ALIGNMENT;
 				footprint.RowPitch = static_cast<UINT>(rowSize + (alignement - rowSize % alignement) % alignement);
 			}
@@ -55,5 +55,12 @@ gxapi::CommandQueueDesc CommandQueue::GetDesc() const {
 }
 
 
+uint64_t CommandQueue::GetTimestampFrequency() const {
+	UINT64 frequency;
+	ThrowIfFailed(m_native->GetTimestampFrequency(&frequency));
+	return frequency;
+}
+
+
 } // namespace gxapi_dx12
 } // namespace inl
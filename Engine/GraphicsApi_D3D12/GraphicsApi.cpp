@@ -4,6 +4,7 @@
 #include "CommandAllocator.hpp"
 #include "CommandList.hpp"
 #include "DescriptorHeap.hpp"
+#include "QueryHeap.hpp"
 #include "NativeCast.hpp"
 #include "ExceptionExpansions.hpp"
 
@@ -306,6 +307,16 @@ gxapi::IDescriptorHeap* GraphicsApi::CreateDescriptorHeap(gxapi::DescriptorHeapD
 }
 
 
+gxapi::IQueryHeap* GraphicsApi::CreateQueryHeap(gxapi::QueryHeapDesc desc) {
+	ComPtr<ID3D12QueryHeap> native;
+
+	auto nativeDesc = native_cast(desc);
+	ThrowIfFailed(m_device->CreateQueryHeap(&nativeDesc, IID_PPV_ARGS(&native)));
+
+	return new QueryHeap{ native, desc };
+}
+
+
 void GraphicsApi::CreateConstantBufferView(gxapi::ConstantBufferViewDesc desc,
 										   gxapi::DescriptorHandle destination)
 {
@@ -42,6 +42,7 @@ public:
 	gxapi::IPipelineState* CreateComputePipelineState(const gxapi::ComputePipelineStateDesc& desc) override;
 
 	gxapi::IDescriptorHeap* CreateDescriptorHeap(gxapi::DescriptorHeapDesc desc) override;
+	gxapi::IQueryHeap* CreateQueryHeap(gxapi::QueryHeapDesc desc) override;
 
 
 	void CreateConstantBufferView(gxapi::ConstantBufferViewDesc desc,
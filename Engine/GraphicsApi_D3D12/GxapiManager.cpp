@@ -408,6 +408,12 @@ gxapi::ShaderProgramBinary GxapiManager::CompileShaderFromFile(const std::string
 }
 
 
+std::string GxapiManager::GetShaderCompilerId() {
+	// Shader model is fixed by GetTarget, it's part of the id so that changing it invalidates binaries.
+	return "D3DCompiler_" + std::to_string(D3D_COMPILER_VERSION) + "_sm5_1";
+}
+
+
 const char* GxapiManager::GetTarget(gxapi::eShaderType type) {
 	switch (type)
 	{
@@ -119,6 +119,14 @@ ID3D12Fence* native_cast(gxapi::IFence * source) {
 	return static_cast<Fence*>(source)->GetNative();
 }
 
+ID3D12QueryHeap* native_cast(gxapi::IQueryHeap* source) {
+	if (source == nullptr) {
+		return nullptr;
+	}
+
+	return static_cast<QueryHeap*>(source)->GetNative();
+}
+
 ID3D12CommandQueue* native_cast(gxapi::ICommandQueue* source) {
 	if (source == nullptr) {
 		return nullptr;
@@ -215,6 +223,20 @@ D3D12_DESCRIPTOR_HEAP_TYPE native_cast(gxapi::eDescriptorHeapType source) {
 }
 
 
+D3D12_QUERY_HEAP_TYPE native_cast(gxapi::eQueryHeapType source) {
+	using gxapi::eQueryHeapType;
+	switch (source) {
+	case eQueryHeapType::TIMESTAMP:
+		return D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+	default:
+		assert(false);
+		break;
+	}
+
+	return D3D12_QUERY_HEAP_TYPE{};
+}
+
+
 D3D12_ROOT_PARAMETER_TYPE native_cast(gxapi::RootParameterDesc::eType source) {
 	switch (source) {
 	case gxapi::RootParameterDesc::CONSTANT:
@@ -605,6 +627,42 @@ DXGI_FORMAT native_cast(gxapi::eFormat source) {
 		return DXGI_FORMAT_R8_SINT;
 	case gxapi::eFormat::A8_UNORM:
 		return DXGI_FORMAT_A8_UNORM;
+	case gxapi::eFormat::BC1_TYPELESS:
+		return DXGI_FORMAT_BC1_TYPELESS;
+	case gxapi::eFormat::BC1_UNORM:
+		return DXGI_FORMAT_BC1_UNORM;
+	case gxapi::eFormat::BC1_UNORM_SRGB:
+		return DXGI_FORMAT_BC1_UNORM_SRGB;
+	case gxapi::eFormat::BC2_TYPELESS:
+		return DXGI_FORMAT_BC2_TYPELESS;
+	case gxapi::eFormat::BC2_UNORM:
+		return DXGI_FORMAT_BC2_UNORM;
+	case gxapi::eFormat::BC2_UNORM_SRGB:
+		return DXGI_FORMAT_BC2_UNORM_SRGB;
+	case gxapi::eFormat::BC3_TYPELESS:
+		return DXGI_FORMAT_BC3_TYPELESS;
+	case gxapi::eFormat::BC3_UNORM:
+		return DXGI_FORMAT_BC3_UNORM;
+	case gxapi::eFormat::BC3_UNORM_SRGB:
+		return DXGI_FORMAT_BC3_UNORM_SRGB;
+	case gxapi::eFormat::BC4_TYPELESS:
+		return DXGI_FORMAT_BC4_TYPELESS;
+	case gxapi::eFormat::BC4_UNORM:
+		return DXGI_FORMAT_BC4_UNORM;
+	case gxapi::eFormat::BC4_SNORM:
+		return DXGI_FORMAT_BC4_SNORM;
+	case gxapi::eFormat::BC5_TYPELESS:
+		return DXGI_FORMAT_BC5_TYPELESS;
+	case gxapi::eFormat::BC5_UNORM:
+		return DXGI_FORMAT_BC5_UNORM;
+	case gxapi::eFormat::BC5_SNORM:
+		return DXGI_FORMAT_BC5_SNORM;
+	case gxapi::eFormat::BC7_TYPELESS:
+		return DXGI_FORMAT_BC7_TYPELESS;
+	case gxapi::eFormat::BC7_UNORM:
+		return DXGI_FORMAT_BC7_UNORM;
+	case gxapi::eFormat::BC7_UNORM_SRGB:
+		return DXGI_FORMAT_BC7_UNORM_SRGB;
 
 	default:
 		assert(false);
@@ -1306,6 +1364,17 @@ D3D12_DESCRIPTOR_HEAP_DESC native_cast(gxapi::DescriptorHeapDesc source) {
 }
 
 
+D3D12_QUERY_HEAP_DESC native_cast(gxapi::QueryHeapDesc source) {
+	D3D12_QUERY_HEAP_DESC result;
+
+	result.Type = native_cast(source.type);
+	result.Count = source.numQueries;
+	result.NodeMask = 0;
+
+	return result;
+}
+
+
 D3D12_BLEND_DESC native_cast(gxapi::BlendState source) {
 	D3D12_BLEND_DESC result;
 
@@ -2153,6 +2222,42 @@ gxapi::eFormat native_cast(DXGI_FORMAT source) {
 		return gxapi::eFormat::R8_SINT;
 	case DXGI_FORMAT_A8_UNORM:
 		return gxapi::eFormat::A8_UNORM;
+	case DXGI_FORMAT_BC1_TYPELESS:
+		return gxapi::eFormat::BC1_TYPELESS;
+	case DXGI_FORMAT_BC1_UNORM:
+		return gxapi::eFormat::BC1_UNORM;
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+		return gxapi::eFormat::BC1_UNORM_SRGB;
+	case DXGI_FORMAT_BC2_TYPELESS:
+		return gxapi::eFormat::BC2_TYPELESS;
+	case DXGI_FORMAT_BC2_UNORM:
+		return gxapi::eFormat::BC2_UNORM;
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+		return gxapi::eFormat::BC2_UNORM_SRGB;
+	case DXGI_FORMAT_BC3_TYPELESS:
+		return gxapi::eFormat::BC3_TYPELESS;
+	case DXGI_FORMAT_BC3_UNORM:
+		return gxapi::eFormat::BC3_UNORM;
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+		return gxapi::eFormat::BC3_UNORM_SRGB;
+	case DXGI_FORMAT_BC4_TYPELESS:
+		return gxapi::eFormat::BC4_TYPELESS;
+	case DXGI_FORMAT_BC4_UNORM:
+		return gxapi::eFormat::BC4_UNORM;
+	case DXGI_FORMAT_BC4_SNORM:
+		return gxapi::eFormat::BC4_SNORM;
+	case DXGI_FORMAT_BC5_TYPELESS:
+		return gxapi::eFormat::BC5_TYPELESS;
+	case DXGI_FORMAT_BC5_UNORM:
+		return gxapi::eFormat::BC5_UNORM;
+	case DXGI_FORMAT_BC5_SNORM:
+		return gxapi::eFormat::BC5_SNORM;
+	case DXGI_FORMAT_BC7_TYPELESS:
+		return gxapi::eFormat::BC7_TYPELESS;
+	case DXGI_FORMAT_BC7_UNORM:
+		return gxapi::eFormat::BC7_UNORM;
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		return gxapi::eFormat::BC7_UNORM_SRGB;
 	default:
 		assert(false);
 		break;
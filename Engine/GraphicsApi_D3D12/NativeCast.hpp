@@ -8,6 +8,7 @@
 #include "DescriptorHeap.hpp"
 #include "CommandList.hpp"
 #include "Fence.hpp"
+#include "QueryHeap.hpp"
 #include "../GraphicsApi_LL/Common.hpp"
 
 #define WIN32_LEAN_AND_MEAN
@@ -53,6 +54,8 @@ ID3D12DescriptorHeap* native_cast(gxapi::IDescriptorHeap* source);
 
 ID3D12Fence* native_cast(gxapi::IFence* source);
 
+ID3D12QueryHeap* native_cast(gxapi::IQueryHeap* source);
+
 ID3D12CommandQueue* native_cast(gxapi::ICommandQueue* source);
 
 //---------------
@@ -65,6 +68,8 @@ D3D12_COMMAND_LIST_TYPE native_cast(gxapi::eCommandListType source);
 
 D3D12_DESCRIPTOR_HEAP_TYPE native_cast(gxapi::eDescriptorHeapType source);
 
+D3D12_QUERY_HEAP_TYPE native_cast(gxapi::eQueryHeapType source);
+
 D3D12_ROOT_PARAMETER_TYPE native_cast(gxapi::RootParameterDesc::eType source);
 
 D3D12_DESCRIPTOR_RANGE_TYPE native_cast(gxapi::DescriptorRange::eType source);
@@ -163,6 +168,8 @@ D3D12_COMMAND_QUEUE_DESC native_cast(gxapi::CommandQueueDesc source);
 
 D3D12_DESCRIPTOR_HEAP_DESC native_cast(gxapi::DescriptorHeapDesc source);
 
+D3D12_QUERY_HEAP_DESC native_cast(gxapi::QueryHeapDesc source);
+
 D3D12_BLEND_DESC native_cast(gxapi::BlendState source);
 
 D3D12_RENDER_TARGET_BLEND_DESC native_cast(gxapi::RenderTargetBlendState source);
@@ -161,21 +161,21 @@ enum class eFormat {
 	//R8G8_B8G8_UNORM = 68,
 	//G8R8_G8B8_UNORM = 69,
 
-	//BC1_TYPELESS = 70,
-	//BC1_UNORM = 71,
-	//BC1_UNORM_SRGB = 72,
-	//BC2_TYPELESS = 73,
-	//BC2_UNORM = 74,
-	//BC2_UNORM_SRGB = 75,
-	//BC3_TYPELESS = 76,
-	//BC3_UNORM = 77,
-	//BC3_UNORM_SRGB = 78,
-	//BC4_TYPELESS = 79,
-	//BC4_UNORM = 80,
-	//BC4_SNORM = 81,
-	//BC5_TYPELESS = 82,
-	//BC5_UNORM = 83,
-	//BC5_SNORM = 84,
+	BC1_TYPELESS = 70,
+	BC1_UNORM = 71,
+	BC1_UNORM_SRGB = 72,
+	BC2_TYPELESS = 73,
+	BC2_UNORM = 74,
+	BC2_UNORM_SRGB = 75,
+	BC3_TYPELESS = 76,
+	BC3_UNORM = 77,
+	BC3_UNORM_SRGB = 78,
+	BC4_TYPELESS = 79,
+	BC4_UNORM = 80,
+	BC4_SNORM = 81,
+	BC5_TYPELESS = 82,
+	BC5_UNORM = 83,
+	BC5_SNORM = 84,
 
 	//B5G6R5_UNORM = 85,
 	//B5G5R5A1_UNORM = 86,
@@ -189,9 +189,9 @@ enum class eFormat {
 	//BC6H_TYPELESS = 94,
 	//BC6H_UF16 = 95,
 	//BC6H_SF16 = 96,
-	//BC7_TYPELESS = 97,
-	//BC7_UNORM = 98,
-	//BC7_UNORM_SRGB = 99,
+	BC7_TYPELESS = 97,
+	BC7_UNORM = 98,
+	BC7_UNORM_SRGB = 99,
 	//AYUV = 100,
 	//Y410 = 101,
 	//Y416 = 102,
@@ -257,6 +257,11 @@ enum class eDescriptorHeapType {
 };
 
 
+enum class eQueryHeapType {
+	TIMESTAMP,
+};
+
+
 enum class eHeapType {
 	DEFAULT,
 	UPLOAD,
@@ -858,6 +863,15 @@ struct DescriptorHeapDesc {
 };
 
 
+struct QueryHeapDesc {
+	QueryHeapDesc() = default;
+	QueryHeapDesc(eQueryHeapType type, unsigned numQueries)
+		: type(type), numQueries(numQueries) {}
+	eQueryHeapType type;
+	unsigned numQueries;
+};
+
+
 struct ShaderByteCodeDesc {
 	ShaderByteCodeDesc() = default;
 	ShaderByteCodeDesc(const void* byteCode, size_t sizeOfByteCode)
@@ -2048,6 +2062,48 @@ inline unsigned GetFormatSizeInBytes(eFormat format) {
 }
 
 
+inline bool IsBlockCompressed(eFormat format) {
+	switch (format) {
+		case eFormat::BC1_TYPELESS:
+		case eFormat::BC1_UNORM:
+		case eFormat::BC1_UNORM_SRGB:
+		case eFormat::BC2_TYPELESS:
+		case eFormat::BC2_UNORM:
+		case eFormat::BC2_UNORM_SRGB:
+		case eFormat::BC3_TYPELESS:
+		case eFormat::BC3_UNORM:
+		case eFormat::BC3_UNORM_SRGB:
+		case eFormat::BC4_TYPELESS:
+		case eFormat::BC4_UNORM:
+		case eFormat::BC4_SNORM:
+		case eFormat::BC5_TYPELESS:
+		case eFormat::BC5_UNORM:
+		case eFormat::BC5_SNORM:
+		case eFormat::BC7_TYPELESS:
+		case eFormat::BC7_UNORM:
+		case eFormat::BC7_UNORM_SRGB:
+			return true;
+		default:
+			return false;
+	}
+}
+
+// Size of a 4x4 pixel block of block compressed formats, 0 for other formats.
+inline unsigned GetFormatBlockSizeInBytes(eFormat format) {
+	switch (format) {
+		case eFormat::BC1_TYPELESS:
+		case eFormat::BC1_UNORM:
+		case eFormat::BC1_UNORM_SRGB:
+		case eFormat::BC4_TYPELESS:
+		case eFormat::BC4_UNORM:
+		case eFormat::BC4_SNORM:
+			return 8;
+		default:
+			return IsBlockCompressed(format) ? 16 : 0;
+	}
+}
+
+
 } // namespace gxapi
 } // namespace inl
 
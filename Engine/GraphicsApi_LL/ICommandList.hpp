@@ -8,6 +8,7 @@ namespace inl {
 namespace gxapi {
 
 class IDescriptorHeap;
+class IQueryHeap;
 
 class ICommandList {
 public:
@@ -56,6 +57,12 @@ public:
 	// TODO: transition, aliasing and bullshit barriers, i would put them into separate functions
 	virtual void ResourceBarrier(unsigned numBarriers, gxapi::ResourceBarrier* barriers) = 0;
 
+	// queries
+	/// <summary> Writes the query's result at this point of the list. For timestamps, the GPU clock is sampled. </summary>
+	virtual void EndQuery(IQueryHeap* heap, unsigned index) = 0;
+	/// <summary> Copies the results of the queries to the buffer, 8 bytes each. </summary>
+	virtual void ResolveQueryData(IQueryHeap* heap, unsigned firstIndex, unsigned numQueries, IResource* destination, size_t destinationOffset) = 0;
+
 	template <class... Barriers>
 	std::enable_if_t<
 		templ::all<std::is_base_of<ResourceBarrierTag, std::remove_reference_t<Barriers>>...>::value,
@@ -18,6 +18,7 @@ class IResource;
 class IRootSignature;
 class IPipelineState;
 class IDescriptorHeap;
+class IQueryHeap;
 
 
 // todo: descriptor view bullshit
@@ -45,6 +46,7 @@ public:
 	virtual IPipelineState* CreateGraphicsPipelineState(const GraphicsPipelineStateDesc& desc) = 0;
 	virtual gxapi::IPipelineState* CreateComputePipelineState(const gxapi::ComputePipelineStateDesc& desc) = 0;
 	virtual IDescriptorHeap* CreateDescriptorHeap(DescriptorHeapDesc) = 0;
+	virtual IQueryHeap* CreateQueryHeap(QueryHeapDesc desc) = 0;
 
 	// Views
 	virtual void CreateConstantBufferView(ConstantBufferViewDesc desc,
@@ -51,6 +51,9 @@ public:
 													  gxapi::eShaderType type,
 													  eShaderCompileFlags flags,
 													  const std::vector<ShaderMacroDefinition>& macros) = 0;
+
+	// Identifies the shader compiler and its version, binaries of different compilers must not be mixed.
+	virtual std::string GetShaderCompilerId() = 0;
 };
 
 
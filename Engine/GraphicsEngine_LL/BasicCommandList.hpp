@@ -69,6 +69,7 @@ namespace gxeng {
 
 
 class BasicCommandList {
+	friend class Scheduler; // to write profiler timestamps between merged tasks
 public:
 
 	struct Decomposition {
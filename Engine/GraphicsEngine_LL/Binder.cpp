@@ -34,9 +34,10 @@ void Binder::CalculateLayout(const std::vector<BindParameterDesc>& parameters) {
 	std::vector<std::vector<BindParameterDesc>> tableParams; // goes into descriptor heap (scratch space)
 	std::vector<BindParameterDesc> samplerParams; // samplers are treated separately
 	std::vector<BindParameterDesc> constantParams; // inline constants and inline CBVs
+	std::vector<BindParameterDesc> bindlessParams; // each gets its own table pointing to the bindless texture table
 
 	// put parameters to the right slot/table in the root signature
-	DistributeParameters(parameters, tableParams, samplerParams, constantParams);
+	DistributeParameters(parameters, tableParams, samplerParams, constantParams, bindlessParams);
 
 	// declare root signature desc
 	gxapi::RootSignatureDesc desc;
@@ -120,6 +121,24 @@ void Binder::CalculateLayout(const std::vector<BindParameterDesc>& parameters) {
 
 		++rootParamIndex;
 	}
+	// bindless tables
+	m_bindlessTables.clear();
+	for (const auto& param : bindlessParams) {
+		RootParameterMapping mapping;
+		mapping.bindParam = param.parameter;
+		mapping.rootParamIndex = rootParamIndex;
+		mapping.rootTableIndex = 0;
+		mapping.constantCount = 0;
+		m_parameters.push_back(mapping);
+
+		desc.rootParameters.push_back(gxapi::RootParameterDesc::DescriptorTable());
+		auto& rootTable = desc.rootParameters[rootParamIndex].As<gxapi::RootParameterDesc::DESCRIPTOR_TABLE>();
+		rootTable.ranges.push_back(gxapi::DescriptorRange{ gxapi::DescriptorRange::SRV, 0, param.parameter.reg, param.parameter.space });
+		rootTable.ranges.back().numDescriptors = param.bindlessTableSize;
+
+		m_bindlessTables.push_back(rootParamIndex);
+		++rootParamIndex;
+	}
 
 	// radix sort mapping for easy search
 	std::sort(m_parameters.begin(), m_parameters.end(), [](const RootParameterMapping& lhs, const RootParameterMapping& rhs)
@@ -135,12 +154,16 @@ void Binder::CalculateLayout(const std::vector<BindParameterDesc>& parameters) {
 void Binder::DistributeParameters(const std::vector<BindParameterDesc>& parameters,
 								  std::vector<std::vector<BindParameterDesc>> & tableParams,
 								  std::vector<BindParameterDesc> & samplerParams,
-								  std::vector<BindParameterDesc> & constantParams)
+								  std::vector<BindParameterDesc> & constantParams,
+								  std::vector<BindParameterDesc> & bindlessParams)
 {
 	// put SRV's and UAV's into descriptor table: they have so many limitation that inlining them is basically worthless
 	// put samplers into separate list
 	for (const auto& param : parameters) {
-		if (param.parameter.type == eBindParameterType::TEXTURE || param.parameter.type == eBindParameterType::UNORDERED) {
+		if (param.parameter.type == eBindParameterType::TEXTURE && param.bindlessTableSize > 0) {
+			bindlessParams.push_back(param);
+		}
+		else if (param.parameter.type == eBindParameterType::TEXTURE || param.parameter.type == eBindParameterType::UNORDERED) {
 			if (tableParams.size() == 0) {
 				tableParams.resize(1);
 			}
@@ -165,6 +188,7 @@ void Binder::DistributeParameters(const std::vector<BindParameterDesc>& paramete
 		for (const auto& table : tableParams) {
 			size += 4;
 		}
+		size += 4 * (int)bindlessParams.size();
 		for (const auto& constant : constantParams) {
 			size += constant.constantSize > 0 ? ((constant.constantSize + 3) / 4 * 4) : 8;
 		}
@@ -219,6 +243,11 @@ void Binder::DistributeParameters(const std::vector<BindParameterDesc>& paramete
 }
 
 
+bool Binder::IsBindlessTable(int rootParamIndex) const {
+	return std::find(m_bindlessTables.begin(), m_bindlessTables.end(), rootParamIndex) != m_bindlessTables.end();
+}
+
+
 std::pair<std::vector<Binder::RootParameterMapping>::const_iterator, bool> Binder::FindMapping(BindParameter param) const {
 	RootParameterMapping key;
 	key.bindParam = param;
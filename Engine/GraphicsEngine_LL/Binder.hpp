@@ -65,6 +65,7 @@ struct BindParameterDesc {
 	float relativeAccessFrequency = 1; /// <summary> Not used currently. TODO: Read more about this aspect. </summary>
 	float relativeChangeFrequency = 1; /// <summary> How often will you change this binding relative to others. Absolute value does not matter. </summary>
 	gxapi::eShaderVisiblity shaderVisibility = gxapi::eShaderVisiblity::ALL;
+	unsigned bindlessTableSize = 0; /// <summary> Non-zero makes a TEXTURE parameter an array over the bindless texture table. It's not bound by the user. </summary>
 };
 
 
@@ -74,6 +75,7 @@ struct BindParameterDesc {
 /// <remarks>
 /// The binder is a flat structure, that is, a mapping between shader registers and resources.
 /// Hides the complexity of Root Signatures, and optimizes parameter layout for preformance and space.
+/// Binders are immutable after construction, copies share the same root signature.
 /// </remarks>
 class Binder {
 	friend std::ostream& ::operator<<(std::ostream& os, const Binder& binder);
@@ -106,18 +108,23 @@ public:
 	/// <summary> Return the description of the underying root signature object. </summary>
 	/// <remarks> Use this to determine the type of slots returned by <see cref="Translate">. </remarks>
 	const gxapi::RootSignatureDesc& GetRootSignatureDesc() const { return m_rootSignatureDesc; }
+
+	/// <summary> True if the root signature slot is a descriptor table over the bindless texture table. </summary>
+	bool IsBindlessTable(int rootParamIndex) const;
 private:
 	void CalculateLayout(const std::vector<BindParameterDesc>& parameters);
 	void DistributeParameters(const std::vector<BindParameterDesc>& parameters,
 		std::vector<std::vector<BindParameterDesc>> & tableParams,
 		std::vector<BindParameterDesc> & samplerParams,
-		std::vector<BindParameterDesc> & constantParams);
+		std::vector<BindParameterDesc> & constantParams,
+		std::vector<BindParameterDesc> & bindlessParams);
 	gxapi::DescriptorRange::eType CastRangeType(eBindParameterType source);
 
 	std::pair<std::vector<RootParameterMapping>::const_iterator, bool> FindMapping(BindParameter param) const;
 private:
 	std::vector<RootParameterMapping> m_parameters;
-	std::unique_ptr<gxapi::IRootSignature> m_rootSignature;
+	std::vector<int> m_bindlessTables; // root parameter indices of bindless tables
+	std::shared_ptr<gxapi::IRootSignature> m_rootSignature;
 	gxapi::RootSignatureDesc m_rootSignatureDesc;
 
 	// Maximum root signature size = 64 DWORDs.
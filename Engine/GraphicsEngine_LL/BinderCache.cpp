@@ -0,0 +1,108 @@
+#include "BinderCache.hpp"
+
+#include <algorithm>
+
+
+namespace inl {
+namespace gxeng {
+
+
+namespace {
+	// Appends the raw bytes of a field, skipping any padding of the enclosing struct.
+	template <class T>
+	void AppendField(std::string& key, const T& field) {
+		key.append(reinterpret_cast<const char*>(&field), sizeof(field));
+	}
+}
+
+
+BinderCache::BinderCache(gxapi::IGraphicsApi* graphicsApi)
+	: m_graphicsApi(graphicsApi)
+{}
+
+
+Binder BinderCache::GetBinder(const std::vector<BindParameterDesc>& parameters, const std::vector<gxapi::StaticSamplerDesc>& staticSamplers) {
+	std::vector<BindParameterDesc> canonical = Canonicalize(parameters);
+	std::string key = MakeKey(canonical, staticSamplers);
+
+	std::lock_guard<std::mutex> lkg(m_mtx);
+	++m_requests;
+
+	auto it = m_binders.find(key);
+	if (it == m_binders.end()) {
+		// Root signature creation is slow, but rare enough not to bother with releasing the lock.
+		it = m_binders.insert({ std::move(key), Binder(m_graphicsApi, canonical, staticSamplers) }).first;
+	}
+	return it->second;
+}
+
+
+void BinderCache::Clear() {
+	std::lock_guard<std::mutex> lkg(m_mtx);
+	m_binders.clear();
+}
+
+
+auto BinderCache::GetStatistics() const -> Statistics {
+	std::lock_guard<std::mutex> lkg(m_mtx);
+	Statistics stats;
+	stats.requests = m_requests;
+	stats.rootSignatures = m_binders.size();
+	return stats;
+}
+
+
+std::vector<BindParameterDesc> BinderCache::Canonicalize(std::vector<BindParameterDesc> parameters) {
+	std::sort(parameters.begin(), parameters.end(), [](const BindParameterDesc& lhs, const BindParameterDesc& rhs) {
+		if (lhs.parameter.type != rhs.parameter.type) {
+			return lhs.parameter.type < rhs.parameter.type;
+		}
+		if (lhs.parameter.space != rhs.parameter.space) {
+			return lhs.parameter.space < rhs.parameter.space;
+		}
+		return lhs.parameter.reg < rhs.parameter.reg;
+	});
+	return parameters;
+}
+
+
+std::string BinderCache::MakeKey(const std::vector<BindParameterDesc>& parameters, const std::vector<gxapi::StaticSamplerDesc>& staticSamplers) {
+	std::string key;
+	key.reserve(parameters.size() * 32 + staticSamplers.size() * 64 + 16);
+
+	AppendField(key, parameters.size());
+	for (const auto& param : parameters) {
+		AppendField(key, param.parameter.type);
+		AppendField(key, param.parameter.reg);
+		AppendField(key, param.parameter.space);
+		AppendField(key, param.constantSize);
+		AppendField(key, param.relativeAccessFrequency);
+		AppendField(key, param.relativeChangeFrequency);
+		AppendField(key, param.shaderVisibility);
+		AppendField(key, param.bindlessTableSize);
+	}
+
+	AppendField(key, staticSamplers.size());
+	for (const auto& sampler : staticSamplers) {
+		AppendField(key, sampler.filter);
+		AppendField(key, sampler.addressU);
+		AppendField(key, sampler.addressV);
+		AppendField(key, sampler.addressW);
+		AppendField(key, sampler.mipLevelBias);
+		AppendField(key, sampler.maxAnisotropy);
+		AppendField(key, sampler.compareFunc);
+		AppendField(key, sampler.border);
+		AppendField(key, sampler.minMipLevel);
+		AppendField(key, sampler.maxMipLevel);
+		AppendField(key, sampler.shaderRegister);
+		AppendField(key, sampler.registerSpace);
+		AppendField(key, sampler.shaderVisibility);
+	}
+
+	return key;
+}
+
+
+
+} // namespace gxeng
+} // namespace inl
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Binder.hpp"
+
+#include <GraphicsApi_LL/Common.hpp>
+
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <mutex>
+
+
+namespace inl {
+namespace gxeng {
+
+
+/// <summary>
+/// Hands out binders for parameter lists, reusing the same root signature for identical layouts.
+/// </summary>
+/// <remarks>
+/// Parameter lists are compared in a canonical form, so the order in which nodes list their
+/// parameters does not matter. Returned binders share their immutable state with the cached one.
+/// Thread-safe.
+/// </remarks>
+class BinderCache {
+public:
+	struct Statistics {
+		size_t requests = 0; // number of binders asked for
+		size_t rootSignatures = 0; // number of unique root signatures created
+	};
+public:
+	BinderCache(gxapi::IGraphicsApi* graphicsApi);
+
+	/// <summary> Returns a binder for the given parameters, creating it only if no identical one exists. </summary>
+	Binder GetBinder(const std::vector<BindParameterDesc>& parameters, const std::vector<gxapi::StaticSamplerDesc>& staticSamplers = {});
+
+	/// <summary> Drops all cached binders. Binders already handed out remain valid. </summary>
+	void Clear();
+
+	Statistics GetStatistics() const;
+private:
+	static std::vector<BindParameterDesc> Canonicalize(std::vector<BindParameterDesc> parameters);
+	static std::string MakeKey(const std::vector<BindParameterDesc>& parameters, const std::vector<gxapi::StaticSamplerDesc>& staticSamplers);
+private:
+	gxapi::IGraphicsApi* m_graphicsApi;
+	std::unordered_map<std::string, Binder> m_binders;
+	size_t m_requests = 0;
+	mutable std::mutex m_mtx;
+};
+
+
+
+} // namespace gxeng
+} // namespace inl
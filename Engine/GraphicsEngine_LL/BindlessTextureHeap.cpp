@@ -0,0 +1,131 @@
+#include "BindlessTextureHeap.hpp"
+
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <cassert>
+#include <algorithm>
+
+
+namespace inl {
+namespace gxeng {
+
+
+BindlessTextureHeap::BindlessTextureHeap(gxapi::IGraphicsApi* graphicsApi)
+	: m_graphicsApi(graphicsApi)
+{
+	m_heap.reset(m_graphicsApi->CreateDescriptorHeap({ gxapi::eDescriptorHeapType::CBV_SRV_UAV, Capacity, false }));
+
+	// stack of free slots, lowest index on top
+	m_freeList.reserve(Capacity);
+	for (uint32_t index = Capacity; index > 0; --index) {
+		m_freeList.push_back(index - 1);
+	}
+
+	for (uint32_t index = 0; index < Capacity; ++index) {
+		SetNull(index);
+	}
+}
+
+
+uint32_t BindlessTextureHeap::Allocate() {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	return AllocateLocked();
+}
+
+
+uint32_t BindlessTextureHeap::AllocateLocked() {
+	if (m_freeList.empty()) {
+		throw OutOfMemoryException("All bindless texture slots are in use.");
+	}
+	uint32_t index = m_freeList.back();
+	m_freeList.pop_back();
+	return index;
+}
+
+
+void BindlessTextureHeap::Deallocate(uint32_t index) {
+	assert(index < Capacity);
+	std::lock_guard<std::mutex> lkg(m_mutex);
+
+	// Frames in flight may still read the descriptor, it's reset when they are done.
+	m_retiredSlots.push_back({ index, m_currentFrameId });
+}
+
+
+uint32_t BindlessTextureHeap::Update(uint32_t index, gxapi::DescriptorHandle srv) {
+	assert(index < Capacity);
+	std::lock_guard<std::mutex> lkg(m_mutex);
+
+	uint32_t newIndex = AllocateLocked();
+	m_graphicsApi->CopyDescriptors(srv, m_heap->At(newIndex), 1, gxapi::eDescriptorHeapType::CBV_SRV_UAV);
+	CopyToShaderVisible(newIndex);
+	m_retiredSlots.push_back({ index, m_currentFrameId });
+	return newIndex;
+}
+
+
+void BindlessTextureHeap::BeginFrame(uint64_t frameId) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	m_currentFrameId = frameId;
+}
+
+
+void BindlessTextureHeap::OnFrameCompleteDevice(uint64_t frameId) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+
+	// Device frames complete in order, so every frame that could read these slots is done.
+	while (!m_retiredSlots.empty() && m_retiredSlots.front().frameId <= frameId) {
+		uint32_t index = m_retiredSlots.front().index;
+		m_retiredSlots.pop_front();
+
+		// don't leave a dangling descriptor in the table, the resource may be released
+		SetNull(index);
+		CopyToShaderVisible(index);
+		m_freeList.push_back(index);
+	}
+}
+
+
+void BindlessTextureHeap::AddShaderVisibleTable(gxapi::IDescriptorHeap* heap, uint32_t offset) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+
+	m_shaderVisibleTables.push_back({ heap, offset });
+	m_graphicsApi->CopyDescriptors(m_heap->At(0), heap->At(offset), Capacity, gxapi::eDescriptorHeapType::CBV_SRV_UAV);
+}
+
+
+void BindlessTextureHeap::RemoveShaderVisibleTable(gxapi::IDescriptorHeap* heap) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+
+	auto it = std::find_if(m_shaderVisibleTables.begin(), m_shaderVisibleTables.end(), [heap](const ShaderVisibleTable& table) {
+		return table.heap == heap;
+	});
+	assert(it != m_shaderVisibleTables.end());
+	m_shaderVisibleTables.erase(it);
+}
+
+
+void BindlessTextureHeap::CopyToShaderVisible(uint32_t index) {
+	for (const auto& table : m_shaderVisibleTables) {
+		m_graphicsApi->CopyDescriptors(m_heap->At(index), table.heap->At(table.offset + index), 1, gxapi::eDescriptorHeapType::CBV_SRV_UAV);
+	}
+}
+
+
+void BindlessTextureHeap::SetNull(uint32_t index) {
+	gxapi::ShaderResourceViewDesc desc;
+	desc.format = gxapi::eFormat::R8G8B8A8_UNORM;
+	desc.dimension = gxapi::eSrvDimension::TEXTURE2DARRAY;
+	desc.tex2DArray.activeArraySize = 1;
+	desc.tex2DArray.firstArrayElement = 0;
+	desc.tex2DArray.mipLevelClamping = 0;
+	desc.tex2DArray.mostDetailedMip = 0;
+	desc.tex2DArray.numMipLevels = 1;
+	desc.tex2DArray.planeIndex = 0;
+
+	m_graphicsApi->CreateShaderResourceView(desc, m_heap->At(index));
+}
+
+
+} // namespace gxeng
+} // namespace inl
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "PipelineEventListener.hpp"
+
+#include "../GraphicsApi_LL/IGraphicsApi.hpp"
+#include "../GraphicsApi_LL/IDescriptorHeap.hpp"
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+
+namespace inl {
+namespace gxeng {
+
+
+/// <summary>
+/// A fixed size table of texture SRVs which shaders index directly.
+/// <para />
+/// Images reserve a slot for their whole lifetime, and materials only pass the slot index to the shader,
+/// so no descriptors have to be copied per draw call.
+/// </summary>
+/// <remarks>
+/// Only one shader visible heap can be bound at a time, so the shader visible table is placed in the heap
+/// that the <see cref="ScratchSpacePool"/> shares between all scratch spaces. When that heap grows, the old one
+/// stays in use until its scratch spaces are recycled, so every table that was added is kept up to date.
+/// Descriptors are copied from a non shader visible master heap, and only the slot that changes is copied.
+/// Slots are never written while frames in flight may read them: updates go to a new slot, and released slots
+/// are reset and reused only after the frame they were released in has completed on the GPU.
+/// Unused slots hold null descriptors.
+/// This class is thread safe.
+/// </remarks>
+class BindlessTextureHeap : public PipelineEventListener {
+public:
+	/// <summary> Number of slots in the table. Shaders must declare their texture arrays with this size. </summary>
+	static constexpr uint32_t Capacity = 4096;
+public:
+	BindlessTextureHeap(gxapi::IGraphicsApi* graphicsApi);
+	BindlessTextureHeap(const BindlessTextureHeap&) = delete;
+	BindlessTextureHeap& operator=(const BindlessTextureHeap&) = delete;
+
+	/// <summary> Reserves a slot. The slot holds a null descriptor until updated. </summary>
+	/// <exception cref="inl::OutOfMemoryException"> If all slots are in use. </exception>
+	uint32_t Allocate();
+
+	/// <summary> Releases a slot. It is reset to a null descriptor and reused once the current frame has completed on the GPU. </summary>
+	void Deallocate(uint32_t index);
+
+	/// <summary> Copies the SRV into a new slot, and releases the old one like <see cref="Deallocate"/>. </summary>
+	/// <returns> The new slot, which shaders must index from now on. </returns>
+	/// <exception cref="inl::OutOfMemoryException"> If all slots are in use. The old slot is kept then. </exception>
+	uint32_t Update(uint32_t index, gxapi::DescriptorHandle srv);
+
+	/// <summary> Adds a place where shaders read the table from, and copies the whole table there.
+	///		<paramref name="heap"/> must have room for <see cref="Capacity"/> descriptors from <paramref name="offset"/>. </summary>
+	void AddShaderVisibleTable(gxapi::IDescriptorHeap* heap, uint32_t offset);
+
+	/// <summary> Stops updating the table in <paramref name="heap"/>. Call before the heap is destroyed. </summary>
+	void RemoveShaderVisibleTable(gxapi::IDescriptorHeap* heap);
+
+	/// <summary> Slots released from now on are reused after the frame completes. </summary>
+	/// <remarks> Must be called on the render thread before the frame is recorded. </remarks>
+	void BeginFrame(uint64_t frameId);
+
+	void OnFrameBeginDevice(uint64_t frameId) override {}
+	void OnFrameBeginHost(uint64_t frameId) override {}
+	void OnFrameBeginAwait(uint64_t frameId) override {}
+	void OnFrameCompleteDevice(uint64_t frameId) override;
+	void OnFrameCompleteHost(uint64_t frameId) override {}
+private:
+	struct ShaderVisibleTable {
+		gxapi::IDescriptorHeap* heap;
+		uint32_t offset;
+	};
+
+	struct RetiredSlot {
+		uint32_t index;
+		uint64_t frameId; // The last frame that may read the slot.
+	};
+
+	uint32_t AllocateLocked();
+	void SetNull(uint32_t index);
+	void CopyToShaderVisible(uint32_t index);
+private:
+	gxapi::IGraphicsApi* m_graphicsApi;
+	std::unique_ptr<gxapi::IDescriptorHeap> m_heap;
+	std::vector<ShaderVisibleTable> m_shaderVisibleTables;
+	std::vector<uint32_t> m_freeList;
+	std::deque<RetiredSlot> m_retiredSlots; // In the order of their frames.
+	uint64_t m_currentFrameId = 0;
+	std::mutex m_mutex;
+};
+
+
+} // namespace gxeng
+} // namespace inl
@@ -36,10 +36,13 @@ void CommandAllocatorPool::RecycleAllocator(gxapi::ICommandAllocator* allocator)
 	{
 		case gxapi::eCommandListType::COPY:
 			m_cpPool.RecycleAllocator(allocator);
+			break;
 		case gxapi::eCommandListType::COMPUTE:
 			m_cuPool.RecycleAllocator(allocator);
+			break;
 		case gxapi::eCommandListType::GRAPHICS:
 			m_gxPool.RecycleAllocator(allocator);
+			break;
 		default:
 			assert(false); // hlye vagy bazmeg
 	}
@@ -62,6 +65,15 @@ LogStream* CommandAllocatorPool::GetLogStream() const {
 }
 
 
+std::vector<PoolThreadStatistics> CommandAllocatorPool::GetThreadStatistics() const {
+	std::vector<PoolThreadStatistics> statistics;
+	impl::MergePoolThreadStatistics(statistics, m_gxPool.GetThreadStatistics());
+	impl::MergePoolThreadStatistics(statistics, m_cuPool.GetThreadStatistics());
+	impl::MergePoolThreadStatistics(statistics, m_cpPool.GetThreadStatistics());
+	return statistics;
+}
+
+
 
 } // namespace gxeng
 } // namespace inl
\ No newline at end of file
@@ -1,6 +1,5 @@
 #pragma once
 
-#include <BaseLibrary/Memory/SlabAllocatorEngine.hpp>
 #include <GraphicsApi_LL/ICommandAllocator.hpp>
 #include <GraphicsApi_LL/IGraphicsApi.hpp>
 
@@ -13,6 +12,8 @@
 #include <iostream> // only for debug
 #include <BaseLibrary/Logging/LogStream.hpp>
 
+#include "PoolThreadCache.hpp"
+
 
 namespace inl {
 namespace gxeng {
@@ -22,54 +23,66 @@ namespace impl {
 
 	class CommandAllocatorPoolBase {
 	public:
+		using ThreadCache = PoolThreadCache<gxapi::ICommandAllocator>::Cache;
+
 		struct Deleter {
 		public:
-			Deleter() : m_container(nullptr) {}
+			Deleter() : m_container(nullptr), m_cache(nullptr) {}
 			Deleter(const Deleter&) = default;
 			Deleter(Deleter&&) = default;
 			Deleter& operator=(const Deleter&) = default;
 			Deleter& operator=(Deleter&&) = default;
-			explicit Deleter(CommandAllocatorPoolBase* container) : m_container(container) {}
+			explicit Deleter(CommandAllocatorPoolBase* container, ThreadCache* cache = nullptr) : m_container(container), m_cache(cache) {}
 			void operator()(gxapi::ICommandAllocator* object) const {
 				assert(m_container != nullptr);
-				m_container->RecycleAllocator(object);
+				m_container->RecycleAllocator(object, m_cache);
 			}
 		private:
 			CommandAllocatorPoolBase* m_container;
+			ThreadCache* m_cache; // cache of the thread that requested the allocator
 		};
 		using UniquePtr = std::unique_ptr<gxapi::ICommandAllocator, Deleter>;
 	public:
 		virtual ~CommandAllocatorPoolBase() {}
 		virtual UniquePtr RequestAllocator() = 0;
-		virtual void RecycleAllocator(gxapi::ICommandAllocator*) = 0;
+		virtual void RecycleAllocator(gxapi::ICommandAllocator*, ThreadCache* cache = nullptr) = 0;
 	};
 
 
+	/// <summary>
+	/// Pool of command allocators of one type.
+	/// Requests are first served from the calling thread's cache, and only go to the
+	/// shared pool, which takes a lock, when the cache is empty.
+	/// </summary>
+	/// <remarks>
+	/// Allocators are recycled when their UniquePtr is released. The scheduler hands them over to
+	/// the residency queue along with the submitted command lists, which releases them once the
+	/// frame's SyncPoint has passed, so recycled allocators are not in use by the GPU anymore.
+	/// </remarks>
 	template <gxapi::eCommandListType TYPE>
 	class CommandAllocatorPool : public CommandAllocatorPoolBase {
 	public:
 	public:
 		explicit CommandAllocatorPool(gxapi::IGraphicsApi* gxApi, size_t initialSize = 1);
 		CommandAllocatorPool(const CommandAllocatorPool&) = delete;
-		CommandAllocatorPool(CommandAllocatorPool&& rhs);
-
 		CommandAllocatorPool& operator=(const CommandAllocatorPool&) = delete;
-		CommandAllocatorPool& operator=(CommandAllocatorPool&& rhs);
 
 
 		UniquePtr RequestAllocator() override;
-		void RecycleAllocator(gxapi::ICommandAllocator* allocator) override;
+		void RecycleAllocator(gxapi::ICommandAllocator* allocator, ThreadCache* cache = nullptr) override;
 		void Reset(size_t initialSize = 1);
 
 		gxapi::IGraphicsApi* GetGraphicsApi() const { return m_gxApi; }
 
 		void SetLogStream(LogStream* logStream) { m_logStream = logStream; }
 		LogStream* GetLogStream() const { return m_logStream; }
+
+		std::vector<PoolThreadStatistics> GetThreadStatistics() const { return m_threadCache.GetStatistics(); }
 	private:
-		std::vector<std::unique_ptr<gxapi::ICommandAllocator>> m_pool;
-		SlabAllocatorEngine m_allocator;
+		std::vector<std::unique_ptr<gxapi::ICommandAllocator>> m_pool; // all allocators ever created
+		std::vector<gxapi::ICommandAllocator*> m_free; // shared overflow pool
+		PoolThreadCache<gxapi::ICommandAllocator> m_threadCache;
 		gxapi::IGraphicsApi* m_gxApi;
-		std::map<gxapi::ICommandAllocator*, size_t> m_addressToIndex;
 		LogStream* m_logStream = nullptr;
 
 		std::mutex m_mtx;
@@ -79,72 +92,55 @@ namespace impl {
 
 	template <gxapi::eCommandListType TYPE>
 	CommandAllocatorPool<TYPE>::CommandAllocatorPool(gxapi::IGraphicsApi* gxApi, size_t initialSize)
-		: m_pool(initialSize), m_allocator(initialSize), m_gxApi(gxApi)
-	{}
-
-
-	template <gxapi::eCommandListType TYPE>
-	CommandAllocatorPool<TYPE>::CommandAllocatorPool(CommandAllocatorPool&& rhs)
-		: m_pool(std::move(rhs.m_pool)), m_allocator(std::move(rhs.m_allocator)), m_gxApi(rhs.m_gxApi)
-	{}
-
-
-	template <gxapi::eCommandListType TYPE>
-	CommandAllocatorPool<TYPE>& CommandAllocatorPool<TYPE>::operator=(CommandAllocatorPool&& rhs) {
-		m_pool = std::move(rhs.m_pool);
-		m_allocator = std::move(rhs.m_allocator);
-		m_gxApi = rhs.m_gxApi;
-
-		return *this;
+		: m_gxApi(gxApi)
+	{
+		m_pool.reserve(initialSize);
+		m_free.reserve(initialSize);
 	}
 
 
 	template <gxapi::eCommandListType TYPE>
 	auto CommandAllocatorPool<TYPE>::RequestAllocator() -> UniquePtr {
-		std::lock_guard<std::mutex> lkg(m_mtx);
-
-		size_t index;
-		try {
-			index = m_allocator.Allocate();
-		}
-		catch (std::bad_alloc&) {
-			size_t currentSize = m_pool.size();
-			size_t newSize = std::max(currentSize + 1, size_t(currentSize * 1.25));
-			m_pool.resize(newSize);
-			m_allocator.Resize(newSize);
+		ThreadCache& cache = m_threadCache.Get();
 
-			index = m_allocator.Allocate();
+		gxapi::ICommandAllocator* allocator = m_threadCache.Pop(cache);
+		if (allocator != nullptr) {
+			return UniquePtr{ allocator, Deleter{this, &cache} };
 		}
 
-		if (m_pool[index] != nullptr) {
-			return UniquePtr{ m_pool[index].get(), Deleter{this} };
+		std::lock_guard<std::mutex> lkg(m_mtx);
+		if (!m_free.empty()) {
+			allocator = m_free.back();
+			m_free.pop_back();
 		}
 		else {
-			std::unique_ptr<gxapi::ICommandAllocator> ptr(m_gxApi->CreateCommandAllocator(TYPE));
-			m_addressToIndex[ptr.get()] = index;
-			m_pool[index] = std::move(ptr);
-			return UniquePtr{ m_pool[index].get(), Deleter{this} };
+			m_pool.emplace_back(m_gxApi->CreateCommandAllocator(TYPE));
+			allocator = m_pool.back().get();
 		}
+		return UniquePtr{ allocator, Deleter{this, &cache} };
 	}
 
 
 	template <gxapi::eCommandListType TYPE>
-	void CommandAllocatorPool<TYPE>::RecycleAllocator(gxapi::ICommandAllocator* allocator) {
-		std::lock_guard<std::mutex> lkg(m_mtx);
-
+	void CommandAllocatorPool<TYPE>::RecycleAllocator(gxapi::ICommandAllocator* allocator, ThreadCache* cache) {
 		allocator->Reset();
-		assert(m_addressToIndex.count(allocator) > 0);
-		size_t index = m_addressToIndex[allocator];
-		m_allocator.Deallocate(index);
+
+		if (cache != nullptr && m_threadCache.Push(*cache, allocator)) {
+			return;
+		}
+
+		std::lock_guard<std::mutex> lkg(m_mtx);
+		m_free.push_back(allocator);
 	}
 
 
 	template <gxapi::eCommandListType TYPE>
 	void CommandAllocatorPool<TYPE>::Reset(size_t initialSize) {
+		m_threadCache.Clear();
+		m_free.clear();
 		m_pool.clear();
-		m_allocator.Reset();
-		m_pool.resize(initialSize);
-		m_allocator.Resize(initialSize);
+		m_pool.reserve(initialSize);
+		m_free.reserve(initialSize);
 	}
 
 } // namespace impl
@@ -157,9 +153,7 @@ public:
 public:
 	explicit CommandAllocatorPool(gxapi::IGraphicsApi* gxApi);
 	CommandAllocatorPool(const CommandAllocatorPool&) = delete;
-	CommandAllocatorPool(CommandAllocatorPool&& rhs) = default;
 	CommandAllocatorPool& operator=(const CommandAllocatorPool&) = delete;
-	CommandAllocatorPool& operator=(CommandAllocatorPool&& rhs) = default;
 
 	CmdAllocPtr RequestAllocator(gxapi::eCommandListType type);
 	void RecycleAllocator(gxapi::ICommandAllocator* allocator);
@@ -168,6 +162,9 @@ public:
 
 	void SetLogStream(LogStream* logStream);
 	LogStream* GetLogStream() const;
+
+	/// <summary> How many requests each thread could serve from its own cache, for all command list types. </summary>
+	std::vector<PoolThreadStatistics> GetThreadStatistics() const;
 private:
 	impl::CommandAllocatorPool<gxapi::eCommandListType::GRAPHICS> m_gxPool;
 	impl::CommandAllocatorPool<gxapi::eCommandListType::COMPUTE> m_cuPool;
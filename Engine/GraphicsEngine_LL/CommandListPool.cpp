@@ -47,10 +47,13 @@ void CommandListPool::RecycleList(gxapi::ICommandList* list) {
 	{
 	case gxapi::eCommandListType::COPY:
 		m_cpPool.RecycleList(list);
+		break;
 	case gxapi::eCommandListType::COMPUTE:
 		m_cuPool.RecycleList(list);
+		break;
 	case gxapi::eCommandListType::GRAPHICS:
 		m_gxPool.RecycleList(list);
+		break;
 	default:
 		assert(false); // hlye vagy bazmeg
 	}
@@ -73,5 +76,14 @@ LogStream* CommandListPool::GetLogStream() const {
 }
 
 
+std::vector<PoolThreadStatistics> CommandListPool::GetThreadStatistics() const {
+	std::vector<PoolThreadStatistics> statistics;
+	impl::MergePoolThreadStatistics(statistics, m_gxPool.GetThreadStatistics());
+	impl::MergePoolThreadStatistics(statistics, m_cuPool.GetThreadStatistics());
+	impl::MergePoolThreadStatistics(statistics, m_cpPool.GetThreadStatistics());
+	return statistics;
+}
+
+
 
 } // namespace inl::gxeng
\ No newline at end of file
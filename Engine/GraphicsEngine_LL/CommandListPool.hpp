@@ -1,6 +1,5 @@
 #pragma once
 
-#include <BaseLibrary/Memory/SlabAllocatorEngine.hpp>
 #include <GraphicsApi_LL/ICommandList.hpp>
 #include <GraphicsApi_LL/IGraphicsApi.hpp>
 
@@ -12,6 +11,8 @@
 
 #include <BaseLibrary/Logging/LogStream.hpp>
 
+#include "PoolThreadCache.hpp"
+
 
 namespace inl::gxeng {
 
@@ -20,20 +21,23 @@ namespace impl {
 
 class CommandListPoolBase {
 public:
+	using ThreadCache = PoolThreadCache<gxapi::ICommandList>::Cache;
+
 	struct Deleter {
 	public:
-		Deleter() : m_container(nullptr) {}
+		Deleter() : m_container(nullptr), m_cache(nullptr) {}
 		Deleter(const Deleter&) = default;
 		Deleter(Deleter&&) = default;
 		Deleter& operator=(const Deleter&) = default;
 		Deleter& operator=(Deleter&&) = default;
-		explicit Deleter(CommandListPoolBase* container) : m_container(container) {}
+		explicit Deleter(CommandListPoolBase* container, ThreadCache* cache = nullptr) : m_container(container), m_cache(cache) {}
 		void operator()(gxapi::ICommandList* object) const {
 			assert(m_container != nullptr);
-			m_container->RecycleList(object);
+			m_container->RecycleList(object, m_cache);
 		}
 	private:
 		CommandListPoolBase* m_container;
+		ThreadCache* m_cache; // cache of the thread that requested the list
 	};
 	using UniquePtr = std::unique_ptr<gxapi::ICommandList, Deleter>;
 	using GraphicsUniquePtr = std::unique_ptr<gxapi::IGraphicsCommandList, Deleter>;
@@ -42,35 +46,39 @@ public:
 public:
 	virtual ~CommandListPoolBase() {}
 	virtual UniquePtr RequestList(gxapi::ICommandAllocator*) = 0;
-	virtual void RecycleList(gxapi::ICommandList*) = 0;
+	virtual void RecycleList(gxapi::ICommandList*, ThreadCache* cache = nullptr) = 0;
 };
 
 
+/// <summary>
+/// Pool of command lists of one type.
+/// Requests are first served from the calling thread's cache, and only go to the
+/// shared pool, which takes a lock, when the cache is empty.
+/// </summary>
 template <gxapi::eCommandListType TYPE>
 class CommandListPool : public CommandListPoolBase {
 public:
 public:
 	explicit CommandListPool(gxapi::IGraphicsApi* gxApi, size_t initialSize = 1);
 	CommandListPool(const CommandListPool&) = delete;
-	CommandListPool(CommandListPool&& rhs);
-
 	CommandListPool& operator=(const CommandListPool&) = delete;
-	CommandListPool& operator=(CommandListPool&& rhs);
 
 
 	UniquePtr RequestList(gxapi::ICommandAllocator* allocator) override;
-	void RecycleList(gxapi::ICommandList* list) override;
+	void RecycleList(gxapi::ICommandList* list, ThreadCache* cache = nullptr) override;
 	void Reset(size_t initialSize = 1);
 
 	gxapi::IGraphicsApi* GetGraphicsApi() const { return m_gxApi; }
 
 	void SetLogStream(LogStream* logStream) { m_logStream = logStream; }
 	LogStream* GetLogStream() const { return m_logStream; }
+
+	std::vector<PoolThreadStatistics> GetThreadStatistics() const { return m_threadCache.GetStatistics(); }
 private:
-	std::vector<std::unique_ptr<gxapi::ICommandList>> m_pool;
-	SlabAllocatorEngine m_allocator;
+	std::vector<std::unique_ptr<gxapi::ICommandList>> m_pool; // all lists ever created
+	std::vector<gxapi::ICommandList*> m_free; // shared overflow pool
+	PoolThreadCache<gxapi::ICommandList> m_threadCache;
 	gxapi::IGraphicsApi* m_gxApi;
-	std::map<gxapi::ICommandList*, size_t> m_addressToIndex;
 	LogStream* m_logStream = nullptr;
 
 	std::mutex m_mtx;
@@ -80,76 +88,56 @@ private:
 
 template <gxapi::eCommandListType TYPE>
 CommandListPool<TYPE>::CommandListPool(gxapi::IGraphicsApi* gxApi, size_t initialSize)
-	: m_pool(initialSize), m_allocator(initialSize), m_gxApi(gxApi)
-{}
-
-
-template <gxapi::eCommandListType TYPE>
-CommandListPool<TYPE>::CommandListPool(CommandListPool&& rhs)
-	: m_pool(std::move(rhs.m_pool)), m_allocator(std::move(rhs.m_allocator)), m_gxApi(rhs.m_gxApi)
-{}
-
-
-template <gxapi::eCommandListType TYPE>
-CommandListPool<TYPE>& CommandListPool<TYPE>::operator=(CommandListPool&& rhs) {
-	m_pool = std::move(rhs.m_pool);
-	m_allocator = std::move(rhs.m_allocator);
-	m_gxApi = rhs.m_gxApi;
-
-	return *this;
+	: m_gxApi(gxApi)
+{
+	m_pool.reserve(initialSize);
+	m_free.reserve(initialSize);
 }
 
 
 template <gxapi::eCommandListType TYPE>
 auto CommandListPool<TYPE>::RequestList(gxapi::ICommandAllocator* allocator) -> UniquePtr {
-	std::lock_guard<std::mutex> lkg(m_mtx);
-
-	size_t index;
-	try {
-		index = m_allocator.Allocate();
-	}
-	catch (std::bad_alloc&) {
-		size_t currentSize = m_pool.size();
-		size_t newSize = std::max(currentSize + 1, size_t(currentSize * 1.25));
-		m_pool.resize(newSize);
-		m_allocator.Resize(newSize);
-
-		index = m_allocator.Allocate();
+	ThreadCache& cache = m_threadCache.Get();
+
+	gxapi::ICommandList* list = m_threadCache.Pop(cache);
+	if (list == nullptr) {
+		std::lock_guard<std::mutex> lkg(m_mtx);
+		if (!m_free.empty()) {
+			list = m_free.back();
+			m_free.pop_back();
+		}
+		else {
+			gxapi::CommandListDesc desc;
+			desc.allocator = allocator;
+			desc.initialState = nullptr;
+			m_pool.emplace_back(m_gxApi->CreateCommandList(TYPE, desc));
+			return UniquePtr{ m_pool.back().get(), Deleter{ this, &cache } };
+		}
 	}
 
-	if (m_pool[index] != nullptr) {
-		dynamic_cast<gxapi::ICopyCommandList*>(m_pool[index].get())->Reset(allocator, nullptr);
-		return UniquePtr{ m_pool[index].get(), Deleter{ this } };
-	}
-	else {
-		gxapi::CommandListDesc desc;
-		desc.allocator = allocator;
-		desc.initialState = nullptr;
-		std::unique_ptr<gxapi::ICommandList> ptr(m_gxApi->CreateCommandList(TYPE, desc));
-		m_addressToIndex[ptr.get()] = index;
-		m_pool[index] = std::move(ptr);
-	
-		return UniquePtr{ m_pool[index].get(), Deleter{ this } };
-	}
+	dynamic_cast<gxapi::ICopyCommandList*>(list)->Reset(allocator, nullptr);
+	return UniquePtr{ list, Deleter{ this, &cache } };
 }
 
 
 template <gxapi::eCommandListType TYPE>
-void CommandListPool<TYPE>::RecycleList(gxapi::ICommandList* list) {
-	std::lock_guard<std::mutex> lkg(m_mtx);
+void CommandListPool<TYPE>::RecycleList(gxapi::ICommandList* list, ThreadCache* cache) {
+	if (cache != nullptr && m_threadCache.Push(*cache, list)) {
+		return;
+	}
 
-	assert(m_addressToIndex.count(list) > 0);
-	size_t index = m_addressToIndex[list];
-	m_allocator.Deallocate(index);
+	std::lock_guard<std::mutex> lkg(m_mtx);
+	m_free.push_back(list);
 }
 
 
 template <gxapi::eCommandListType TYPE>
 void CommandListPool<TYPE>::Reset(size_t initialSize) {
+	m_threadCache.Clear();
+	m_free.clear();
 	m_pool.clear();
-	m_allocator.Reset();
-	m_pool.resize(initialSize);
-	m_allocator.Resize(initialSize);
+	m_pool.reserve(initialSize);
+	m_free.reserve(initialSize);
 }
 
 
@@ -167,9 +155,7 @@ public:
 public:
 	explicit CommandListPool(gxapi::IGraphicsApi* gxApi);
 	CommandListPool(const CommandListPool&) = delete;
-	CommandListPool(CommandListPool&& rhs) = default;
 	CommandListPool& operator=(const CommandListPool&) = delete;
-	CommandListPool& operator=(CommandListPool&& rhs) = default;
 
 	CmdListPtr RequestList(gxapi::eCommandListType type, gxapi::ICommandAllocator* allocator);
 	GraphicsCmdListPtr RequestGraphicsList(gxapi::ICommandAllocator* allocator);
@@ -181,6 +167,9 @@ public:
 
 	void SetLogStream(LogStream* logStream);
 	LogStream* GetLogStream() const;
+
+	/// <summary> How many requests each thread could serve from its own cache, for all command list types. </summary>
+	std::vector<PoolThreadStatistics> GetThreadStatistics() const;
 private:
 	impl::CommandListPool<gxapi::eCommandListType::GRAPHICS> m_gxPool;
 	impl::CommandListPool<gxapi::eCommandListType::COMPUTE> m_cuPool;
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+
+namespace inl {
+namespace gxeng {
+
+
+// Layout of a capture file:
+//	header
+//	object records, in creation order, so that objects come after their dependencies
+//	resource states, as the first barrier of the frame expects them
+//	descriptor records, the contents of the referenced descriptor heaps at the end of the frame
+//	submission records, in the order they were called on the queues
+// Every record is an opcode followed by its payload. Objects are referred to by ids, 0 is null.
+// GPU virtual addresses are stored as a buffer id and an offset into it, descriptor handles as a heap id and an index.
+
+static constexpr char CommandStreamMagic[8] = { 'I', 'N', 'L', 'C', 'M', 'D', 'S', '\0' };
+static constexpr uint32_t CommandStreamVersion = 1;
+
+
+struct CommandStreamHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t pointerSize; // descs are stored as they are in memory, the reader must be the same build flavor
+	uint32_t numObjects;
+	uint32_t numResourceStates;
+	uint32_t numDescriptors;
+	uint32_t numSubmissions;
+};
+
+
+enum class eCommandStreamOp : uint16_t {
+	// Objects
+	CREATE_COMMAND_QUEUE,
+	CREATE_COMMAND_ALLOCATOR,
+	CREATE_COMMITTED_RESOURCE,
+	CREATE_EXTERNAL_RESOURCE, // e.g. swap chain back buffers, replayed as committed resources
+	CREATE_ROOT_SIGNATURE,
+	CREATE_GRAPHICS_PIPELINE_STATE,
+	CREATE_COMPUTE_PIPELINE_STATE,
+	CREATE_DESCRIPTOR_HEAP,
+	CREATE_QUERY_HEAP,
+	CREATE_FENCE,
+	INITIAL_RESOURCE_STATE,
+
+	// Descriptors
+	CONSTANT_BUFFER_VIEW,
+	DEPTH_STENCIL_VIEW,
+	RENDER_TARGET_VIEW,
+	SHADER_RESOURCE_VIEW,
+	UNORDERED_ACCESS_VIEW,
+
+	// Submission
+	EXECUTE_COMMAND_LISTS,
+	SIGNAL,
+	WAIT,
+
+	// Copy command list
+	COPY_BUFFER,
+	COPY_RESOURCE,
+	COPY_TEXTURE_SUBRESOURCE,
+	COPY_TEXTURE_REGION,
+	COPY_TEXTURE,
+	RESOURCE_BARRIER,
+	END_QUERY,
+	RESOLVE_QUERY_DATA,
+
+	// Compute command list
+	DISPATCH,
+	SET_COMPUTE_ROOT_CONSTANTS,
+	SET_COMPUTE_ROOT_CONSTANT_BUFFER,
+	SET_COMPUTE_ROOT_DESCRIPTOR_TABLE,
+	SET_COMPUTE_ROOT_SHADER_RESOURCE,
+	SET_COMPUTE_ROOT_UNORDERED_RESOURCE,
+	SET_COMPUTE_ROOT_SIGNATURE,
+	SET_PIPELINE_STATE,
+	RESET_STATE,
+	SET_DESCRIPTOR_HEAPS,
+
+	// Graphics command list
+	CLEAR_DEPTH_STENCIL,
+	CLEAR_RENDER_TARGET,
+	DRAW_INDEXED_INSTANCED,
+	DRAW_INSTANCED,
+	EXECUTE_BUNDLE, // not replayed
+	SET_INDEX_BUFFER,
+	SET_PRIMITIVE_TOPOLOGY,
+	SET_VERTEX_BUFFERS,
+	SET_RENDER_TARGETS,
+	SET_BLEND_FACTOR,
+	SET_STENCIL_REF,
+	SET_SCISSOR_RECTS,
+	SET_VIEWPORTS,
+	SET_GRAPHICS_ROOT_CONSTANTS,
+	SET_GRAPHICS_ROOT_CONSTANT_BUFFER,
+	SET_GRAPHICS_ROOT_DESCRIPTOR_TABLE,
+	SET_GRAPHICS_ROOT_SHADER_RESOURCE,
+	SET_GRAPHICS_ROOT_SIGNATURE,
+};
+
+
+/// <summary> A GPU virtual address inside a buffer. </summary>
+struct CapturedAddress {
+	uint32_t resource;
+	uint64_t offset;
+};
+
+/// <summary> A descriptor inside a descriptor heap. </summary>
+struct CapturedDescriptor {
+	uint32_t heap;
+	uint32_t index;
+};
+
+
+/// <summary> Appends records to a growing byte buffer. </summary>
+class CommandStreamWriter {
+public:
+	/// <summary> Stores the bytes of plain structures. Pointers inside must be translated by the caller. </summary>
+	template <class T>
+	void Write(const T& value) {
+		WriteBytes(&value, sizeof(T));
+	}
+
+	void WriteBytes(const void* data, size_t size) {
+		if (!m_enabled) {
+			return;
+		}
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+		m_data.insert(m_data.end(), bytes, bytes + size);
+	}
+
+	void WriteString(const char* str) {
+		uint32_t length = str ? (uint32_t)strlen(str) : 0;
+		Write(length);
+		WriteBytes(str, length);
+	}
+
+	void WriteOp(eCommandStreamOp op) {
+		Write(op);
+	}
+
+	/// <summary> A disabled writer drops everything written to it, so that callers don't have to check. </summary>
+	void Enable(bool enabled) { m_enabled = enabled; }
+
+	void Clear() { m_data.clear(); }
+	const std::vector<uint8_t>& GetData() const { return m_data; }
+	size_t GetSize() const { return m_data.size(); }
+private:
+	std::vector<uint8_t> m_data;
+	bool m_enabled = true;
+};
+
+
+/// <summary> Reads records, throws if the stream ends in the middle of one. </summary>
+class CommandStreamReader {
+public:
+	CommandStreamReader() = default;
+	CommandStreamReader(const uint8_t* data, size_t size) : m_begin(data), m_current(data), m_end(data + size) {}
+
+	/// <summary> Reads a structure stored by <see cref="CommandStreamWriter::Write"/>, no constructor is called. </summary>
+	template <class T>
+	T Read() {
+		std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+		std::memcpy(&storage, ReadBytes(sizeof(T)), sizeof(T));
+		return *reinterpret_cast<const T*>(&storage);
+	}
+
+	const void* ReadBytes(size_t size) {
+		if (size_t(m_end - m_current) < size) {
+			throw InvalidArgumentException("Command stream is truncated.");
+		}
+		const uint8_t* data = m_current;
+		m_current += size;
+		return data;
+	}
+
+	std::string ReadString() {
+		uint32_t length = Read<uint32_t>();
+		const char* str = reinterpret_cast<const char*>(ReadBytes(length));
+		return std::string(str, str + length);
+	}
+
+	bool IsEnd() const { return m_current == m_end; }
+	size_t GetPosition() const { return m_current - m_begin; }
+private:
+	const uint8_t* m_begin = nullptr;
+	const uint8_t* m_current = nullptr;
+	const uint8_t* m_end = nullptr;
+};
+
+
+} // namespace gxeng
+} // namespace inl
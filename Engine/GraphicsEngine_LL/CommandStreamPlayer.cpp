@@ -0,0 +1,801 @@
+#include "CommandStreamPlayer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <optional>
+#include <string>
+
+
+namespace inl {
+namespace gxeng {
+
+
+using Clock = std::chrono::high_resolution_clock;
+
+
+static double ElapsedMs(Clock::time_point begin, Clock::time_point end) {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() / 1e6;
+}
+
+
+static gxapi::ShaderByteCodeDesc ReadShader(CommandStreamReader& reader) {
+	size_t size = (size_t)reader.Read<uint64_t>();
+	return { reader.ReadBytes(size), size }; // points into the capture, which outlives the pipeline state creation
+}
+
+
+static void ExpectOp(bool condition) {
+	if (!condition) {
+		throw InvalidArgumentException("Command stream capture is malformed.");
+	}
+}
+
+
+//------------------------------------------------------------------------------
+// Loading
+//------------------------------------------------------------------------------
+
+CommandStreamPlayer::CommandStreamPlayer(std::istream& capture) {
+	m_data.assign(std::istreambuf_iterator<char>(capture), std::istreambuf_iterator<char>());
+
+	CommandStreamReader reader(m_data.data(), m_data.size());
+	m_header = reader.Read<CommandStreamHeader>();
+	if (!std::equal(std::begin(CommandStreamMagic), std::end(CommandStreamMagic), m_header.magic)) {
+		throw InvalidArgumentException("Not a command stream capture.");
+	}
+	if (m_header.version != CommandStreamVersion || m_header.pointerSize != sizeof(void*)) {
+		throw InvalidArgumentException("Command stream capture was saved by an incompatible version.");
+	}
+
+	// Walk the whole capture once, so that malformed files are rejected before anything is created.
+	m_objectsOffset = reader.GetPosition();
+	for (uint32_t i = 0; i < m_header.numObjects; ++i) {
+		ReadObject(reader, false);
+	}
+	for (uint32_t i = 0; i < m_header.numResourceStates; ++i) {
+		ExpectOp(reader.Read<eCommandStreamOp>() == eCommandStreamOp::INITIAL_RESOURCE_STATE);
+		uint32_t resource = reader.Read<uint32_t>();
+		m_initialStates[resource] = reader.Read<gxapi::eResourceState>();
+	}
+	m_descriptorsOffset = reader.GetPosition();
+	for (uint32_t i = 0; i < m_header.numDescriptors; ++i) {
+		ReadDescriptor(reader, false);
+	}
+	for (uint32_t i = 0; i < m_header.numSubmissions; ++i) {
+		ReadSubmission(reader);
+	}
+	ExpectOp(reader.IsEnd());
+
+	// Fence values are relative to the first signal of the capture, see GetFenceValue.
+	std::unordered_map<uint32_t, uint64_t> lastFenceValues;
+	for (auto& submission : m_submissions) {
+		if (submission.op == eCommandStreamOp::SIGNAL) {
+			auto first = m_firstFenceValues.insert({ submission.fence, submission.value }).first;
+			first->second = std::min(first->second, submission.value);
+			lastFenceValues[submission.fence] = std::max(lastFenceValues[submission.fence], submission.value);
+			m_fenceValueSpan = std::max(m_fenceValueSpan, lastFenceValues[submission.fence] - first->second + 1);
+		}
+	}
+
+	m_statistics.numObjects = m_header.numObjects;
+	m_statistics.numDescriptors = m_header.numDescriptors;
+	m_statistics.numSubmissions = m_header.numSubmissions;
+}
+
+
+CommandStreamPlayer::~CommandStreamPlayer() = default;
+
+
+void CommandStreamPlayer::Prepare(gxapi::IGraphicsApi* graphicsApi) {
+	if (m_graphicsApi) {
+		throw InvalidStateException("Capture is already prepared.");
+	}
+	m_graphicsApi = graphicsApi;
+
+	CommandStreamReader objects(m_data.data() + m_objectsOffset, m_data.size() - m_objectsOffset);
+	for (uint32_t i = 0; i < m_header.numObjects; ++i) {
+		ReadObject(objects, true);
+	}
+
+	CommandStreamReader descriptors(m_data.data() + m_descriptorsOffset, m_data.size() - m_descriptorsOffset);
+	for (uint32_t i = 0; i < m_header.numDescriptors; ++i) {
+		ReadDescriptor(descriptors, true);
+	}
+
+	// Lists are created closed, Replay resets them.
+	for (auto& submission : m_submissions) {
+		for (auto& replayList : submission.lists) {
+			replayList.allocator.reset(graphicsApi->CreateCommandAllocator(replayList.type));
+			replayList.list.reset(graphicsApi->CreateCommandList(replayList.type, { replayList.allocator.get(), Find(m_pipelineStates, replayList.initialState) }));
+			dynamic_cast<gxapi::ICopyCommandList*>(replayList.list.get())->Close();
+		}
+	}
+
+	m_idleFence.reset(graphicsApi->CreateFence(0));
+}
+
+
+void CommandStreamPlayer::ReadObject(CommandStreamReader& reader, bool create) {
+	eCommandStreamOp op = reader.Read<eCommandStreamOp>();
+	uint32_t id = reader.Read<uint32_t>();
+
+	switch (op) {
+		case eCommandStreamOp::CREATE_COMMAND_QUEUE: {
+			auto desc = reader.Read<gxapi::CommandQueueDesc>();
+			if (create) {
+				m_queues[id].reset(m_graphicsApi->CreateCommandQueue(desc));
+			}
+			break;
+		}
+		case eCommandStreamOp::CREATE_COMMAND_ALLOCATOR:
+			reader.Read<gxapi::eCommandListType>(); // each replayed list has its own allocator
+			break;
+		case eCommandStreamOp::CREATE_COMMITTED_RESOURCE: {
+			auto heapProperties = reader.Read<gxapi::HeapProperties>();
+			auto heapFlags = reader.Read<gxapi::eHeapFlags>();
+			auto desc = reader.Read<gxapi::ResourceDesc>();
+			auto initialState = reader.Read<gxapi::eResourceState>();
+			bool hasClearValue = reader.Read<bool>();
+			std::optional<gxapi::ClearValue> clearValue;
+			if (hasClearValue) {
+				clearValue = reader.Read<gxapi::ClearValue>();
+			}
+			if (create) {
+				auto state = m_initialStates.find(id);
+				if (state != m_initialStates.end() && heapProperties.type == gxapi::eHeapType::DEFAULT) {
+					initialState = state->second;
+				}
+				m_resources[id].reset(m_graphicsApi->CreateCommittedResource(heapProperties, heapFlags, desc, initialState, clearValue ? &clearValue.value() : nullptr));
+			}
+			break;
+		}
+		case eCommandStreamOp::CREATE_EXTERNAL_RESOURCE: {
+			auto desc = reader.Read<gxapi::ResourceDesc>();
+			if (create) {
+				auto state = m_initialStates.find(id);
+				gxapi::eResourceState initialState = state != m_initialStates.end() ? state->second : gxapi::eResourceState::COMMON;
+				m_resources[id].reset(m_graphicsApi->CreateCommittedResource(gxapi::HeapProperties{ gxapi::eHeapType::DEFAULT }, gxapi::eHeapFlags::NONE, desc, initialState));
+			}
+			break;
+		}
+		case eCommandStreamOp::CREATE_ROOT_SIGNATURE: {
+			gxapi::RootSignatureDesc desc;
+			uint32_t numParameters = reader.Read<uint32_t>();
+			for (uint32_t i = 0; i < numParameters; ++i) {
+				auto type = reader.Read<gxapi::RootParameterDesc::eType>();
+				auto visibility = reader.Read<gxapi::eShaderVisiblity>();
+				switch (type) {
+					case gxapi::RootParameterDesc::CONSTANT: {
+						auto constant = reader.Read<gxapi::RootConstant>();
+						desc.rootParameters.push_back(gxapi::RootParameterDesc::Constant(constant.numConstants, constant.shaderRegister, constant.registerSpace, visibility));
+						break;
+					}
+					case gxapi::RootParameterDesc::CBV: {
+						auto descriptor = reader.Read<gxapi::RootDescriptor>();
+						desc.rootParameters.push_back(gxapi::RootParameterDesc::Cbv(descriptor.shaderRegister, descriptor.registerSpace, visibility));
+						break;
+					}
+					case gxapi::RootParameterDesc::SRV: {
+						auto descriptor = reader.Read<gxapi::RootDescriptor>();
+						desc.rootParameters.push_back(gxapi::RootParameterDesc::Srv(descriptor.shaderRegister, descriptor.registerSpace, visibility));
+						break;
+					}
+					case gxapi::RootParameterDesc::UAV: {
+						auto descriptor = reader.Read<gxapi::RootDescriptor>();
+						desc.rootParameters.push_back(gxapi::RootParameterDesc::Uav(descriptor.shaderRegister, descriptor.registerSpace, visibility));
+						break;
+					}
+					case gxapi::RootParameterDesc::DESCRIPTOR_TABLE: {
+						std::vector<gxapi::DescriptorRange> ranges(reader.Read<uint32_t>());
+						for (auto& range : ranges) {
+							range = reader.Read<gxapi::DescriptorRange>();
+						}
+						desc.rootParameters.push_back(gxapi::RootParameterDesc::DescriptorTable(std::move(ranges), visibility));
+						break;
+					}
+					default:
+						desc.rootParameters.push_back(gxapi::RootParameterDesc{});
+				}
+			}
+			uint32_t numSamplers = reader.Read<uint32_t>();
+			for (uint32_t i = 0; i < numSamplers; ++i) {
+				desc.staticSamplers.push_back(reader.Read<gxapi::StaticSamplerDesc>());
+			}
+			if (create) {
+				m_rootSignatures[id].reset(m_graphicsApi->CreateRootSignature(desc));
+			}
+			break;
+		}
+		case eCommandStreamOp::CREATE_GRAPHICS_PIPELINE_STATE: {
+			gxapi::GraphicsPipelineStateDesc desc;
+			uint32_t rootSignature = reader.Read<uint32_t>();
+			desc.vs = ReadShader(reader);
+			desc.gs = ReadShader(reader);
+			desc.hs = ReadShader(reader);
+			desc.ds = ReadShader(reader);
+			desc.ps = ReadShader(reader);
+			desc.rasterization = reader.Read<gxapi::RasterizerState>();
+			desc.depthStencilState = reader.Read<gxapi::DepthStencilState>();
+			desc.blending.alphaToCoverage = reader.Read<bool>();
+			desc.blending.independentBlending = reader.Read<bool>();
+			std::memcpy(desc.blending.multiTarget, reader.ReadBytes(sizeof(desc.blending.multiTarget)), sizeof(desc.blending.multiTarget));
+			desc.blendSampleMask = reader.Read<unsigned>();
+
+			std::vector<std::string> semanticNames(reader.Read<unsigned>());
+			std::vector<gxapi::InputElementDesc> elements(semanticNames.size());
+			for (size_t i = 0; i < elements.size(); ++i) {
+				semanticNames[i] = reader.ReadString();
+				elements[i].semanticName = semanticNames[i].c_str();
+				elements[i].semanticIndex = reader.Read<unsigned>();
+				elements[i].format = reader.Read<gxapi::eFormat>();
+				elements[i].inputSlot = reader.Read<unsigned>();
+				elements[i].offset = reader.Read<unsigned>();
+				elements[i].classifiacation = reader.Read<gxapi::eInputClassification>();
+				elements[i].instanceDataStepRate = reader.Read<unsigned>();
+			}
+			desc.inputLayout.numElements = (unsigned)elements.size();
+			desc.inputLayout.elements = elements.data();
+
+			desc.primitiveTopologyType = reader.Read<gxapi::ePrimitiveTopologyType>();
+			desc.triangleStripCutIndex = reader.Read<gxapi::eTriangleStripCutIndex>();
+			desc.numRenderTargets = reader.Read<unsigned>();
+			std::memcpy(desc.renderTargetFormats, reader.ReadBytes(sizeof(desc.renderTargetFormats)), sizeof(desc.renderTargetFormats));
+			desc.depthStencilFormat = reader.Read<gxapi::eFormat>();
+			desc.multisampleCount = reader.Read<unsigned>();
+			desc.multisampleQuality = reader.Read<unsigned>();
+			desc.addDebugInfo = reader.Read<bool>();
+			if (create) {
+				desc.rootSignature = Find(m_rootSignatures, rootSignature);
+				m_pipelineStates[id].reset(m_graphicsApi->CreateGraphicsPipelineState(desc));
+			}
+			break;
+		}
+		case eCommandStreamOp::CREATE_COMPUTE_PIPELINE_STATE: {
+			gxapi::ComputePipelineStateDesc desc;
+			uint32_t rootSignature = reader.Read<uint32_t>();
+			desc.cs = ReadShader(reader);
+			desc.addDebugInfo = reader.Read<bool>();
+			if (create) {
+				desc.rootSignature = Find(m_rootSignatures, rootSignature);
+				m_pipelineStates[id].reset(m_graphicsApi->CreateComputePipelineState(desc));
+			}
+			break;
+		}
+		case eCommandStreamOp::CREATE_DESCRIPTOR_HEAP: {
+			auto desc = reader.Read<gxapi::DescriptorHeapDesc>();
+			if (create) {
+				m_descriptorHeaps[id].reset(m_graphicsApi->CreateDescriptorHeap(desc));
+			}
+			break;
+		}
+		case eCommandStreamOp::CREATE_QUERY_HEAP: {
+			auto desc = reader.Read<gxapi::QueryHeapDesc>();
+			if (create) {
+				m_queryHeaps[id].reset(m_graphicsApi->CreateQueryHeap(desc));
+			}
+			break;
+		}
+		case eCommandStreamOp::CREATE_FENCE: {
+			reader.Read<uint64_t>(); // replayed values start from zero
+			if (create) {
+				m_fences[id].reset(m_graphicsApi->CreateFence(0));
+			}
+			break;
+		}
+		default:
+			ExpectOp(false);
+	}
+}
+
+
+void CommandStreamPlayer::ReadDescriptor(CommandStreamReader& reader, bool create) {
+	eCommandStreamOp op = reader.Read<eCommandStreamOp>();
+	auto destination = reader.Read<CapturedDescriptor>();
+
+	if (op == eCommandStreamOp::CONSTANT_BUFFER_VIEW) {
+		gxapi::ConstantBufferViewDesc desc;
+		auto address = reader.Read<CapturedAddress>();
+		desc.sizeInBytes = (size_t)reader.Read<uint64_t>();
+		if (create) {
+			desc.gpuVirtualAddress = GetAddress(address);
+			m_graphicsApi->CreateConstantBufferView(desc, GetDescriptor(destination));
+		}
+		return;
+	}
+
+	uint32_t resourceId = reader.Read<uint32_t>();
+	bool hasDesc = reader.Read<bool>();
+	gxapi::IResource* resource = create ? Find(m_resources, resourceId) : nullptr;
+	bool skip = !create || (resourceId != 0 && resource == nullptr); // resource did not make it into the capture
+	gxapi::DescriptorHandle handle = create ? GetDescriptor(destination) : gxapi::DescriptorHandle{};
+
+	switch (op) {
+		case eCommandStreamOp::DEPTH_STENCIL_VIEW: {
+			auto desc = hasDesc ? reader.Read<gxapi::DepthStencilViewDesc>() : gxapi::DepthStencilViewDesc{};
+			if (skip) break;
+			if (!hasDesc) m_graphicsApi->CreateDepthStencilView(resource, handle);
+			else if (!resource) m_graphicsApi->CreateDepthStencilView(desc, handle);
+			else m_graphicsApi->CreateDepthStencilView(resource, desc, handle);
+			break;
+		}
+		case eCommandStreamOp::RENDER_TARGET_VIEW: {
+			auto desc = hasDesc ? reader.Read<gxapi::RenderTargetViewDesc>() : gxapi::RenderTargetViewDesc{};
+			if (skip) break;
+			if (!hasDesc) m_graphicsApi->CreateRenderTargetView(resource, handle);
+			else m_graphicsApi->CreateRenderTargetView(resource, desc, handle);
+			break;
+		}
+		case eCommandStreamOp::SHADER_RESOURCE_VIEW: {
+			auto desc = hasDesc ? reader.Read<gxapi::ShaderResourceViewDesc>() : gxapi::ShaderResourceViewDesc{};
+			if (skip) break;
+			if (!hasDesc) m_graphicsApi->CreateShaderResourceView(resource, handle);
+			else if (!resource) m_graphicsApi->CreateShaderResourceView(desc, handle);
+			else m_graphicsApi->CreateShaderResourceView(resource, desc, handle);
+			break;
+		}
+		case eCommandStreamOp::UNORDERED_ACCESS_VIEW: {
+			auto desc = hasDesc ? reader.Read<gxapi::UnorderedAccessViewDesc>() : gxapi::UnorderedAccessViewDesc{};
+			if (skip) break;
+			if (!hasDesc) m_graphicsApi->CreateUnorderedAccessView(resource, handle);
+			else if (!resource) m_graphicsApi->CreateUnorderedAccessView(desc, handle);
+			else m_graphicsApi->CreateUnorderedAccessView(resource, desc, handle);
+			break;
+		}
+		default:
+			ExpectOp(false);
+	}
+}
+
+
+void CommandStreamPlayer::ReadSubmission(CommandStreamReader& reader) {
+	Submission submission;
+	submission.op = reader.Read<eCommandStreamOp>();
+	submission.queue = reader.Read<uint32_t>();
+
+	switch (submission.op) {
+		case eCommandStreamOp::EXECUTE_COMMAND_LISTS: {
+			uint32_t numLists = reader.Read<uint32_t>();
+			for (uint32_t i = 0; i < numLists; ++i) {
+				ReplayList replayList;
+				replayList.type = reader.Read<gxapi::eCommandListType>();
+				reader.Read<uint32_t>(); // allocator, each replayed list has its own
+				replayList.initialState = reader.Read<uint32_t>();
+				replayList.size = (size_t)reader.Read<uint64_t>();
+				replayList.commands = reinterpret_cast<const uint8_t*>(reader.ReadBytes(replayList.size));
+				m_statistics.numCommands += RecordCommands({ replayList.commands, replayList.size }, nullptr);
+				submission.lists.push_back(std::move(replayList));
+			}
+			m_statistics.numCommandLists += numLists;
+			break;
+		}
+		case eCommandStreamOp::SIGNAL:
+		case eCommandStreamOp::WAIT:
+			submission.fence = reader.Read<uint32_t>();
+			submission.value = reader.Read<uint64_t>();
+			break;
+		default:
+			ExpectOp(false);
+	}
+
+	m_submissions.push_back(std::move(submission));
+}
+
+
+//------------------------------------------------------------------------------
+// Replay
+//------------------------------------------------------------------------------
+
+CommandStreamReplayTiming CommandStreamPlayer::Replay() {
+	if (!m_graphicsApi) {
+		throw InvalidStateException("Capture must be prepared before replaying it.");
+	}
+
+	CommandStreamReplayTiming timing;
+	std::unordered_map<uint32_t, uint64_t> signaledValues; // captured values signaled in this replay
+
+	for (auto& submission : m_submissions) {
+		gxapi::ICommandQueue* queue = Find(m_queues, submission.queue);
+		if (!queue) {
+			continue;
+		}
+
+		if (submission.op == eCommandStreamOp::EXECUTE_COMMAND_LISTS) {
+			std::vector<gxapi::ICommandList*> lists;
+			auto recordBegin = Clock::now();
+			for (auto& replayList : submission.lists) {
+				auto list = dynamic_cast<gxapi::ICopyCommandList*>(replayList.list.get());
+				replayList.allocator->Reset();
+				list->Reset(replayList.allocator.get(), Find(m_pipelineStates, replayList.initialState));
+				RecordCommands({ replayList.commands, replayList.size }, list);
+				list->Close();
+				lists.push_back(replayList.list.get());
+			}
+			auto submitBegin = Clock::now();
+			queue->ExecuteCommandLists((uint32_t)lists.size(), lists.data());
+			auto submitEnd = Clock::now();
+			timing.recordMs += ElapsedMs(recordBegin, submitBegin);
+			timing.submitMs += ElapsedMs(submitBegin, submitEnd);
+			continue;
+		}
+
+		gxapi::IFence* fence = Find(m_fences, submission.fence);
+		if (!fence) {
+			continue;
+		}
+		if (submission.op == eCommandStreamOp::WAIT) {
+			// The CPU signaled this fence in the original frame, waiting for it would hang.
+			auto signaled = signaledValues.find(submission.fence);
+			if (signaled == signaledValues.end() || signaled->second < submission.value) {
+				++timing.numSkippedWaits;
+				continue;
+			}
+		}
+		else {
+			signaledValues[submission.fence] = std::max(signaledValues[submission.fence], submission.value);
+		}
+
+		auto submitBegin = Clock::now();
+		if (submission.op == eCommandStreamOp::SIGNAL) {
+			queue->Signal(fence, GetFenceValue(submission.fence, submission.value));
+		}
+		else {
+			queue->Wait(fence, GetFenceValue(submission.fence, submission.value));
+		}
+		timing.submitMs += ElapsedMs(submitBegin, Clock::now());
+	}
+
+	auto waitBegin = Clock::now();
+	for (auto& queue : m_queues) {
+		queue.second->Signal(m_idleFence.get(), ++m_idleFenceValue);
+		m_idleFence->Wait(m_idleFenceValue);
+	}
+	timing.gpuWaitMs = ElapsedMs(waitBegin, Clock::now());
+
+	++m_numReplays;
+	return timing;
+}
+
+
+size_t CommandStreamPlayer::RecordCommands(CommandStreamReader reader, gxapi::ICopyCommandList* list) {
+	auto computeList = dynamic_cast<gxapi::IComputeCommandList*>(list);
+	auto graphicsList = dynamic_cast<gxapi::IGraphicsCommandList*>(list);
+	auto requireCompute = [&] { ExpectOp(!list || computeList); return computeList != nullptr; };
+	auto requireGraphics = [&] { ExpectOp(!list || graphicsList); return graphicsList != nullptr; };
+	auto resource = [&] { return list ? Find(m_resources, reader.Read<uint32_t>()) : (reader.Read<uint32_t>(), nullptr); };
+	auto address = [&] { auto captured = reader.Read<CapturedAddress>(); return list ? GetAddress(captured) : nullptr; };
+	auto descriptor = [&] { auto captured = reader.Read<CapturedDescriptor>(); return list ? GetDescriptor(captured) : gxapi::DescriptorHandle{}; };
+
+	size_t numCommands = 0;
+	while (!reader.IsEnd()) {
+		eCommandStreamOp op = reader.Read<eCommandStreamOp>();
+		++numCommands;
+
+		switch (op) {
+			// Copy
+			case eCommandStreamOp::COPY_BUFFER: {
+				auto dst = resource();
+				auto dstOffset = reader.Read<uint64_t>();
+				auto src = resource();
+				auto srcOffset = reader.Read<uint64_t>();
+				auto numBytes = reader.Read<uint64_t>();
+				if (list && dst && src) list->CopyBuffer(dst, (size_t)dstOffset, src, (size_t)srcOffset, (size_t)numBytes);
+				break;
+			}
+			case eCommandStreamOp::COPY_RESOURCE: {
+				auto dst = resource();
+				auto src = resource();
+				if (list && dst && src) list->CopyResource(dst, src);
+				break;
+			}
+			case eCommandStreamOp::COPY_TEXTURE_SUBRESOURCE: {
+				auto dst = resource();
+				auto dstSubresource = reader.Read<unsigned>();
+				auto dstX = reader.Read<int>();
+				auto dstY = reader.Read<int>();
+				auto dstZ = reader.Read<int>();
+				auto src = resource();
+				auto srcSubresource = reader.Read<unsigned>();
+				auto srcRegion = reader.Read<gxapi::Cube>();
+				if (list && dst && src) list->CopyTexture(dst, dstSubresource, dstX, dstY, dstZ, src, srcSubresource, srcRegion);
+				break;
+			}
+			case eCommandStreamOp::COPY_TEXTURE_REGION:
+			case eCommandStreamOp::COPY_TEXTURE: {
+				auto dst = resource();
+				auto dstDesc = reader.Read<gxapi::TextureCopyDesc>();
+				auto dstX = reader.Read<int>();
+				auto dstY = reader.Read<int>();
+				auto dstZ = reader.Read<int>();
+				auto src = resource();
+				auto srcDesc = reader.Read<gxapi::TextureCopyDesc>();
+				if (op == eCommandStreamOp::COPY_TEXTURE_REGION) {
+					auto srcRegion = reader.Read<gxapi::Cube>();
+					if (list && dst && src) list->CopyTexture(dst, dstDesc, dstX, dstY, dstZ, src, srcDesc, srcRegion);
+				}
+				else {
+					if (list && dst && src) list->CopyTexture(dst, dstDesc, dstX, dstY, dstZ, src, srcDesc);
+				}
+				break;
+			}
+			case eCommandStreamOp::RESOURCE_BARRIER: {
+				uint32_t numBarriers = reader.Read<uint32_t>();
+				std::vector<gxapi::ResourceBarrier> barriers;
+				barriers.reserve(numBarriers);
+				for (uint32_t i = 0; i < numBarriers; ++i) {
+					auto type = reader.Read<gxapi::eResourceBarrierType>();
+					if (type == gxapi::eResourceBarrierType::TRANSITION) {
+						auto target = resource();
+						auto subResource = reader.Read<unsigned>();
+						auto beforeState = reader.Read<gxapi::eResourceState>();
+						auto afterState = reader.Read<gxapi::eResourceState>();
+						auto splitMode = reader.Read<gxapi::eResourceBarrierSplit>();
+						if (target) {
+							barriers.push_back(gxapi::TransitionBarrier{ target, beforeState, afterState, subResource, splitMode });
+						}
+					}
+					else if (type == gxapi::eResourceBarrierType::UAV) {
+						barriers.push_back(gxapi::UavBarrier{ resource() });
+					}
+				}
+				if (list && !barriers.empty()) list->ResourceBarrier((unsigned)barriers.size(), barriers.data());
+				break;
+			}
+			case eCommandStreamOp::END_QUERY: {
+				auto heapId = reader.Read<uint32_t>();
+				auto index = reader.Read<unsigned>();
+				auto heap = Find(m_queryHeaps, heapId);
+				if (list && heap) list->EndQuery(heap, index);
+				break;
+			}
+			case eCommandStreamOp::RESOLVE_QUERY_DATA: {
+				auto heapId = reader.Read<uint32_t>();
+				auto firstIndex = reader.Read<unsigned>();
+				auto numQueries = reader.Read<unsigned>();
+				auto destination = resource();
+				auto destinationOffset = reader.Read<uint64_t>();
+				auto heap = Find(m_queryHeaps, heapId);
+				if (list && heap && destination) list->ResolveQueryData(heap, firstIndex, numQueries, destination, (size_t)destinationOffset);
+				break;
+			}
+
+			// Compute
+			case eCommandStreamOp::DISPATCH: {
+				auto x = reader.Read<uint32_t>();
+				auto y = reader.Read<uint32_t>();
+				auto z = reader.Read<uint32_t>();
+				if (requireCompute()) computeList->Dispatch(x, y, z);
+				break;
+			}
+			case eCommandStreamOp::SET_COMPUTE_ROOT_CONSTANTS:
+			case eCommandStreamOp::SET_GRAPHICS_ROOT_CONSTANTS: {
+				auto parameterIndex = reader.Read<unsigned>();
+				auto destOffset = reader.Read<unsigned>();
+				auto numValues = reader.Read<unsigned>();
+				std::vector<uint32_t> values(numValues);
+				std::memcpy(values.data(), reader.ReadBytes(numValues * sizeof(uint32_t)), numValues * sizeof(uint32_t));
+				if (op == eCommandStreamOp::SET_COMPUTE_ROOT_CONSTANTS) {
+					if (requireCompute()) computeList->SetComputeRootConstants(parameterIndex, destOffset, numValues, values.data());
+				}
+				else {
+					if (requireGraphics()) graphicsList->SetGraphicsRootConstants(parameterIndex, destOffset, numValues, values.data());
+				}
+				break;
+			}
+			case eCommandStreamOp::SET_COMPUTE_ROOT_CONSTANT_BUFFER: {
+				auto parameterIndex = reader.Read<unsigned>();
+				auto gpuAddress = address();
+				if (requireCompute()) computeList->SetComputeRootConstantBuffer(parameterIndex, gpuAddress);
+				break;
+			}
+			case eCommandStreamOp::SET_COMPUTE_ROOT_DESCRIPTOR_TABLE: {
+				auto parameterIndex = reader.Read<unsigned>();
+				auto baseHandle = descriptor();
+				if (requireCompute()) computeList->SetComputeRootDescriptorTable(parameterIndex, baseHandle);
+				break;
+			}
+			case eCommandStreamOp::SET_COMPUTE_ROOT_SHADER_RESOURCE: {
+				auto parameterIndex = reader.Read<unsigned>();
+				auto gpuAddress = address();
+				if (requireCompute()) computeList->SetComputeRootShaderResource(parameterIndex, gpuAddress);
+				break;
+			}
+			case eCommandStreamOp::SET_COMPUTE_ROOT_UNORDERED_RESOURCE: {
+				auto parameterIndex = reader.Read<unsigned>();
+				auto gpuAddress = address();
+				if (requireCompute()) computeList->SetComputeRootUnorderedResource(parameterIndex, gpuAddress);
+				break;
+			}
+			case eCommandStreamOp::SET_COMPUTE_ROOT_SIGNATURE: {
+				auto rootSignature = Find(m_rootSignatures, reader.Read<uint32_t>());
+				if (requireCompute() && rootSignature) computeList->SetComputeRootSignature(rootSignature);
+				break;
+			}
+			case eCommandStreamOp::SET_PIPELINE_STATE: {
+				auto pipelineState = Find(m_pipelineStates, reader.Read<uint32_t>());
+				if (requireCompute() && pipelineState) computeList->SetPipelineState(pipelineState);
+				break;
+			}
+			case eCommandStreamOp::RESET_STATE: {
+				auto pipelineState = Find(m_pipelineStates, reader.Read<uint32_t>());
+				if (requireCompute()) computeList->ResetState(pipelineState);
+				break;
+			}
+			case eCommandStreamOp::SET_DESCRIPTOR_HEAPS: {
+				std::vector<gxapi::IDescriptorHeap*> heaps(reader.Read<uint32_t>());
+				for (auto& heap : heaps) {
+					heap = Find(m_descriptorHeaps, reader.Read<uint32_t>());
+				}
+				if (requireCompute()) computeList->SetDescriptorHeaps(heaps.data(), (uint32_t)heaps.size());
+				break;
+			}
+
+			// Graphics
+			case eCommandStreamOp::CLEAR_DEPTH_STENCIL: {
+				auto dsv = descriptor();
+				auto depth = reader.Read<float>();
+				auto stencil = reader.Read<uint8_t>();
+				auto clearDepth = reader.Read<bool>();
+				auto clearStencil = reader.Read<bool>();
+				std::vector<gxapi::Rectangle> rects(reader.Read<uint32_t>());
+				std::memcpy(rects.data(), reader.ReadBytes(rects.size() * sizeof(gxapi::Rectangle)), rects.size() * sizeof(gxapi::Rectangle));
+				if (requireGraphics()) graphicsList->ClearDepthStencil(dsv, depth, stencil, rects.size(), rects.empty() ? nullptr : rects.data(), clearDepth, clearStencil);
+				break;
+			}
+			case eCommandStreamOp::CLEAR_RENDER_TARGET: {
+				auto rtv = descriptor();
+				auto color = reader.Read<gxapi::ColorRGBA>();
+				std::vector<gxapi::Rectangle> rects(reader.Read<uint32_t>());
+				std::memcpy(rects.data(), reader.ReadBytes(rects.size() * sizeof(gxapi::Rectangle)), rects.size() * sizeof(gxapi::Rectangle));
+				if (requireGraphics()) graphicsList->ClearRenderTarget(rtv, color, rects.size(), rects.empty() ? nullptr : rects.data());
+				break;
+			}
+			case eCommandStreamOp::DRAW_INDEXED_INSTANCED: {
+				auto numIndices = reader.Read<unsigned>();
+				auto startIndex = reader.Read<unsigned>();
+				auto vertexOffset = reader.Read<int>();
+				auto numInstances = reader.Read<unsigned>();
+				auto startInstance = reader.Read<unsigned>();
+				if (requireGraphics()) graphicsList->DrawIndexedInstanced(numIndices, startIndex, vertexOffset, numInstances, startInstance);
+				break;
+			}
+			case eCommandStreamOp::DRAW_INSTANCED: {
+				auto numVertices = reader.Read<unsigned>();
+				auto startVertex = reader.Read<unsigned>();
+				auto numInstances = reader.Read<unsigned>();
+				auto startInstance = reader.Read<unsigned>();
+				if (requireGraphics()) graphicsList->DrawInstanced(numVertices, startVertex, numInstances, startInstance);
+				break;
+			}
+			case eCommandStreamOp::EXECUTE_BUNDLE:
+				if (!list) ++m_statistics.numUnsupportedCommands;
+				break;
+			case eCommandStreamOp::SET_INDEX_BUFFER: {
+				auto gpuAddress = address();
+				auto sizeInBytes = reader.Read<uint64_t>();
+				auto format = reader.Read<gxapi::eFormat>();
+				if (requireGraphics()) graphicsList->SetIndexBuffer(gpuAddress, (size_t)sizeInBytes, format);
+				break;
+			}
+			case eCommandStreamOp::SET_PRIMITIVE_TOPOLOGY: {
+				auto topology = reader.Read<gxapi::ePrimitiveTopology>();
+				if (requireGraphics()) graphicsList->SetPrimitiveTopology(topology);
+				break;
+			}
+			case eCommandStreamOp::SET_VERTEX_BUFFERS: {
+				auto startSlot = reader.Read<unsigned>();
+				auto count = reader.Read<unsigned>();
+				std::vector<void*> addresses(count);
+				std::vector<unsigned> sizes(count);
+				std::vector<unsigned> strides(count);
+				for (unsigned i = 0; i < count; ++i) {
+					addresses[i] = address();
+					sizes[i] = reader.Read<unsigned>();
+					strides[i] = reader.Read<unsigned>();
+				}
+				if (requireGraphics()) graphicsList->SetVertexBuffers(startSlot, count, addresses.data(), sizes.data(), strides.data());
+				break;
+			}
+			case eCommandStreamOp::SET_RENDER_TARGETS: {
+				std::vector<gxapi::DescriptorHandle> renderTargets(reader.Read<unsigned>());
+				for (auto& renderTarget : renderTargets) {
+					renderTarget = descriptor();
+				}
+				bool hasDepthStencil = reader.Read<bool>();
+				gxapi::DescriptorHandle depthStencil = hasDepthStencil ? descriptor() : gxapi::DescriptorHandle{};
+				if (requireGraphics()) graphicsList->SetRenderTargets((unsigned)renderTargets.size(), renderTargets.data(), hasDepthStencil ? &depthStencil : nullptr);
+				break;
+			}
+			case eCommandStreamOp::SET_BLEND_FACTOR: {
+				auto factor = reader.Read<gxapi::ColorRGBA>();
+				if (requireGraphics()) graphicsList->SetBlendFactor(factor.r, factor.g, factor.b, factor.a);
+				break;
+			}
+			case eCommandStreamOp::SET_STENCIL_REF: {
+				auto stencilRef = reader.Read<unsigned>();
+				if (requireGraphics()) graphicsList->SetStencilRef(stencilRef);
+				break;
+			}
+			case eCommandStreamOp::SET_SCISSOR_RECTS: {
+				std::vector<gxapi::Rectangle> rects(reader.Read<unsigned>());
+				std::memcpy(rects.data(), reader.ReadBytes(rects.size() * sizeof(gxapi::Rectangle)), rects.size() * sizeof(gxapi::Rectangle));
+				if (requireGraphics()) graphicsList->SetScissorRects((unsigned)rects.size(), rects.data());
+				break;
+			}
+			case eCommandStreamOp::SET_VIEWPORTS: {
+				auto numViewports = reader.Read<unsigned>();
+				std::vector<gxapi::Viewport> viewports(numViewports);
+				std::memcpy(viewports.data(), reader.ReadBytes(numViewports * sizeof(gxapi::Viewport)), numViewports * sizeof(gxapi::Viewport));
+				if (requireGraphics()) graphicsList->SetViewports(numViewports, viewports.data());
+				break;
+			}
+			case eCommandStreamOp::SET_GRAPHICS_ROOT_CONSTANT_BUFFER: {
+				auto parameterIndex = reader.Read<unsigned>();
+				auto gpuAddress = address();
+				if (requireGraphics()) graphicsList->SetGraphicsRootConstantBuffer(parameterIndex, gpuAddress);
+				break;
+			}
+			case eCommandStreamOp::SET_GRAPHICS_ROOT_DESCRIPTOR_TABLE: {
+				auto parameterIndex = reader.Read<unsigned>();
+				auto baseHandle = descriptor();
+				if (requireGraphics()) graphicsList->SetGraphicsRootDescriptorTable(parameterIndex, baseHandle);
+				break;
+			}
+			case eCommandStreamOp::SET_GRAPHICS_ROOT_SHADER_RESOURCE: {
+				auto parameterIndex = reader.Read<unsigned>();
+				auto gpuAddress = address();
+				if (requireGraphics()) graphicsList->SetGraphicsRootShaderResource(parameterIndex, gpuAddress);
+				break;
+			}
+			case eCommandStreamOp::SET_GRAPHICS_ROOT_SIGNATURE: {
+				auto rootSignature = Find(m_rootSignatures, reader.Read<uint32_t>());
+				if (requireGraphics() && rootSignature) graphicsList->SetGraphicsRootSignature(rootSignature);
+				break;
+			}
+			default:
+				ExpectOp(false);
+		}
+	}
+
+	return numCommands;
+}
+
+
+//------------------------------------------------------------------------------
+// Lookup
+//------------------------------------------------------------------------------
+
+template <class T>
+T* CommandStreamPlayer::Find(const std::unordered_map<uint32_t, std::unique_ptr<T>>& objects, uint32_t id) {
+	auto it = objects.find(id);
+	return it != objects.end() ? it->second.get() : nullptr;
+}
+
+
+void* CommandStreamPlayer::GetAddress(CapturedAddress address) const {
+	gxapi::IResource* resource = Find(m_resources, address.resource);
+	if (!resource) {
+		return nullptr;
+	}
+	return reinterpret_cast<uint8_t*>(resource->GetGPUAddress()) + address.offset;
+}
+
+
+gxapi::DescriptorHandle CommandStreamPlayer::GetDescriptor(CapturedDescriptor descriptor) const {
+	gxapi::IDescriptorHeap* heap = Find(m_descriptorHeaps, descriptor.heap);
+	if (!heap) {
+		return {};
+	}
+	return heap->At(descriptor.index);
+}
+
+
+uint64_t CommandStreamPlayer::GetFenceValue(uint32_t fence, uint64_t capturedValue) const {
+	auto first = m_firstFenceValues.find(fence);
+	uint64_t relativeValue = first != m_firstFenceValues.end() ? capturedValue - first->second : 0;
+	return m_numReplays * m_fenceValueSpan + relativeValue + 1;
+}
+
+
+} // namespace gxeng
+} // namespace inl
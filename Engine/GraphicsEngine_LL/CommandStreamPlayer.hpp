@@ -0,0 +1,126 @@
+#pragma once
+
+#include "CommandStreamFormat.hpp"
+
+#include <GraphicsApi_LL/IGraphicsApi.hpp>
+#include <GraphicsApi_LL/ICommandList.hpp>
+#include <GraphicsApi_LL/ICommandQueue.hpp>
+#include <GraphicsApi_LL/ICommandAllocator.hpp>
+#include <GraphicsApi_LL/IDescriptorHeap.hpp>
+#include <GraphicsApi_LL/IPipelineState.hpp>
+#include <GraphicsApi_LL/IRootSignature.hpp>
+#include <GraphicsApi_LL/IResource.hpp>
+#include <GraphicsApi_LL/IQueryHeap.hpp>
+#include <GraphicsApi_LL/IFence.hpp>
+
+#include <istream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+
+namespace inl {
+namespace gxeng {
+
+
+struct CommandStreamStatistics {
+	size_t numObjects = 0;
+	size_t numDescriptors = 0;
+	size_t numSubmissions = 0;
+	size_t numCommandLists = 0;
+	size_t numCommands = 0;
+	size_t numUnsupportedCommands = 0; // e.g. bundles, these are not replayed
+};
+
+
+struct CommandStreamReplayTiming {
+	double recordMs = 0; // resetting, recording and closing the command lists
+	double submitMs = 0; // executing command lists and signaling or waiting on queues
+	double gpuWaitMs = 0; // waiting for the GPU to finish the frame
+	size_t numSkippedWaits = 0; // waits on fences that no captured submission signals
+};
+
+
+/// <summary>
+/// Replays a frame saved by the <see cref="CommandStreamRecorder"/> on any graphics API.
+/// <para />
+/// <see cref="Prepare"/> creates the objects of the capture, and fills the descriptor heaps.
+/// Each <see cref="Replay"/> records the captured command lists again and submits them in the captured order,
+/// so the timings show the CPU cost of the graphics API without the engine on top of it.
+/// </summary>
+/// <remarks>
+/// Resources start in the state the first barrier of the frame expects. Buffer contents are not captured.
+/// Fence values are offset by each replay, so that replays can follow each other on the same fences.
+/// </remarks>
+class CommandStreamPlayer {
+public:
+	/// <summary> Loads a capture. Throws <see cref="InvalidArgumentException"/> if the capture is malformed,
+	///		or it was saved by an incompatible build. </summary>
+	explicit CommandStreamPlayer(std::istream& capture);
+	CommandStreamPlayer(const CommandStreamPlayer&) = delete;
+	CommandStreamPlayer& operator=(const CommandStreamPlayer&) = delete;
+	~CommandStreamPlayer();
+
+	/// <summary> Creates the captured objects and descriptors on <paramref name="graphicsApi"/>. </summary>
+	void Prepare(gxapi::IGraphicsApi* graphicsApi);
+
+	/// <summary> Records and submits the captured frame, then waits for the GPU to finish it. </summary>
+	CommandStreamReplayTiming Replay();
+
+	const CommandStreamStatistics& GetStatistics() const { return m_statistics; }
+private:
+	struct ReplayList {
+		gxapi::eCommandListType type;
+		uint32_t initialState;
+		const uint8_t* commands;
+		size_t size;
+		std::unique_ptr<gxapi::ICommandAllocator> allocator;
+		std::unique_ptr<gxapi::ICommandList> list;
+	};
+
+	struct Submission {
+		eCommandStreamOp op;
+		uint32_t queue;
+		uint32_t fence; // signal and wait
+		uint64_t value; // signal and wait
+		std::vector<ReplayList> lists; // execute
+	};
+private:
+	void ReadObject(CommandStreamReader& reader, bool create);
+	void ReadDescriptor(CommandStreamReader& reader, bool create);
+	void ReadSubmission(CommandStreamReader& reader);
+	/// <summary> Replays the commands on the list, or only validates them if the list is null. </summary>
+	size_t RecordCommands(CommandStreamReader reader, gxapi::ICopyCommandList* list);
+
+	template <class T>
+	static T* Find(const std::unordered_map<uint32_t, std::unique_ptr<T>>& objects, uint32_t id);
+	void* GetAddress(CapturedAddress address) const;
+	gxapi::DescriptorHandle GetDescriptor(CapturedDescriptor descriptor) const;
+	uint64_t GetFenceValue(uint32_t fence, uint64_t capturedValue) const;
+private:
+	std::vector<uint8_t> m_data;
+	size_t m_objectsOffset = 0;
+	size_t m_descriptorsOffset = 0;
+	CommandStreamHeader m_header;
+	CommandStreamStatistics m_statistics;
+	std::vector<Submission> m_submissions;
+	std::unordered_map<uint32_t, gxapi::eResourceState> m_initialStates;
+	std::unordered_map<uint32_t, uint64_t> m_firstFenceValues; // the lowest value each fence is signaled to
+	uint64_t m_fenceValueSpan = 0;
+
+	gxapi::IGraphicsApi* m_graphicsApi = nullptr;
+	std::unordered_map<uint32_t, std::unique_ptr<gxapi::ICommandQueue>> m_queues;
+	std::unordered_map<uint32_t, std::unique_ptr<gxapi::IResource>> m_resources;
+	std::unordered_map<uint32_t, std::unique_ptr<gxapi::IRootSignature>> m_rootSignatures;
+	std::unordered_map<uint32_t, std::unique_ptr<gxapi::IPipelineState>> m_pipelineStates;
+	std::unordered_map<uint32_t, std::unique_ptr<gxapi::IDescriptorHeap>> m_descriptorHeaps;
+	std::unordered_map<uint32_t, std::unique_ptr<gxapi::IQueryHeap>> m_queryHeaps;
+	std::unordered_map<uint32_t, std::unique_ptr<gxapi::IFence>> m_fences;
+	std::unique_ptr<gxapi::IFence> m_idleFence;
+	uint64_t m_idleFenceValue = 0;
+	uint64_t m_numReplays = 0;
+};
+
+
+} // namespace gxeng
+} // namespace inl
@@ -0,0 +1,1508 @@
+#include "CommandStreamRecorder.hpp"
+
+#include <GraphicsApi_LL/ICommandAllocator.hpp>
+#include <GraphicsApi_LL/IDescriptorHeap.hpp>
+#include <GraphicsApi_LL/IResource.hpp>
+#include <GraphicsApi_LL/IFence.hpp>
+#include <GraphicsApi_LL/IQueryHeap.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+
+namespace inl {
+namespace gxeng {
+
+
+static void WriteShader(CommandStreamWriter& writer, const gxapi::ShaderByteCodeDesc& shader) {
+	writer.Write((uint64_t)shader.sizeOfByteCode);
+	writer.WriteBytes(shader.shaderByteCode, shader.sizeOfByteCode);
+}
+
+
+//------------------------------------------------------------------------------
+// Copy command list
+//------------------------------------------------------------------------------
+
+RecordingCopyCommandList::RecordingCopyCommandList(CommandStreamRecorder* recorder, gxapi::ICopyCommandList* commandList, gxapi::CommandListDesc desc)
+	: m_recorder(recorder),
+	m_commandList(commandList),
+	m_copyList(commandList)
+{
+	Restart(desc.allocator, desc.initialState);
+}
+
+
+gxapi::eCommandListType RecordingCopyCommandList::GetType() const {
+	return m_commandList->GetType();
+}
+
+
+void RecordingCopyCommandList::Close() {
+	m_copyList->Close();
+}
+
+
+void RecordingCopyCommandList::Reset(gxapi::ICommandAllocator* allocator, gxapi::IPipelineState* newState) {
+	m_copyList->Reset(allocator, newState);
+	Restart(allocator, newState);
+}
+
+
+void RecordingCopyCommandList::CopyBuffer(gxapi::IResource* dst, size_t dstOffset, gxapi::IResource* src, size_t srcOffset, size_t numBytes) {
+	m_commands.WriteOp(eCommandStreamOp::COPY_BUFFER);
+	WriteResource(dst);
+	m_commands.Write((uint64_t)dstOffset);
+	WriteResource(src);
+	m_commands.Write((uint64_t)srcOffset);
+	m_commands.Write((uint64_t)numBytes);
+	m_copyList->CopyBuffer(CommandStreamRecorder::GetInnerResource(dst), dstOffset, CommandStreamRecorder::GetInnerResource(src), srcOffset, numBytes);
+}
+
+
+void RecordingCopyCommandList::CopyResource(gxapi::IResource* dst, gxapi::IResource* src) {
+	m_commands.WriteOp(eCommandStreamOp::COPY_RESOURCE);
+	WriteResource(dst);
+	WriteResource(src);
+	m_copyList->CopyResource(CommandStreamRecorder::GetInnerResource(dst), CommandStreamRecorder::GetInnerResource(src));
+}
+
+
+void RecordingCopyCommandList::CopyTexture(gxapi::IResource* dst,
+										   unsigned dstSubresourceIndex,
+										   int dstX, int dstY, int dstZ,
+										   gxapi::IResource* src,
+										   unsigned srcSubresourceIndex,
+										   gxapi::Cube srcRegion)
+{
+	m_commands.WriteOp(eCommandStreamOp::COPY_TEXTURE_SUBRESOURCE);
+	WriteResource(dst);
+	m_commands.Write(dstSubresourceIndex);
+	m_commands.Write(dstX);
+	m_commands.Write(dstY);
+	m_commands.Write(dstZ);
+	WriteResource(src);
+	m_commands.Write(srcSubresourceIndex);
+	m_commands.Write(srcRegion);
+	m_copyList->CopyTexture(CommandStreamRecorder::GetInnerResource(dst), dstSubresourceIndex, dstX, dstY, dstZ, CommandStreamRecorder::GetInnerResource(src), srcSubresourceIndex, srcRegion);
+}
+
+
+void RecordingCopyCommandList::CopyTexture(gxapi::IResource* dst,
+										   gxapi::TextureCopyDesc dstDesc,
+										   int dstX, int dstY, int dstZ,
+										   gxapi::IResource* src,
+										   gxapi::TextureCopyDesc srcDesc,
+										   gxapi::Cube srcRegion)
+{
+	m_commands.WriteOp(eCommandStreamOp::COPY_TEXTURE_REGION);
+	WriteResource(dst);
+	m_commands.Write(dstDesc);
+	m_commands.Write(dstX);
+	m_commands.Write(dstY);
+	m_commands.Write(dstZ);
+	WriteResource(src);
+	m_commands.Write(srcDesc);
+	m_commands.Write(srcRegion);
+	m_copyList->CopyTexture(CommandStreamRecorder::GetInnerResource(dst), dstDesc, dstX, dstY, dstZ, CommandStreamRecorder::GetInnerResource(src), srcDesc, srcRegion);
+}
+
+
+void RecordingCopyCommandList::CopyTexture(gxapi::IResource* dst,
+										   gxapi::TextureCopyDesc dstDesc,
+										   int dstX, int dstY, int dstZ,
+										   gxapi::IResource* src,
+										   gxapi::TextureCopyDesc srcDesc)
+{
+	m_commands.WriteOp(eCommandStreamOp::COPY_TEXTURE);
+	WriteResource(dst);
+	m_commands.Write(dstDesc);
+	m_commands.Write(dstX);
+	m_commands.Write(dstY);
+	m_commands.Write(dstZ);
+	WriteResource(src);
+	m_commands.Write(srcDesc);
+	m_copyList->CopyTexture(CommandStreamRecorder::GetInnerResource(dst), dstDesc, dstX, dstY, dstZ, CommandStreamRecorder::GetInnerResource(src), srcDesc);
+}
+
+
+void RecordingCopyCommandList::ResourceBarrier(unsigned numBarriers, gxapi::ResourceBarrier* barriers) {
+	std::vector<gxapi::ResourceBarrier> innerBarriers(barriers, barriers + numBarriers);
+	for (auto& barrier : innerBarriers) {
+		switch (barrier.type) {
+			case gxapi::eResourceBarrierType::TRANSITION:
+				barrier.transition.resource = CommandStreamRecorder::GetInnerResource(barrier.transition.resource);
+				break;
+			case gxapi::eResourceBarrierType::UAV:
+				barrier.uav.resource = CommandStreamRecorder::GetInnerResource(barrier.uav.resource);
+				break;
+			default:
+				break;
+		}
+	}
+
+	if (!m_recording) {
+		m_copyList->ResourceBarrier(numBarriers, innerBarriers.data());
+		return;
+	}
+
+	m_commands.WriteOp(eCommandStreamOp::RESOURCE_BARRIER);
+	m_commands.Write(numBarriers);
+	for (unsigned i = 0; i < numBarriers; ++i) {
+		const gxapi::ResourceBarrier& barrier = barriers[i];
+		m_commands.Write(barrier.type);
+		switch (barrier.type) {
+			case gxapi::eResourceBarrierType::TRANSITION: {
+				const gxapi::TransitionBarrier& transition = barrier.transition;
+				WriteResource(transition.resource);
+				m_commands.Write(transition.subResource);
+				m_commands.Write(transition.beforeState);
+				m_commands.Write(transition.afterState);
+				m_commands.Write(transition.splitMode);
+
+				uint32_t id = m_references.empty() ? 0 : m_references.back(); // just written by WriteResource
+				auto sameResource = [id](const auto& entry) { return entry.first == id; };
+				if (id != 0 && std::none_of(m_firstStates.begin(), m_firstStates.end(), sameResource)) {
+					m_firstStates.push_back({ id, transition.beforeState });
+				}
+				break;
+			}
+			case gxapi::eResourceBarrierType::UAV:
+				WriteResource(barrier.uav.resource);
+				break;
+			default:
+				break;
+		}
+	}
+	m_copyList->ResourceBarrier(numBarriers, innerBarriers.data());
+}
+
+
+void RecordingCopyCommandList::EndQuery(gxapi::IQueryHeap* heap, unsigned index) {
+	m_commands.WriteOp(eCommandStreamOp::END_QUERY);
+	WriteObject(heap);
+	m_commands.Write(index);
+	m_copyList->EndQuery(heap, index);
+}
+
+
+void RecordingCopyCommandList::ResolveQueryData(gxapi::IQueryHeap* heap, unsigned firstIndex, unsigned numQueries, gxapi::IResource* destination, size_t destinationOffset) {
+	m_commands.WriteOp(eCommandStreamOp::RESOLVE_QUERY_DATA);
+	WriteObject(heap);
+	m_commands.Write(firstIndex);
+	m_commands.Write(numQueries);
+	WriteResource(destination);
+	m_commands.Write((uint64_t)destinationOffset);
+	m_copyList->ResolveQueryData(heap, firstIndex, numQueries, CommandStreamRecorder::GetInnerResource(destination), destinationOffset);
+}
+
+
+void RecordingCopyCommandList::WriteObject(const void* object) {
+	if (!m_recording) {
+		return;
+	}
+	uint32_t id;
+	{
+		std::lock_guard<std::mutex> lkg(m_recorder->m_mutex);
+		id = m_recorder->GetObjectId(object);
+	}
+	m_commands.Write(id);
+	m_references.push_back(id);
+}
+
+
+void RecordingCopyCommandList::WriteResource(const gxapi::IResource* resource) {
+	if (!m_recording) {
+		return;
+	}
+	uint32_t id;
+	{
+		std::lock_guard<std::mutex> lkg(m_recorder->m_mutex);
+		id = m_recorder->GetResourceId(resource);
+	}
+	m_commands.Write(id);
+	m_references.push_back(id);
+}
+
+
+void RecordingCopyCommandList::WriteAddress(const void* gpuVirtualAddress) {
+	if (!m_recording) {
+		return;
+	}
+	CapturedAddress address;
+	{
+		std::lock_guard<std::mutex> lkg(m_recorder->m_mutex);
+		address = m_recorder->TranslateAddress(gpuVirtualAddress);
+	}
+	m_commands.Write(address);
+	m_references.push_back(address.resource);
+}
+
+
+void RecordingCopyCommandList::WriteDescriptor(const gxapi::DescriptorHandle& handle) {
+	if (!m_recording) {
+		return;
+	}
+	CapturedDescriptor descriptor;
+	{
+		std::lock_guard<std::mutex> lkg(m_recorder->m_mutex);
+		descriptor = m_recorder->TranslateDescriptor(handle);
+	}
+	m_commands.Write(descriptor);
+	m_references.push_back(descriptor.heap);
+}
+
+
+void RecordingCopyCommandList::Restart(gxapi::ICommandAllocator* allocator, gxapi::IPipelineState* initialState) {
+	m_commands.Clear();
+	m_commands.Enable(false);
+	m_references.clear();
+	m_firstStates.clear();
+
+	std::lock_guard<std::mutex> lkg(m_recorder->m_mutex);
+	m_recording = m_recorder->m_capturing;
+	if (!m_recording) {
+		return;
+	}
+	m_commands.Enable(true);
+	m_allocator = m_recorder->GetObjectId(allocator);
+	m_initialState = m_recorder->GetObjectId(initialState);
+	m_references.push_back(m_allocator);
+	m_references.push_back(m_initialState);
+}
+
+
+//------------------------------------------------------------------------------
+// Compute command list
+//------------------------------------------------------------------------------
+
+RecordingComputeCommandList::RecordingComputeCommandList(CommandStreamRecorder* recorder, gxapi::IComputeCommandList* commandList, gxapi::CommandListDesc desc)
+	: RecordingCopyCommandList(recorder, commandList, desc),
+	m_computeList(commandList)
+{}
+
+
+void RecordingComputeCommandList::Dispatch(size_t dimx, size_t dimy, size_t dimz) {
+	m_commands.WriteOp(eCommandStreamOp::DISPATCH);
+	m_commands.Write((uint32_t)dimx);
+	m_commands.Write((uint32_t)dimy);
+	m_commands.Write((uint32_t)dimz);
+	m_computeList->Dispatch(dimx, dimy, dimz);
+}
+
+
+void RecordingComputeCommandList::SetComputeRootConstant(unsigned parameterIndex, unsigned destOffset, uint32_t value) {
+	SetComputeRootConstants(parameterIndex, destOffset, 1, &value);
+}
+
+
+void RecordingComputeCommandList::SetComputeRootConstants(unsigned parameterIndex, unsigned destOffset, unsigned numValues, const uint32_t* value) {
+	m_commands.WriteOp(eCommandStreamOp::SET_COMPUTE_ROOT_CONSTANTS);
+	m_commands.Write(parameterIndex);
+	m_commands.Write(destOffset);
+	m_commands.Write(numValues);
+	m_commands.WriteBytes(value, numValues * sizeof(uint32_t));
+	m_computeList->SetComputeRootConstants(parameterIndex, destOffset, numValues, value);
+}
+
+
+void RecordingComputeCommandList::SetComputeRootConstantBuffer(unsigned parameterIndex, void* gpuVirtualAddress) {
+	m_commands.WriteOp(eCommandStreamOp::SET_COMPUTE_ROOT_CONSTANT_BUFFER);
+	m_commands.Write(parameterIndex);
+	WriteAddress(gpuVirtualAddress);
+	m_computeList->SetComputeRootConstantBuffer(parameterIndex, gpuVirtualAddress);
+}
+
+
+void RecordingComputeCommandList::SetComputeRootDescriptorTable(unsigned parameterIndex, gxapi::DescriptorHandle baseHandle) {
+	m_commands.WriteOp(eCommandStreamOp::SET_COMPUTE_ROOT_DESCRIPTOR_TABLE);
+	m_commands.Write(parameterIndex);
+	WriteDescriptor(baseHandle);
+	m_computeList->SetComputeRootDescriptorTable(parameterIndex, baseHandle);
+}
+
+
+void RecordingComputeCommandList::SetComputeRootShaderResource(unsigned parameterIndex, void* gpuVirtualAddress) {
+	m_commands.WriteOp(eCommandStreamOp::SET_COMPUTE_ROOT_SHADER_RESOURCE);
+	m_commands.Write(parameterIndex);
+	WriteAddress(gpuVirtualAddress);
+	m_computeList->SetComputeRootShaderResource(parameterIndex, gpuVirtualAddress);
+}
+
+
+void RecordingComputeCommandList::SetComputeRootUnorderedResource(unsigned parameterIndex, void* gpuVirtualAddress) {
+	m_commands.WriteOp(eCommandStreamOp::SET_COMPUTE_ROOT_UNORDERED_RESOURCE);
+	m_commands.Write(parameterIndex);
+	WriteAddress(gpuVirtualAddress);
+	m_computeList->SetComputeRootUnorderedResource(parameterIndex, gpuVirtualAddress);
+}
+
+
+void RecordingComputeCommandList::SetComputeRootSignature(gxapi::IRootSignature* rootSignature) {
+	m_commands.WriteOp(eCommandStreamOp::SET_COMPUTE_ROOT_SIGNATURE);
+	WriteObject(rootSignature);
+	m_computeList->SetComputeRootSignature(rootSignature);
+}
+
+
+void RecordingComputeCommandList::SetPipelineState(gxapi::IPipelineState* pipelineState) {
+	m_commands.WriteOp(eCommandStreamOp::SET_PIPELINE_STATE);
+	WriteObject(pipelineState);
+	m_computeList->SetPipelineState(pipelineState);
+}
+
+
+void RecordingComputeCommandList::ResetState(gxapi::IPipelineState* initialPipelineState) {
+	m_commands.WriteOp(eCommandStreamOp::RESET_STATE);
+	WriteObject(initialPipelineState);
+	m_computeList->ResetState(initialPipelineState);
+}
+
+
+void RecordingComputeCommandList::SetDescriptorHeaps(gxapi::IDescriptorHeap* const* heaps, uint32_t count) {
+	m_commands.WriteOp(eCommandStreamOp::SET_DESCRIPTOR_HEAPS);
+	m_commands.Write(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		WriteObject(heaps[i]);
+	}
+	std::vector<gxapi::IDescriptorHeap*> innerHeaps(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		innerHeaps[i] = CommandStreamRecorder::GetInnerHeap(heaps[i]);
+	}
+	m_computeList->SetDescriptorHeaps(innerHeaps.data(), count);
+}
+
+
+//------------------------------------------------------------------------------
+// Graphics command list
+//------------------------------------------------------------------------------
+
+RecordingGraphicsCommandList::RecordingGraphicsCommandList(CommandStreamRecorder* recorder, gxapi::IGraphicsCommandList* commandList, gxapi::CommandListDesc desc)
+	: RecordingComputeCommandList(recorder, commandList, desc),
+	m_graphicsList(commandList)
+{}
+
+
+void RecordingGraphicsCommandList::ClearDepthStencil(gxapi::DescriptorHandle dsv,
+													 float depth,
+													 uint8_t stencil,
+													 size_t numRects,
+													 gxapi::Rectangle* rects,
+													 bool clearDepth,
+													 bool clearStencil)
+{
+	m_commands.WriteOp(eCommandStreamOp::CLEAR_DEPTH_STENCIL);
+	WriteDescriptor(dsv);
+	m_commands.Write(depth);
+	m_commands.Write(stencil);
+	m_commands.Write(clearDepth);
+	m_commands.Write(clearStencil);
+	m_commands.Write((uint32_t)numRects);
+	m_commands.WriteBytes(rects, numRects * sizeof(gxapi::Rectangle));
+	m_graphicsList->ClearDepthStencil(dsv, depth, stencil, numRects, rects, clearDepth, clearStencil);
+}
+
+
+void RecordingGraphicsCommandList::ClearRenderTarget(gxapi::DescriptorHandle rtv,
+													 gxapi::ColorRGBA color,
+													 size_t numRects,
+													 gxapi::Rectangle* rects)
+{
+	m_commands.WriteOp(eCommandStreamOp::CLEAR_RENDER_TARGET);
+	WriteDescriptor(rtv);
+	m_commands.Write(color);
+	m_commands.Write((uint32_t)numRects);
+	m_commands.WriteBytes(rects, numRects * sizeof(gxapi::Rectangle));
+	m_graphicsList->ClearRenderTarget(rtv, color, numRects, rects);
+}
+
+
+void RecordingGraphicsCommandList::DrawIndexedInstanced(unsigned numIndices, unsigned startIndex, int vertexOffset, unsigned numInstances, unsigned startInstance) {
+	m_commands.WriteOp(eCommandStreamOp::DRAW_INDEXED_INSTANCED);
+	m_commands.Write(numIndices);
+	m_commands.Write(startIndex);
+	m_commands.Write(vertexOffset);
+	m_commands.Write(numInstances);
+	m_commands.Write(startInstance);
+	m_graphicsList->DrawIndexedInstanced(numIndices, startIndex, vertexOffset, numInstances, startInstance);
+}
+
+
+void RecordingGraphicsCommandList::DrawInstanced(unsigned numVertices, unsigned startVertex, unsigned numInstances, unsigned startInstance) {
+	m_commands.WriteOp(eCommandStreamOp::DRAW_INSTANCED);
+	m_commands.Write(numVertices);
+	m_commands.Write(startVertex);
+	m_commands.Write(numInstances);
+	m_commands.Write(startInstance);
+	m_graphicsList->DrawInstanced(numVertices, startVertex, numInstances, startInstance);
+}
+
+
+void RecordingGraphicsCommandList::ExecuteBundle(gxapi::IGraphicsCommandList* bundle) {
+	m_commands.WriteOp(eCommandStreamOp::EXECUTE_BUNDLE);
+	m_graphicsList->ExecuteBundle(dynamic_cast<gxapi::IGraphicsCommandList*>(CommandStreamRecorder::GetInnerList(bundle)));
+}
+
+
+void RecordingGraphicsCommandList::SetIndexBuffer(void* gpuVirtualAddress, size_t sizeInBytes, gxapi::eFormat format) {
+	m_commands.WriteOp(eCommandStreamOp::SET_INDEX_BUFFER);
+	WriteAddress(gpuVirtualAddress);
+	m_commands.Write((uint64_t)sizeInBytes);
+	m_commands.Write(format);
+	m_graphicsList->SetIndexBuffer(gpuVirtualAddress, sizeInBytes, format);
+}
+
+
+void RecordingGraphicsCommandList::SetPrimitiveTopology(gxapi::ePrimitiveTopology topology) {
+	m_commands.WriteOp(eCommandStreamOp::SET_PRIMITIVE_TOPOLOGY);
+	m_commands.Write(topology);
+	m_graphicsList->SetPrimitiveTopology(topology);
+}
+
+
+void RecordingGraphicsCommandList::SetVertexBuffers(unsigned startSlot,
+													unsigned count,
+													void** gpuVirtualAddress,
+													unsigned* sizeInBytes,
+													unsigned* strideInBytes)
+{
+	m_commands.WriteOp(eCommandStreamOp::SET_VERTEX_BUFFERS);
+	m_commands.Write(startSlot);
+	m_commands.Write(count);
+	for (unsigned i = 0; i < count; ++i) {
+		WriteAddress(gpuVirtualAddress[i]);
+		m_commands.Write(sizeInBytes[i]);
+		m_commands.Write(strideInBytes[i]);
+	}
+	m_graphicsList->SetVertexBuffers(startSlot, count, gpuVirtualAddress, sizeInBytes, strideInBytes);
+}
+
+
+void RecordingGraphicsCommandList::SetRenderTargets(unsigned numRenderTargets,
+													gxapi::DescriptorHandle* renderTargets,
+													gxapi::DescriptorHandle* depthStencil)
+{
+	m_commands.WriteOp(eCommandStreamOp::SET_RENDER_TARGETS);
+	m_commands.Write(numRenderTargets);
+	for (unsigned i = 0; i < numRenderTargets; ++i) {
+		WriteDescriptor(renderTargets[i]);
+	}
+	m_commands.Write(depthStencil != nullptr);
+	if (depthStencil) {
+		WriteDescriptor(*depthStencil);
+	}
+	m_graphicsList->SetRenderTargets(numRenderTargets, renderTargets, depthStencil);
+}
+
+
+void RecordingGraphicsCommandList::SetBlendFactor(float r, float g, float b, float a) {
+	m_commands.WriteOp(eCommandStreamOp::SET_BLEND_FACTOR);
+	m_commands.Write(gxapi::ColorRGBA(r, g, b, a));
+	m_graphicsList->SetBlendFactor(r, g, b, a);
+}
+
+
+void RecordingGraphicsCommandList::SetStencilRef(unsigned stencilRef) {
+	m_commands.WriteOp(eCommandStreamOp::SET_STENCIL_REF);
+	m_commands.Write(stencilRef);
+	m_graphicsList->SetStencilRef(stencilRef);
+}
+
+
+void RecordingGraphicsCommandList::SetScissorRects(unsigned numRects, gxapi::Rectangle* rects) {
+	m_commands.WriteOp(eCommandStreamOp::SET_SCISSOR_RECTS);
+	m_commands.Write(numRects);
+	m_commands.WriteBytes(rects, numRects * sizeof(gxapi::Rectangle));
+	m_graphicsList->SetScissorRects(numRects, rects);
+}
+
+
+void RecordingGraphicsCommandList::SetViewports(unsigned numViewports, gxapi::Viewport* viewports) {
+	m_commands.WriteOp(eCommandStreamOp::SET_VIEWPORTS);
+	m_commands.Write(numViewports);
+	m_commands.WriteBytes(viewports, numViewports * sizeof(gxapi::Viewport));
+	m_graphicsList->SetViewports(numViewports, viewports);
+}
+
+
+void RecordingGraphicsCommandList::SetGraphicsRootConstant(unsigned parameterIndex, unsigned destOffset, uint32_t value) {
+	SetGraphicsRootConstants(parameterIndex, destOffset, 1, &value);
+}
+
+
+void RecordingGraphicsCommandList::SetGraphicsRootConstants(unsigned parameterIndex, unsigned destOffset, unsigned numValues, const uint32_t* value) {
+	m_commands.WriteOp(eCommandStreamOp::SET_GRAPHICS_ROOT_CONSTANTS);
+	m_commands.Write(parameterIndex);
+	m_commands.Write(destOffset);
+	m_commands.Write(numValues);
+	m_commands.WriteBytes(value, numValues * sizeof(uint32_t));
+	m_graphicsList->SetGraphicsRootConstants(parameterIndex, destOffset, numValues, value);
+}
+
+
+void RecordingGraphicsCommandList::SetGraphicsRootConstantBuffer(unsigned parameterIndex, void* gpuVirtualAddress) {
+	m_commands.WriteOp(eCommandStreamOp::SET_GRAPHICS_ROOT_CONSTANT_BUFFER);
+	m_commands.Write(parameterIndex);
+	WriteAddress(gpuVirtualAddress);
+	m_graphicsList->SetGraphicsRootConstantBuffer(parameterIndex, gpuVirtualAddress);
+}
+
+
+void RecordingGraphicsCommandList::SetGraphicsRootDescriptorTable(unsigned parameterIndex, gxapi::DescriptorHandle baseHandle) {
+	m_commands.WriteOp(eCommandStreamOp::SET_GRAPHICS_ROOT_DESCRIPTOR_TABLE);
+	m_commands.Write(parameterIndex);
+	WriteDescriptor(baseHandle);
+	m_graphicsList->SetGraphicsRootDescriptorTable(parameterIndex, baseHandle);
+}
+
+
+void RecordingGraphicsCommandList::SetGraphicsRootShaderResource(unsigned parameterIndex, void* gpuVirtualAddress) {
+	m_commands.WriteOp(eCommandStreamOp::SET_GRAPHICS_ROOT_SHADER_RESOURCE);
+	m_commands.Write(parameterIndex);
+	WriteAddress(gpuVirtualAddress);
+	m_graphicsList->SetGraphicsRootShaderResource(parameterIndex, gpuVirtualAddress);
+}
+
+
+void RecordingGraphicsCommandList::SetGraphicsRootSignature(gxapi::IRootSignature* rootSignature) {
+	m_commands.WriteOp(eCommandStreamOp::SET_GRAPHICS_ROOT_SIGNATURE);
+	WriteObject(rootSignature);
+	m_graphicsList->SetGraphicsRootSignature(rootSignature);
+}
+
+
+//------------------------------------------------------------------------------
+// Command queue
+//------------------------------------------------------------------------------
+
+RecordingCommandQueue::RecordingCommandQueue(CommandStreamRecorder* recorder, gxapi::ICommandQueue* commandQueue)
+	: m_recorder(recorder),
+	m_commandQueue(commandQueue)
+{}
+
+
+void RecordingCommandQueue::ExecuteCommandLists(uint32_t numCommandLists, gxapi::ICommandList* const* commandLists) {
+	m_recorder->RecordExecute(this, numCommandLists, commandLists);
+
+	std::vector<gxapi::ICommandList*> innerLists(numCommandLists);
+	for (uint32_t i = 0; i < numCommandLists; ++i) {
+		innerLists[i] = CommandStreamRecorder::GetInnerList(commandLists[i]);
+	}
+	m_commandQueue->ExecuteCommandLists(numCommandLists, innerLists.data());
+}
+
+
+void RecordingCommandQueue::Signal(gxapi::IFence* fence, uint64_t value) {
+	m_recorder->RecordFenceOp(eCommandStreamOp::SIGNAL, this, fence, value);
+	m_commandQueue->Signal(fence, value);
+}
+
+
+void RecordingCommandQueue::Wait(gxapi::IFence* fence, uint64_t value) {
+	m_recorder->RecordFenceOp(eCommandStreamOp::WAIT, this, fence, value);
+	m_commandQueue->Wait(fence, value);
+}
+
+
+gxapi::CommandQueueDesc RecordingCommandQueue::GetDesc() const {
+	return m_commandQueue->GetDesc();
+}
+
+
+uint64_t RecordingCommandQueue::GetTimestampFrequency() const {
+	return m_commandQueue->GetTimestampFrequency();
+}
+
+
+//------------------------------------------------------------------------------
+// Resource and descriptor heap
+//------------------------------------------------------------------------------
+
+RecordingResource::RecordingResource(CommandStreamRecorder* recorder, gxapi::IResource* resource)
+	: m_recorder(recorder),
+	m_resource(resource)
+{}
+
+
+RecordingResource::~RecordingResource() {
+	m_recorder->ForgetObject(this);
+}
+
+
+gxapi::ResourceDesc RecordingResource::GetDesc() const {
+	return m_resource->GetDesc();
+}
+
+
+void* RecordingResource::Map(unsigned subresourceIndex, const gxapi::MemoryRange* readRange) {
+	return m_resource->Map(subresourceIndex, readRange);
+}
+
+
+void RecordingResource::Unmap(unsigned subresourceIndex, const gxapi::MemoryRange* writtenRange) {
+	m_resource->Unmap(subresourceIndex, writtenRange);
+}
+
+
+void* RecordingResource::GetGPUAddress() const {
+	return m_resource->GetGPUAddress();
+}
+
+
+unsigned RecordingResource::GetNumMipLevels() const {
+	return m_resource->GetNumMipLevels();
+}
+
+
+unsigned RecordingResource::GetNumTexturePlanes() const {
+	return m_resource->GetNumTexturePlanes();
+}
+
+
+unsigned RecordingResource::GetNumArrayLevels() const {
+	return m_resource->GetNumArrayLevels();
+}
+
+
+unsigned RecordingResource::GetNumSubresources() const {
+	return m_resource->GetNumSubresources();
+}
+
+
+unsigned RecordingResource::GetSubresourceIndex(unsigned mipLevel, unsigned arrayIdx, unsigned planeIdx) const {
+	return m_resource->GetSubresourceIndex(mipLevel, arrayIdx, planeIdx);
+}
+
+
+Vec3u64 RecordingResource::GetSize(unsigned mipLevel) const {
+	return m_resource->GetSize(mipLevel);
+}
+
+
+void RecordingResource::SetName(const char* name) {
+	m_resource->SetName(name);
+}
+
+
+RecordingDescriptorHeap::RecordingDescriptorHeap(CommandStreamRecorder* recorder, gxapi::IDescriptorHeap* heap)
+	: m_recorder(recorder),
+	m_heap(heap)
+{}
+
+
+RecordingDescriptorHeap::~RecordingDescriptorHeap() {
+	m_recorder->ForgetObject(this);
+}
+
+
+gxapi::DescriptorHandle RecordingDescriptorHeap::At(size_t index) const {
+	return m_heap->At(index);
+}
+
+
+gxapi::DescriptorHeapDesc RecordingDescriptorHeap::GetDesc() const {
+	return m_heap->GetDesc();
+}
+
+
+uint32_t RecordingDescriptorHeap::GetIncrementSize() const {
+	return m_heap->GetIncrementSize();
+}
+
+
+//------------------------------------------------------------------------------
+// Recorder: capture
+//------------------------------------------------------------------------------
+
+CommandStreamRecorder::CommandStreamRecorder(gxapi::IGraphicsApi* graphicsApi)
+	: m_graphicsApi(graphicsApi)
+{
+	if (graphicsApi == nullptr) {
+		throw InvalidArgumentException("A graphics API to record is required.");
+	}
+}
+
+
+void CommandStreamRecorder::BeginCapture() {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	if (m_capturing) {
+		throw InvalidStateException("A capture is already in progress.");
+	}
+	m_capturing = true;
+	m_submissions.Clear();
+	m_numSubmissions = 0;
+	m_capturedReferences.clear();
+	m_capturedStates.clear();
+}
+
+
+void CommandStreamRecorder::EndCapture(std::ostream& capture) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	if (!m_capturing) {
+		throw InvalidStateException("There is no capture in progress.");
+	}
+	m_capturing = false;
+
+	// Find every object the submissions need, directly or through other objects and descriptors.
+	std::set<uint32_t> referenced;
+	std::vector<uint32_t> pending(m_capturedReferences.begin(), m_capturedReferences.end());
+	while (!pending.empty()) {
+		uint32_t id = pending.back();
+		pending.pop_back();
+		if (id == 0 || !referenced.insert(id).second) {
+			continue;
+		}
+		auto it = m_objects.find(id);
+		if (it == m_objects.end()) {
+			continue; // destroyed and its address reused, replayed as null
+		}
+		pending.insert(pending.end(), it->second.references.begin(), it->second.references.end());
+		for (auto& descriptor : it->second.descriptors) {
+			pending.insert(pending.end(), descriptor.second.references.begin(), descriptor.second.references.end());
+		}
+	}
+
+	CommandStreamWriter objects;
+	CommandStreamWriter descriptors;
+	CommandStreamWriter states;
+	CommandStreamHeader header = {};
+	std::copy(std::begin(CommandStreamMagic), std::end(CommandStreamMagic), header.magic);
+	header.version = CommandStreamVersion;
+	header.pointerSize = sizeof(void*);
+	header.numSubmissions = m_numSubmissions;
+
+	for (auto& object : m_objects) {
+		if (referenced.count(object.first) == 0) {
+			continue;
+		}
+		objects.WriteOp(object.second.op);
+		objects.Write(object.first);
+		objects.WriteBytes(object.second.payload.data(), object.second.payload.size());
+		++header.numObjects;
+
+		for (auto& descriptor : object.second.descriptors) {
+			descriptors.WriteOp(descriptor.second.op);
+			descriptors.Write(CapturedDescriptor{ object.first, descriptor.first });
+			descriptors.WriteBytes(descriptor.second.payload.data(), descriptor.second.payload.size());
+			++header.numDescriptors;
+		}
+	}
+
+	for (auto& state : m_capturedStates) {
+		states.WriteOp(eCommandStreamOp::INITIAL_RESOURCE_STATE);
+		states.Write(state.first);
+		states.Write(state.second);
+		++header.numResourceStates;
+	}
+
+	capture.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	for (const CommandStreamWriter* section : { &objects, &states, &descriptors, &m_submissions }) {
+		capture.write(reinterpret_cast<const char*>(section->GetData().data()), section->GetSize());
+	}
+
+	m_submissions.Clear();
+	m_capturedReferences.clear();
+	m_capturedStates.clear();
+
+	for (auto id : m_retiredObjects) {
+		m_objects.erase(id);
+	}
+	m_retiredObjects.clear();
+}
+
+
+bool CommandStreamRecorder::IsCapturing() const {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	return m_capturing;
+}
+
+
+size_t CommandStreamRecorder::GetNumTrackedObjects() const {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	return m_objects.size();
+}
+
+
+gxapi::ICommandQueue* CommandStreamRecorder::GetInnerQueue(gxapi::ICommandQueue* commandQueue) {
+	auto recordingQueue = dynamic_cast<RecordingCommandQueue*>(commandQueue);
+	return recordingQueue ? recordingQueue->GetInnerQueue() : commandQueue;
+}
+
+
+gxapi::ICommandList* CommandStreamRecorder::GetInnerList(gxapi::ICommandList* commandList) {
+	auto recordingList = dynamic_cast<RecordingCopyCommandList*>(commandList);
+	return recordingList ? recordingList->GetInnerList() : commandList;
+}
+
+
+gxapi::IResource* CommandStreamRecorder::GetInnerResource(gxapi::IResource* resource) {
+	auto recordingResource = dynamic_cast<RecordingResource*>(resource);
+	return recordingResource ? recordingResource->GetInnerResource() : resource;
+}
+
+
+const gxapi::IResource* CommandStreamRecorder::GetInnerResource(const gxapi::IResource* resource) {
+	auto recordingResource = dynamic_cast<const RecordingResource*>(resource);
+	return recordingResource ? recordingResource->GetInnerResource() : resource;
+}
+
+
+gxapi::IDescriptorHeap* CommandStreamRecorder::GetInnerHeap(gxapi::IDescriptorHeap* heap) {
+	auto recordingHeap = dynamic_cast<RecordingDescriptorHeap*>(heap);
+	return recordingHeap ? recordingHeap->GetInnerHeap() : heap;
+}
+
+
+void CommandStreamRecorder::RecordExecute(RecordingCommandQueue* queue, uint32_t numCommandLists, gxapi::ICommandList* const* commandLists) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	if (!m_capturing) {
+		return;
+	}
+
+	// Lists reset before the capture began have not recorded their commands.
+	std::vector<RecordingCopyCommandList*> recordedLists;
+	for (uint32_t i = 0; i < numCommandLists; ++i) {
+		auto list = dynamic_cast<RecordingCopyCommandList*>(commandLists[i]);
+		if (!list) {
+			throw InvalidArgumentException("Command list was not created by the recorder.");
+		}
+		if (list->m_recording) {
+			recordedLists.push_back(list);
+		}
+	}
+	if (recordedLists.empty()) {
+		return;
+	}
+
+	m_submissions.WriteOp(eCommandStreamOp::EXECUTE_COMMAND_LISTS);
+	m_submissions.Write(GetObjectId(queue));
+	m_submissions.Write((uint32_t)recordedLists.size());
+	for (auto list : recordedLists) {
+		m_submissions.Write(list->GetType());
+		m_submissions.Write(list->m_allocator);
+		m_submissions.Write(list->m_initialState);
+		m_submissions.Write((uint64_t)list->m_commands.GetSize());
+		m_submissions.WriteBytes(list->m_commands.GetData().data(), list->m_commands.GetSize());
+
+		for (auto id : list->m_references) {
+			AddReference(id);
+		}
+		for (auto& state : list->m_firstStates) {
+			m_capturedStates.insert(state); // keeps the earliest
+		}
+	}
+	AddReference(GetObjectId(queue));
+	++m_numSubmissions;
+}
+
+
+void CommandStreamRecorder::RecordFenceOp(eCommandStreamOp op, RecordingCommandQueue* queue, gxapi::IFence* fence, uint64_t value) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	if (!m_capturing) {
+		return;
+	}
+
+	uint32_t queueId = GetObjectId(queue);
+	uint32_t fenceId = GetObjectId(fence);
+	m_submissions.WriteOp(op);
+	m_submissions.Write(queueId);
+	m_submissions.Write(fenceId);
+	m_submissions.Write(value);
+	AddReference(queueId);
+	AddReference(fenceId);
+	++m_numSubmissions;
+}
+
+
+void CommandStreamRecorder::AddReference(uint32_t id) {
+	if (id != 0) {
+		m_capturedReferences.insert(id);
+	}
+}
+
+
+//------------------------------------------------------------------------------
+// Recorder: command submission
+//------------------------------------------------------------------------------
+
+gxapi::ICommandQueue* CommandStreamRecorder::CreateCommandQueue(gxapi::CommandQueueDesc desc) {
+	auto queue = std::make_unique<RecordingCommandQueue>(this, m_graphicsApi->CreateCommandQueue(desc));
+
+	CommandStreamWriter payload;
+	payload.Write(desc);
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	RegisterObject(queue.get(), eCommandStreamOp::CREATE_COMMAND_QUEUE, payload);
+	return queue.release();
+}
+
+
+gxapi::ICommandAllocator* CommandStreamRecorder::CreateCommandAllocator(gxapi::eCommandListType type) {
+	gxapi::ICommandAllocator* allocator = m_graphicsApi->CreateCommandAllocator(type);
+
+	CommandStreamWriter payload;
+	payload.Write(type);
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	RegisterObject(allocator, eCommandStreamOp::CREATE_COMMAND_ALLOCATOR, payload);
+	return allocator;
+}
+
+
+gxapi::IGraphicsCommandList* CommandStreamRecorder::CreateGraphicsCommandList(gxapi::CommandListDesc desc) {
+	gxapi::IGraphicsCommandList* list = m_graphicsApi->CreateGraphicsCommandList(desc);
+	return new RecordingGraphicsCommandList(this, list, desc);
+}
+
+
+gxapi::IComputeCommandList* CommandStreamRecorder::CreateComputeCommandList(gxapi::CommandListDesc desc) {
+	gxapi::IComputeCommandList* list = m_graphicsApi->CreateComputeCommandList(desc);
+	return new RecordingComputeCommandList(this, list, desc);
+}
+
+
+gxapi::ICopyCommandList* CommandStreamRecorder::CreateCopyCommandList(gxapi::CommandListDesc desc) {
+	gxapi::ICopyCommandList* list = m_graphicsApi->CreateCopyCommandList(desc);
+	return new RecordingCopyCommandList(this, list, desc);
+}
+
+
+gxapi::ICommandList* CommandStreamRecorder::CreateCommandList(gxapi::eCommandListType type, gxapi::CommandListDesc desc) {
+	switch (type) {
+		case gxapi::eCommandListType::COPY: return CreateCopyCommandList(desc);
+		case gxapi::eCommandListType::COMPUTE: return CreateComputeCommandList(desc);
+		case gxapi::eCommandListType::GRAPHICS: return CreateGraphicsCommandList(desc);
+		default: throw InvalidArgumentException("Command list type cannot be recorded.");
+	}
+}
+
+
+//------------------------------------------------------------------------------
+// Recorder: resources and pipeline
+//------------------------------------------------------------------------------
+
+gxapi::IResource* CommandStreamRecorder::CreateCommittedResource(gxapi::HeapProperties heapProperties,
+																 gxapi::eHeapFlags heapFlags,
+																 gxapi::ResourceDesc desc,
+																 gxapi::eResourceState initialState,
+																 gxapi::ClearValue* clearValue)
+{
+	auto resource = std::make_unique<RecordingResource>(this, m_graphicsApi->CreateCommittedResource(heapProperties, heapFlags, desc, initialState, clearValue));
+
+	CommandStreamWriter payload;
+	payload.Write(heapProperties);
+	payload.Write(heapFlags);
+	payload.Write(desc);
+	payload.Write(initialState);
+	payload.Write(clearValue != nullptr);
+	if (clearValue) {
+		payload.Write(*clearValue);
+	}
+
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	uint32_t id = RegisterObject(resource.get(), eCommandStreamOp::CREATE_COMMITTED_RESOURCE, payload);
+	if (desc.type == gxapi::eResourceType::BUFFER) {
+		uint64_t begin = reinterpret_cast<uint64_t>(resource->GetGPUAddress());
+		InsertRange(m_bufferAddresses, begin, { begin + desc.bufferDesc.sizeInBytes, id, 0 });
+		m_objects[id].bufferAddress = begin;
+	}
+	return resource.release();
+}
+
+
+gxapi::IRootSignature* CommandStreamRecorder::CreateRootSignature(gxapi::RootSignatureDesc desc) {
+	gxapi::IRootSignature* rootSignature = m_graphicsApi->CreateRootSignature(desc);
+
+	CommandStreamWriter payload;
+	payload.Write((uint32_t)desc.rootParameters.size());
+	for (auto& parameter : desc.rootParameters) {
+		payload.Write(parameter.type);
+		payload.Write(parameter.shaderVisibility);
+		switch (parameter.type) {
+			case gxapi::RootParameterDesc::CONSTANT:
+				payload.Write(parameter.As<gxapi::RootParameterDesc::CONSTANT>());
+				break;
+			case gxapi::RootParameterDesc::CBV:
+				payload.Write(parameter.As<gxapi::RootParameterDesc::CBV>());
+				break;
+			case gxapi::RootParameterDesc::SRV:
+				payload.Write(parameter.As<gxapi::RootParameterDesc::SRV>());
+				break;
+			case gxapi::RootParameterDesc::UAV:
+				payload.Write(parameter.As<gxapi::RootParameterDesc::UAV>());
+				break;
+			case gxapi::RootParameterDesc::DESCRIPTOR_TABLE: {
+				auto& ranges = parameter.As<gxapi::RootParameterDesc::DESCRIPTOR_TABLE>().ranges;
+				payload.Write((uint32_t)ranges.size());
+				payload.WriteBytes(ranges.data(), ranges.size() * sizeof(gxapi::DescriptorRange));
+				break;
+			}
+			default:
+				break;
+		}
+	}
+	payload.Write((uint32_t)desc.staticSamplers.size());
+	payload.WriteBytes(desc.staticSamplers.data(), desc.staticSamplers.size() * sizeof(gxapi::StaticSamplerDesc));
+
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	RegisterObject(rootSignature, eCommandStreamOp::CREATE_ROOT_SIGNATURE, payload);
+	return rootSignature;
+}
+
+
+gxapi::IPipelineState* CommandStreamRecorder::CreateGraphicsPipelineState(const gxapi::GraphicsPipelineStateDesc& desc) {
+	gxapi::IPipelineState* pipelineState = m_graphicsApi->CreateGraphicsPipelineState(desc);
+
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	uint32_t rootSignature = GetObjectId(desc.rootSignature);
+
+	CommandStreamWriter payload;
+	payload.Write(rootSignature);
+	for (auto shader : { &desc.vs, &desc.gs, &desc.hs, &desc.ds, &desc.ps }) {
+		WriteShader(payload, *shader);
+	}
+	payload.Write(desc.rasterization);
+	payload.Write(desc.depthStencilState);
+	payload.Write(desc.blending.alphaToCoverage); // the rest of the blend state is a self-reference
+	payload.Write(desc.blending.independentBlending);
+	payload.WriteBytes(desc.blending.multiTarget, sizeof(desc.blending.multiTarget));
+	payload.Write(desc.blendSampleMask);
+	payload.Write(desc.inputLayout.numElements);
+	for (unsigned i = 0; i < desc.inputLayout.numElements; ++i) {
+		const gxapi::InputElementDesc& element = desc.inputLayout.elements[i];
+		payload.WriteString(element.semanticName);
+		payload.Write(element.semanticIndex);
+		payload.Write(element.format);
+		payload.Write(element.inputSlot);
+		payload.Write(element.offset);
+		payload.Write(element.classifiacation);
+		payload.Write(element.instanceDataStepRate);
+	}
+	payload.Write(desc.primitiveTopologyType);
+	payload.Write(desc.triangleStripCutIndex);
+	payload.Write(desc.numRenderTargets);
+	payload.WriteBytes(desc.renderTargetFormats, sizeof(desc.renderTargetFormats));
+	payload.Write(desc.depthStencilFormat);
+	payload.Write(desc.multisampleCount);
+	payload.Write(desc.multisampleQuality);
+	payload.Write(desc.addDebugInfo);
+
+	RegisterObject(pipelineState, eCommandStreamOp::CREATE_GRAPHICS_PIPELINE_STATE, payload, { rootSignature });
+	return pipelineState;
+}
+
+
+gxapi::IPipelineState* CommandStreamRecorder::CreateComputePipelineState(const gxapi::ComputePipelineStateDesc& desc) {
+	gxapi::IPipelineState* pipelineState = m_graphicsApi->CreateComputePipelineState(desc);
+
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	uint32_t rootSignature = GetObjectId(desc.rootSignature);
+
+	CommandStreamWriter payload;
+	payload.Write(rootSignature);
+	WriteShader(payload, desc.cs);
+	payload.Write(desc.addDebugInfo);
+
+	RegisterObject(pipelineState, eCommandStreamOp::CREATE_COMPUTE_PIPELINE_STATE, payload, { rootSignature });
+	return pipelineState;
+}
+
+
+gxapi::IDescriptorHeap* CommandStreamRecorder::CreateDescriptorHeap(gxapi::DescriptorHeapDesc desc) {
+	auto heap = std::make_unique<RecordingDescriptorHeap>(this, m_graphicsApi->CreateDescriptorHeap(desc));
+
+	CommandStreamWriter payload;
+	payload.Write(desc);
+
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	uint32_t id = RegisterObject(heap.get(), eCommandStreamOp::CREATE_DESCRIPTOR_HEAP, payload);
+	if (desc.numDescriptors > 0) {
+		gxapi::DescriptorHandle first = heap->At(0);
+		uint32_t increment = heap->GetIncrementSize();
+		uint64_t size = uint64_t(increment) * desc.numDescriptors;
+		ObjectRecord& record = m_objects[id];
+		record.cpuDescriptorAddress = reinterpret_cast<uint64_t>(first.cpuAddress);
+		InsertRange(m_cpuDescriptorAddresses, record.cpuDescriptorAddress, { record.cpuDescriptorAddress + size, id, increment });
+		if (first.gpuAddress != nullptr) {
+			record.gpuDescriptorAddress = reinterpret_cast<uint64_t>(first.gpuAddress);
+			InsertRange(m_gpuDescriptorAddresses, record.gpuDescriptorAddress, { record.gpuDescriptorAddress + size, id, increment });
+		}
+	}
+	return heap.release();
+}
+
+
+gxapi::IQueryHeap* CommandStreamRecorder::CreateQueryHeap(gxapi::QueryHeapDesc desc) {
+	gxapi::IQueryHeap* heap = m_graphicsApi->CreateQueryHeap(desc);
+
+	CommandStreamWriter payload;
+	payload.Write(desc);
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	RegisterObject(heap, eCommandStreamOp::CREATE_QUERY_HEAP, payload);
+	return heap;
+}
+
+
+//------------------------------------------------------------------------------
+// Recorder: views
+//------------------------------------------------------------------------------
+
+void CommandStreamRecorder::CreateConstantBufferView(gxapi::ConstantBufferViewDesc desc, gxapi::DescriptorHandle destination) {
+	m_graphicsApi->CreateConstantBufferView(desc, destination);
+
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	CapturedAddress address = TranslateAddress(desc.gpuVirtualAddress);
+	CommandStreamWriter payload;
+	payload.Write(address);
+	payload.Write((uint64_t)desc.sizeInBytes);
+	SetDescriptor(destination, { eCommandStreamOp::CONSTANT_BUFFER_VIEW, payload.GetData(), { address.resource } });
+}
+
+
+void CommandStreamRecorder::CreateDepthStencilView(gxapi::DepthStencilViewDesc desc, gxapi::DescriptorHandle destination) {
+	m_graphicsApi->CreateDepthStencilView(desc, destination);
+	RecordView(eCommandStreamOp::DEPTH_STENCIL_VIEW, nullptr, &desc, destination);
+}
+
+void CommandStreamRecorder::CreateDepthStencilView(const gxapi::IResource* resource, gxapi::DescriptorHandle destination) {
+	m_graphicsApi->CreateDepthStencilView(GetInnerResource(resource), destination);
+	RecordView<gxapi::DepthStencilViewDesc>(eCommandStreamOp::DEPTH_STENCIL_VIEW, resource, nullptr, destination);
+}
+
+void CommandStreamRecorder::CreateDepthStencilView(const gxapi::IResource* resource, gxapi::DepthStencilViewDesc desc, gxapi::DescriptorHandle destination) {
+	m_graphicsApi->CreateDepthStencilView(GetInnerResource(resource), desc, destination);
+	RecordView(eCommandStreamOp::DEPTH_STENCIL_VIEW, resource, &desc, destination);
+}
+
+
+void CommandStreamRecorder::CreateRenderTargetView(const gxapi::IResource* resource, gxapi::DescriptorHandle destination) {
+	m_graphicsApi->CreateRenderTargetView(GetInnerResource(resource), destination);
+	RecordView<gxapi::RenderTargetViewDesc>(eCommandStreamOp::RENDER_TARGET_VIEW, resource, nullptr, destination);
+}
+
+void CommandStreamRecorder::CreateRenderTargetView(const gxapi::IResource* resource, gxapi::RenderTargetViewDesc desc, gxapi::DescriptorHandle destination) {
+	m_graphicsApi->CreateRenderTargetView(GetInnerResource(resource), desc, destination);
+	RecordView(eCommandStreamOp::RENDER_TARGET_VIEW, resource, &desc, destination);
+}
+
+
+void CommandStreamRecorder::CreateShaderResourceView(gxapi::ShaderResourceViewDesc desc, gxapi::DescriptorHandle destination) {
+	m_graphicsApi->CreateShaderResourceView(desc, destination);
+	RecordView(eCommandStreamOp::SHADER_RESOURCE_VIEW, nullptr, &desc, destination);
+}
+
+void CommandStreamRecorder::CreateShaderResourceView(const gxapi::IResource* resource, gxapi::DescriptorHandle destination) {
+	m_graphicsApi->CreateShaderResourceView(GetInnerResource(resource), destination);
+	RecordView<gxapi::ShaderResourceViewDesc>(eCommandStreamOp::SHADER_RESOURCE_VIEW, resource, nullptr, destination);
+}
+
+void CommandStreamRecorder::CreateShaderResourceView(const gxapi::IResource* resource, gxapi::ShaderResourceViewDesc desc, gxapi::DescriptorHandle destination) {
+	m_graphicsApi->CreateShaderResourceView(GetInnerResource(resource), desc, destination);
+	RecordView(eCommandStreamOp::SHADER_RESOURCE_VIEW, resource, &desc, destination);
+}
+
+
+void CommandStreamRecorder::CreateUnorderedAccessView(gxapi::UnorderedAccessViewDesc desc, gxapi::DescriptorHandle destination) {
+	m_graphicsApi->CreateUnorderedAccessView(desc, destination);
+	RecordView(eCommandStreamOp::UNORDERED_ACCESS_VIEW, nullptr, &desc, destination);
+}
+
+void CommandStreamRecorder::CreateUnorderedAccessView(const gxapi::IResource* resource, gxapi::DescriptorHandle destination) {
+	m_graphicsApi->CreateUnorderedAccessView(GetInnerResource(resource), destination);
+	RecordView<gxapi::UnorderedAccessViewDesc>(eCommandStreamOp::UNORDERED_ACCESS_VIEW, resource, nullptr, destination);
+}
+
+void CommandStreamRecorder::CreateUnorderedAccessView(const gxapi::IResource* resource, gxapi::UnorderedAccessViewDesc desc, gxapi::DescriptorHandle destination) {
+	m_graphicsApi->CreateUnorderedAccessView(GetInnerResource(resource), desc, destination);
+	RecordView(eCommandStreamOp::UNORDERED_ACCESS_VIEW, resource, &desc, destination);
+}
+
+
+void CommandStreamRecorder::CopyDescriptors(size_t numSrcDescRanges,
+											gxapi::DescriptorHandle* srcRangeStarts,
+											size_t numDstDescRanges,
+											gxapi::DescriptorHandle* dstRangeStarts,
+											uint32_t* rangeCounts,
+											gxapi::eDescriptorHeapType descHeapsType)
+{
+	m_graphicsApi->CopyDescriptors(numSrcDescRanges, srcRangeStarts, numDstDescRanges, dstRangeStarts, rangeCounts, descHeapsType);
+	CopyDescriptorRanges(numSrcDescRanges, srcRangeStarts, nullptr, numDstDescRanges, dstRangeStarts, rangeCounts);
+}
+
+
+void CommandStreamRecorder::CopyDescriptors(size_t numSrcDescRanges,
+											gxapi::DescriptorHandle* srcRangeStarts,
+											uint32_t* srcRangeLengths,
+											size_t numDstDescRanges,
+											gxapi::DescriptorHandle* dstRangeStarts,
+											uint32_t* dstRangeLengths,
+											gxapi::eDescriptorHeapType descHeapsType)
+{
+	m_graphicsApi->CopyDescriptors(numSrcDescRanges, srcRangeStarts, srcRangeLengths, numDstDescRanges, dstRangeStarts, dstRangeLengths, descHeapsType);
+	CopyDescriptorRanges(numSrcDescRanges, srcRangeStarts, srcRangeLengths, numDstDescRanges, dstRangeStarts, dstRangeLengths);
+}
+
+
+void CommandStreamRecorder::CopyDescriptors(gxapi::DescriptorHandle srcStart,
+											gxapi::DescriptorHandle dstStart,
+											size_t rangeCount,
+											gxapi::eDescriptorHeapType descHeapsType)
+{
+	m_graphicsApi->CopyDescriptors(srcStart, dstStart, rangeCount, descHeapsType);
+	uint32_t length = (uint32_t)rangeCount;
+	CopyDescriptorRanges(1, &srcStart, &length, 1, &dstStart, &length);
+}
+
+
+//------------------------------------------------------------------------------
+// Recorder: misc
+//------------------------------------------------------------------------------
+
+gxapi::IFence* CommandStreamRecorder::CreateFence(uint64_t initialValue) {
+	gxapi::IFence* fence = m_graphicsApi->CreateFence(initialValue);
+
+	CommandStreamWriter payload;
+	payload.Write(initialValue);
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	RegisterObject(fence, eCommandStreamOp::CREATE_FENCE, payload);
+	return fence;
+}
+
+
+void CommandStreamRecorder::MakeResident(const std::vector<gxapi::IResource*>& objects) {
+	std::vector<gxapi::IResource*> innerObjects(objects.size());
+	std::transform(objects.begin(), objects.end(), innerObjects.begin(), [](gxapi::IResource* resource) { return GetInnerResource(resource); });
+	m_graphicsApi->MakeResident(innerObjects);
+}
+
+
+void CommandStreamRecorder::Evict(const std::vector<gxapi::IResource*>& objects) {
+	std::vector<gxapi::IResource*> innerObjects(objects.size());
+	std::transform(objects.begin(), objects.end(), innerObjects.begin(), [](gxapi::IResource* resource) { return GetInnerResource(resource); });
+	m_graphicsApi->Evict(innerObjects);
+}
+
+
+void CommandStreamRecorder::ReportLiveObjects() const {
+	m_graphicsApi->ReportLiveObjects();
+}
+
+
+//------------------------------------------------------------------------------
+// Recorder: bookkeeping, all called with the mutex locked
+//------------------------------------------------------------------------------
+
+uint32_t CommandStreamRecorder::RegisterObject(const void* object, eCommandStreamOp op, const CommandStreamWriter& payload, std::vector<uint32_t> references) {
+	uint32_t id = m_nextId++;
+
+	// An object that lived at this address is gone, forget about it.
+	auto it = m_ids.find(object);
+	if (it != m_ids.end()) {
+		RetireObject(it->second);
+		it->second = id;
+	}
+	else {
+		m_ids.insert({ object, id });
+	}
+
+	ObjectRecord& record = m_objects[id];
+	record.op = op;
+	record.payload = payload.GetData();
+	record.references = std::move(references);
+	return id;
+}
+
+
+void CommandStreamRecorder::ForgetObject(const void* object) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	auto it = m_ids.find(object);
+	if (it == m_ids.end()) {
+		return;
+	}
+	uint32_t id = it->second;
+	m_ids.erase(it);
+
+	auto record = m_objects.find(id);
+	if (record != m_objects.end()) {
+		EraseRange(m_bufferAddresses, record->second.bufferAddress, id);
+		EraseRange(m_cpuDescriptorAddresses, record->second.cpuDescriptorAddress, id);
+		EraseRange(m_gpuDescriptorAddresses, record->second.gpuDescriptorAddress, id);
+	}
+	RetireObject(id);
+}
+
+
+void CommandStreamRecorder::RetireObject(uint32_t id) {
+	// Submissions of the capture may still refer to the object, it's written if they do.
+	if (m_capturing) {
+		m_retiredObjects.push_back(id);
+	}
+	else {
+		m_objects.erase(id);
+	}
+}
+
+
+uint32_t CommandStreamRecorder::GetResourceId(const gxapi::IResource* resource) {
+	if (resource == nullptr) {
+		return 0;
+	}
+	uint32_t id = GetObjectId(resource);
+	if (id != 0) {
+		return id;
+	}
+
+	// Not created through the recorder, like swap chain buffers.
+	gxapi::ResourceDesc desc = resource->GetDesc();
+	CommandStreamWriter payload;
+	payload.Write(desc);
+	id = RegisterObject(resource, eCommandStreamOp::CREATE_EXTERNAL_RESOURCE, payload);
+	if (desc.type == gxapi::eResourceType::BUFFER) {
+		uint64_t begin = reinterpret_cast<uint64_t>(resource->GetGPUAddress());
+		InsertRange(m_bufferAddresses, begin, { begin + desc.bufferDesc.sizeInBytes, id, 0 });
+		m_objects[id].bufferAddress = begin;
+	}
+	return id;
+}
+
+
+CapturedAddress CommandStreamRecorder::TranslateAddress(const void* gpuVirtualAddress) const {
+	auto range = FindRange(m_bufferAddresses, reinterpret_cast<uint64_t>(gpuVirtualAddress));
+	if (!range) {
+		return { 0, 0 }; // null, or a buffer the recorder does not know about
+	}
+	return { range->second.object, reinterpret_cast<uint64_t>(gpuVirtualAddress) - range->first };
+}
+
+
+uint32_t CommandStreamRecorder::GetObjectId(const void* object) const {
+	if (object == nullptr) {
+		return 0;
+	}
+	auto it = m_ids.find(object);
+	return it != m_ids.end() ? it->second : 0;
+}
+
+
+CapturedDescriptor CommandStreamRecorder::TranslateDescriptor(const gxapi::DescriptorHandle& handle) const {
+	uint64_t address = reinterpret_cast<uint64_t>(handle.cpuAddress);
+	auto range = FindRange(m_cpuDescriptorAddresses, address);
+	if (!range) {
+		address = reinterpret_cast<uint64_t>(handle.gpuAddress);
+		range = FindRange(m_gpuDescriptorAddresses, address);
+	}
+	if (!range) {
+		return { 0, 0 };
+	}
+	return { range->second.object, uint32_t((address - range->first) / range->second.stride) };
+}
+
+
+void CommandStreamRecorder::InsertRange(std::map<uint64_t, AddressRange>& ranges, uint64_t begin, AddressRange range) {
+	if (begin == 0 || range.end <= begin) {
+		return;
+	}
+
+	// Ranges of released objects may overlap the new one.
+	auto first = ranges.lower_bound(begin);
+	if (first != ranges.begin() && std::prev(first)->second.end > begin) {
+		--first;
+	}
+	auto last = ranges.lower_bound(range.end);
+	ranges.erase(first, last);
+	ranges.insert({ begin, range });
+}
+
+
+void CommandStreamRecorder::EraseRange(std::map<uint64_t, AddressRange>& ranges, uint64_t begin, uint32_t object) {
+	// The range may have been taken over by a newer object already.
+	auto it = ranges.find(begin);
+	if (it != ranges.end() && it->second.object == object) {
+		ranges.erase(it);
+	}
+}
+
+
+const std::pair<const uint64_t, CommandStreamRecorder::AddressRange>* CommandStreamRecorder::FindRange(const std::map<uint64_t, AddressRange>& ranges, uint64_t address) {
+	if (address == 0) {
+		return nullptr;
+	}
+	auto it = ranges.upper_bound(address);
+	if (it == ranges.begin()) {
+		return nullptr;
+	}
+	--it;
+	return address < it->second.end ? &*it : nullptr;
+}
+
+
+template <class Desc>
+void CommandStreamRecorder::RecordView(eCommandStreamOp op, const gxapi::IResource* resource, const Desc* desc, gxapi::DescriptorHandle destination) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	uint32_t resourceId = GetResourceId(resource);
+
+	CommandStreamWriter payload;
+	payload.Write(resourceId);
+	payload.Write(desc != nullptr);
+	if (desc) {
+		payload.Write(*desc);
+	}
+	SetDescriptor(destination, { op, payload.GetData(), { resourceId } });
+}
+
+
+void CommandStreamRecorder::SetDescriptor(const gxapi::DescriptorHandle& destination, DescriptorRecord record) {
+	CapturedDescriptor descriptor = TranslateDescriptor(destination);
+	auto heap = m_objects.find(descriptor.heap);
+	if (heap != m_objects.end()) {
+		heap->second.descriptors[descriptor.index] = std::move(record);
+	}
+}
+
+
+void CommandStreamRecorder::CopyDescriptorRanges(size_t numSrcDescRanges,
+												 const gxapi::DescriptorHandle* srcRangeStarts,
+												 const uint32_t* srcRangeLengths,
+												 size_t numDstDescRanges,
+												 const gxapi::DescriptorHandle* dstRangeStarts,
+												 const uint32_t* dstRangeLengths)
+{
+	// Ranges without lengths are one descriptor long, the copy goes descriptor by descriptor across ranges.
+	auto expand = [this](size_t numRanges, const gxapi::DescriptorHandle* starts, const uint32_t* lengths) {
+		std::vector<CapturedDescriptor> descriptors;
+		for (size_t i = 0; i < numRanges; ++i) {
+			CapturedDescriptor start = TranslateDescriptor(starts[i]);
+			uint32_t length = lengths ? lengths[i] : 1;
+			for (uint32_t j = 0; j < length; ++j) {
+				descriptors.push_back({ start.heap, start.index + j });
+			}
+		}
+		return descriptors;
+	};
+
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	std::vector<CapturedDescriptor> sources = expand(numSrcDescRanges, srcRangeStarts, srcRangeLengths);
+	std::vector<CapturedDescriptor> destinations = expand(numDstDescRanges, dstRangeStarts, dstRangeLengths);
+
+	for (size_t i = 0; i < std::min(sources.size(), destinations.size()); ++i) {
+		auto dstHeap = m_objects.find(destinations[i].heap);
+		if (dstHeap == m_objects.end()) {
+			continue;
+		}
+		auto srcHeap = m_objects.find(sources[i].heap);
+		const DescriptorRecord* source = nullptr;
+		if (srcHeap != m_objects.end()) {
+			auto it = srcHeap->second.descriptors.find(sources[i].index);
+			source = it != srcHeap->second.descriptors.end() ? &it->second : nullptr;
+		}
+
+		if (source) {
+			dstHeap->second.descriptors[destinations[i].index] = *source;
+		}
+		else {
+			dstHeap->second.descriptors.erase(destinations[i].index);
+		}
+	}
+}
+
+
+} // namespace gxeng
+} // namespace inl
@@ -0,0 +1,432 @@
+#pragma once
+
+#include "CommandStreamFormat.hpp"
+
+#include <GraphicsApi_LL/IGraphicsApi.hpp>
+#include <GraphicsApi_LL/ICommandList.hpp>
+#include <GraphicsApi_LL/ICommandQueue.hpp>
+#include <GraphicsApi_LL/IDescriptorHeap.hpp>
+#include <GraphicsApi_LL/IResource.hpp>
+
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <mutex>
+#include <ostream>
+#include <memory>
+#include <vector>
+
+
+namespace inl {
+namespace gxeng {
+
+
+class CommandStreamRecorder;
+
+
+#pragma warning(disable: 4250) // members of the recording lists are inherited via dominance, that's intended
+
+class RecordingCopyCommandList : virtual public gxapi::ICopyCommandList {
+public:
+	RecordingCopyCommandList(CommandStreamRecorder* recorder, gxapi::ICopyCommandList* commandList, gxapi::CommandListDesc desc);
+
+	gxapi::ICommandList* GetInnerList() const { return m_commandList.get(); }
+
+	gxapi::eCommandListType GetType() const override;
+
+	void Close() override;
+	void Reset(gxapi::ICommandAllocator* allocator, gxapi::IPipelineState* newState = nullptr) override;
+
+	void CopyBuffer(gxapi::IResource* dst, size_t dstOffset, gxapi::IResource* src, size_t srcOffset, size_t numBytes) override;
+	void CopyResource(gxapi::IResource* dst, gxapi::IResource* src) override;
+	void CopyTexture(gxapi::IResource* dst,
+					 unsigned dstSubresourceIndex,
+					 int dstX, int dstY, int dstZ,
+					 gxapi::IResource* src,
+					 unsigned srcSubresourceIndex,
+					 gxapi::Cube srcRegion) override;
+	void CopyTexture(gxapi::IResource* dst,
+					 gxapi::TextureCopyDesc dstDesc,
+					 int dstX, int dstY, int dstZ,
+					 gxapi::IResource* src,
+					 gxapi::TextureCopyDesc srcDesc,
+					 gxapi::Cube srcRegion) override;
+	void CopyTexture(gxapi::IResource* dst,
+					 gxapi::TextureCopyDesc dstDesc,
+					 int dstX, int dstY, int dstZ,
+					 gxapi::IResource* src,
+					 gxapi::TextureCopyDesc srcDesc) override;
+
+	void ResourceBarrier(unsigned numBarriers, gxapi::ResourceBarrier* barriers) override;
+	using gxapi::ICopyCommandList::ResourceBarrier;
+
+	void EndQuery(gxapi::IQueryHeap* heap, unsigned index) override;
+	void ResolveQueryData(gxapi::IQueryHeap* heap, unsigned firstIndex, unsigned numQueries, gxapi::IResource* destination, size_t destinationOffset) override;
+protected:
+	friend class CommandStreamRecorder;
+
+	void WriteObject(const void* object);
+	void WriteResource(const gxapi::IResource* resource);
+	void WriteAddress(const void* gpuVirtualAddress);
+	void WriteDescriptor(const gxapi::DescriptorHandle& handle);
+	void Restart(gxapi::ICommandAllocator* allocator, gxapi::IPipelineState* initialState);
+protected:
+	CommandStreamRecorder* m_recorder;
+	std::unique_ptr<gxapi::ICommandList> m_commandList;
+	gxapi::ICopyCommandList* m_copyList;
+
+	// Commands since the last reset, only written if a capture was in progress when the list was reset
+	bool m_recording = false;
+	CommandStreamWriter m_commands;
+	std::vector<uint32_t> m_references;
+	std::vector<std::pair<uint32_t, gxapi::eResourceState>> m_firstStates; // state before the first transition of each resource
+	uint32_t m_allocator = 0;
+	uint32_t m_initialState = 0;
+};
+
+
+class RecordingComputeCommandList : public RecordingCopyCommandList, virtual public gxapi::IComputeCommandList {
+public:
+	RecordingComputeCommandList(CommandStreamRecorder* recorder, gxapi::IComputeCommandList* commandList, gxapi::CommandListDesc desc);
+
+	void Dispatch(size_t dimx, size_t dimy, size_t dimz) override;
+
+	void SetComputeRootConstant(unsigned parameterIndex, unsigned destOffset, uint32_t value) override;
+	void SetComputeRootConstants(unsigned parameterIndex, unsigned destOffset, unsigned numValues, const uint32_t* value) override;
+	void SetComputeRootConstantBuffer(unsigned parameterIndex, void* gpuVirtualAddress) override;
+	void SetComputeRootDescriptorTable(unsigned parameterIndex, gxapi::DescriptorHandle baseHandle) override;
+	void SetComputeRootShaderResource(unsigned parameterIndex, void* gpuVirtualAddress) override;
+	void SetComputeRootUnorderedResource(unsigned parameterIndex, void* gpuVirtualAddress) override;
+	void SetComputeRootSignature(gxapi::IRootSignature* rootSignature) override;
+
+	void SetPipelineState(gxapi::IPipelineState* pipelineState) override;
+	void ResetState(gxapi::IPipelineState* initialPipelineState) override;
+
+	void SetDescriptorHeaps(gxapi::IDescriptorHeap* const* heaps, uint32_t count) override;
+private:
+	gxapi::IComputeCommandList* m_computeList;
+};
+
+
+class RecordingGraphicsCommandList : public RecordingComputeCommandList, virtual public gxapi::IGraphicsCommandList {
+public:
+	RecordingGraphicsCommandList(CommandStreamRecorder* recorder, gxapi::IGraphicsCommandList* commandList, gxapi::CommandListDesc desc);
+
+	void ClearDepthStencil(gxapi::DescriptorHandle dsv,
+						   float depth,
+						   uint8_t stencil,
+						   size_t numRects,
+						   gxapi::Rectangle* rects,
+						   bool clearDepth,
+						   bool clearStencil) override;
+	void ClearRenderTarget(gxapi::DescriptorHandle rtv,
+						   gxapi::ColorRGBA color,
+						   size_t numRects,
+						   gxapi::Rectangle* rects) override;
+
+	void DrawIndexedInstanced(unsigned numIndices, unsigned startIndex, int vertexOffset, unsigned numInstances, unsigned startInstance) override;
+	void DrawInstanced(unsigned numVertices, unsigned startVertex, unsigned numInstances, unsigned startInstance) override;
+	void ExecuteBundle(gxapi::IGraphicsCommandList* bundle) override;
+
+	void SetIndexBuffer(void* gpuVirtualAddress, size_t sizeInBytes, gxapi::eFormat format) override;
+	void SetPrimitiveTopology(gxapi::ePrimitiveTopology topology) override;
+	void SetVertexBuffers(unsigned startSlot,
+						  unsigned count,
+						  void** gpuVirtualAddress,
+						  unsigned* sizeInBytes,
+						  unsigned* strideInBytes) override;
+
+	void SetRenderTargets(unsigned numRenderTargets,
+						  gxapi::DescriptorHandle* renderTargets,
+						  gxapi::DescriptorHandle* depthStencil) override;
+	void SetBlendFactor(float r, float g, float b, float a) override;
+	void SetStencilRef(unsigned stencilRef) override;
+
+	void SetScissorRects(unsigned numRects, gxapi::Rectangle* rects) override;
+	void SetViewports(unsigned numViewports, gxapi::Viewport* viewports) override;
+
+	void SetGraphicsRootConstant(unsigned parameterIndex, unsigned destOffset, uint32_t value) override;
+	void SetGraphicsRootConstants(unsigned parameterIndex, unsigned destOffset, unsigned numValues, const uint32_t* value) override;
+	void SetGraphicsRootConstantBuffer(unsigned parameterIndex, void* gpuVirtualAddress) override;
+	void SetGraphicsRootDescriptorTable(unsigned parameterIndex, gxapi::DescriptorHandle baseHandle) override;
+	void SetGraphicsRootShaderResource(unsigned parameterIndex, void* gpuVirtualAddress) override;
+	void SetGraphicsRootSignature(gxapi::IRootSignature* rootSignature) override;
+private:
+	gxapi::IGraphicsCommandList* m_graphicsList;
+};
+
+#pragma warning(default: 4250)
+
+
+class RecordingResource : public gxapi::IResource {
+public:
+	RecordingResource(CommandStreamRecorder* recorder, gxapi::IResource* resource);
+	~RecordingResource();
+
+	gxapi::IResource* GetInnerResource() const { return m_resource.get(); }
+
+	gxapi::ResourceDesc GetDesc() const override;
+	void* Map(unsigned subresourceIndex, const gxapi::MemoryRange* readRange = nullptr) override;
+	void Unmap(unsigned subresourceIndex, const gxapi::MemoryRange* writtenRange = nullptr) override;
+	void* GetGPUAddress() const override;
+
+	unsigned GetNumMipLevels() const override;
+	unsigned GetNumTexturePlanes() const override;
+	unsigned GetNumArrayLevels() const override;
+	unsigned GetNumSubresources() const override;
+	unsigned GetSubresourceIndex(unsigned mipLevel, unsigned arrayIdx, unsigned planeIdx) const override;
+	Vec3u64 GetSize(unsigned mipLevel = 0) const override;
+
+	void SetName(const char* name) override;
+private:
+	CommandStreamRecorder* m_recorder;
+	std::unique_ptr<gxapi::IResource> m_resource;
+};
+
+
+class RecordingDescriptorHeap : public gxapi::IDescriptorHeap {
+public:
+	RecordingDescriptorHeap(CommandStreamRecorder* recorder, gxapi::IDescriptorHeap* heap);
+	~RecordingDescriptorHeap();
+
+	gxapi::IDescriptorHeap* GetInnerHeap() const { return m_heap.get(); }
+
+	gxapi::DescriptorHandle At(size_t index) const override;
+	gxapi::DescriptorHeapDesc GetDesc() const override;
+	uint32_t GetIncrementSize() const override;
+private:
+	CommandStreamRecorder* m_recorder;
+	std::unique_ptr<gxapi::IDescriptorHeap> m_heap;
+};
+
+
+class RecordingCommandQueue : public gxapi::ICommandQueue {
+public:
+	RecordingCommandQueue(CommandStreamRecorder* recorder, gxapi::ICommandQueue* commandQueue);
+
+	gxapi::ICommandQueue* GetInnerQueue() const { return m_commandQueue.get(); }
+
+	void ExecuteCommandLists(uint32_t numCommandLists, gxapi::ICommandList* const* commandLists) override;
+	void Signal(gxapi::IFence* fence, uint64_t value) override;
+	void Wait(gxapi::IFence* fence, uint64_t value) override;
+	gxapi::CommandQueueDesc GetDesc() const override;
+	uint64_t GetTimestampFrequency() const override;
+private:
+	CommandStreamRecorder* m_recorder;
+	std::unique_ptr<gxapi::ICommandQueue> m_commandQueue;
+};
+
+
+/// <summary>
+/// Wraps a graphics API, and records what is done with it, so that frames can be saved and replayed by the
+/// <see cref="CommandStreamPlayer"/> without the engine and the scene.
+/// <para />
+/// Pass the recorder to the engine instead of the real graphics API. Command lists, queues, resources and
+/// descriptor heaps are wrapped, other objects are returned as they are and identified by their address.
+/// The contents of command lists are only recorded if the list is reset between <see cref="BeginCapture"/>
+/// and <see cref="EndCapture"/>, outside captures the lists just forward the calls. The file contains the
+/// objects and descriptors referenced by the captured submissions, and nothing else.
+/// <para />
+/// Destroyed resources and descriptor heaps are forgotten, objects that are not wrapped are forgotten when
+/// another object is created at their address.
+/// </summary>
+/// <remarks>
+/// Data written by the CPU into mapped resources is not captured: the replayed frame issues the same commands,
+/// but may draw different pixels. GPU waits on fences that are signaled by the CPU are skipped during replay.
+/// Queues created by the recorder must be unwrapped with <see cref="GetInnerQueue"/> before giving them to the
+/// swap chain. Lists executed during a capture that were reset before it are left out of the capture.
+/// The recorder is thread safe as much as the wrapped API is.
+/// </remarks>
+class CommandStreamRecorder : public gxapi::IGraphicsApi {
+	friend class RecordingCopyCommandList;
+	friend class RecordingCommandQueue;
+	friend class RecordingResource;
+	friend class RecordingDescriptorHeap;
+public:
+	/// <param name="graphicsApi"> The API that does the actual work, not owned. </param>
+	explicit CommandStreamRecorder(gxapi::IGraphicsApi* graphicsApi);
+	CommandStreamRecorder(const CommandStreamRecorder&) = delete;
+	CommandStreamRecorder& operator=(const CommandStreamRecorder&) = delete;
+
+	/// <summary> Starts collecting submissions. </summary>
+	void BeginCapture();
+
+	/// <summary> Writes the submissions since <see cref="BeginCapture"/> and the objects they use to the stream. </summary>
+	void EndCapture(std::ostream& capture);
+
+	bool IsCapturing() const;
+
+	/// <summary> The number of objects the recorder keeps records of, for diagnostics. </summary>
+	size_t GetNumTrackedObjects() const;
+
+	gxapi::IGraphicsApi* GetInnerApi() const { return m_graphicsApi; }
+
+	/// <summary> Returns the queue of the wrapped API, or the queue itself if it's not created by a recorder. </summary>
+	static gxapi::ICommandQueue* GetInnerQueue(gxapi::ICommandQueue* commandQueue);
+
+	/// <summary> Returns the list of the wrapped API, or the list itself if it's not created by a recorder. </summary>
+	static gxapi::ICommandList* GetInnerList(gxapi::ICommandList* commandList);
+
+	/// <summary> Returns the resource of the wrapped API, or the resource itself if it's not created by a recorder. </summary>
+	static gxapi::IResource* GetInnerResource(gxapi::IResource* resource);
+	static const gxapi::IResource* GetInnerResource(const gxapi::IResource* resource);
+
+	/// <summary> Returns the heap of the wrapped API, or the heap itself if it's not created by a recorder. </summary>
+	static gxapi::IDescriptorHeap* GetInnerHeap(gxapi::IDescriptorHeap* heap);
+
+
+	// Command submission
+	gxapi::ICommandQueue* CreateCommandQueue(gxapi::CommandQueueDesc desc) override;
+	gxapi::ICommandAllocator* CreateCommandAllocator(gxapi::eCommandListType type) override;
+	gxapi::IGraphicsCommandList* CreateGraphicsCommandList(gxapi::CommandListDesc desc) override;
+	gxapi::IComputeCommandList* CreateComputeCommandList(gxapi::CommandListDesc desc) override;
+	gxapi::ICopyCommandList* CreateCopyCommandList(gxapi::CommandListDesc desc) override;
+	gxapi::ICommandList* CreateCommandList(gxapi::eCommandListType type, gxapi::CommandListDesc desc) override;
+
+	// Resources
+	gxapi::IResource* CreateCommittedResource(gxapi::HeapProperties heapProperties,
+											  gxapi::eHeapFlags heapFlags,
+											  gxapi::ResourceDesc desc,
+											  gxapi::eResourceState initialState,
+											  gxapi::ClearValue* clearValue = nullptr) override;
+
+	// Pipeline and binding
+	gxapi::IRootSignature* CreateRootSignature(gxapi::RootSignatureDesc desc) override;
+	gxapi::IPipelineState* CreateGraphicsPipelineState(const gxapi::GraphicsPipelineStateDesc& desc) override;
+	gxapi::IPipelineState* CreateComputePipelineState(const gxapi::ComputePipelineStateDesc& desc) override;
+	gxapi::IDescriptorHeap* CreateDescriptorHeap(gxapi::DescriptorHeapDesc desc) override;
+	gxapi::IQueryHeap* CreateQueryHeap(gxapi::QueryHeapDesc desc) override;
+
+	// Views
+	void CreateConstantBufferView(gxapi::ConstantBufferViewDesc desc,
+								  gxapi::DescriptorHandle destination) override;
+
+	void CreateDepthStencilView(gxapi::DepthStencilViewDesc desc,
+								gxapi::DescriptorHandle destination) override;
+	void CreateDepthStencilView(const gxapi::IResource* resource,
+								gxapi::DescriptorHandle destination) override;
+	void CreateDepthStencilView(const gxapi::IResource* resource,
+								gxapi::DepthStencilViewDesc desc,
+								gxapi::DescriptorHandle destination) override;
+
+	void CreateRenderTargetView(const gxapi::IResource* resource,
+								gxapi::DescriptorHandle destination) override;
+	void CreateRenderTargetView(const gxapi::IResource* resource,
+								gxapi::RenderTargetViewDesc desc,
+								gxapi::DescriptorHandle destination) override;
+
+	void CreateShaderResourceView(gxapi::ShaderResourceViewDesc desc,
+								  gxapi::DescriptorHandle destination) override;
+	void CreateShaderResourceView(const gxapi::IResource* resource,
+								  gxapi::DescriptorHandle destination) override;
+	void CreateShaderResourceView(const gxapi::IResource* resource,
+								  gxapi::ShaderResourceViewDesc desc,
+								  gxapi::DescriptorHandle destination) override;
+
+	void CreateUnorderedAccessView(gxapi::UnorderedAccessViewDesc desc,
+								   gxapi::DescriptorHandle destination) override;
+	void CreateUnorderedAccessView(const gxapi::IResource* resource,
+								   gxapi::DescriptorHandle destination) override;
+	void CreateUnorderedAccessView(const gxapi::IResource* resource,
+								   gxapi::UnorderedAccessViewDesc desc,
+								   gxapi::DescriptorHandle destination) override;
+
+	void CopyDescriptors(size_t numSrcDescRanges,
+						 gxapi::DescriptorHandle* srcRangeStarts,
+						 size_t numDstDescRanges,
+						 gxapi::DescriptorHandle* dstRangeStarts,
+						 uint32_t* rangeCounts,
+						 gxapi::eDescriptorHeapType descHeapsType) override;
+	void CopyDescriptors(size_t numSrcDescRanges,
+						 gxapi::DescriptorHandle* srcRangeStarts,
+						 uint32_t* srcRangeLengths,
+						 size_t numDstDescRanges,
+						 gxapi::DescriptorHandle* dstRangeStarts,
+						 uint32_t* dstRangeLengths,
+						 gxapi::eDescriptorHeapType descHeapsType) override;
+	void CopyDescriptors(gxapi::DescriptorHandle srcStart,
+						 gxapi::DescriptorHandle dstStart,
+						 size_t rangeCount,
+						 gxapi::eDescriptorHeapType descHeapsType) override;
+
+	// Misc
+	gxapi::IFence* CreateFence(uint64_t initialValue) override;
+
+	void MakeResident(const std::vector<gxapi::IResource*>& objects) override;
+	void Evict(const std::vector<gxapi::IResource*>& objects) override;
+
+	// Debug
+	void ReportLiveObjects() const override;
+private:
+	struct DescriptorRecord {
+		eCommandStreamOp op;
+		std::vector<uint8_t> payload;
+		std::vector<uint32_t> references;
+	};
+
+	struct ObjectRecord {
+		eCommandStreamOp op;
+		std::vector<uint8_t> payload;
+		std::vector<uint32_t> references;
+		std::map<uint32_t, DescriptorRecord> descriptors; // for descriptor heaps, by index
+		uint64_t bufferAddress = 0; // beginning of the address ranges the object occupies, if any
+		uint64_t cpuDescriptorAddress = 0;
+		uint64_t gpuDescriptorAddress = 0;
+	};
+
+	struct AddressRange {
+		uint64_t end;
+		uint32_t object;
+		uint32_t stride; // descriptor increment size for heaps
+	};
+private:
+	uint32_t RegisterObject(const void* object, eCommandStreamOp op, const CommandStreamWriter& payload, std::vector<uint32_t> references = {});
+	/// <summary> Called by the wrappers when the object is destroyed. </summary>
+	void ForgetObject(const void* object);
+	/// <summary> Drops the record, or keeps it until the capture ends if one is in progress. </summary>
+	void RetireObject(uint32_t id);
+	uint32_t GetObjectId(const void* object) const;
+	/// <summary> Registers resources the recorder has not seen as external. </summary>
+	uint32_t GetResourceId(const gxapi::IResource* resource);
+	CapturedAddress TranslateAddress(const void* gpuVirtualAddress) const;
+	CapturedDescriptor TranslateDescriptor(const gxapi::DescriptorHandle& handle) const;
+	static void InsertRange(std::map<uint64_t, AddressRange>& ranges, uint64_t begin, AddressRange range);
+	static const std::pair<const uint64_t, AddressRange>* FindRange(const std::map<uint64_t, AddressRange>& ranges, uint64_t address);
+	static void EraseRange(std::map<uint64_t, AddressRange>& ranges, uint64_t begin, uint32_t object);
+
+	template <class Desc>
+	void RecordView(eCommandStreamOp op, const gxapi::IResource* resource, const Desc* desc, gxapi::DescriptorHandle destination);
+	void SetDescriptor(const gxapi::DescriptorHandle& destination, DescriptorRecord record);
+	void CopyDescriptorRanges(size_t numSrcDescRanges,
+							  const gxapi::DescriptorHandle* srcRangeStarts,
+							  const uint32_t* srcRangeLengths,
+							  size_t numDstDescRanges,
+							  const gxapi::DescriptorHandle* dstRangeStarts,
+							  const uint32_t* dstRangeLengths);
+
+	void RecordExecute(RecordingCommandQueue* queue, uint32_t numCommandLists, gxapi::ICommandList* const* commandLists);
+	void RecordFenceOp(eCommandStreamOp op, RecordingCommandQueue* queue, gxapi::IFence* fence, uint64_t value);
+	void AddReference(uint32_t id);
+private:
+	gxapi::IGraphicsApi* m_graphicsApi;
+
+	mutable std::mutex m_mutex;
+	uint32_t m_nextId = 1;
+	std::unordered_map<const void*, uint32_t> m_ids;
+	std::map<uint32_t, ObjectRecord> m_objects; // ordered by id, i.e. creation order
+	std::map<uint64_t, AddressRange> m_bufferAddresses;
+	std::map<uint64_t, AddressRange> m_cpuDescriptorAddresses;
+	std::map<uint64_t, AddressRange> m_gpuDescriptorAddresses;
+
+	// Current capture
+	bool m_capturing = false;
+	CommandStreamWriter m_submissions;
+	uint32_t m_numSubmissions = 0;
+	std::set<uint32_t> m_capturedReferences;
+	std::map<uint32_t, gxapi::eResourceState> m_capturedStates;
+	std::vector<uint32_t> m_retiredObjects; // destroyed during the capture, their records are still needed
+};
+
+
+} // namespace gxeng
+} // namespace inl
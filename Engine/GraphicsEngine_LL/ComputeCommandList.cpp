@@ -143,9 +143,9 @@ void ComputeCommandList::BindCompute(BindParameter parameter, const TextureView3
 }
 
 void ComputeCommandList::BindCompute(BindParameter parameter, const ConstBufferView& shaderConstant) {
-	if (dynamic_cast<const PersistentConstBuffer*>(&shaderConstant.GetResource())) {
-		m_additionalResources.push_back(shaderConstant.GetResource());
-	}
+	// Views store the buffer as a plain ConstBuffer, so persistent and volatile buffers can't be told apart here.
+	// Keep it alive either way until the GPU is done with the command list.
+	m_additionalResources.push_back(shaderConstant.GetResource());
 
 	try {
 		m_computeBindingManager.Bind(parameter, shaderConstant);
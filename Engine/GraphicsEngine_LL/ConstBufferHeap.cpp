@@ -1,5 +1,6 @@
 #include "ConstBufferHeap.hpp"
 
+#include <algorithm>
 #include <cassert>
 
 namespace inl {
@@ -114,6 +115,35 @@ PersistentConstBuffer ConstantBufferHeap::CreatePersistentBuffer(const void* dat
 }
 
 
+void ConstantBufferHeap::UpdatePersistentBuffer(const PersistentConstBuffer& buffer, const void* data, uint32_t dataSize) {
+	assert(dataSize <= buffer.GetSize());
+	auto resource = buffer._GetResourcePtr();
+
+	gxapi::MemoryRange noReadRange{0, 0};
+	void* dst = resource->Map(0, &noReadRange);
+	memcpy(dst, data, dataSize);
+	resource->Unmap(0, nullptr);
+}
+
+
+void ConstantBufferHeap::BeginFrame(uint64_t frameId) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_currFrameID = frameId + 1;
+}
+
+
+uint64_t ConstantBufferHeap::GetCurrentFrameID() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_currFrameID;
+}
+
+
+bool ConstantBufferHeap::IsFrameComplete(uint64_t frameId) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return frameId <= m_lastFinishedFrameID;
+}
+
+
 void ConstantBufferHeap::OnFrameBeginDevice(uint64_t frameId)
 {}
 
@@ -125,7 +155,8 @@ void ConstantBufferHeap::OnFrameBeginHost(uint64_t frameId)
 void ConstantBufferHeap::OnFrameCompleteDevice(uint64_t frameId) {
 	std::lock_guard<std::mutex> lock(m_mutex);
 
-	m_lastFinishedFrameID++;
+	// Device frames complete in order, the ID of the event is enough to tell which one has finished.
+	m_lastFinishedFrameID = std::max(m_lastFinishedFrameID, frameId + 1);
 
 	bool foundVictim = true;
 	while (m_largePages.Count() > MAX_PERMANENT_LARGE_PAGE_COUNT && foundVictim) {
@@ -145,7 +176,7 @@ void ConstantBufferHeap::OnFrameCompleteDevice(uint64_t frameId) {
 
 
 void ConstantBufferHeap::OnFrameCompleteHost(uint64_t frameId) {
-	m_currFrameID++;
+	// Frames are started by BeginFrame on the render thread, events are dispatched asynchronously.
 }
 
 
@@ -47,6 +47,17 @@ public:
 
 	VolatileConstBuffer CreateVolatileBuffer(const void* data, uint32_t dataSize);
 	PersistentConstBuffer CreatePersistentBuffer(const void* data, uint32_t dataSize);
+	/// <summary> Overwrites the contents of the buffer in place. The caller must make sure the GPU is no longer reading it. </summary>
+	void UpdatePersistentBuffer(const PersistentConstBuffer& buffer, const void* data, uint32_t dataSize);
+
+	/// <summary> Starts stamping pages with the frame. </summary>
+	/// <remarks> Must be called on the render thread before the frame is recorded, so that no buffer of
+	///		the frame can be stamped with an earlier frame that might complete while the GPU still reads it. </remarks>
+	void BeginFrame(uint64_t frameId);
+	/// <summary> The ID of the frame that is being recorded. Buffers written now are in use until it completes. </summary>
+	uint64_t GetCurrentFrameID();
+	/// <summary> Tells if the GPU has finished the frame returned by <see cref="GetCurrentFrameID"/> at some point. </summary>
+	bool IsFrameComplete(uint64_t frameId);
 
 	void OnFrameBeginDevice(uint64_t frameId) override;
 	void OnFrameBeginHost(uint64_t frameId) override;
@@ -61,6 +72,7 @@ protected:
 	RingBuffer<ConstBufferPage> m_pages;
 	std::mutex m_mutex;
 
+	// Frame IDs are the engine's frame indices plus one, so that zero is complete before the first frame.
 	uint64_t m_currFrameID = 1;
 	uint64_t m_lastFinishedFrameID = 0;
 
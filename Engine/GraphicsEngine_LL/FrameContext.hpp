@@ -20,6 +20,7 @@ namespace gxeng {
 class CommandAllocatorPool;
 class CommandListPool;
 class ScratchSpacePool;
+class BinderCache;
 class Scene;
 class PerspectiveCamera;
 class RenderTargetView2D;
@@ -38,6 +39,7 @@ struct FrameContext {
 	RTVHeap* rtvHeap = nullptr;
 	DSVHeap* dsvHeap = nullptr;
 	ShaderManager* shaderManager = nullptr;
+	BinderCache* binderCache = nullptr;
 
 	CommandQueue* commandQueue = nullptr;
 	RenderTargetView2D* backBuffer = nullptr;
@@ -0,0 +1,290 @@
+#include "FrameProfiler.hpp"
+#include "CommandQueue.hpp"
+
+#include <GraphicsApi_LL/ICommandQueue.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <cassert>
+
+
+namespace inl {
+namespace gxeng {
+
+
+static const char* PhaseName(eProfilerPhase phase) {
+	switch (phase) {
+		case eProfilerPhase::SETUP: return "Setup";
+		case eProfilerPhase::EXECUTE: return "Execute";
+		case eProfilerPhase::GPU: return "GPU";
+		default: assert(false); return "";
+	}
+}
+
+
+static void WriteJsonString(std::ostream& os, const std::string& str) {
+	os << '"';
+	for (char c : str) {
+		switch (c) {
+			case '"': os << "\\\""; break;
+			case '\\': os << "\\\\"; break;
+			case '\n': os << "\\n"; break;
+			case '\t': os << "\\t"; break;
+			default:
+				if ((unsigned char)c >= 0x20) {
+					os << c;
+				}
+		}
+	}
+	os << '"';
+}
+
+
+//------------------------------------------------------------------------------
+// Rolling statistics
+//------------------------------------------------------------------------------
+
+void FrameProfiler::RollingTiming::Add(double value) {
+	m_samples[m_next] = value;
+	m_next = (m_next + 1) % m_samples.size();
+	m_count = std::min(m_count + 1, m_samples.size());
+}
+
+
+ProfilerTiming FrameProfiler::RollingTiming::Get() const {
+	ProfilerTiming timing;
+	if (m_count == 0) {
+		return timing;
+	}
+
+	double sum = 0;
+	for (size_t i = 0; i < m_count; ++i) {
+		sum += m_samples[i];
+		timing.max = std::max(timing.max, m_samples[i]);
+	}
+	timing.average = sum / m_count;
+	timing.last = m_samples[(m_next + m_samples.size() - 1) % m_samples.size()];
+	return timing;
+}
+
+
+//------------------------------------------------------------------------------
+// Profiler
+//------------------------------------------------------------------------------
+
+FrameProfiler::FrameProfiler()
+	: m_startTime(Clock::now())
+{}
+
+
+void FrameProfiler::BeginFrame(uint64_t frameId, gxapi::IGraphicsApi* graphicsApi, CommandQueue& commandQueue) {
+	if (!m_queryHeap) {
+		m_queryHeap.reset(graphicsApi->CreateQueryHeap({ gxapi::eQueryHeapType::TIMESTAMP, MaxTimestampsPerFrame * NumFrameSlots }));
+		m_readbackBuffer.reset(graphicsApi->CreateCommittedResource(
+			gxapi::HeapProperties{ gxapi::eHeapType::READBACK },
+			gxapi::eHeapFlags::NONE,
+			gxapi::ResourceDesc::Buffer(MaxTimestampsPerFrame * NumFrameSlots * sizeof(uint64_t)),
+			gxapi::eResourceState::COPY_DEST));
+		m_readbackBuffer->SetName("Profiler timestamp readback");
+		m_timestampFrequency = commandQueue.GetUnderlyingQueue()->GetTimestampFrequency();
+	}
+
+	// The previous frame did not finish, e.g. the pipeline threw, its timestamps are never resolved.
+	if (m_currentSlot) {
+		m_currentSlot->pending = false;
+		m_currentSlot = nullptr;
+	}
+
+	for (unsigned slotIndex = 0; slotIndex < NumFrameSlots; ++slotIndex) {
+		if (m_slots[slotIndex].pending && m_slots[slotIndex].finished.IsReached()) {
+			CollectGpuTimings(m_slots[slotIndex], slotIndex);
+		}
+	}
+
+	m_currentSlotIndex = frameId % NumFrameSlots;
+	m_currentSlot = &m_slots[m_currentSlotIndex];
+	if (m_currentSlot->pending) {
+		m_currentSlot->finished.Wait();
+		CollectGpuTimings(*m_currentSlot, m_currentSlotIndex);
+	}
+	m_currentSlot->frameId = frameId;
+	m_currentSlot->submitUs = ToMicroseconds(Clock::now());
+	m_currentSlot->timestampNames.clear();
+
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	m_frameId = frameId;
+	m_frameCpuTimes.clear();
+	while (!m_traceEvents.empty() && m_traceEvents.front().frameId + TraceHistoryFrames < frameId) {
+		m_traceEvents.pop_front();
+	}
+}
+
+
+void FrameProfiler::RecordCpu(const std::string& name, eProfilerPhase phase, Clock::time_point begin, Clock::time_point end) {
+	assert(phase != eProfilerPhase::GPU);
+
+	double beginUs = ToMicroseconds(begin);
+	double durationUs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() / 1000.0;
+
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	uint32_t threadIndex = GetThreadIndex(std::this_thread::get_id());
+	m_traceEvents.push_back({ name, phase, threadIndex, m_frameId, beginUs, durationUs });
+	m_frameCpuTimes[name][phase == eProfilerPhase::SETUP ? 0 : 1] += durationUs / 1000.0;
+}
+
+
+void FrameProfiler::WriteTimestamp(gxapi::ICopyCommandList* commandList, const std::string& name) {
+	if (!m_currentSlot || m_currentSlot->timestampNames.size() >= MaxTimestampsPerFrame) {
+		return;
+	}
+
+	unsigned index = m_currentSlotIndex * MaxTimestampsPerFrame + (unsigned)m_currentSlot->timestampNames.size();
+	commandList->EndQuery(m_queryHeap.get(), index);
+	m_currentSlot->timestampNames.push_back(name);
+}
+
+
+void FrameProfiler::ResolveTimestamps(gxapi::ICopyCommandList* commandList) {
+	if (!m_currentSlot || m_currentSlot->timestampNames.empty()) {
+		return;
+	}
+
+	unsigned firstIndex = m_currentSlotIndex * MaxTimestampsPerFrame;
+	commandList->ResolveQueryData(m_queryHeap.get(),
+								  firstIndex,
+								  (unsigned)m_currentSlot->timestampNames.size(),
+								  m_readbackBuffer.get(),
+								  firstIndex * sizeof(uint64_t));
+}
+
+
+void FrameProfiler::EndFrame(SyncPoint frameFinished) {
+	if (m_currentSlot) {
+		m_currentSlot->finished = frameFinished;
+		m_currentSlot->pending = m_currentSlot->timestampNames.size() >= 2;
+		m_currentSlot = nullptr;
+	}
+
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	for (auto& frameTimes : m_frameCpuTimes) {
+		NodeRecord& record = m_nodes[frameTimes.first];
+		record.setup.Add(frameTimes.second[0]);
+		record.execute.Add(frameTimes.second[1]);
+	}
+	m_frameCpuTimes.clear();
+}
+
+
+std::vector<ProfilerNodeStatistics> FrameProfiler::GetStatistics() const {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+
+	std::vector<ProfilerNodeStatistics> statistics;
+	for (auto& node : m_nodes) {
+		ProfilerNodeStatistics stats;
+		stats.name = node.first;
+		stats.setup = node.second.setup.Get();
+		stats.execute = node.second.execute.Get();
+		stats.gpu = node.second.gpu.Get();
+		statistics.push_back(stats);
+	}
+
+	std::sort(statistics.begin(), statistics.end(), [](const ProfilerNodeStatistics& lhs, const ProfilerNodeStatistics& rhs) {
+		return std::max(lhs.setup.average + lhs.execute.average, lhs.gpu.average) > std::max(rhs.setup.average + rhs.execute.average, rhs.gpu.average);
+	});
+	return statistics;
+}
+
+
+ProfilerGpuFrameTime FrameProfiler::GetGpuFrameTime() const {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	return m_gpuFrameTime;
+}
+
+
+void FrameProfiler::ExportChromeTrace(std::ostream& os) const {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+
+	os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+	// Name the tracks.
+	os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}";
+	for (auto& thread : m_threadIndices) {
+		os << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.second
+			<< ",\"args\":{\"name\":\"CPU " << thread.second << "\"}}";
+	}
+
+	for (auto& event : m_traceEvents) {
+		os << ",\n{\"name\":";
+		WriteJsonString(os, event.name.empty() ? std::string("(unnamed)") : event.name);
+		os << ",\"cat\":\"" << PhaseName(event.phase) << "\""
+			<< ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadIndex
+			<< ",\"ts\":" << event.beginUs
+			<< ",\"dur\":" << event.durationUs
+			<< ",\"args\":{\"frame\":" << event.frameId << "}}";
+	}
+
+	os << "\n]}\n";
+}
+
+
+void FrameProfiler::Clear() {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	m_nodes.clear();
+	m_frameCpuTimes.clear();
+	m_traceEvents.clear();
+	m_gpuFrameTime = {};
+}
+
+
+void FrameProfiler::CollectGpuTimings(FrameSlot& slot, unsigned slotIndex) {
+	slot.pending = false;
+
+	const size_t count = slot.timestampNames.size();
+	const size_t offset = slotIndex * MaxTimestampsPerFrame * sizeof(uint64_t);
+	std::vector<uint64_t> timestamps(count);
+
+	gxapi::MemoryRange readRange{ offset, offset + count * sizeof(uint64_t) };
+	gxapi::MemoryRange noWriteRange{ 0, 0 };
+	const uint8_t* mapped = reinterpret_cast<const uint8_t*>(m_readbackBuffer->Map(0, &readRange));
+	std::memcpy(timestamps.data(), mapped + offset, count * sizeof(uint64_t));
+	m_readbackBuffer->Unmap(0, &noWriteRange);
+
+	const double usPerTick = 1e6 / m_timestampFrequency;
+	const double frameBeginUs = std::max(slot.submitUs, m_lastGpuEndUs);
+
+	std::map<std::string, double> frameGpuTimes;
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	for (size_t i = 1; i < count; ++i) {
+		if (slot.timestampNames[i].empty() || timestamps[i] < timestamps[i - 1]) {
+			continue;
+		}
+		double beginUs = frameBeginUs + (timestamps[i - 1] - timestamps[0]) * usPerTick;
+		double durationUs = (timestamps[i] - timestamps[i - 1]) * usPerTick;
+		m_traceEvents.push_back({ slot.timestampNames[i], eProfilerPhase::GPU, 0, slot.frameId, beginUs, durationUs });
+		frameGpuTimes[slot.timestampNames[i]] += durationUs / 1000.0;
+	}
+	m_lastGpuEndUs = frameBeginUs + (timestamps[count - 1] - timestamps[0]) * usPerTick;
+	m_gpuFrameTime = { slot.frameId, (timestamps[count - 1] - timestamps[0]) * usPerTick / 1000.0 };
+
+	for (auto& gpuTime : frameGpuTimes) {
+		m_nodes[gpuTime.first].gpu.Add(gpuTime.second);
+	}
+}
+
+
+double FrameProfiler::ToMicroseconds(Clock::time_point time) const {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(time - m_startTime).count() / 1000.0;
+}
+
+
+uint32_t FrameProfiler::GetThreadIndex(std::thread::id id) {
+	auto it = m_threadIndices.find(id);
+	if (it == m_threadIndices.end()) {
+		it = m_threadIndices.insert({ id, (uint32_t)m_threadIndices.size() + 1 }).first;
+	}
+	return it->second;
+}
+
+
+} // namespace gxeng
+} // namespace inl
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "SyncPoint.hpp"
+
+#include <GraphicsApi_LL/IGraphicsApi.hpp>
+#include <GraphicsApi_LL/IQueryHeap.hpp>
+#include <GraphicsApi_LL/IResource.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <array>
+#include <map>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <ostream>
+#include <cstdint>
+
+
+namespace inl {
+namespace gxeng {
+
+
+class CommandQueue;
+
+
+enum class eProfilerPhase {
+	SETUP,
+	EXECUTE,
+	GPU,
+};
+
+
+/// <summary> Timing of a node over the last few frames, in milliseconds. </summary>
+struct ProfilerTiming {
+	double average = 0;
+	double max = 0;
+	double last = 0;
+};
+
+
+/// <summary> Timings of all tasks of a pipeline node, summed per frame. </summary>
+struct ProfilerNodeStatistics {
+	std::string name;
+	ProfilerTiming setup;
+	ProfilerTiming execute;
+	ProfilerTiming gpu;
+};
+
+
+/// <summary> GPU time of a whole frame. </summary>
+struct ProfilerGpuFrameTime {
+	uint64_t frameId = 0; // the frame that was measured
+	double timeMs = 0; // 0 if no frame has been read back yet
+};
+
+
+/// <summary>
+/// Measures how long each pipeline node takes on the CPU and the GPU.
+/// <para />
+/// The <see cref="Scheduler"/> reports CPU time of tasks' Setup and Execute, and writes a GPU timestamp
+/// after each task's command list. The GPU time of a task is the time between its timestamp and the previous one,
+/// so injected barriers are counted towards the task that needed them.
+/// Timestamps are read back a few frames later, when the GPU has finished with them.
+/// </summary>
+/// <remarks>
+/// Statistics are kept per node display name, so that the same node is recognized across pipeline reloads.
+/// The GPU and the CPU clocks are not calibrated: the GPU track of a frame is placed at the time the frame
+/// was submitted, or right after the previous frame's GPU work, whichever is later.
+/// Reading statistics and exporting traces is thread safe, the rest must be called from the render thread.
+/// </remarks>
+class FrameProfiler {
+public:
+	using Clock = std::chrono::high_resolution_clock;
+
+	/// <summary> Timestamps beyond this in a frame are not recorded. </summary>
+	static constexpr unsigned MaxTimestampsPerFrame = 512;
+	/// <summary> Number of frames that may wait for their timestamps to be read back. </summary>
+	static constexpr unsigned NumFrameSlots = 8;
+	/// <summary> Number of frames statistics are calculated over. </summary>
+	static constexpr unsigned StatisticsWindow = 64;
+	/// <summary> Number of frames kept for trace export. </summary>
+	static constexpr unsigned TraceHistoryFrames = 120;
+public:
+	FrameProfiler();
+	FrameProfiler(const FrameProfiler&) = delete;
+	FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+	/// <summary> Starts a new frame, and collects the GPU timings of finished frames. </summary>
+	void BeginFrame(uint64_t frameId, gxapi::IGraphicsApi* graphicsApi, CommandQueue& commandQueue);
+
+	/// <summary> Reports a piece of CPU work of a node. Can be called from any thread. </summary>
+	void RecordCpu(const std::string& name, eProfilerPhase phase, Clock::time_point begin, Clock::time_point end);
+
+	/// <summary> Records a GPU timestamp at the end of the command list. GPU work since the previous timestamp is
+	///		assigned to <paramref name="name"/>. Empty name marks the beginning of the frame. </summary>
+	void WriteTimestamp(gxapi::ICopyCommandList* commandList, const std::string& name);
+
+	/// <summary> Records copying the frame's timestamps to the CPU. Must be in the last command list of the frame. </summary>
+	void ResolveTimestamps(gxapi::ICopyCommandList* commandList);
+
+	/// <summary> Closes the frame. Timestamps are read back once <paramref name="frameFinished"/> is reached. </summary>
+	void EndFrame(SyncPoint frameFinished);
+
+	/// <summary> Returns the statistics of each node, slowest total first. </summary>
+	std::vector<ProfilerNodeStatistics> GetStatistics() const;
+
+	/// <summary> Returns the GPU time of the last frame that was read back.
+	///		This lags behind the current frame by the number of frames in flight. </summary>
+	ProfilerGpuFrameTime GetGpuFrameTime() const;
+
+	/// <summary> Writes the recorded events of the last frames in the Chrome trace event format.
+	///		The output can be opened in chrome://tracing or Perfetto. </summary>
+	void ExportChromeTrace(std::ostream& os) const;
+
+	/// <summary> Drops statistics and recorded events. </summary>
+	void Clear();
+private:
+	class RollingTiming {
+	public:
+		void Add(double value);
+		ProfilerTiming Get() const;
+	private:
+		std::array<double, StatisticsWindow> m_samples;
+		size_t m_count = 0;
+		size_t m_next = 0;
+	};
+
+	struct NodeRecord {
+		RollingTiming setup;
+		RollingTiming execute;
+		RollingTiming gpu;
+	};
+
+	struct TraceEvent {
+		std::string name;
+		eProfilerPhase phase;
+		uint32_t threadIndex; // 0 is the GPU
+		uint64_t frameId;
+		double beginUs;
+		double durationUs;
+	};
+
+	struct FrameSlot {
+		uint64_t frameId = 0;
+		bool pending = false;
+		SyncPoint finished;
+		double submitUs = 0;
+		std::vector<std::string> timestampNames;
+	};
+private:
+	void CollectGpuTimings(FrameSlot& slot, unsigned slotIndex);
+	double ToMicroseconds(Clock::time_point time) const;
+	uint32_t GetThreadIndex(std::thread::id id);
+private:
+	Clock::time_point m_startTime;
+
+	// GPU queries, touched only by the render thread
+	std::unique_ptr<gxapi::IQueryHeap> m_queryHeap;
+	std::unique_ptr<gxapi::IResource> m_readbackBuffer;
+	std::array<FrameSlot, NumFrameSlots> m_slots;
+	FrameSlot* m_currentSlot = nullptr;
+	unsigned m_currentSlotIndex = 0;
+	uint64_t m_timestampFrequency = 1;
+	double m_lastGpuEndUs = 0;
+
+	// Results
+	mutable std::mutex m_mutex;
+	uint64_t m_frameId = 0;
+	ProfilerGpuFrameTime m_gpuFrameTime;
+	std::map<std::string, NodeRecord> m_nodes;
+	std::map<std::string, std::array<double, 2>> m_frameCpuTimes; // setup and execute of the current frame
+	std::deque<TraceEvent> m_traceEvents;
+	std::map<std::thread::id, uint32_t> m_threadIndices;
+};
+
+
+} // namespace gxeng
+} // namespace inl
@@ -261,9 +261,9 @@ void GraphicsCommandList::BindGraphics(BindParameter parameter, const TextureVie
 }
 
 void GraphicsCommandList::BindGraphics(BindParameter parameter, const ConstBufferView& shaderConstant) {
-	if (dynamic_cast<const PersistentConstBuffer*>(&shaderConstant.GetResource())) {
-		m_additionalResources.push_back(shaderConstant.GetResource());
-	}
+	// Views store the buffer as a plain ConstBuffer, so persistent and volatile buffers can't be told apart here.
+	// Keep it alive either way until the GPU is done with the command list.
+	m_additionalResources.push_back(shaderConstant.GetResource());
 
 	try {
 		m_graphicsBindingManager.Bind(parameter, shaderConstant);
@@ -1,5 +1,6 @@
 #include "GraphicsEngine.hpp"
 #include "GraphicsNode.hpp"
+#include "CommandStreamRecorder.hpp"
 
 #include <BaseLibrary/Graph/Node.hpp>
 #include <BaseLibrary/Graph/NodeLibrary.hpp>
@@ -10,6 +11,7 @@
 
 #include <rapidjson/document.h>
 #include <optional>
+#include <fstream>
 
 #include "Nodes/Node_GetBackBuffer.hpp"
 #include "Nodes/Node_TextureProperties.hpp"
@@ -83,6 +85,7 @@ GraphicsEngine::GraphicsEngine(GraphicsEngineDesc desc)
 	m_commandListPool(desc.graphicsApi),
 	m_scratchSpacePool(desc.graphicsApi, gxapi::eDescriptorHeapType::CBV_SRV_UAV),
 	m_textureSpace(desc.graphicsApi),
+	m_bindlessTextureHeap(desc.graphicsApi),
 	m_masterCommandQueue(desc.graphicsApi->CreateCommandQueue(CommandQueueDesc{ eCommandListType::GRAPHICS }), desc.graphicsApi->CreateFence(0)),
 	m_residencyQueue(std::unique_ptr<gxapi::IFence>(desc.graphicsApi->CreateFence(0))),
 	m_memoryManager(desc.graphicsApi),
@@ -90,7 +93,8 @@ GraphicsEngine::GraphicsEngine(GraphicsEngineDesc desc)
 	m_rtvHeap(desc.graphicsApi),
 	m_persResViewHeap(desc.graphicsApi),
 	m_logger(desc.logger),
-	m_shaderManager(desc.gxapiManager)
+	m_shaderManager(desc.gxapiManager),
+	m_binderCache(desc.graphicsApi)
 {
 	// Create swapchain
 	SwapChainDesc swapChainDesc;
@@ -102,9 +106,12 @@ GraphicsEngine::GraphicsEngine(GraphicsEngineDesc desc)
 	swapChainDesc.isFullScreen = desc.fullScreen;
 	swapChainDesc.multisampleCount = 1;
 	swapChainDesc.multiSampleQuality = 0;
-	m_swapChain.reset(m_gxapiManager->CreateSwapChain(swapChainDesc, m_masterCommandQueue.GetUnderlyingQueue()));
+	m_swapChain.reset(m_gxapiManager->CreateSwapChain(swapChainDesc, CommandStreamRecorder::GetInnerQueue(m_masterCommandQueue.GetUnderlyingQueue())));
 
-	m_frameEndFenceValues.resize(m_swapChain->GetDesc().numBuffers, { nullptr, 0 });
+	m_frameEndFenceValues.resize(m_swapChain->GetDesc().numBuffers, { nullptr, 0 }); // frames in flight, as many as back buffers by default
+
+	// Scratch spaces carry a copy of the bindless texture table
+	m_scratchSpacePool.SetBindlessHeap(&m_bindlessTextureHeap);
 
 	// Init backbuffer heap
 	m_backBufferHeap = std::make_unique<BackBufferManager>(m_graphicsApi, m_swapChain.get());
@@ -123,6 +130,7 @@ GraphicsEngine::GraphicsEngine(GraphicsEngineDesc desc)
 	shaderFlags += gxapi::eShaderCompileFlags::DEBUG;
 #endif // NDEBUG
 	m_shaderManager.SetShaderCompileFlags(shaderFlags);
+	m_shaderManager.SetCacheDirectory("./ShaderCache");
 
 	// Register nodes
 	RegisterPipelineClasses();
@@ -140,6 +148,8 @@ GraphicsEngine::GraphicsEngine(GraphicsEngineDesc desc)
 	m_commandAllocatorPool.SetLogStream(&m_logStreamPipeline);
 
 	m_pipelineEventDispatcher += &m_memoryManager.GetUploadManager();
+	m_pipelineEventDispatcher += &m_memoryManager.GetConstBufferHeap();
+	m_pipelineEventDispatcher += &m_bindlessTextureHeap;
 	// DELETE THIS
 	m_pipelineEventPrinter.SetLog(&m_logStreamPipeline);
 	m_pipelineEventDispatcher += &m_pipelineEventPrinter;
@@ -147,7 +157,10 @@ GraphicsEngine::GraphicsEngine(GraphicsEngineDesc desc)
 
 
 	// Begin awaiting frame #0's Update()
-	m_pipelineEventDispatcher.DispachFrameBeginAwait(0);
+	m_memoryManager.GetUploadManager().BeginFrame(0);
+	m_memoryManager.GetConstBufferHeap().BeginFrame(0);
+	m_bindlessTextureHeap.BeginFrame(0);
+	m_pipelineEventDispatcher.DispatchFrameBeginAwait(0);
 }
 
 
@@ -155,6 +168,13 @@ GraphicsEngine::~GraphicsEngine() {
 	std::cout << "Graphics engine shutting down..." << std::endl;
 	SyncPoint lastSync = m_masterCommandQueue.Signal();
 	lastSync.Wait();
+
+	// Listeners are members, some destroyed before the dispatcher. Deliver pending events and detach them first.
+	m_pipelineEventDispatcher.WaitEpoch(m_pipelineEventDispatcher.GetLastEpoch());
+	m_pipelineEventDispatcher -= &m_memoryManager.GetUploadManager();
+	m_pipelineEventDispatcher -= &m_memoryManager.GetConstBufferHeap();
+	m_pipelineEventDispatcher -= &m_bindlessTextureHeap;
+	m_pipelineEventDispatcher -= &m_pipelineEventPrinter;
 	std::cout << "Graphics engine deleting..." << std::endl;
 }
 
@@ -163,11 +183,8 @@ void GraphicsEngine::Update(float elapsed) {
 	std::chrono::nanoseconds frameTime(long long(elapsed * 1e9));
 	m_absoluteTime += frameTime;
 
-	// Wait for previous frame on this BB to complete
+	// No need to wait for the back buffer, the GPU executes frames in order.
 	int backBufferIndex = m_swapChain->GetCurrentBufferIndex();
-	if (m_frameEndFenceValues[backBufferIndex]) {
-		m_frameEndFenceValues[backBufferIndex].Wait();
-	}
 
 	// Set up context
 	FrameContext context;
@@ -185,6 +202,7 @@ void GraphicsEngine::Update(float elapsed) {
 	context.rtvHeap = &m_rtvHeap;
 	context.dsvHeap = &m_dsvHeap;
 	context.shaderManager = &m_shaderManager;
+	context.binderCache = &m_binderCache;
 
 	context.commandQueue = &m_masterCommandQueue;
 	context.backBuffer = &m_backBufferHeap->GetBackBuffer(backBufferIndex);
@@ -199,16 +217,39 @@ void GraphicsEngine::Update(float elapsed) {
 	// Update special nodes for current frame
 	UpdateSpecialNodes();
 
+	// Don't get further ahead of the GPU than the allowed number of frames in flight.
+	// Everything else that is reused between frames is recycled by its own fence.
+	SyncPoint& oldestFrameEnd = m_frameEndFenceValues[m_frame % m_frameEndFenceValues.size()];
+	if (oldestFrameEnd) {
+		oldestFrameEnd.Wait();
+	}
+
+	// Start capturing after the throttle, a capture only contains this frame's submissions.
+	std::string captureFramePath = std::move(m_captureFramePath);
+	m_captureFramePath.clear();
+	if (!captureFramePath.empty()) {
+		static_cast<CommandStreamRecorder*>(m_graphicsApi)->BeginCapture();
+	}
+
 	// Execute the pipeline
-	m_pipelineEventDispatcher.DispatchFrameBegin(m_frame).wait();
+	// Listeners are notified asynchronously, nothing in the frame depends on them having finished.
+	m_pipelineEventDispatcher.DispatchFrameBegin(m_frame);
 	m_scheduler.Execute(context);
-	m_pipelineEventDispatcher.DispatchFrameEnd(m_frame).wait();
+	m_pipelineEventDispatcher.DispatchFrameEnd(m_frame);
 
 	// Mark frame completion
 	SyncPoint frameEnd = m_masterCommandQueue.Signal();
-	m_frameEndFenceValues[backBufferIndex] = frameEnd;
+	oldestFrameEnd = frameEnd;
 	m_pipelineEventDispatcher.DispatchDeviceFrameEnd(frameEnd, m_frame);
 
+	if (!captureFramePath.empty()) {
+		std::ofstream capture(captureFramePath, std::ios::binary | std::ios::trunc);
+		static_cast<CommandStreamRecorder*>(m_graphicsApi)->EndCapture(capture);
+		if (!capture) {
+			m_logStreamGeneral.Event("Failed to write frame capture to " + captureFramePath + ".");
+		}
+	}
+
 	// Flush log
 	m_logger->Flush();
 
@@ -217,7 +258,29 @@ void GraphicsEngine::Update(float elapsed) {
 	++m_frame;
 
 	// Await next frame
-	m_pipelineEventDispatcher.DispachFrameBeginAwait(m_frame).wait(); // m_frame incremented on previous line
+	m_memoryManager.GetUploadManager().BeginFrame(m_frame); // m_frame incremented on previous line
+	m_memoryManager.GetConstBufferHeap().BeginFrame(m_frame);
+	m_bindlessTextureHeap.BeginFrame(m_frame);
+	m_pipelineEventDispatcher.DispatchFrameBeginAwait(m_frame);
+}
+
+
+void GraphicsEngine::SetFramesInFlight(unsigned count) {
+	if (count == 0) {
+		throw InvalidArgumentException("At least one frame must be in flight.");
+	}
+
+	// Drain the GPU, so that no frame is lost from tracking.
+	SyncPoint sp = m_masterCommandQueue.Signal();
+	sp.Wait();
+
+	m_frameEndFenceValues.clear();
+	m_frameEndFenceValues.resize(count, { nullptr, 0 });
+}
+
+
+unsigned GraphicsEngine::GetFramesInFlight() const {
+	return (unsigned)m_frameEndFenceValues.size();
 }
 
 
@@ -255,11 +318,11 @@ Mesh* GraphicsEngine::CreateMesh() {
 }
 
 Image* GraphicsEngine::CreateImage() {
-	return new Image(&m_memoryManager, &m_textureSpace);
+	return new Image(&m_memoryManager, &m_textureSpace, &m_bindlessTextureHeap);
 }
 
 Material* GraphicsEngine::CreateMaterial() {
-	return new Material;
+	return new Material(&m_memoryManager, &m_persResViewHeap);
 }
 
 MaterialShaderEquation* GraphicsEngine::CreateMaterialShaderEquation() {
@@ -364,6 +427,7 @@ OverlayEntity* GraphicsEngine::CreateOverlayEntity() {
 
 bool GraphicsEngine::SetEnvVariable(std::string name, Any obj) {
 	auto res = m_envVariables.insert_or_assign(std::move(name), std::move(obj));
+	m_scheduler.InvalidateConstants(); // nodes reading env vars are folded as constants
 	return res.second;
 }
 
@@ -384,14 +448,10 @@ const Any& GraphicsEngine::GetEnvVariable(const std::string& name) {
 
 void GraphicsEngine::LoadPipeline(const std::string& graphDesc) {
 	Pipeline pipeline;
-	pipeline.CreateFromDescription(graphDesc, m_nodeFactory);
+	pipeline.CreateFromDescription(graphDesc, m_nodeFactory); // initializes the nodes as well
 
-	EngineContext engineContext(1, 1);
-	for (auto& node : pipeline) {
-		if (auto graphicsNode = dynamic_cast<GraphicsNode*>(&node)) {
-			graphicsNode->Initialize(engineContext);
-		}
-	}
+	// Nodes create their shaders, binders and PSOs in their first Setup.
+	// The scheduler does that on multiple threads when it gets a new pipeline.
 
 	auto specialNodes = SelectSpecialNodes(pipeline);
 
@@ -409,6 +469,47 @@ void GraphicsEngine::LoadPipeline(const std::string& graphDesc) {
 }
 
 
+BinderCache::Statistics GraphicsEngine::GetBinderCacheStatistics() const {
+	return m_binderCache.GetStatistics();
+}
+
+
+std::vector<PoolThreadStatistics> GraphicsEngine::GetCommandAllocatorPoolStatistics() const {
+	return m_commandAllocatorPool.GetThreadStatistics();
+}
+
+
+std::vector<PoolThreadStatistics> GraphicsEngine::GetCommandListPoolStatistics() const {
+	return m_commandListPool.GetThreadStatistics();
+}
+
+
+void GraphicsEngine::SetProfilingEnabled(bool enabled) {
+	m_scheduler.SetProfiler(enabled ? &m_profiler : nullptr);
+}
+
+
+bool GraphicsEngine::GetProfilingEnabled() const {
+	return m_scheduler.GetProfiler() != nullptr;
+}
+
+
+const FrameProfiler& GraphicsEngine::GetProfiler() const {
+	return m_profiler;
+}
+
+
+void GraphicsEngine::CaptureFrame(std::string path) {
+	if (dynamic_cast<CommandStreamRecorder*>(m_graphicsApi) == nullptr) {
+		throw InvalidStateException("Frame capture requires the engine to use a CommandStreamRecorder as its graphics API.");
+	}
+	if (path.empty()) {
+		throw InvalidArgumentException("Capture path must not be empty.");
+	}
+	m_captureFramePath = std::move(path);
+}
+
+
 // DEPRECATED
 // It's about time to get rid of thuis abomination
 /*
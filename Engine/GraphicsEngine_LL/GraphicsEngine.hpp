@@ -7,14 +7,16 @@
 #include "CommandListPool.hpp"
 #include "ScratchSpacePool.hpp"
 #include "ResourceResidencyQueue.hpp"
-#include "PipelineEventDispatcher.hpp"
+#include "LightweightEventDispatcher.hpp"
 #include "PipelineEventListener.hpp"
 
 #include "CriticalBufferHeap.hpp"
 #include "BackBufferManager.hpp"
 #include "MemoryManager.hpp"
 #include "HostDescHeap.hpp"
+#include "BindlessTextureHeap.hpp"
 #include "ShaderManager.hpp"
+#include "BinderCache.hpp"
 
 #include <GraphicsApi_LL/IGxapiManager.hpp>
 #include <GraphicsApi_LL/IGraphicsApi.hpp>
@@ -101,6 +103,12 @@ public:
 	void SetFullScreen(bool enable);
 	bool GetFullScreen() const;
 
+	/// <summary> Sets how many frames the CPU may record ahead of the GPU. Must be at least 1. </summary>
+	/// <remarks> With 1, each frame waits for the previous one to finish on the GPU.
+	///		Higher values let recording overlap GPU execution at the cost of latency and memory. </remarks>
+	void SetFramesInFlight(unsigned count);
+	unsigned GetFramesInFlight() const;
+
 
 	// Resources
 	Mesh* CreateMesh();
@@ -135,6 +143,27 @@ public:
 
 	/// <summary> Load the pipeline from the JSON node graph description. </summary>
 	void LoadPipeline(const std::string& nodes);
+
+	/// <summary> Returns how many binders were requested by nodes, and how many distinct root signatures they needed. </summary>
+	BinderCache::Statistics GetBinderCacheStatistics() const;
+
+	/// <summary> Returns how many command allocator requests each thread could serve from its own cache. </summary>
+	std::vector<PoolThreadStatistics> GetCommandAllocatorPoolStatistics() const;
+
+	/// <summary> Returns how many command list requests each thread could serve from its own cache. </summary>
+	std::vector<PoolThreadStatistics> GetCommandListPoolStatistics() const;
+
+	/// <summary> Enables measuring the CPU and GPU time of each pipeline node. Disabled by default. </summary>
+	void SetProfilingEnabled(bool enabled);
+	bool GetProfilingEnabled() const;
+
+	/// <summary> Per-node timings and trace export, see <see cref="FrameProfiler"/>. </summary>
+	const FrameProfiler& GetProfiler() const;
+
+	/// <summary> Saves the command lists and submissions of the next frame to <paramref name="path"/>, so that the
+	///		frame can be replayed without the engine by a <see cref="CommandStreamPlayer"/>. </summary>
+	/// <remarks> The engine must have been created with a <see cref="CommandStreamRecorder"/> as its graphics API. </remarks>
+	void CaptureFrame(std::string path);
 private:
 	//void CreatePipeline();
 	void RegisterPipelineClasses();
@@ -161,17 +190,20 @@ private:
 	CommandListPool m_commandListPool;
 	ScratchSpacePool m_scratchSpacePool; // Creates CBV_SRV_UAV type scratch spaces
 	CbvSrvUavHeap m_textureSpace;
+	BindlessTextureHeap m_bindlessTextureHeap; // Images' SRVs, shaders read them from the heap of the scratch spaces
 	Pipeline m_pipeline;
 	Scheduler m_scheduler;
+	FrameProfiler m_profiler;
 	ShaderManager m_shaderManager;
-	std::vector<SyncPoint> m_frameEndFenceValues;
+	BinderCache m_binderCache;
+	std::vector<SyncPoint> m_frameEndFenceValues; // one per frame in flight
 	std::vector<std::shared_ptr<GraphicsNode>> m_graphicsNodes;
 	std::vector<GraphicsNode*> m_specialNodes;
 
 	// Pipeline elements
 	CommandQueue m_masterCommandQueue;
 	ResourceResidencyQueue m_residencyQueue;
-	PipelineEventDispatcher m_pipelineEventDispatcher;
+	LightweightEventDispatcher m_pipelineEventDispatcher;
 	PipelineEventPrinter m_pipelineEventPrinter; // ONLY FOR TEST PURPOSES
 
 	// Logging
@@ -182,6 +214,7 @@ private:
 	// Misc
 	std::chrono::nanoseconds m_absoluteTime;
 	uint64_t m_frame = 0;
+	std::string m_captureFramePath; // capture the next frame if not empty
 
 	// Env variables
 	std::unordered_map<std::string, Any> m_envVariables;
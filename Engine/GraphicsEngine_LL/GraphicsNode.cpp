@@ -18,6 +18,16 @@ const lemon::ListDigraph::NodeMap<GraphicsTask*>& GraphicsNode::GetTaskGraphMapp
 }
 
 
+bool GraphicsNode::IsParallelSetupAllowed() const {
+	return m_parallelSetupAllowed;
+}
+
+
+void GraphicsNode::SetParallelSetupAllowed(bool allowed) {
+	m_parallelSetupAllowed = allowed;
+}
+
+
 void GraphicsNode::SetTaskSingle(GraphicsTask* task) {
 	m_taskNodes.clear();
 	lemon::ListDigraph::Node node = m_taskNodes.addNode();
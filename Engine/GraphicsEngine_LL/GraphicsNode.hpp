@@ -80,9 +80,17 @@ public:
 	const lemon::ListDigraph& GetTaskGraph() const;
 	const lemon::ListDigraph::NodeMap<GraphicsTask*>& GetTaskGraphMapping() const;
 
+	/// <summary> Whether the Setup of the node's tasks may run concurrently with other tasks' Setup. </summary>
+	bool IsParallelSetupAllowed() const;
+
 protected:
 	void SetTaskSingle(GraphicsTask* task);
 
+	/// <summary> Lets the scheduler set up the node's tasks on multiple threads when warming up a new pipeline.
+	///		Only allow it if Setup touches nothing but the node's own members, its inputs and the
+	///		<see cref="SetupContext"/>. Disabled by default, such tasks are set up one at a time. </summary>
+	void SetParallelSetupAllowed(bool allowed);
+
 	template <class Iter>
 	void SetTaskParallel(Iter first, Iter last);
 
@@ -94,6 +102,7 @@ protected:
 private:
 	lemon::ListDigraph m_taskNodes;
 	lemon::ListDigraph::NodeMap<GraphicsTask*> m_taskMap;
+	bool m_parallelSetupAllowed = false;
 };
 
 
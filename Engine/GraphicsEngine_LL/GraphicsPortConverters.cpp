@@ -89,6 +89,25 @@ std::vector<std::pair<gxapi::eFormat, std::string>> impl::ParseTableGenerator()
 		{ gxapi::eFormat::R8_SNORM, "R8_SNORM" },
 		{ gxapi::eFormat::R8_SINT, "R8_SINT" },
 		{ gxapi::eFormat::A8_UNORM, "A8_UNORM" },
+
+		{ gxapi::eFormat::BC1_TYPELESS, "BC1_TYPELESS" },
+		{ gxapi::eFormat::BC1_UNORM, "BC1_UNORM" },
+		{ gxapi::eFormat::BC1_UNORM_SRGB, "BC1_UNORM_SRGB" },
+		{ gxapi::eFormat::BC2_TYPELESS, "BC2_TYPELESS" },
+		{ gxapi::eFormat::BC2_UNORM, "BC2_UNORM" },
+		{ gxapi::eFormat::BC2_UNORM_SRGB, "BC2_UNORM_SRGB" },
+		{ gxapi::eFormat::BC3_TYPELESS, "BC3_TYPELESS" },
+		{ gxapi::eFormat::BC3_UNORM, "BC3_UNORM" },
+		{ gxapi::eFormat::BC3_UNORM_SRGB, "BC3_UNORM_SRGB" },
+		{ gxapi::eFormat::BC4_TYPELESS, "BC4_TYPELESS" },
+		{ gxapi::eFormat::BC4_UNORM, "BC4_UNORM" },
+		{ gxapi::eFormat::BC4_SNORM, "BC4_SNORM" },
+		{ gxapi::eFormat::BC5_TYPELESS, "BC5_TYPELESS" },
+		{ gxapi::eFormat::BC5_UNORM, "BC5_UNORM" },
+		{ gxapi::eFormat::BC5_SNORM, "BC5_SNORM" },
+		{ gxapi::eFormat::BC7_TYPELESS, "BC7_TYPELESS" },
+		{ gxapi::eFormat::BC7_UNORM, "BC7_UNORM" },
+		{ gxapi::eFormat::BC7_UNORM_SRGB, "BC7_UNORM_SRGB" },
 	};
 
 	return records;
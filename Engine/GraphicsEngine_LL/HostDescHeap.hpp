@@ -3,10 +3,11 @@
 #include "../GraphicsApi_LL/IGraphicsApi.hpp"
 #include "../GraphicsApi_LL/Exception.hpp"
 #include "../GraphicsApi_LL/IDescriptorHeap.hpp"
-#include "../BaseLibrary/Memory/SlabAllocatorEngine.hpp"
 
 #include <vector>
 #include <mutex>
+#include <atomic>
+#include <memory>
 #include <functional>
 #include <cassert>
 
@@ -27,7 +28,8 @@ public:
 /// This class was made for high level engine components
 /// that need a way of handling resource descriptors.
 /// <para />
-/// This class is thread safe.
+/// This class is thread safe. Allocate, Deallocate and At are lock-free,
+/// only growing the heap takes a lock.
 /// <para />
 /// The heap automatically grows if current size is not
 /// sufficient for a new allocation.
@@ -38,30 +40,40 @@ public:
 /// </summary>
 template <gxapi::eDescriptorHeapType HeapType>
 class HostDescHeap : public IHostDescHeap {
-	static constexpr size_t chunkDim = 64;
-	struct ChunkListItem {
-		std::unique_ptr<gxapi::IDescriptorHeap> heaps[chunkDim];
-		std::unique_ptr<ChunkListItem> next;
+	// Maximum number of underlying heaps. The table of heaps is allocated
+	// up front, so that it never moves and can be read without locking.
+	static constexpr size_t maxChunks = 4096;
+	static constexpr uint32_t emptyList = 0xFFFFFFFF;
+
+	struct Chunk {
+		std::unique_ptr<gxapi::IDescriptorHeap> heap;
+		std::unique_ptr<std::atomic<uint32_t>[]> next; // free list links of the chunk's descriptors
 	};
 
 public:
 	HostDescHeap(gxapi::IGraphicsApi* graphicsApi, size_t heapSize);
+	~HostDescHeap();
 
 	size_t Allocate() override;
 	void Deallocate(size_t pos) override;
 	gxapi::DescriptorHandle At(size_t pos) override;
 private:
 	void Grow();
+	std::atomic<uint32_t>& Next(uint32_t pos);
+
+	// Free list head packs an ABA counter into the upper 32 bits, and the first free index into the lower 32 bits.
+	static uint64_t PackHead(uint32_t tag, uint32_t index) { return (uint64_t(tag) << 32) | index; }
+	static uint32_t HeadTag(uint64_t head) { return uint32_t(head >> 32); }
+	static uint32_t HeadIndex(uint64_t head) { return uint32_t(head); }
 
 protected:
 	gxapi::IGraphicsApi* const m_graphicsApi;
 private:
-	std::mutex m_listMutex;
-	std::unique_ptr<ChunkListItem> m_first;
-	size_t m_descriptorCount;
+	std::unique_ptr<std::atomic<Chunk*>[]> m_chunks;
+	std::atomic<size_t> m_chunkCount;
+	std::atomic<uint64_t> m_freeHead;
 
-	std::mutex m_allocMutex;
-	SlabAllocatorEngine m_allocEngine;
+	std::mutex m_growMutex;
 
 	const size_t heapDim;
 };
@@ -70,82 +82,100 @@ private:
 template <gxapi::eDescriptorHeapType HeapType>
 HostDescHeap<HeapType>::HostDescHeap(gxapi::IGraphicsApi* graphicsApi, size_t heapSize)
 	: m_graphicsApi(graphicsApi),
-	heapDim(heapSize),
-	m_allocEngine(0),
-	m_descriptorCount(0)
-{}
+	m_chunks(new std::atomic<Chunk*>[maxChunks]),
+	m_chunkCount(0),
+	m_freeHead(PackHead(0, emptyList)),
+	heapDim(heapSize)
+{
+	assert(heapSize * maxChunks < emptyList);
+	for (size_t i = 0; i < maxChunks; ++i) {
+		m_chunks[i] = nullptr;
+	}
+}
 
 template <gxapi::eDescriptorHeapType HeapType>
-size_t HostDescHeap<HeapType>::Allocate() {
-	try {
-		std::lock_guard<std::mutex> lkg(m_allocMutex);
-		return m_allocEngine.Allocate();
+HostDescHeap<HeapType>::~HostDescHeap() {
+	for (size_t i = 0; i < m_chunkCount; ++i) {
+		delete m_chunks[i].load();
 	}
-	catch (std::bad_alloc&) {
-		std::lock_guard<std::mutex> lkg(m_listMutex);
-		Grow();
-		return m_allocEngine.Allocate();
+}
+
+template <gxapi::eDescriptorHeapType HeapType>
+size_t HostDescHeap<HeapType>::Allocate() {
+	uint64_t head = m_freeHead.load(std::memory_order_acquire);
+	while (true) {
+		uint32_t index = HeadIndex(head);
+		if (index == emptyList) {
+			Grow();
+			head = m_freeHead.load(std::memory_order_acquire);
+			continue;
+		}
+
+		// Chunks are never freed, so reading the link is safe even if another thread pops the same index,
+		// the tag makes the exchange fail in that case.
+		uint32_t next = Next(index).load(std::memory_order_relaxed);
+		if (m_freeHead.compare_exchange_weak(head, PackHead(HeadTag(head) + 1, next), std::memory_order_acquire, std::memory_order_acquire)) {
+			return index;
+		}
 	}
 }
 
 template <gxapi::eDescriptorHeapType HeapType>
 void HostDescHeap<HeapType>::Deallocate(size_t pos) {
-	std::lock_guard<std::mutex> lkg(m_allocMutex);
-	m_allocEngine.Deallocate(pos);
+	assert(pos < m_chunkCount * heapDim);
+
+	uint32_t index = (uint32_t)pos;
+	uint64_t head = m_freeHead.load(std::memory_order_relaxed);
+	do {
+		Next(index).store(HeadIndex(head), std::memory_order_relaxed);
+	} while (!m_freeHead.compare_exchange_weak(head, PackHead(HeadTag(head) + 1, index), std::memory_order_release, std::memory_order_relaxed));
 }
 
 template <gxapi::eDescriptorHeapType HeapType>
 gxapi::DescriptorHandle HostDescHeap<HeapType>::At(size_t pos) {
-	assert(pos < m_descriptorCount);
+	assert(pos < m_chunkCount * heapDim);
 
-	// structure is like a 3D texture
-	const size_t chunkIdx = pos / (chunkDim*chunkDim); // z = i / (width*height)
-	const size_t heapIdx = (pos - chunkIdx*heapDim*chunkDim) / heapDim; // y = (i - z*width*height) / width
-	const size_t descIdx = (pos - chunkIdx*heapDim*chunkDim - heapIdx*heapDim) / 1; // x = (i - z*width*height - y*width) / 1
-
-	ChunkListItem* chunk = m_first.get();
-	for (size_t i = chunkIdx; i != 0; --i) {
-		chunk = chunk->next.get();
-	}
-
-	gxapi::IDescriptorHeap* heap = chunk->heaps[heapIdx].get();
-	gxapi::DescriptorHandle desc = heap->At(descIdx);
+	Chunk* chunk = m_chunks[pos / heapDim].load(std::memory_order_acquire);
+	return chunk->heap->At(pos % heapDim);
+}
 
-	return desc;
+template <gxapi::eDescriptorHeapType HeapType>
+std::atomic<uint32_t>& HostDescHeap<HeapType>::Next(uint32_t pos) {
+	Chunk* chunk = m_chunks[pos / heapDim].load(std::memory_order_acquire);
+	return chunk->next[pos % heapDim];
 }
 
 template <gxapi::eDescriptorHeapType HeapType>
 void HostDescHeap<HeapType>::Grow() {
-	ChunkListItem* chunk = m_first.get();
-
-	// if there aren't any chunks
-	if (chunk == nullptr) {
-		m_first = std::make_unique<ChunkListItem>();
-		chunk = m_first.get();
-	}
+	std::lock_guard<std::mutex> lkg(m_growMutex);
 
-	// find last chunk
-	while (chunk->next) {
-		chunk = chunk->next.get();
+	// someone else has grown the heap while we were waiting
+	if (HeadIndex(m_freeHead.load(std::memory_order_acquire)) != emptyList) {
+		return;
 	}
 
-	// find last heap
-	ptrdiff_t heapIdx = 0;
-	while (heapIdx < chunkDim && chunk->heaps[heapIdx]) {
-		++heapIdx;
+	size_t chunkIdx = m_chunkCount;
+	if (chunkIdx >= maxChunks) {
+		throw std::bad_alloc();
 	}
 
-	// add new chunk if needed
-	if (heapIdx >= chunkDim) {
-		chunk->next = std::make_unique<ChunkListItem>();
-		chunk = chunk->next.get();
-		heapIdx = 0;
+	// allocate new heap, and chain its descriptors into a list
+	auto chunk = std::make_unique<Chunk>();
+	chunk->heap.reset(m_graphicsApi->CreateDescriptorHeap({ HeapType, heapDim, false }));
+	chunk->next.reset(new std::atomic<uint32_t>[heapDim]);
+	const uint32_t first = uint32_t(chunkIdx * heapDim);
+	for (uint32_t i = 0; i < heapDim; ++i) {
+		chunk->next[i].store(first + i + 1, std::memory_order_relaxed);
 	}
-
-	// allocate new heap
-	chunk->heaps[heapIdx].reset(m_graphicsApi->CreateDescriptorHeap({ HeapType, heapDim, false }));
-	m_descriptorCount += heapDim;
-	m_allocEngine.Resize(m_descriptorCount);
+	Chunk* chunkPtr = chunk.release();
+	m_chunks[chunkIdx].store(chunkPtr, std::memory_order_release);
+	m_chunkCount = chunkIdx + 1;
+
+	// push the whole chain onto the free list, deallocations may have happened meanwhile
+	uint64_t head = m_freeHead.load(std::memory_order_relaxed);
+	do {
+		chunkPtr->next[heapDim - 1].store(HeadIndex(head), std::memory_order_relaxed);
+	} while (!m_freeHead.compare_exchange_weak(head, PackHead(HeadTag(head) + 1, first), std::memory_order_release, std::memory_order_relaxed));
 }
 
 
@@ -1,9 +1,28 @@
 #include "Image.hpp"
 
+#include <BaseLibrary/Exception/Exception.hpp>
+
 namespace inl {
 namespace gxeng {
 
 
+Image::Image(MemoryManager* memoryManager, CbvSrvUavHeap* descriptorHeap, BindlessTextureHeap* bindlessHeap)
+	: ImageBase(memoryManager, descriptorHeap),
+	m_bindlessHeap(bindlessHeap),
+	m_bindlessIndex(0)
+{
+	if (m_bindlessHeap) {
+		m_bindlessIndex = m_bindlessHeap->Allocate();
+	}
+}
+
+Image::~Image() {
+	if (m_bindlessHeap) {
+		m_bindlessHeap->Deallocate(m_bindlessIndex);
+	}
+}
+
+
 void Image::SetLayout(uint64_t width, uint32_t height, ePixelChannelType channelType, int channelCount, ePixelClass pixelClass) {
 	ImageBase::SetLayout(width, height, channelType, channelCount, pixelClass, 1);
 }
@@ -16,6 +35,13 @@ const TextureView2D& Image::GetSrv() {
 	return m_resourceView;
 }
 
+uint32_t Image::GetBindlessIndex() const {
+	if (!m_bindlessHeap) {
+		throw InvalidStateException("Image is not in the bindless texture table.");
+	}
+	return m_bindlessIndex;
+}
+
 
 void Image::CreateResourceView(const Texture2D& texture) {
 	gxapi::SrvTexture2DArray srvdesc;
@@ -26,6 +52,10 @@ void Image::CreateResourceView(const Texture2D& texture) {
 	srvdesc.numMipLevels = 1; // change this back to -1
 	srvdesc.planeIndex = 0;
 	m_resourceView = TextureView2D(texture, *m_descriptorHeap, texture.GetFormat(), srvdesc);
+
+	if (m_bindlessHeap) {
+		m_bindlessIndex = m_bindlessHeap->Update(m_bindlessIndex, m_resourceView.GetHandle());
+	}
 }
 
 
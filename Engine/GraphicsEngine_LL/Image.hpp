@@ -3,6 +3,7 @@
 #include <memory>
 
 #include "ImageBase.hpp"
+#include "BindlessTextureHeap.hpp"
 
 
 namespace inl {
@@ -11,7 +12,10 @@ namespace gxeng {
 
 class Image : public ImageBase {
 public:
-	Image(MemoryManager* memoryManager, CbvSrvUavHeap* descriptorHeap) : ImageBase(memoryManager, descriptorHeap) {}
+	Image(MemoryManager* memoryManager, CbvSrvUavHeap* descriptorHeap, BindlessTextureHeap* bindlessHeap = nullptr);
+	Image(const Image&) = delete;
+	Image& operator=(const Image&) = delete;
+	~Image();
 
 	/// <summary> Allocates the underlying GPU-resident texture. </summary>
 	/// <param name="width"> Width of the texture in pixels. </param>
@@ -34,11 +38,17 @@ public:
 	
 	const TextureView2D& GetSrv();
 
+	/// <summary> Index of the image in the bindless texture table. Changes when the texture is replaced, so read it when drawing. </summary>
+	/// <exception cref="inl::InvalidStateException"> If the image was created without a bindless heap. </exception>
+	uint32_t GetBindlessIndex() const;
+
 private:
 	void CreateResourceView(const Texture2D& texture) override;
 
 private:
 	TextureView2D m_resourceView;
+	BindlessTextureHeap* m_bindlessHeap;
+	uint32_t m_bindlessIndex;
 };
 
 
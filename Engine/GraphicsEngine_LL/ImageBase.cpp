@@ -1,4 +1,7 @@
 #include "ImageBase.hpp"
+#include "PixelConversion.hpp"
+
+#include <algorithm>
 
 namespace inl {
 namespace gxeng {
@@ -10,6 +13,7 @@ ImageBase::ImageBase(MemoryManager* memoryManager, CbvSrvUavHeap* descriptorHeap
 	m_descriptorHeap = descriptorHeap;
 
 	m_channelCount = 0;
+	m_storageChannelCount = 0;
 }
 
 
@@ -24,6 +28,9 @@ void ImageBase::SetLayout(uint64_t width, uint32_t height, ePixelChannelType cha
 	if (!ConvertFormat(channelType, channelCount, pixelClass, format, resultChCnt)) {
 		throw InvalidArgumentException("Unsupported texture format.");
 	}
+	if (IsBlockCompressed(channelType) && (width % 4 != 0 || height % 4 != 0)) {
+		throw InvalidArgumentException("Size of block compressed images must be a multiple of 4.");
+	}
 
 
 	Texture2DDesc resdesc(width, height, format, 0, arraySize);
@@ -34,6 +41,7 @@ void ImageBase::SetLayout(uint64_t width, uint32_t height, ePixelChannelType cha
 
 	m_resource = std::move(texture);
 	m_channelCount = channelCount;
+	m_storageChannelCount = resultChCnt;
 	m_channelType = channelType;
 	m_pixelClass = pixelClass;
 }
@@ -48,32 +56,40 @@ void ImageBase::Update(uint64_t x, uint32_t y, uint64_t width, uint32_t height,
 		throw OutOfRangeException("Destination region out of bounds.");
 	}
 
-	if (GetChannelCount() != 4 && reader.GetChannelCount() == 3) {
-		if (reader.GetChannelCount() != GetChannelCount()
-			|| reader.GetPixelClass() != GetPixelClass()
-			|| reader.GetChannelType() != GetChannelType())
+	if (IsBlockCompressed(m_channelType)) {
+		// Blocks are uploaded as they are, in whole blocks, except at the edges of the mip level.
+		uint64_t levelWidth = std::max<uint64_t>(1, GetWidth() >> mipLevel);
+		uint64_t levelHeight = std::max<uint64_t>(1, GetHeight() >> mipLevel);
+		if (reader.GetChannelType() != m_channelType) {
+			throw InvalidArgumentException("Block compressed images must be updated with blocks of the same format.");
+		}
+		if (x % 4 != 0 || y % 4 != 0
+			|| (width % 4 != 0 && x + width != levelWidth)
+			|| (height % 4 != 0 && y + height != levelHeight))
 		{
-			throw NotImplementedException("Pixel types mismatch, conversion is not supported yet (but will be).");
+			throw InvalidArgumentException("Block compressed images must be updated in whole 4x4 blocks.");
 		}
 	}
 
-	// Convert 3 channel pixels to 4 channels.
-	std::unique_ptr<uint8_t> pixels4;
-	if (reader.GetChannelCount() == 3) {
-		size_t structureSize = reader.StructureSize();
-		size_t structureSize4 = structureSize * 4 / 3;
-		size_t channelSize = structureSize / 3;
-		pixels4.reset(new uint8_t[structureSize4 * width * height]);
-		size_t dstPitch = width * structureSize4;
-		size_t srcPitch = bytesPerRow > 0 ? bytesPerRow : width * structureSize;
-		for (size_t y = 0; y < height; ++y) {
-			for (size_t x = 0; x < height; ++x) {
-				uint8_t* dst = pixels4.get() + (y * dstPitch + x * structureSize4);
-				memcpy(dst, (uint8_t*)pixels + (y * srcPitch + x * structureSize), structureSize);
-				memset(dst + structureSize, 0, channelSize);
-			}
+	// Convert pixels to the format of the texture.
+	PixelFormat sourceFormat{ reader.GetChannelType(), reader.GetChannelCount(), reader.GetPixelClass() };
+	PixelFormat storageFormat{ m_channelType, m_storageChannelCount, m_pixelClass };
+	if (sourceFormat.pixelClass != ePixelClass::SRGB && storageFormat.pixelClass != ePixelClass::SRGB) {
+		sourceFormat.pixelClass = storageFormat.pixelClass; // these are stored the same way
+	}
+
+	std::unique_ptr<uint8_t[]> convertedPixels;
+	if (!IsBlockCompressed(m_channelType) && sourceFormat != storageFormat) {
+		if (!PixelConverter::IsSupported(sourceFormat, storageFormat)) {
+			throw NotImplementedException("Pixel types mismatch, conversion between these formats is not supported.");
 		}
-		pixels = pixels4.get();
+		PixelConverter converter(sourceFormat, storageFormat);
+		size_t srcPitch = bytesPerRow > 0 ? bytesPerRow : width * sourceFormat.GetSize();
+		size_t dstPitch = width * storageFormat.GetSize();
+		convertedPixels.reset(new uint8_t[dstPitch * height]);
+		converter.Convert(pixels, srcPitch, convertedPixels.get(), dstPitch, width, height);
+		pixels = convertedPixels.get();
+		bytesPerRow = 0;
 	}
 
 	// Upload data to gpu.
@@ -128,9 +144,26 @@ ePixelClass ImageBase::GetPixelClass() const {
 bool ImageBase::ConvertFormat(ePixelChannelType channelType, int channelCount, ePixelClass pixelClass, gxapi::eFormat& fmt, int& resultingChannelCount) {
 	using gxapi::eFormat;
 
+	if (pixelClass == ePixelClass::SRGB
+		&& channelType != ePixelChannelType::INT8_NORM
+		&& channelType != ePixelChannelType::BC1
+		&& channelType != ePixelChannelType::BC3
+		&& channelType != ePixelChannelType::BC7)
+	{
+		return false;
+	}
+
 	switch (channelType) {
 		case ePixelChannelType::INT8_NORM:
 		{
+			if (pixelClass == ePixelClass::SRGB) {
+				if (channelCount < 3) {
+					return false;
+				}
+				fmt = eFormat::R8G8B8A8_UNORM_SRGB;
+				resultingChannelCount = 4;
+				return true;
+			}
 			eFormat arr[] = { eFormat::R8_UNORM, eFormat::R8G8_UNORM, eFormat::R8G8B8A8_UNORM , eFormat::R8G8B8A8_UNORM };
 			fmt = arr[channelCount - 1];
 			resultingChannelCount = channelCount == 3 ? 4 : channelCount;
@@ -157,6 +190,27 @@ bool ImageBase::ConvertFormat(ePixelChannelType channelType, int channelCount, e
 			resultingChannelCount = channelCount;
 			return true;
 		}
+		// Blocks always hold the channels of their format.
+		case ePixelChannelType::BC1:
+			fmt = pixelClass == ePixelClass::SRGB ? eFormat::BC1_UNORM_SRGB : eFormat::BC1_UNORM;
+			resultingChannelCount = 4;
+			return true;
+		case ePixelChannelType::BC3:
+			fmt = pixelClass == ePixelClass::SRGB ? eFormat::BC3_UNORM_SRGB : eFormat::BC3_UNORM;
+			resultingChannelCount = 4;
+			return true;
+		case ePixelChannelType::BC4:
+			fmt = eFormat::BC4_UNORM;
+			resultingChannelCount = 1;
+			return true;
+		case ePixelChannelType::BC5:
+			fmt = eFormat::BC5_UNORM;
+			resultingChannelCount = 2;
+			return true;
+		case ePixelChannelType::BC7:
+			fmt = pixelClass == ePixelClass::SRGB ? eFormat::BC7_UNORM_SRGB : eFormat::BC7_UNORM;
+			resultingChannelCount = 4;
+			return true;
 	}
 
 	return false;
@@ -51,7 +51,9 @@ protected:
 	/// <param name="pixels"> A pointer to the bytes representing the pixels. Use <see cref="Pixel"/> as helper. </param>
 	/// <param name="reader"> Interprets byte stream. Implement <see cref="IPixelReader"/> or use <see cref="Pixel::Reader"/>. </param>
 	/// <param name="bytesPerRow"> How many bytes to skip in <paramref name="pixels"/> for each row. Leave as 0 for no row padding. </param>
-	/// <remarks> As you can't create multi-planed textures, uploading to specific plane is not supported. </remarks>
+	/// <remarks> Pixels of a different format than the image's are converted, see <see cref="PixelConverter"/>.
+	/// Block compressed images take <see cref="CompressedBlock"/>s of the same format, in whole blocks.
+	/// As you can't create multi-planed textures, uploading to specific plane is not supported. </remarks>
 	void Update(uint64_t x, uint32_t y, uint64_t width, uint32_t height, unsigned mipLevel, unsigned arrayIdx, const void* pixels, const IPixelReader& reader, size_t bytesPerRow = 0);
 
 	/// <summary> Converts simplified pixel format to GraphicsAPI format. </summary>
@@ -67,6 +69,7 @@ private:
 	Texture2D m_resource;
 	ePixelChannelType m_channelType;
 	int m_channelCount;
+	int m_storageChannelCount; // 3 channel textures may be stored with 4 channels
 	ePixelClass m_pixelClass;
 	MemoryManager* m_memoryManager;
 };
@@ -0,0 +1,286 @@
+#include "LightweightEventDispatcher.hpp"
+#include <BaseLibrary/ThreadName.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+
+namespace inl {
+namespace gxeng {
+
+
+static_assert((LightweightEventDispatcher::QueueSize & (LightweightEventDispatcher::QueueSize - 1)) == 0, "Queue size must be a power of two.");
+
+// How many times threads check for work before going to sleep.
+static constexpr int SpinCount = 64;
+
+
+//------------------------------------------------------------------------------
+// Ring
+//------------------------------------------------------------------------------
+
+LightweightEventDispatcher::EventRing::EventRing()
+	: m_slots(new Slot[QueueSize]),
+	m_pushPosition(0),
+	m_popPosition(0)
+{
+	for (size_t i = 0; i < QueueSize; ++i) {
+		m_slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+
+bool LightweightEventDispatcher::EventRing::TryPush(const Event& event, uint64_t& position) {
+	uint64_t pos = m_pushPosition.load(std::memory_order_relaxed);
+	for (;;) {
+		Slot& slot = m_slots[pos & (QueueSize - 1)];
+		uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+		int64_t diff = (int64_t)sequence - (int64_t)pos;
+		if (diff == 0) {
+			if (m_pushPosition.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				slot.event = event;
+				slot.sequence.store(pos + 1, std::memory_order_release);
+				position = pos;
+				return true;
+			}
+		}
+		else if (diff < 0) {
+			return false; // slot of the previous lap is not consumed yet
+		}
+		else {
+			pos = m_pushPosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+
+bool LightweightEventDispatcher::EventRing::TryPop(Event& event) {
+	uint64_t pos = m_popPosition.load(std::memory_order_relaxed);
+	for (;;) {
+		Slot& slot = m_slots[pos & (QueueSize - 1)];
+		uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+		int64_t diff = (int64_t)sequence - (int64_t)(pos + 1);
+		if (diff == 0) {
+			if (m_popPosition.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				event = std::move(slot.event);
+				slot.event.premise = {}; // don't keep the fence alive
+				slot.sequence.store(pos + QueueSize, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (diff < 0) {
+			return false;
+		}
+		else {
+			pos = m_popPosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+
+bool LightweightEventDispatcher::EventRing::Empty() const {
+	uint64_t pos = m_popPosition.load(std::memory_order_relaxed);
+	const Slot& slot = m_slots[pos & (QueueSize - 1)];
+	return slot.sequence.load(std::memory_order_acquire) != pos + 1;
+}
+
+
+//------------------------------------------------------------------------------
+// Channel
+//------------------------------------------------------------------------------
+
+uint64_t LightweightEventDispatcher::Channel::Push(const Event& event) {
+	uint64_t position;
+	while (!ring.TryPush(event, position)) {
+		std::this_thread::yield(); // consumer is far behind, wait for a free slot
+	}
+
+	// Pairs with the fence in Pop: either we see the consumer sleeping, or it sees the event.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (consumerSleeping.load(std::memory_order_relaxed)) {
+		Wake();
+	}
+	return position;
+}
+
+
+bool LightweightEventDispatcher::Channel::Pop(Event& event, const std::atomic_bool& run) {
+	for (;;) {
+		for (int i = 0; i < SpinCount; ++i) {
+			if (ring.TryPop(event)) {
+				return true;
+			}
+			if (!run) {
+				return false;
+			}
+		}
+
+		consumerSleeping.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		{
+			std::unique_lock<std::mutex> lk(mutex);
+			cv.wait(lk, [this, &run] { return !ring.Empty() || !run; });
+		}
+		consumerSleeping.store(false, std::memory_order_relaxed);
+	}
+}
+
+
+void LightweightEventDispatcher::Channel::Wake() {
+	std::lock_guard<std::mutex> lkg(mutex);
+	cv.notify_all();
+}
+
+
+//------------------------------------------------------------------------------
+// Dispatcher
+//------------------------------------------------------------------------------
+
+LightweightEventDispatcher::LightweightEventDispatcher()
+	: m_epoch(0),
+	m_numDispatched(0),
+	m_numEpochWaiters(0),
+	m_run(true)
+{
+	m_deviceSyncThread = std::thread(&LightweightEventDispatcher::DeviceSyncThread, this);
+	m_eventThread = std::thread(&LightweightEventDispatcher::DispatchThread, this);
+}
+
+
+LightweightEventDispatcher::~LightweightEventDispatcher() noexcept {
+	Shutdown();
+}
+
+
+void LightweightEventDispatcher::Shutdown() {
+	m_run = false;
+	if (m_deviceSyncThread.joinable()) {
+		m_deviceEvents.Wake();
+		m_deviceSyncThread.join();
+	}
+	if (m_eventThread.joinable()) {
+		m_hostEvents.Wake();
+		m_eventThread.join();
+	}
+}
+
+
+uint64_t LightweightEventDispatcher::DispatchFrameBegin(uint64_t frameId) {
+	++m_numDispatched;
+	return m_hostEvents.Push({ eEventType::FRAME_BEGIN_HOST, frameId }) + 1;
+}
+
+uint64_t LightweightEventDispatcher::DispatchFrameEnd(uint64_t frameId) {
+	++m_numDispatched;
+	return m_hostEvents.Push({ eEventType::FRAME_COMPLETE_HOST, frameId }) + 1;
+}
+
+uint64_t LightweightEventDispatcher::DispatchFrameBeginAwait(uint64_t frameId) {
+	++m_numDispatched;
+	return m_hostEvents.Push({ eEventType::FRAME_BEGIN_AWAIT, frameId }) + 1;
+}
+
+
+void LightweightEventDispatcher::DispatchDeviceFrameBegin(SyncPoint deviceEvent, uint64_t frameId) {
+	++m_numDispatched;
+	m_deviceEvents.Push({ eEventType::FRAME_BEGIN_DEVICE, frameId, std::move(deviceEvent) });
+}
+
+void LightweightEventDispatcher::DispatchDeviceFrameEnd(SyncPoint deviceEvent, uint64_t frameId) {
+	++m_numDispatched;
+	m_deviceEvents.Push({ eEventType::FRAME_COMPLETE_DEVICE, frameId, std::move(deviceEvent) });
+}
+
+
+uint64_t LightweightEventDispatcher::GetEpoch() const {
+	return m_epoch.load(std::memory_order_acquire);
+}
+
+
+uint64_t LightweightEventDispatcher::GetLastEpoch() const {
+	return m_numDispatched.load(std::memory_order_acquire);
+}
+
+
+void LightweightEventDispatcher::WaitEpoch(uint64_t epoch) const {
+	for (int i = 0; i < SpinCount; ++i) {
+		if (GetEpoch() >= epoch) {
+			return;
+		}
+		std::this_thread::yield();
+	}
+
+	++m_numEpochWaiters;
+	{
+		std::unique_lock<std::mutex> lk(m_epochMutex);
+		m_epochCv.wait(lk, [this, epoch] { return GetEpoch() >= epoch; });
+	}
+	--m_numEpochWaiters;
+}
+
+
+void LightweightEventDispatcher::operator+=(PipelineEventListener* listener) {
+	std::lock_guard<std::mutex> lkg(m_listenerMutex);
+	if (std::find(m_listeners.begin(), m_listeners.end(), listener) == m_listeners.end()) {
+		m_listeners.push_back(listener);
+	}
+}
+
+
+void LightweightEventDispatcher::operator-=(PipelineEventListener* listener) {
+	std::lock_guard<std::mutex> lkg(m_listenerMutex);
+	m_listeners.erase(std::remove(m_listeners.begin(), m_listeners.end(), listener), m_listeners.end());
+}
+
+
+void LightweightEventDispatcher::DispatchThread() {
+	SetCurrentThreadName("Event Dispatcher Thread");
+
+	Event event;
+	while (m_hostEvents.Pop(event, m_run)) {
+		Deliver(event);
+
+		// Seq-cst pairs with the increment in WaitEpoch: either we see the waiter, or it sees the new epoch.
+		m_epoch.fetch_add(1, std::memory_order_seq_cst);
+		if (m_numEpochWaiters.load(std::memory_order_seq_cst) > 0) {
+			std::lock_guard<std::mutex> lkg(m_epochMutex);
+			m_epochCv.notify_all();
+		}
+	}
+}
+
+
+void LightweightEventDispatcher::DeviceSyncThread() {
+	SetCurrentThreadName("Event Dispatcher: Device Sync Thread");
+
+	Event event;
+	while (m_deviceEvents.Pop(event, m_run)) {
+		event.premise.Wait();
+		event.premise = {};
+		m_hostEvents.Push(event);
+	}
+}
+
+
+void LightweightEventDispatcher::Deliver(const Event& event) {
+	std::lock_guard<std::mutex> listenerLock(m_listenerMutex);
+
+	for (auto listener : m_listeners) {
+		try {
+			switch (event.type) {
+				case eEventType::FRAME_BEGIN_AWAIT: listener->OnFrameBeginAwait(event.frameId); break;
+				case eEventType::FRAME_BEGIN_HOST: listener->OnFrameBeginHost(event.frameId); break;
+				case eEventType::FRAME_COMPLETE_HOST: listener->OnFrameCompleteHost(event.frameId); break;
+				case eEventType::FRAME_BEGIN_DEVICE: listener->OnFrameBeginDevice(event.frameId); break;
+				case eEventType::FRAME_COMPLETE_DEVICE: listener->OnFrameCompleteDevice(event.frameId); break;
+			}
+		}
+		catch (...) {
+			assert(false); // should log instead
+		}
+	}
+}
+
+
+} // namespace gxeng
+} // namespace inl
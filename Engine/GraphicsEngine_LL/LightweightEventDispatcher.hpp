@@ -0,0 +1,135 @@
+#pragma once
+
+#include "SyncPoint.hpp"
+#include "PipelineEventListener.hpp"
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+
+
+namespace inl {
+namespace gxeng {
+
+
+/// <summary>
+/// Delivers pipeline events to listeners on a background thread, like the <see cref="PipelineEventDispatcher"/>,
+/// but without allocating per event.
+/// <para />
+/// Events are small records copied into preallocated slots of a lock-free ring. Each delivered host event
+/// increments the epoch counter, so instead of futures, dispatching returns the epoch at which the event is done.
+/// Callers can poll <see cref="GetEpoch"/> or block in <see cref="WaitEpoch"/>.
+/// </summary>
+/// <remarks>
+/// Listeners are called on a single thread, in dispatch order. Device events are delivered after their
+/// sync point is reached, then they count towards the epoch like host events.
+/// Threads only sleep and wake through the kernel when there is nothing to do, or somebody waits on the epoch.
+/// </remarks>
+class LightweightEventDispatcher {
+public:
+	/// <summary> Number of event slots. Dispatching more events than this ahead of the listeners blocks. </summary>
+	static constexpr size_t QueueSize = 256;
+public:
+	LightweightEventDispatcher();
+	LightweightEventDispatcher(const LightweightEventDispatcher&) = delete;
+	LightweightEventDispatcher& operator=(const LightweightEventDispatcher&) = delete;
+	~LightweightEventDispatcher() noexcept;
+
+	/// <returns> The epoch when listeners have received the event. </returns>
+	uint64_t DispatchFrameBegin(uint64_t frameId);
+	/// <returns> The epoch when listeners have received the event. </returns>
+	uint64_t DispatchFrameEnd(uint64_t frameId);
+	/// <returns> The epoch when listeners have received the event. </returns>
+	uint64_t DispatchFrameBeginAwait(uint64_t frameId);
+	void DispatchDeviceFrameBegin(SyncPoint deviceEvent, uint64_t frameId);
+	void DispatchDeviceFrameEnd(SyncPoint deviceEvent, uint64_t frameId);
+
+	/// <summary> The number of events that have been delivered to all listeners. </summary>
+	uint64_t GetEpoch() const;
+
+	/// <summary> The epoch when listeners have received every event dispatched so far, including device events. </summary>
+	/// <remarks> Device events are only delivered once their sync point is reached. </remarks>
+	uint64_t GetLastEpoch() const;
+
+	/// <summary> Blocks until the epoch reaches <paramref name="epoch"/>. </summary>
+	void WaitEpoch(uint64_t epoch) const;
+
+	void operator+=(PipelineEventListener* listener);
+	void operator-=(PipelineEventListener* listener);
+private:
+	enum class eEventType : uint8_t {
+		FRAME_BEGIN_AWAIT,
+		FRAME_BEGIN_HOST,
+		FRAME_COMPLETE_HOST,
+		FRAME_BEGIN_DEVICE,
+		FRAME_COMPLETE_DEVICE,
+	};
+
+	struct Event {
+		eEventType type;
+		uint64_t frameId;
+		SyncPoint premise; // only for device events
+	};
+
+	/// <summary> Bounded multi-producer multi-consumer ring. Every slot carries a sequence number,
+	///		which tells whether it's ready to be written or read in the current lap. </summary>
+	class EventRing {
+	public:
+		EventRing();
+		/// <summary> Returns false if the ring is full. </summary>
+		bool TryPush(const Event& event, uint64_t& position);
+		/// <summary> Returns false if the ring is empty. </summary>
+		bool TryPop(Event& event);
+		bool Empty() const;
+	private:
+		struct Slot {
+			std::atomic<uint64_t> sequence;
+			Event event;
+		};
+		std::unique_ptr<Slot[]> m_slots;
+		alignas(64) std::atomic<uint64_t> m_pushPosition;
+		alignas(64) std::atomic<uint64_t> m_popPosition;
+	};
+
+	/// <summary> A ring with a single consumer thread that sleeps while the ring is empty. </summary>
+	struct Channel {
+		EventRing ring;
+		std::atomic_bool consumerSleeping{ false };
+		std::mutex mutex;
+		std::condition_variable cv;
+
+		uint64_t Push(const Event& event);
+		/// <summary> Returns false if the dispatcher is shutting down. </summary>
+		bool Pop(Event& event, const std::atomic_bool& run);
+		void Wake();
+	};
+private:
+	void DispatchThread();
+	void DeviceSyncThread();
+	void Deliver(const Event& event);
+	void Shutdown();
+private:
+	Channel m_hostEvents;
+	Channel m_deviceEvents;
+
+	std::atomic<uint64_t> m_epoch;
+	std::atomic<uint64_t> m_numDispatched; // Each event, host or device, increments the epoch once.
+	mutable std::atomic<uint32_t> m_numEpochWaiters;
+	mutable std::mutex m_epochMutex;
+	mutable std::condition_variable m_epochCv;
+
+	std::mutex m_listenerMutex;
+	std::vector<PipelineEventListener*> m_listeners;
+
+	std::atomic_bool m_run;
+	std::thread m_eventThread;
+	std::thread m_deviceSyncThread;
+};
+
+
+} // namespace gxeng
+} // namespace inl
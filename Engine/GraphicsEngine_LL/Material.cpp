@@ -1,5 +1,10 @@
 #include "Material.hpp"
+#include "MemoryManager.hpp"
+#include "Image.hpp"
 #include <stack>
+#include <mutex>
+#include <sstream>
+#include <algorithm>
 
 
 
@@ -16,17 +21,25 @@ std::string MaterialShader::LoadShaderSource(std::string name) const {
 }
 
 std::vector<MaterialShaderParameter> MaterialShader::GetShaderParameters() const {
-	std::vector<MaterialShaderParameter> params;
-	eMaterialShaderParamType ret;
-	ExtractShaderParameters(GetShaderCode(), "main", ret, params);
-	return params;
+	return m_parameters;
 }
 
 eMaterialShaderParamType MaterialShader::GetShaderOutputType() const {
+	return m_outputType;
+}
+
+
+void MaterialShader::UpdateCompiled() {
+	std::string code = GetShaderCode();
+
 	std::vector<MaterialShaderParameter> params;
 	eMaterialShaderParamType ret;
-	ExtractShaderParameters(GetShaderCode(), "main", ret, params);
-	return ret;
+	ExtractShaderParameters(code, "main", ret, params);
+
+	m_hash = std::hash<std::string>()(code);
+	m_id = InternCode(code, m_hash);
+	m_parameters = std::move(params);
+	m_outputType = ret;
 }
 
 
@@ -53,10 +66,12 @@ std::string MaterialShaderEquation::GetShaderCode() const {
 
 void MaterialShaderEquation::SetSourceName(const std::string& name) {
 	m_source = LoadShaderSource(name);
+	UpdateCompiled();
 }
 
 void MaterialShaderEquation::SetSourceCode(const std::string& code) {
 	m_source = code;
+	UpdateCompiled();
 }
 
 
@@ -85,7 +100,8 @@ void MaterialShaderGraph::AssembleShaderCode() {
 	for (size_t i = 0; i < m_nodes.size(); ++i) {
 		MaterialShader* shader = m_nodes[i].get();
 		functions[i] = shader->GetShaderCode();
-		ExtractShaderParameters(functions[i], "main", shaderNodeReturns[i], shaderNodeParams[i]);
+		shaderNodeReturns[i] = shader->GetShaderOutputType();
+		shaderNodeParams[i] = shader->GetShaderParameters();
 
 		for (auto p : shaderNodeParams[i]) {
 			if (p.type == eMaterialShaderParamType::UNKNOWN) {
@@ -163,7 +179,7 @@ void MaterialShaderGraph::AssembleShaderCode() {
 		std::stringstream ss;
 		ss << "main_" << topologicalOrder.size();
 		shaderNodes[node].SetFunctionName(ss.str());
-		functions[node] = std::regex_replace(functions[node], std::regex("main"), ss.str());
+		functions[node] = RenameIdentifier(functions[node], "main", ss.str());
 		topologicalOrder.push_back(node);
 		shaderNodes[node].SetFunctionReturn(GetParameterString(shaderNodeReturns[node]));
 	};
@@ -207,6 +223,7 @@ void MaterialShaderGraph::AssembleShaderCode() {
 
 
 	m_source = finalCode.str();
+	UpdateCompiled();
 }
 
 void MaterialShaderGraph::SetGraph(std::vector<std::unique_ptr<MaterialShader>> nodes, std::vector<Link> links) {
@@ -223,115 +240,88 @@ void MaterialShaderGraph::SetGraph(std::vector<std::unique_ptr<MaterialShader>>
 //------------------------------------------------------------------------------
 
 
-std::string MaterialShader::RemoveComments(std::string code) {
-	std::stringstream ss(code);
-
-	// remove single line comments by trimming commented-out tails, line-by-line
-	std::string noSingleLine;
-	std::string singleLine;
-	while (std::getline(ss, singleLine)) {
-		size_t idx = singleLine.find_first_of("//");
-		if (idx != singleLine.npos) {
-			singleLine = singleLine.substr(0, idx - 1);
-		}
-		noSingleLine += singleLine;
-	}
-
-	// remove multiline comments by replacing regex template " /*anything*/ " to empty string
-	std::stringstream noComment;
-	std::regex multilinePattern(R"(/\*.*\*/)");
-	std::regex_replace(std::ostreambuf_iterator<char>(noComment), noSingleLine.begin(), noSingleLine.end(), multilinePattern, "");
-
-	std::string ret = noComment.str();
-	return ret;
-}
-
-
-std::string MaterialShader::FindFunctionSignature(std::string code, const std::string& functionName) {
-	// regex to match " functionName ( anything ) { " 
-	std::regex signaturePattern(functionName + R"(\s*\(.*\)\s*\{)");
-
-	// find matches
-	std::smatch matches;
-	if (!std::regex_search(code, matches, signaturePattern)) {
-		throw InvalidArgumentException("No main function found in material shader.");
-	}
-
-	// march back towards return type over whitespaces
-	intptr_t matchIdx = matches[0].first - code.cbegin();
-	matchIdx -= 1;
-	while (matchIdx >= 0 && isspace(code[matchIdx])) {
-		--matchIdx;
-	}
-
-	// march back over return type's characters
-	intptr_t returnIdx = matchIdx;
-	while (returnIdx >= 0 && !isspace(code[returnIdx])) {
-		--returnIdx;
-	}
-	returnIdx = std::max(intptr_t(0), returnIdx);
-
-	// return type spans across range [returnIdx, matchIdx], it being empty range means failure
-	if (matchIdx == returnIdx) {
-		throw InvalidArgumentException("Main function has no return type.");
-	}
-
-	// walk back from match's end until ')'
-	intptr_t matchEndIdx = matches[0].second - code.begin();
-	while (code[matchEndIdx] != ')') {
-		matchEndIdx--;
-	}
-	++matchEndIdx;
-
-	return code.substr(returnIdx, matchEndIdx - returnIdx);
-}
+std::vector<MaterialShaderToken> MaterialShader::Tokenize(const std::string& code) {
+	std::vector<MaterialShaderToken> tokens;
 
+	auto IsIdentifierStart = [](char c) { return isalpha((unsigned char)c) || c == '_'; };
+	auto IsIdentifierChar = [](char c) { return isalnum((unsigned char)c) || c == '_'; };
 
-void MaterialShader::SplitFunctionSignature(std::string signature, std::string& returnType, std::vector<std::pair<std::string, std::string>>& parameters) {
-	// extract part between the parentheses
-	size_t opening = signature.find_first_of('(');
-	size_t closing = signature.find_first_of(')');
-	std::stringstream paramString(signature.substr(opening + 1, closing - opening - 1));
+	size_t pos = 0;
+	const size_t size = code.size();
+	while (pos < size) {
+		char c = code[pos];
 
-	// split the parameters string to individual parameters, and process them
-	std::string param;
-	while (getline(paramString, param, ',')) {
-		if (param.size() == 0) {
-			throw InvalidArgumentException("Parameter of main has zero characters.");
+		// whitespaces
+		if (isspace((unsigned char)c)) {
+			++pos;
 		}
-		// trim leading and trailing whitespaces
-		intptr_t firstChar = 0;
-		while (firstChar < (intptr_t)param.size() && isspace(param[firstChar])) {
-			++firstChar;
+		// single line comments
+		else if (c == '/' && pos + 1 < size && code[pos + 1] == '/') {
+			pos = code.find('\n', pos);
+			pos = pos == code.npos ? size : pos + 1;
 		}
-		intptr_t lastChar = param.size() - 1;
-		while (lastChar >= firstChar && isspace(param[lastChar])) {
-			--lastChar;
+		// multi line comments
+		else if (c == '/' && pos + 1 < size && code[pos + 1] == '*') {
+			pos = code.find("*/", pos + 2);
+			pos = pos == code.npos ? size : pos + 2;
 		}
-		if (firstChar >= lastChar) {
-			throw InvalidArgumentException("Parameter of main has no type specifier or declaration name.");
+		// identifiers and keywords
+		else if (IsIdentifierStart(c)) {
+			size_t end = pos + 1;
+			while (end < size && IsIdentifierChar(code[end])) {
+				++end;
+			}
+			tokens.push_back({ MaterialShaderToken::IDENTIFIER, pos, end - pos });
+			pos = end;
 		}
-		param = param.substr(firstChar, lastChar-firstChar+1);
-
-		// split param to type and name
-		firstChar = 0;
-		while (!isspace(param[firstChar])) {
-			++firstChar;
+		// numeric literals, including suffixes like 1.0f or 0x1Fu
+		else if (isdigit((unsigned char)c) || (c == '.' && pos + 1 < size && isdigit((unsigned char)code[pos + 1]))) {
+			size_t end = pos + 1;
+			while (end < size && (IsIdentifierChar(code[end]) || code[end] == '.')) {
+				++end;
+			}
+			tokens.push_back({ MaterialShaderToken::NUMBER, pos, end - pos });
+			pos = end;
 		}
-		lastChar = param.size() - 1;
-		while (!isspace(param[lastChar])) {
-			--lastChar;
+		// string literals, used by includes
+		else if (c == '"') {
+			size_t end = pos + 1;
+			while (end < size && code[end] != '"' && code[end] != '\n') {
+				end += code[end] == '\\' ? 2 : 1;
+			}
+			end = std::min(end + 1, size);
+			tokens.push_back({ MaterialShaderToken::STRING, pos, end - pos });
+			pos = end;
+		}
+		// everything else is a single character of punctuation
+		else {
+			tokens.push_back({ MaterialShaderToken::PUNCTUATION, pos, 1 });
+			++pos;
 		}
-
-		parameters.push_back({ param.substr(0, firstChar), param.substr(lastChar + 1, param.npos) });
 	}
 
-	// get return type
-	intptr_t lastChar = 0;
-	while (!isspace(signature[lastChar])) {
-		++lastChar;
+	return tokens;
+}
+
+
+std::string MaterialShader::RenameIdentifier(const std::string& code, const std::string& identifier, const std::string& newName) {
+	std::string result;
+	result.reserve(code.size());
+
+	size_t copied = 0;
+	for (const auto& token : Tokenize(code)) {
+		if (token.kind == MaterialShaderToken::IDENTIFIER
+			&& token.length == identifier.size()
+			&& code.compare(token.offset, token.length, identifier) == 0)
+		{
+			result.append(code, copied, token.offset - copied);
+			result += newName;
+			copied = token.offset + token.length;
+		}
 	}
-	returnType = signature.substr(0, lastChar);
+	result.append(code, copied, code.npos);
+
+	return result;
 }
 
 
@@ -364,29 +354,124 @@ eMaterialShaderParamType MaterialShader::GetParameterType(std::string typeString
 }
 
 
-void MaterialShader::ExtractShaderParameters(std::string code, const std::string& functionName, eMaterialShaderParamType& returnType, std::vector<MaterialShaderParameter>& parameters) {
-	code = RemoveComments(code);
-	std::string signature = FindFunctionSignature(code, functionName);
+void MaterialShader::ExtractShaderParameters(const std::string& code, const std::string& functionName, eMaterialShaderParamType& returnType, std::vector<MaterialShaderParameter>& parameters) {
+	std::vector<MaterialShaderToken> tokens = Tokenize(code);
+
+	auto IsPunctuation = [&](size_t index, char c) {
+		return index < tokens.size() && tokens[index].kind == MaterialShaderToken::PUNCTUATION && code[tokens[index].offset] == c;
+	};
+	auto TokenString = [&](size_t index) {
+		return code.substr(tokens[index].offset, tokens[index].length);
+	};
+
+	// find " functionName ( anything ) { "
+	size_t nameIdx = 0, openingIdx = 0, closingIdx = 0;
+	bool found = false;
+	for (size_t i = 0; i < tokens.size() && !found; ++i) {
+		if (tokens[i].kind != MaterialShaderToken::IDENTIFIER
+			|| tokens[i].length != functionName.size()
+			|| code.compare(tokens[i].offset, tokens[i].length, functionName) != 0
+			|| !IsPunctuation(i + 1, '('))
+		{
+			continue;
+		}
+
+		// find matching parenthesis
+		size_t depth = 0;
+		size_t j = i + 1;
+		for (; j < tokens.size(); ++j) {
+			if (IsPunctuation(j, '(')) {
+				++depth;
+			}
+			else if (IsPunctuation(j, ')') && --depth == 0) {
+				break;
+			}
+		}
 
-	std::string returnTypeStr;
-	std::vector<std::pair<std::string, std::string>> paramList;
-	SplitFunctionSignature(signature, returnTypeStr, paramList);
+		if (IsPunctuation(j + 1, '{')) {
+			nameIdx = i;
+			openingIdx = i + 1;
+			closingIdx = j;
+			found = true;
+		}
+	}
+	if (!found) {
+		throw InvalidArgumentException("No main function found in material shader.");
+	}
 
-	returnType = GetParameterType(returnTypeStr);
+	// return type is the word right before the name
+	if (nameIdx == 0 || tokens[nameIdx - 1].kind != MaterialShaderToken::IDENTIFIER) {
+		throw InvalidArgumentException("Main function has no return type.");
+	}
+	returnType = GetParameterType(TokenString(nameIdx - 1));
 
-	// collect results
+	// split the parameter list at top-level commas, and process the parameters
 	std::vector<MaterialShaderParameter> params;
-	for (const auto& p : paramList) {
-		MaterialShaderParameter param;
-		param.type = GetParameterType(p.first);
-		param.name = p.second;
-		params.push_back(param);
+	if (closingIdx > openingIdx + 1) {
+		size_t paramBegin = openingIdx + 1;
+		size_t depth = 0;
+		for (size_t i = openingIdx + 1; i <= closingIdx; ++i) {
+			if (i != closingIdx) {
+				if (IsPunctuation(i, '(')) {
+					++depth;
+				}
+				else if (IsPunctuation(i, ')')) {
+					--depth;
+				}
+				if (depth > 0 || !IsPunctuation(i, ',')) {
+					continue;
+				}
+			}
+
+			if (paramBegin == i) {
+				throw InvalidArgumentException("Parameter of main has zero characters.");
+			}
+
+			// type is the first word, name is the last word before the semantic or default value
+			size_t nameEnd = paramBegin;
+			while (nameEnd < i && !IsPunctuation(nameEnd, ':') && !IsPunctuation(nameEnd, '=')) {
+				++nameEnd;
+			}
+			if (nameEnd - paramBegin < 2
+				|| tokens[paramBegin].kind != MaterialShaderToken::IDENTIFIER
+				|| tokens[nameEnd - 1].kind != MaterialShaderToken::IDENTIFIER)
+			{
+				throw InvalidArgumentException("Parameter of main has no type specifier or declaration name.");
+			}
+
+			MaterialShaderParameter param;
+			param.type = GetParameterType(TokenString(paramBegin));
+			param.name = TokenString(nameEnd - 1);
+			params.push_back(param);
+
+			paramBegin = i + 1;
+		}
 	}
 
 	parameters = std::move(params);
 }
 
 
+uint32_t MaterialShader::InternCode(const std::string& code, size_t hash) {
+	static std::mutex mtx;
+	static std::unordered_multimap<size_t, std::pair<std::string, uint32_t>> codes;
+	static uint32_t nextId = 1; // 0 is reserved for "no code yet"
+
+	std::lock_guard<std::mutex> lkg(mtx);
+
+	auto range = codes.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it) {
+		if (it->second.first == code) {
+			return it->second.second;
+		}
+	}
+
+	uint32_t id = nextId++;
+	codes.insert({ hash, { code, id } });
+	return id;
+}
+
+
 
 //------------------------------------------------------------------------------
 // ShaderNode
@@ -451,6 +536,7 @@ Material::Parameter::Parameter() {
 }
 Material::Parameter::Parameter(eMaterialShaderParamType type) {
 	m_type = type;
+	m_data.image = nullptr;
 }
 
 
@@ -460,6 +546,9 @@ Material::Parameter& Material::Parameter::operator=(Image* image) {
 	}
 
 	m_data.image = image;
+	if (m_owner) {
+		m_owner->OnParameterChanged(*this);
+	}
 	return *this;
 }
 
@@ -469,6 +558,9 @@ Material::Parameter& Material::Parameter::operator=(Vec4 color) {
 	}
 
 	m_data.color = color;
+	if (m_owner) {
+		m_owner->OnParameterChanged(*this);
+	}
 	return *this;
 }
 
@@ -478,6 +570,9 @@ Material::Parameter& Material::Parameter::operator=(float value) {
 	}
 
 	m_data.value = value;
+	if (m_owner) {
+		m_owner->OnParameterChanged(*this);
+	}
 	return *this;
 }
 
@@ -510,6 +605,11 @@ Material::Parameter::operator float() const {
 
 
 
+Material::Material(MemoryManager* memoryManager, CbvSrvUavHeap* viewHeap)
+	: m_memoryManager(memoryManager), m_viewHeap(viewHeap)
+{}
+
+
 void Material::SetShader(MaterialShader* shader) {
 	m_shader = shader;
 	auto params = m_shader->GetShaderParameters();
@@ -517,8 +617,12 @@ void Material::SetShader(MaterialShader* shader) {
 	m_paramNameMap.clear();
 	for (auto p : params) {
 		m_parameters.push_back(Parameter{ p.type });
+		m_parameters.back().m_owner = this;
 		m_paramNameMap.insert({ p.name, m_parameters.size() - 1 });
 	}
+
+	CalculateConstantLayout(params, m_constantOffsets, m_constantsSize);
+	m_constantsDirty = true;
 }
 
 size_t Material::GetParameterCount() const {
@@ -548,4 +652,125 @@ const Material::Parameter& Material::operator[](const std::string& name) const {
 }
 
 
+ConstBufferView Material::GetConstantBuffer() {
+	std::lock_guard<std::mutex> lkg(m_constantsMutex);
+
+	if (m_constantsSize == 0) {
+		return {};
+	}
+	if (m_memoryManager == nullptr || m_viewHeap == nullptr) {
+		throw InvalidStateException("Material was not created by the graphics engine, it has no GPU memory.");
+	}
+	ConstantBufferHeap& constBufferHeap = m_memoryManager->GetConstBufferHeap();
+
+	if (!m_constantsDirty.exchange(false) && !m_constantBuffers.empty()) {
+		// The frame being recorded reads the buffer too, so it must not be recycled before that one completes.
+		ConstantBufferSlot& slot = m_constantBuffers[m_currentConstantBuffer];
+		slot.lastUsedFrameID = constBufferHeap.GetCurrentFrameID();
+		return slot.view;
+	}
+
+	// CBV sizes must be multiples of 256 bytes.
+	std::vector<uint8_t> data((m_constantsSize + 255) / 256 * 256, 0);
+	for (size_t paramIdx = 0; paramIdx < m_parameters.size(); ++paramIdx) {
+		const Parameter& param = m_parameters[paramIdx];
+		uint8_t* target = data.data() + m_constantOffsets[paramIdx];
+		switch (param.GetType()) {
+			case eMaterialShaderParamType::COLOR:
+			{
+				Vec4 color = (Vec4)param;
+				float components[4] = { color.x, color.y, color.z, color.w };
+				memcpy(target, components, sizeof(components));
+				break;
+			}
+			case eMaterialShaderParamType::VALUE:
+			{
+				float value = (float)param;
+				memcpy(target, &value, sizeof(value));
+				break;
+			}
+			case eMaterialShaderParamType::BITMAP_COLOR_2D:
+			case eMaterialShaderParamType::BITMAP_VALUE_2D:
+			{
+				// shaders look up the texture in the bindless table
+				Image* image = (Image*)param;
+				uint32_t index = image ? image->GetBindlessIndex() : 0;
+				memcpy(target, &index, sizeof(index));
+				break;
+			}
+			default:
+				break;
+		}
+	}
+
+	// Buffers of frames in flight can't be overwritten, so the next one the GPU is done with is reused.
+	// The ring only grows when all of them are in use, which settles at about the number of frames in flight.
+	size_t slotIdx = m_constantBuffers.size();
+	for (size_t i = 1; i <= m_constantBuffers.size(); ++i) {
+		size_t candidate = (m_currentConstantBuffer + i) % m_constantBuffers.size();
+		if (constBufferHeap.IsFrameComplete(m_constantBuffers[candidate].lastUsedFrameID)) {
+			slotIdx = candidate;
+			break;
+		}
+	}
+	if (slotIdx == m_constantBuffers.size()) {
+		PersistentConstBuffer buffer = m_memoryManager->CreatePersistentConstBuffer(data.data(), (uint32_t)data.size());
+		ConstBufferView view(buffer, *m_viewHeap);
+		m_constantBuffers.push_back({ std::move(buffer), std::move(view), 0 });
+	}
+	else {
+		m_memoryManager->UpdatePersistentConstBuffer(m_constantBuffers[slotIdx].buffer, data.data(), (uint32_t)data.size());
+	}
+
+	m_currentConstantBuffer = slotIdx;
+	ConstantBufferSlot& slot = m_constantBuffers[slotIdx];
+	slot.lastUsedFrameID = constBufferHeap.GetCurrentFrameID();
+	return slot.view;
+}
+
+
+void Material::CalculateConstantLayout(const std::vector<MaterialShaderParameter>& params, std::vector<int>& offsets, size_t& constantsSize) {
+	int cbSize = 0;
+	offsets.clear();
+
+	for (auto& param : params) {
+		switch (param.type) {
+			case eMaterialShaderParamType::BITMAP_COLOR_2D:
+			case eMaterialShaderParamType::BITMAP_VALUE_2D:
+			{
+				cbSize = ((cbSize + 3) / 4) * 4; // correct alignement
+				offsets.push_back(cbSize);
+				cbSize += sizeof(uint32_t); // index into bindless texture table
+				break;
+			}
+			case eMaterialShaderParamType::COLOR:
+			{
+				cbSize = ((cbSize + 15) / 16) * 16; // correct alignement
+				offsets.push_back(cbSize);
+				cbSize += 16;
+				break;
+			}
+			case eMaterialShaderParamType::VALUE:
+			{
+				cbSize = ((cbSize + 3) / 4) * 4; // correct alignement
+				offsets.push_back(cbSize);
+				cbSize += sizeof(float);
+				break;
+			}
+			default:
+				assert(false);
+				offsets.push_back(0);
+		}
+	}
+
+	constantsSize = cbSize;
+}
+
+
+void Material::OnParameterChanged(const Parameter& param) {
+	// Textures are referenced by their bindless index, so they invalidate the buffer as well.
+	m_constantsDirty = true;
+}
+
+
 } // namespace inl::gxeng
\ No newline at end of file
@@ -1,20 +1,24 @@
 #pragma once
 
 #include "ShaderManager.hpp"
+#include "ResourceView.hpp"
 
 #include <BaseLibrary/Graph_All.hpp>
 #include <InlineMath.hpp>
 
-#include <regex>
 #include <sstream>
 #include <iterator>
 #include <algorithm>
 #include <string>
+#include <mutex>
+#include <atomic>
 
 namespace inl::gxeng {
 
 
 class Image;
+class MemoryManager;
+class CbvSrvUavHeap;
 
 
 enum class eMaterialShaderParamType {
@@ -33,6 +37,20 @@ struct MaterialShaderParameter {
 
 
 
+/// <summary> A token of HLSL code as seen by the material shader scanner. </summary>
+struct MaterialShaderToken {
+	enum eKind {
+		IDENTIFIER,
+		NUMBER,
+		PUNCTUATION,
+		STRING,
+	};
+	eKind kind;
+	size_t offset; // position in the source code
+	size_t length;
+};
+
+
 class MaterialShader {
 public:
 	MaterialShader(ShaderManager* shaderManager) : m_shaderManager(shaderManager) {}
@@ -40,22 +58,40 @@ public:
 	virtual std::string GetShaderCode() const = 0;
 	virtual std::vector<MaterialShaderParameter> GetShaderParameters() const;
 	virtual eMaterialShaderParamType GetShaderOutputType() const;
-	virtual size_t GetHash() const { return std::hash<std::string>()(GetShaderCode()); }
+	virtual size_t GetHash() const { return m_hash; }
+
+	/// <summary> Small integer that identifies the shader code.
+	///		Shaders with identical code have the same id, even if they are different objects. </summary>
+	uint32_t GetId() const { return m_id; }
 
 	void SetName(std::string name);
 	const std::string& GetName() const;
+
+	/// <summary> Replaces whole-word occurences of an identifier, leaving comments and longer identifiers intact. </summary>
+	static std::string RenameIdentifier(const std::string& code, const std::string& identifier, const std::string& newName);
 protected:
-	static std::string RemoveComments(std::string code);
-	static std::string FindFunctionSignature(std::string code, const std::string& functionName);
-	static void SplitFunctionSignature(std::string signature, std::string& returnType, std::vector<std::pair<std::string, std::string>>& parameters);
+	/// <summary> Parses the current shader code, and caches its id, hash and parameter layout.
+	///		Must be called by derived classes whenever the code changes. </summary>
+	void UpdateCompiled();
+
+	static std::vector<MaterialShaderToken> Tokenize(const std::string& code);
 	static std::string GetParameterString(eMaterialShaderParamType type);
 	static eMaterialShaderParamType GetParameterType(std::string typeString);
-	static void ExtractShaderParameters(std::string code, const std::string& functionName, eMaterialShaderParamType& returnType, std::vector<MaterialShaderParameter>& parameters);
+	static void ExtractShaderParameters(const std::string& code, const std::string& functionName, eMaterialShaderParamType& returnType, std::vector<MaterialShaderParameter>& parameters);
+
+	/// <summary> Returns a process-wide unique id for the given code. Thread-safe. </summary>
+	static uint32_t InternCode(const std::string& code, size_t hash);
 protected:
 	std::string LoadShaderSource(std::string name) const;
 private:
 	ShaderManager* m_shaderManager;
 	std::string m_name;
+
+	// Cached results of parsing the code.
+	uint32_t m_id = 0;
+	size_t m_hash = 0;
+	std::vector<MaterialShaderParameter> m_parameters;
+	eMaterialShaderParamType m_outputType = eMaterialShaderParamType::UNKNOWN;
 };
 
 
@@ -117,6 +153,7 @@ private:
 class Material {
 public:
 	class Parameter {
+		friend class Material;
 	public:
 		Parameter();
 		Parameter(eMaterialShaderParamType type);
@@ -139,9 +176,14 @@ public:
 			Vec4 color;
 			float value;
 		} m_data;
+		Material* m_owner = nullptr; // notified when the value changes
 	};
 
 public:
+	Material(MemoryManager* memoryManager = nullptr, CbvSrvUavHeap* viewHeap = nullptr);
+	Material(const Material&) = delete;
+	Material& operator=(const Material&) = delete;
+
 	void SetShader(MaterialShader* shader);
 	MaterialShader* GetShader() const { return m_shader; }
 	size_t GetParameterCount() const;
@@ -151,10 +193,42 @@ public:
 
 	Parameter& operator[](const std::string& name);
 	const Parameter& operator[](const std::string& name) const;
+
+	/// <summary> Offset of each parameter within the constant buffer in bytes.
+	///		Textures are stored as their index in the bindless texture table. </summary>
+	const std::vector<int>& GetConstantOffsets() const { return m_constantOffsets; }
+	/// <summary> Size of the parameters in the constant buffer, zero if there are none. </summary>
+	size_t GetConstantsSize() const { return m_constantsSize; }
+
+	/// <summary> Returns the constant buffer with the current values and texture indices of parameters.
+	///		The values are only written if a parameter has changed since the last call,
+	///		into a buffer of a small ring that no frame in flight is reading. </summary>
+	/// <remarks> The buffer stays valid until the frame being recorded has finished on the GPU. </remarks>
+	ConstBufferView GetConstantBuffer();
+
+	/// <summary> Calculates the constant buffer layout of shader parameters according to HLSL packing rules. </summary>
+	static void CalculateConstantLayout(const std::vector<MaterialShaderParameter>& params, std::vector<int>& offsets, size_t& constantsSize);
+private:
+	void OnParameterChanged(const Parameter& param);
 private:
 	std::vector<Parameter> m_parameters;
 	MaterialShader* m_shader = nullptr;
 	std::unordered_map<std::string, size_t> m_paramNameMap; // maps parameter names to indices
+
+	// Constant buffer
+	MemoryManager* m_memoryManager;
+	CbvSrvUavHeap* m_viewHeap;
+	std::vector<int> m_constantOffsets;
+	size_t m_constantsSize = 0;
+	struct ConstantBufferSlot {
+		PersistentConstBuffer buffer;
+		ConstBufferView view;
+		uint64_t lastUsedFrameID; // the slot can be overwritten once this frame has completed
+	};
+	std::vector<ConstantBufferSlot> m_constantBuffers;
+	size_t m_currentConstantBuffer = 0;
+	std::atomic_bool m_constantsDirty{ true };
+	std::mutex m_constantsMutex;
 };
 
 
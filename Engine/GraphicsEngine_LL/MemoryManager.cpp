@@ -40,6 +40,10 @@ UploadManager& MemoryManager::GetUploadManager() {
 	return m_uploadHeap;
 }
 
+ConstantBufferHeap& MemoryManager::GetConstBufferHeap() {
+	return m_constBufferHeap;
+}
+
 
 VolatileConstBuffer MemoryManager::CreateVolatileConstBuffer(const void* data, uint32_t size) {
 	return m_constBufferHeap.CreateVolatileBuffer(data, size);
@@ -51,6 +55,11 @@ PersistentConstBuffer MemoryManager::CreatePersistentConstBuffer(const void * da
 }
 
 
+void MemoryManager::UpdatePersistentConstBuffer(const PersistentConstBuffer& buffer, const void* data, uint32_t size) {
+	m_constBufferHeap.UpdatePersistentBuffer(buffer, data, size);
+}
+
+
 VertexBuffer MemoryManager::CreateVertexBuffer(eResourceHeapType heap, size_t size) {
 	MemoryObjDesc desc = AllocateResource(heap, gxapi::ResourceDesc::Buffer(size));
 
@@ -86,8 +86,10 @@ public:
 	void UnlockResident(IterT begin, IterT end);
 
 	UploadManager& GetUploadManager();
+	ConstantBufferHeap& GetConstBufferHeap();
 	VolatileConstBuffer CreateVolatileConstBuffer(const void* data, uint32_t size);
 	PersistentConstBuffer CreatePersistentConstBuffer(const void* data, uint32_t size);
+	void UpdatePersistentConstBuffer(const PersistentConstBuffer& buffer, const void* data, uint32_t size);
 
 	VertexBuffer CreateVertexBuffer(eResourceHeapType heap, size_t size);
 	IndexBuffer CreateIndexBuffer(eResourceHeapType heap, size_t size, size_t indexCount);
@@ -3,6 +3,8 @@
 #include "VertexCompressor.hpp"
 #include <BaseLibrary/ArrayView.hpp>
 
+#include <algorithm>
+
 
 
 namespace inl {
@@ -10,7 +12,9 @@ namespace gxeng {
 
 
 
-void Mesh::Set(const VertexBase* vertices, const IVertexReader* vertexReader, size_t numVertices, const unsigned* indices, size_t numIndices) {
+void Mesh::Set(const VertexBase* vertices, const IVertexReader* vertexReader, size_t numVertices, const unsigned* indices, size_t numIndices, std::vector<Submesh> submeshes) {
+	CheckSubmeshes(submeshes, indices, numIndices, numVertices);
+
 	// Create constants
 	auto& elements = vertexReader->GetElements();
 	std::vector<bool> elementMap(elements.size(), true);
@@ -38,6 +42,30 @@ void Mesh::Set(const VertexBase* vertices, const IVertexReader* vertexReader, si
 
 	// Calculate hashes
 	m_layout = Layout(layout);
+	SetSubmeshes(std::move(submeshes));
+}
+
+
+void Mesh::SetCompressed(const void* vertices, size_t stride, size_t numVertices, std::vector<Element> elements, const void* indices, size_t numIndices, bool indices32Bit, std::vector<Submesh> submeshes) {
+	// Set data
+	VertexStream stream;
+	stream.stride = (uint32_t)stride;
+	stream.count = numVertices;
+	stream.data = const_cast<void*>(vertices);
+	if (indices32Bit) {
+		const uint32_t* firstIndex = static_cast<const uint32_t*>(indices);
+		CheckSubmeshes(submeshes, firstIndex, numIndices, numVertices);
+		MeshBuffer::Set(&stream, &stream + 1, firstIndex, firstIndex + numIndices);
+	}
+	else {
+		const uint16_t* firstIndex = static_cast<const uint16_t*>(indices);
+		CheckSubmeshes(submeshes, firstIndex, numIndices, numVertices);
+		MeshBuffer::Set(&stream, &stream + 1, firstIndex, firstIndex + numIndices);
+	}
+
+	// Set stream elements and calculate hashes
+	m_layout = Layout({ std::move(elements) });
+	SetSubmeshes(std::move(submeshes));
 }
 
 
@@ -59,6 +87,48 @@ void Mesh::Update(const VertexBase* vertices, const IVertexReader* vertexReader,
 void Mesh::Clear() {
 	MeshBuffer::Clear();
 	m_layout.Clear();
+	m_submeshes.clear();
+}
+
+
+const std::vector<Mesh::Submesh>& Mesh::GetSubmeshes() const {
+	return m_submeshes;
+}
+
+
+template <class IndexT>
+void Mesh::CheckSubmeshes(const std::vector<Submesh>& submeshes, const IndexT* indices, size_t numIndices, size_t numVertices) {
+	for (const auto& submesh : submeshes) {
+		if (size_t(submesh.firstIndex) + submesh.numIndices > numIndices) {
+			throw OutOfRangeException("Submesh reaches past the end of the index buffer.");
+		}
+		if (submesh.numIndices == 0) {
+			continue;
+		}
+		// The GPU adds the base vertex to every index of the draw.
+		const IndexT* first = indices + submesh.firstIndex;
+		auto range = std::minmax_element(first, first + submesh.numIndices);
+		if (int64_t(*range.first) + submesh.baseVertex < 0 || int64_t(*range.second) + submesh.baseVertex >= int64_t(numVertices)) {
+			throw OutOfRangeException("Submesh indexes outside the vertex buffer.");
+		}
+	}
+}
+
+
+void Mesh::SetSubmeshes(std::vector<Submesh> submeshes) {
+	if (!submeshes.empty()) {
+		m_submeshes = std::move(submeshes);
+		return;
+	}
+
+	Submesh submesh;
+	submesh.firstIndex = 0;
+	submesh.numIndices = (unsigned)GetIndexBuffer().GetIndexCount();
+	submesh.baseVertex = 0;
+	submesh.materialSlot = 0;
+	submesh.boundsMin = Vec3(0, 0, 0);
+	submesh.boundsMax = Vec3(0, 0, 0);
+	m_submeshes = { submesh };
 }
 
 
@@ -66,6 +136,17 @@ const Mesh::Layout& Mesh::GetLayout() const {
 	return m_layout;
 }
 
+bool Mesh::IsSkinned() const {
+	for (size_t streamIdx = 0; streamIdx < m_layout.GetStreamCount(); ++streamIdx) {
+		for (const auto& element : m_layout[streamIdx]) {
+			if (element.semantic == eVertexElementSemantic::BONE_INDICES) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
 
 
 bool Mesh::Layout::EqualElements(const Layout& rhs) const {
@@ -43,13 +43,37 @@ public:
 		size_t m_elementHash = 0;
 		size_t m_layoutHash = 0;
 	};
+	/// <summary> A part of the mesh that is drawn with its own material, from a range of the shared index buffer. </summary>
+	struct Submesh {
+		unsigned firstIndex;
+		unsigned numIndices;
+		int baseVertex; // Added to the indices of the submesh, so they can be relative to its first vertex.
+		unsigned materialSlot; // See MeshEntity::GetMaterial.
+		Vec3 boundsMin; // In the space of the vertices. Given by the caller, not computed from the vertices.
+		Vec3 boundsMax;
+	};
 public:
 	Mesh(MemoryManager* memoryManager) : MeshBuffer(memoryManager) {}
 
-	void Set(const VertexBase* vertices, const IVertexReader* vertexReader, size_t numVertices, const unsigned* indices, size_t numIndices);
+	/// <param name="submeshes"> Splits the mesh into parts that are drawn from the same buffers, one ranged draw each.
+	///		Leave empty for a single submesh of all indices, with material slot 0. </param>
+	/// <exception cref="OutOfRangeException"> If a submesh reaches past the end of the indices, or its indices plus
+	///		its base vertex reach outside the vertices. The mesh is left unchanged then. </exception>
+	void Set(const VertexBase* vertices, const IVertexReader* vertexReader, size_t numVertices, const unsigned* indices, size_t numIndices, std::vector<Submesh> submeshes = {});
+	/// <summary> Sets vertices which are already in the compressed layout, such as those mapped from cooked mesh files. </summary>
+	/// <param name="elements"> The offset of each element within the vertices of <paramref name="stride"/> bytes. </param>
+	/// <param name="indices"> 16 or 32 bit indices, as <paramref name="indices32Bit"/> says. </param>
+	/// <param name="submeshes"> Same as for <see cref="Set"/>. </param>
+	/// <exception cref="OutOfRangeException"> Same as for <see cref="Set"/>. </exception>
+	void SetCompressed(const void* vertices, size_t stride, size_t numVertices, std::vector<Element> elements, const void* indices, size_t numIndices, bool indices32Bit, std::vector<Submesh> submeshes = {});
 	void Update(const VertexBase* vertices, const IVertexReader* vertexReader, size_t numVertices, size_t offsetInVertices);
 	void Clear();
 
+	/// <summary> The submeshes given with the vertices. </summary>
+	/// <remarks> The single default submesh has empty bounds, at the origin, as the mesh does not read the vertices back.
+	///		Only given tables have bounds, such as those of the asset loader and of cooked meshes. Drawing does not use them. </remarks>
+	const std::vector<Submesh>& GetSubmeshes() const;
+
 	using MeshBuffer::GetNumStreams;
 	using MeshBuffer::GetVertexBuffer;
 	using MeshBuffer::GetVertexBufferStride;
@@ -57,8 +81,16 @@ public:
 	using MeshBuffer::IsIndexBuffer32Bit;
 
 	const Layout& GetLayout() const;
+	/// <summary> Tells if the vertices have bone indices and weights, so they have to be skinned when drawn. </summary>
+	bool IsSkinned() const;
+private:
+	/// <summary> Checks the table against the caller's indices, which are not kept after uploading. </summary>
+	template <class IndexT>
+	static void CheckSubmeshes(const std::vector<Submesh>& submeshes, const IndexT* indices, size_t numIndices, size_t numVertices);
+	void SetSubmeshes(std::vector<Submesh> submeshes);
 private:
 	Layout m_layout;
+	std::vector<Submesh> m_submeshes;
 };
 
 
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <memory>
+#include <algorithm>
 #include <cstdint>
 #include <type_traits>
 
@@ -96,10 +97,9 @@ void MeshBuffer::Set(StreamIt firstStream, StreamIt lastStream, IndexIt firstInd
 
 
 	// Create index buffer.
-	size_t numVertices = firstStream->count; // all must have the same number of verts, see Validate
 	size_t numIndices = std::distance(firstIndex, lastIndex);
-	// Not perfect, but hey, why'd you give more vertices if they are not indexed?
-	bool using32BitIndex = numVertices > 0xFFFFu;
+	// Submeshes may index relative to their base vertex, so the largest index matters, not the number of vertices.
+	bool using32BitIndex = numIndices > 0 && *std::max_element(firstIndex, lastIndex) > 0xFFFFu;
 	unsigned indexStride = using32BitIndex ? sizeof(uint32_t) : sizeof(uint16_t);
 	size_t indexTotalSize = numIndices * indexStride;
 	IndexBuffer newIndexBuffer = m_memoryManager->CreateIndexBuffer(eResourceHeapType::CRITICAL, indexTotalSize, numIndices);
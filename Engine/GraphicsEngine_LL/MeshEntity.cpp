@@ -5,7 +5,7 @@ namespace inl::gxeng {
 
 MeshEntity::MeshEntity() :
 	m_mesh(nullptr),
-	m_material(nullptr)
+	m_materials(1, nullptr)
 {}
 
 
@@ -18,10 +18,33 @@ Mesh* MeshEntity::GetMesh() const {
 }
 
 void MeshEntity::SetMaterial(Material* material) {
-	m_material = material;
+	m_materials[0] = material;
 }
 Material* MeshEntity::GetMaterial() const {
-	return m_material;
+	return m_materials[0];
+}
+
+void MeshEntity::SetMaterial(size_t slot, Material* material) {
+	if (slot >= m_materials.size()) {
+		m_materials.resize(slot + 1, nullptr);
+	}
+	m_materials[slot] = material;
+}
+Material* MeshEntity::GetMaterial(size_t slot) const {
+	if (slot < m_materials.size() && m_materials[slot] != nullptr) {
+		return m_materials[slot];
+	}
+	return m_materials[0];
+}
+size_t MeshEntity::GetMaterialCount() const {
+	return m_materials.size();
+}
+
+void MeshEntity::SetSkinMatrices(std::vector<Mat44> skinMatrices) {
+	m_skinMatrices = std::move(skinMatrices);
+}
+const std::vector<Mat44>& MeshEntity::GetSkinMatrices() const {
+	return m_skinMatrices;
 }
 
 
@@ -4,6 +4,8 @@
 #include <InlineMath.hpp>
 #include "BaseLibrary/Transformable.hpp"
 
+#include <vector>
+
 namespace inl::gxeng {
 
 
@@ -23,17 +25,35 @@ public:
 	/// <summary> Returns currently associated triangle mesh. </summary>
 	Mesh* GetMesh() const;
 
-	/// <summary> Describes the surface of the triangle mesh. </summary>
+	/// <summary> Describes the surface of the triangle mesh. Sets the first material slot. </summary>
 	/// <remarks> Passing nullptr is ok, but rendering it is undefined behviour.
 	///		The material must not be deleted while assigned to the entity. </remarks>
 	void SetMaterial(Material* material);
-	/// <summary> Returns the currently associated material. </summary>
+	/// <summary> Returns the material of the first slot. </summary>
 	Material* GetMaterial() const;
 
+	/// <summary> Sets the material of the submeshes that use the given slot, see <see cref="Mesh::Submesh"/>. </summary>
+	void SetMaterial(size_t slot, Material* material);
+	/// <summary> Returns the material of the slot, or that of the first slot if this one is not set. </summary>
+	Material* GetMaterial(size_t slot) const;
+	/// <summary> One more than the last slot that was set. </summary>
+	size_t GetMaterialCount() const;
+
+	/// <summary> Sets the bone transforms that skinned meshes are drawn with, see asset::ComputeSkinMatrices. </summary>
+	/// <remarks> Meshes without bone indices and weights ignore them. Skinned meshes are drawn in their bind pose
+	///		while no matrices are set, and are not drawn at all with more than <see cref="MaxSkinMatrices"/>. </remarks>
+	void SetSkinMatrices(std::vector<Mat44> skinMatrices);
+	/// <summary> Returns the bone transforms of skinned meshes. </summary>
+	const std::vector<Mat44>& GetSkinMatrices() const;
+
+	/// <summary> The number of bones a skinned mesh can be drawn with, the size of the shaders' bone array. </summary>
+	static constexpr size_t MaxSkinMatrices = 64;
+
 private:
 	// Physical properties
 	Mesh* m_mesh;
-	Material* m_material;
+	std::vector<Material*> m_materials;
+	std::vector<Mat44> m_skinMatrices;
 };
 
 
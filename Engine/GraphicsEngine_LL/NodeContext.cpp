@@ -4,6 +4,7 @@
 #include "CommandAllocatorPool.hpp"
 #include "ScratchSpacePool.hpp"
 #include "GraphicsCommandList.hpp"
+#include "BinderCache.hpp"
 
 
 namespace inl::gxeng {
@@ -39,13 +40,15 @@ SetupContext::SetupContext(MemoryManager* memoryManager,
 						   RTVHeap* rtvHeap,
 						   DSVHeap* dsvHeap,
 						   ShaderManager* shaderManager,
-						   gxapi::IGraphicsApi* graphicsApi)
+						   gxapi::IGraphicsApi* graphicsApi,
+						   BinderCache* binderCache)
 	: m_memoryManager(memoryManager),
 	m_srvHeap(srvHeap),
 	m_rtvHeap(rtvHeap),
 	m_dsvHeap(dsvHeap),
 	m_shaderManager(shaderManager),
-	m_graphicsApi(graphicsApi)
+	m_graphicsApi(graphicsApi),
+	m_binderCache(binderCache)
 {}
 
 
@@ -161,6 +164,9 @@ gxapi::IPipelineState* SetupContext::CreatePSO(const gxapi::ComputePipelineState
 
 
 Binder SetupContext::CreateBinder(const std::vector<BindParameterDesc>& parameters, const std::vector<gxapi::StaticSamplerDesc>& staticSamplers) const {
+	if (m_binderCache) {
+		return m_binderCache->GetBinder(parameters, staticSamplers);
+	}
 	return Binder(m_graphicsApi, parameters, staticSamplers);
 }
 
@@ -178,7 +184,8 @@ RenderContext::RenderContext(MemoryManager* memoryManager,
 							 gxapi::IGraphicsApi* graphicsApi,
 							 CommandListPool* commandListPool,
 							 CommandAllocatorPool* commandAllocatorPool,
-							 ScratchSpacePool* scratchSpacePool)
+							 ScratchSpacePool* scratchSpacePool,
+							 BinderCache* binderCache)
 	: m_memoryManager(memoryManager),
 	m_srvHeap(srvHeap),
 	m_volatileViewHeap(volatileViewHeap),
@@ -186,7 +193,8 @@ RenderContext::RenderContext(MemoryManager* memoryManager,
 	m_graphicsApi(graphicsApi),
 	m_commandListPool(commandListPool),
 	m_commandAllocatorPool(commandAllocatorPool),
-	m_scratchSpacePool(scratchSpacePool)
+	m_scratchSpacePool(scratchSpacePool),
+	m_binderCache(binderCache)
 {}
 
 
@@ -222,6 +230,9 @@ gxapi::IPipelineState* RenderContext::CreatePSO(const gxapi::ComputePipelineStat
 }
 
 Binder RenderContext::CreateBinder(const std::vector<BindParameterDesc>& parameters, const std::vector<gxapi::StaticSamplerDesc>& staticSamplers) const {
+	if (m_binderCache) {
+		return m_binderCache->GetBinder(parameters, staticSamplers);
+	}
 	return Binder(m_graphicsApi, parameters, staticSamplers);
 }
 
@@ -236,6 +247,12 @@ GraphicsCommandList& RenderContext::AsGraphics() {
 	else if (m_type == gxapi::eCommandListType::GRAPHICS) {
 		return *dynamic_cast<GraphicsCommandList*>(m_commandList.get());
 	}
+	else if (m_type == gxapi::eCommandListType::COMPUTE) {
+		// Compute lists are graphics lists as well, see AsCompute. This happens when the scheduler merges a
+		// graphics task into the list of a compute task.
+		m_type = gxapi::eCommandListType::GRAPHICS;
+		return *dynamic_cast<GraphicsCommandList*>(m_commandList.get());
+	}
 	else {
 		throw std::logic_error("Your first call to AsType() determines the command list type. You did not choose GRAPHICS, thus this call is invalid.");
 	}
@@ -246,7 +263,7 @@ ComputeCommandList& RenderContext::AsCompute() {
 		m_type = gxapi::eCommandListType::COMPUTE;
 		return *dynamic_cast<ComputeCommandList*>(m_commandList.get());
 	}
-	else if (m_type == gxapi::eCommandListType::COMPUTE) {
+	else if (m_type == gxapi::eCommandListType::COMPUTE || m_type == gxapi::eCommandListType::GRAPHICS) {
 		return *dynamic_cast<ComputeCommandList*>(m_commandList.get());
 	}
 	else {
@@ -26,6 +26,7 @@ class BasicCommandList;
 class ScratchSpacePool;
 class CommandListPool;
 class CommandAllocatorPool;
+class BinderCache;
 
 // Debug draw
 class DebugObject;
@@ -80,7 +81,8 @@ public:
 				 RTVHeap* rtvHeap = nullptr,
 				 DSVHeap* dsvHeap = nullptr,
 				 ShaderManager* shaderManager = nullptr,
-				 gxapi::IGraphicsApi* graphicsApi = nullptr);
+				 gxapi::IGraphicsApi* graphicsApi = nullptr,
+				 BinderCache* binderCache = nullptr);
 	SetupContext(SetupContext&&) = delete;
 	SetupContext& operator=(SetupContext&&) = delete;
 	SetupContext(const SetupContext&) = delete;
@@ -123,6 +125,7 @@ private:
 	// Shaders and PSOs
 	ShaderManager* m_shaderManager;
 	gxapi::IGraphicsApi* m_graphicsApi;
+	BinderCache* m_binderCache;
 };
 
 
@@ -140,7 +143,8 @@ public:
 				  gxapi::IGraphicsApi* graphicsApi = nullptr,
 				  CommandListPool* commandListPool = nullptr,
 				  CommandAllocatorPool* commandAllocatorPool = nullptr,
-				  ScratchSpacePool* scratchSpacePool = nullptr);
+				  ScratchSpacePool* scratchSpacePool = nullptr,
+				  BinderCache* binderCache = nullptr);
 	RenderContext(RenderContext&&) = delete;
 	RenderContext& operator=(RenderContext&&) = delete;
 	RenderContext(const RenderContext&) = delete;
@@ -179,6 +183,7 @@ private:
 	// Shaders and PSOs
 	ShaderManager* m_shaderManager;
 	gxapi::IGraphicsApi* m_graphicsApi;
+	BinderCache* m_binderCache;
 
 	// Command list
 	CommandListPool* m_commandListPool;
@@ -225,6 +225,11 @@ void CSM::Execute(RenderContext & context) {
 				continue; //skip quadcopter for visualization purposes (obscures camera...)
 			}
 
+			// Skinned meshes are only drawn by the depth prepass and the forward pass
+			if (mesh->IsSkinned()) {
+				continue;
+			}
+
 			// Draw mesh
 			if (!CheckMeshFormat(*mesh)) {
 				assert(false);
@@ -249,7 +254,9 @@ void CSM::Execute(RenderContext & context) {
 
 			commandList.SetVertexBuffers(0, (unsigned)vertexBuffers.size(), vertexBuffers.data(), sizes.data(), strides.data());
 			commandList.SetIndexBuffer(&mesh->GetIndexBuffer(), mesh->IsIndexBuffer32Bit());
-			commandList.DrawIndexedInstanced((unsigned)mesh->GetIndexBuffer().GetIndexCount());
+			for (const Mesh::Submesh& submesh : mesh->GetSubmeshes()) {
+				commandList.DrawIndexedInstanced(submesh.numIndices, submesh.firstIndex, submesh.baseVertex);
+			}
 		}
 	}
 }
@@ -9,6 +9,7 @@
 #include "../GraphicsCommandList.hpp"
 
 #include <array>
+#include <algorithm>
 
 namespace inl::gxeng::nodes {
 
@@ -26,6 +27,19 @@ static bool CheckMeshFormat(const Mesh& mesh) {
 }
 
 
+static bool CheckSkinnedMeshFormat(const Mesh& mesh) {
+	// Position, normal and texcoord as above, followed by the bones.
+	if (mesh.GetNumStreams() != 1) return false;
+	auto& elements = mesh.GetLayout()[0];
+	if (elements.size() != 5) return false;
+	if (elements[0].semantic != eVertexElementSemantic::POSITION) return false;
+	if (elements[3].semantic != eVertexElementSemantic::BONE_INDICES || elements[3].offset != 32) return false;
+	if (elements[4].semantic != eVertexElementSemantic::BONE_WEIGHTS || elements[4].offset != 48) return false;
+
+	return true;
+}
+
+
 static void ConvertToSubmittable(
 	Mesh* mesh,
 	std::vector<const gxeng::VertexBuffer*>& vertexBuffers,
@@ -94,6 +108,15 @@ void DepthPrepass::Setup(SetupContext & context) {
 		transformBindParamDesc.relativeChangeFrequency = 0;
 		transformBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::VERTEX;
 
+		// Only read by the skinned shader.
+		BindParameterDesc skinBindParamDesc;
+		m_skinBindParam = BindParameter(eBindParameterType::CONSTANT, 1);
+		skinBindParamDesc.parameter = m_skinBindParam;
+		skinBindParamDesc.constantSize = sizeof(Mat44_Packed) * MeshEntity::MaxSkinMatrices;
+		skinBindParamDesc.relativeAccessFrequency = 0;
+		skinBindParamDesc.relativeChangeFrequency = 0;
+		skinBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::VERTEX;
+
 		BindParameterDesc sampBindParamDesc;
 		sampBindParamDesc.parameter = BindParameter(eBindParameterType::SAMPLER, 0);
 		sampBindParamDesc.constantSize = 0;
@@ -111,7 +134,7 @@ void DepthPrepass::Setup(SetupContext & context) {
 		samplerDesc.registerSpace = 0;
 		samplerDesc.shaderVisibility = gxapi::eShaderVisiblity::PIXEL;
 
-		m_binder = context.CreateBinder({ transformBindParamDesc, sampBindParamDesc },{ samplerDesc });
+		m_binder = context.CreateBinder({ transformBindParamDesc, skinBindParamDesc, sampBindParamDesc },{ samplerDesc });
 	}
 
 	if (!m_shader.vs || !m_shader.ps) {
@@ -122,6 +145,14 @@ void DepthPrepass::Setup(SetupContext & context) {
 		m_shader = context.CreateShader("DepthPrepass", shaderParts, "");
 	}
 
+	if (!m_skinnedShader.vs || !m_skinnedShader.ps) {
+		ShaderParts shaderParts;
+		shaderParts.vs = true;
+		shaderParts.ps = true;
+
+		m_skinnedShader = context.CreateShader("DepthPrepassSkinned", shaderParts, "");
+	}
+
 	if (m_PSO == nullptr || m_depthStencilFormat != currDepthStencilFormat) {
 		m_depthStencilFormat = currDepthStencilFormat;
 
@@ -146,6 +177,15 @@ void DepthPrepass::Setup(SetupContext & context) {
 		psoDesc.numRenderTargets = 0;
 
 		m_PSO.reset(context.CreatePSO(psoDesc));
+
+		inputElementDesc.push_back(gxapi::InputElementDesc("BONE_INDICES", 0, gxapi::eFormat::R32G32B32A32_UINT, 0, 32));
+		inputElementDesc.push_back(gxapi::InputElementDesc("BONE_WEIGHTS", 0, gxapi::eFormat::R32G32B32A32_FLOAT, 0, 48));
+		psoDesc.inputLayout.elements = inputElementDesc.data();
+		psoDesc.inputLayout.numElements = (unsigned)inputElementDesc.size();
+		psoDesc.vs = m_skinnedShader.vs;
+		psoDesc.ps = m_skinnedShader.ps;
+
+		m_skinnedPSO.reset(context.CreatePSO(psoDesc));
 	}
 }
 
@@ -185,6 +225,8 @@ void DepthPrepass::Execute(RenderContext & context) {
 	std::vector<const gxeng::VertexBuffer*> vertexBuffers;
 	std::vector<unsigned> sizes;
 	std::vector<unsigned> strides;
+	std::vector<Mat44_Packed> skinCBData(MeshEntity::MaxSkinMatrices, Mat44_Packed::Identity());
+	gxapi::IPipelineState* currentPSO = m_PSO.get();
 
 	// Iterate over all entities
 	for (const MeshEntity* entity : *m_entities) {
@@ -193,10 +235,21 @@ void DepthPrepass::Execute(RenderContext & context) {
 		auto position = entity->GetPosition();
 
 		// Draw mesh
-		if (!CheckMeshFormat(*mesh)) {
+		const bool skinned = mesh->IsSkinned();
+		if (skinned ? !CheckSkinnedMeshFormat(*mesh) : !CheckMeshFormat(*mesh)) {
 			assert(false);
 			continue;
 		}
+		const std::vector<Mat44>& skinMatrices = entity->GetSkinMatrices();
+		if (skinned && skinMatrices.size() > MeshEntity::MaxSkinMatrices) {
+			continue;
+		}
+
+		gxapi::IPipelineState* pso = skinned ? m_skinnedPSO.get() : m_PSO.get();
+		if (pso != currentPSO) {
+			commandList.SetPipelineState(pso);
+			currentPSO = pso;
+		}
 
 		ConvertToSubmittable(mesh, vertexBuffers, sizes, strides);
 
@@ -207,6 +260,13 @@ void DepthPrepass::Execute(RenderContext & context) {
 
 		commandList.BindGraphics(m_transformBindParam, &transformCBData, sizeof(transformCBData));
 
+		if (skinned) {
+			// The bind pose while the entity has no matrices.
+			std::fill(skinCBData.begin(), skinCBData.end(), Mat44_Packed::Identity());
+			std::copy(skinMatrices.begin(), skinMatrices.end(), skinCBData.begin());
+			commandList.BindGraphics(m_skinBindParam, skinCBData.data(), sizeof(Mat44_Packed) * skinCBData.size());
+		}
+
 		for (auto& vb : vertexBuffers) {
 			commandList.SetResourceState(*vb, gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
 		}
@@ -214,7 +274,9 @@ void DepthPrepass::Execute(RenderContext & context) {
 
 		commandList.SetVertexBuffers(0, (unsigned)vertexBuffers.size(), vertexBuffers.data(), sizes.data(), strides.data());
 		commandList.SetIndexBuffer(&mesh->GetIndexBuffer(), mesh->IsIndexBuffer32Bit());
-		commandList.DrawIndexedInstanced((unsigned)mesh->GetIndexBuffer().GetIndexCount());
+		for (const Mesh::Submesh& submesh : mesh->GetSubmeshes()) {
+			commandList.DrawIndexedInstanced(submesh.numIndices, submesh.firstIndex, submesh.baseVertex);
+		}
 	}
 }
 
@@ -38,8 +38,11 @@ public:
 protected:
 	std::optional<Binder> m_binder;
 	BindParameter m_transformBindParam;
+	BindParameter m_skinBindParam;
 	ShaderProgram m_shader;
+	ShaderProgram m_skinnedShader;
 	std::unique_ptr<gxapi::IPipelineState> m_PSO;
+	std::unique_ptr<gxapi::IPipelineState> m_skinnedPSO;
 	gxapi::eFormat m_depthStencilFormat = gxapi::eFormat::UNKNOWN;
 
 private: // execution context
@@ -5,12 +5,14 @@
 #include "../MeshEntity.hpp"
 #include "../Mesh.hpp"
 #include "../Image.hpp"
+#include "../BindlessTextureHeap.hpp"
 #include "../DirectionalLight.hpp"
 #include "../NodeContext.hpp"
 #include "../GraphicsCommandList.hpp"
 #include "../ResourceView.hpp"
 
 #include <array>
+#include <algorithm>
 
 namespace inl::gxeng::nodes {
 
@@ -339,80 +341,25 @@ void ForwardRender::Execute(RenderContext& context) {
 	std::vector<const gxeng::VertexBuffer*> vertexBuffers;
 	std::vector<unsigned> sizes;
 	std::vector<unsigned> strides;
+	std::vector<Mat44_Packed> skinConstants(MeshEntity::MaxSkinMatrices);
 
 	// Iterate over all entities
 	for (const MeshEntity* entity : *m_entities) {
 		// Get entity parameters
 		Mesh* mesh = entity->GetMesh();
-		Material* material = entity->GetMaterial();
 
 		assert(mesh != nullptr);
-		assert(material != nullptr);
 
-		// Set pipeline state & binder
-		const Mesh::Layout& layout = mesh->GetLayout();
-		const MaterialShader* materialShader = material->GetShader();
-		assert(materialShader != nullptr);
-
-		ScenarioData& scenario = GetScenario(
-			context, layout, *materialShader, m_rtv.GetDescription().format, m_dsv.GetDescription().format);
-
-		commandList.SetPipelineState(scenario.pso.get());
-		commandList.SetGraphicsBinder(&scenario.binder);
-
-		commandList.SetResourceState(m_pointLightShadowMapTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
-		commandList.SetResourceState(m_cascadedShadowMapTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
-		commandList.SetResourceState(m_shadowMXTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
-		commandList.SetResourceState(m_csmSplitsTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
-		commandList.SetResourceState(m_lightMVPTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
-
-		commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 400), m_pointLightShadowMapTexView);
-
-		commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 500), m_cascadedShadowMapTexView);
-		commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 501), m_shadowMXTexView);
-		commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 502), m_csmSplitsTexView);
-		commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 503), m_lightMVPTexView);
-
-		commandList.SetResourceState(m_lightCullDataView.GetResource(), {gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE	});
-
-		commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 600), m_lightCullDataView);
-
-		// Set material parameters
-		std::vector<uint8_t> materialConstants(scenario.constantsSize);
-		for (size_t paramIdx = 0; paramIdx < material->GetParameterCount(); ++paramIdx) {
-			const Material::Parameter& param = (*material)[paramIdx];
-			switch (param.GetType()) {
-			case eMaterialShaderParamType::BITMAP_COLOR_2D:
-			case eMaterialShaderParamType::BITMAP_VALUE_2D:
-			{
-				BindParameter bindSlot(eBindParameterType::TEXTURE, scenario.offsets[paramIdx]);
-				commandList.SetResourceState(((Image*)param)->GetSrv().GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
-				commandList.BindGraphics(bindSlot, ((Image*)param)->GetSrv());
-				break;
-			}
-			case eMaterialShaderParamType::COLOR:
-			{
-				*reinterpret_cast<float*>(materialConstants.data() + scenario.offsets[paramIdx] + 0) = ((Vec4)param).x;
-				*reinterpret_cast<float*>(materialConstants.data() + scenario.offsets[paramIdx] + 4) = ((Vec4)param).y;
-				*reinterpret_cast<float*>(materialConstants.data() + scenario.offsets[paramIdx] + 8) = ((Vec4)param).z;
-				*reinterpret_cast<float*>(materialConstants.data() + scenario.offsets[paramIdx] + 12) = ((Vec4)param).w;
-				break;
-			}
-			case eMaterialShaderParamType::VALUE:
-			{
-				*reinterpret_cast<float*>(materialConstants.data() + scenario.offsets[paramIdx]) = ((float)param);
-				break;
-			}
-			}
-		}
-		if (scenario.constantsSize > 0) {
-			commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 200), materialConstants.data(), (int)materialConstants.size());
+		const std::vector<Mat44>& skinMatrices = entity->GetSkinMatrices();
+		const bool skinned = mesh->IsSkinned();
+		if (skinned && skinMatrices.size() > MeshEntity::MaxSkinMatrices) {
+			continue;
 		}
 
 		assert(m_directionalLights->Size() == 1);
 		const DirectionalLight* sun = *m_directionalLights->begin();
 
-		// Set vertex and light constants
+		// Vertex and light constants
 		VsConstants vsConstants;
 		LightConstants lightConstants;
 		vsConstants.m = entity->GetTransform();
@@ -424,9 +371,11 @@ void ForwardRender::Execute(RenderContext& context) {
 		Vec4 vsLightDir = Vec4(sun->GetDirection(), 0.0f) * view;
 		lightConstants.direction = Vec3(vsLightDir.xyz).Normalized();
 		lightConstants.color = sun->GetColor();
-
-		commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 0), &vsConstants, sizeof(vsConstants));
-		commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 100), &lightConstants, sizeof(lightConstants));
+		if (skinned) {
+			// The bind pose while the entity has no matrices.
+			std::fill(skinConstants.begin(), skinConstants.end(), Mat44_Packed::Identity());
+			std::copy(skinMatrices.begin(), skinMatrices.end(), skinConstants.begin());
+		}
 
 		Uniforms uniformsCBData;
 		uniformsCBData.screen_dimensions = Vec4((float)m_rtv.GetResource().GetWidth(), (float)m_rtv.GetResource().GetHeight(), 0.f, 0.f);
@@ -446,9 +395,7 @@ void ForwardRender::Execute(RenderContext& context) {
 		uniformsCBData.halfExposureFramerate = 0.5 * 0.75 * 150; //TODO add measured FPS (or target)
 		uniformsCBData.maxMotionBlurRadius = 20;
 
-		commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 600), &uniformsCBData, sizeof(uniformsCBData));
-
-		// Set primitives
+		// Set primitives, all submeshes are drawn from these
 		vertexBuffers.clear(); sizes.clear(); strides.clear();
 		for (size_t i = 0; i < mesh->GetNumStreams(); ++i) {
 			vertexBuffers.push_back(&mesh->GetVertexBuffer(i));
@@ -461,9 +408,67 @@ void ForwardRender::Execute(RenderContext& context) {
 		commandList.SetVertexBuffers(0, (unsigned)vertexBuffers.size(), vertexBuffers.data(), sizes.data(), strides.data());
 		commandList.SetIndexBuffer(&mesh->GetIndexBuffer(), mesh->IsIndexBuffer32Bit());
 
-		// Drawcall
-		commandList.DrawIndexedInstanced((unsigned)mesh->GetIndexBuffer().GetIndexCount());
+		// Submeshes with the same material shader share the pipeline state and the bindings, only the material changes
+		const ScenarioData* currentScenario = nullptr;
+		for (const Mesh::Submesh& submesh : mesh->GetSubmeshes()) {
+			Material* material = entity->GetMaterial(submesh.materialSlot);
+			assert(material != nullptr);
+
+			const MaterialShader* materialShader = material->GetShader();
+			assert(materialShader != nullptr);
+
+			ScenarioData& scenario = GetScenario(
+				context, *mesh, *materialShader, m_rtv.GetDescription().format, m_dsv.GetDescription().format);
+
+			if (&scenario != currentScenario) {
+				currentScenario = &scenario;
+
+				// Set pipeline state & binder
+				commandList.SetPipelineState(scenario.pso.get());
+				commandList.SetGraphicsBinder(&scenario.binder);
+
+				commandList.SetResourceState(m_pointLightShadowMapTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+				commandList.SetResourceState(m_cascadedShadowMapTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+				commandList.SetResourceState(m_shadowMXTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+				commandList.SetResourceState(m_csmSplitsTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+				commandList.SetResourceState(m_lightMVPTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+
+				commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 400), m_pointLightShadowMapTexView);
+
+				commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 500), m_cascadedShadowMapTexView);
+				commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 501), m_shadowMXTexView);
+				commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 502), m_csmSplitsTexView);
+				commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 503), m_lightMVPTexView);
 
+				commandList.SetResourceState(m_lightCullDataView.GetResource(), {gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE	});
+
+				commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 600), m_lightCullDataView);
+
+				// Set vertex and light constants
+				commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 0), &vsConstants, sizeof(vsConstants));
+				if (skinned) {
+					commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 1), skinConstants.data(), sizeof(Mat44_Packed) * skinConstants.size());
+				}
+				commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 100), &lightConstants, sizeof(lightConstants));
+				commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 600), &uniformsCBData, sizeof(uniformsCBData));
+			}
+
+			// Set material parameters
+			// Textures are read from the bindless table, only their states have to be right.
+			for (size_t paramIdx = 0; paramIdx < material->GetParameterCount(); ++paramIdx) {
+				const Material::Parameter& param = (*material)[paramIdx];
+				if (param.GetType() == eMaterialShaderParamType::BITMAP_COLOR_2D || param.GetType() == eMaterialShaderParamType::BITMAP_VALUE_2D) {
+					commandList.SetResourceState(((Image*)param)->GetSrv().GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+				}
+			}
+			if (scenario.constantsSize > 0) {
+				// parameters and texture indices live in the material's own buffer, only uploaded when they change
+				commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 200), material->GetConstantBuffer());
+			}
+
+			// Drawcall
+			commandList.DrawIndexedInstanced(submesh.numIndices, submesh.firstIndex, submesh.baseVertex);
+		}
 	}
 }
 
@@ -471,20 +476,22 @@ void ForwardRender::Execute(RenderContext& context) {
 
 ForwardRender::ScenarioData& ForwardRender::GetScenario(
 	RenderContext& context,
-	const Mesh::Layout& layout,
+	const Mesh& mesh,
 	const MaterialShader& shader,
 	gxapi::eFormat renderTargetFormat,
 	gxapi::eFormat depthStencilFormat)
 {
-	std::string shaderCode = shader.GetShaderCode();
+	const Mesh::Layout& layout = mesh.GetLayout();
+	const bool skinned = mesh.IsSkinned();
+	uint32_t shaderId = shader.GetId();
 
-	ScenarioDesc key{ layout, shaderCode };
+	ScenarioDesc key{ layout, shaderId };
 	auto scenarioIt = m_scenarios.find(key);
 
 	// Create scenario PSO if needed
 	if (scenarioIt == m_scenarios.end()) {
 		auto vsIt = m_vertexShaders.find(layout);
-		auto psIt = m_materialShaders.find(shaderCode);
+		auto psIt = m_materialShaders.find(shaderId);
 
 		// Compile vertex shader if needed
 		if (vsIt == m_vertexShaders.end()) {
@@ -500,7 +507,7 @@ ForwardRender::ScenarioData& ForwardRender::GetScenario(
 			std::string psCode = GeneratePixelShader(shader);
 			ShaderParts psParts;
 			psParts.ps = true;
-			auto res = m_materialShaders.insert({ shaderCode, context.CompileShader(psCode, psParts, "") });
+			auto res = m_materialShaders.insert({ shaderId, context.CompileShader(psCode, psParts, "") });
 			psIt = res.first;
 		}
 
@@ -510,8 +517,8 @@ ForwardRender::ScenarioData& ForwardRender::GetScenario(
 		size_t constantsSize;
 		Binder binder;
 
-		binder = GenerateBinder(context, shader.GetShaderParameters(), offsets, constantsSize);
-		pso = CreatePso(context, binder, vsIt->second.vs, psIt->second.ps, renderTargetFormat, depthStencilFormat);
+		binder = GenerateBinder(context, shader.GetShaderParameters(), skinned, offsets, constantsSize);
+		pso = CreatePso(context, binder, layout, skinned, vsIt->second.vs, psIt->second.ps, renderTargetFormat, depthStencilFormat);
 
 		auto res = m_scenarios.insert({ key, ScenarioData() });
 		scenarioIt = res.first;
@@ -526,9 +533,9 @@ ForwardRender::ScenarioData& ForwardRender::GetScenario(
 		|| scenarioIt->second.depthStencilFormat != depthStencilFormat)
 	{
 		auto& vs = m_vertexShaders.at(layout).vs;
-		auto& ps = m_materialShaders.at(shaderCode).ps;
+		auto& ps = m_materialShaders.at(shaderId).ps;
 
-		auto newPso = CreatePso(context, scenarioIt->second.binder, vs, ps, renderTargetFormat, depthStencilFormat);
+		auto newPso = CreatePso(context, scenarioIt->second.binder, layout, skinned, vs, ps, renderTargetFormat, depthStencilFormat);
 
 		scenarioIt->second.pso = std::move(newPso);
 		scenarioIt->second.renderTargetFormat = renderTargetFormat;
@@ -549,13 +556,41 @@ std::string ForwardRender::GenerateVertexShader(const Mesh::Layout& layout) {
 	}
 
 	auto& elements = layout[0];
-	if (elements.size() != 3
+	if ((elements.size() != 3 && elements.size() != 5)
 		|| elements[0].semantic != eVertexElementSemantic::POSITION
 		|| elements[1].semantic != eVertexElementSemantic::NORMAL
 		|| elements[2].semantic != eVertexElementSemantic::TEX_COORD)
 	{
 		throw InvalidArgumentException("Mesh must have 3 attributes: position, normal, texcoord.");
 	}
+	const bool skinned = elements.size() == 5;
+	if (skinned
+		&& (elements[3].semantic != eVertexElementSemantic::BONE_INDICES
+			|| elements[4].semantic != eVertexElementSemantic::BONE_WEIGHTS))
+	{
+		throw InvalidArgumentException("Skinned meshes must have 2 more attributes: bone indices, bone weights.");
+	}
+
+	// Vertices are moved into the bind space of the mesh first, the rest of the shader is the same.
+	std::string skinConstants;
+	std::string skinInputs;
+	std::string skinning;
+	if (skinned) {
+		skinConstants =
+			"struct SkinConstants\n"
+			"{\n"
+			"	float4x4 bones[" + std::to_string(MeshEntity::MaxSkinMatrices) + "];\n"
+			"};\n"
+			"ConstantBuffer<SkinConstants> skinConstants : register(b1);\n";
+		skinInputs = ", uint4 boneIndices : BONE_INDICES, float4 boneWeights : BONE_WEIGHTS";
+		skinning =
+			"	float4x4 skin = boneWeights.x * skinConstants.bones[boneIndices.x]\n"
+			"		+ boneWeights.y * skinConstants.bones[boneIndices.y]\n"
+			"		+ boneWeights.z * skinConstants.bones[boneIndices.z]\n"
+			"		+ boneWeights.w * skinConstants.bones[boneIndices.w];\n"
+			"	position = float4(mul(float4(position.xyz, 1.0f), skin).xyz, 1.0f);\n"
+			"	normal.xyz = mul(normal.xyz, (float3x3)skin);\n";
+	}
 
 	std::string vertexShader =
 		"Texture2D<float4> lightMVPTex : register(t503);"
@@ -569,6 +604,7 @@ std::string ForwardRender::GenerateVertexShader(const Mesh::Layout& layout) {
 		"	float4x4 P;\n"
 		"};\n"
 		"ConstantBuffer<VsConstants> vsConstants : register(b0);\n"
+		+ skinConstants +
 
 		"struct PS_Input\n"
 		"{\n"
@@ -581,9 +617,10 @@ std::string ForwardRender::GenerateVertexShader(const Mesh::Layout& layout) {
 		"	float4 currPosition : TEX_COORD4;\n"
 		"};\n"
 
-		"PS_Input VSMain(float4 position : POSITION, float4 normal : NORMAL, float4 texCoord : TEX_COORD)\n"
+		"PS_Input VSMain(float4 position : POSITION, float4 normal : NORMAL, float4 texCoord : TEX_COORD" + skinInputs + ")\n"
 		"{\n"
 		"	PS_Input result;\n"
+		+ skinning +
 		//"	normal.xyz = normalize(normal.xyz);\n"
 		"	float3 viewNormal = mul(normal.xyz, (float3x3)vsConstants.MV);\n"
 
@@ -619,10 +656,7 @@ std::string ForwardRender::GeneratePixelShader(const MaterialShader& shader) {
 	shadingFunction = shader.GetShaderCode();
 
 	// rename "main" to something else
-	std::stringstream renameMain;
-	std::regex renameRegex("main");
-	std::regex_replace(std::ostreambuf_iterator<char>(renameMain), shadingFunction.begin(), shadingFunction.end(), renameRegex, "mtl_shader");
-	shadingFunction = renameMain.str();
+	shadingFunction = MaterialShader::RenameIdentifier(shadingFunction, "main", "mtl_shader");
 
 	// structures
 	std::string structures =
@@ -667,6 +701,7 @@ std::string ForwardRender::GeneratePixelShader(const MaterialShader& shader) {
 
 	mtlConstantBuffer << "struct MtlConstants { \n";
 	int numMtlConstants = 0;
+	int numTextures = 0;
 	for (size_t i = 0; i < params.size(); ++i) {
 		switch (params[i].type) {
 			case eMaterialShaderParamType::COLOR:
@@ -682,19 +717,22 @@ std::string ForwardRender::GeneratePixelShader(const MaterialShader& shader) {
 				break;
 			}
 			case eMaterialShaderParamType::BITMAP_COLOR_2D:
-			{
-				textures << "Texture2DArray<float4> tex" << i << " : register(t" << i << "); \n";
-				textures << "SamplerState samp" << i << " : register(s" << i << "); \n";
-				break;
-			}
 			case eMaterialShaderParamType::BITMAP_VALUE_2D:
 			{
-				textures << "Texture2DArray<float> tex" << i << " : register(t" << i << "); \n";
-				textures << "SamplerState samp" << i << " : register(s" << i << "); \n";
+				mtlConstantBuffer << "    uint param" << i << "; \n";
+				// each texture keeps its own sampler, only the descriptors come from the bindless table
+				textures << "SamplerState g_mtlSampler" << i << " : register(s" << numTextures << "); \n";
+				++numMtlConstants;
+				++numTextures;
 				break;
 			}
 		}
 	}
+	if (numTextures > 0) {
+		// both arrays alias the same bindless table, see GenerateBinder
+		textures << "Texture2DArray<float4> g_bindlessColorMaps[" << BindlessTextureHeap::Capacity << "] : register(t0, space100); \n";
+		textures << "Texture2DArray<float> g_bindlessValueMaps[" << BindlessTextureHeap::Capacity << "] : register(t0, space101); \n";
+	}
 	mtlConstantBuffer << "};\n";
 	mtlConstantBuffer << "ConstantBuffer<MtlConstants> mtlCb: register(b200); \n";
 	if (numMtlConstants == 0) {
@@ -732,15 +770,15 @@ std::string ForwardRender::GeneratePixelShader(const MaterialShader& shader) {
 			case eMaterialShaderParamType::BITMAP_COLOR_2D:
 			{
 				PSMain << "    MapColor2D input" << i << "; \n";
-				PSMain << "    input" << i << ".tex = tex" << i << "; \n";
-				PSMain << "    input" << i << ".samp = samp" << i << "; \n\n";
+				PSMain << "    input" << i << ".tex = g_bindlessColorMaps[mtlCb.param" << i << "]; \n";
+				PSMain << "    input" << i << ".samp = g_mtlSampler" << i << "; \n\n";
 				break;
 			}
 			case eMaterialShaderParamType::BITMAP_VALUE_2D:
 			{
 				PSMain << "    MapValue2D input" << i << "; \n";
-				PSMain << "    input" << i << ".tex = tex" << i << "; \n";
-				PSMain << "    input" << i << ".samp = samp" << i << "; \n\n";
+				PSMain << "    input" << i << ".tex = g_bindlessValueMaps[mtlCb.param" << i << "]; \n";
+				PSMain << "    input" << i << ".samp = g_mtlSampler" << i << "; \n\n";
 				break;
 			}
 		}
@@ -777,51 +815,15 @@ std::string ForwardRender::GeneratePixelShader(const MaterialShader& shader) {
 		+ PSMain.str();
 }
 
-Binder ForwardRender::GenerateBinder(RenderContext& context, const std::vector<MaterialShaderParameter>& mtlParams, std::vector<int>& offsets, size_t& materialCbSize) {
-	int textureRegister = 0;
-	int cbSize = 0;
+Binder ForwardRender::GenerateBinder(RenderContext& context, const std::vector<MaterialShaderParameter>& mtlParams, bool skinned, std::vector<int>& offsets, size_t& materialCbSize) {
 	std::vector<BindParameterDesc> descs;
-	offsets.clear();
-
-	for (auto& param : mtlParams) {
-		switch (param.type) {
-		case eMaterialShaderParamType::BITMAP_COLOR_2D:
-		case eMaterialShaderParamType::BITMAP_VALUE_2D:
-		{
-			BindParameterDesc desc;
-			desc.parameter = BindParameter(eBindParameterType::TEXTURE, textureRegister);
-			desc.constantSize = 0;
-			desc.relativeAccessFrequency = 0;
-			desc.relativeChangeFrequency = 0;
-			desc.shaderVisibility = gxapi::eShaderVisiblity::PIXEL;
-			descs.push_back(desc);
-
-			offsets.push_back(desc.parameter.reg);
-
-			++textureRegister;
-
-			break;
-		}
-		case eMaterialShaderParamType::COLOR:
-		{
-			cbSize = ((cbSize + 15) / 16) * 16; // correct alignement
-			offsets.push_back(cbSize);
-			cbSize += 16;
 
-			break;
-		}
-		case eMaterialShaderParamType::VALUE:
-		{
-			cbSize = ((cbSize + 3) / 4) * 4; // correct alignement
-			offsets.push_back(cbSize);
-			cbSize += sizeof(float);
+	size_t cbSize;
+	Material::CalculateConstantLayout(mtlParams, offsets, cbSize);
 
-			break;
-		}
-		default:
-			assert(false);;
-		}
-	}
+	int numTextures = (int)std::count_if(mtlParams.begin(), mtlParams.end(), [](const MaterialShaderParameter& param) {
+		return param.type == eMaterialShaderParamType::BITMAP_COLOR_2D || param.type == eMaterialShaderParamType::BITMAP_VALUE_2D;
+	});
 
 	BindParameterDesc theSamplerDesc;
 	theSamplerDesc.parameter = BindParameter(eBindParameterType::SAMPLER, 500);
@@ -896,6 +898,13 @@ Binder ForwardRender::GenerateBinder(RenderContext& context, const std::vector<M
 	vsCbDesc.relativeChangeFrequency = 0;
 	vsCbDesc.shaderVisibility = gxapi::eShaderVisiblity::VERTEX;
 
+	BindParameterDesc skinCbDesc;
+	skinCbDesc.parameter = BindParameter(eBindParameterType::CONSTANT, 1);
+	skinCbDesc.constantSize = sizeof(Mat44_Packed) * MeshEntity::MaxSkinMatrices;
+	skinCbDesc.relativeAccessFrequency = 0;
+	skinCbDesc.relativeChangeFrequency = 0;
+	skinCbDesc.shaderVisibility = gxapi::eShaderVisiblity::VERTEX;
+
 	BindParameterDesc lightCbDesc;
 	lightCbDesc.parameter = BindParameter(eBindParameterType::CONSTANT, 100);
 	lightCbDesc.constantSize = sizeof(LightConstants);
@@ -905,7 +914,7 @@ Binder ForwardRender::GenerateBinder(RenderContext& context, const std::vector<M
 
 	BindParameterDesc mtlCbDesc;
 	mtlCbDesc.parameter = BindParameter(eBindParameterType::CONSTANT, 200);
-	mtlCbDesc.constantSize = cbSize;
+	mtlCbDesc.constantSize = 0; // bound by address from the material's persistent buffer
 	mtlCbDesc.relativeAccessFrequency = 0;
 	mtlCbDesc.relativeChangeFrequency = 0;
 	mtlCbDesc.shaderVisibility = gxapi::eShaderVisiblity::PIXEL;
@@ -928,6 +937,9 @@ Binder ForwardRender::GenerateBinder(RenderContext& context, const std::vector<M
 	samplerParam.shaderVisibility = gxapi::eShaderVisiblity::PIXEL;
 
 	descs.push_back(vsCbDesc);
+	if (skinned) {
+		descs.push_back(skinCbDesc);
+	}
 	descs.push_back(lightCbDesc);
 	descs.push_back(lightUniformsCbDesc);
 
@@ -945,7 +957,21 @@ Binder ForwardRender::GenerateBinder(RenderContext& context, const std::vector<M
 	}
 
 	std::vector<gxapi::StaticSamplerDesc> samplerParams;
-	for (int i = 0; i < textureRegister; ++i) {
+	if (numTextures > 0) {
+		BindParameterDesc bindlessDesc;
+		bindlessDesc.parameter = BindParameter(eBindParameterType::TEXTURE, 0, 100);
+		bindlessDesc.constantSize = 0;
+		bindlessDesc.relativeAccessFrequency = 0;
+		bindlessDesc.relativeChangeFrequency = 0;
+		bindlessDesc.shaderVisibility = gxapi::eShaderVisiblity::PIXEL;
+		bindlessDesc.bindlessTableSize = BindlessTextureHeap::Capacity;
+		descs.push_back(bindlessDesc);
+		bindlessDesc.parameter.space = 101;
+		descs.push_back(bindlessDesc);
+	}
+
+	// one static sampler per texture parameter, in the order of the parameters
+	for (int i = 0; i < numTextures; ++i) {
 		samplerDesc.parameter.reg = i;
 		samplerParam.shaderRegister = i;
 		descs.push_back(samplerDesc);
@@ -963,6 +989,8 @@ Binder ForwardRender::GenerateBinder(RenderContext& context, const std::vector<M
 std::unique_ptr<gxapi::IPipelineState> ForwardRender::CreatePso(
 	RenderContext& context,
 	Binder& binder,
+	const Mesh::Layout& layout,
+	bool skinned,
 	ShaderStage& vs,
 	ShaderStage & ps,
 	gxapi::eFormat renderTargetFormat,
@@ -975,6 +1003,16 @@ std::unique_ptr<gxapi::IPipelineState> ForwardRender::CreatePso(
 		gxapi::InputElementDesc("NORMAL", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 12),
 		gxapi::InputElementDesc("TEX_COORD", 0, gxapi::eFormat::R32G32_FLOAT, 0, 24),
 	};
+	if (skinned) {
+		for (const auto& element : layout[0]) {
+			if (element.semantic == eVertexElementSemantic::BONE_INDICES) {
+				inputElementDesc.push_back(gxapi::InputElementDesc("BONE_INDICES", 0, gxapi::eFormat::R32G32B32A32_UINT, 0, element.offset));
+			}
+			else if (element.semantic == eVertexElementSemantic::BONE_WEIGHTS) {
+				inputElementDesc.push_back(gxapi::InputElementDesc("BONE_WEIGHTS", 0, gxapi::eFormat::R32G32B32A32_FLOAT, 0, element.offset));
+			}
+		}
+	}
 
 	gxapi::GraphicsPipelineStateDesc psoDesc;
 	psoDesc.inputLayout.elements = inputElementDesc.data();
@@ -38,7 +38,7 @@ class ForwardRender :
 private:
 	struct ScenarioDesc {
 		Mesh::Layout layout;
-		std::string shader;
+		uint32_t shaderId; // MaterialShader::GetId()
 	};
 	struct ScenarioData {
 		std::unique_ptr<gxapi::IPipelineState> pso;
@@ -76,10 +76,12 @@ public:
 private:
 	static std::string GenerateVertexShader(const Mesh::Layout& layout);
 	static std::string GeneratePixelShader(const MaterialShader& shader);
-	Binder GenerateBinder(RenderContext& context, const std::vector<MaterialShaderParameter>& mtlParams, std::vector<int>& offsets, size_t& materialCbSize);
+	Binder GenerateBinder(RenderContext& context, const std::vector<MaterialShaderParameter>& mtlParams, bool skinned, std::vector<int>& offsets, size_t& materialCbSize);
 	std::unique_ptr<gxapi::IPipelineState> CreatePso(
 		RenderContext& context,
 		Binder& binder,
+		const Mesh::Layout& layout,
+		bool skinned,
 		ShaderStage& vs,
 		ShaderStage& ps,
 		gxapi::eFormat renderTargetFormat,
@@ -87,7 +89,7 @@ private:
 
 	ScenarioData& GetScenario(
 		RenderContext& context,
-		const Mesh::Layout& layout,
+		const Mesh& mesh,
 		const MaterialShader& shader,
 		gxapi::eFormat renderTargetFormat,
 		gxapi::eFormat depthStencilFormat);
@@ -122,12 +124,12 @@ private:
 		size_t operator()(const Mesh::Layout& lhs, const Mesh::Layout& rhs) const { return lhs.EqualElements(rhs); }
 	};
 	struct ScenarioHash {
-		size_t operator()(const ScenarioDesc& obj) const { return obj.layout.GetLayoutHash() ^ std::hash<std::string>()(obj.shader); }
+		size_t operator()(const ScenarioDesc& obj) const { return obj.layout.GetLayoutHash() ^ std::hash<uint32_t>()(obj.shaderId); }
 		size_t operator()(const ScenarioDesc& lhs, const ScenarioDesc& rhs) const { 
-			return lhs.layout.EqualLayout(rhs.layout) && lhs.shader == rhs.shader;
+			return lhs.layout.EqualLayout(rhs.layout) && lhs.shaderId == rhs.shaderId;
 		}
 	};
-	std::unordered_map<std::string, ShaderProgram> m_materialShaders; // maps MaterialShader codes to pixel shaders
+	std::unordered_map<uint32_t, ShaderProgram> m_materialShaders; // maps MaterialShader ids to pixel shaders
 	std::unordered_map<Mesh::Layout, ShaderProgram, ElementHash, ElementHash> m_vertexShaders; // maps Mesh layouts to vertex shaders
 	std::unordered_map<ScenarioDesc, ScenarioData, ScenarioHash, ScenarioHash> m_scenarios; // maps mesh-mtlshader pairs to PSOs
 };
@@ -430,7 +430,6 @@ void Voxelization::Execute(RenderContext & context) {
 			for (const MeshEntity* entity : *m_entities) {
 				// Get entity parameters
 				Mesh* mesh = entity->GetMesh();
-				Material* material = entity->GetMaterial();
 				auto position = entity->GetPosition();
 
 				if (mesh->GetIndexBuffer().GetIndexCount() == 3600)
@@ -438,6 +437,11 @@ void Voxelization::Execute(RenderContext & context) {
 					continue; //skip quadcopter for visualization purposes (obscures camera...)
 				}
 
+				// Skinned meshes are only drawn by the depth prepass and the forward pass
+				if (mesh->IsSkinned()) {
+					continue;
+				}
+
 				// Draw mesh
 				if (!CheckMeshFormat(*mesh)) {
 					assert(false);
@@ -450,17 +454,6 @@ void Voxelization::Execute(RenderContext & context) {
 
 				commandList.BindGraphics(m_uniformsBindParam, &uniformsCBData, sizeof(Uniforms));
 
-				for (size_t paramIdx = 0; paramIdx < material->GetParameterCount(); ++paramIdx) {
-					const Material::Parameter& param = (*material)[paramIdx];
-					if (param.GetType() == eMaterialShaderParamType::BITMAP_COLOR_2D ||
-						param.GetType() == eMaterialShaderParamType::BITMAP_VALUE_2D)
-					{
-						commandList.SetResourceState(((Image*)param)->GetSrv().GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
-						commandList.BindGraphics(m_albedoTexBindParam, ((Image*)param)->GetSrv());
-						break;
-					}
-				}
-
 				for (auto& vb : vertexBuffers) {
 					commandList.SetResourceState(*vb, gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
 				}
@@ -468,7 +461,23 @@ void Voxelization::Execute(RenderContext & context) {
 				commandList.SetResourceState(mesh->GetIndexBuffer(), gxapi::eResourceState::INDEX_BUFFER);
 				commandList.SetVertexBuffers(0, (unsigned)vertexBuffers.size(), vertexBuffers.data(), sizes.data(), strides.data());
 				commandList.SetIndexBuffer(&mesh->GetIndexBuffer(), mesh->IsIndexBuffer32Bit());
-				commandList.DrawIndexedInstanced((unsigned)mesh->GetIndexBuffer().GetIndexCount());
+
+				// The buffers are shared, only the albedo changes between submeshes
+				for (const Mesh::Submesh& submesh : mesh->GetSubmeshes()) {
+					Material* material = entity->GetMaterial(submesh.materialSlot);
+					for (size_t paramIdx = 0; paramIdx < material->GetParameterCount(); ++paramIdx) {
+						const Material::Parameter& param = (*material)[paramIdx];
+						if (param.GetType() == eMaterialShaderParamType::BITMAP_COLOR_2D ||
+							param.GetType() == eMaterialShaderParamType::BITMAP_VALUE_2D)
+						{
+							commandList.SetResourceState(((Image*)param)->GetSrv().GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+							commandList.BindGraphics(m_albedoTexBindParam, ((Image*)param)->GetSrv());
+							break;
+						}
+					}
+
+					commandList.DrawIndexedInstanced(submesh.numIndices, submesh.firstIndex, submesh.baseVertex);
+				}
 			}
 
 			commandList.UAVBarrier(m_voxelTexUAV[0].GetResource());
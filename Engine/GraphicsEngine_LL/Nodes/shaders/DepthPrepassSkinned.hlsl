@@ -0,0 +1,40 @@
+
+struct Transform
+{
+	float4x4 MVP;
+};
+
+struct SkinConstants
+{
+	float4x4 bones[64];
+};
+
+
+ConstantBuffer<Transform> transform : register(b0);
+ConstantBuffer<SkinConstants> skin : register(b1);
+
+struct PS_Input
+{
+	float4 position : SV_POSITION;
+};
+
+
+PS_Input VSMain(float4 position : POSITION, uint4 boneIndices : BONE_INDICES, float4 boneWeights : BONE_WEIGHTS)
+{
+	PS_Input result;
+
+	float4x4 skinMatrix = boneWeights.x * skin.bones[boneIndices.x]
+		+ boneWeights.y * skin.bones[boneIndices.y]
+		+ boneWeights.z * skin.bones[boneIndices.z]
+		+ boneWeights.w * skin.bones[boneIndices.w];
+	float4 skinnedPosition = float4(mul(float4(position.xyz, 1.0f), skinMatrix).xyz, 1.0f);
+
+    result.position = mul(skinnedPosition, transform.MVP);
+
+	return result;
+}
+
+
+void PSMain(PS_Input input)
+{
+}
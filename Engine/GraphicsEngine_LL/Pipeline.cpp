@@ -4,6 +4,9 @@
 #include "Pipeline.hpp"
 #include "GraphicsNodeFactory.hpp"
 #include "GraphicsNode.hpp"
+#include "Nodes/Node_GetBackBuffer.hpp"
+#include "Nodes/Node_GetEnvVariable.hpp"
+#include "Nodes/Node_TextureProperties.hpp"
 
 #include <BaseLibrary/Exception/Exception.hpp>
 
@@ -13,6 +16,9 @@
 #include <cassert>
 #include <optional>
 #include <typeinfo>
+#include <thread>
+#include <algorithm>
+#include <unordered_map>
 
 
 namespace inl {
@@ -102,6 +108,8 @@ Pipeline::NodeIterator Pipeline::NodeIterator::operator++(int) const {
 
 Pipeline::Pipeline()
 	: m_nodeMap(m_dependencyGraph),
+	m_liveNodeMap(m_dependencyGraph, true),
+	m_constantNodeMap(m_dependencyGraph, false),
 	m_taskFunctionMap(m_taskGraph),
 	m_taskParentMap(m_taskGraph, lemon::INVALID)
 {}
@@ -112,6 +120,8 @@ Pipeline::Pipeline(Pipeline&& rhs) : Pipeline() {
 	lemon::DigraphCopy<decltype(rhs.m_dependencyGraph), decltype(this->m_dependencyGraph)>
 		depCopy(rhs.m_dependencyGraph, this->m_dependencyGraph);
 	depCopy.nodeMap(rhs.m_nodeMap, this->m_nodeMap);
+	depCopy.nodeMap(rhs.m_liveNodeMap, this->m_liveNodeMap);
+	depCopy.nodeMap(rhs.m_constantNodeMap, this->m_constantNodeMap);
 	depCopy.run();
 
 	lemon::DigraphCopy<decltype(rhs.m_taskGraph), decltype(this->m_taskGraph)>
@@ -263,7 +273,7 @@ void Pipeline::CreateFromDescription(const std::string& jsonDescription, Graphic
 
 
 	// Finish by creating the actual pipeline.
-	EngineContext engineContext(1, 1);
+	EngineContext engineContext(std::max(1, (int)std::thread::hardware_concurrency()), 1);
 	for (auto& node : nodeObjects) {
 		if (auto graphicsNode = dynamic_cast<GraphicsNode*>(node.get())) {
 			graphicsNode->Initialize(engineContext);
@@ -284,6 +294,7 @@ void Pipeline::CreateFromNodesList(const std::vector<std::shared_ptr<NodeBase>>
 	// calculate graphs
 	try {
 		CalculateDependencyGraph();
+		CalculateLiveNodes();
 		CalculateTaskGraph();
 	}
 	catch (...) {
@@ -293,10 +304,14 @@ void Pipeline::CreateFromNodesList(const std::vector<std::shared_ptr<NodeBase>>
 
 	// check if graphs are DAGs
 	// note: if task graph is a DAG => dep. graph must be a DAG
+	// note: dead nodes are not in the task graph, check them too
 	bool isTaskGraphDAG = lemon::dag(m_taskGraph);
-	if (!isTaskGraphDAG) {
+	bool isDependencyGraphDAG = lemon::dag(m_dependencyGraph);
+	if (!isTaskGraphDAG || !isDependencyGraphDAG) {
 		throw InvalidArgumentException("Supplied nodes do not make a directed acyclic graph.");
 	}
+
+	CalculateConstantNodes();
 }
 
 
@@ -432,6 +447,11 @@ void Pipeline::CalculateTaskGraph() {
 		NodeBase* pipelineNode = m_nodeMap[depNode].get();
 		assert(pipelineNode != nullptr); // each graph node must have a pipeline node assigned
 
+		// Dead nodes get no tasks
+		if (!m_liveNodeMap[depNode]) {
+			continue;
+		}
+
 		// Merge subgraph of graphics pipeline node into expanded task graph
 		if (gxeng::GraphicsNode* graphicsPipelineNode = dynamic_cast<gxeng::GraphicsNode*>(pipelineNode)) {
 			const lemon::ListDigraph& subtaskNodes = graphicsPipelineNode->GetTaskGraph();
@@ -527,7 +547,11 @@ void Pipeline::CalculateTaskGraph() {
 	}
 
 	// Connect sources and sinks according to dependencyGraph
+	// note: a live node's dependencies are all live
 	for (lemon::ListDigraph::ArcIt depArc(m_dependencyGraph); depArc != lemon::INVALID; ++depArc) {
+		if (!m_liveNodeMap[m_dependencyGraph.target(depArc)]) {
+			continue;
+		}
 		auto source = sourceSinkMapping[m_dependencyGraph.source(depArc)].sink;
 		auto target = sourceSinkMapping[m_dependencyGraph.target(depArc)].source;
 		m_taskGraph.addArc(source, target);
@@ -569,6 +593,134 @@ void Pipeline::CalculateDependencyGraph() {
 }
 
 
+void Pipeline::CalculateLiveNodes() {
+	// The image is rendered into the back buffer, so the nodes that matter are the ones which
+	// the back buffer flows through, and everything that they depend on.
+	// A sink is the end of such a flow: a node that receives the back buffer (or a texture that was
+	// passed along with it) and has texture outputs, but passes none of them on.
+	// Nodes without outputs are kept as sinks as well, they can only be there for their side effects.
+
+	std::unordered_map<const InputPortBase*, lemon::ListDigraph::Node> inputOwners;
+	std::vector<lemon::ListDigraph::Node> stack;
+	lemon::ListDigraph::NodeMap<bool> receivesBackBuffer(m_dependencyGraph, false);
+	for (lemon::ListDigraph::NodeIt depNode(m_dependencyGraph); depNode != lemon::INVALID; ++depNode) {
+		NodeBase* node = m_nodeMap[depNode].get();
+		for (size_t i = 0; i < node->GetNumInputs(); ++i) {
+			inputOwners[node->GetInput(i)] = depNode;
+		}
+		if (dynamic_cast<nodes::GetBackBuffer*>(node)) {
+			receivesBackBuffer[depNode] = true;
+			stack.push_back(depNode);
+		}
+		m_liveNodeMap[depNode] = true;
+	}
+
+	// Without a back buffer, there's no telling what the pipeline renders to, keep everything.
+	if (stack.empty()) {
+		return;
+	}
+
+	// Follow the textures that leave the back buffer's nodes.
+	while (!stack.empty()) {
+		NodeBase* node = m_nodeMap[stack.back()].get();
+		stack.pop_back();
+		for (size_t i = 0; i < node->GetNumOutputs(); ++i) {
+			OutputPortBase* output = node->GetOutput(i);
+			if (output->GetType() != typeid(Texture2D)) {
+				continue;
+			}
+			for (InputPortBase* input : *output) {
+				auto it = inputOwners.find(input);
+				if (it != inputOwners.end() && !receivesBackBuffer[it->second]) {
+					receivesBackBuffer[it->second] = true;
+					stack.push_back(it->second);
+				}
+			}
+		}
+	}
+
+	// Find sinks.
+	for (lemon::ListDigraph::NodeIt depNode(m_dependencyGraph); depNode != lemon::INVALID; ++depNode) {
+		NodeBase* node = m_nodeMap[depNode].get();
+		bool hasTextureOutput = false;
+		bool hasLinkedTextureOutput = false;
+		for (size_t i = 0; i < node->GetNumOutputs(); ++i) {
+			OutputPortBase* output = node->GetOutput(i);
+			if (output->GetType() == typeid(Texture2D)) {
+				hasTextureOutput = true;
+				hasLinkedTextureOutput = hasLinkedTextureOutput || output->begin() != output->end();
+			}
+		}
+
+		bool isSink = node->GetNumOutputs() == 0 || (receivesBackBuffer[depNode] && hasTextureOutput && !hasLinkedTextureOutput);
+		m_liveNodeMap[depNode] = isSink;
+		if (isSink) {
+			stack.push_back(depNode);
+		}
+	}
+
+	// Everything sinks depend on is live.
+	while (!stack.empty()) {
+		lemon::ListDigraph::Node depNode = stack.back();
+		stack.pop_back();
+		for (lemon::ListDigraph::InArcIt arc(m_dependencyGraph, depNode); arc != lemon::INVALID; ++arc) {
+			lemon::ListDigraph::Node dependency = m_dependencyGraph.source(arc);
+			if (!m_liveNodeMap[dependency]) {
+				m_liveNodeMap[dependency] = true;
+				stack.push_back(dependency);
+			}
+		}
+	}
+}
+
+
+void Pipeline::CalculateConstantNodes() {
+	// A node is constant if it computes its outputs from its inputs only, and all of its inputs are constant.
+	// Plain nodes (arithmetic, logic, etc.) do so, environment variables only change when set again, and the
+	// properties of the back buffer only change when the screen is resized. Other graphics nodes are never constant.
+
+	lemon::ListDigraph::NodeMap<int> order(m_dependencyGraph);
+	lemon::topologicalSort(m_dependencyGraph, order);
+	std::vector<lemon::ListDigraph::Node> sortedNodes;
+	for (lemon::ListDigraph::NodeIt depNode(m_dependencyGraph); depNode != lemon::INVALID; ++depNode) {
+		sortedNodes.push_back(depNode);
+	}
+	std::sort(sortedNodes.begin(), sortedNodes.end(), [&order](const auto& lhs, const auto& rhs) {
+		return order[lhs] < order[rhs];
+	});
+
+	std::unordered_map<const OutputPortBase*, lemon::ListDigraph::Node> outputOwners;
+	for (auto depNode : sortedNodes) {
+		NodeBase* node = m_nodeMap[depNode].get();
+		for (size_t i = 0; i < node->GetNumOutputs(); ++i) {
+			outputOwners[node->GetOutput(i)] = depNode;
+		}
+	}
+
+	for (auto depNode : sortedNodes) {
+		NodeBase* node = m_nodeMap[depNode].get();
+		bool isTextureProperties = dynamic_cast<nodes::TextureProperties*>(node) != nullptr;
+		bool isFoldable = dynamic_cast<GraphicsNode*>(node) == nullptr
+			|| dynamic_cast<nodes::GetEnvVariable*>(node) != nullptr
+			|| isTextureProperties;
+
+		bool isConstant = isFoldable && m_liveNodeMap[depNode];
+		for (size_t i = 0; i < node->GetNumInputs() && isConstant; ++i) {
+			OutputPortBase* link = node->GetInput(i)->GetLink();
+			if (link == nullptr) {
+				continue;
+			}
+			auto it = outputOwners.find(link);
+			assert(it != outputOwners.end());
+			NodeBase* source = m_nodeMap[it->second].get();
+			isConstant = m_constantNodeMap[it->second]
+				|| (isTextureProperties && dynamic_cast<nodes::GetBackBuffer*>(source) != nullptr);
+		}
+		m_constantNodeMap[depNode] = isConstant;
+	}
+}
+
+
 bool Pipeline::IsLinked(NodeBase* srcNode, NodeBase* dstNode) {
 	for (size_t dstIn = 0; dstIn < dstNode->GetNumInputs(); dstIn++) {
 		OutputPortBase* linked = dstNode->GetInput(dstIn)->GetLink();
@@ -591,6 +743,13 @@ const lemon::ListDigraph::NodeMap<std::shared_ptr<NodeBase>>& Pipeline::GetNodeM
 	return m_nodeMap;
 }
 
+const lemon::ListDigraph::NodeMap<bool>& Pipeline::GetLiveNodeMap() const {
+	return m_liveNodeMap;
+}
+const lemon::ListDigraph::NodeMap<bool>& Pipeline::GetConstantNodeMap() const {
+	return m_constantNodeMap;
+}
+
 const lemon::ListDigraph& Pipeline::GetTaskGraph() const {
 	return m_taskGraph;
 }
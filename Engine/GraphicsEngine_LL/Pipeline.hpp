@@ -99,6 +99,13 @@ public:
 	const lemon::ListDigraph::NodeMap<GraphicsTask*>& GetTaskFunctionMap() const;
 	const lemon::ListDigraph::NodeMap<lemon::ListDigraph::NodeIt>& GetTaskParentMap() const;
 
+	/// <summary> Tells for each node of the dependency graph if it contributes to the rendered image.
+	///		Dead nodes stay in the pipeline, but they get no tasks. </summary>
+	const lemon::ListDigraph::NodeMap<bool>& GetLiveNodeMap() const;
+	/// <summary> Tells for each node of the dependency graph if its outputs are the same every frame,
+	///		as long as the environment variables and the screen size do not change. </summary>
+	const lemon::ListDigraph::NodeMap<bool>& GetConstantNodeMap() const;
+
 	template <class T>
 	void AddNodeMetaData() = delete;
 	template <class T>
@@ -107,11 +114,15 @@ public:
 private:
 	void CalculateTaskGraph();
 	void CalculateDependencyGraph();
+	void CalculateLiveNodes();
+	void CalculateConstantNodes();
 	bool IsLinked(NodeBase* srcNode, NodeBase* dstNode);
 
 
 	lemon::ListDigraph m_dependencyGraph;
 	lemon::ListDigraph::NodeMap<std::shared_ptr<NodeBase>> m_nodeMap;
+	lemon::ListDigraph::NodeMap<bool> m_liveNodeMap;
+	lemon::ListDigraph::NodeMap<bool> m_constantNodeMap;
 	lemon::ListDigraph m_taskGraph;
 	lemon::ListDigraph::NodeMap<GraphicsTask*> m_taskFunctionMap;
 	lemon::ListDigraph::NodeMap<lemon::ListDigraph::NodeIt> m_taskParentMap;
@@ -2,7 +2,9 @@
 
 
 #include <type_traits>
+#include <cassert>
 #include <cstdint>
+#include <cstddef>
 
 
 namespace inl {
@@ -15,11 +17,26 @@ enum class ePixelChannelType {
 	INT32,
 	//FLOAT16,
 	FLOAT32,
+	// Block compressed, each 4x4 pixel block is one structure. See <see cref="CompressedBlock"/>.
+	BC1, // RGB + 1 bit alpha, 8 bytes
+	BC3, // RGBA, 16 bytes
+	BC4, // R, 8 bytes
+	BC5, // RG, 16 bytes
+	BC7, // RGBA, 16 bytes
 };
 
+constexpr bool IsBlockCompressed(ePixelChannelType channelType) {
+	return channelType == ePixelChannelType::BC1
+		|| channelType == ePixelChannelType::BC3
+		|| channelType == ePixelChannelType::BC4
+		|| channelType == ePixelChannelType::BC5
+		|| channelType == ePixelChannelType::BC7;
+}
+
 enum class ePixelClass {
 	LINEAR,
 	VALUE_EXPONENT,
+	SRGB, // color channels are sRGB encoded, alpha is linear
 };
 
 
@@ -163,5 +180,78 @@ template <ePixelChannelType ChannelType, int ChannelCount>
 typename Pixel<ChannelType, ChannelCount, ePixelClass::LINEAR>::PixelReader Pixel<ChannelType, ChannelCount, ePixelClass::LINEAR>::reader;
 
 
+template <ePixelChannelType ChannelType, int ChannelCount>
+class Pixel<ChannelType, ChannelCount, ePixelClass::SRGB>
+	: public Pixel<ChannelType, ChannelCount, ePixelClass::LINEAR>
+{
+	static_assert(ChannelType == ePixelChannelType::INT8_NORM, "sRGB pixels must have 8 bit channels.");
+public:
+	using Pixel<ChannelType, ChannelCount, ePixelClass::LINEAR>::Pixel;
+
+	/// <summary> Reads and writes the encoded values. </summary>
+	class PixelReader : public Pixel<ChannelType, ChannelCount, ePixelClass::LINEAR>::PixelReader {
+	public:
+		ePixelClass GetPixelClass() const override {
+			return ePixelClass::SRGB;
+		}
+	};
+	static IPixelReader& Reader() {
+		return reader;
+	}
+private:
+	static PixelReader reader;
+};
+
+template <ePixelChannelType ChannelType, int ChannelCount>
+typename Pixel<ChannelType, ChannelCount, ePixelClass::SRGB>::PixelReader Pixel<ChannelType, ChannelCount, ePixelClass::SRGB>::reader;
+
+
+/// <summary> A 4x4 block of a block compressed texture, already encoded. </summary>
+/// <remarks> Pass <see cref="CompressedBlock::Reader"/> to Image::Update to upload compressed data as is.
+/// Its pixels are not addressable, the width and height given to Update are still in pixels. </remarks>
+template <ePixelChannelType ChannelType, ePixelClass Type = ePixelClass::LINEAR>
+class CompressedBlock {
+	static_assert(IsBlockCompressed(ChannelType), "Compressed blocks must have a block compressed channel type.");
+	static_assert(Type != ePixelClass::SRGB || ChannelType == ePixelChannelType::BC1 || ChannelType == ePixelChannelType::BC3 || ChannelType == ePixelChannelType::BC7,
+				  "Only BC1, BC3 and BC7 blocks may be sRGB.");
+public:
+	static constexpr size_t Size = ChannelType == ePixelChannelType::BC1 || ChannelType == ePixelChannelType::BC4 ? 8 : 16;
+	static constexpr int ChannelCount = ChannelType == ePixelChannelType::BC4 ? 1 : ChannelType == ePixelChannelType::BC5 ? 2 : 4;
+
+	uint8_t bytes[Size];
+
+	class PixelReader : public IPixelReader {
+	public:
+		float Get(const void* pixel, int channel) const override {
+			assert(false); // blocks can't be read per pixel
+			return 0.0f;
+		}
+		void Set(void* pixel, int channel, float value) const override {
+			assert(false);
+		}
+		ePixelChannelType GetChannelType() const override {
+			return ChannelType;
+		}
+		int GetChannelCount() const override {
+			return ChannelCount;
+		}
+		ePixelClass GetPixelClass() const override {
+			return Type;
+		}
+		size_t StructureSize() const override {
+			return Size;
+		}
+	};
+	static IPixelReader& Reader() {
+		return reader;
+	}
+private:
+	static PixelReader reader;
+};
+
+template <ePixelChannelType ChannelType, ePixelClass Type>
+typename CompressedBlock<ChannelType, Type>::PixelReader CompressedBlock<ChannelType, Type>::reader;
+
+
 } // namespace gxeng
 } // namespace inl
\ No newline at end of file
@@ -0,0 +1,662 @@
+#include "PixelConversion.hpp"
+
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <immintrin.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+
+
+namespace inl::gxeng {
+
+
+//------------------------------------------------------------------------------
+// Reference conversion
+//------------------------------------------------------------------------------
+
+static float SrgbToLinear(float c) {
+	return c <= 0.04045f ? c / 12.92f : (float)std::pow((c + 0.055) / 1.055, 2.4);
+}
+
+static float LinearToSrgb(float c) {
+	return c <= 0.0031308f ? c * 12.92f : (float)(1.055 * std::pow(c, 1.0 / 2.4) - 0.055);
+}
+
+static float Clamp01(float value) {
+	return std::min(std::max(value, 0.0f), 1.0f);
+}
+
+
+static float ReadChannel(const uint8_t* pixel, const PixelFormat& format, int channel) {
+	float value = 0.0f;
+	switch (format.channelType) {
+		case ePixelChannelType::INT8_NORM: value = pixel[channel] / 255.0f; break;
+		case ePixelChannelType::INT16_NORM: value = reinterpret_cast<const uint16_t*>(pixel)[channel] / 65535.0f; break;
+		case ePixelChannelType::FLOAT32: value = reinterpret_cast<const float*>(pixel)[channel]; break;
+		default: assert(false);
+	}
+	return format.pixelClass == ePixelClass::SRGB && channel < 3 ? SrgbToLinear(value) : value;
+}
+
+
+static void WriteChannel(uint8_t* pixel, const PixelFormat& format, int channel, float value) {
+	if (format.pixelClass == ePixelClass::SRGB && channel < 3) {
+		value = LinearToSrgb(Clamp01(value));
+	}
+	switch (format.channelType) {
+		case ePixelChannelType::INT8_NORM: pixel[channel] = (uint8_t)std::nearbyint(Clamp01(value) * 255.0f); break;
+		case ePixelChannelType::INT16_NORM: reinterpret_cast<uint16_t*>(pixel)[channel] = (uint16_t)std::nearbyint(Clamp01(value) * 65535.0f); break;
+		case ePixelChannelType::FLOAT32: reinterpret_cast<float*>(pixel)[channel] = value; break;
+		default: assert(false);
+	}
+}
+
+
+//------------------------------------------------------------------------------
+// Lookup tables
+//------------------------------------------------------------------------------
+
+// Linear value of each 8 bit sRGB value.
+struct SrgbDecodeTable {
+	SrgbDecodeTable() {
+		for (int i = 0; i < 256; ++i) {
+			values[i] = SrgbToLinear(i / 255.0f);
+		}
+	}
+	float values[256];
+};
+
+
+// thresholds[k] is the smallest linear value that encodes to at least k. The thresholds are searched using
+// the reference, thus the table gives the same results.
+// To avoid searching all thresholds, values are put into buckets by the exponent and the top 7 bits of the
+// mantissa. A bucket is so narrow that its values encode to its first value or one more, so one comparison
+// with the next threshold finds the result. Values below the first bucket all encode to 0.
+struct SrgbEncodeTable {
+	static constexpr uint32_t FirstBucketBits = 0x39000000; // 2^-13
+	static constexpr uint32_t BucketShift = 16;
+	static constexpr int NumBuckets = (0x3F800000 - FirstBucketBits) >> BucketShift; // up to 1.0f
+
+	SrgbEncodeTable() {
+		auto encode = [](float value) {
+			return (int)std::nearbyint(LinearToSrgb(Clamp01(value)) * 255.0f);
+		};
+
+		thresholds[0] = 0.0f;
+		for (int k = 1; k < 256; ++k) {
+			// Positive floats are ordered as their bits.
+			uint32_t low = 0, high = 0x3F800000; // 0.0f, 1.0f
+			while (low < high) {
+				uint32_t mid = low + (high - low) / 2;
+				if (encode(FromBits(mid)) >= k) {
+					high = mid;
+				}
+				else {
+					low = mid + 1;
+				}
+			}
+			thresholds[k] = FromBits(low);
+		}
+		thresholds[256] = 2.0f; // clamped values never reach it
+
+		for (int bucket = 0; bucket < NumBuckets; ++bucket) {
+			bucketStarts[bucket] = encode(FromBits(FirstBucketBits + (uint32_t(bucket) << BucketShift)));
+		}
+	}
+
+	static float FromBits(uint32_t bits) {
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	float thresholds[257];
+	int32_t bucketStarts[NumBuckets];
+};
+
+
+static const SrgbDecodeTable& GetSrgbDecodeTable() {
+	static const SrgbDecodeTable table;
+	return table;
+}
+
+static const SrgbEncodeTable& GetSrgbEncodeTable() {
+	static const SrgbEncodeTable table;
+	return table;
+}
+
+
+static uint8_t EncodeSrgb(float value, const SrgbEncodeTable& table) {
+	value = Clamp01(value);
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	if (bits < SrgbEncodeTable::FirstBucketBits) {
+		return 0;
+	}
+	int bucket = std::min(int((bits - SrgbEncodeTable::FirstBucketBits) >> SrgbEncodeTable::BucketShift), SrgbEncodeTable::NumBuckets - 1);
+	int k = table.bucketStarts[bucket];
+	return uint8_t(k + (value >= table.thresholds[k + 1]));
+}
+
+
+//------------------------------------------------------------------------------
+// Scalar kernels
+//------------------------------------------------------------------------------
+
+namespace {
+
+template <class T>
+constexpr float NormalizedMax() {
+	return float(T(~T(0)));
+}
+
+
+void GenericKernel(const void* source, void* destination, size_t count, const PixelConverter& converter) {
+	PixelConverter::ConvertReference(source, converter.GetSourceFormat(), destination, converter.GetDestinationFormat(), count);
+}
+
+
+void CopyKernel(const void* source, void* destination, size_t count, const PixelConverter& converter) {
+	std::memcpy(destination, source, count * converter.GetSourceFormat().GetSize());
+}
+
+
+template <class T>
+void ExpandScalar(const void* source, void* destination, size_t count, const PixelConverter&) {
+	const T alpha = std::is_floating_point<T>::value ? T(1) : std::numeric_limits<T>::max();
+	const T* src = static_cast<const T*>(source);
+	T* dst = static_cast<T*>(destination);
+	for (size_t i = 0; i < count; ++i) {
+		dst[4 * i + 0] = src[3 * i + 0];
+		dst[4 * i + 1] = src[3 * i + 1];
+		dst[4 * i + 2] = src[3 * i + 2];
+		dst[4 * i + 3] = alpha;
+	}
+}
+
+
+// Normalized integers to float, same number of channels.
+template <class T>
+void ToFloatScalar(const T* src, float* dst, size_t numValues) {
+	for (size_t i = 0; i < numValues; ++i) {
+		dst[i] = src[i] / NormalizedMax<T>();
+	}
+}
+
+template <class T>
+void ToFloatScalar(const void* source, void* destination, size_t count, const PixelConverter& converter) {
+	ToFloatScalar(static_cast<const T*>(source), static_cast<float*>(destination), count * converter.GetSourceFormat().channelCount);
+}
+
+
+// Float to normalized integers, same number of channels.
+template <class T>
+void FromFloatScalar(const float* src, T* dst, size_t numValues) {
+	for (size_t i = 0; i < numValues; ++i) {
+		dst[i] = (T)std::nearbyint(Clamp01(src[i]) * NormalizedMax<T>());
+	}
+}
+
+template <class T>
+void FromFloatScalar(const void* source, void* destination, size_t count, const PixelConverter& converter) {
+	FromFloatScalar(static_cast<const float*>(source), static_cast<T*>(destination), count * converter.GetSourceFormat().channelCount);
+}
+
+
+// sRGB bytes to linear float, 3 to 4 channels or the same number of channels.
+void SrgbToFloatScalar(const void* source, void* destination, size_t count, const PixelConverter& converter) {
+	const float* table = GetSrgbDecodeTable().values;
+	const uint8_t* src = static_cast<const uint8_t*>(source);
+	float* dst = static_cast<float*>(destination);
+	const int srcChannels = converter.GetSourceFormat().channelCount;
+	const int dstChannels = converter.GetDestinationFormat().channelCount;
+	for (size_t i = 0; i < count; ++i, src += srcChannels, dst += dstChannels) {
+		for (int c = 0; c < srcChannels; ++c) {
+			dst[c] = c < 3 ? table[src[c]] : src[c] / 255.0f;
+		}
+		if (dstChannels > srcChannels) {
+			dst[3] = 1.0f;
+		}
+	}
+}
+
+
+// Linear float to sRGB bytes, same number of channels.
+void FloatToSrgbScalar(const void* source, void* destination, size_t count, const PixelConverter& converter) {
+	const SrgbEncodeTable& table = GetSrgbEncodeTable();
+	const float* src = static_cast<const float*>(source);
+	uint8_t* dst = static_cast<uint8_t*>(destination);
+	const int channels = converter.GetSourceFormat().channelCount;
+	for (size_t i = 0; i < count; ++i, src += channels, dst += channels) {
+		for (int c = 0; c < channels; ++c) {
+			dst[c] = c < 3 ? EncodeSrgb(src[c], table) : (uint8_t)std::nearbyint(Clamp01(src[c]) * 255.0f);
+		}
+	}
+}
+
+
+//------------------------------------------------------------------------------
+// SSE4.1 kernels
+//------------------------------------------------------------------------------
+
+INL_TARGET_SSE41 void ExpandU8Sse41(const void* source, void* destination, size_t count, const PixelConverter& converter) {
+	const uint8_t* src = static_cast<const uint8_t*>(source);
+	uint8_t* dst = static_cast<uint8_t*>(destination);
+	const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+
+	// 4 pixels at a time, reading 16 bytes of which 12 are used.
+	size_t i = 0;
+	for (; i + 6 <= count; i += 4) {
+		__m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i));
+		__m128i rgba = _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * i), rgba);
+	}
+	ExpandScalar<uint8_t>(src + 3 * i, dst + 4 * i, count - i, converter);
+}
+
+
+INL_TARGET_SSE41 void ExpandU16Sse41(const void* source, void* destination, size_t count, const PixelConverter& converter) {
+	const uint16_t* src = static_cast<const uint16_t*>(source);
+	uint16_t* dst = static_cast<uint16_t*>(destination);
+	const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 3, 4, 5, -1, -1, 6, 7, 8, 9, 10, 11, -1, -1);
+	const __m128i alpha = _mm_set1_epi64x((long long)0xFFFF000000000000ull);
+
+	// 2 pixels at a time, reading 16 bytes of which 12 are used.
+	size_t i = 0;
+	for (; i + 3 <= count; i += 2) {
+		__m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i));
+		__m128i rgba = _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * i), rgba);
+	}
+	ExpandScalar<uint16_t>(src + 3 * i, dst + 4 * i, count - i, converter);
+}
+
+
+INL_TARGET_SSE41 void ExpandF32Sse41(const void* source, void* destination, size_t count, const PixelConverter& converter) {
+	const float* src = static_cast<const float*>(source);
+	float* dst = static_cast<float*>(destination);
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	// 4 pixels from 3 registers: [r0 g0 b0 r1] [g1 b1 r2 g2] [b2 r3 g3 b3]
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i a = _mm_castps_si128(_mm_loadu_ps(src + 3 * i + 0));
+		__m128i b = _mm_castps_si128(_mm_loadu_ps(src + 3 * i + 4));
+		__m128i c = _mm_castps_si128(_mm_loadu_ps(src + 3 * i + 8));
+		__m128 p0 = _mm_castsi128_ps(a);
+		__m128 p1 = _mm_castsi128_ps(_mm_alignr_epi8(b, a, 12));
+		__m128 p2 = _mm_castsi128_ps(_mm_alignr_epi8(c, b, 8));
+		__m128 p3 = _mm_castsi128_ps(_mm_srli_si128(c, 4));
+		_mm_storeu_ps(dst + 4 * i + 0, _mm_blend_ps(p0, one, 8));
+		_mm_storeu_ps(dst + 4 * i + 4, _mm_blend_ps(p1, one, 8));
+		_mm_storeu_ps(dst + 4 * i + 8, _mm_blend_ps(p2, one, 8));
+		_mm_storeu_ps(dst + 4 * i + 12, _mm_blend_ps(p3, one, 8));
+	}
+	ExpandScalar<float>(src + 3 * i, dst + 4 * i, count - i, converter);
+}
+
+
+INL_TARGET_SSE41 void StoreU8AsFloatSse41(__m128i bytes, float* dst, __m128 scale) {
+	_mm_storeu_ps(dst + 0, _mm_div_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(bytes)), scale));
+	_mm_storeu_ps(dst + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(bytes, 4))), scale));
+	_mm_storeu_ps(dst + 8, _mm_div_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(bytes, 8))), scale));
+	_mm_storeu_ps(dst + 12, _mm_div_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(bytes, 12))), scale));
+}
+
+
+INL_TARGET_SSE41 void U8ToFloatSse41(const void* source, void* destination, size_t count, const PixelConverter& converter) {
+	const uint8_t* src = static_cast<const uint8_t*>(source);
+	float* dst = static_cast<float*>(destination);
+	const size_t numValues = count * converter.GetSourceFormat().channelCount;
+	const __m128 scale = _mm_set1_ps(255.0f);
+
+	size_t i = 0;
+	for (; i + 16 <= numValues; i += 16) {
+		StoreU8AsFloatSse41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), dst + i, scale);
+	}
+	ToFloatScalar(src + i, dst + i, numValues - i);
+}
+
+
+INL_TARGET_SSE41 void ExpandU8ToFloatSse41(const void* source, void* destination, size_t count, const PixelConverter& converter) {
+	const uint8_t* src = static_cast<const uint8_t*>(source);
+	float* dst = static_cast<float*>(destination);
+	const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+	const __m128 scale = _mm_set1_ps(255.0f);
+
+	size_t i = 0;
+	for (; i + 6 <= count; i += 4) {
+		__m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i));
+		__m128i rgba = _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha);
+		StoreU8AsFloatSse41(rgba, dst + 4 * i, scale);
+	}
+	PixelConverter::ConvertReference(src + 3 * i, converter.GetSourceFormat(), dst + 4 * i, converter.GetDestinationFormat(), count - i);
+}
+
+
+INL_TARGET_SSE41 void U16ToFloatSse41(const void* source, void* destination, size_t count, const PixelConverter& converter) {
+	const uint16_t* src = static_cast<const uint16_t*>(source);
+	float* dst = static_cast<float*>(destination);
+	const size_t numValues = count * converter.GetSourceFormat().channelCount;
+	const __m128 scale = _mm_set1_ps(65535.0f);
+
+	size_t i = 0;
+	for (; i + 8 <= numValues; i += 8) {
+		__m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		_mm_storeu_ps(dst + i + 0, _mm_div_ps(_mm_cvtepi32_ps(_mm_cvtepu16_epi32(values)), scale));
+		_mm_storeu_ps(dst + i + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_cvtepu16_epi32(_mm_srli_si128(values, 8))), scale));
+	}
+	ToFloatScalar(src + i, dst + i, numValues - i);
+}
+
+
+INL_TARGET_SSE41 __m128i FloatToNormalizedSse41(const float* src, __m128 scale) {
+	__m128 value = _mm_loadu_ps(src);
+	value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+	return _mm_cvtps_epi32(_mm_mul_ps(value, scale)); // rounds to nearest even, like nearbyint
+}
+
+
+INL_TARGET_SSE41 void FloatToU8Sse41(const void* source, void* destination, size_t count, const PixelConverter& converter) {
+	const float* src = static_cast<const float*>(source);
+	uint8_t* dst = static_cast<uint8_t*>(destination);
+	const size_t numValues = count * converter.GetSourceFormat().channelCount;
+	const __m128 scale = _mm_set1_ps(255.0f);
+
+	size_t i = 0;
+	for (; i + 16 <= numValues; i += 16) {
+		__m128i v0 = FloatToNormalizedSse41(src + i + 0, scale);
+		__m128i v1 = FloatToNormalizedSse41(src + i + 4, scale);
+		__m128i v2 = FloatToNormalizedSse41(src + i + 8, scale);
+		__m128i v3 = FloatToNormalizedSse41(src + i + 12, scale);
+		__m128i packed = _mm_packus_epi16(_mm_packus_epi32(v0, v1), _mm_packus_epi32(v2, v3));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+	}
+	FromFloatScalar(src + i, dst + i, numValues - i);
+}
+
+
+INL_TARGET_SSE41 void FloatToU16Sse41(const void* source, void* destination, size_t count, const PixelConverter& converter) {
+	const float* src = static_cast<const float*>(source);
+	uint16_t* dst = static_cast<uint16_t*>(destination);
+	const size_t numValues = count * converter.GetSourceFormat().channelCount;
+	const __m128 scale = _mm_set1_ps(65535.0f);
+
+	size_t i = 0;
+	for (; i + 8 <= numValues; i += 8) {
+		__m128i v0 = FloatToNormalizedSse41(src + i + 0, scale);
+		__m128i v1 = FloatToNormalizedSse41(src + i + 4, scale);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi32(v0, v1));
+	}
+	FromFloatScalar(src + i, dst + i, numValues - i);
+}
+
+
+//------------------------------------------------------------------------------
+// AVX2 kernels
+//------------------------------------------------------------------------------
+
+INL_TARGET_AVX2 void ExpandU8Avx2(const void* source, void* destination, size_t count, const PixelConverter& converter) {
+	const uint8_t* src = static_cast<const uint8_t*>(source);
+	uint8_t* dst = static_cast<uint8_t*>(destination);
+	const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+											 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+
+	// 8 pixels at a time, each lane gets 4 of them.
+	size_t i = 0;
+	for (; i + 10 <= count; i += 8) {
+		__m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i));
+		__m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i + 12));
+		__m256i rgb = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+		__m256i rgba = _mm256_or_si256(_mm256_shuffle_epi8(rgb, shuffle), alpha);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 4 * i), rgba);
+	}
+	ExpandScalar<uint8_t>(src + 3 * i, dst + 4 * i, count - i, converter);
+}
+
+
+INL_TARGET_AVX2 void U8ToFloatAvx2(const void* source, void* destination, size_t count, const PixelConverter& converter) {
+	const uint8_t* src = static_cast<const uint8_t*>(source);
+	float* dst = static_cast<float*>(destination);
+	const size_t numValues = count * converter.GetSourceFormat().channelCount;
+	const __m256 scale = _mm256_set1_ps(255.0f);
+
+	size_t i = 0;
+	for (; i + 16 <= numValues; i += 16) {
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		_mm256_storeu_ps(dst + i + 0, _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes)), scale));
+		_mm256_storeu_ps(dst + i + 8, _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8))), scale));
+	}
+	ToFloatScalar(src + i, dst + i, numValues - i);
+}
+
+
+// Encodes 8 values at once, the same way as EncodeSrgb.
+INL_TARGET_AVX2 __m256i EncodeSrgbAvx2(__m256 clamped, const SrgbEncodeTable& table) {
+	const __m256i firstBucket = _mm256_set1_epi32((int)SrgbEncodeTable::FirstBucketBits);
+	__m256i bits = _mm256_castps_si256(clamped);
+	__m256i bucket = _mm256_srli_epi32(_mm256_sub_epi32(bits, firstBucket), SrgbEncodeTable::BucketShift);
+	bucket = _mm256_min_epi32(bucket, _mm256_set1_epi32(SrgbEncodeTable::NumBuckets - 1));
+	__m256i belowBuckets = _mm256_cmpgt_epi32(firstBucket, bits);
+	bucket = _mm256_andnot_si256(belowBuckets, bucket);
+
+	__m256i k = _mm256_i32gather_epi32(table.bucketStarts, bucket, 4);
+	__m256 threshold = _mm256_i32gather_ps(table.thresholds, _mm256_add_epi32(k, _mm256_set1_epi32(1)), 4);
+	__m256i greaterEqual = _mm256_castps_si256(_mm256_cmp_ps(clamped, threshold, _CMP_GE_OQ));
+	k = _mm256_sub_epi32(k, greaterEqual); // true is -1
+	return _mm256_andnot_si256(belowBuckets, k);
+}
+
+
+INL_TARGET_AVX2 void FloatToSrgbAvx2(const void* source, void* destination, size_t count, const PixelConverter& converter) {
+	const SrgbEncodeTable& table = GetSrgbEncodeTable();
+	const float* src = static_cast<const float*>(source);
+	uint8_t* dst = static_cast<uint8_t*>(destination);
+	const int channels = converter.GetSourceFormat().channelCount;
+	const size_t numValues = count * channels;
+	const size_t numSimdValues = numValues - numValues % (8 * channels); // the remaining pixels are whole
+
+	// With 4 channels, every 4th value is alpha and is not encoded. Others have color channels only.
+	const __m256i alphaMask = channels == 4 ? _mm256_setr_epi32(0, 0, 0, -1, 0, 0, 0, -1) : _mm256_setzero_si256();
+	const __m256 scale = _mm256_set1_ps(255.0f);
+
+	size_t i = 0;
+	for (; i < numSimdValues; i += 8) {
+		__m256 value = _mm256_loadu_ps(src + i);
+		__m256 clamped = _mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+		__m256i encoded = EncodeSrgbAvx2(clamped, table);
+		__m256i linear = _mm256_cvtps_epi32(_mm256_mul_ps(clamped, scale));
+		__m256i result = _mm256_blendv_epi8(encoded, linear, alphaMask);
+
+		__m128i words = _mm_packus_epi32(_mm256_castsi256_si128(result), _mm256_extracti128_si256(result, 1));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(words, words));
+	}
+	FloatToSrgbScalar(src + i, dst + i, (numValues - i) / channels, converter);
+}
+
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+// PixelFormat
+//------------------------------------------------------------------------------
+
+size_t PixelFormat::GetSize() const {
+	switch (channelType) {
+		case ePixelChannelType::INT8_NORM: return channelCount * 1;
+		case ePixelChannelType::INT16_NORM: return channelCount * 2;
+		case ePixelChannelType::INT32: return channelCount * 4;
+		case ePixelChannelType::FLOAT32: return channelCount * 4;
+		case ePixelChannelType::BC1: return 8;
+		case ePixelChannelType::BC3: return 16;
+		case ePixelChannelType::BC4: return 8;
+		case ePixelChannelType::BC5: return 16;
+		case ePixelChannelType::BC7: return 16;
+	}
+	throw InvalidArgumentException("Unknown pixel channel type.");
+}
+
+
+bool PixelFormat::operator==(const PixelFormat& rhs) const {
+	return channelType == rhs.channelType && channelCount == rhs.channelCount && pixelClass == rhs.pixelClass;
+}
+
+
+//------------------------------------------------------------------------------
+// PixelConverter
+//------------------------------------------------------------------------------
+
+PixelConverter::PixelConverter(PixelFormat source, PixelFormat destination, eSimdLevel simdLevel)
+	: m_source(source), m_destination(destination)
+{
+	if (!IsSupported(source, destination)) {
+		throw InvalidArgumentException("Pixel conversion between these formats is not supported.");
+	}
+	SelectKernel(std::min(simdLevel, CpuFeatures::GetSimdLevel()));
+}
+
+
+bool PixelConverter::IsSupported(PixelFormat source, PixelFormat destination) {
+	auto isConvertible = [](const PixelFormat& format) {
+		bool isNormalizedOrFloat = format.channelType == ePixelChannelType::INT8_NORM
+			|| format.channelType == ePixelChannelType::INT16_NORM
+			|| format.channelType == ePixelChannelType::FLOAT32;
+		return (format.pixelClass == ePixelClass::LINEAR && isNormalizedOrFloat)
+			|| (format.pixelClass == ePixelClass::SRGB && format.channelType == ePixelChannelType::INT8_NORM);
+	};
+
+	if (source.channelCount < 1 || source.channelCount > 4) {
+		return false;
+	}
+	if (IsBlockCompressed(source.channelType) || IsBlockCompressed(destination.channelType)) {
+		return false; // blocks are uploaded as they are
+	}
+	if (source == destination) {
+		return true;
+	}
+	bool channelsMatch = source.channelCount == destination.channelCount
+		|| (source.channelCount == 3 && destination.channelCount == 4);
+	return channelsMatch && isConvertible(source) && isConvertible(destination);
+}
+
+
+void PixelConverter::Convert(const void* source, void* destination, size_t count) const {
+	m_kernel(source, destination, count, *this);
+}
+
+
+void PixelConverter::Convert(const void* source, size_t sourcePitch, void* destination, size_t destinationPitch, size_t width, size_t height) const {
+	for (size_t y = 0; y < height; ++y) {
+		m_kernel(static_cast<const uint8_t*>(source) + y * sourcePitch,
+				 static_cast<uint8_t*>(destination) + y * destinationPitch,
+				 width,
+				 *this);
+	}
+}
+
+
+void PixelConverter::ConvertReference(const void* source, PixelFormat sourceFormat, void* destination, PixelFormat destinationFormat, size_t count) {
+	const uint8_t* src = static_cast<const uint8_t*>(source);
+	uint8_t* dst = static_cast<uint8_t*>(destination);
+	const size_t srcSize = sourceFormat.GetSize();
+	const size_t dstSize = destinationFormat.GetSize();
+
+	if (sourceFormat == destinationFormat) {
+		std::memcpy(dst, src, count * srcSize);
+		return;
+	}
+
+	for (size_t i = 0; i < count; ++i, src += srcSize, dst += dstSize) {
+		for (int c = 0; c < destinationFormat.channelCount; ++c) {
+			float value = c < sourceFormat.channelCount ? ReadChannel(src, sourceFormat, c) : 1.0f;
+			WriteChannel(dst, destinationFormat, c, value);
+		}
+	}
+}
+
+
+void PixelConverter::SetKernel(Kernel kernel, eSimdLevel simdLevel) {
+	m_kernel = kernel;
+	m_simdLevel = simdLevel;
+}
+
+
+void PixelConverter::SelectKernel(eSimdLevel simdLevel) {
+	using T = ePixelChannelType;
+	using C = ePixelClass;
+
+	const bool sse41 = simdLevel >= eSimdLevel::SSE4_1;
+	const bool avx2 = simdLevel >= eSimdLevel::AVX2;
+	const T srcType = m_source.channelType;
+	const T dstType = m_destination.channelType;
+	const bool sameChannels = m_source.channelCount == m_destination.channelCount;
+	const bool expand = m_source.channelCount == 3 && m_destination.channelCount == 4;
+	const bool srcLinear = m_source.pixelClass == C::LINEAR;
+	const bool dstLinear = m_destination.pixelClass == C::LINEAR;
+
+	SetKernel(&GenericKernel, eSimdLevel::SCALAR);
+
+	if (m_source == m_destination) {
+		SetKernel(&CopyKernel, eSimdLevel::SCALAR);
+	}
+	// Add alpha.
+	else if (expand && srcType == dstType && m_source.pixelClass == m_destination.pixelClass) {
+		switch (srcType) {
+			case T::INT8_NORM:
+				avx2 ? SetKernel(&ExpandU8Avx2, eSimdLevel::AVX2)
+					: sse41 ? SetKernel(&ExpandU8Sse41, eSimdLevel::SSE4_1)
+					: SetKernel(&ExpandScalar<uint8_t>, eSimdLevel::SCALAR);
+				break;
+			case T::INT16_NORM:
+				sse41 ? SetKernel(&ExpandU16Sse41, eSimdLevel::SSE4_1) : SetKernel(&ExpandScalar<uint16_t>, eSimdLevel::SCALAR);
+				break;
+			case T::FLOAT32:
+				sse41 ? SetKernel(&ExpandF32Sse41, eSimdLevel::SSE4_1) : SetKernel(&ExpandScalar<float>, eSimdLevel::SCALAR);
+				break;
+			default:
+				break;
+		}
+	}
+	// Normalized to float.
+	else if (dstType == T::FLOAT32 && srcLinear && dstLinear) {
+		if (srcType == T::INT8_NORM && sameChannels) {
+			avx2 ? SetKernel(&U8ToFloatAvx2, eSimdLevel::AVX2)
+				: sse41 ? SetKernel(&U8ToFloatSse41, eSimdLevel::SSE4_1)
+				: SetKernel(&ToFloatScalar<uint8_t>, eSimdLevel::SCALAR);
+		}
+		else if (srcType == T::INT8_NORM && expand && sse41) {
+			SetKernel(&ExpandU8ToFloatSse41, eSimdLevel::SSE4_1);
+		}
+		else if (srcType == T::INT16_NORM && sameChannels) {
+			sse41 ? SetKernel(&U16ToFloatSse41, eSimdLevel::SSE4_1) : SetKernel(&ToFloatScalar<uint16_t>, eSimdLevel::SCALAR);
+		}
+	}
+	// Float to normalized.
+	else if (srcType == T::FLOAT32 && sameChannels && srcLinear && dstLinear) {
+		if (dstType == T::INT8_NORM) {
+			sse41 ? SetKernel(&FloatToU8Sse41, eSimdLevel::SSE4_1) : SetKernel(&FromFloatScalar<uint8_t>, eSimdLevel::SCALAR);
+		}
+		else if (dstType == T::INT16_NORM) {
+			sse41 ? SetKernel(&FloatToU16Sse41, eSimdLevel::SSE4_1) : SetKernel(&FromFloatScalar<uint16_t>, eSimdLevel::SCALAR);
+		}
+	}
+	// sRGB to linear float, table lookup.
+	else if (m_source.pixelClass == C::SRGB && dstType == T::FLOAT32 && dstLinear && (sameChannels || expand)) {
+		SetKernel(&SrgbToFloatScalar, eSimdLevel::SCALAR);
+	}
+	// Linear float to sRGB.
+	else if (srcType == T::FLOAT32 && srcLinear && m_destination.pixelClass == C::SRGB && sameChannels) {
+		avx2 ? SetKernel(&FloatToSrgbAvx2, eSimdLevel::AVX2) : SetKernel(&FloatToSrgbScalar, eSimdLevel::SCALAR);
+	}
+}
+
+
+} // namespace inl::gxeng
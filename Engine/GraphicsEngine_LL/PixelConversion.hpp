@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Pixel.hpp"
+
+#include <BaseLibrary/CpuFeatures.hpp>
+#include <cstddef>
+
+
+namespace inl::gxeng {
+
+
+/// <summary> Describes how a pixel is laid out in memory. </summary>
+struct PixelFormat {
+	ePixelChannelType channelType;
+	int channelCount;
+	ePixelClass pixelClass;
+
+	/// <summary> Size of a pixel in bytes, or of a 4x4 block for block compressed channel types. </summary>
+	size_t GetSize() const;
+
+	bool operator==(const PixelFormat& rhs) const;
+	bool operator!=(const PixelFormat& rhs) const { return !(*this == rhs); }
+};
+
+
+/// <summary>
+/// Converts pixels between formats, e.g. RGB to RGBA, 8 or 16 bit normalized to float, or sRGB to linear.
+/// <para />
+/// The fastest kernel for the pair of formats is picked on construction, according to the instruction sets
+/// the CPU supports. Format pairs without a dedicated kernel go through <see cref="ConvertReference"/>.
+/// </summary>
+/// <remarks>
+/// When expanding 3 channels to 4, alpha is set to 1.
+/// Normalized integers are rounded to nearest when converted from float, and out of range values are clamped.
+/// Only the first 3 channels of sRGB pixels are sRGB encoded, alpha is linear.
+/// INT32 and VALUE_EXPONENT pixels can only be copied.
+/// </remarks>
+class PixelConverter {
+public:
+	/// <summary> Picks the kernel for the formats. </summary>
+	/// <param name="simdLevel"> The widest instruction set to use, the CPU's by default. </param>
+	/// <exception cref="InvalidArgumentException"> If the conversion is not supported. </exception>
+	PixelConverter(PixelFormat source, PixelFormat destination, eSimdLevel simdLevel = CpuFeatures::GetSimdLevel());
+
+	/// <summary> Whether pixels of format source can be converted to pixels of format destination. </summary>
+	static bool IsSupported(PixelFormat source, PixelFormat destination);
+
+	/// <summary> Converts a row of pixels. </summary>
+	void Convert(const void* source, void* destination, size_t count) const;
+
+	/// <summary> Converts a rectangle of pixels. </summary>
+	/// <param name="sourcePitch"> Bytes between the rows of the source. </param>
+	/// <param name="destinationPitch"> Bytes between the rows of the destination. </param>
+	void Convert(const void* source, size_t sourcePitch, void* destination, size_t destinationPitch, size_t width, size_t height) const;
+
+	PixelFormat GetSourceFormat() const { return m_source; }
+	PixelFormat GetDestinationFormat() const { return m_destination; }
+
+	/// <summary> The instruction set of the picked kernel. It is lower than requested if there's no such kernel for the formats. </summary>
+	eSimdLevel GetSimdLevel() const { return m_simdLevel; }
+
+	/// <summary> Converts one channel at a time through floats. Slow, but it defines what the kernels must produce. </summary>
+	static void ConvertReference(const void* source, PixelFormat sourceFormat, void* destination, PixelFormat destinationFormat, size_t count);
+private:
+	using Kernel = void (*)(const void* source, void* destination, size_t count, const PixelConverter& converter);
+
+	void SelectKernel(eSimdLevel simdLevel);
+	void SetKernel(Kernel kernel, eSimdLevel simdLevel);
+private:
+	PixelFormat m_source;
+	PixelFormat m_destination;
+	Kernel m_kernel = nullptr;
+	eSimdLevel m_simdLevel = eSimdLevel::SCALAR;
+};
+
+
+} // namespace inl::gxeng
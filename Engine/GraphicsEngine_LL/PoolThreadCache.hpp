@@ -0,0 +1,152 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <cstdint>
+
+
+namespace inl {
+namespace gxeng {
+
+
+/// <summary> How well the thread local caches of a pool served a thread. </summary>
+struct PoolThreadStatistics {
+	std::thread::id threadId;
+	size_t hits = 0; /// <summary> Requests served by the thread's own cache. </summary>
+	size_t misses = 0; /// <summary> Requests that had to go to the shared pool. </summary>
+};
+
+
+namespace impl {
+
+/// <summary>
+/// Thread local frontend for object pools.
+/// <para />
+/// Each thread that requests objects gets a small private cache, so that
+/// requests don't contend on the pool's lock. Objects are returned to the cache
+/// of the thread that requested them, no matter which thread recycles them.
+/// When a cache is full, the object goes back to the shared pool instead.
+/// </summary>
+/// <remarks>
+/// The owner thread pops its cache without locking. Returned objects go through
+/// a small inbox, which is only shared between the owner and the recycling thread.
+/// Meant for long lived threads: objects cached by a thread that exits are not reused.
+/// </remarks>
+template <class T>
+class PoolThreadCache {
+public:
+	struct Cache {
+		std::thread::id threadId;
+		std::vector<T*> objects; // only touched by owner thread
+		std::vector<T*> inbox; // objects returned from any thread
+		std::mutex inboxMutex;
+		std::atomic_size_t hits{ 0 };
+		std::atomic_size_t misses{ 0 };
+	};
+public:
+	explicit PoolThreadCache(size_t maxCachedObjects = 32) : m_id(NextId()), m_maxCachedObjects(maxCachedObjects) {}
+	PoolThreadCache(const PoolThreadCache&) = delete;
+	PoolThreadCache& operator=(const PoolThreadCache&) = delete;
+
+	/// <summary> Returns the calling thread's cache. Creates it on first use. </summary>
+	Cache& Get() {
+		// Keyed by a unique id instead of the address, so that a new pool
+		// at the address of a destroyed one does not pick up stale entries.
+		thread_local std::vector<std::pair<uint64_t, Cache*>> lookup;
+		for (auto& entry : lookup) {
+			if (entry.first == m_id) {
+				return *entry.second;
+			}
+		}
+
+		std::lock_guard<std::mutex> lkg(m_cachesMutex);
+		m_caches.push_back(std::make_unique<Cache>());
+		m_caches.back()->threadId = std::this_thread::get_id();
+		lookup.push_back({ m_id, m_caches.back().get() });
+		return *m_caches.back();
+	}
+
+	/// <summary> Takes an object from the cache, null if it's empty. Must be called by the owner thread. </summary>
+	T* Pop(Cache& cache) {
+		if (cache.objects.empty()) {
+			std::lock_guard<std::mutex> lkg(cache.inboxMutex);
+			std::swap(cache.objects, cache.inbox);
+		}
+		if (cache.objects.empty()) {
+			++cache.misses;
+			return nullptr;
+		}
+		++cache.hits;
+		T* object = cache.objects.back();
+		cache.objects.pop_back();
+		return object;
+	}
+
+	/// <summary> Returns an object to the cache. Can be called from any thread. </summary>
+	/// <returns> False if the cache is full, and the object should go to the shared pool. </returns>
+	bool Push(Cache& cache, T* object) {
+		std::lock_guard<std::mutex> lkg(cache.inboxMutex);
+		if (cache.inbox.size() >= m_maxCachedObjects) {
+			return false;
+		}
+		cache.inbox.push_back(object);
+		return true;
+	}
+
+	/// <summary> Drops all cached objects. Only call when no other thread uses the pool. </summary>
+	void Clear() {
+		std::lock_guard<std::mutex> lkg(m_cachesMutex);
+		for (auto& cache : m_caches) {
+			cache->objects.clear();
+			cache->inbox.clear();
+		}
+	}
+
+	std::vector<PoolThreadStatistics> GetStatistics() const {
+		std::lock_guard<std::mutex> lkg(m_cachesMutex);
+		std::vector<PoolThreadStatistics> statistics;
+		for (auto& cache : m_caches) {
+			PoolThreadStatistics stats;
+			stats.threadId = cache->threadId;
+			stats.hits = cache->hits;
+			stats.misses = cache->misses;
+			statistics.push_back(stats);
+		}
+		return statistics;
+	}
+private:
+	static uint64_t NextId() {
+		static std::atomic<uint64_t> nextId{ 0 };
+		return ++nextId;
+	}
+private:
+	const uint64_t m_id;
+	const size_t m_maxCachedObjects;
+	std::vector<std::unique_ptr<Cache>> m_caches;
+	mutable std::mutex m_cachesMutex;
+};
+
+
+/// <summary> Sums statistics of the same thread. </summary>
+inline void MergePoolThreadStatistics(std::vector<PoolThreadStatistics>& target, const std::vector<PoolThreadStatistics>& source) {
+	for (auto& stats : source) {
+		auto it = std::find_if(target.begin(), target.end(), [&](const PoolThreadStatistics& s) { return s.threadId == stats.threadId; });
+		if (it == target.end()) {
+			target.push_back(stats);
+		}
+		else {
+			it->hits += stats.hits;
+			it->misses += stats.misses;
+		}
+	}
+}
+
+} // namespace impl
+
+
+} // namespace gxeng
+} // namespace inl
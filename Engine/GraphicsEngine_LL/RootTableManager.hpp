@@ -59,6 +59,9 @@ private:
 	/// <summary> Copies ALL scratch space tables to a fresh range. Used after a new scratch space is bound. </summary>
 	void RenewRootTables();
 
+	/// <summary> Points bindless tables to the bindless texture table mirrored in the current scratch space. </summary>
+	void SetBindlessTables();
+
 	void SetRootDescriptorTable(gxapi::IGraphicsCommandList* list, unsigned parameterIndex, gxapi::DescriptorHandle baseHandle);
 	void SetRootDescriptorTable(gxapi::IComputeCommandList* list, unsigned parameterIndex, gxapi::DescriptorHandle baseHandle);
 	void SetRootSignature(gxapi::IGraphicsCommandList* list, gxapi::IRootSignature* sig);
@@ -68,8 +71,10 @@ protected:
 	CommandListT* m_commandList;
 	Binder* m_binder;
 	StackDescHeap* m_heap;
+	gxapi::IRootSignature* m_rootSignature = nullptr; // last one set on the command list
 private:
 	std::vector<DescriptorTableState> m_rootTableStates;
+	std::vector<int> m_bindlessSlots; // root signature slots of bindless tables, these don't need scratch space
 };
 
 
@@ -91,7 +96,11 @@ RootTableManager<Type>::RootTableManager(gxapi::IGraphicsApi* graphicsApi, Comma
 template <gxapi::eCommandListType Type>
 void RootTableManager<Type>::SetBinder(Binder* binder) {
 	m_binder = binder;
-	SetRootSignature(m_commandList, m_binder->GetRootSignature());
+	// Binders with identical layouts share root signatures, no need to switch then.
+	if (m_rootSignature != m_binder->GetRootSignature()) {
+		m_rootSignature = m_binder->GetRootSignature();
+		SetRootSignature(m_commandList, m_rootSignature);
+	}
 	InitRootTables();
 }
 
@@ -101,6 +110,7 @@ void RootTableManager<Type>::SetDescriptorHeap(StackDescHeap* heap) {
 	assert(heap != nullptr);
 	m_heap = heap;
 	RenewRootTables();
+	SetBindlessTables();
 }
 
 
@@ -201,11 +211,15 @@ auto RootTableManager<Type>::FindRootTable(int rootSignatureSlot) -> DescriptorT
 template <gxapi::eCommandListType Type>
 void RootTableManager<Type>::InitRootTables() {
 	m_rootTableStates.clear();
+	m_bindlessSlots.clear();
 	const gxapi::RootSignatureDesc& desc = m_binder->GetRootSignatureDesc();
 
 	for (size_t slot = 0; slot < desc.rootParameters.size(); slot++) {
 		auto& param = desc.rootParameters[slot];
-		if (param.type == gxapi::RootParameterDesc::DESCRIPTOR_TABLE) {
+		if (param.type == gxapi::RootParameterDesc::DESCRIPTOR_TABLE && m_binder->IsBindlessTable((int)slot)) {
+			m_bindlessSlots.push_back((int)slot);
+		}
+		else if (param.type == gxapi::RootParameterDesc::DESCRIPTOR_TABLE) {
 			auto& ranges = param.As<gxapi::RootParameterDesc::DESCRIPTOR_TABLE>().ranges;
 
 			if (ranges.size() <= 0) {
@@ -242,6 +256,8 @@ void RootTableManager<Type>::InitRootTables() {
 			m_rootTableStates.back().bindings.resize(descriptorCountTotal);
 		}
 	}
+
+	SetBindlessTables();
 }
 
 template <gxapi::eCommandListType Type>
@@ -255,6 +271,20 @@ template <gxapi::eCommandListType Type>
 void RootTableManager<Type>::RenewRootTables() {
 	for (auto& table : m_rootTableStates) {
 		DuplicateRootTable(table);
+		SetRootDescriptorTable(m_commandList, table.slot, table.reference.Get(0));
+	}
+}
+
+template <gxapi::eCommandListType Type>
+void RootTableManager<Type>::SetBindlessTables() {
+	if (m_bindlessSlots.empty()) {
+		return;
+	}
+	if (m_heap->GetReservedSize() == 0) {
+		throw InvalidStateException("Binder has bindless tables, but the scratch space has no bindless textures.");
+	}
+	for (int slot : m_bindlessSlots) {
+		SetRootDescriptorTable(m_commandList, slot, m_heap->GetReservedBase());
 	}
 }
 
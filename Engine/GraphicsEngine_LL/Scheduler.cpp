@@ -4,8 +4,15 @@
 
 #include "GraphicsCommandList.hpp"
 
+#include <BaseLibrary/Exception/Exception.hpp>
+
 #include <cassert>
 #include <iostream> // only for debugging
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
 
 namespace inl {
 namespace gxeng {
@@ -16,6 +23,72 @@ Scheduler::Scheduler()
 
 void Scheduler::SetPipeline(Pipeline&& pipeline) {
 	m_pipeline = std::move(pipeline);
+	m_warmUpPending = true;
+
+	// Name tasks after their nodes for profiling.
+	m_taskNames.clear();
+	const auto& taskGraph = m_pipeline.GetTaskGraph();
+	const auto& taskFunctionMap = m_pipeline.GetTaskFunctionMap();
+	const auto& taskParentMap = m_pipeline.GetTaskParentMap();
+	const auto& nodeMap = m_pipeline.GetNodeMap();
+	for (lemon::ListDigraph::NodeIt taskNode(taskGraph); taskNode != lemon::INVALID; ++taskNode) {
+		const GraphicsTask* task = taskFunctionMap[taskNode];
+		lemon::ListDigraph::Node parent = taskParentMap[taskNode];
+		if (task == nullptr || parent == lemon::INVALID) {
+			continue;
+		}
+		const NodeBase* node = nodeMap[parent].get();
+		m_taskNames[task] = !node->GetDisplayName().empty() ? node->GetDisplayName() : node->GetClassName(true, { "inl::gxeng::nodes::", "inl::gxeng::", "inl::" });
+	}
+
+	// Collect the tasks of nodes whose Setup is safe to run concurrently.
+	m_parallelSetupTasks.clear();
+	for (lemon::ListDigraph::NodeIt taskNode(taskGraph); taskNode != lemon::INVALID; ++taskNode) {
+		const GraphicsTask* task = taskFunctionMap[taskNode];
+		lemon::ListDigraph::Node parent = taskParentMap[taskNode];
+		if (task == nullptr || parent == lemon::INVALID) {
+			continue;
+		}
+		const GraphicsNode* node = dynamic_cast<const GraphicsNode*>(nodeMap[parent].get());
+		if (node && node->IsParallelSetupAllowed()) {
+			m_parallelSetupTasks.insert(task);
+		}
+	}
+
+	// Collect constant tasks, they are set up once and skipped until invalidated.
+	m_constantTasks.clear();
+	m_constantsValid = false;
+	const auto& constantNodeMap = m_pipeline.GetConstantNodeMap();
+	for (lemon::ListDigraph::NodeIt taskNode(taskGraph); taskNode != lemon::INVALID; ++taskNode) {
+		lemon::ListDigraph::Node parent = taskParentMap[taskNode];
+		if (taskFunctionMap[taskNode] != nullptr && parent != lemon::INVALID && constantNodeMap[parent]) {
+			m_constantTasks.insert(taskFunctionMap[taskNode]);
+		}
+	}
+
+	// Collect the tasks that directly depend on each task for pass merging, looking through the helper nodes.
+	m_taskDependents.clear();
+	for (lemon::ListDigraph::NodeIt taskNode(taskGraph); taskNode != lemon::INVALID; ++taskNode) {
+		const GraphicsTask* task = taskFunctionMap[taskNode];
+		if (task == nullptr) {
+			continue;
+		}
+		auto& dependents = m_taskDependents[task];
+		std::vector<lemon::ListDigraph::Node> stack = { taskNode };
+		while (!stack.empty()) {
+			lemon::ListDigraph::Node current = stack.back();
+			stack.pop_back();
+			for (lemon::ListDigraph::OutArcIt arc(taskGraph, current); arc != lemon::INVALID; ++arc) {
+				lemon::ListDigraph::Node target = taskGraph.target(arc);
+				if (taskFunctionMap[target] == nullptr) {
+					stack.push_back(target);
+				}
+				else if (std::find(dependents.begin(), dependents.end(), taskFunctionMap[target]) == dependents.end()) {
+					dependents.push_back(taskFunctionMap[target]);
+				}
+			}
+		}
+	}
 }
 
 const Pipeline& Scheduler::GetPipeline() const {
@@ -32,100 +105,100 @@ void Scheduler::Execute(FrameContext context) {
 
 	auto tasks = MakeSchedule(taskGraph, taskFunctionMap);
 
+	// Constant tasks have already set their outputs, which are still in their consumers' inputs.
+	if (m_constantsValid) {
+		tasks.erase(std::remove_if(tasks.begin(), tasks.end(), [this](GraphicsTask* task) {
+			return task == nullptr || m_constantTasks.count(task) > 0;
+		}), tasks.end());
+	}
+
 	// Inject copy task to the start.
 	UploadTask uploadTask(context.uploadRequests);
 	tasks.insert(tasks.begin(), &uploadTask);
 
+	if (m_profiler) {
+		try {
+			BeginProfiledFrame(context);
+		}
+		catch (std::exception& ex) {
+			context.log->Event(std::string("Profiler could not begin frame: ") + ex.what());
+		}
+	}
+
 	// Setup and execute the tasks.
 	try {
 		// PHASE I.: Setup() tasks in correct order
-		for (auto& task : tasks) {
-			if (task != nullptr) {
-				SetupContext setupContext(context.memoryManager, context.textureSpace, context.rtvHeap, context.dsvHeap, context.shaderManager, context.gxApi);
-				task->Setup(setupContext);
+		if (m_warmUpPending) {
+			// First frame of the pipeline: shaders, binders and PSOs are created now, worth the threads.
+			m_warmUpPending = false;
+			unsigned numThreads = m_warmUpThreadCount > 0 ? m_warmUpThreadCount : std::max(1u, std::thread::hardware_concurrency());
+			SetupTask(&uploadTask, context);
+			SetupParallel(taskGraph, taskFunctionMap, context, numThreads);
+		}
+		else {
+			for (auto& task : tasks) {
+				if (task != nullptr) {
+					SetupTask(task, context);
+				}
 			}
 		}
+		m_constantsValid = true;
 
 
 		// PHASE II.: Execute() tasks in correct
+		std::unique_ptr<VolatileViewHeap> volatileHeap;
+		std::unique_ptr<RenderContext> renderContext;
+		const GraphicsTask* previousTask = nullptr;
+		unsigned numMergedTasks = 0;
 		for (auto& task : tasks) {
-			VolatileViewHeap volatileHeap(context.gxApi);
-			RenderContext renderContext(context.memoryManager,
-										context.textureSpace,
-										&volatileHeap,
-										context.shaderManager,
-										context.gxApi,
-										context.commandListPool,
-										context.commandAllocatorPool,
-										context.scratchSpacePool);
-
-			// Execute the task on the CPU.
-			if (task != nullptr) {
-				task->Execute(renderContext);
-
-				// Enqueue all command lists on the GPU.
-				if (renderContext.IsListInitialized()) {
-					BasicCommandList* commandList = nullptr;
-					switch (renderContext.GetType()) {
-						case gxapi::eCommandListType::GRAPHICS: commandList = &renderContext.AsGraphics(); break;
-						case gxapi::eCommandListType::COMPUTE: commandList = &renderContext.AsCompute(); break;
-						case gxapi::eCommandListType::COPY: commandList = &renderContext.AsCopy(); break;
-						default: assert(false);
-					}
-					BasicCommandList::Decomposition decomposition = commandList->Decompose();
-
-					std::sort(decomposition.usedResources.begin(), decomposition.usedResources.end(), [](const ResourceUsage& lhs, const ResourceUsage& rhs) {
-						auto lhsPtr = lhs.resource._GetResourcePtr();
-						auto rhsPtr = rhs.resource._GetResourcePtr();
-						return lhsPtr < rhsPtr || (lhs.resource._GetResourcePtr() == rhs.resource._GetResourcePtr() && lhs.subresource < rhs.subresource);
-					});
-
-					// Inject a transition barrier command list.
-					auto barriers = InjectBarriers(decomposition.usedResources.begin(), decomposition.usedResources.end());
-					if (barriers.size() > 0) {
-						CmdAllocPtr injectAlloc = context.commandAllocatorPool->RequestAllocator(gxapi::eCommandListType::GRAPHICS);
-						GraphicsCmdListPtr injectList = context.commandListPool->RequestGraphicsList(injectAlloc.get());
-
-						injectList->ResourceBarrier((unsigned)barriers.size(), barriers.data());
-						injectList->Close();
-
-						EnqueueCommandList(*context.commandQueue,
-										   std::move(injectList),
-										   std::move(injectAlloc),
-										   {},
-										   {},
-										   {},
-										   context);
-					}
-
-					// Update resource states.
-					UpdateResourceStates(decomposition.usedResources.begin(), decomposition.usedResources.end());
-
-					// Enqueue actual command list.
-					std::vector<MemoryObject> usedResourceList;
-					usedResourceList.reserve(decomposition.usedResources.size());
-					for (auto& v : decomposition.usedResources) {
-						usedResourceList.push_back(std::move(v.resource));
-					}
-					for (auto& v : decomposition.additionalResources) {
-						usedResourceList.push_back(std::move(v));
-					}
-
-					dynamic_cast<gxapi::ICopyCommandList*>(decomposition.commandList.get())->Close();
-
-					EnqueueCommandList(*context.commandQueue,
-									   std::move(decomposition.commandList),
-									   std::move(decomposition.commandAllocator),
-									   std::move(decomposition.scratchSpaces),
-									   std::move(usedResourceList),
-									   std::unique_ptr<VolatileViewHeap>(new VolatileViewHeap(std::move(volatileHeap))),
-									   context);
+			if (task == nullptr) {
+				continue;
+			}
 
+			// Submit the previous tasks' command list unless this one can continue it.
+			if (renderContext && renderContext->IsListInitialized()) {
+				if (CanMergeTasks(previousTask, task, *renderContext, numMergedTasks)) {
+					++numMergedTasks;
+				}
+				else {
+					SubmitRenderContext(*renderContext, std::move(volatileHeap), context);
+					renderContext.reset();
+				}
+			}
+			if (!renderContext) {
+				volatileHeap = std::make_unique<VolatileViewHeap>(context.gxApi);
+				renderContext = std::make_unique<RenderContext>(context.memoryManager,
+																context.textureSpace,
+																volatileHeap.get(),
+																context.shaderManager,
+																context.gxApi,
+																context.commandListPool,
+																context.commandAllocatorPool,
+																context.scratchSpacePool,
+																context.binderCache);
+				numMergedTasks = 1;
+			}
 
+			// Execute the task on the CPU.
+			auto executeBegin = FrameProfiler::Clock::now();
+			task->Execute(*renderContext);
+			if (m_profiler) {
+				m_profiler->RecordCpu(GetTaskName(task), eProfilerPhase::EXECUTE, executeBegin, FrameProfiler::Clock::now());
+			}
 
+			if (renderContext->IsListInitialized()) {
+				if (m_profiler) {
+					// Timestamp at the end of each task, so merged tasks are still timed one by one.
+					BasicCommandList& commandList = GetCommandList(*renderContext);
+					m_profiler->WriteTimestamp(dynamic_cast<gxapi::ICopyCommandList*>(commandList.GetCommandList()), GetTaskName(task));
 				}
+				previousTask = task;
 			}
 		}
+		if (renderContext && renderContext->IsListInitialized()) {
+			SubmitRenderContext(*renderContext, std::move(volatileHeap), context);
+		}
+		renderContext.reset();
 
 		// Set backBuffer to PRESENT state.
 		gxapi::eResourceState bbState = context.backBuffer->GetResource().ReadState(0);
@@ -165,10 +238,21 @@ void Scheduler::Execute(FrameContext context) {
 			context.log->Event(std::string("Fatal pipeline Execute error, could not render error screen: ") + ex.what());
 		}
 	}
+
+	if (m_profiler) {
+		try {
+			EndProfiledFrame(context);
+		}
+		catch (std::exception& ex) {
+			context.log->Event(std::string("Profiler could not finish frame: ") + ex.what());
+		}
+	}
 }
 
 
 void Scheduler::ReleaseResources() {
+	// Nodes drop their inputs, constants must be set again.
+	m_constantsValid = false;
 	for (NodeBase& node : m_pipeline) {
 		if (GraphicsNode* ptr = dynamic_cast<GraphicsNode*>(&node)) {
 			ptr->Reset();
@@ -177,6 +261,250 @@ void Scheduler::ReleaseResources() {
 }
 
 
+void Scheduler::SetWarmUpThreadCount(unsigned numThreads) {
+	m_warmUpThreadCount = numThreads;
+}
+
+unsigned Scheduler::GetWarmUpThreadCount() const {
+	return m_warmUpThreadCount;
+}
+
+
+void Scheduler::SetProfiler(FrameProfiler* profiler) {
+	m_profiler = profiler;
+}
+
+FrameProfiler* Scheduler::GetProfiler() const {
+	return m_profiler;
+}
+
+
+void Scheduler::InvalidateConstants() {
+	m_constantsValid = false;
+}
+
+
+void Scheduler::SetPassMergingEnabled(bool enabled) {
+	m_passMergingEnabled = enabled;
+}
+
+bool Scheduler::GetPassMergingEnabled() const {
+	return m_passMergingEnabled;
+}
+
+
+bool Scheduler::CanMergeTasks(const GraphicsTask* previous, const GraphicsTask* next, const RenderContext& renderContext, unsigned numMergedTasks) const {
+	// Copy lists cannot take draws and dispatches. Graphics and compute lists are the same on the graphics queue.
+	if (!m_passMergingEnabled
+		|| renderContext.GetType() == gxapi::eCommandListType::COPY
+		|| numMergedTasks >= MaxMergedTasks)
+	{
+		return false;
+	}
+
+	// Merge when the next task consumes the previous one's results. They are serialized by
+	// barriers either way, but this way the barriers are recorded inline by the command list.
+	auto it = m_taskDependents.find(previous);
+	return it != m_taskDependents.end() && std::find(it->second.begin(), it->second.end(), next) != it->second.end();
+}
+
+
+void Scheduler::SubmitRenderContext(RenderContext& renderContext, std::unique_ptr<VolatileViewHeap> volatileHeap, const FrameContext& context) {
+	BasicCommandList::Decomposition decomposition = GetCommandList(renderContext).Decompose();
+
+	std::sort(decomposition.usedResources.begin(), decomposition.usedResources.end(), [](const ResourceUsage& lhs, const ResourceUsage& rhs) {
+		auto lhsPtr = lhs.resource._GetResourcePtr();
+		auto rhsPtr = rhs.resource._GetResourcePtr();
+		return lhsPtr < rhsPtr || (lhs.resource._GetResourcePtr() == rhs.resource._GetResourcePtr() && lhs.subresource < rhs.subresource);
+	});
+
+	// Inject a transition barrier command list.
+	auto barriers = InjectBarriers(decomposition.usedResources.begin(), decomposition.usedResources.end());
+	if (barriers.size() > 0) {
+		CmdAllocPtr injectAlloc = context.commandAllocatorPool->RequestAllocator(gxapi::eCommandListType::GRAPHICS);
+		GraphicsCmdListPtr injectList = context.commandListPool->RequestGraphicsList(injectAlloc.get());
+
+		injectList->ResourceBarrier((unsigned)barriers.size(), barriers.data());
+		injectList->Close();
+
+		EnqueueCommandList(*context.commandQueue,
+						   std::move(injectList),
+						   std::move(injectAlloc),
+						   {},
+						   {},
+						   {},
+						   context);
+	}
+
+	// Update resource states.
+	UpdateResourceStates(decomposition.usedResources.begin(), decomposition.usedResources.end());
+
+	// Enqueue actual command list.
+	std::vector<MemoryObject> usedResourceList;
+	usedResourceList.reserve(decomposition.usedResources.size());
+	for (auto& v : decomposition.usedResources) {
+		usedResourceList.push_back(std::move(v.resource));
+	}
+	for (auto& v : decomposition.additionalResources) {
+		usedResourceList.push_back(std::move(v));
+	}
+
+	gxapi::ICopyCommandList* copyList = dynamic_cast<gxapi::ICopyCommandList*>(decomposition.commandList.get());
+	copyList->Close();
+
+	EnqueueCommandList(*context.commandQueue,
+					   std::move(decomposition.commandList),
+					   std::move(decomposition.commandAllocator),
+					   std::move(decomposition.scratchSpaces),
+					   std::move(usedResourceList),
+					   std::move(volatileHeap),
+					   context);
+}
+
+
+BasicCommandList& Scheduler::GetCommandList(RenderContext& renderContext) {
+	switch (renderContext.GetType()) {
+		case gxapi::eCommandListType::GRAPHICS: return renderContext.AsGraphics();
+		case gxapi::eCommandListType::COMPUTE: return renderContext.AsCompute();
+		case gxapi::eCommandListType::COPY: return renderContext.AsCopy();
+		default: assert(false);
+	}
+	throw InvalidStateException("Render context has an unknown command list type.");
+}
+
+
+void Scheduler::SetupTask(GraphicsTask* task, const FrameContext& context) const {
+	SetupContext setupContext(context.memoryManager, context.textureSpace, context.rtvHeap, context.dsvHeap, context.shaderManager, context.gxApi, context.binderCache);
+	auto setupBegin = FrameProfiler::Clock::now();
+	task->Setup(setupContext);
+	if (m_profiler) {
+		m_profiler->RecordCpu(GetTaskName(task), eProfilerPhase::SETUP, setupBegin, FrameProfiler::Clock::now());
+	}
+}
+
+
+void Scheduler::BeginProfiledFrame(const FrameContext& context) {
+	m_profiler->BeginFrame(context.frame, context.gxApi, *context.commandQueue);
+
+	CmdAllocPtr allocator = context.commandAllocatorPool->RequestAllocator(gxapi::eCommandListType::GRAPHICS);
+	GraphicsCmdListPtr commandList = context.commandListPool->RequestGraphicsList(allocator.get());
+	m_profiler->WriteTimestamp(commandList.get(), {});
+	commandList->Close();
+	EnqueueCommandList(*context.commandQueue, std::move(commandList), std::move(allocator), {}, {}, {}, context);
+}
+
+
+void Scheduler::EndProfiledFrame(const FrameContext& context) {
+	CmdAllocPtr allocator = context.commandAllocatorPool->RequestAllocator(gxapi::eCommandListType::GRAPHICS);
+	GraphicsCmdListPtr commandList = context.commandListPool->RequestGraphicsList(allocator.get());
+	m_profiler->ResolveTimestamps(commandList.get());
+	commandList->Close();
+	SyncPoint finished = EnqueueCommandList(*context.commandQueue, std::move(commandList), std::move(allocator), {}, {}, {}, context);
+	m_profiler->EndFrame(finished);
+}
+
+
+const std::string& Scheduler::GetTaskName(const GraphicsTask* task) const {
+	static const std::string uploadName = "Upload";
+	static const std::string unknownName = "";
+
+	if (dynamic_cast<const UploadTask*>(task)) {
+		return uploadName;
+	}
+	auto it = m_taskNames.find(task);
+	return it != m_taskNames.end() ? it->second : unknownName;
+}
+
+
+void Scheduler::SetupParallel(const lemon::ListDigraph& taskGraph,
+							  const lemon::ListDigraph::NodeMap<GraphicsTask*>& taskFunctionMap,
+							  const FrameContext& context,
+							  unsigned numThreads) const
+{
+	using TaskNode = lemon::ListDigraph::Node;
+
+	// Count unfinished dependencies for each task, tasks without any are ready to go.
+	lemon::ListDigraph::NodeMap<int> numDependencies(taskGraph, 0);
+	std::vector<TaskNode> readyTasks;
+	size_t numRemaining = 0;
+	for (lemon::ListDigraph::NodeIt taskNode(taskGraph); taskNode != lemon::INVALID; ++taskNode) {
+		for (lemon::ListDigraph::InArcIt arc(taskGraph, taskNode); arc != lemon::INVALID; ++arc) {
+			++numDependencies[taskNode];
+		}
+		if (numDependencies[taskNode] == 0) {
+			readyTasks.push_back(taskNode);
+		}
+		++numRemaining;
+	}
+
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::exception_ptr error;
+	std::mutex serialSetupMtx; // Held while setting up tasks that are not allowed to run concurrently.
+
+	// Workers take any ready task, set it up, then release the tasks that were waiting for it.
+	auto worker = [&]() {
+		for (;;) {
+			TaskNode taskNode;
+			{
+				std::unique_lock<std::mutex> lkg(mtx);
+				cv.wait(lkg, [&] { return !readyTasks.empty() || numRemaining == 0 || error; });
+				if (numRemaining == 0 || error) {
+					return;
+				}
+				taskNode = readyTasks.back();
+				readyTasks.pop_back();
+			}
+
+			try {
+				GraphicsTask* task = taskFunctionMap[taskNode];
+				if (task != nullptr && m_parallelSetupTasks.count(task) > 0) {
+					SetupTask(task, context);
+				}
+				else if (task != nullptr) {
+					std::lock_guard<std::mutex> serialLkg(serialSetupMtx);
+					SetupTask(task, context);
+				}
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lkg(mtx);
+				if (!error) {
+					error = std::current_exception();
+				}
+				cv.notify_all();
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lkg(mtx);
+				--numRemaining;
+				for (lemon::ListDigraph::OutArcIt arc(taskGraph, taskNode); arc != lemon::INVALID; ++arc) {
+					TaskNode dependent = taskGraph.target(arc);
+					if (--numDependencies[dependent] == 0) {
+						readyTasks.push_back(dependent);
+					}
+				}
+			}
+			cv.notify_all();
+		}
+	};
+
+	// The calling thread works too.
+	std::vector<std::thread> threads;
+	for (unsigned i = 1; i < numThreads; ++i) {
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+
 void Scheduler::MakeResident(std::vector<MemoryObject*> usedResources) {
 
 }
@@ -216,13 +544,13 @@ std::vector<GraphicsTask*> Scheduler::MakeSchedule(const lemon::ListDigraph& tas
 }
 
 
-void Scheduler::EnqueueCommandList(CommandQueue& commandQueue,
-								   CmdListPtr commandList,
-								   CmdAllocPtr commandAllocator,
-								   std::vector<ScratchSpacePtr> scratchSpaces,
-								   std::vector<MemoryObject> usedResources,
-								   std::unique_ptr<VolatileViewHeap> volatileHeap,
-								   const FrameContext& context)
+SyncPoint Scheduler::EnqueueCommandList(CommandQueue& commandQueue,
+								        CmdListPtr commandList,
+								        CmdAllocPtr commandAllocator,
+								        std::vector<ScratchSpacePtr> scratchSpaces,
+								        std::vector<MemoryObject> usedResources,
+								        std::unique_ptr<VolatileViewHeap> volatileHeap,
+								        const FrameContext& context)
 {
 	// Enqueue CPU task to make resources resident before the command list runs.
 	SyncPoint residentPoint = context.residencyQueue->EnqueueInit(usedResources);
@@ -237,6 +565,8 @@ void Scheduler::EnqueueCommandList(CommandQueue& commandQueue,
 
 	// Enqueue CPU task to clean up resources after command list finished.
 	context.residencyQueue->EnqueueClean(completionPoint, std::move(usedResources), std::move(commandAllocator), std::move(scratchSpaces), std::move(volatileHeap));
+
+	return completionPoint;
 }
 
 
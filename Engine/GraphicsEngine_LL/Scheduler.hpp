@@ -6,6 +6,7 @@
 #include "ScratchSpacePool.hpp"
 #include "CommandListPool.hpp"
 #include "MemoryObject.hpp"
+#include "FrameProfiler.hpp"
 
 #include <BaseLibrary/optional.hpp>
 #include <GraphicsApi_LL/IFence.hpp>
@@ -13,6 +14,9 @@
 #include <memory>
 #include <cstdint>
 #include <vector>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace inl {
 namespace gxeng {
@@ -29,6 +33,25 @@ public:
 	Pipeline ReleasePipeline();
 	void Execute(FrameContext context);
 	void ReleaseResources();
+
+	/// <summary> Sets how many threads are used to set up the tasks of a freshly loaded pipeline.
+	///		Zero selects the number of hardware threads. </summary>
+	void SetWarmUpThreadCount(unsigned numThreads);
+	unsigned GetWarmUpThreadCount() const;
+
+	/// <summary> Sets the profiler that receives the timings of the tasks. Null disables profiling. </summary>
+	void SetProfiler(FrameProfiler* profiler);
+	FrameProfiler* GetProfiler() const;
+
+	/// <summary> Makes the constant nodes of the pipeline compute their outputs again in the next frame.
+	///		Call when environment variables change. </summary>
+	void InvalidateConstants();
+
+	/// <summary> Sets whether tasks that directly depend on each other are recorded into the same command list. </summary>
+	/// <remarks> Saves a submission, a fence signal and a barrier list per merged task, for example on chains of
+	///		full-screen passes. Enabled by default. </remarks>
+	void SetPassMergingEnabled(bool enabled);
+	bool GetPassMergingEnabled() const;
 protected:
 	struct UsedResource {
 		MemoryObject* resource;
@@ -42,17 +65,38 @@ protected:
 	static void Evict(std::vector<MemoryObject*> usedResources);
 
 
+	/// <summary> Calls Setup on every task of the graph using multiple threads.
+	///		A task is only set up when all tasks it depends on have been set up. </summary>
+	/// <remarks> This is meant for the first frame of a new pipeline, where nodes compile their shaders,
+	///		build their binders and PSOs. Later frames' setups are too cheap to benefit from threading.
+	///		Only tasks of nodes that allow parallel setup run concurrently, the rest are set up one at a time. </remarks>
+	void SetupParallel(const lemon::ListDigraph& taskGraph,
+					   const lemon::ListDigraph::NodeMap<GraphicsTask*>& taskFunctionMap,
+					   const FrameContext& context,
+					   unsigned numThreads) const;
+
+	/// <summary> Calls the task's Setup, and reports how long it took if profiling. </summary>
+	void SetupTask(GraphicsTask* task, const FrameContext& context) const;
+
 	static std::vector<GraphicsTask*> MakeSchedule(const lemon::ListDigraph& taskGraph,
 												   const lemon::ListDigraph::NodeMap<GraphicsTask*>& taskFunctionMap
 													/*std::vector<CommandQueue*> queues*/);
 
-	static void EnqueueCommandList(CommandQueue& commandQueue,
-								   CmdListPtr commandList,
-								   CmdAllocPtr commandAllocator,
-								   std::vector<ScratchSpacePtr> scratchSpaces,
-								   std::vector<MemoryObject> usedResources,
-								   std::unique_ptr<VolatileViewHeap> volatileHeap,
-								   const FrameContext& context);
+	/// <summary> Whether the task can be recorded into the command list the previous task was recorded to. </summary>
+	bool CanMergeTasks(const GraphicsTask* previous, const GraphicsTask* next, const RenderContext& renderContext, unsigned numMergedTasks) const;
+
+	/// <summary> Injects the barriers needed by the recorded command list and enqueues them. </summary>
+	void SubmitRenderContext(RenderContext& renderContext, std::unique_ptr<VolatileViewHeap> volatileHeap, const FrameContext& context);
+
+	static BasicCommandList& GetCommandList(RenderContext& renderContext);
+
+	static SyncPoint EnqueueCommandList(CommandQueue& commandQueue,
+								        CmdListPtr commandList,
+								        CmdAllocPtr commandAllocator,
+								        std::vector<ScratchSpacePtr> scratchSpaces,
+								        std::vector<MemoryObject> usedResources,
+								        std::unique_ptr<VolatileViewHeap> volatileHeap,
+								        const FrameContext& context);
 
 	template <class UsedResourceIter>
 	static std::vector<gxapi::ResourceBarrier> InjectBarriers(UsedResourceIter firstResource, UsedResourceIter lastResource);
@@ -64,8 +108,28 @@ protected:
 	static void UpdateResourceStates(UsedResourceIter firstResource, UsedResourceIter lastResource);
 
 	static void RenderFailureScreen(FrameContext context);
+
+	/// <summary> Records a GPU timestamp to mark the beginning of the frame for the profiler. </summary>
+	void BeginProfiledFrame(const FrameContext& context);
+	/// <summary> Copies the GPU timestamps of the frame so that the profiler can read them later. </summary>
+	void EndProfiledFrame(const FrameContext& context);
+
+	/// <summary> Name of the pipeline node the task belongs to. </summary>
+	const std::string& GetTaskName(const GraphicsTask* task) const;
 private:
 	Pipeline m_pipeline;
+	bool m_warmUpPending = false;
+	unsigned m_warmUpThreadCount = 0;
+	FrameProfiler* m_profiler = nullptr;
+	std::unordered_map<const GraphicsTask*, std::string> m_taskNames;
+
+	std::unordered_set<const GraphicsTask*> m_constantTasks;
+	std::unordered_set<const GraphicsTask*> m_parallelSetupTasks;
+	bool m_constantsValid = false;
+
+	bool m_passMergingEnabled = true;
+	std::unordered_map<const GraphicsTask*, std::vector<const GraphicsTask*>> m_taskDependents;
+	static constexpr unsigned MaxMergedTasks = 8;
 private:
 	class UploadTask : public GraphicsTask {
 	public:
@@ -1,4 +1,7 @@
 #include "ScratchSpacePool.hpp"
+
+#include <BaseLibrary/Exception/Exception.hpp>
+
 #include <cassert>
 #include <algorithm>
 
@@ -10,6 +13,16 @@ ScratchSpacePool::ScratchSpacePool(gxapi::IGraphicsApi* gxApi, gxapi::eDescripto
 {}
 
 
+void ScratchSpacePool::SetBindlessHeap(BindlessTextureHeap* bindlessHeap) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	assert(m_pool.empty());
+	assert(m_type == gxapi::eDescriptorHeapType::CBV_SRV_UAV);
+
+	m_bindlessHeap = bindlessHeap;
+	GrowSharedHeap(InitialSharedScratchSpaces);
+}
+
+
 auto ScratchSpacePool::RequestScratchSpace() -> UniquePtr {
 	std::lock_guard<std::mutex> lkg(m_mutex);
 
@@ -26,15 +39,41 @@ auto ScratchSpacePool::RequestScratchSpace() -> UniquePtr {
 		index = m_allocator.Allocate();
 	}
 
-	if (m_pool[index] != nullptr) {
-		return UniquePtr{ m_pool[index].get(), Deleter{this} };
+	if (!m_sharedHeaps.empty()) {
+		if (index >= m_sharedHeaps.back().numScratchSpaces) {
+			try {
+				GrowSharedHeap(uint32_t(index + 1));
+			}
+			catch (...) {
+				m_allocator.Deallocate(index);
+				throw;
+			}
+		}
+		// The scratch space is not in use, so it can move to the current heap.
+		gxapi::IDescriptorHeap* currentHeap = m_sharedHeaps.back().heap.get();
+		if (m_pool[index] != nullptr && m_pool[index]->GetHeap() != currentHeap) {
+			ReleaseSharedSlot(m_pool[index]->GetHeap());
+			m_addressToIndex.erase(m_pool[index].get());
+			m_pool[index].reset();
+		}
 	}
-	else {
-		std::unique_ptr<StackDescHeap> ptr(new StackDescHeap{ m_gxApi, m_type, 1000 });
+
+	if (m_pool[index] == nullptr) {
+		std::unique_ptr<StackDescHeap> ptr;
+		if (!m_sharedHeaps.empty()) {
+			SharedHeap& sharedHeap = m_sharedHeaps.back();
+			uint32_t offset = BindlessTextureHeap::Capacity + (uint32_t)index * ScratchSpaceSize;
+			ptr.reset(new StackDescHeap{ sharedHeap.heap.get(), offset, ScratchSpaceSize, 0, BindlessTextureHeap::Capacity });
+			++sharedHeap.numLive;
+		}
+		else {
+			ptr.reset(new StackDescHeap{ m_gxApi, m_type, ScratchSpaceSize });
+		}
 		m_addressToIndex[ptr.get()] = index;
 		m_pool[index] = std::move(ptr);
-		return UniquePtr{ m_pool[index].get(), Deleter{this} };
 	}
+
+	return UniquePtr{ m_pool[index].get(), Deleter{this} };
 }
 
 
@@ -48,6 +87,47 @@ void ScratchSpacePool::RecycleScratchSpace(StackDescHeap* scratchSpace) {
 }
 
 
+void ScratchSpacePool::GrowSharedHeap(uint32_t minScratchSpaces) {
+	constexpr uint32_t maxScratchSpaces = (MaxSharedHeapSize - BindlessTextureHeap::Capacity) / ScratchSpaceSize;
+	if (minScratchSpaces > maxScratchSpaces) {
+		throw OutOfMemoryException("The shared descriptor heap cannot hold more scratch spaces.");
+	}
+
+	uint32_t numScratchSpaces = minScratchSpaces;
+	if (!m_sharedHeaps.empty()) {
+		numScratchSpaces = std::max(numScratchSpaces, m_sharedHeaps.back().numScratchSpaces * 2);
+	}
+	numScratchSpaces = std::min(numScratchSpaces, maxScratchSpaces);
+
+	gxapi::DescriptorHeapDesc desc(m_type, BindlessTextureHeap::Capacity + numScratchSpaces * ScratchSpaceSize, true);
+	std::unique_ptr<gxapi::IDescriptorHeap> heap(m_gxApi->CreateDescriptorHeap(desc));
+	m_bindlessHeap->AddShaderVisibleTable(heap.get(), 0);
+
+	gxapi::IDescriptorHeap* previous = m_sharedHeaps.empty() ? nullptr : m_sharedHeaps.back().heap.get();
+	m_sharedHeaps.push_back({ std::move(heap), numScratchSpaces, 0 });
+	if (previous && m_sharedHeaps[m_sharedHeaps.size() - 2].numLive == 0) {
+		m_bindlessHeap->RemoveShaderVisibleTable(previous);
+		m_sharedHeaps.erase(m_sharedHeaps.end() - 2);
+	}
+}
+
+
+void ScratchSpacePool::ReleaseSharedSlot(gxapi::IDescriptorHeap* heap) {
+	auto it = std::find_if(m_sharedHeaps.begin(), m_sharedHeaps.end(), [heap](const SharedHeap& sharedHeap) {
+		return sharedHeap.heap.get() == heap;
+	});
+	assert(it != m_sharedHeaps.end());
+	assert(it->numLive > 0);
+
+	// Old heaps are destroyed once nothing is placed in them, the current one is kept.
+	--it->numLive;
+	if (it->numLive == 0 && it + 1 != m_sharedHeaps.end()) {
+		m_bindlessHeap->RemoveShaderVisibleTable(heap);
+		m_sharedHeaps.erase(it);
+	}
+}
+
+
 
 } // namespace gxeng
 } // namespace inl
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "../BaseLibrary/Memory/SlabAllocatorEngine.hpp"
 #include "../GraphicsApi_LL/IGraphicsApi.hpp"
 #include "StackDescHeap.hpp"
+#include "BindlessTextureHeap.hpp"
 #include <vector>
 #include <map>
 #include <mutex>
@@ -34,10 +35,34 @@ public:
 	ScratchSpacePool& operator=(const ScratchSpacePool&) = delete;
 	ScratchSpacePool& operator=(ScratchSpacePool&& rhs) = default;;
 
+	/// <summary> Places all scratch spaces in one shader visible heap, which starts with the bindless table.
+	///		The heap is replaced by a larger one when it runs out of scratch spaces.
+	///		Call before requesting any scratch spaces. </summary>
+	void SetBindlessHeap(BindlessTextureHeap* bindlessHeap);
+
+	/// <exception cref="inl::OutOfMemoryException"> If the shared heap would exceed the size limit of shader visible heaps. </exception>
 	UniquePtr RequestScratchSpace();
 	void RecycleScratchSpace(StackDescHeap* scratchSpace);
 private:
+	// Only one shader visible heap can be bound at a time, so scratch spaces share it with the bindless table.
+	// Old shared heaps are kept until the scratch spaces in them are recycled, the last one is current.
+	struct SharedHeap {
+		std::unique_ptr<gxapi::IDescriptorHeap> heap;
+		uint32_t numScratchSpaces; // Room for this many.
+		size_t numLive; // Scratch spaces created in the heap and not yet moved to a newer one.
+	};
+
+	void GrowSharedHeap(uint32_t minScratchSpaces);
+	void ReleaseSharedSlot(gxapi::IDescriptorHeap* heap);
+private:
+	static constexpr uint32_t ScratchSpaceSize = 1000;
+	static constexpr uint32_t InitialSharedScratchSpaces = 64;
+	// D3D12 limit of shader visible CBV_SRV_UAV heaps on resource binding tiers 1 and 2.
+	static constexpr uint32_t MaxSharedHeapSize = 1000000;
+
 	std::vector<std::unique_ptr<StackDescHeap>> m_pool;
+	std::vector<SharedHeap> m_sharedHeaps;
+	BindlessTextureHeap* m_bindlessHeap = nullptr;
 	gxapi::eDescriptorHeapType m_type;
 	SlabAllocatorEngine m_allocator;
 	gxapi::IGraphicsApi* m_gxApi;
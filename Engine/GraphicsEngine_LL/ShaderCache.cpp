@@ -0,0 +1,185 @@
+#include "ShaderCache.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+
+
+namespace inl {
+namespace gxeng {
+
+
+namespace {
+	// File layout: header followed by the raw binary.
+	struct CacheFileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t key;
+		uint64_t size;
+		uint64_t checksum;
+	};
+
+	constexpr uint32_t CacheFileMagic = 0x53434e49; // "INCS"
+	constexpr uint32_t CacheFileVersion = 1;
+}
+
+
+void ShaderCache::SetDirectory(std::experimental::filesystem::path directory) {
+	m_directory = std::move(directory);
+	if (!m_directory.empty()) {
+		std::error_code ec;
+		std::experimental::filesystem::create_directories(m_directory, ec);
+		if (ec) {
+			m_directory.clear(); // can't use the folder, just go on without cache
+		}
+	}
+}
+
+const std::experimental::filesystem::path& ShaderCache::GetDirectory() const {
+	return m_directory;
+}
+
+bool ShaderCache::IsEnabled() const {
+	return !m_directory.empty();
+}
+
+
+bool ShaderCache::Load(uint64_t key, std::vector<uint8_t>& binary) {
+	if (!IsEnabled()) {
+		return false;
+	}
+
+	std::ifstream file(GetFilePath(key), std::ios::binary);
+	CacheFileHeader header;
+	if (!file.is_open() || !file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+		++m_misses;
+		return false;
+	}
+
+	// Reject files of other versions, hash collisions on file name level and truncated files.
+	if (header.magic != CacheFileMagic || header.version != CacheFileVersion || header.key != key) {
+		++m_misses;
+		return false;
+	}
+
+	// The size comes from disk, so it must not be trusted before it's checked against the length of the file.
+	const std::streamoff contentBegin = file.tellg();
+	file.seekg(0, std::ios::end);
+	const std::streamoff contentEnd = file.tellg();
+	if (contentBegin < 0 || contentEnd < contentBegin || header.size != uint64_t(contentEnd - contentBegin)) {
+		++m_misses;
+		return false;
+	}
+	file.seekg(contentBegin);
+
+	std::vector<uint8_t> content(header.size);
+	if (!file.read(reinterpret_cast<char*>(content.data()), content.size())
+		|| Hash(content.data(), content.size()) != header.checksum)
+	{
+		++m_misses;
+		return false;
+	}
+
+	binary = std::move(content);
+	++m_hits;
+	return true;
+}
+
+
+void ShaderCache::Store(uint64_t key, const std::vector<uint8_t>& binary) {
+	if (!IsEnabled()) {
+		return;
+	}
+
+	CacheFileHeader header;
+	header.magic = CacheFileMagic;
+	header.version = CacheFileVersion;
+	header.key = key;
+	header.size = binary.size();
+	header.checksum = Hash(binary.data(), binary.size());
+
+	// Write to a temporary file first, and move it in place when complete,
+	// so that concurrent readers (or other processes) never see half-written binaries.
+	auto filePath = GetFilePath(key);
+	std::stringstream tempName;
+	tempName << filePath.filename().string() << "." << std::this_thread::get_id() << ".tmp";
+	auto tempPath = m_directory / tempName.str();
+
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			return;
+		}
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+		if (!file) {
+			file.close();
+			std::error_code ec;
+			std::experimental::filesystem::remove(tempPath, ec);
+			return;
+		}
+	}
+
+	std::error_code ec;
+	std::experimental::filesystem::rename(tempPath, filePath, ec);
+	if (ec) {
+		// Someone else has probably written the same binary, which is just as good.
+		std::experimental::filesystem::remove(tempPath, ec);
+		return;
+	}
+	++m_writes;
+}
+
+
+void ShaderCache::Clear() {
+	if (!IsEnabled()) {
+		return;
+	}
+
+	std::error_code ec;
+	for (auto& entry : std::experimental::filesystem::directory_iterator(m_directory, ec)) {
+		if (entry.path().extension() == ".cso") {
+			std::experimental::filesystem::remove(entry.path(), ec);
+		}
+	}
+}
+
+
+auto ShaderCache::GetStatistics() const -> Statistics {
+	Statistics stats;
+	stats.hits = m_hits;
+	stats.misses = m_misses;
+	stats.writes = m_writes;
+	return stats;
+}
+
+
+uint64_t ShaderCache::Hash(const void* data, size_t size, uint64_t seed) {
+	constexpr uint64_t prime = 0x100000001b3ull;
+
+	uint64_t hash = seed;
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= prime;
+	}
+	return hash;
+}
+
+uint64_t ShaderCache::Hash(const std::string& str, uint64_t seed) {
+	// Hash the terminator too, so that concatenated strings don't collide ("ab"+"c" vs "a"+"bc").
+	return Hash(str.c_str(), str.size() + 1, seed);
+}
+
+
+std::experimental::filesystem::path ShaderCache::GetFilePath(uint64_t key) const {
+	std::stringstream ss;
+	ss << std::hex << std::setw(16) << std::setfill('0') << key << ".cso";
+	return m_directory / ss.str();
+}
+
+
+
+} // namespace gxeng
+} // namespace inl
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <cstdint>
+
+
+namespace inl {
+namespace gxeng {
+
+
+/// <summary>
+/// Persistent storage of compiled shader binaries on disk.
+/// Binaries are content-addressed: the key is a hash of everything that influences
+/// the compiler's output, so a key is never invalidated, only orphaned.
+/// </summary>
+/// <remarks>
+/// Load and Store are thread-safe. Setting the directory is not.
+/// </remarks>
+class ShaderCache {
+public:
+	struct Statistics {
+		size_t hits = 0;
+		size_t misses = 0;
+		size_t writes = 0;
+	};
+public:
+	ShaderCache() = default;
+
+	/// <summary> Sets the folder where binaries are kept. An empty path disables the cache. </summary>
+	void SetDirectory(std::experimental::filesystem::path directory);
+	const std::experimental::filesystem::path& GetDirectory() const;
+	bool IsEnabled() const;
+
+	/// <summary> Looks up the binary for the key. </summary>
+	/// <returns> True if a valid binary was found, false otherwise. </returns>
+	bool Load(uint64_t key, std::vector<uint8_t>& binary);
+
+	/// <summary> Writes the binary for the key. Failures are silently ignored, the cache is only an optimization. </summary>
+	void Store(uint64_t key, const std::vector<uint8_t>& binary);
+
+	/// <summary> Deletes all cache files from the directory. </summary>
+	void Clear();
+
+	Statistics GetStatistics() const;
+
+	/// <summary> 64 bit FNV-1a. Stable across runs and platforms, unlike std::hash. </summary>
+	static uint64_t Hash(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ull);
+	static uint64_t Hash(const std::string& str, uint64_t seed = 0xcbf29ce484222325ull);
+private:
+	std::experimental::filesystem::path GetFilePath(uint64_t key) const;
+private:
+	std::experimental::filesystem::path m_directory;
+
+	std::atomic_size_t m_hits{ 0 };
+	std::atomic_size_t m_misses{ 0 };
+	std::atomic_size_t m_writes{ 0 };
+};
+
+
+
+} // namespace gxeng
+} // namespace inl
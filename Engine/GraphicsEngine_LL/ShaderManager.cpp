@@ -10,13 +10,15 @@ namespace gxeng {
 
 
 ShaderManager::ShaderManager(gxapi::IGxapiManager* gxapiManager)
-	: m_gxapiManager(gxapiManager)
+	: m_gxapiManager(gxapiManager), m_fileSystem(nullptr)
 {
 	unsigned numCores = std::thread::hardware_concurrency();
 	numCores = std::max(1u, numCores); // must be at least one core
 	numCores = std::min(64u, numCores); // there should not be more than 64 cores... too many mutexes
 	m_numCompileMutexes = numCores * 5; // should find some prime larger than X, but that's it for now
 	m_compileMutexes = std::make_unique<std::mutex[]>(m_numCompileMutexes);
+
+	m_compilerId = m_gxapiManager->GetShaderCompilerId();
 }
 
 ShaderManager::~ShaderManager() {
@@ -40,6 +42,12 @@ auto ShaderManager::GetSourceDirectories() const -> std::pair<PathContainer::con
 	return{ m_directories.begin(), m_directories.end() };
 }
 
+void ShaderManager::SetFileSystem(const VirtualFileSystem* fileSystem) {
+	std::unique_lock<std::shared_mutex> lkg(m_sourceMutex);
+
+	m_fileSystem = fileSystem;
+}
+
 
 void ShaderManager::AddSourceCode(std::string name, std::string sourceCode) {
 	std::unique_lock<std::shared_mutex> lkg(m_sourceMutex);
@@ -75,7 +83,7 @@ const ShaderProgram& ShaderManager::CreateShader(const std::string& name, Shader
 	// shader does not exist
 	else {
 		// insert new entry for shader
-		auto ins = m_shaders.insert({ name, std::make_unique<ShaderStore>() });
+		auto ins = m_shaders.insert({ shaderId, std::make_unique<ShaderStore>() });
 		it = ins.first;
 	}
 	ShaderStore* shader = it->second.get();
@@ -90,6 +98,14 @@ const ShaderProgram& ShaderManager::CreateShader(const std::string& name, Shader
 	size_t nameHash = ShaderIdHash()(shaderId);
 	std::unique_lock<std::mutex> shaderLock(m_compileMutexes[nameHash % m_numCompileMutexes]);
 
+	// another thread might have compiled it while we were waiting for the lock
+	{
+		std::lock_guard<std::mutex> lkg(m_shaderMutex);
+		if (requestedParts.SubsetOf(shader->parts)) {
+			return shader->program;
+		}
+	}
+
 	// find requested shader code
 	std::string shaderSource;
 	std::string shaderPath;
@@ -109,13 +125,15 @@ const ShaderProgram& ShaderManager::CreateShader(const std::string& name, Shader
 		throw gxapi::ShaderCompilationError("Error while compiling shader \"" + shaderPath + "\"", ex.Subject());
 	}
 
-	shader->parts = shader->parts.SetUnion(partsToCompile);
+	// publish binaries under the map lock, readers check parts under the same lock
+	shaderMapLock.lock();
 	if (partsToCompile.vs) { shader->program.vs = std::move(program.vs); }
 	if (partsToCompile.hs) { shader->program.hs = std::move(program.hs); }
 	if (partsToCompile.ds) { shader->program.ds = std::move(program.ds); }
 	if (partsToCompile.gs) { shader->program.gs = std::move(program.gs); }
 	if (partsToCompile.ps) { shader->program.ps = std::move(program.ps); }
 	if (partsToCompile.cs) { shader->program.cs = std::move(program.cs); }
+	shader->parts = shader->parts.SetUnion(partsToCompile);
 
 	return shader->program;
 }
@@ -134,6 +152,15 @@ void ShaderManager::ReloadShaders() {
 }
 
 
+void ShaderManager::SetCacheDirectory(std::experimental::filesystem::path directory) {
+	m_cache.SetDirectory(std::move(directory));
+}
+
+ShaderCache::Statistics ShaderManager::GetCacheStatistics() const {
+	return m_cache.GetStatistics();
+}
+
+
 std::string ShaderManager::LoadShaderSource(const std::string& name) const {
 	std::shared_lock<std::shared_mutex> lkg(m_sourceMutex);
 
@@ -163,6 +190,14 @@ std::pair<std::string, std::string> ShaderManager::FindShaderCode(const std::str
 	// try it in directories
 	for (const auto& directory : m_directories) {
 		auto filepath = directory / (name + ".hlsl");
+		if (m_fileSystem) {
+			VirtualFile file;
+			if (m_fileSystem->TryOpen(filepath.generic_string(), file)) {
+				const char* content = static_cast<const char*>(file.GetData());
+				return { filepath.generic_string(), std::string(content, content + file.GetSize()) };
+			}
+			continue;
+		}
 		std::ifstream fs(filepath.c_str());
 		if (fs.is_open()) {
 			fs.seekg(0, std::ios::end);
@@ -192,6 +227,20 @@ ShaderProgram ShaderManager::CompileShaderInternal(const std::string& sourceCode
 	IncludeProvider includeProvider([this](const char* name) { return FindShaderCode(name).second; });
 	ShaderProgram ret;
 
+	// The cache key covers everything the compiler's output depends on.
+	// Individual stages get their own key derived from this.
+	uint64_t programKey = 0;
+	if (m_cache.IsEnabled()) {
+		std::unordered_set<std::string> visitedIncludes;
+		auto flags = m_compileFlags;
+		uint32_t flagBits = (uint32_t)static_cast<gxapi::eShaderCompileFlags::EnumT>(flags);
+
+		programKey = HashSourceWithIncludes(sourceCode, visitedIncludes);
+		programKey = ShaderCache::Hash(macros, programKey);
+		programKey = ShaderCache::Hash(&flagBits, sizeof(flagBits), programKey);
+		programKey = ShaderCache::Hash(m_compilerId, programKey);
+	}
+
 	static const char* const mainNames[] = {
 		"VSMain",
 		"HSMain",
@@ -226,12 +275,18 @@ ShaderProgram ShaderManager::CompileShaderInternal(const std::string& sourceCode
 		const int stageId = compileIndices[idx];
 		const char* mainName = mainNames[stageId];
 		gxapi::eShaderType type = types[stageId];
-		auto binary = m_gxapiManager->CompileShader(sourceCode.c_str(),
-			mainName,
-			type,
-			m_compileFlags,
-			&includeProvider,
-			macros.c_str());
+
+		gxapi::ShaderProgramBinary binary;
+		uint64_t stageKey = ShaderCache::Hash(mainName, programKey);
+		if (!m_cache.Load(stageKey, binary.data)) {
+			binary = m_gxapiManager->CompileShader(sourceCode.c_str(),
+				mainName,
+				type,
+				m_compileFlags,
+				&includeProvider,
+				macros.c_str());
+			m_cache.Store(stageKey, binary.data);
+		}
 
 		ShaderStage* dest = nullptr;
 		switch (type) {
@@ -250,6 +305,65 @@ ShaderProgram ShaderManager::CompileShaderInternal(const std::string& sourceCode
 }
 
 
+uint64_t ShaderManager::HashSourceWithIncludes(const std::string& sourceCode, std::unordered_set<std::string>& visitedIncludes) const {
+	uint64_t hash = ShaderCache::Hash(sourceCode);
+
+	for (const auto& includeName : FindIncludes(sourceCode)) {
+		// Include guards make repeated includes legal, and they must not blow up the recursion.
+		hash = ShaderCache::Hash(includeName, hash);
+		if (!visitedIncludes.insert(includeName).second) {
+			continue;
+		}
+
+		// The include may be inside an inactive #if block, so a missing file is not an error here.
+		// The compiler will complain if it's actually needed.
+		std::string includeSource;
+		try {
+			includeSource = FindShaderCode(includeName).second;
+		}
+		catch (FileNotFoundException&) {
+			continue;
+		}
+		uint64_t includeHash = HashSourceWithIncludes(includeSource, visitedIncludes);
+		hash = ShaderCache::Hash(&includeHash, sizeof(includeHash), hash);
+	}
+
+	return hash;
+}
+
+
+std::vector<std::string> ShaderManager::FindIncludes(const std::string& sourceCode) {
+	std::vector<std::string> includes;
+
+	size_t pos = 0;
+	while ((pos = sourceCode.find("#include", pos)) != sourceCode.npos) {
+		// Only count directives at the beginning of a line, that skips most commented out ones.
+		size_t lineBegin = sourceCode.find_last_of('\n', pos);
+		lineBegin = lineBegin == sourceCode.npos ? 0 : lineBegin + 1;
+		bool isDirective = sourceCode.find_first_not_of(" \t", lineBegin) == pos;
+		pos += 8;
+		if (!isDirective) {
+			continue;
+		}
+
+		size_t open = sourceCode.find_first_not_of(" \t", pos);
+		if (open == sourceCode.npos || (sourceCode[open] != '"' && sourceCode[open] != '<')) {
+			continue;
+		}
+		char closeChar = sourceCode[open] == '"' ? '"' : '>';
+		size_t close = sourceCode.find_first_of(std::string{ closeChar, '\n' }, open + 1);
+		if (close == sourceCode.npos || sourceCode[close] != closeChar) {
+			continue;
+		}
+
+		includes.push_back(sourceCode.substr(open + 1, close - open - 1));
+		pos = close;
+	}
+
+	return includes;
+}
+
+
 std::string ShaderManager::StripShaderName(std::string name) {
 	// remove extension from the end, if any
 	size_t extDot = name.find_last_of('.');
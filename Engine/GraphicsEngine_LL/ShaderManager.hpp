@@ -8,6 +8,9 @@
 
 #include <GraphicsApi_LL/IGxapiManager.hpp>
 #include <GraphicsApi_LL/Common.hpp>
+#include <BaseLibrary/FileSystem/VirtualFileSystem.hpp>
+
+#include "ShaderCache.hpp"
 
 
 namespace inl {
@@ -103,6 +106,9 @@ public:
 /// shader codes. Shader binaries are requested by name. If the source code associated
 /// with the requested name is found either as a file, a resource or memory-string,
 /// the code is compiled and the binary is returned.
+/// If a cache directory is set, compiled binaries are also kept on disk, so that
+/// shaders are only recompiled when their source, includes, macros, flags or the
+/// compiler itself changes.
 /// </summary>
 /// <remarks>
 /// This class is designed for concurrent requests for multiple shaders, so it is
@@ -155,6 +161,11 @@ public:
 	///	adding or removing directories concurrently with this is disallowed. </remarks>
 	std::pair<PathContainer::const_iterator, PathContainer::const_iterator> GetSourceDirectories() const;
 
+	/// <summary> Source directories are searched through the file system instead of the disk,
+	///	so shaders can be loaded from pack files. Null searches the disk again. </summary>
+	/// <remarks> This method is thread-safe. The file system must outlive the shader manager or be reset. </remarks>
+	void SetFileSystem(const VirtualFileSystem* fileSystem);
+
 
 	/// <summary> Adds a source code to the list. </summary> 
 	/// <remarks> This method is thread-safe. </remarks>
@@ -189,6 +200,14 @@ public:
 	/// <summary> It does not do anything, but I guess it will be good for something in the future. </summary>
 	void ReloadShaders();
 
+
+	/// <summary> Sets the directory of the persistent shader binary cache. Empty path disables the cache. </summary>
+	/// <remarks> This method is NOT thread-safe, call it before compiling any shaders. </remarks>
+	void SetCacheDirectory(std::experimental::filesystem::path directory);
+
+	/// <summary> Number of binaries loaded from and written to the persistent cache so far. </summary>
+	ShaderCache::Statistics GetCacheStatistics() const;
+
 	/// <summary> Return the source code of a certain shader. </summary>
 	std::string LoadShaderSource(const std::string& name) const;
 
@@ -206,6 +225,13 @@ private:
 	/// <summary> Compiles a shader to binary according to parameters. </summary>
 	ShaderProgram CompileShaderInternal(const std::string& sourceCode, ShaderParts parts, const std::string& macros);
 
+	/// <summary> Hashes the source code along with all the files it includes, recursively. Does not lock anything. </summary>
+	uint64_t HashSourceWithIncludes(const std::string& sourceCode, std::unordered_set<std::string>& visitedIncludes) const;
+
+	/// <summary> Returns the names of the files referenced by #include directives. </summary>
+	/// <remarks> Conditional compilation is not evaluated, so the result may contain more than actually used. </remarks>
+	static std::vector<std::string> FindIncludes(const std::string& sourceCode);
+
 	// Cuts off extension (only .hlsl, .glsl, .cg, .txt), converts to lowercase.
 	static std::string StripShaderName(std::string name);
 private:
@@ -213,6 +239,7 @@ private:
 
 	PathContainer m_directories; /// <summary> List of directories where shaders should be searched for. </summary>
 	CodeContainer m_codes; /// <summary> List of {fileName, sourceCode} of runtime-added char* shaders. </summary>
+	const VirtualFileSystem* m_fileSystem; /// <summary> Source directories are searched in this if set. </summary>
 
 	ShaderContainer m_shaders; /// <summary> List of compiled shaders. </summary>
 
@@ -222,6 +249,9 @@ private:
 	size_t m_numCompileMutexes;
 
 	gxapi::eShaderCompileFlags m_compileFlags;
+
+	ShaderCache m_cache; /// <summary> Persistent binary storage. </summary>
+	std::string m_compilerId; /// <summary> Part of the cache key, a new compiler must not reuse old binaries. </summary>
 };
 
 
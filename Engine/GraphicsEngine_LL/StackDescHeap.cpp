@@ -48,18 +48,35 @@ DescriptorArrayRef::DescriptorArrayRef(StackDescHeap* home, uint32_t pos, uint32
 
 
 StackDescHeap::StackDescHeap(gxapi::IGraphicsApi* graphicsApi, gxapi::eDescriptorHeapType type, uint32_t size) :
-	m_size(size),
+	m_begin(0),
+	m_end(size),
+	m_reservedOffset(0),
+	m_reservedSize(0),
 	m_next(0)
 {
 	assert(type == gxapi::eDescriptorHeapType::CBV_SRV_UAV || type == gxapi::eDescriptorHeapType::SAMPLER);
 	gxapi::DescriptorHeapDesc desc(type, size, true);
-	m_heap.reset(graphicsApi->CreateDescriptorHeap(desc));
+	m_ownedHeap.reset(graphicsApi->CreateDescriptorHeap(desc));
+	m_heap = m_ownedHeap.get();
+}
+
+
+StackDescHeap::StackDescHeap(gxapi::IDescriptorHeap* sharedHeap, uint32_t offset, uint32_t size, uint32_t reservedOffset, uint32_t reservedSize) :
+	m_heap(sharedHeap),
+	m_begin(offset),
+	m_end(offset + size),
+	m_reservedOffset(reservedOffset),
+	m_reservedSize(reservedSize),
+	m_next(offset)
+{
+	assert(offset + size <= sharedHeap->GetDesc().numDescriptors);
+	assert(reservedOffset + reservedSize <= offset || offset + size <= reservedOffset);
 }
 
 
 DescriptorArrayRef StackDescHeap::Allocate(uint32_t size) {
 	uint32_t newNext = m_next + size;
-	if (newNext > m_size) {
+	if (newNext > m_end) {
 		throw std::bad_alloc();
 	}
 	uint32_t descPosition = m_next;
@@ -69,7 +86,7 @@ DescriptorArrayRef StackDescHeap::Allocate(uint32_t size) {
 
 
 void StackDescHeap::Reset() {
-	m_next = 0;
+	m_next = m_begin;
 }
 
 
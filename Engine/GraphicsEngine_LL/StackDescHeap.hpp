@@ -49,11 +49,17 @@ protected:
 /// <para />
 /// Each CPU thread that generates command lists should have
 /// exclusive ownership over at least one instance of this class.
+/// <para />
+/// A scratch space either owns its heap, or is a window into a heap shared with other scratch spaces.
+/// A shared heap can also hold a reserved range of descriptors that are used by all draw calls,
+/// which is never handed out by Allocate.
 /// </summary>
 class StackDescHeap {
 	friend class DescriptorArrayRef;
 public:
 	StackDescHeap(gxapi::IGraphicsApi* graphicsApi, gxapi::eDescriptorHeapType type, uint32_t size);
+	/// <summary> Allocates from <paramref name="size"/> descriptors of <paramref name="sharedHeap"/>, starting at <paramref name="offset"/>. </summary>
+	StackDescHeap(gxapi::IDescriptorHeap* sharedHeap, uint32_t offset, uint32_t size, uint32_t reservedOffset, uint32_t reservedSize);
 
 	DescriptorArrayRef Allocate(uint32_t size);
 
@@ -62,10 +68,19 @@ public:
 	/// </summary>
 	void Reset();
 
-	gxapi::IDescriptorHeap* GetHeap() const { return m_heap.get(); }
+	gxapi::IDescriptorHeap* GetHeap() const { return m_heap; }
+
+	/// <summary> Number of descriptors in the reserved range of the heap. </summary>
+	uint32_t GetReservedSize() const { return m_reservedSize; }
+	/// <summary> First descriptor of the reserved range. Only valid if the reserved size is not zero. </summary>
+	gxapi::DescriptorHandle GetReservedBase() const { return m_heap->At(m_reservedOffset); }
 protected:
-	std::unique_ptr<gxapi::IDescriptorHeap> m_heap;
-	uint32_t m_size;
+	std::unique_ptr<gxapi::IDescriptorHeap> m_ownedHeap;
+	gxapi::IDescriptorHeap* m_heap;
+	uint32_t m_begin;
+	uint32_t m_end;
+	uint32_t m_reservedOffset;
+	uint32_t m_reservedSize;
 	uint32_t m_next;
 };
 
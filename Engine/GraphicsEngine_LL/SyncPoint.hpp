@@ -29,6 +29,12 @@ public:
 		m_fence->Wait(m_value);		
 	}
 
+	/// <summary> Returns true if the point has been reached, without blocking. </summary>
+	bool IsReached() const {
+		assert((bool)m_fence);
+		return m_fence->Fetch() >= m_value;
+	}
+
 	operator bool() {
 		return (bool)m_fence;
 	}
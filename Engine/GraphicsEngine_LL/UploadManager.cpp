@@ -89,10 +89,20 @@ void UploadManager::Upload(
 		throw InvalidArgumentException("Uploaded data does not fit inside target texture. (Uploaded size or offset is too large)", "target");
 	}
 
-	auto pixelSize = gxapi::GetFormatSizeInBytes(format);
-	auto rowSize = width * pixelSize;
+	// Block compressed formats are copied by rows of 4x4 pixel blocks.
+	size_t rowSize;
+	size_t numRows;
+	if (gxapi::IsBlockCompressed(format)) {
+		rowSize = (width + 3) / 4 * gxapi::GetFormatBlockSizeInBytes(format);
+		numRows = (height + 3) / 4;
+	}
+	else {
+		rowSize = width * gxapi::GetFormatSizeInBytes(format);
+		numRows = height;
+	}
 	size_t rowPitch = SnapUpwrads(rowSize, DUP_D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
-	auto requiredSize = bytesPerRow > 0 ? bytesPerRow : rowPitch * height;
+	size_t sourcePitch = bytesPerRow > 0 ? bytesPerRow : rowSize;
+	auto requiredSize = rowPitch * numRows;
 
 	MemoryObjDesc uploadObjDesc = MemoryObjDesc(
 		m_graphicsApi->CreateCommittedResource(
@@ -140,8 +150,8 @@ void UploadManager::Upload(
 	auto stagePtr = reinterpret_cast<uint8_t*>(uploadResource->Map(0, &noReadRange));
 	auto byteData = reinterpret_cast<const uint8_t*>(data);
 	//copy texture row-by-row
-	for (size_t y = 0; y < height; y++) {
-		memcpy(stagePtr + rowPitch*y, byteData + rowSize*y, rowSize);
+	for (size_t y = 0; y < numRows; y++) {
+		memcpy(stagePtr + rowPitch*y, byteData + sourcePitch*y, rowSize);
 	}
 	uploadResource->Unmap(0, nullptr);
 }
@@ -173,6 +183,11 @@ void UploadManager::OnFrameCompleteHost(uint64_t frameId) {
 
 
 void UploadManager::OnFrameBeginAwait(uint64_t frameId) {
+	// Frames are started by BeginFrame on the render thread, events are dispatched asynchronously.
+}
+
+
+void UploadManager::BeginFrame(uint64_t frameId) {
 	std::lock_guard<std::mutex> lock(m_mtx);
 
 	UploadFrame uploadFrame;
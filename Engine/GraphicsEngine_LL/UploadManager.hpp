@@ -63,6 +63,11 @@ public:
 	// The pixels from the source image must be in row-major order inside memory.
 	void Upload(const Texture2D& target, uint32_t offsetX, uint32_t offsetY, uint32_t subresource, const void* data, uint64_t width, uint32_t height, gxapi::eFormat format, size_t bytesPerRow = 0);
 
+	/// <summary> Starts collecting uploads for the frame. </summary>
+	/// <remarks> Must be called on the thread that calls Upload, so that no upload can slip into
+	///		the list of a frame that is already being recorded. </remarks>
+	void BeginFrame(uint64_t frameId);
+
 	void OnFrameBeginDevice(uint64_t frameId) override;
 	void OnFrameBeginHost(uint64_t frameId) override;
 	void OnFrameBeginAwait(uint64_t frameId) override;
@@ -30,6 +30,8 @@ enum class eVertexElementSemantic {
 	COLOR,
 	TANGENT,
 	BITANGENT,
+	BONE_INDICES,
+	BONE_WEIGHTS,
 };
 
 
@@ -73,6 +75,12 @@ using Tangent = VertexElement<eVertexElementSemantic::TANGENT, Index>;
 template <int Index>
 using Bitangent = VertexElement<eVertexElementSemantic::BITANGENT, Index>;
 
+template <int Index>
+using BoneIndices = VertexElement<eVertexElementSemantic::BONE_INDICES, Index>;
+
+template <int Index>
+using BoneWeights = VertexElement<eVertexElementSemantic::BONE_WEIGHTS, Index>;
+
 
 
 
@@ -265,6 +273,8 @@ INL_GXENG_VERTEX_PART(eVertexElementSemantic::TEX_COORD, INL_GXENG_SIMPLE_ARG(Ve
 INL_GXENG_VERTEX_PART(eVertexElementSemantic::COLOR, INL_GXENG_SIMPLE_ARG(Vec3_Packed), GetColor, colors, color)
 INL_GXENG_VERTEX_PART(eVertexElementSemantic::TANGENT, INL_GXENG_SIMPLE_ARG(Vec3_Packed), GetTangent, tangents, tangent)
 INL_GXENG_VERTEX_PART(eVertexElementSemantic::BITANGENT, INL_GXENG_SIMPLE_ARG(Vec3_Packed), GetBitangent, bitangents, bitangent)
+INL_GXENG_VERTEX_PART(eVertexElementSemantic::BONE_INDICES, INL_GXENG_SIMPLE_ARG(Vec4u_Packed), GetBoneIndices, boneIndexLists, boneIndices)
+INL_GXENG_VERTEX_PART(eVertexElementSemantic::BONE_WEIGHTS, INL_GXENG_SIMPLE_ARG(Vec4_Packed), GetBoneWeights, boneWeightLists, boneWeights)
 
 
 
@@ -0,0 +1,122 @@
+#include "Test.hpp"
+#include <GraphicsApi_D3D12/GxapiManager.hpp>
+#include <GraphicsApi_LL/IGraphicsApi.hpp>
+#include <GraphicsEngine_LL/BindlessTextureHeap.hpp>
+#include <GraphicsEngine_LL/ScratchSpacePool.hpp>
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std::literals::string_literals;
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestBindlessTextureHeap : public AutoRegisterTest<TestBindlessTextureHeap> {
+public:
+	TestBindlessTextureHeap() {}
+
+	static std::string Name() {
+		return "Bindless Texture Heap";
+	}
+	virtual int Run() override;
+private:
+	static int a;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+static void TestAssertFunc(bool val, const char* expression) {
+	if (!val) {
+		throw std::runtime_error("Assertion failed while evaluating the following expression:\n"s + expression);
+	}
+}
+
+#define TestAssert(x) TestAssertFunc(x, #x)
+
+
+using namespace inl;
+using namespace inl::gxeng;
+
+
+// Free slots are handed out last released first, so a reused slot is the next one allocated.
+static void TestDeferredReuse(gxapi::IGraphicsApi* graphicsApi) {
+	BindlessTextureHeap heap(graphicsApi);
+	heap.BeginFrame(10);
+
+	// Released slots are not handed out again until the frame completes.
+	uint32_t released = heap.Allocate();
+	heap.Deallocate(released);
+	TestAssert(heap.Allocate() != released);
+	heap.OnFrameCompleteDevice(9);
+	TestAssert(heap.Allocate() != released);
+	heap.OnFrameCompleteDevice(10);
+	TestAssert(heap.Allocate() == released);
+
+	// Updates move to a new slot, the old one is released with the frame.
+	heap.BeginFrame(11);
+	std::unique_ptr<gxapi::IDescriptorHeap> srvs(graphicsApi->CreateDescriptorHeap({ gxapi::eDescriptorHeapType::CBV_SRV_UAV, 1, false }));
+	gxapi::ShaderResourceViewDesc nullDesc;
+	nullDesc.format = gxapi::eFormat::R8G8B8A8_UNORM;
+	nullDesc.dimension = gxapi::eSrvDimension::TEXTURE2D;
+	nullDesc.tex2D.mipLevelClamping = 0;
+	nullDesc.tex2D.mostDetailedMip = 0;
+	nullDesc.tex2D.numMipLevels = 1;
+	nullDesc.tex2D.planeIndex = 0;
+	graphicsApi->CreateShaderResourceView(nullDesc, srvs->At(0));
+	uint32_t updated = heap.Update(released, srvs->At(0));
+	TestAssert(updated != released);
+	TestAssert(heap.Allocate() != released);
+	heap.OnFrameCompleteDevice(11);
+	TestAssert(heap.Allocate() == released);
+}
+
+
+// The shared heap grows past its initial size, and recycled scratch spaces move to the new heap.
+static void TestScratchSpaceGrowth(gxapi::IGraphicsApi* graphicsApi) {
+	BindlessTextureHeap heap(graphicsApi);
+	ScratchSpacePool pool(graphicsApi, gxapi::eDescriptorHeapType::CBV_SRV_UAV);
+	pool.SetBindlessHeap(&heap);
+
+	std::vector<ScratchSpacePtr> scratchSpaces;
+	for (int i = 0; i < 200; ++i) {
+		scratchSpaces.push_back(pool.RequestScratchSpace());
+	}
+	gxapi::IDescriptorHeap* first = scratchSpaces.front()->GetHeap();
+	gxapi::IDescriptorHeap* last = scratchSpaces.back()->GetHeap();
+	TestAssert(first != last);
+
+	scratchSpaces.clear();
+	ScratchSpacePtr recycled = pool.RequestScratchSpace();
+	TestAssert(recycled->GetHeap() == last);
+}
+
+
+int TestBindlessTextureHeap::Run() {
+	using namespace inl;
+
+	try {
+		std::unique_ptr<gxapi::IGxapiManager> gxapiManager(new gxapi_dx12::GxapiManager());
+		std::unique_ptr<gxapi::IGraphicsApi> graphicsApi(gxapiManager->CreateGraphicsApi(0));
+		TestDeferredReuse(graphicsApi.get());
+		TestScratchSpaceGrowth(graphicsApi.get());
+	}
+	catch (std::exception& ex) {
+		cout << ex.what() << endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,264 @@
+#include "Test.hpp"
+#include <AssetLibrary/BlockCompression.hpp>
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+
+using namespace std::literals::string_literals;
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestBlockCompression : public AutoRegisterTest<TestBlockCompression> {
+public:
+	TestBlockCompression() {}
+
+	static std::string Name() {
+		return "Block Compression";
+	}
+	virtual int Run() override;
+private:
+	static int a;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+static void TestAssertFunc(bool val, const char* expression) {
+	if (!val) {
+		throw std::runtime_error("Assertion failed while evaluating the following expression:\n"s + expression);
+	}
+}
+
+#define TestAssert(x) TestAssertFunc(x, #x)
+
+
+using inl::asset::eBlockFormat;
+
+static const eBlockFormat formats[] = { eBlockFormat::BC1, eBlockFormat::BC3, eBlockFormat::BC4, eBlockFormat::BC5, eBlockFormat::BC7 };
+static const char* formatNames[] = { "BC1", "BC3", "BC4", "BC5", "BC7" };
+
+
+// Channels of the pixels the format stores.
+static int GetChannelCount(eBlockFormat format) {
+	return format == eBlockFormat::BC4 ? 1 : format == eBlockFormat::BC5 ? 2 : format == eBlockFormat::BC1 ? 3 : 4;
+}
+
+
+// Smooth gradients with some noise and hard edges, like a typical texture.
+static std::vector<uint8_t> TestImage(size_t width, size_t height) {
+	std::vector<uint8_t> pixels(width * height * 4);
+	for (size_t y = 0; y < height; ++y) {
+		for (size_t x = 0; x < width; ++x) {
+			uint32_t hash = (uint32_t(x) * 2654435761u ^ uint32_t(y) * 40503u) * 2246822519u;
+			int noise = int(hash >> 28) - 8;
+			bool stripe = (x / 37 + y / 23) % 5 == 0;
+			uint8_t* pixel = &pixels[(y * width + x) * 4];
+			pixel[0] = uint8_t(std::min(255, std::max(0, int(x * 255 / width) + noise)));
+			pixel[1] = uint8_t(std::min(255, std::max(0, int(y * 255 / height) + noise)));
+			pixel[2] = stripe ? 230 : uint8_t(128 + 100 * std::sin(x * 0.05) * std::cos(y * 0.03));
+			pixel[3] = uint8_t(std::min(255, std::max(0, int((x + y) * 255 / (width + height)) + noise)));
+		}
+	}
+	return pixels;
+}
+
+
+static double Psnr(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, int channelCount) {
+	double sum = 0.0;
+	size_t count = 0;
+	for (size_t i = 0; i < a.size(); i += 4) {
+		for (int c = 0; c < channelCount; ++c) {
+			double diff = double(a[i + c]) - double(b[i + c]);
+			sum += diff * diff;
+			++count;
+		}
+	}
+	double mse = sum / count;
+	return mse == 0.0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+
+// Flat blocks are reproduced exactly if the format can represent the color.
+// BC7 mode 6 endpoints share their lowest bit between channels, so it may be 1 off.
+static void TestFlat() {
+	using namespace inl::asset;
+
+	const uint8_t color[4] = { 255, 0, 255, 200 };
+	uint8_t pixels[16 * 4];
+	for (int i = 0; i < 16; ++i) {
+		std::copy(color, color + 4, pixels + 4 * i);
+	}
+
+	for (auto format : formats) {
+		uint8_t block[16];
+		uint8_t decoded[16 * 4];
+		int channelCount = GetChannelCount(format);
+		BlockCompressor::CompressBlock(format, pixels, block);
+		BlockCompressor::DecompressBlock(format, block, decoded);
+		for (int i = 0; i < 16; ++i) {
+			for (int c = 0; c < channelCount; ++c) {
+				int tolerance = format == eBlockFormat::BC7 ? 1 : 0;
+				TestAssert(std::abs(decoded[4 * i + c] - color[c]) <= tolerance);
+			}
+		}
+	}
+}
+
+
+// Pixels with alpha below 128 are made transparent in BC1.
+static void TestPunchThrough() {
+	using namespace inl::asset;
+
+	uint8_t pixels[16 * 4];
+	for (int i = 0; i < 16; ++i) {
+		pixels[4 * i + 0] = uint8_t(i * 16);
+		pixels[4 * i + 1] = 128;
+		pixels[4 * i + 2] = 0;
+		pixels[4 * i + 3] = i % 3 == 0 ? 0 : 255;
+	}
+	uint8_t block[8];
+	uint8_t decoded[16 * 4];
+	BlockCompressor::CompressBlock(eBlockFormat::BC1, pixels, block);
+	BlockCompressor::DecompressBlock(eBlockFormat::BC1, block, decoded);
+	for (int i = 0; i < 16; ++i) {
+		TestAssert(decoded[4 * i + 3] == pixels[4 * i + 3]);
+	}
+}
+
+
+// Known blocks, laid out by hand from the format descriptions.
+static void TestDecode() {
+	using namespace inl::asset;
+
+	// BC1: red and blue endpoints, 4 color mode, index i % 4 for each pixel.
+	const uint8_t bc1[8] = { 0x00, 0xF8, 0x1F, 0x00, 0xE4, 0xE4, 0xE4, 0xE4 };
+	uint8_t decoded[16 * 4];
+	BlockCompressor::DecompressBlock(eBlockFormat::BC1, bc1, decoded);
+	TestAssert(decoded[0] == 255 && decoded[2] == 0 && decoded[3] == 255);
+	TestAssert(decoded[4] == 0 && decoded[6] == 255);
+	TestAssert(decoded[8] == 170 && decoded[10] == 85);
+	TestAssert(decoded[12] == 85 && decoded[14] == 170);
+
+	// BC7 mode 6: all endpoint and p bits set, so every pixel is white.
+	const uint8_t bc7[16] = { 0xC0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+	BlockCompressor::DecompressBlock(eBlockFormat::BC7, bc7, decoded);
+	TestAssert(std::all_of(decoded, decoded + 64, [](uint8_t value) { return value == 255; }));
+}
+
+
+static void TestQuality() {
+	using namespace inl::asset;
+
+	// Odd size to hit the partial blocks at the edges.
+	const size_t width = 258, height = 131;
+	const double minPsnr[] = { 37.0, 38.0, 50.0, 50.0, 40.0 };
+
+	for (size_t i = 0; i < std::size(formats); ++i) {
+		// BC1 alpha is 1 bit, measure its colors.
+		auto pixels = TestImage(width, height);
+		if (formats[i] == eBlockFormat::BC1) {
+			for (size_t p = 3; p < pixels.size(); p += 4) {
+				pixels[p] = 255;
+			}
+		}
+		BlockCompressor compressor(formats[i]);
+		auto blocks = compressor.Compress(pixels.data(), 0, width, height, 4);
+		TestAssert(blocks.size() == BlockCompressor::GetCompressedSize(formats[i], width, height));
+
+		std::vector<uint8_t> decoded(pixels.size());
+		compressor.Decompress(blocks.data(), width, height, decoded.data());
+		double psnr = Psnr(pixels, decoded, GetChannelCount(formats[i]));
+		cout << formatNames[i] << " PSNR: " << psnr << " dB" << endl;
+		TestAssert(psnr > minPsnr[i]);
+	}
+}
+
+
+static void TestThreads() {
+	using namespace inl::asset;
+
+	const size_t width = 256, height = 256;
+	const auto pixels = TestImage(width, height);
+	for (auto format : formats) {
+		auto single = BlockCompressor(format, 1).Compress(pixels.data(), 0, width, height, 4);
+		auto multi = BlockCompressor(format, 8).Compress(pixels.data(), 0, width, height, 4);
+		TestAssert(single == multi);
+	}
+}
+
+
+static void TestImageInput() {
+	using namespace inl::asset;
+
+	Image image;
+	image.Create(6, 5, eChannelType::INT8, 3);
+	auto blocks = BlockCompressor(eBlockFormat::BC1).Compress(image);
+	TestAssert(blocks.size() == 2 * 2 * 8);
+
+	bool thrown = false;
+	try {
+		image.Create(4, 4, eChannelType::FLOAT, 1);
+		BlockCompressor(eBlockFormat::BC4).Compress(image);
+	}
+	catch (inl::InvalidArgumentException&) {
+		thrown = true;
+	}
+	TestAssert(thrown);
+}
+
+
+static void Benchmark() {
+	using namespace inl::asset;
+	using Clock = std::chrono::high_resolution_clock;
+
+	const size_t size = 1024;
+	const auto pixels = TestImage(size, size);
+	const double numBlocks = double(size / 4 * (size / 4));
+
+	cout << "Compressing " << size << "x" << size << " RGBA8:" << endl;
+	for (size_t i = 0; i < std::size(formats); ++i) {
+		cout << "   " << formatNames[i] << ":";
+		for (unsigned numThreads : { 1u, 0u }) {
+			BlockCompressor compressor(formats[i], numThreads);
+			auto begin = Clock::now();
+			compressor.Compress(pixels.data(), 0, size, size, 4);
+			double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+			cout << " " << numBlocks / seconds / 1e6 << " Mblocks/s" << (numThreads == 1 ? " on 1 thread," : " on all threads");
+		}
+		cout << endl;
+	}
+}
+
+
+int TestBlockCompression::Run() {
+	try {
+		TestFlat();
+		TestPunchThrough();
+		TestDecode();
+		TestQuality();
+		TestThreads();
+		TestImageInput();
+		Benchmark();
+	}
+	catch (std::exception& ex) {
+		cout << ex.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,190 @@
+#include "Test.hpp"
+#include <GraphicsApi_D3D12/GxapiManager.hpp>
+#include <GraphicsApi_LL/IGraphicsApi.hpp>
+#include <GraphicsEngine_LL/CommandStreamRecorder.hpp>
+#include <GraphicsEngine_LL/CommandStreamPlayer.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std::literals::string_literals;
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestCommandStreamReplay : public AutoRegisterTest<TestCommandStreamReplay> {
+public:
+	TestCommandStreamReplay() {}
+
+	static std::string Name() {
+		return "Command Stream Replay";
+	}
+	virtual int Run() override;
+private:
+	static void CaptureSyntheticFrame(inl::gxapi::IGraphicsApi* graphicsApi, std::ostream& capture);
+	static void TestForgetsDestroyedObjects(inl::gxapi::IGraphicsApi* graphicsApi);
+	static int a;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+static void TestAssertFunc(bool val, const char* expression) {
+	if (!val) {
+		throw std::runtime_error("Assertion failed while evaluating the following expression:\n"s + expression);
+	}
+}
+
+#define TestAssert(x) TestAssertFunc(x, #x)
+
+
+constexpr int NumSyntheticTargets = 16;
+
+
+// Clears a few render targets, so that the round trip can be tested without a capture from the engine.
+void TestCommandStreamReplay::CaptureSyntheticFrame(inl::gxapi::IGraphicsApi* graphicsApi, std::ostream& capture) {
+	using namespace inl;
+
+	gxeng::CommandStreamRecorder recorder(graphicsApi);
+	std::unique_ptr<gxapi::ICommandQueue> queue(recorder.CreateCommandQueue({ gxapi::eCommandListType::GRAPHICS }));
+	std::unique_ptr<gxapi::ICommandAllocator> allocator(recorder.CreateCommandAllocator(gxapi::eCommandListType::GRAPHICS));
+	std::unique_ptr<gxapi::IGraphicsCommandList> list(recorder.CreateGraphicsCommandList({ allocator.get() }));
+	std::unique_ptr<gxapi::IDescriptorHeap> rtvHeap(recorder.CreateDescriptorHeap({ gxapi::eDescriptorHeapType::RTV, NumSyntheticTargets, false }));
+	std::unique_ptr<gxapi::IFence> fence(recorder.CreateFence(0));
+	std::vector<std::unique_ptr<gxapi::IResource>> targets;
+	for (int i = 0; i < NumSyntheticTargets; ++i) {
+		auto desc = gxapi::ResourceDesc::Texture2D(256, 256, gxapi::eFormat::R8G8B8A8_UNORM, gxapi::eResourceFlags::ALLOW_RENDER_TARGET);
+		targets.emplace_back(recorder.CreateCommittedResource(gxapi::HeapProperties{ gxapi::eHeapType::DEFAULT }, gxapi::eHeapFlags::NONE, desc, gxapi::eResourceState::COMMON));
+		recorder.CreateRenderTargetView(targets.back().get(), rtvHeap->At(i));
+	}
+
+	// The list was opened before the capture, it only records once it's reset during the capture.
+	list->Close();
+	recorder.BeginCapture();
+	list->Reset(allocator.get());
+	for (int i = 0; i < NumSyntheticTargets; ++i) {
+		list->ResourceBarrier(gxapi::TransitionBarrier{ targets[i].get(), gxapi::eResourceState::COMMON, gxapi::eResourceState::RENDER_TARGET });
+		list->ClearRenderTarget(rtvHeap->At(i), gxapi::ColorRGBA(i / float(NumSyntheticTargets), 0, 1, 1));
+		list->ResourceBarrier(gxapi::TransitionBarrier{ targets[i].get(), gxapi::eResourceState::RENDER_TARGET, gxapi::eResourceState::COMMON });
+	}
+	list->Close();
+	gxapi::ICommandList* lists[] = { list.get() };
+	queue->ExecuteCommandLists(1, lists);
+	queue->Signal(fence.get(), 1);
+	recorder.EndCapture(capture);
+
+	fence->Wait(1);
+}
+
+
+void TestCommandStreamReplay::TestForgetsDestroyedObjects(inl::gxapi::IGraphicsApi* graphicsApi) {
+	using namespace inl;
+
+	gxeng::CommandStreamRecorder recorder(graphicsApi);
+	size_t numTracked = recorder.GetNumTrackedObjects();
+	for (int i = 0; i < 64; ++i) {
+		std::unique_ptr<gxapi::IResource> buffer(recorder.CreateCommittedResource(gxapi::HeapProperties{ gxapi::eHeapType::UPLOAD },
+																				  gxapi::eHeapFlags::NONE,
+																				  gxapi::ResourceDesc::Buffer(4096),
+																				  gxapi::eResourceState::GENERIC_READ));
+		std::unique_ptr<gxapi::IDescriptorHeap> heap(recorder.CreateDescriptorHeap({ gxapi::eDescriptorHeapType::CBV_SRV_UAV, 16, false }));
+		TestAssert(recorder.GetNumTrackedObjects() == numTracked + 2);
+	}
+	TestAssert(recorder.GetNumTrackedObjects() == numTracked);
+
+	// Objects destroyed during a capture are kept until it ends, the submissions may need them.
+	recorder.BeginCapture();
+	std::unique_ptr<gxapi::IDescriptorHeap> heap(recorder.CreateDescriptorHeap({ gxapi::eDescriptorHeapType::CBV_SRV_UAV, 16, false }));
+	heap.reset();
+	TestAssert(recorder.GetNumTrackedObjects() == numTracked + 1);
+	std::stringstream capture;
+	recorder.EndCapture(capture);
+	TestAssert(recorder.GetNumTrackedObjects() == numTracked);
+}
+
+
+int TestCommandStreamReplay::Run() {
+	using namespace inl;
+
+	std::unique_ptr<gxapi::IGxapiManager> gxapiManager(new gxapi_dx12::GxapiManager());
+	std::unique_ptr<gxapi::IGraphicsApi> graphicsApi(gxapiManager->CreateGraphicsApi(0));
+
+	// A capture from the engine can be benchmarked by pointing INL_CAPTURE_FILE at it.
+	const char* path = std::getenv("INL_CAPTURE_FILE");
+
+	std::unique_ptr<gxeng::CommandStreamPlayer> player;
+	try {
+		TestForgetsDestroyedObjects(graphicsApi.get());
+
+		if (path != nullptr) {
+			std::ifstream file(path, std::ios::binary);
+			if (!file.is_open()) {
+				cout << "Could not open " << path << "." << endl;
+				return 1;
+			}
+			player = std::make_unique<gxeng::CommandStreamPlayer>(file);
+		}
+		else {
+			std::stringstream synthetic;
+			CaptureSyntheticFrame(graphicsApi.get(), synthetic);
+			player = std::make_unique<gxeng::CommandStreamPlayer>(synthetic);
+		}
+		player->Prepare(graphicsApi.get());
+
+		if (path == nullptr) {
+			const auto& statistics = player->GetStatistics();
+			TestAssert(statistics.numSubmissions == 2); // execute and signal
+			TestAssert(statistics.numCommandLists == 1);
+			TestAssert(statistics.numCommands == 3 * NumSyntheticTargets);
+			TestAssert(statistics.numUnsupportedCommands == 0);
+			TestAssert(statistics.numDescriptors == NumSyntheticTargets);
+		}
+	}
+	catch (std::exception& ex) {
+		cout << "Command stream test failed: " << ex.what() << endl;
+		return 1;
+	}
+
+	const auto& statistics = player->GetStatistics();
+	cout << "Objects:          " << statistics.numObjects << endl;
+	cout << "Descriptors:      " << statistics.numDescriptors << endl;
+	cout << "Submissions:      " << statistics.numSubmissions << endl;
+	cout << "Command lists:    " << statistics.numCommandLists << endl;
+	cout << "Commands:         " << statistics.numCommands << " (" << statistics.numUnsupportedCommands << " not replayed)" << endl;
+
+	constexpr int NumReplays = 100;
+	constexpr int NumWarmup = 5;
+	gxeng::CommandStreamReplayTiming total;
+	double bestRecordMs = 1e9;
+	for (int i = 0; i < NumWarmup + NumReplays; ++i) {
+		auto timing = player->Replay();
+		if (i < NumWarmup) {
+			continue;
+		}
+		total.recordMs += timing.recordMs;
+		total.submitMs += timing.submitMs;
+		total.gpuWaitMs += timing.gpuWaitMs;
+		total.numSkippedWaits = timing.numSkippedWaits;
+		bestRecordMs = std::min(bestRecordMs, timing.recordMs);
+	}
+
+	cout << endl << "Average of " << NumReplays << " replays:" << endl;
+	cout << "   record:   " << total.recordMs / NumReplays << " ms (best " << bestRecordMs << " ms)" << endl;
+	cout << "   submit:   " << total.submitMs / NumReplays << " ms" << endl;
+	cout << "   GPU wait: " << total.gpuWaitMs / NumReplays << " ms" << endl;
+	cout << "   skipped waits per replay: " << total.numSkippedWaits << endl;
+
+	return 0;
+}
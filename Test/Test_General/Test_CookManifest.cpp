@@ -0,0 +1,241 @@
+#include "Test.hpp"
+#include "../../Tools/AssetCooker/AssetCooker.hpp"
+#include <AssetLibrary/CookManifest.hpp>
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <string>
+#include <filesystem>
+
+using namespace std::literals::string_literals;
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestCookManifest : public AutoRegisterTest<TestCookManifest> {
+public:
+	TestCookManifest() {}
+
+	static std::string Name() {
+		return "Cook Manifest";
+	}
+	virtual int Run() override;
+private:
+	static int a;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+static void TestAssertFunc(bool val, const char* expression) {
+	if (!val) {
+		throw std::runtime_error("Assertion failed while evaluating the following expression:\n"s + expression);
+	}
+}
+
+#define TestAssert(x) TestAssertFunc(x, #x)
+
+
+using namespace inl;
+using namespace inl::asset;
+namespace fs = std::experimental::filesystem;
+
+
+static void TestRoundTrip(const std::string& path) {
+	CookManifest manifest;
+	manifest.SetCookerVersion(7);
+
+	CookManifest::Asset box;
+	box.sourcePath = "Models/Box.obj";
+	box.cookedPath = "Models/Box.inlmesh";
+	box.inputHash = 0xFEDCBA9876543210ull;
+	box.dependencies = { "Models/Box.mtl", "Textures/crate.png" };
+	manifest.SetAsset(box);
+
+	CookManifest::Asset shader;
+	shader.sourcePath = "shaders/simple_diffuse.mtl.hlsl";
+	shader.cookedPath = "shaders/simple_diffuse.mtl.hlsl";
+	shader.inputHash = 42;
+	manifest.SetAsset(shader);
+
+	CookManifest::FileStamp stamp;
+	stamp.size = 1234;
+	stamp.lastWriteTime = -5;
+	stamp.contentHash = 0x123456789ull;
+	manifest.SetFileStamp("Textures/crate.png", stamp);
+
+	manifest.Save(path);
+	CookManifest loaded(path);
+
+	TestAssert(loaded.GetCookerVersion() == 7);
+	TestAssert(loaded.GetAssets().size() == 2);
+
+	// Paths are looked up case insensitively, in any separator, and keep how they were written.
+	const CookManifest::Asset* found = loaded.FindAsset("models\\BOX.obj");
+	TestAssert(found != nullptr);
+	TestAssert(found->sourcePath == "Models/Box.obj");
+	TestAssert(found->cookedPath == "Models/Box.inlmesh");
+	TestAssert(found->inputHash == box.inputHash);
+	TestAssert(found->dependencies == box.dependencies);
+
+	found = loaded.FindAsset("shaders/simple_diffuse.mtl.hlsl");
+	TestAssert(found != nullptr);
+	TestAssert(found->dependencies.empty());
+	TestAssert(loaded.FindAsset("models/missing.obj") == nullptr);
+
+	const CookManifest::FileStamp* foundStamp = loaded.FindFileStamp("textures/crate.png");
+	TestAssert(foundStamp != nullptr);
+	TestAssert(foundStamp->size == stamp.size);
+	TestAssert(foundStamp->lastWriteTime == stamp.lastWriteTime);
+	TestAssert(foundStamp->contentHash == stamp.contentHash);
+	TestAssert(loaded.FindFileStamp("Models/Box.mtl") == nullptr);
+
+	loaded.RemoveAsset("MODELS/box.obj");
+	TestAssert(loaded.FindAsset("Models/Box.obj") == nullptr);
+	TestAssert(loaded.GetAssets().size() == 1);
+}
+
+
+static void TestCorrupt(const std::string& path) {
+	auto isRejected = [&path](const std::string& contents) {
+		{
+			std::ofstream file(path, std::ios::trunc);
+			file << contents;
+		}
+		try {
+			CookManifest manifest(path);
+		}
+		catch (InvalidArgumentException&) {
+			return true;
+		}
+		return false;
+	};
+
+	TestAssert(!isRejected("inlcook\t1\t3\n"));
+	TestAssert(isRejected(""));
+	TestAssert(isRejected("inlcook\t2\t3\n"));
+	TestAssert(isRejected("inlpack\t1\t3\n"));
+	TestAssert(isRejected("inlcook\t1\t3\nasset\ta.obj\ta.inlmesh\n"));
+	TestAssert(isRejected("inlcook\t1\t3\nasset\ta.obj\ta.inlmesh\tnot a hash\n"));
+	TestAssert(isRejected("inlcook\t1\t3\nfile\ta.png\t12\n"));
+	TestAssert(isRejected("inlcook\t1\t3\nmesh\ta.obj\n"));
+
+	bool thrown = false;
+	try {
+		CookManifest manifest(path + ".missing");
+	}
+	catch (FileNotFoundException&) {
+		thrown = true;
+	}
+	TestAssert(thrown);
+}
+
+
+static void WriteText(const fs::path& path, const std::string& text) {
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file << text;
+	TestAssert(file.good());
+}
+
+
+static std::string ReadText(const fs::path& path) {
+	std::ifstream file(path, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+
+// Edits always change the size, the modification time may be too coarse to tell them apart.
+static void TestRecook(const fs::path& directory) {
+	const fs::path source = directory / "source";
+	const fs::path output = directory / "cooked";
+	fs::create_directories(source);
+
+	WriteText(source / "common.hlsli", "float4 Tint() { return 1; }\n");
+	WriteText(source / "lit.hlsl", "#include \"common.hlsli\"\nfloat4 main() : SV_TARGET { return Tint(); }\n");
+	WriteText(source / "unlit.hlsl", "float4 main() : SV_TARGET { return 1; }\n");
+	WriteText(source / "old.hlsl", "float4 main() : SV_TARGET { return 0; }\n");
+
+	CookSettings settings;
+	settings.sourceDirectory = source.generic_string();
+	settings.outputDirectory = output.generic_string();
+	settings.numThreads = 2;
+
+	CookResult result = AssetCooker(settings).Cook();
+	TestAssert(result.errors.empty());
+	TestAssert(result.numCooked == 3);
+	TestAssert(result.numUpToDate == 0);
+	TestAssert(fs::exists(output / CookManifest::FileName));
+	TestAssert(!fs::exists(output / "common.hlsli"));
+
+	// Nothing changed.
+	result = AssetCooker(settings).Cook();
+	TestAssert(result.errors.empty());
+	TestAssert(result.numCooked == 0);
+	TestAssert(result.numUpToDate == 3);
+
+	// The edited source.
+	WriteText(source / "unlit.hlsl", "float4 main() : SV_TARGET { return 0.5f; }\n");
+	result = AssetCooker(settings).Cook();
+	TestAssert(result.errors.empty());
+	TestAssert(result.numCooked == 1);
+	TestAssert(result.numUpToDate == 2);
+	TestAssert(ReadText(output / "unlit.hlsl") == ReadText(source / "unlit.hlsl"));
+
+	// The source that includes the edited file.
+	WriteText(source / "common.hlsli", "float4 Tint() { return float4(1, 0, 0, 1); }\n");
+	result = AssetCooker(settings).Cook();
+	TestAssert(result.errors.empty());
+	TestAssert(result.numCooked == 1);
+	TestAssert(result.numUpToDate == 2);
+
+	// The output of the deleted source.
+	fs::remove(source / "old.hlsl");
+	result = AssetCooker(settings).Cook();
+	TestAssert(result.errors.empty());
+	TestAssert(result.numCooked == 0);
+	TestAssert(result.numUpToDate == 2);
+	TestAssert(result.numRemoved == 1);
+	TestAssert(!fs::exists(output / "old.hlsl"));
+	TestAssert(fs::exists(output / "lit.hlsl"));
+
+	// Forced cooking ignores the manifest.
+	settings.force = true;
+	result = AssetCooker(settings).Cook();
+	TestAssert(result.numCooked == 2);
+	TestAssert(result.numUpToDate == 0);
+	TestAssert(result.numRemoved == 0);
+}
+
+
+int TestCookManifest::Run() {
+	std::string path = (fs::temp_directory_path() / CookManifest::FileName).generic_string();
+	fs::path directory = fs::temp_directory_path() / "inl_test_cook";
+	try {
+		TestRoundTrip(path);
+		TestCorrupt(path);
+		fs::remove_all(directory);
+		TestRecook(directory);
+	}
+	catch (std::exception& ex) {
+		cout << ex.what() << endl;
+		fs::remove(path);
+		fs::remove_all(directory);
+		return 1;
+	}
+
+	fs::remove(path);
+	fs::remove_all(directory);
+	return 0;
+}
@@ -0,0 +1,153 @@
+#include "Test.hpp"
+#include <AssetLibrary/CookedMesh.hpp>
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <filesystem>
+
+using namespace std::literals::string_literals;
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestCookedMesh : public AutoRegisterTest<TestCookedMesh> {
+public:
+	TestCookedMesh() {}
+
+	static std::string Name() {
+		return "Cooked Mesh";
+	}
+	virtual int Run() override;
+private:
+	static int a;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+static void TestAssertFunc(bool val, const char* expression) {
+	if (!val) {
+		throw std::runtime_error("Assertion failed while evaluating the following expression:\n"s + expression);
+	}
+}
+
+#define TestAssert(x) TestAssertFunc(x, #x)
+
+
+using VertexT = inl::gxeng::Vertex<inl::gxeng::Position<0>, inl::gxeng::Normal<0>, inl::gxeng::TexCoord<0>>;
+
+
+static std::vector<VertexT> MakeVertices(size_t count, float offset) {
+	std::vector<VertexT> vertices(count);
+	for (size_t i = 0; i < count; ++i) {
+		vertices[i].position = { offset + float(i), -float(i), 2.0f * float(i) };
+		vertices[i].normal = { 0.0f, 1.0f, 0.0f };
+		vertices[i].texCoord = { float(i) / count, 0.5f };
+	}
+	return vertices;
+}
+
+
+static void TestRoundTrip(const std::string& path) {
+	using namespace inl::asset;
+
+	// A quad and a triangle.
+	auto quadVertices = MakeVertices(4, 0.0f);
+	auto triangleVertices = MakeVertices(3, 10.0f);
+	std::vector<unsigned> quadIndices = { 0, 1, 2, 0, 2, 3 };
+	std::vector<unsigned> triangleIndices = { 0, 1, 2 };
+
+	CookedMeshData data;
+	data.AddSubmesh(quadVertices.data(), &VertexT::GetReader(), quadVertices.size(), quadIndices.data(), quadIndices.size());
+	data.AddSubmesh(triangleVertices.data(), &VertexT::GetReader(), triangleVertices.size(), triangleIndices.data(), triangleIndices.size(), 3);
+	data.Write(path);
+
+	CookedMesh mesh(path);
+	TestAssert(mesh.GetSubmeshCount() == 2);
+	TestAssert(mesh.GetVertexStride() == data.vertexStride);
+	TestAssert(!mesh.IsIndex32Bit());
+
+	auto elements = mesh.GetElements();
+	TestAssert(elements.size() == 3);
+	for (size_t i = 0; i < elements.size(); ++i) {
+		TestAssert(elements[i].semantic == data.elements[i].semantic);
+		TestAssert(elements[i].index == data.elements[i].index);
+		TestAssert(elements[i].offset == data.elements[i].offset);
+	}
+
+	const CookedSubmesh& triangle = mesh.GetSubmesh(1);
+	TestAssert(triangle.firstVertex == 4 && triangle.numVertices == 3);
+	TestAssert(triangle.firstIndex == 6 && triangle.numIndices == 3);
+	TestAssert(triangle.materialIndex == 3 && mesh.GetSubmesh(0).materialIndex == 0);
+	TestAssert(mesh.GetVertexCount() == 7 && mesh.GetIndexCount() == 9);
+	TestAssert(triangle.boundsMin[0] == 10.0f && triangle.boundsMax[0] == 12.0f);
+	TestAssert(mesh.GetBoundsMin().x == 0.0f && mesh.GetBoundsMax().x == 12.0f);
+	TestAssert(mesh.GetBoundsMin().y == -3.0f && mesh.GetBoundsMax().z == 6.0f);
+
+	// The mapped data is exactly what was cooked.
+	TestAssert(std::memcmp(mesh.GetVertices(0), data.vertices.data(), data.vertices.size()) == 0);
+	const uint16_t* indices = static_cast<const uint16_t*>(mesh.GetIndices(1));
+	TestAssert(indices[0] == 0 && indices[1] == 1 && indices[2] == 2);
+}
+
+
+static void TestCorrupt(const std::string& path) {
+	using namespace inl::asset;
+
+	std::vector<char> bytes;
+	{
+		std::ifstream file(path, std::ios::binary);
+		bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	auto isRejected = [&path](const std::vector<char>& fileBytes) {
+		{
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			file.write(fileBytes.data(), fileBytes.size());
+		}
+		try {
+			CookedMesh mesh(path);
+		}
+		catch (inl::InvalidArgumentException&) {
+			return true;
+		}
+		return false;
+	};
+
+	auto truncated = bytes;
+	truncated.resize(truncated.size() - 4);
+	TestAssert(isRejected(truncated));
+
+	auto badMagic = bytes;
+	badMagic[0] = 'X';
+	TestAssert(isRejected(badMagic));
+}
+
+
+int TestCookedMesh::Run() {
+	std::string path = (std::experimental::filesystem::temp_directory_path() / "test_cooked_mesh.inlmesh").generic_string();
+	try {
+		TestRoundTrip(path);
+		TestCorrupt(path);
+	}
+	catch (std::exception& ex) {
+		cout << ex.what() << endl;
+		std::experimental::filesystem::remove(path);
+		return 1;
+	}
+
+	std::experimental::filesystem::remove(path);
+	return 0;
+}
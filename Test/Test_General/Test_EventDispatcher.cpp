@@ -0,0 +1,180 @@
+#include "Test.hpp"
+#include <GraphicsEngine_LL/PipelineEventDispatcher.hpp>
+#include <GraphicsEngine_LL/LightweightEventDispatcher.hpp>
+#include <GraphicsApi_D3D12/GxapiManager.hpp>
+#include <GraphicsApi_LL/IGraphicsApi.hpp>
+#include <GraphicsApi_LL/IFence.hpp>
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <memory>
+
+using std::cout;
+using std::endl;
+
+using namespace inl;
+using namespace inl::gxeng;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestEventDispatcher : public AutoRegisterTest<TestEventDispatcher> {
+public:
+	TestEventDispatcher() {}
+
+	static std::string Name() {
+		return "Event Dispatcher";
+	}
+	virtual int Run() override;
+private:
+	static int a;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+using Clock = std::chrono::high_resolution_clock;
+
+
+class TimingListener : public PipelineEventListener {
+public:
+	explicit TimingListener(size_t numEvents) : received(numEvents) {}
+
+	void OnFrameBeginDevice(uint64_t frameId) override {}
+	void OnFrameBeginHost(uint64_t frameId) override { received[frameId] = Clock::now(); }
+	void OnFrameBeginAwait(uint64_t frameId) override {}
+	void OnFrameCompleteDevice(uint64_t frameId) override {}
+	void OnFrameCompleteHost(uint64_t frameId) override {}
+
+	std::vector<Clock::time_point> received;
+};
+
+
+class DeviceFrameListener : public PipelineEventListener {
+public:
+	void OnFrameBeginDevice(uint64_t frameId) override {}
+	void OnFrameBeginHost(uint64_t frameId) override {}
+	void OnFrameBeginAwait(uint64_t frameId) override {}
+	void OnFrameCompleteDevice(uint64_t frameId) override { ++numCompleted; }
+	void OnFrameCompleteHost(uint64_t frameId) override {}
+
+	int numCompleted = 0;
+};
+
+
+static void PrintLatency(const char* name, const std::vector<Clock::time_point>& sent, const std::vector<Clock::time_point>& received) {
+	std::vector<double> latencies;
+	for (size_t i = 0; i < sent.size(); ++i) {
+		latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(received[i] - sent[i]).count() / 1000.0);
+	}
+	std::sort(latencies.begin(), latencies.end());
+	double mean = 0;
+	for (auto l : latencies) {
+		mean += l;
+	}
+	mean /= latencies.size();
+
+	cout << "  " << name << ": mean = " << mean << " us"
+		<< ", median = " << latencies[latencies.size() / 2] << " us"
+		<< ", p99 = " << latencies[latencies.size() * 99 / 100] << " us" << endl;
+}
+
+
+int TestEventDispatcher::Run() {
+	constexpr size_t NumEvents = 20'000;
+
+	// Latency: time from dispatching an event until the listener is called, one event at a time.
+	cout << "Latency (" << NumEvents << " events, waiting for each):" << endl;
+	{
+		TimingListener listener(NumEvents);
+		std::vector<Clock::time_point> sent(NumEvents);
+		PipelineEventDispatcher dispatcher;
+		dispatcher += &listener;
+		for (size_t i = 0; i < NumEvents; ++i) {
+			sent[i] = Clock::now();
+			dispatcher.DispatchFrameBegin(i).wait();
+		}
+		PrintLatency("PipelineEventDispatcher   ", sent, listener.received);
+	}
+	{
+		TimingListener listener(NumEvents);
+		std::vector<Clock::time_point> sent(NumEvents);
+		LightweightEventDispatcher dispatcher;
+		dispatcher += &listener;
+		for (size_t i = 0; i < NumEvents; ++i) {
+			sent[i] = Clock::now();
+			dispatcher.WaitEpoch(dispatcher.DispatchFrameBegin(i));
+		}
+		PrintLatency("LightweightEventDispatcher", sent, listener.received);
+	}
+
+	// Throughput: cost of dispatching on the caller's thread when nobody waits.
+	cout << "Dispatch cost (" << NumEvents << " events, waiting for the last):" << endl;
+	{
+		TimingListener listener(NumEvents);
+		PipelineEventDispatcher dispatcher;
+		dispatcher += &listener;
+		std::future<void> last;
+		auto startTime = Clock::now();
+		for (size_t i = 0; i < NumEvents; ++i) {
+			last = dispatcher.DispatchFrameBegin(i);
+		}
+		auto dispatchTime = Clock::now();
+		last.wait();
+		auto endTime = Clock::now();
+		cout << "  PipelineEventDispatcher   : "
+			<< std::chrono::duration_cast<std::chrono::nanoseconds>(dispatchTime - startTime).count() / double(NumEvents) << " ns per dispatch, "
+			<< std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count() / 1000.0 << " ms total" << endl;
+	}
+	{
+		TimingListener listener(NumEvents);
+		LightweightEventDispatcher dispatcher;
+		dispatcher += &listener;
+		uint64_t last = 0;
+		auto startTime = Clock::now();
+		for (size_t i = 0; i < NumEvents; ++i) {
+			last = dispatcher.DispatchFrameBegin(i);
+		}
+		auto dispatchTime = Clock::now();
+		dispatcher.WaitEpoch(last);
+		auto endTime = Clock::now();
+		cout << "  LightweightEventDispatcher: "
+			<< std::chrono::duration_cast<std::chrono::nanoseconds>(dispatchTime - startTime).count() / double(NumEvents) << " ns per dispatch, "
+			<< std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count() / 1000.0 << " ms total" << endl;
+
+		if (dispatcher.GetEpoch() != NumEvents) {
+			cout << "Epoch mismatch!" << endl;
+			return 1;
+		}
+	}
+
+	// The last epoch covers device events too, so owners can drain the dispatcher before destroying listeners.
+	{
+		std::unique_ptr<gxapi::IGxapiManager> gxapiManager(new gxapi_dx12::GxapiManager());
+		std::unique_ptr<gxapi::IGraphicsApi> graphicsApi(gxapiManager->CreateGraphicsApi(0));
+		std::shared_ptr<gxapi::IFence> fence(graphicsApi->CreateFence(1));
+
+		DeviceFrameListener listener;
+		LightweightEventDispatcher dispatcher;
+		dispatcher += &listener;
+		dispatcher.DispatchFrameBegin(0);
+		dispatcher.DispatchDeviceFrameEnd(SyncPoint(fence, 1), 0);
+		dispatcher.DispatchFrameEnd(0);
+		dispatcher.WaitEpoch(dispatcher.GetLastEpoch());
+		dispatcher -= &listener;
+
+		if (dispatcher.GetLastEpoch() != 3 || listener.numCompleted != 1) {
+			cout << "Device event not delivered by the last epoch!" << endl;
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,108 @@
+#include "Test.hpp"
+#include <GraphicsApi_D3D12/GxapiManager.hpp>
+#include <GraphicsApi_LL/IGraphicsApi.hpp>
+#include <GraphicsEngine_LL/HostDescHeap.hpp>
+#include <thread>
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <unordered_set>
+#include <algorithm>
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestHostDescHeap : public AutoRegisterTest<TestHostDescHeap> {
+public:
+	TestHostDescHeap() {}
+
+	static std::string Name() {
+		return "Host Desc Heap";
+	}
+	virtual int Run() override;
+private:
+	static int a;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestHostDescHeap::Run() {
+	using namespace inl;
+
+	std::unique_ptr<gxapi::IGxapiManager> gxapiManager(new gxapi_dx12::GxapiManager());
+	std::unique_ptr<gxapi::IGraphicsApi> graphicsApi(gxapiManager->CreateGraphicsApi(0));
+
+	constexpr int NumAllocsPerThread = 10'000;
+	constexpr int NumCycles = 20;
+	const int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	cout << "Benchmark (allocate and free " << NumAllocsPerThread << " descriptors " << NumCycles << " times per thread):" << endl;
+	for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+		gxeng::CbvSrvUavHeap heap(graphicsApi.get());
+		std::vector<std::vector<size_t>> allocations(numThreads);
+		std::atomic_int startFlag{ 0 };
+
+		std::vector<std::thread> threads;
+		for (int t = 0; t < numThreads; ++t) {
+			threads.emplace_back([&, t] {
+				auto& mine = allocations[t];
+				mine.reserve(NumAllocsPerThread);
+				while (startFlag == 0);
+
+				for (int cycle = 0; cycle < NumCycles; ++cycle) {
+					for (int i = 0; i < NumAllocsPerThread; ++i) {
+						size_t pos = heap.Allocate();
+						heap.At(pos);
+						mine.push_back(pos);
+					}
+					// keep the last cycle's allocations for the consistency check
+					if (cycle + 1 < NumCycles) {
+						for (auto pos : mine) {
+							heap.Deallocate(pos);
+						}
+						mine.clear();
+					}
+				}
+			});
+		}
+
+		auto startTime = std::chrono::high_resolution_clock::now();
+		startFlag = 1;
+		for (auto& thread : threads) {
+			thread.join();
+		}
+		auto endTime = std::chrono::high_resolution_clock::now();
+
+		// every live allocation must be unique
+		std::unordered_set<size_t> unique;
+		size_t total = 0;
+		for (auto& v : allocations) {
+			unique.insert(v.begin(), v.end());
+			total += v.size();
+		}
+
+		double elapsedMs = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count() / 1e6;
+		double numOps = 2.0 * numThreads * NumAllocsPerThread * NumCycles;
+		cout << "  threads = " << numThreads
+			<< ", time = " << elapsedMs << " ms"
+			<< ", " << numOps / elapsedMs / 1000.0 << " Mop/s"
+			<< (unique.size() == total ? "" : ", DUPLICATE ALLOCATIONS!") << endl;
+
+		if (unique.size() != total) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,287 @@
+#include "Test.hpp"
+#include <AssetLibrary/ImageResampler.hpp>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+using namespace std::literals::string_literals;
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestImageResampler : public AutoRegisterTest<TestImageResampler> {
+public:
+	TestImageResampler() {}
+
+	static std::string Name() {
+		return "Image Resampler";
+	}
+	virtual int Run() override;
+private:
+	static int a;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+static void TestAssertFunc(bool val, const char* expression) {
+	if (!val) {
+		throw std::runtime_error("Assertion failed while evaluating the following expression:\n"s + expression);
+	}
+}
+
+#define TestAssert(x) TestAssertFunc(x, #x)
+
+
+static bool Near(float a, float b, float tolerance = 1e-5f) {
+	return std::abs(a - b) <= tolerance;
+}
+
+
+static void TestBox() {
+	using namespace inl::asset;
+
+	ResampleDesc desc;
+	desc.filter = eResampleFilter::BOX;
+	ImageResampler resampler(desc);
+
+	FloatImage image(4, 2, 1);
+	image.pixels = { 1, 2, 3, 4,
+					 5, 6, 7, 8 };
+	FloatImage half = resampler.Resize(image, 2, 1);
+	TestAssert(half.width == 2 && half.height == 1);
+	TestAssert(Near(half.pixels[0], 3.5f) && Near(half.pixels[1], 5.5f));
+}
+
+
+// Weights sum to one, so flat images stay flat, also at the edges and with odd scales.
+static void TestFlat() {
+	using namespace inl::asset;
+
+	for (auto filter : { eResampleFilter::BOX, eResampleFilter::KAISER, eResampleFilter::LANCZOS }) {
+		for (int channelCount : { 3, 4 }) {
+			ResampleDesc desc;
+			desc.filter = filter;
+			ImageResampler resampler(desc);
+
+			FloatImage image(13, 7, channelCount);
+			std::fill(image.pixels.begin(), image.pixels.end(), 0.25f);
+			for (auto size : { std::make_pair(5, 3), std::make_pair(29, 17), std::make_pair(1, 1) }) {
+				FloatImage resized = resampler.Resize(image, size.first, size.second);
+				TestAssert(resized.pixels.size() == size_t(size.first * size.second * channelCount));
+				for (float value : resized.pixels) {
+					TestAssert(Near(value, 0.25f));
+				}
+			}
+		}
+	}
+}
+
+
+static void TestSrgb() {
+	using namespace inl::asset;
+
+	// Black and white averages to 50% linear intensity, which is 188 in sRGB, not 128.
+	const uint8_t pixels[2] = { 0, 255 };
+	uint8_t result = 0;
+	for (bool srgb : { false, true }) {
+		ResampleDesc desc;
+		desc.filter = eResampleFilter::BOX;
+		desc.srgb = srgb;
+		ImageResampler resampler(desc);
+		FloatImage image = resampler.Decode(pixels, 2, 2, 1, eChannelType::INT8, 1);
+		resampler.Encode(resampler.Resize(image, 1, 1), &result, 1, eChannelType::INT8);
+		TestAssert(result == (srgb ? 188 : 128));
+	}
+
+	// Alpha is not sRGB encoded.
+	ResampleDesc desc;
+	desc.srgb = true;
+	ImageResampler resampler(desc);
+	const uint8_t pixel[4] = { 128, 128, 128, 128 };
+	FloatImage image = resampler.Decode(pixel, 4, 1, 1, eChannelType::INT8, 4);
+	TestAssert(image.pixels[0] < 0.25f && Near(image.pixels[3], 128 / 255.0f));
+	uint8_t encoded[4];
+	resampler.Encode(image, encoded, 4, eChannelType::INT8);
+	TestAssert(std::equal(encoded, encoded + 4, pixel));
+}
+
+
+static void TestMipChain() {
+	using namespace inl::asset;
+
+	ImageResampler resampler;
+	FloatImage image(13, 5, 2);
+	auto levels = resampler.GenerateMipChain(image);
+	TestAssert(levels.size() == 3);
+	TestAssert(levels[0].width == 6 && levels[0].height == 2);
+	TestAssert(levels[1].width == 3 && levels[1].height == 1);
+	TestAssert(levels[2].width == 1 && levels[2].height == 1);
+}
+
+
+static void TestThreads() {
+	using namespace inl::asset;
+
+	FloatImage image(512, 384, 4);
+	for (size_t i = 0; i < image.pixels.size(); ++i) {
+		image.pixels[i] = float(i * 7919 % 1000) / 1000.0f;
+	}
+
+	ResampleDesc desc;
+	desc.numThreads = 1;
+	FloatImage single = ImageResampler(desc).Resize(image, 300, 200);
+	desc.numThreads = 8;
+	FloatImage multi = ImageResampler(desc).Resize(image, 300, 200);
+	TestAssert(single.pixels == multi.pixels);
+}
+
+
+// Sparse alpha tested pixels fade out in the mips unless coverage is preserved.
+static void TestAlphaCoverage() {
+	using namespace inl::asset;
+
+	FloatImage image(256, 256, 4);
+	for (size_t y = 0; y < image.height; ++y) {
+		for (size_t x = 0; x < image.width; ++x) {
+			uint32_t hash = (uint32_t(x) * 2654435761u ^ uint32_t(y) * 40503u) * 2246822519u;
+			image.Row(y)[x * 4 + 3] = (hash >> 16) % 100 < 30 ? 1.0f : 0.0f;
+		}
+	}
+
+	ResampleDesc desc;
+	desc.alphaCoverageReference = 0.5f;
+	const float baseCoverage = ImageResampler::GetAlphaCoverage(image, 3, 0.5f);
+	auto preserved = ImageResampler(desc).GenerateMipChain(image);
+	desc.alphaCoverageReference = 0.0f;
+	auto plain = ImageResampler(desc).GenerateMipChain(image);
+
+	for (size_t i = 0; i < preserved.size() && preserved[i].width >= 8; ++i) {
+		float coverage = ImageResampler::GetAlphaCoverage(preserved[i], 3, 0.5f);
+		float plainCoverage = ImageResampler::GetAlphaCoverage(plain[i], 3, 0.5f);
+		TestAssert(std::abs(coverage - baseCoverage) < 0.02f);
+		TestAssert(baseCoverage - plainCoverage > 0.1f);
+	}
+	cout << "Alpha coverage " << baseCoverage << ", level 2 has " << ImageResampler::GetAlphaCoverage(preserved[1], 3, 0.5f)
+		<< " preserved, " << ImageResampler::GetAlphaCoverage(plain[1], 3, 0.5f) << " without." << endl;
+}
+
+
+// Box filtered mip chain the way it could be done before, one pixel at a time through Image::At.
+static std::vector<inl::asset::Image> GenerateMipChainPerPixel(inl::asset::Image& base) {
+	using namespace inl::asset;
+	using PixelT = Pixel<eChannelType::INT8, 4>;
+
+	std::vector<Image> levels;
+	Image* previous = &base;
+	while (previous->GetWidth() > 1 || previous->GetHeight() > 1) {
+		size_t width = std::max<size_t>(1, previous->GetWidth() / 2);
+		size_t height = std::max<size_t>(1, previous->GetHeight() / 2);
+		Image level;
+		level.Create(width, height, eChannelType::INT8, 4);
+		for (size_t y = 0; y < height; ++y) {
+			for (size_t x = 0; x < width; ++x) {
+				size_t x1 = std::min(2 * x + 1, previous->GetWidth() - 1);
+				size_t y1 = std::min(2 * y + 1, previous->GetHeight() - 1);
+				const PixelT* quad[4] = {
+					&previous->At<eChannelType::INT8, 4>(2 * x, 2 * y),
+					&previous->At<eChannelType::INT8, 4>(x1, 2 * y),
+					&previous->At<eChannelType::INT8, 4>(2 * x, y1),
+					&previous->At<eChannelType::INT8, 4>(x1, y1),
+				};
+				PixelT& pixel = level.At<eChannelType::INT8, 4>(x, y);
+				for (int c = 0; c < 4; ++c) {
+					pixel[c] = uint8_t(((*quad[0])[c] + (*quad[1])[c] + (*quad[2])[c] + (*quad[3])[c] + 2) / 4);
+				}
+			}
+		}
+		levels.push_back(std::move(level));
+		previous = &levels.back();
+	}
+	return levels;
+}
+
+
+static void Benchmark() {
+	using namespace inl::asset;
+	using Clock = std::chrono::high_resolution_clock;
+
+	const size_t size = 2048;
+	Image image;
+	image.Create(size, size, eChannelType::INT8, 4);
+	for (size_t y = 0; y < size; ++y) {
+		for (size_t x = 0; x < size; ++x) {
+			auto& pixel = image.At<eChannelType::INT8, 4>(x, y);
+			pixel[0] = uint8_t(x);
+			pixel[1] = uint8_t(y);
+			pixel[2] = uint8_t(x ^ y);
+			pixel[3] = uint8_t(x * y);
+		}
+	}
+
+	auto measure = [](auto generate) {
+		auto begin = Clock::now();
+		size_t numLevels = generate().size();
+		double ms = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+		TestAssert(numLevels == 11);
+		return ms;
+	};
+
+	cout << "Mip chain of " << size << "x" << size << " RGBA8:" << endl;
+	double perPixelMs = measure([&] { return GenerateMipChainPerPixel(image); });
+	cout << "   At<>() box: " << perPixelMs << " ms" << endl;
+
+	struct {
+		const char* name;
+		eResampleFilter filter;
+		bool srgb;
+		unsigned numThreads;
+	} configs[] = {
+		{ "box, 1 thread", eResampleFilter::BOX, false, 1 },
+		{ "box", eResampleFilter::BOX, false, 0 },
+		{ "box sRGB", eResampleFilter::BOX, true, 0 },
+		{ "Kaiser, 1 thread", eResampleFilter::KAISER, false, 1 },
+		{ "Kaiser", eResampleFilter::KAISER, false, 0 },
+		{ "Lanczos sRGB", eResampleFilter::LANCZOS, true, 0 },
+	};
+	for (auto& config : configs) {
+		ResampleDesc desc;
+		desc.filter = config.filter;
+		desc.srgb = config.srgb;
+		desc.numThreads = config.numThreads;
+		ImageResampler resampler(desc);
+		double ms = measure([&] { return resampler.GenerateMipChain(image); });
+		cout << "   " << config.name << ": " << ms << " ms" << endl;
+	}
+}
+
+
+int TestImageResampler::Run() {
+	try {
+		TestBox();
+		TestFlat();
+		TestSrgb();
+		TestMipChain();
+		TestThreads();
+		TestAlphaCoverage();
+		Benchmark();
+	}
+	catch (std::exception& ex) {
+		cout << ex.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,272 @@
+#include "Test.hpp"
+#include <AssetLibrary/Model.hpp>
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <memory>
+
+using namespace std::literals::string_literals;
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestModelVertices : public AutoRegisterTest<TestModelVertices> {
+public:
+	TestModelVertices() {}
+
+	static std::string Name() {
+		return "Model Vertices";
+	}
+	virtual int Run() override;
+private:
+	static int a;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+static void TestAssertFunc(bool val, const char* expression) {
+	if (!val) {
+		throw std::runtime_error("Assertion failed while evaluating the following expression:\n"s + expression);
+	}
+}
+
+#define TestAssert(x) TestAssertFunc(x, #x)
+
+
+using namespace inl;
+using VertexT = gxeng::Vertex<gxeng::Position<0>, gxeng::Normal<0>, gxeng::TexCoord<0>>;
+
+
+// A model built in memory instead of being imported by assimp.
+class SyntheticModel : public asset::Model {
+public:
+	// With faces, each submesh is a fan of triangles around its first vertex, and uses the material of its reverse index.
+	SyntheticModel(const std::vector<unsigned>& submeshSizes, bool withFaces = false) {
+		m_ownedScene.reset(new aiScene());
+		m_ownedScene->mNumMeshes = (unsigned)submeshSizes.size();
+		m_ownedScene->mMeshes = new aiMesh*[submeshSizes.size()];
+		for (size_t submeshID = 0; submeshID < submeshSizes.size(); ++submeshID) {
+			unsigned numVertices = submeshSizes[submeshID];
+			aiMesh* mesh = new aiMesh();
+			mesh->mNumVertices = numVertices;
+			mesh->mVertices = new aiVector3D[numVertices];
+			mesh->mNormals = new aiVector3D[numVertices];
+			mesh->mTextureCoords[0] = new aiVector3D[numVertices];
+			mesh->mNumUVComponents[0] = 2;
+			for (unsigned i = 0; i < numVertices; ++i) {
+				float t = float(i) / numVertices;
+				mesh->mVertices[i] = aiVector3D(std::sin(t * 40.0f) * 5.0f, t * 10.0f, std::cos(t * 40.0f) * 5.0f + float(submeshID));
+				mesh->mNormals[i] = aiVector3D(std::sin(t * 40.0f), 0.0f, std::cos(t * 40.0f));
+				mesh->mTextureCoords[0][i] = aiVector3D(t, 1.0f - t, 0.0f);
+			}
+			if (withFaces && numVertices >= 3) {
+				mesh->mNumFaces = numVertices - 2;
+				mesh->mFaces = new aiFace[mesh->mNumFaces];
+				for (unsigned i = 0; i < mesh->mNumFaces; ++i) {
+					mesh->mFaces[i].mNumIndices = 3;
+					mesh->mFaces[i].mIndices = new unsigned[3]{ 0, i + 1, i + 2 };
+				}
+			}
+			mesh->mMaterialIndex = unsigned(submeshSizes.size() - 1 - submeshID);
+			m_ownedScene->mMeshes[submeshID] = mesh;
+		}
+		m_scene = m_ownedScene.get();
+
+		// Rotation around Z, non-uniform scale and translation.
+		m_transform = Mat44{
+			0.0f, 2.0f, 0.0f, 0.0f,
+			-1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 3.0f, 0.0f,
+			4.0f, 5.0f, 6.0f, 1.0f
+		};
+		m_invTrTransform = m_transform.Inverse().Transpose();
+	}
+
+	// The vertex extraction as it was before batching: per vertex with full matrix products.
+	std::vector<VertexT> GetVerticesReference(unsigned submeshID, asset::CoordSysLayout csys) const {
+		auto xAxis = asset::GetAxis(csys.x);
+		auto yAxis = asset::GetAxis(csys.y);
+		auto zAxis = asset::GetAxis(csys.z);
+		const Mat44 posTransform =
+			m_transform *
+			Mat44(xAxis.x, yAxis.x, zAxis.x, 0,
+				  xAxis.y, yAxis.y, zAxis.y, 0,
+				  xAxis.z, yAxis.z, zAxis.z, 0,
+				  0, 0, 0, 1);
+		const Mat44 normalTransform = posTransform.Inverse().Transpose();
+
+		const aiMesh* mesh = m_scene->mMeshes[submeshID];
+		std::vector<VertexT> result;
+		for (unsigned i = 0; i < mesh->mNumVertices; ++i) {
+			const aiVector3D& pos = mesh->mVertices[i];
+			const aiVector3D& normal = mesh->mNormals[i];
+			const aiVector3D& texCoord = mesh->mTextureCoords[0][i];
+			VertexT vertex;
+			vertex.position = (posTransform * Vec4(pos.x, pos.y, pos.z, 1)).xyz;
+			vertex.normal = normalTransform * Vec3(normal.x, normal.y, normal.z);
+			vertex.texCoord = Vec2_Packed(texCoord.x, texCoord.y);
+			result.push_back(vertex);
+		}
+		return result;
+	}
+private:
+	std::unique_ptr<aiScene> m_ownedScene;
+};
+
+
+static bool IsClose(const VertexT& lhs, const VertexT& rhs) {
+	auto close = [](float a, float b) { return std::abs(a - b) <= 1e-4f * std::max(1.0f, std::abs(b)); };
+	return close(lhs.position.x, rhs.position.x) && close(lhs.position.y, rhs.position.y) && close(lhs.position.z, rhs.position.z)
+		&& close(lhs.normal.x, rhs.normal.x) && close(lhs.normal.y, rhs.normal.y) && close(lhs.normal.z, rhs.normal.z)
+		&& lhs.texCoord.x == rhs.texCoord.x && lhs.texCoord.y == rhs.texCoord.y;
+}
+
+
+static bool IsEqual(const VertexT& lhs, const VertexT& rhs) {
+	return lhs.position == rhs.position && lhs.normal == rhs.normal && lhs.texCoord == rhs.texCoord;
+}
+
+
+static const asset::CoordSysLayout coordSysLayout = { asset::AxisDir::POS_X, asset::AxisDir::NEG_Z, asset::AxisDir::NEG_Y };
+
+
+static void TestReference() {
+	// Sizes not divisible by 4 to hit the remainder of the SIMD loop.
+	SyntheticModel model({ 1, 7, 1002 });
+	for (unsigned submeshID = 0; submeshID < model.SubmeshCount(); ++submeshID) {
+		auto vertices = model.GetVertices<gxeng::Position<0>, gxeng::Normal<0>, gxeng::TexCoord<0>>(submeshID, coordSysLayout);
+		auto reference = model.GetVerticesReference(submeshID, coordSysLayout);
+		TestAssert(vertices.size() == reference.size());
+		for (size_t i = 0; i < vertices.size(); ++i) {
+			TestAssert(IsClose(vertices[i], reference[i]));
+		}
+	}
+}
+
+
+static void TestAllSubmeshes() {
+	SyntheticModel model({ 100000, 3, 250001 });
+	TestAssert(model.GetVertexCount() == 350004);
+
+	std::vector<VertexT> all(model.GetVertexCount());
+	model.GetAllVertices(all.data(), coordSysLayout, 8);
+
+	size_t offset = 0;
+	for (unsigned submeshID = 0; submeshID < model.SubmeshCount(); ++submeshID) {
+		std::vector<VertexT> single(model.GetVertexCount(submeshID));
+		model.GetVertices(submeshID, single.data(), coordSysLayout, 1);
+		for (size_t i = 0; i < single.size(); ++i) {
+			TestAssert(IsEqual(single[i], all[offset + i]));
+		}
+		offset += single.size();
+	}
+}
+
+
+static void TestSubmeshTable() {
+	SyntheticModel model({ 5, 3, 2, 4 }, true);
+	std::vector<VertexT> vertices = model.GetAllVertices<gxeng::Position<0>, gxeng::Normal<0>, gxeng::TexCoord<0>>(coordSysLayout);
+	std::vector<unsigned> indices = { 7, 7, 7 }; // Indices are appended.
+	auto submeshes = model.GetSubmeshTable(vertices.data(), indices);
+
+	const unsigned firstIndices[] = { 3, 12, 15, 15 };
+	const unsigned numIndices[] = { 9, 3, 0, 6 };
+	const int baseVertices[] = { 0, 5, 8, 10 };
+	TestAssert(submeshes.size() == 4);
+	TestAssert(indices.size() == 21);
+	for (unsigned submeshID = 0; submeshID < 4; ++submeshID) {
+		const auto& submesh = submeshes[submeshID];
+		TestAssert(submesh.firstIndex == firstIndices[submeshID]);
+		TestAssert(submesh.numIndices == numIndices[submeshID]);
+		TestAssert(submesh.baseVertex == baseVertices[submeshID]);
+		TestAssert(submesh.materialSlot == 3 - submeshID);
+
+		// Indices stay relative to the submesh, the base vertex makes them point at its vertices.
+		const size_t numVertices = model.GetVertexCount(submeshID);
+		TestAssert(std::vector<unsigned>(indices.begin() + submesh.firstIndex, indices.begin() + submesh.firstIndex + submesh.numIndices) == model.GetIndices(submeshID));
+		for (unsigned i = 0; i < submesh.numIndices; ++i) {
+			TestAssert(indices[submesh.firstIndex + i] < numVertices);
+		}
+
+		// Bounds are those of the positions of the submesh.
+		for (int c = 0; c < 3; ++c) {
+			float min = vertices[submesh.baseVertex].position[c];
+			float max = min;
+			for (size_t i = 0; i < numVertices; ++i) {
+				min = std::min(min, vertices[submesh.baseVertex + i].position[c]);
+				max = std::max(max, vertices[submesh.baseVertex + i].position[c]);
+			}
+			TestAssert(submesh.boundsMin[c] == min);
+			TestAssert(submesh.boundsMax[c] == max);
+		}
+	}
+}
+
+
+static void TestMissingAttribute() {
+	SyntheticModel model({ 10 });
+	bool thrown = false;
+	try {
+		model.GetAllVertices<gxeng::Position<0>, gxeng::Tangent<0>>();
+	}
+	catch (InvalidCallException&) {
+		thrown = true;
+	}
+	TestAssert(thrown);
+}
+
+
+static void Benchmark() {
+	using Clock = std::chrono::high_resolution_clock;
+
+	SyntheticModel model({ 2000000, 1000000, 500000, 500000 });
+	const double numVertices = double(model.GetVertexCount());
+	std::vector<VertexT> output(model.GetVertexCount());
+
+	cout << "Extracting " << numVertices / 1e6 << "M vertices:" << endl;
+	{
+		auto begin = Clock::now();
+		for (unsigned submeshID = 0; submeshID < model.SubmeshCount(); ++submeshID) {
+			model.GetVerticesReference(submeshID, coordSysLayout);
+		}
+		double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+		cout << "   per vertex: " << numVertices / seconds / 1e6 << " Mvertices/s" << endl;
+	}
+	for (unsigned numThreads : { 1u, 0u }) {
+		auto begin = Clock::now();
+		model.GetAllVertices(output.data(), coordSysLayout, numThreads);
+		double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+		cout << "   batched" << (numThreads == 1 ? ", 1 thread: " : ", all threads: ") << numVertices / seconds / 1e6 << " Mvertices/s" << endl;
+	}
+}
+
+
+int TestModelVertices::Run() {
+	try {
+		TestReference();
+		TestAllSubmeshes();
+		TestSubmeshTable();
+		TestMissingAttribute();
+		Benchmark();
+	}
+	catch (std::exception& ex) {
+		cout << ex.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
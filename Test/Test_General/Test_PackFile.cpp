@@ -0,0 +1,279 @@
+#include "Test.hpp"
+#include <BaseLibrary/FileSystem/Lz4.hpp>
+#include <BaseLibrary/FileSystem/PackFile.hpp>
+#include <BaseLibrary/FileSystem/VirtualFileSystem.hpp>
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <random>
+#include <cstring>
+#include <filesystem>
+
+using namespace std::literals::string_literals;
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestPackFile : public AutoRegisterTest<TestPackFile> {
+public:
+	TestPackFile() {}
+
+	static std::string Name() {
+		return "Pack File";
+	}
+	virtual int Run() override;
+private:
+	static int a;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+static void TestAssertFunc(bool val, const char* expression) {
+	if (!val) {
+		throw std::runtime_error("Assertion failed while evaluating the following expression:\n"s + expression);
+	}
+}
+
+#define TestAssert(x) TestAssertFunc(x, #x)
+
+
+using namespace inl;
+namespace fs = std::experimental::filesystem;
+
+
+static std::vector<uint8_t> MakeText(size_t size) {
+	static const char words[] = "float4 main(PS_Input input) : SV_TARGET { return tex.Sample(samp, input.texCoord); }\n";
+	std::vector<uint8_t> data(size);
+	for (size_t i = 0; i < size; ++i) {
+		data[i] = words[(i * 7 / 5) % (sizeof(words) - 1)];
+	}
+	return data;
+}
+
+
+static std::vector<uint8_t> MakeNoise(size_t size) {
+	std::mt19937 rne(1234);
+	std::vector<uint8_t> data(size);
+	for (auto& byte : data) {
+		byte = uint8_t(rne());
+	}
+	return data;
+}
+
+
+static void TestLz4() {
+	std::vector<std::vector<uint8_t>> inputs = {
+		{},
+		{ 1, 2, 3 },
+		std::vector<uint8_t>(100000, 'a'), // Matches overlapping their output.
+		MakeText(1 << 20),
+		MakeNoise(70000),
+	};
+	for (const auto& input : inputs) {
+		std::vector<uint8_t> compressed(Lz4CompressBound(input.size()));
+		size_t compressedSize = Lz4Compress(input.data(), input.size(), compressed.data(), compressed.size());
+		TestAssert(compressedSize > 0);
+		compressed.resize(compressedSize);
+
+		std::vector<uint8_t> output(input.size());
+		Lz4Decompress(compressed.data(), compressed.size(), output.data(), output.size());
+		TestAssert(output == input);
+	}
+
+	// Repetitive data compresses well, noise does not fit into a smaller buffer.
+	auto text = MakeText(1 << 20);
+	std::vector<uint8_t> compressed(text.size() / 8);
+	TestAssert(Lz4Compress(text.data(), text.size(), compressed.data(), compressed.size()) > 0);
+	auto noise = MakeNoise(70000);
+	compressed.resize(noise.size() - 1);
+	TestAssert(Lz4Compress(noise.data(), noise.size(), compressed.data(), compressed.size()) == 0);
+
+	// Truncated or wrongly sized input is rejected instead of read past.
+	compressed.resize(Lz4CompressBound(text.size()));
+	compressed.resize(Lz4Compress(text.data(), text.size(), compressed.data(), compressed.size()));
+	std::vector<uint8_t> output(text.size());
+	auto isRejected = [&output](const std::vector<uint8_t>& input, size_t size) {
+		try {
+			Lz4Decompress(input.data(), input.size(), output.data(), size);
+		}
+		catch (InvalidArgumentException&) {
+			return true;
+		}
+		return false;
+	};
+	TestAssert(isRejected({ compressed.begin(), compressed.begin() + compressed.size() / 2 }, text.size()));
+	TestAssert(isRejected(compressed, text.size() - 1));
+}
+
+
+static void TestRoundTrip(const std::string& path) {
+	auto shader = MakeText(5000);
+	auto texture = MakeNoise(3001);
+	auto model = MakeText(123);
+
+	PackFileWriter writer;
+	writer.AddFile("Shaders/blit.hlsl", shader.data(), shader.size());
+	writer.AddFile("textures\\noise.png", texture.data(), texture.size());
+	writer.AddFile("./models/../models/box.obj", model.data(), model.size(), ePackCompression::NONE);
+	writer.AddFile("empty.txt", nullptr, 0);
+
+	bool thrown = false;
+	try {
+		writer.AddFile("shaders/BLIT.hlsl", shader.data(), shader.size());
+	}
+	catch (InvalidArgumentException&) {
+		thrown = true;
+	}
+	TestAssert(thrown);
+
+	writer.Write(path);
+
+	PackFile pack(path);
+	TestAssert(pack.GetEntryCount() == 4);
+	TestAssert(pack.Find("missing.hlsl") == PackFile::InvalidIndex);
+
+	size_t shaderIndex = pack.Find("shaders\\BLIT.HLSL");
+	TestAssert(shaderIndex != PackFile::InvalidIndex);
+	TestAssert(pack.GetEntryPath(shaderIndex) == "Shaders/blit.hlsl");
+	TestAssert(pack.GetEntryCompression(shaderIndex) == ePackCompression::LZ4);
+	TestAssert(pack.GetMappedData(shaderIndex) == nullptr);
+	std::vector<uint8_t> output(pack.GetEntrySize(shaderIndex));
+	pack.Read(shaderIndex, output.data());
+	TestAssert(output == shader);
+
+	// Noise does not compress, it is stored and mapped, as are files added uncompressed.
+	for (auto entry : { std::make_pair("textures/noise.png", &texture), std::make_pair("models/box.obj", &model) }) {
+		size_t index = pack.Find(entry.first);
+		TestAssert(index != PackFile::InvalidIndex);
+		TestAssert(pack.GetEntryCompression(index) == ePackCompression::NONE);
+		const void* mapped = pack.GetMappedData(index);
+		TestAssert(mapped != nullptr);
+		TestAssert(reinterpret_cast<uintptr_t>(mapped) % 16 == 0);
+		TestAssert(pack.GetEntrySize(index) == entry.second->size());
+		TestAssert(std::memcmp(mapped, entry.second->data(), entry.second->size()) == 0);
+	}
+
+	size_t emptyIndex = pack.Find("empty.txt");
+	TestAssert(emptyIndex != PackFile::InvalidIndex);
+	TestAssert(pack.GetEntrySize(emptyIndex) == 0);
+}
+
+
+static void TestCorrupt(const std::string& path) {
+	std::vector<char> bytes;
+	{
+		std::ifstream file(path, std::ios::binary);
+		bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	auto isRejected = [&path](const std::vector<char>& contents) {
+		{
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			file.write(contents.data(), contents.size());
+		}
+		try {
+			PackFile pack(path);
+		}
+		catch (InvalidArgumentException&) {
+			return true;
+		}
+		return false;
+	};
+
+	auto truncated = bytes;
+	truncated.resize(truncated.size() - 4);
+	TestAssert(isRejected(truncated));
+
+	auto badMagic = bytes;
+	badMagic[0] = 'X';
+	TestAssert(isRejected(badMagic));
+
+	// Every slot of the hash table taken, lookups of missing paths would probe forever.
+	auto fullHashTable = bytes;
+	uint32_t hashTableSize;
+	uint64_t hashTableOffset;
+	std::memcpy(&hashTableSize, fullHashTable.data() + 12, sizeof(hashTableSize));
+	std::memcpy(&hashTableOffset, fullHashTable.data() + 24, sizeof(hashTableOffset));
+	for (uint32_t i = 0; i < hashTableSize; ++i) {
+		const uint32_t firstEntry = 1;
+		std::memcpy(fullHashTable.data() + hashTableOffset + i * sizeof(uint32_t), &firstEntry, sizeof(firstEntry));
+	}
+	TestAssert(isRejected(fullHashTable));
+}
+
+
+static void TestFileSystem(const std::string& packPath, const std::string& directory) {
+	auto patched = MakeText(77);
+	fs::create_directories(fs::path(directory) / "shaders");
+	{
+		std::ofstream file((fs::path(directory) / "shaders" / "blit.hlsl").generic_string(), std::ios::binary);
+		file.write(reinterpret_cast<const char*>(patched.data()), patched.size());
+	}
+
+	VirtualFileSystem fileSystem;
+	fileSystem.MountPack(std::make_shared<PackFile>(packPath), "data");
+
+	TestAssert(fileSystem.Exists("data/shaders/blit.hlsl"));
+	TestAssert(!fileSystem.Exists("shaders/blit.hlsl"));
+	TestAssert(!fileSystem.Exists("data/shaders/missing.hlsl"));
+
+	VirtualFile texture = fileSystem.Open("Data\\Textures\\noise.png");
+	TestAssert(texture.IsMapped());
+	TestAssert(texture.GetSize() == 3001);
+	TestAssert(std::memcmp(texture.GetData(), MakeNoise(3001).data(), 3001) == 0);
+
+	VirtualFile shader = fileSystem.Open("data/shaders/blit.hlsl");
+	TestAssert(!shader.IsMapped());
+	TestAssert(shader.GetSize() == 5000);
+
+	// Mounted later, the directory overrides the pack.
+	fileSystem.MountDirectory(directory, "data");
+	shader = fileSystem.Open("data/shaders/blit.hlsl");
+	TestAssert(shader.GetSize() == patched.size());
+	TestAssert(std::memcmp(shader.GetData(), patched.data(), patched.size()) == 0);
+	TestAssert(fileSystem.Open("data/textures/noise.png").IsMapped());
+
+	bool thrown = false;
+	try {
+		fileSystem.Open("data/shaders/missing.hlsl");
+	}
+	catch (FileNotFoundException&) {
+		thrown = true;
+	}
+	TestAssert(thrown);
+}
+
+
+int TestPackFile::Run() {
+	std::string path = (fs::temp_directory_path() / "test_pack_file.inlpack").generic_string();
+	std::string directory = (fs::temp_directory_path() / "test_pack_file_loose").generic_string();
+	try {
+		TestLz4();
+		TestRoundTrip(path);
+		TestFileSystem(path, directory);
+		TestCorrupt(path);
+	}
+	catch (std::exception& ex) {
+		cout << ex.what() << endl;
+		fs::remove(path);
+		fs::remove_all(directory);
+		return 1;
+	}
+
+	fs::remove(path);
+	fs::remove_all(directory);
+	return 0;
+}
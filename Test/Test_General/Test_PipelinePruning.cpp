@@ -0,0 +1,146 @@
+#include "Test.hpp"
+
+#include <GraphicsEngine_LL/Pipeline.hpp>
+#include <GraphicsEngine_LL/GraphicsNode.hpp>
+#include <GraphicsEngine_LL/Nodes/Node_GetBackBuffer.hpp>
+#include <GraphicsEngine_LL/Nodes/Node_TextureProperties.hpp>
+#include <BaseLibrary/Graph/Node_Arithmetic.hpp>
+
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+
+using namespace std::literals::string_literals;
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Node classes
+//------------------------------------------------------------------------------
+
+
+// Stands in for a full-screen pass: takes a texture and passes it on.
+class TestPassNode :
+	virtual public inl::gxeng::GraphicsNode,
+	public inl::gxeng::GraphicsTask,
+	public inl::InputPortConfig<inl::gxeng::Texture2D, float, unsigned>,
+	public inl::OutputPortConfig<inl::gxeng::Texture2D>
+{
+public:
+	static const char* Info_GetName() { return "TestPassNode"; }
+
+	void Update() override {}
+	void Notify(inl::InputPortBase* sender) override {}
+	void Initialize(inl::gxeng::EngineContext& context) override {
+		GraphicsNode::SetTaskSingle(this);
+	}
+	void Reset() override {}
+	void Setup(inl::gxeng::SetupContext& context) override {}
+	void Execute(inl::gxeng::RenderContext& context) override {}
+};
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestPipelinePruning : public AutoRegisterTest<TestPipelinePruning> {
+public:
+	TestPipelinePruning() {}
+
+	static std::string Name() {
+		return "Pipeline Pruning";
+	}
+	virtual int Run() override;
+private:
+	static int a;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+static void TestAssertFunc(bool val, const char* expression) {
+	if (!val) {
+		throw std::runtime_error("Assertion failed while evaluating the following expression:\n"s + expression);
+	}
+}
+
+#define TestAssert(x) TestAssertFunc(x, #x)
+
+
+int TestPipelinePruning::Run() {
+	using namespace inl;
+	using namespace inl::gxeng;
+
+	// Back buffer -> passA -> passB, passB is the sink.
+	// Constant float math feeds passA, the back buffer's width feeds passB.
+	// passC and its math are not connected to the back buffer, they are dead.
+	auto backBuffer = std::make_shared<nodes::GetBackBuffer>();
+	auto properties = std::make_shared<nodes::TextureProperties>();
+	auto passA = std::make_shared<TestPassNode>();
+	auto passB = std::make_shared<TestPassNode>();
+	auto passC = std::make_shared<TestPassNode>();
+	auto add = std::make_shared<FloatAdd>();
+	auto multiply = std::make_shared<FloatMultiply>();
+	auto deadAdd = std::make_shared<FloatAdd>();
+
+	add->GetInput<0>().Set(1.0f);
+	add->GetInput<1>().Set(2.0f);
+	multiply->GetInput<1>().Set(0.5f);
+	deadAdd->GetInput<0>().Set(1.0f);
+	deadAdd->GetInput<1>().Set(2.0f);
+
+	try {
+		TestAssert(backBuffer->GetOutput(0)->Link(passA->GetInput(0)));
+		TestAssert(backBuffer->GetOutput(0)->Link(properties->GetInput(0)));
+		TestAssert(passA->GetOutput(0)->Link(passB->GetInput(0)));
+		TestAssert(add->GetOutput(0)->Link(multiply->GetInput(0)));
+		TestAssert(multiply->GetOutput(0)->Link(passA->GetInput(1)));
+		TestAssert(properties->GetOutput(0)->Link(passB->GetInput(2)));
+		TestAssert(deadAdd->GetOutput(0)->Link(passC->GetInput(1)));
+
+		EngineContext engineContext(1, 1);
+		std::vector<std::shared_ptr<NodeBase>> nodes = { backBuffer, properties, passA, passB, passC, add, multiply, deadAdd };
+		for (auto& node : nodes) {
+			if (auto graphicsNode = dynamic_cast<GraphicsNode*>(node.get())) {
+				graphicsNode->Initialize(engineContext);
+			}
+		}
+
+		Pipeline pipeline;
+		pipeline.CreateFromNodesList(nodes);
+
+		std::unordered_map<const NodeBase*, bool> isLive;
+		std::unordered_map<const NodeBase*, bool> isConstant;
+		for (lemon::ListDigraph::NodeIt depNode(pipeline.GetDependencyGraph()); depNode != lemon::INVALID; ++depNode) {
+			const NodeBase* node = pipeline.GetNodeMap()[depNode].get();
+			isLive[node] = pipeline.GetLiveNodeMap()[depNode];
+			isConstant[node] = pipeline.GetConstantNodeMap()[depNode];
+		}
+
+		TestAssert(isLive[backBuffer.get()] && isLive[properties.get()] && isLive[passA.get()] && isLive[passB.get()]);
+		TestAssert(isLive[add.get()] && isLive[multiply.get()]);
+		TestAssert(!isLive[passC.get()] && !isLive[deadAdd.get()]);
+
+		TestAssert(isConstant[add.get()] && isConstant[multiply.get()] && isConstant[properties.get()]);
+		TestAssert(!isConstant[backBuffer.get()] && !isConstant[passA.get()] && !isConstant[passB.get()]);
+		TestAssert(!isConstant[deadAdd.get()]);
+
+		// Only live nodes get tasks, each of these has a single one.
+		TestAssert(lemon::countNodes(pipeline.GetTaskGraph()) == 6);
+
+		cout << "Dead nodes pruned, constants found." << endl;
+	}
+	catch (std::exception& ex) {
+		cout << ex.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
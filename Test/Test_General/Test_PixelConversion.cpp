@@ -0,0 +1,240 @@
+#include "Test.hpp"
+#include <GraphicsEngine_LL/PixelConversion.hpp>
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+
+using namespace std::literals::string_literals;
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestPixelConversion : public AutoRegisterTest<TestPixelConversion> {
+public:
+	TestPixelConversion() {}
+
+	static std::string Name() {
+		return "Pixel Conversion";
+	}
+	virtual int Run() override;
+private:
+	static int a;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+static void TestAssertFunc(bool val, const char* expression) {
+	if (!val) {
+		throw std::runtime_error("Assertion failed while evaluating the following expression:\n"s + expression);
+	}
+}
+
+#define TestAssert(x) TestAssertFunc(x, #x)
+
+
+// Random pixels, floats go a bit out of [0, 1] to exercise clamping.
+static std::vector<uint8_t> RandomPixels(inl::gxeng::PixelFormat format, size_t count, std::mt19937& rne) {
+	using namespace inl::gxeng;
+
+	std::vector<uint8_t> pixels(format.GetSize() * count);
+	if (format.channelType == ePixelChannelType::FLOAT32) {
+		std::uniform_real_distribution<float> rng(-0.1f, 1.1f);
+		for (size_t i = 0; i < pixels.size() / sizeof(float); ++i) {
+			float value = rng(rne);
+			std::memcpy(pixels.data() + i * sizeof(float), &value, sizeof(float));
+		}
+	}
+	else {
+		std::uniform_int_distribution<int> rng(0, 255);
+		for (auto& byte : pixels) {
+			byte = (uint8_t)rng(rne);
+		}
+	}
+	return pixels;
+}
+
+
+static std::string FormatName(inl::gxeng::PixelFormat format) {
+	using namespace inl::gxeng;
+
+	static const char* types[] = { "U8", "U16", "U32", "F32" };
+	static const char* classes[] = { "", "_EXP", "_SRGB" };
+	return types[(int)format.channelType] + std::to_string(format.channelCount) + classes[(int)format.pixelClass];
+}
+
+
+// Compares every supported pair of formats to the reference, using every instruction set the CPU has.
+static void TestAgainstReference() {
+	using namespace inl;
+	using namespace inl::gxeng;
+
+	std::vector<PixelFormat> formats;
+	for (auto type : { ePixelChannelType::INT8_NORM, ePixelChannelType::INT16_NORM, ePixelChannelType::INT32, ePixelChannelType::FLOAT32 }) {
+		for (auto pixelClass : { ePixelClass::LINEAR, ePixelClass::VALUE_EXPONENT, ePixelClass::SRGB }) {
+			for (int channelCount = 1; channelCount <= 4; ++channelCount) {
+				formats.push_back({ type, channelCount, pixelClass });
+			}
+		}
+	}
+
+	std::mt19937 rne(1234);
+	int numPairs = 0;
+	int numSimdPairs = 0;
+	for (auto source : formats) {
+		for (auto destination : formats) {
+			if (!PixelConverter::IsSupported(source, destination)) {
+				continue;
+			}
+			++numPairs;
+
+			for (auto level : { eSimdLevel::SCALAR, eSimdLevel::SSE4_1, eSimdLevel::AVX2 }) {
+				if (level > CpuFeatures::GetSimdLevel()) {
+					continue;
+				}
+				PixelConverter converter(source, destination, level);
+				numSimdPairs += level == eSimdLevel::SSE4_1 && converter.GetSimdLevel() != eSimdLevel::SCALAR;
+
+				// Odd lengths to hit the scalar tails of the kernels.
+				for (size_t count : { 1, 2, 3, 5, 7, 8, 15, 16, 17, 31, 33, 1001 }) {
+					auto pixels = RandomPixels(source, count, rne);
+					std::vector<uint8_t> expected(destination.GetSize() * count);
+					std::vector<uint8_t> actual(destination.GetSize() * count);
+					PixelConverter::ConvertReference(pixels.data(), source, expected.data(), destination, count);
+					converter.Convert(pixels.data(), actual.data(), count);
+					if (expected != actual) {
+						throw std::runtime_error("Mismatch converting " + FormatName(source) + " to " + FormatName(destination)
+												 + " at SIMD level " + std::to_string((int)converter.GetSimdLevel())
+												 + ", " + std::to_string(count) + " pixels.");
+					}
+				}
+			}
+		}
+	}
+	cout << numPairs << " format pairs match the reference, " << numSimdPairs << " of them with SIMD kernels." << endl;
+}
+
+
+// Non-square rectangles with padded rows.
+static void TestRectangle() {
+	using namespace inl::gxeng;
+
+	PixelFormat source{ ePixelChannelType::INT8_NORM, 3, ePixelClass::LINEAR };
+	PixelFormat destination{ ePixelChannelType::INT8_NORM, 4, ePixelClass::LINEAR };
+	PixelConverter converter(source, destination);
+
+	const size_t width = 37, height = 13;
+	const size_t sourcePitch = width * 3 + 5;
+	const size_t destinationPitch = width * 4;
+	std::vector<uint8_t> pixels(sourcePitch * height);
+	for (size_t i = 0; i < pixels.size(); ++i) {
+		pixels[i] = uint8_t(i * 7);
+	}
+	std::vector<uint8_t> converted(destinationPitch * height);
+	converter.Convert(pixels.data(), sourcePitch, converted.data(), destinationPitch, width, height);
+
+	for (size_t y = 0; y < height; ++y) {
+		for (size_t x = 0; x < width; ++x) {
+			for (size_t c = 0; c < 3; ++c) {
+				TestAssert(converted[y * destinationPitch + x * 4 + c] == pixels[y * sourcePitch + x * 3 + c]);
+			}
+			TestAssert(converted[y * destinationPitch + x * 4 + 3] == 255);
+		}
+	}
+}
+
+
+static void TestUnsupported() {
+	using namespace inl;
+	using namespace inl::gxeng;
+
+	TestAssert(!PixelConverter::IsSupported({ ePixelChannelType::INT8_NORM, 4, ePixelClass::LINEAR }, { ePixelChannelType::INT8_NORM, 3, ePixelClass::LINEAR }));
+	TestAssert(!PixelConverter::IsSupported({ ePixelChannelType::INT32, 1, ePixelClass::LINEAR }, { ePixelChannelType::FLOAT32, 1, ePixelClass::LINEAR }));
+	TestAssert(!PixelConverter::IsSupported({ ePixelChannelType::FLOAT32, 1, ePixelClass::SRGB }, { ePixelChannelType::FLOAT32, 1, ePixelClass::LINEAR }));
+
+	bool thrown = false;
+	try {
+		PixelConverter converter({ ePixelChannelType::INT8_NORM, 2, ePixelClass::LINEAR }, { ePixelChannelType::INT8_NORM, 1, ePixelClass::LINEAR });
+	}
+	catch (InvalidArgumentException&) {
+		thrown = true;
+	}
+	TestAssert(thrown);
+}
+
+
+static void Benchmark(inl::gxeng::PixelFormat source, inl::gxeng::PixelFormat destination) {
+	using namespace inl;
+	using namespace inl::gxeng;
+	using Clock = std::chrono::high_resolution_clock;
+
+	const size_t width = 2048, height = 2048;
+	std::mt19937 rne(42);
+	auto pixels = RandomPixels(source, width * height, rne);
+	std::vector<uint8_t> converted(destination.GetSize() * width * height);
+
+	auto measure = [&](auto convert) {
+		double best = 1e9;
+		for (int i = 0; i < 5; ++i) {
+			auto begin = Clock::now();
+			convert();
+			best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - begin).count());
+		}
+		return best;
+	};
+
+	cout << FormatName(source) << " -> " << FormatName(destination) << ", " << width << "x" << height << ":" << endl;
+	double referenceMs = measure([&] {
+		PixelConverter::ConvertReference(pixels.data(), source, converted.data(), destination, width * height);
+	});
+	cout << "   reference: " << referenceMs << " ms" << endl;
+	for (auto level : { eSimdLevel::SCALAR, eSimdLevel::SSE4_1, eSimdLevel::AVX2 }) {
+		if (level > CpuFeatures::GetSimdLevel()) {
+			continue;
+		}
+		PixelConverter converter(source, destination, level);
+		if (converter.GetSimdLevel() != level) {
+			continue;
+		}
+		double ms = measure([&] {
+			converter.Convert(pixels.data(), width * source.GetSize(), converted.data(), width * destination.GetSize(), width, height);
+		});
+		const char* names[] = { "scalar", "SSE4.1", "AVX2" };
+		cout << "   " << names[(int)level] << ": " << ms << " ms (" << referenceMs / ms << "x)" << endl;
+	}
+}
+
+
+int TestPixelConversion::Run() {
+	using namespace inl::gxeng;
+
+	try {
+		TestAgainstReference();
+		TestRectangle();
+		TestUnsupported();
+	}
+	catch (std::exception& ex) {
+		cout << ex.what() << endl;
+		return 1;
+	}
+
+	Benchmark({ ePixelChannelType::INT8_NORM, 3, ePixelClass::LINEAR }, { ePixelChannelType::INT8_NORM, 4, ePixelClass::LINEAR });
+	Benchmark({ ePixelChannelType::INT8_NORM, 4, ePixelClass::LINEAR }, { ePixelChannelType::FLOAT32, 4, ePixelClass::LINEAR });
+	Benchmark({ ePixelChannelType::FLOAT32, 4, ePixelClass::LINEAR }, { ePixelChannelType::INT8_NORM, 4, ePixelClass::SRGB });
+
+	return 0;
+}
@@ -0,0 +1,293 @@
+#include "Test.hpp"
+#include <AssetLibrary/Animation.hpp>
+#include <AssetLibrary/Skinning.hpp>
+#include <GraphicsEngine_LL/Vertex.hpp>
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+using namespace std::literals::string_literals;
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestSkinning : public AutoRegisterTest<TestSkinning> {
+public:
+	TestSkinning() {}
+
+	static std::string Name() {
+		return "Skinning";
+	}
+	virtual int Run() override;
+private:
+	static int a;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+static void TestAssertFunc(bool val, const char* expression) {
+	if (!val) {
+		throw std::runtime_error("Assertion failed while evaluating the following expression:\n"s + expression);
+	}
+}
+
+#define TestAssert(x) TestAssertFunc(x, #x)
+
+
+using namespace inl;
+using namespace inl::asset;
+using SkinnedVertexT = gxeng::Vertex<gxeng::Position<0>, gxeng::Normal<0>, gxeng::BoneIndices<0>, gxeng::BoneWeights<0>>;
+
+
+static bool IsClose(float lhs, float rhs) {
+	return std::abs(lhs - rhs) <= 1e-4f * std::max(1.0f, std::abs(rhs));
+}
+
+
+// A track that holds still, with rotation given as x, y, z, w.
+static AnimationTrack MakeTrack(Vec3_Packed translation, Vec4_Packed rotation) {
+	AnimationTrack track;
+	track.translationTimes = { 0.0f };
+	track.translations = { { { translation.x }, { translation.y }, { translation.z } } };
+	track.rotationTimes = { 0.0f };
+	track.rotations = { { { rotation.x }, { rotation.y }, { rotation.z }, { rotation.w } } };
+	track.scaleTimes = { 0.0f };
+	track.scales = { { { 1.0f }, { 1.0f }, { 1.0f } } };
+	return track;
+}
+
+
+static void TestSampler() {
+	const float halfSqrt2 = std::sqrt(0.5f);
+
+	// Five tracks, so that the SIMD loop has a remainder.
+	std::vector<AnimationTrack> tracks;
+	for (int i = 0; i < 5; ++i) {
+		AnimationTrack track = MakeTrack({ float(i), 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f });
+		track.translationTimes = { 0.0f, 1.0f, 3.0f };
+		track.translations = { { { 0.0f, 2.0f, 6.0f }, { float(i), float(i), float(i) }, { 0.0f, 0.0f, 0.0f } } };
+		// To 90 degrees around Z. The last key is the same rotation negated, which must not spin the bone around.
+		track.rotationTimes = { 0.0f, 2.0f, 3.0f };
+		track.rotations = { { { 0.0f, 0.0f, -0.0f }, { 0.0f, 0.0f, -0.0f }, { 0.0f, halfSqrt2, -halfSqrt2 }, { 1.0f, halfSqrt2, -halfSqrt2 } } };
+		tracks.push_back(track);
+	}
+	AnimationClip clip("walk", 3.0f, tracks);
+	AnimationSampler sampler(clip);
+	LocalPose pose;
+
+	// Forward, then backward and out of range.
+	for (float time : { 0.0f, 0.5f, 1.0f, 2.0f, 2.5f, 3.0f, 1.5f, -1.0f, 10.0f }) {
+		sampler.Sample(time, pose);
+		TestAssert(pose.GetBoneCount() == 5);
+
+		const float clamped = std::min(std::max(time, 0.0f), 3.0f);
+		const float expectedX = clamped <= 1.0f ? 2.0f * clamped : 2.0f + (clamped - 1.0f) * 2.0f;
+		const float angle = std::min(clamped, 2.0f) / 2.0f * 1.5707963f;
+		for (size_t bone = 0; bone < 5; ++bone) {
+			TestAssert(IsClose(pose.translation[0][bone], expectedX));
+			TestAssert(IsClose(pose.translation[1][bone], float(bone)));
+			TestAssert(pose.scale[2][bone] == 1.0f);
+
+			// Normalized linear blending is exact at the keys and halfway between them. q and -q are the same rotation.
+			if (clamped == 0.0f || clamped == 1.0f || clamped >= 2.0f) {
+				const float dot = pose.rotation[2][bone] * std::sin(angle / 2.0f) + pose.rotation[3][bone] * std::cos(angle / 2.0f);
+				TestAssert(IsClose(std::abs(dot), 1.0f));
+			}
+			const float lengthSq = pose.rotation[0][bone] * pose.rotation[0][bone] + pose.rotation[1][bone] * pose.rotation[1][bone]
+				+ pose.rotation[2][bone] * pose.rotation[2][bone] + pose.rotation[3][bone] * pose.rotation[3][bone];
+			TestAssert(IsClose(lengthSq, 1.0f));
+		}
+	}
+
+	bool thrown = false;
+	try {
+		tracks[2].rotationTimes = { 1.0f, 0.0f, 3.0f };
+		AnimationClip unsorted("unsorted", 3.0f, tracks);
+	}
+	catch (InvalidArgumentException&) {
+		thrown = true;
+	}
+	TestAssert(thrown);
+}
+
+
+static void TestSkinMatrices() {
+	const float halfSqrt2 = std::sqrt(0.5f);
+
+	// A root moved along X, and a child above it turned 90 degrees around Z.
+	std::vector<Bone> bones(2);
+	bones[0].name = "root";
+	bones[1].name = "child";
+	bones[1].parent = 0;
+	bones[1].inverseBind(3, 0) = -1.0f;
+	Skeleton skeleton(bones);
+	TestAssert(skeleton.FindBone("child") == 1);
+	TestAssert(skeleton.FindBone("missing") == -1);
+
+	AnimationClip clip("pose", 0.0f, {
+		MakeTrack({ 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }),
+		MakeTrack({ 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, halfSqrt2, halfSqrt2 }),
+	});
+	AnimationSampler sampler(clip);
+	LocalPose pose;
+	sampler.Sample(0.0f, pose);
+
+	std::vector<Mat44> skinMatrices;
+	ComputeSkinMatrices(skeleton, pose, skinMatrices);
+	TestAssert(skinMatrices.size() == 2);
+
+	// (2, 0, 0) is (1, 0, 0) in the bind space of the child, that turns to (0, 1, 0), then moves up and right.
+	const float position[4] = { 2.0f, 0.0f, 0.0f, 1.0f };
+	float result[4] = {};
+	for (int j = 0; j < 4; ++j) {
+		for (int i = 0; i < 4; ++i) {
+			result[j] += position[i] * skinMatrices[1](i, j);
+		}
+	}
+	TestAssert(IsClose(result[0], 1.0f));
+	TestAssert(IsClose(result[1], 2.0f));
+	TestAssert(IsClose(result[2], 0.0f));
+	TestAssert(IsClose(result[3], 1.0f));
+
+	bool thrown = false;
+	try {
+		std::vector<Bone> unordered = { bones[1], bones[0] };
+		unordered[0].parent = 1;
+		Skeleton invalid(unordered);
+	}
+	catch (InvalidArgumentException&) {
+		thrown = true;
+	}
+	TestAssert(thrown);
+}
+
+
+static std::vector<SkinnedVertexT> MakeVertices(size_t count, uint32_t numBones) {
+	std::mt19937 rne(42);
+	std::uniform_real_distribution<float> coordinate(-10.0f, 10.0f);
+	std::uniform_int_distribution<uint32_t> bone(0, numBones - 1);
+
+	std::vector<SkinnedVertexT> vertices(count);
+	for (auto& vertex : vertices) {
+		vertex.position = { coordinate(rne), coordinate(rne), coordinate(rne) };
+		vertex.normal = { coordinate(rne), coordinate(rne), coordinate(rne) };
+		float weights[4] = { std::abs(coordinate(rne)), std::abs(coordinate(rne)), std::abs(coordinate(rne)), 0.0f };
+		const float sum = weights[0] + weights[1] + weights[2];
+		vertex.boneIndices = { bone(rne), bone(rne), bone(rne), 0u };
+		vertex.boneWeights = { weights[0] / sum, weights[1] / sum, weights[2] / sum, weights[3] };
+	}
+	return vertices;
+}
+
+
+static std::vector<Mat44> MakeSkinMatrices(size_t count) {
+	std::mt19937 rne(7);
+	std::uniform_real_distribution<float> element(-1.0f, 1.0f);
+
+	std::vector<Mat44> matrices(count);
+	for (auto& matrix : matrices) {
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				matrix(i, j) = j < 3 ? element(rne) : float(i == 3);
+			}
+		}
+	}
+	return matrices;
+}
+
+
+static void TestKernel() {
+	// Not divisible by the number of threads.
+	const auto vertices = MakeVertices(10007, 40);
+	const auto skinMatrices = MakeSkinMatrices(40);
+
+	std::vector<SkinnedVertexT> reference(vertices.size());
+	SkinVerticesReference(
+		&vertices[0].position, &vertices[0].normal, &vertices[0].boneIndices, &vertices[0].boneWeights, sizeof(SkinnedVertexT),
+		vertices.size(),
+		skinMatrices.data(), skinMatrices.size(),
+		&reference[0].position, &reference[0].normal, sizeof(SkinnedVertexT));
+
+	for (unsigned numThreads : { 1u, 3u }) {
+		std::vector<SkinnedVertexT> skinned(vertices.size());
+		SkinVertices(vertices.data(), vertices.size(), skinMatrices.data(), skinMatrices.size(), skinned.data(), numThreads);
+		for (size_t i = 0; i < vertices.size(); ++i) {
+			for (int c = 0; c < 3; ++c) {
+				TestAssert(IsClose(skinned[i].position[c], reference[i].position[c]));
+				TestAssert(IsClose(skinned[i].normal[c], reference[i].normal[c]));
+			}
+		}
+	}
+
+	// Only positions, into a static vertex type.
+	using StaticVertexT = gxeng::Vertex<gxeng::Position<0>>;
+	std::vector<StaticVertexT> positions(vertices.size());
+	SkinVertices(
+		&vertices[0].position, nullptr, &vertices[0].boneIndices, &vertices[0].boneWeights, sizeof(SkinnedVertexT),
+		vertices.size(),
+		skinMatrices.data(), skinMatrices.size(),
+		&positions[0].position, nullptr, sizeof(StaticVertexT));
+	for (size_t i = 0; i < vertices.size(); ++i) {
+		for (int c = 0; c < 3; ++c) {
+			TestAssert(IsClose(positions[i].position[c], reference[i].position[c]));
+		}
+	}
+}
+
+
+static void Benchmark() {
+	using Clock = std::chrono::high_resolution_clock;
+
+	const auto vertices = MakeVertices(1000000, 64);
+	const auto skinMatrices = MakeSkinMatrices(64);
+	std::vector<SkinnedVertexT> output(vertices.size());
+	const double numVertices = double(vertices.size());
+
+	cout << "Skinning " << numVertices / 1e6 << "M vertices:" << endl;
+	{
+		auto begin = Clock::now();
+		SkinVerticesReference(
+			&vertices[0].position, &vertices[0].normal, &vertices[0].boneIndices, &vertices[0].boneWeights, sizeof(SkinnedVertexT),
+			vertices.size(),
+			skinMatrices.data(), skinMatrices.size(),
+			&output[0].position, &output[0].normal, sizeof(SkinnedVertexT));
+		double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+		cout << "   scalar: " << numVertices / seconds / 1e6 << " Mvertices/s" << endl;
+	}
+	for (unsigned numThreads : { 1u, 0u }) {
+		auto begin = Clock::now();
+		SkinVertices(vertices.data(), vertices.size(), skinMatrices.data(), skinMatrices.size(), output.data(), numThreads);
+		double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+		cout << "   SSE" << (numThreads == 1 ? ", 1 thread: " : ", all threads: ") << numVertices / seconds / 1e6 << " Mvertices/s" << endl;
+	}
+}
+
+
+int TestSkinning::Run() {
+	try {
+		TestSampler();
+		TestSkinMatrices();
+		TestKernel();
+		Benchmark();
+	}
+	catch (std::exception& ex) {
+		cout << ex.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
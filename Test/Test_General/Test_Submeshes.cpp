@@ -0,0 +1,158 @@
+#include "Test.hpp"
+#include <GraphicsApi_D3D12/GxapiManager.hpp>
+#include <GraphicsApi_LL/IGraphicsApi.hpp>
+#include <GraphicsEngine_LL/Material.hpp>
+#include <GraphicsEngine_LL/MemoryManager.hpp>
+#include <GraphicsEngine_LL/Mesh.hpp>
+#include <GraphicsEngine_LL/MeshEntity.hpp>
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <string>
+
+using namespace std::literals::string_literals;
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestSubmeshes : public AutoRegisterTest<TestSubmeshes> {
+public:
+	TestSubmeshes() {}
+
+	static std::string Name() {
+		return "Submeshes";
+	}
+	virtual int Run() override;
+private:
+	static int a;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+static void TestAssertFunc(bool val, const char* expression) {
+	if (!val) {
+		throw std::runtime_error("Assertion failed while evaluating the following expression:\n"s + expression);
+	}
+}
+
+#define TestAssert(x) TestAssertFunc(x, #x)
+
+
+using namespace inl;
+using namespace inl::gxeng;
+
+
+static void TestMaterialSlots() {
+	Material first;
+	Material third;
+	MeshEntity entity;
+	TestAssert(entity.GetMaterialCount() == 1);
+	TestAssert(entity.GetMaterial(0) == nullptr);
+
+	// Slots that are not set are drawn with the first material.
+	entity.SetMaterial(&first);
+	TestAssert(entity.GetMaterial() == &first);
+	TestAssert(entity.GetMaterial(0) == &first);
+	TestAssert(entity.GetMaterial(4) == &first);
+
+	entity.SetMaterial(2, &third);
+	TestAssert(entity.GetMaterialCount() == 3);
+	TestAssert(entity.GetMaterial(1) == &first);
+	TestAssert(entity.GetMaterial(2) == &third);
+	TestAssert(entity.GetMaterial(3) == &first);
+
+	entity.SetMaterial(2, nullptr);
+	TestAssert(entity.GetMaterial(2) == &first);
+}
+
+
+static Mesh::Submesh MakeSubmesh(unsigned firstIndex, unsigned numIndices, int baseVertex) {
+	Mesh::Submesh submesh;
+	submesh.firstIndex = firstIndex;
+	submesh.numIndices = numIndices;
+	submesh.baseVertex = baseVertex;
+	submesh.materialSlot = 0;
+	submesh.boundsMin = Vec3(0, 0, 0);
+	submesh.boundsMax = Vec3(0, 0, 0);
+	return submesh;
+}
+
+
+// Two triangles of three vertices each, indexed relative to their first vertex.
+static const float vertices[6][3] = {
+	{ 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 },
+	{ 0, 0, 1 }, { 1, 0, 1 }, { 0, 1, 1 },
+};
+static const uint16_t indices[6] = { 0, 1, 2, 0, 2, 1 };
+
+
+static bool IsRejected(Mesh& mesh, std::vector<Mesh::Submesh> submeshes, size_t numVertices = 6, size_t numIndices = 6) {
+	std::vector<Mesh::Element> elements = { { eVertexElementSemantic::POSITION, 0, 0 } };
+	try {
+		mesh.SetCompressed(vertices, sizeof(vertices[0]), numVertices, elements, indices, numIndices, false, std::move(submeshes));
+	}
+	catch (OutOfRangeException&) {
+		return true;
+	}
+	return false;
+}
+
+
+static void TestSubmeshRanges(MemoryManager& memoryManager) {
+	Mesh mesh(&memoryManager);
+	TestAssert(!IsRejected(mesh, {}));
+	TestAssert(mesh.GetSubmeshes().size() == 1);
+	TestAssert(mesh.GetSubmeshes()[0].numIndices == 6);
+
+	TestAssert(!IsRejected(mesh, { MakeSubmesh(0, 3, 0), MakeSubmesh(3, 3, 3) }));
+	TestAssert(mesh.GetSubmeshes().size() == 2);
+	TestAssert(mesh.GetSubmeshes()[1].baseVertex == 3);
+
+	// Past the end of the index buffer.
+	TestAssert(IsRejected(mesh, { MakeSubmesh(3, 6, 0) }));
+	// The largest index plus the base vertex is past the last vertex.
+	TestAssert(IsRejected(mesh, { MakeSubmesh(0, 3, 0), MakeSubmesh(3, 3, 4) }));
+	// The smallest index plus the base vertex is before the first vertex.
+	TestAssert(IsRejected(mesh, { MakeSubmesh(3, 3, -1) }));
+	// Rejected meshes are left unchanged.
+	TestAssert(mesh.GetSubmeshes().size() == 2);
+	TestAssert(mesh.GetIndexBuffer().GetIndexCount() == 6);
+
+	// Empty ranges draw nothing, their base vertex does not matter.
+	TestAssert(!IsRejected(mesh, { MakeSubmesh(6, 0, 100) }));
+
+	// Vertices without a table get a single submesh.
+	TestAssert(!IsRejected(mesh, {}, 3, 3));
+	TestAssert(mesh.GetSubmeshes().size() == 1);
+	TestAssert(mesh.GetSubmeshes()[0].numIndices == 3);
+	TestAssert(IsRejected(mesh, { MakeSubmesh(0, 3, 3) }, 3, 3));
+}
+
+
+int TestSubmeshes::Run() {
+	try {
+		TestMaterialSlots();
+
+		std::unique_ptr<gxapi::IGxapiManager> gxapiManager(new gxapi_dx12::GxapiManager());
+		std::unique_ptr<gxapi::IGraphicsApi> graphicsApi(gxapiManager->CreateGraphicsApi(0));
+		MemoryManager memoryManager(graphicsApi.get());
+		TestSubmeshRanges(memoryManager);
+	}
+	catch (std::exception& ex) {
+		cout << ex.what() << endl;
+		return 1;
+	}
+	return 0;
+}
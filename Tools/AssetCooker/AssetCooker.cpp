@@ -0,0 +1,284 @@
+#include "AssetCooker.hpp"
+
+#include <AssetLibrary/ParallelFor.hpp>
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+
+
+namespace inl {
+namespace asset {
+
+
+namespace fs = std::experimental::filesystem;
+
+
+static uint64_t Fnv1a(const void* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; ++i) {
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
+	return hash;
+}
+
+
+static uint64_t Fnv1a(const std::string& text, uint64_t hash) {
+	// The length separates consecutive strings.
+	const uint64_t length = text.size();
+	return Fnv1a(text.data(), text.size(), Fnv1a(&length, sizeof(length), hash));
+}
+
+
+AssetCooker::AssetCooker(CookSettings settings)
+	: m_settings(std::move(settings))
+{}
+
+
+//------------------------------------------------------------------------------
+// Cooking
+//------------------------------------------------------------------------------
+
+
+CookResult AssetCooker::Cook() {
+	if (!fs::is_directory(m_settings.sourceDirectory)) {
+		throw FileNotFoundException("Source directory does not exist.", m_settings.sourceDirectory);
+	}
+	fs::create_directories(m_settings.outputDirectory);
+
+	// A missing or unreadable manifest only means that everything is cooked.
+	const std::string manifestFile = GetOutputFile(CookManifest::FileName);
+	m_previous = CookManifest();
+	if (fs::exists(manifestFile)) {
+		try {
+			m_previous.Load(manifestFile);
+		}
+		catch (InvalidArgumentException&) {
+			m_previous = CookManifest();
+		}
+		if (m_previous.GetCookerVersion() != Version) {
+			m_previous = CookManifest();
+		}
+	}
+	m_manifest = CookManifest();
+	m_manifest.SetCookerVersion(Version);
+	m_fileHashes.clear();
+
+	CookResult result;
+	std::vector<Job> jobs = FindSources();
+
+	// Two sources must not be cooked into the same file, like box.obj and box.fbx.
+	std::unordered_map<std::string, std::string> cookedPaths;
+	for (auto it = jobs.begin(); it != jobs.end();) {
+		std::string key = it->cookedPath;
+		std::transform(key.begin(), key.end(), key.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+		auto inserted = cookedPaths.insert({ key, it->sourcePath });
+		if (!inserted.second) {
+			result.errors.push_back(it->sourcePath + ": cooks into the same file as " + inserted.first->second + ".");
+			it = jobs.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+
+	// Hashing reads every changed file, so it is done in parallel too.
+	const unsigned numThreads = GetNumThreads(m_settings.numThreads);
+	std::vector<char> isUpToDate(jobs.size());
+	ParallelFor(jobs.size(), numThreads, [this, &jobs, &isUpToDate](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			// Files that cannot be hashed will fail to cook too, and are reported then.
+			try {
+				isUpToDate[i] = IsUpToDate(jobs[i]);
+			}
+			catch (std::exception&) {
+				isUpToDate[i] = false;
+			}
+		}
+	});
+
+	std::vector<const Job*> outOfDate;
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		if (isUpToDate[i]) {
+			m_manifest.SetAsset(*m_previous.FindAsset(jobs[i].sourcePath));
+			++result.numUpToDate;
+		}
+		else {
+			outOfDate.push_back(&jobs[i]);
+		}
+	}
+
+	// Cooking times vary a lot, so threads take the next asset when they are done instead of splitting the list.
+	std::atomic<size_t> nextJob(0);
+	std::mutex resultMutex;
+	VirtualFileSystem fileSystem;
+	fileSystem.MountDirectory(m_settings.sourceDirectory);
+	ParallelFor(numThreads, numThreads, [&](size_t, size_t) {
+		for (size_t i = nextJob++; i < outOfDate.size(); i = nextJob++) {
+			const Job& job = *outOfDate[i];
+			const std::string outputFile = GetOutputFile(job.cookedPath);
+			try {
+				fs::create_directories(fs::path(outputFile).parent_path());
+
+				CookManifest::Asset asset;
+				asset.sourcePath = job.sourcePath;
+				asset.cookedPath = job.cookedPath;
+				asset.dependencies = CookAsset(job.type, fileSystem, job.sourcePath, outputFile);
+				std::sort(asset.dependencies.begin(), asset.dependencies.end());
+				asset.inputHash = HashInputs(job, asset.dependencies);
+
+				std::lock_guard<std::mutex> lock(resultMutex);
+				m_manifest.SetAsset(std::move(asset));
+				++result.numCooked;
+			}
+			catch (std::exception& ex) {
+				std::error_code error;
+				fs::remove(outputFile, error);
+
+				std::lock_guard<std::mutex> lock(resultMutex);
+				result.errors.push_back(job.sourcePath + ": " + ex.what());
+			}
+		}
+	});
+
+	// Outputs of deleted sources would be found by the runtime otherwise. A source of another
+	// type may have taken their place, like a box.obj replaced by a box.fbx.
+	for (const CookManifest::Asset* asset : m_previous.GetAssets()) {
+		std::string key = asset->cookedPath;
+		std::transform(key.begin(), key.end(), key.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+		if (!fs::exists(GetSourceFile(asset->sourcePath)) && cookedPaths.count(key) == 0) {
+			std::error_code error;
+			if (fs::remove(GetOutputFile(asset->cookedPath), error)) {
+				++result.numRemoved;
+			}
+		}
+	}
+
+	// Only the files of this run are stamped, so the manifest does not grow with deleted files.
+	for (const auto& entry : m_fileHashes) {
+		if (entry.second.contentHash != 0) {
+			m_manifest.SetFileStamp(entry.first, entry.second);
+		}
+	}
+	m_manifest.Save(manifestFile);
+
+	std::sort(result.errors.begin(), result.errors.end());
+	return result;
+}
+
+
+std::vector<AssetCooker::Job> AssetCooker::FindSources() const {
+	const std::string root = fs::absolute(m_settings.sourceDirectory).generic_string();
+	const std::string output = fs::absolute(m_settings.outputDirectory).generic_string() + "/";
+
+	std::vector<Job> jobs;
+	for (const auto& entry : fs::recursive_directory_iterator(root)) {
+		const std::string path = entry.path().generic_string();
+		// The output directory may be inside the source directory.
+		if (!fs::is_regular_file(entry.status()) || path.compare(0, output.size(), output) == 0) {
+			continue;
+		}
+
+		Job job;
+		job.sourcePath = PackFile::NormalizePath(path.substr(root.size()));
+		if (!GetAssetType(job.sourcePath, job.type)) {
+			continue;
+		}
+		job.cookedPath = GetCookedPath(job.type, job.sourcePath);
+		jobs.push_back(std::move(job));
+	}
+
+	std::sort(jobs.begin(), jobs.end(), [](const Job& lhs, const Job& rhs) { return lhs.sourcePath < rhs.sourcePath; });
+	return jobs;
+}
+
+
+bool AssetCooker::IsUpToDate(const Job& job) const {
+	const CookManifest::Asset* previous = m_previous.FindAsset(job.sourcePath);
+	if (m_settings.force || previous == nullptr || previous->cookedPath != job.cookedPath) {
+		return false;
+	}
+
+	// The dependencies can only change if the asset or one of the dependencies changed.
+	return HashInputs(job, previous->dependencies) == previous->inputHash
+		&& fs::exists(GetOutputFile(job.cookedPath));
+}
+
+
+//------------------------------------------------------------------------------
+// Hashing
+//------------------------------------------------------------------------------
+
+
+uint64_t AssetCooker::HashInputs(const Job& job, const std::vector<std::string>& dependencies) const {
+	uint64_t hash = Fnv1a(&Version, sizeof(Version));
+	hash = Fnv1a(GetCookSettings(job.type), hash);
+
+	const uint64_t sourceHash = HashFile(job.sourcePath);
+	hash = Fnv1a(&sourceHash, sizeof(sourceHash), hash);
+	for (const auto& dependency : dependencies) {
+		const uint64_t dependencyHash = HashFile(dependency);
+		hash = Fnv1a(dependency, hash);
+		hash = Fnv1a(&dependencyHash, sizeof(dependencyHash), hash);
+	}
+	return hash;
+}
+
+
+uint64_t AssetCooker::HashFile(const std::string& path) const {
+	{
+		std::lock_guard<std::mutex> lock(m_hashMutex);
+		auto it = m_fileHashes.find(path);
+		if (it != m_fileHashes.end()) {
+			return it->second.contentHash;
+		}
+	}
+
+	// Another thread may hash the same file meanwhile, the result is the same.
+	const std::string file = GetSourceFile(path);
+	CookManifest::FileStamp stamp;
+	std::error_code error;
+	if (fs::is_regular_file(file, error)) {
+		stamp.size = fs::file_size(file);
+		stamp.lastWriteTime = fs::last_write_time(file).time_since_epoch().count();
+
+		const CookManifest::FileStamp* previous = m_previous.FindFileStamp(path);
+		if (previous != nullptr && previous->size == stamp.size && previous->lastWriteTime == stamp.lastWriteTime) {
+			stamp.contentHash = previous->contentHash;
+		}
+		else {
+			std::ifstream stream(file, std::ios::binary);
+			if (!stream.is_open()) {
+				throw RuntimeException("Could not open file for hashing.", file);
+			}
+			std::vector<char> buffer(1 << 16);
+			uint64_t hash = Fnv1a(nullptr, 0);
+			while (stream.read(buffer.data(), buffer.size()) || stream.gcount() > 0) {
+				hash = Fnv1a(buffer.data(), (size_t)stream.gcount(), hash);
+			}
+			// Missing files hash to 0, existing ones never do.
+			stamp.contentHash = hash != 0 ? hash : 1;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(m_hashMutex);
+	m_fileHashes[path] = stamp;
+	return stamp.contentHash;
+}
+
+
+std::string AssetCooker::GetSourceFile(const std::string& path) const {
+	return (fs::path(m_settings.sourceDirectory) / path).generic_string();
+}
+
+
+std::string AssetCooker::GetOutputFile(const std::string& path) const {
+	return (fs::path(m_settings.outputDirectory) / path).generic_string();
+}
+
+
+}
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Cookers.hpp"
+
+#include <AssetLibrary/CookManifest.hpp>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace inl {
+namespace asset {
+
+
+struct CookSettings {
+	std::string sourceDirectory;
+	std::string outputDirectory;
+	/// <summary> Number of threads to use, 0 for the number of cores. </summary>
+	unsigned numThreads = 0;
+	/// <summary> Cook every asset, even those that did not change. </summary>
+	bool force = false;
+};
+
+
+struct CookResult {
+	size_t numCooked = 0;
+	size_t numUpToDate = 0;
+	size_t numRemoved = 0;
+	/// <summary> One message for each asset that could not be cooked. </summary>
+	std::vector<std::string> errors;
+};
+
+
+/// <summary>
+/// Cooks the source assets of a directory tree into the output directory, and writes a <see cref="CookManifest"/> there.
+/// </summary>
+/// <remarks>
+/// An asset is cooked again only if the hash of its inputs changed: the cooker version, the settings of its type,
+/// and the contents of its source file and of the dependencies recorded the last time it was cooked.
+/// Contents are hashed again only for files whose size or modification time changed.
+/// Assets are cooked in parallel. Assets that fail are left out of the manifest, so they are retried on the next run.
+/// </remarks>
+class AssetCooker {
+public:
+	/// <summary> Increment when cooked formats or cooking change, so that all assets are cooked again. </summary>
+	static constexpr uint32_t Version = 2;
+public:
+	explicit AssetCooker(CookSettings settings);
+
+	/// <exception cref="FileNotFoundException"> If the source directory does not exist. </exception>
+	/// <exception cref="RuntimeException"> If the manifest cannot be written. </exception>
+	CookResult Cook();
+private:
+	struct Job {
+		eAssetType type;
+		std::string sourcePath; // Relative to the source directory.
+		std::string cookedPath; // Relative to the output directory.
+	};
+
+	std::vector<Job> FindSources() const;
+	bool IsUpToDate(const Job& job) const;
+	uint64_t HashInputs(const Job& job, const std::vector<std::string>& dependencies) const;
+	uint64_t HashFile(const std::string& path) const;
+
+	std::string GetSourceFile(const std::string& path) const;
+	std::string GetOutputFile(const std::string& path) const;
+private:
+	CookSettings m_settings;
+	CookManifest m_previous;
+	CookManifest m_manifest;
+
+	// Stamps of the files hashed by this run, by source relative path. The content hash of missing files is 0.
+	mutable std::mutex m_hashMutex;
+	mutable std::unordered_map<std::string, CookManifest::FileStamp> m_fileHashes;
+};
+
+
+}
+}
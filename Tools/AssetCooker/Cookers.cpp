@@ -0,0 +1,350 @@
+#include "Cookers.hpp"
+
+#include <AssetLibrary/BlockCompression.hpp>
+#include <AssetLibrary/CookedMesh.hpp>
+#include <AssetLibrary/Image.hpp>
+#include <AssetLibrary/ImageResampler.hpp>
+#include <AssetLibrary/Model.hpp>
+#include <AssetLibrary/VirtualIOSystem.hpp>
+#include <GraphicsEngine_LL/ShaderManager.hpp>
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+
+
+namespace inl {
+namespace asset {
+
+
+//------------------------------------------------------------------------------
+// Helpers
+//------------------------------------------------------------------------------
+
+
+static std::string GetExtension(const std::string& path) {
+	const size_t dot = path.find_last_of('.');
+	const size_t slash = path.find_last_of('/');
+	if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+		return {};
+	}
+	std::string extension = path.substr(dot);
+	for (auto& c : extension) {
+		c = (char)std::tolower((unsigned char)c);
+	}
+	return extension;
+}
+
+
+static std::string ReplaceExtension(const std::string& path, const std::string& extension) {
+	return path.substr(0, path.size() - GetExtension(path).size()) + extension;
+}
+
+
+// The directory of a file system path, with a trailing slash, or empty at the root.
+static std::string GetDirectory(const std::string& path) {
+	const size_t slash = path.find_last_of('/');
+	return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+
+//------------------------------------------------------------------------------
+// Models
+//------------------------------------------------------------------------------
+
+
+// Remembers the files assimp opens besides the model, like .mtl files of .obj models.
+class RecordingIOSystem : public VirtualIOSystem {
+public:
+	RecordingIOSystem(const VirtualFileSystem& fileSystem, std::vector<std::string>& openedFiles)
+		: VirtualIOSystem(fileSystem), m_openedFiles(openedFiles)
+	{}
+
+	Assimp::IOStream* Open(const char* file, const char* mode) override {
+		Assimp::IOStream* stream = VirtualIOSystem::Open(file, mode);
+		if (stream != nullptr) {
+			m_openedFiles.push_back(PackFile::NormalizePath(file));
+		}
+		return stream;
+	}
+private:
+	std::vector<std::string>& m_openedFiles;
+};
+
+
+static std::vector<std::string> CookModel(const VirtualFileSystem& fileSystem, const std::string& sourcePath, const std::string& outputFile) {
+	std::vector<std::string> openedFiles;
+	Model model(new RecordingIOSystem(fileSystem, openedFiles), sourcePath);
+
+	// The layout the scene loads meshes with.
+	const CoordSysLayout coordSysLayout = { AxisDir::POS_X, AxisDir::NEG_Z, AxisDir::NEG_Y };
+	CookedMeshData::FromModel<gxeng::Position<0>, gxeng::Normal<0>, gxeng::TexCoord<0>>(model, coordSysLayout).Write(outputFile);
+
+	const std::string modelPath = PackFile::NormalizePath(sourcePath);
+	std::vector<std::string> dependencies;
+	for (const auto& file : openedFiles) {
+		if (file != modelPath && std::find(dependencies.begin(), dependencies.end(), file) == dependencies.end()) {
+			dependencies.push_back(file);
+		}
+	}
+	const std::string directory = GetDirectory(modelPath);
+	for (const auto& texturePath : model.GetTexturePaths()) {
+		std::string path = PackFile::NormalizePath(directory + texturePath);
+		if (std::find(dependencies.begin(), dependencies.end(), path) == dependencies.end()) {
+			dependencies.push_back(std::move(path));
+		}
+	}
+	return dependencies;
+}
+
+
+//------------------------------------------------------------------------------
+// Textures
+//------------------------------------------------------------------------------
+
+
+// Layout of the DDS file header, see the DirectX documentation of DDS_HEADER and DDS_HEADER_DXT10.
+struct DdsHeader {
+	uint32_t magic;
+	uint32_t size;
+	uint32_t flags;
+	uint32_t height;
+	uint32_t width;
+	uint32_t pitchOrLinearSize;
+	uint32_t depth;
+	uint32_t mipMapCount;
+	uint32_t reserved1[11];
+	uint32_t pixelFormatSize;
+	uint32_t pixelFormatFlags;
+	uint32_t fourCC;
+	uint32_t pixelFormatBits[5];
+	uint32_t caps;
+	uint32_t caps2;
+	uint32_t caps3;
+	uint32_t caps4;
+	uint32_t reserved2;
+	uint32_t dxgiFormat;
+	uint32_t resourceDimension;
+	uint32_t miscFlag;
+	uint32_t arraySize;
+	uint32_t miscFlags2;
+};
+static_assert(sizeof(DdsHeader) == 4 + 124 + 20, "DDS header must match the file layout.");
+
+
+static uint32_t GetDxgiFormat(eBlockFormat format) {
+	switch (format) {
+		case eBlockFormat::BC1: return 71; // DXGI_FORMAT_BC1_UNORM
+		case eBlockFormat::BC3: return 77; // DXGI_FORMAT_BC3_UNORM
+		case eBlockFormat::BC4: return 80; // DXGI_FORMAT_BC4_UNORM
+		case eBlockFormat::BC5: return 83; // DXGI_FORMAT_BC5_UNORM
+		case eBlockFormat::BC7: return 98; // DXGI_FORMAT_BC7_UNORM
+		default: throw InvalidArgumentException("Block format has no DXGI format.");
+	}
+}
+
+
+static void WriteDds(const std::string& path, eBlockFormat format, size_t width, size_t height, const std::vector<std::vector<uint8_t>>& levels) {
+	DdsHeader header = {};
+	header.magic = 0x20534444; // "DDS "
+	header.size = 124;
+	header.flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; // caps, height, width, pixel format, mip count, linear size
+	header.height = (uint32_t)height;
+	header.width = (uint32_t)width;
+	header.pitchOrLinearSize = (uint32_t)levels[0].size();
+	header.mipMapCount = (uint32_t)levels.size();
+	header.pixelFormatSize = 32;
+	header.pixelFormatFlags = 0x4; // four CC
+	header.fourCC = 0x30315844; // "DX10"
+	header.caps = 0x1000 | 0x8 | 0x400000; // texture, complex, mip map
+	header.dxgiFormat = GetDxgiFormat(format);
+	header.resourceDimension = 3; // texture 2D
+	header.arraySize = 1;
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		throw RuntimeException("Could not open file for writing.", path);
+	}
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	for (const auto& level : levels) {
+		file.write(reinterpret_cast<const char*>(level.data()), level.size());
+	}
+	if (!file.good()) {
+		throw RuntimeException("Could not write texture.", path);
+	}
+}
+
+
+// FreeImage stores rows bottom up and colors as BGR. DDS files are top down RGB.
+static std::vector<uint8_t> GetTopDownRgb(const Image& image) {
+	const size_t width = image.GetWidth();
+	const size_t height = image.GetHeight();
+	const size_t channelCount = image.GetChannelCount();
+	const size_t rowSize = width * channelCount;
+
+	std::vector<uint8_t> pixels(rowSize * height);
+	for (size_t y = 0; y < height; ++y) {
+		const uint8_t* source = static_cast<const uint8_t*>(image.GetData()) + (height - 1 - y) * image.GetBytesPerRow();
+		uint8_t* target = pixels.data() + y * rowSize;
+		std::memcpy(target, source, rowSize);
+		if (channelCount >= 3) {
+			for (size_t x = 0; x < rowSize; x += channelCount) {
+				std::swap(target[x], target[x + 2]);
+			}
+		}
+	}
+	return pixels;
+}
+
+
+static std::vector<std::string> CookTexture(const VirtualFileSystem& fileSystem, const std::string& sourcePath, const std::string& outputFile) {
+	Image image;
+	image.Load(fileSystem, sourcePath);
+	if (image.GetType() != eChannelType::INT8) {
+		throw InvalidArgumentException("Only textures with 8 bit channels are cooked.", sourcePath);
+	}
+
+	eBlockFormat format;
+	switch (image.GetChannelCount()) {
+		case 1: format = eBlockFormat::BC4; break;
+		case 2: format = eBlockFormat::BC5; break;
+		case 3: format = eBlockFormat::BC1; break;
+		default: format = eBlockFormat::BC7; break;
+	}
+
+	// Assets are already cooked in parallel, a single texture uses one thread.
+	ResampleDesc resampleDesc;
+	resampleDesc.numThreads = 1;
+	std::vector<Image> mips = ImageResampler(resampleDesc).GenerateMipChain(image);
+	BlockCompressor compressor(format, 1);
+
+	std::vector<std::vector<uint8_t>> levels;
+	levels.push_back(compressor.Compress(GetTopDownRgb(image).data(), 0, image.GetWidth(), image.GetHeight(), (int)image.GetChannelCount()));
+	for (const auto& mip : mips) {
+		levels.push_back(compressor.Compress(GetTopDownRgb(mip).data(), 0, mip.GetWidth(), mip.GetHeight(), (int)mip.GetChannelCount()));
+	}
+
+	WriteDds(outputFile, format, image.GetWidth(), image.GetHeight(), levels);
+	return {};
+}
+
+
+//------------------------------------------------------------------------------
+// Shaders
+//------------------------------------------------------------------------------
+
+
+static std::string ReadText(const VirtualFile& file) {
+	return std::string(static_cast<const char*>(file.GetData()), file.GetSize());
+}
+
+
+// Includes are looked for next to the including file, then at the root, with and without the .hlsl
+// extension the shader manager appends. Missing includes are recorded too, they may appear later.
+static void CollectIncludes(const VirtualFileSystem& fileSystem, const std::string& path, const std::string& sourceCode, std::unordered_set<std::string>& visited, std::vector<std::string>& dependencies) {
+	const std::string directory = GetDirectory(path);
+	for (const auto& includeName : gxeng::ShaderManager::FindIncludes(sourceCode)) {
+		const std::string candidates[] = {
+			PackFile::NormalizePath(directory + includeName),
+			PackFile::NormalizePath(directory + includeName + ".hlsl"),
+			PackFile::NormalizePath(includeName),
+			PackFile::NormalizePath(includeName + ".hlsl"),
+		};
+		VirtualFile includeFile;
+		auto found = std::find_if(std::begin(candidates), std::end(candidates), [&](const std::string& candidate) {
+			return fileSystem.TryOpen(candidate, includeFile);
+		});
+		const std::string& includePath = found != std::end(candidates) ? *found : candidates[0];
+
+		if (!visited.insert(includePath).second) {
+			continue;
+		}
+		dependencies.push_back(includePath);
+		if (found != std::end(candidates)) {
+			CollectIncludes(fileSystem, includePath, ReadText(includeFile), visited, dependencies);
+		}
+	}
+}
+
+
+static std::vector<std::string> CookShader(const VirtualFileSystem& fileSystem, const std::string& sourcePath, const std::string& outputFile) {
+	VirtualFile file = fileSystem.Open(sourcePath);
+
+	std::ofstream output(outputFile, std::ios::binary | std::ios::trunc);
+	if (!output.is_open()) {
+		throw RuntimeException("Could not open file for writing.", outputFile);
+	}
+	output.write(static_cast<const char*>(file.GetData()), file.GetSize());
+	if (!output.good()) {
+		throw RuntimeException("Could not write shader.", outputFile);
+	}
+
+	std::unordered_set<std::string> visited = { PackFile::NormalizePath(sourcePath) };
+	std::vector<std::string> dependencies;
+	CollectIncludes(fileSystem, PackFile::NormalizePath(sourcePath), ReadText(file), visited, dependencies);
+	return dependencies;
+}
+
+
+//------------------------------------------------------------------------------
+// Asset types
+//------------------------------------------------------------------------------
+
+
+bool GetAssetType(const std::string& path, eAssetType& type) {
+	static const char* const modelExtensions[] = { ".fbx", ".obj", ".dae", ".3ds", ".blend", ".ply", ".stl", ".gltf", ".glb" };
+	static const char* const textureExtensions[] = { ".png", ".jpg", ".jpeg", ".tga", ".bmp", ".tif", ".tiff", ".psd" };
+
+	const std::string extension = GetExtension(path);
+	auto isOneOf = [&extension](const auto& extensions) {
+		return std::any_of(std::begin(extensions), std::end(extensions), [&extension](const char* e) { return extension == e; });
+	};
+
+	if (isOneOf(modelExtensions)) {
+		type = eAssetType::MODEL;
+		return true;
+	}
+	if (isOneOf(textureExtensions)) {
+		type = eAssetType::TEXTURE;
+		return true;
+	}
+	if (extension == ".hlsl") {
+		type = eAssetType::SHADER;
+		return true;
+	}
+	return false;
+}
+
+
+std::string GetCookedPath(eAssetType type, const std::string& sourcePath) {
+	switch (type) {
+		case eAssetType::MODEL: return ReplaceExtension(sourcePath, CookedMesh::Extension);
+		case eAssetType::TEXTURE: return ReplaceExtension(sourcePath, ".dds");
+		default: return sourcePath;
+	}
+}
+
+
+std::string GetCookSettings(eAssetType type) {
+	switch (type) {
+		case eAssetType::MODEL: return "mesh position normal texcoord +x -z -y";
+		case eAssetType::TEXTURE: return "dds bc4 bc5 bc1 bc7 kaiser";
+		default: return "copy";
+	}
+}
+
+
+std::vector<std::string> CookAsset(eAssetType type, const VirtualFileSystem& fileSystem, const std::string& sourcePath, const std::string& outputFile) {
+	switch (type) {
+		case eAssetType::MODEL: return CookModel(fileSystem, sourcePath, outputFile);
+		case eAssetType::TEXTURE: return CookTexture(fileSystem, sourcePath, outputFile);
+		default: return CookShader(fileSystem, sourcePath, outputFile);
+	}
+}
+
+
+}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <BaseLibrary/FileSystem/VirtualFileSystem.hpp>
+
+#include <string>
+#include <vector>
+
+
+namespace inl {
+namespace asset {
+
+
+enum class eAssetType {
+	MODEL, // cooked to a CookedMesh
+	TEXTURE, // cooked to a block compressed DDS with mips
+	SHADER, // copied, shaders are compiled at runtime
+};
+
+
+/// <summary> Classifies a source file by its extension. Returns false if the file is not cooked. </summary>
+bool GetAssetType(const std::string& path, eAssetType& type);
+
+/// <summary> The path of the cooked asset relative to the output directory, from that of the source. </summary>
+std::string GetCookedPath(eAssetType type, const std::string& sourcePath);
+
+/// <summary> Describes the settings assets of the type are cooked with, hashed into the inputs of the assets. </summary>
+std::string GetCookSettings(eAssetType type);
+
+/// <summary> Cooks one asset. </summary>
+/// <param name="fileSystem"> The source directory, mounted at the root. </param>
+/// <param name="sourcePath"> Path of the asset in the file system. </param>
+/// <param name="outputFile"> The file to write. Its directory must exist. </param>
+/// <returns> The other files of the file system the asset was made from. They need not exist. </returns>
+/// <exception cref="Exception"> Or any other exception, if the asset cannot be cooked. </exception>
+std::vector<std::string> CookAsset(eAssetType type, const VirtualFileSystem& fileSystem, const std::string& sourcePath, const std::string& outputFile);
+
+
+}
+}
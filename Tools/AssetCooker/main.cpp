@@ -0,0 +1,67 @@
+#include "AssetCooker.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+using namespace inl::asset;
+
+
+static void PrintUsage() {
+	std::cout << "Usage: AssetCooker <source directory> <output directory> [-j <threads>] [--force]" << std::endl;
+	std::cout << "  Cooks models, textures and shaders that changed since the last run." << std::endl;
+	std::cout << "  -j <threads>  Number of threads, all cores by default." << std::endl;
+	std::cout << "  --force       Cook all assets, even those that did not change." << std::endl;
+}
+
+
+int main(int argc, char* argv[]) {
+	CookSettings settings;
+	int numPositional = 0;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			settings.numThreads = (unsigned)std::max(0, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--force") == 0) {
+			settings.force = true;
+		}
+		else if (argv[i][0] != '-' && numPositional == 0) {
+			settings.sourceDirectory = argv[i];
+			++numPositional;
+		}
+		else if (argv[i][0] != '-' && numPositional == 1) {
+			settings.outputDirectory = argv[i];
+			++numPositional;
+		}
+		else {
+			PrintUsage();
+			return 2;
+		}
+	}
+	if (numPositional != 2) {
+		PrintUsage();
+		return 2;
+	}
+
+	CookResult result;
+	try {
+		AssetCooker cooker(settings);
+		result = cooker.Cook();
+	}
+	catch (std::exception& ex) {
+		std::cout << "Cooking failed: " << ex.what() << std::endl;
+		return 1;
+	}
+
+	for (const auto& error : result.errors) {
+		std::cout << "error: " << error << std::endl;
+	}
+	std::cout << result.numCooked << " cooked, "
+		<< result.numUpToDate << " up to date, "
+		<< result.numRemoved << " removed, "
+		<< result.errors.size() << " failed." << std::endl;
+
+	return result.errors.empty() ? 0 : 1;
+}